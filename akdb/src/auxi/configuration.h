@@ -3,23 +3,28 @@
 
 #include "iniparser.h"
 
+/*
+ * The settings below are parsed once by AK_inflate_config into AK_settings, AK_reload_config refreshes the ones that
+ * may change at runtime.
+ */
+
 /**
  * @def AK_BLOBS_PATH
  * @brief Constant declaring the path of blobs folder (note: if changed keep in mind for make clean in makefile).
    Path declared in config.ini has to be absolute (tied up with installation package), but for debugging purpose we are going to keep it relative.
 */
-#define AK_BLOBS_PATH (iniparser_getstring(AK_config, "general:blobs_folder", "./blobs"))
+#define AK_BLOBS_PATH (AK_settings.blobs_path)
 
 /**
  * @def DB_NAME
  * @brief Constant declaring the name of the database file
 */
-#define DB_FILE (iniparser_getstring(AK_config,"general:db_file","kalashnikov.db"))
+#define DB_FILE (AK_settings.db_file)
 /**
  * @def MAX_NUM_OF_BLOCKS
  * @brief Constant declaring the maximum number of blocks in a segment
 */
-#define MAX_NUM_OF_BLOCKS (iniparser_getint(AK_config,"segments:max_num_of_blocks",200))
+#define MAX_NUM_OF_BLOCKS (AK_settings.max_num_of_blocks)
 /**
   * @def MAX_EXTENTS_IN_SEGMENT
   * @brief Constant declaring the maximum number of extents in segment
@@ -29,17 +34,17 @@
   * @def MAX_FREE_SPACE_SIZE
   * @brief Constant declaring the maximum free space in block
 */
-#define MAX_FREE_SPACE_SIZE (iniparser_getint(AK_config,"blocks:max_AK_free_space_size",4000))
+#define MAX_FREE_SPACE_SIZE (AK_settings.max_free_space_size)
 /**
   * @def MAX_LAST_TUPLE_DICT_SIZE_TO_USE
   * @brief Constant declaring the maximum size od last tuple in a dictionary
 */
-#define MAX_LAST_TUPLE_DICT_SIZE_TO_USE (iniparser_getint(AK_config,"dictionary:max_last_tuple_dict_size_to_use",470))
+#define MAX_LAST_TUPLE_DICT_SIZE_TO_USE (AK_settings.max_last_tuple_dict_size_to_use)
 /**
   * @def DB_FILE_SIZE
   * @brief Constant declaring size of DB file in MB
  */
-#define DB_FILE_SIZE (iniparser_getint(AK_config,"general:db_file_size",40))
+#define DB_FILE_SIZE (AK_settings.db_file_size)
 /**
   * @def MAX_DB_FILE_BLOCKS
   * @brief Constant declaring total blocks in DB file (for the given DB_FILE size)
@@ -49,32 +54,62 @@
   * @def INITIAL_EXTENT_SIZE
   * @brief Constant declaring initial extent size in blocks
  */
-#define INITIAL_EXTENT_SIZE (iniparser_getint(AK_config,"extents:initial_extent_size",15))
+#define INITIAL_EXTENT_SIZE (AK_settings.initial_extent_size)
 /**
   * @def EXTENT_GROWTH_TABLE
   * @brief Constant declaring extent growth factor for tables
  */
-#define EXTENT_GROWTH_TABLE (iniparser_getdouble(AK_config,"extents:extent_growth_table",0.5))
+#define EXTENT_GROWTH_TABLE (AK_settings.extent_growth_table)
 /**
   * @def EXTENT_GROWTH_INDEX
   * @brief Constant declaring extent growth factor for indices
  */
-#define EXTENT_GROWTH_INDEX (iniparser_getdouble(AK_config,"extents:extent_growth_index",0.2))
+#define EXTENT_GROWTH_INDEX (AK_settings.extent_growth_index)
 /**
   * @def EXTENT_GROWTH_TRANSACTION
   * @brief Constant declaring extent growth factor for transaction segments
  */
-#define EXTENT_GROWTH_TRANSACTION (iniparser_getdouble(AK_config,"extents:extent_growth_transaction",0.2))
+#define EXTENT_GROWTH_TRANSACTION (AK_settings.extent_growth_transaction)
 /**
   * @def EXTENT_GROWTH_TEMP
   * @brief Constant declaring extent growth factor for temporary segments
  */
-#define EXTENT_GROWTH_TEMP (iniparser_getdouble(AK_config,"extents:extent_growth_temp",0.5))
+#define EXTENT_GROWTH_TEMP (AK_settings.extent_growth_temp)
+/**
+  * @def CACHE_POOL_SIZE
+  * @brief Constant declaring the number of block frames in the buffer pool
+ */
+#define CACHE_POOL_SIZE (AK_settings.cache_pool_size)
+/**
+  * @def CACHE_POLICY
+  * @brief Constant declaring the buffer pool replacement policy (lru, clock or 2q)
+ */
+#define CACHE_POLICY (AK_settings.cache_policy)
+/**
+  * @def CACHE_WRITER_INTERVAL
+  * @brief Constant declaring the number of milliseconds between two rounds of the background writer (0 disables it)
+ */
+#define CACHE_WRITER_INTERVAL (AK_settings.cache_writer_interval)
+/**
+  * @def CACHE_WRITER_BATCH
+  * @brief Constant declaring the maximum number of dirty blocks the background writer writes in one round
+ */
+#define CACHE_WRITER_BATCH (AK_settings.cache_writer_batch)
+/**
+  * @def CACHE_READAHEAD
+  * @brief Constant declaring the maximum number of blocks read with one vectored read on a sequential scan (1 disables read-ahead)
+ */
+#define CACHE_READAHEAD (AK_settings.cache_readahead)
+/**
+  * @def WORK_MEMORY
+  * @brief Constant declaring the memory in KB a query operator may use for its hash tables before it spills to temporary segments
+ */
+#define WORK_MEMORY (AK_settings.work_memory)
 /**
  * @def ARCHIVELOG_PATH
  * @brief Constant declaring the path of archivelog folder
 */
-#define ARCHIVELOG_PATH (iniparser_getstring(AK_config, "redolog:archivelog_folder", "./archivelog"))
+#define ARCHIVELOG_PATH (AK_settings.archivelog_path)
 /**
  * @def MAX_REDO_LOG_MEMORY
  * @brief The maximum size of REDO log memory
@@ -91,7 +126,7 @@
  * @def NUMBER_OF_THREADS
  * @brief Constant declaring maximum number of threads that an application can acquire
 */
-#define NUMBER_OF_THREADS (iniparser_getint(AK_config,"general:number_of_threads",42))
+#define NUMBER_OF_THREADS (AK_settings.number_of_threads)
 /**
   * @def MAX_EXTENTS
   * @brief Constant declaring maximum number of extents for a given segment
@@ -78,7 +78,7 @@
 #define MAX_QUERY_LIB_MEMORY 255
 /**
   * @def MAX_CACHE_MEMORY
-  * @brief Constant declaring the maximum size of DB cache memory
+  * @brief Constant declaring the default size of DB cache memory (overridden by cache:pool_size in config.ini)
  */
 #define MAX_CACHE_MEMORY 255
 /**
@@ -97,21 +97,6 @@
  * @brief Constant declaring the maximum number of attributes to handle in relation equivalence function
  */
 #define MAX_TOKENS 255
-/**
- * @def MAX_MAIN_BUCKETS
- * @brief Constant declaring the maximum number of main buckets
-*/
-#define MAX_MAIN_BUCKETS 512
-/**
- * @def MAIN_BUCKET_SIZE
- * @brief Constant declaring the size of main buckets
-*/
-#define MAIN_BUCKET_SIZE 4
-/**
- * @def HASH_BUCKET_SIZE
- * @brief Constant declaring the size of hash buckets
-*/
-#define HASH_BUCKET_SIZE 4
 /**
  * @def NUMBER_OF_KEYS
  * @brief Constant declaring the number of buckets in hash table
@@ -271,6 +256,41 @@
  * @brief Constant indicating dirty block (changed since read from disk, has to be written)
  */
 #define BLOCK_DIRTY 1
+/**
+ * @def CACHE_POLICY_LRU
+ * @brief Constant indicating the least recently used block cache replacement policy
+ */
+#define CACHE_POLICY_LRU 0
+/**
+ * @def CACHE_POLICY_CLOCK
+ * @brief Constant indicating the CLOCK (second chance) block cache replacement policy
+ */
+#define CACHE_POLICY_CLOCK 1
+/**
+ * @def CACHE_POLICY_2Q
+ * @brief Constant indicating the scan resistant 2Q block cache replacement policy
+ */
+#define CACHE_POLICY_2Q 2
+/**
+ * @def CACHE_POLICY_COUNT
+ * @brief Number of block cache replacement policies
+ */
+#define CACHE_POLICY_COUNT 3
+/**
+ * @def CACHE_QUEUE_NONE
+ * @brief Constant indicating a cache frame that is not linked into a replacement queue
+ */
+#define CACHE_QUEUE_NONE -1
+/**
+ * @def CACHE_QUEUE_A1IN
+ * @brief Constant indicating the LRU queue, or the 2Q first-reference FIFO queue
+ */
+#define CACHE_QUEUE_A1IN 0
+/**
+ * @def CACHE_QUEUE_AM
+ * @brief Constant indicating the 2Q queue of blocks that were referenced again after eviction
+ */
+#define CACHE_QUEUE_AM 1
 /**
  * @def ATTR_DELIMITER
  * @brief Constant declaring attributes delimiter
@@ -332,21 +352,6 @@
  * @brief Constant indicating that the operation to be performed is 'search'
  */
 #define FIND 2
-/**
- * @def INFO_BUCKET
- * @brief Constant declaring the type of bucket as "info bucket" when inserting bucket to block
-*/
-#define INFO_BUCKET 0
-/**
- * @def MAIN_BUCKET
- * @brief Constant declaring the type of bucket as "main bucket" when inserting bucket to block
-*/
-#define MAIN_BUCKET 1
-/**
- * @def HASH_BUCKET
- * @brief Constant declaring the type of bucket as "hash bucket" when inserting bucket to block
-*/
-#define HASH_BUCKET 2
 /**
  * @def SHARED_LOCK
  * @brief Constant declaring the type of lock as SHARED LOCK
@@ -531,7 +536,7 @@
  * @def NUM_SYS_TABLES
  * @brief Constant which defines the length of system_catalog
  */
-#define NUM_SYS_TABLES  20
+#define NUM_SYS_TABLES  22
 
 #endif
 
@@ -9,6 +9,7 @@
 /*---------------------------- Includes ------------------------------------*/
 #include <ctype.h>
 #include "iniparser.h"
+#include "constants.h"
 
 /*---------------------------- Defines -------------------------------------*/
 #define ASCIILINESZ         (1024)
@@ -852,15 +853,90 @@ char * AK_config_get(dictionary * d, char * key, char * def)
 //char * DB_FILE;
 
 
+AK_runtime_config AK_settings = {
+    "kalashnikov.db", "./blobs", 40, 42, 4000, 200, 470, 15, 0.5, 0.2, 0.2, 0.5,
+    MAX_CACHE_MEMORY, "lru", 0, 32, 8, 1024, "./archivelog"
+};
+
+/**
+ * @brief Function that copies a string setting into a field of AK_settings
+ * @param field field to copy into, AK_CONFIG_STRING_SIZE bytes long
+ * @param value value of the setting
+ * @return No return value
+ */
+static void AK_config_copy_string(char *field, const char *value)
+{
+  strncpy(field, value, AK_CONFIG_STRING_SIZE - 1);
+  field[AK_CONFIG_STRING_SIZE - 1] = '\0';
+}
+
+/**
+ * @brief Function that reads the settings that may change while the database is running from the dictionary into
+ *        AK_settings
+ * @param d dictionary loaded from config.ini
+ * @return No return value
+ */
+static void AK_config_read_reloadable(dictionary *d)
+{
+  AK_settings.cache_writer_interval = iniparser_getint(d, "cache:writer_interval", 0);
+  AK_settings.cache_writer_batch = iniparser_getint(d, "cache:writer_batch", 32);
+  AK_settings.cache_readahead = iniparser_getint(d, "cache:readahead", 8);
+  AK_settings.work_memory = iniparser_getint(d, "query:work_memory", 1024);
+}
+
+/**
+ * @brief Function that loads config.ini into AK_config and parses all settings into AK_settings
+ * @return No return value
+ */
 void AK_inflate_config()
 {
   AK_PRO;
   AK_config = iniparser_load("config.ini");
+  AK_config_copy_string(AK_settings.db_file, iniparser_getstring(AK_config, "general:db_file", "kalashnikov.db"));
+  AK_config_copy_string(AK_settings.blobs_path, iniparser_getstring(AK_config, "general:blobs_folder", "./blobs"));
+  AK_settings.db_file_size = iniparser_getint(AK_config, "general:db_file_size", 40);
+  AK_settings.number_of_threads = iniparser_getint(AK_config, "general:number_of_threads", 42);
+  AK_settings.max_free_space_size = iniparser_getint(AK_config, "blocks:max_AK_free_space_size", 4000);
+  AK_settings.max_num_of_blocks = iniparser_getint(AK_config, "segments:max_num_of_blocks", 200);
+  AK_settings.max_last_tuple_dict_size_to_use = iniparser_getint(AK_config, "dictionary:max_last_tuple_dict_size_to_use", 470);
+  AK_settings.initial_extent_size = iniparser_getint(AK_config, "extents:initial_extent_size", 15);
+  AK_settings.extent_growth_table = iniparser_getdouble(AK_config, "extents:extent_growth_table", 0.5);
+  AK_settings.extent_growth_index = iniparser_getdouble(AK_config, "extents:extent_growth_index", 0.2);
+  AK_settings.extent_growth_transaction = iniparser_getdouble(AK_config, "extents:extent_growth_transaction", 0.2);
+  AK_settings.extent_growth_temp = iniparser_getdouble(AK_config, "extents:extent_growth_temp", 0.5);
+  AK_settings.cache_pool_size = iniparser_getint(AK_config, "cache:pool_size", MAX_CACHE_MEMORY);
+  AK_config_copy_string(AK_settings.cache_policy, iniparser_getstring(AK_config, "cache:policy", "lru"));
+  AK_config_copy_string(AK_settings.archivelog_path, iniparser_getstring(AK_config, "redolog:archivelog_folder", "./archivelog"));
+  AK_config_read_reloadable(AK_config);
   AK_EPI;
   //DB_FILE = AK_config_get(AK_config,"general:db_file", NULL);
   //printf("DB_FILE: %s \n",DB_FILE);
 }
 
+/**
+ * @brief Function that reads config.ini again and applies the settings that may change while the database is running
+ *        (cache:writer_interval, cache:writer_batch, cache:readahead and query:work_memory). The file layout, extent
+ *        and pool settings stay as they were loaded by AK_inflate_config.
+ * @return EXIT_SUCCESS if config.ini has been read, EXIT_ERROR otherwise
+ */
+int AK_reload_config()
+{
+  dictionary *d;
+  AK_PRO;
+  d = iniparser_load("config.ini");
+  if (d == NULL)
+  {
+    AK_EPI;
+    return EXIT_ERROR;
+  }
+  AK_config_read_reloadable(d);
+  if (AK_config != NULL)
+    iniparser_AK_freedict(AK_config);
+  AK_config = d;
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
 
 
 /*
@@ -1022,6 +1098,22 @@ TestResult AK_iniparser_test(){
         }
     }
 
+    // check if the parsed settings match the loaded config.ini and survive a reload
+    printf("Testing if the settings parsed from config.ini match the dictionary and survive a reload\n");
+    if(AK_config != NULL
+        && AK_settings.max_num_of_blocks == iniparser_getint(AK_config, "segments:max_num_of_blocks", 200)
+        && AK_settings.cache_readahead == iniparser_getint(AK_config, "cache:readahead", 8)
+        && strcmp(AK_settings.db_file, iniparser_getstring(AK_config, "general:db_file", "kalashnikov.db")) == 0
+        && AK_reload_config() == EXIT_SUCCESS
+        && AK_settings.cache_writer_batch == iniparser_getint(AK_config, "cache:writer_batch", 32)
+        && AK_settings.cache_readahead == iniparser_getint(AK_config, "cache:readahead", 8)){
+        succesfulTests++;
+        printf("Success\n\n");
+    }else{
+        failedTests++;
+        printf("Fail\n\n");
+    }
+
     //cleaning dictionary
     iniparser_AK_freedict(dict_to_test);
 	AK_EPI;
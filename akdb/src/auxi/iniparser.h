@@ -306,11 +306,64 @@ dictionary * iniparser_load(const char * ininame);
 /*--------------------------------------------------------------------------*/
 void iniparser_AK_freedict(dictionary * d);
 
+/**
+  * @def AK_CONFIG_STRING_SIZE
+  * @brief Constant declaring the maximum length of a string setting kept in AK_runtime_config
+ */
+#define AK_CONFIG_STRING_SIZE 256
+
+/**
+ * @brief Structure holding the settings of config.ini, parsed once by AK_inflate_config so that hot paths read plain
+ *        fields instead of looking the keys up in the dictionary (see auxi/configuration.h)
+ */
+typedef struct {
+    /// general:db_file
+    char db_file[AK_CONFIG_STRING_SIZE];
+    /// general:blobs_folder
+    char blobs_path[AK_CONFIG_STRING_SIZE];
+    /// general:db_file_size, in MB
+    int db_file_size;
+    /// general:number_of_threads
+    int number_of_threads;
+    /// blocks:max_AK_free_space_size
+    int max_free_space_size;
+    /// segments:max_num_of_blocks
+    int max_num_of_blocks;
+    /// dictionary:max_last_tuple_dict_size_to_use
+    int max_last_tuple_dict_size_to_use;
+    /// extents:initial_extent_size
+    int initial_extent_size;
+    /// extents:extent_growth_table
+    double extent_growth_table;
+    /// extents:extent_growth_index
+    double extent_growth_index;
+    /// extents:extent_growth_transaction
+    double extent_growth_transaction;
+    /// extents:extent_growth_temp
+    double extent_growth_temp;
+    /// cache:pool_size
+    int cache_pool_size;
+    /// cache:policy
+    char cache_policy[AK_CONFIG_STRING_SIZE];
+    /// cache:writer_interval, reloadable
+    int cache_writer_interval;
+    /// cache:writer_batch, reloadable
+    int cache_writer_batch;
+    /// cache:readahead, reloadable
+    int cache_readahead;
+    /// query:work_memory, in KB, reloadable
+    int work_memory;
+    /// redolog:archivelog_folder
+    char archivelog_path[AK_CONFIG_STRING_SIZE];
+} AK_runtime_config;
+
 void AK_inflate_config();
+int AK_reload_config();
 
 TestResult AK_iniparser_test();
 
 extern dictionary * AK_config;
+extern AK_runtime_config AK_settings;
 //extern char * DB_FILE;
 
 #endif
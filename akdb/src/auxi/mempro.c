@@ -21,6 +21,7 @@ USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include "mempro.h"
+#include "constants.h"
 /**
 * @author Marin Rukavina, Mislav Bozicevic
 * @param ds debug mode state
@@ -1028,6 +1029,367 @@ size_t AK_fread(void *buf, size_t size, size_t count, FILE *fp) {
     return ret;
 }
 
+/**
+* @brief Write to a file descriptor at a given offset (see pwrite) [public function]
+* @return number of bytes written, -1 on error
+*/
+ssize_t AK_pwrite(int fd, const void *buf, size_t count, off_t offset) {
+    ssize_t ret;
+#if !AK_DEBMOD_ON
+    return pwrite(fd, buf, count, offset);
+#endif
+#ifdef __linux__
+    int32_t pos, i;
+    pos = -1;
+    for (i = 0; i < AK_DEBMOD_PAGES_NUM; ++i) {
+        if (buf == AK_DEBMOD_STATE->page[i]) {
+            pos = i;
+        }
+    }
+    assert(mprotect(AK_DEBMOD_STATE->page[pos],
+        AK_DEBMOD_STATE->real[pos], PROT_READ | PROT_WRITE) == 0);
+#endif
+    ret = pwrite(fd, buf, count, offset);
+#ifdef __linux__
+    assert(mprotect(AK_DEBMOD_STATE->page[pos],
+        AK_DEBMOD_STATE->real[pos], PROT_READ) == 0);
+#endif
+    return ret;
+}
+
+/**
+* @brief Read from a file descriptor at a given offset (see pread) [public function]
+* @return number of bytes read, -1 on error
+*/
+ssize_t AK_pread(int fd, void *buf, size_t count, off_t offset) {
+    ssize_t ret;
+#if !AK_DEBMOD_ON
+    return pread(fd, buf, count, offset);
+#endif
+#ifdef __linux__
+    int32_t pos, i;
+    pos = -1;
+    for (i = 0; i < AK_DEBMOD_PAGES_NUM; ++i) {
+        if (buf == AK_DEBMOD_STATE->page[i]) {
+            pos = i;
+        }
+    }
+    assert(mprotect(AK_DEBMOD_STATE->page[pos],
+        AK_DEBMOD_STATE->real[pos], PROT_READ | PROT_WRITE) == 0);
+#endif
+    ret = pread(fd, buf, count, offset);
+#ifdef __linux__
+    assert(mprotect(AK_DEBMOD_STATE->page[pos],
+        AK_DEBMOD_STATE->real[pos], PROT_READ) == 0);
+#endif
+    return ret;
+}
+
+/**
+* @brief Write several buffers to consecutive positions of a file descriptor (see pwritev) [public function]
+* @return number of bytes written, -1 on error
+*/
+ssize_t AK_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t offset) {
+    ssize_t ret;
+#if !AK_DEBMOD_ON
+    return pwritev(fd, iov, iovcnt, offset);
+#endif
+#ifdef __linux__
+    int32_t pos, i, k;
+    for (k = 0; k < iovcnt; ++k) {
+        pos = -1;
+        for (i = 0; i < AK_DEBMOD_PAGES_NUM; ++i) {
+            if (iov[k].iov_base == AK_DEBMOD_STATE->page[i]) {
+                pos = i;
+            }
+        }
+        if (pos != -1) {
+            assert(mprotect(AK_DEBMOD_STATE->page[pos],
+                AK_DEBMOD_STATE->real[pos], PROT_READ | PROT_WRITE) == 0);
+        }
+    }
+#endif
+    ret = pwritev(fd, iov, iovcnt, offset);
+#ifdef __linux__
+    for (k = 0; k < iovcnt; ++k) {
+        pos = -1;
+        for (i = 0; i < AK_DEBMOD_PAGES_NUM; ++i) {
+            if (iov[k].iov_base == AK_DEBMOD_STATE->page[i]) {
+                pos = i;
+            }
+        }
+        if (pos != -1) {
+            assert(mprotect(AK_DEBMOD_STATE->page[pos],
+                AK_DEBMOD_STATE->real[pos], PROT_READ) == 0);
+        }
+    }
+#endif
+    return ret;
+}
+
+/**
+* @brief Read consecutive positions of a file descriptor into several buffers (see preadv) [public function]
+* @return number of bytes read, -1 on error
+*/
+ssize_t AK_preadv(int fd, const struct iovec *iov, int iovcnt, off_t offset) {
+    ssize_t ret;
+#if !AK_DEBMOD_ON
+    return preadv(fd, iov, iovcnt, offset);
+#endif
+#ifdef __linux__
+    int32_t pos, i, k;
+    for (k = 0; k < iovcnt; ++k) {
+        pos = -1;
+        for (i = 0; i < AK_DEBMOD_PAGES_NUM; ++i) {
+            if (iov[k].iov_base == AK_DEBMOD_STATE->page[i]) {
+                pos = i;
+            }
+        }
+        if (pos != -1) {
+            assert(mprotect(AK_DEBMOD_STATE->page[pos],
+                AK_DEBMOD_STATE->real[pos], PROT_READ | PROT_WRITE) == 0);
+        }
+    }
+#endif
+    ret = preadv(fd, iov, iovcnt, offset);
+#ifdef __linux__
+    for (k = 0; k < iovcnt; ++k) {
+        pos = -1;
+        for (i = 0; i < AK_DEBMOD_PAGES_NUM; ++i) {
+            if (iov[k].iov_base == AK_DEBMOD_STATE->page[i]) {
+                pos = i;
+            }
+        }
+        if (pos != -1) {
+            assert(mprotect(AK_DEBMOD_STATE->page[pos],
+                AK_DEBMOD_STATE->real[pos], PROT_READ) == 0);
+        }
+    }
+#endif
+    return ret;
+}
+
+#ifdef _WIN32
+#define AK_TRACE_TLS __declspec(thread)
+#else
+#define AK_TRACE_TLS __thread
+#endif
+
+/**
+  * @brief Sampling mode counters of one thread. They are only written by
+  *        their thread; the list of all threads is only locked when a
+  *        thread calls a traced function for the first time.
+  */
+typedef struct AK_trace_thread {
+    /// open addressing table keyed by the address of the function name
+    AK_trace_counter slot[AK_TRACE_SLOTS];
+    /// functions entered and not left yet, with the start time of timed calls (0 if not timed)
+    struct {
+        const char *func;
+        unsigned long long start;
+    } stack[AK_TRACE_DEPTH];
+    int depth;
+    struct AK_trace_thread *next;
+} AK_trace_thread;
+
+static AK_trace_thread *AK_trace_threads = NULL;
+static pthread_mutex_t AK_trace_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+static AK_TRACE_TLS AK_trace_thread *AK_trace_self = NULL;
+static volatile int AK_trace_enabled = 1;
+
+/**
+* @brief Monotonic clock in nanoseconds [private function]
+* @return current time
+*/
+static unsigned long long AK_trace_now(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/**
+* @param thread counters of a thread
+* @param func_name function name as in source
+* @brief Finds the slot of a function in the counters of a thread [private function]
+* @return the slot of the function, the empty slot it would take or NULL if the table is full
+*/
+static AK_trace_counter *AK_trace_slot(AK_trace_thread *thread, const char *func_name){
+    uint32_t i, k;
+    i = (uint32_t)(((uintptr_t)func_name >> 3) & (AK_TRACE_SLOTS - 1));
+    for (k = 0; k < AK_TRACE_SLOTS; ++k, i = (i + 1) & (AK_TRACE_SLOTS - 1)){
+        if (thread->slot[i].func == func_name || thread->slot[i].func == NULL){
+            return &thread->slot[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+* @param func_name function name as in source
+* @brief Finds or adds the counter of a function for the calling thread,
+*        registering the thread on its first call [private function]
+* @return counter or NULL if the table is full
+*/
+static AK_trace_counter *AK_trace_counter_of(const char *func_name){
+    AK_trace_thread *self = AK_trace_self;
+    AK_trace_counter *counter;
+    if (self == NULL){
+        self = calloc(1, sizeof(AK_trace_thread));
+        if (self == NULL){
+            return NULL;
+        }
+        pthread_mutex_lock(&AK_trace_threads_mutex);
+        self->next = AK_trace_threads;
+        AK_trace_threads = self;
+        pthread_mutex_unlock(&AK_trace_threads_mutex);
+        AK_trace_self = self;
+    }
+    counter = AK_trace_slot(self, func_name);
+    if (counter != NULL && counter->func == NULL){
+        counter->func = func_name;
+    }
+    return counter;
+}
+
+/**
+* @param func_name function name as in source
+* @brief Not for direct use (only with macro AK_PRO in sampling mode). Counts
+*        the call in the counters of the calling thread and times every
+*        AK_TRACE_SAMPLE_PERIOD-th call
+* @return void
+*/
+void AK_trace_enter(const char *func_name){
+    AK_trace_counter *counter;
+    AK_trace_thread *self;
+    if (!AK_trace_enabled || (counter = AK_trace_counter_of(func_name)) == NULL){
+        return;
+    }
+    self = AK_trace_self;
+    counter->calls++;
+    if (self->depth < AK_TRACE_DEPTH){
+        self->stack[self->depth].func = func_name;
+        self->stack[self->depth].start =
+            counter->calls % AK_TRACE_SAMPLE_PERIOD == 1 ? AK_trace_now() : 0;
+        self->depth++;
+    }
+}
+
+/**
+* @param func_name function name as in source
+* @brief Not for direct use (only with macro AK_EPI in sampling mode). Adds
+*        the time of a timed call to the counters of the calling thread
+* @return void
+*/
+void AK_trace_leave(const char *func_name){
+    AK_trace_thread *self = AK_trace_self;
+    AK_trace_counter *counter;
+    int i;
+    if (self == NULL){
+        return;
+    }
+    /// frames above the function belong to callees that returned without AK_EPI
+    for (i = self->depth - 1; i >= 0 && self->stack[i].func != func_name; --i);
+    if (i < 0){
+        return;
+    }
+    self->depth = i;
+    if (self->stack[i].start != 0 && (counter = AK_trace_counter_of(func_name)) != NULL){
+        counter->timed++;
+        counter->time_ns += AK_trace_now() - self->stack[i].start;
+    }
+}
+
+/**
+* @param enabled zero to stop counting, nonzero to count again
+* @brief Switches sampling mode counting on or off at runtime [public function]
+* @return void
+*/
+void AK_trace_set_enabled(int enabled){
+    AK_trace_enabled = enabled;
+}
+
+/**
+* @brief Sets the counters of all threads to zero [public function]
+* @return void
+*/
+void AK_trace_reset(){
+    AK_trace_thread *thread;
+    pthread_mutex_lock(&AK_trace_threads_mutex);
+    for (thread = AK_trace_threads; thread != NULL; thread = thread->next){
+        memset(thread->slot, 0, sizeof(thread->slot));
+    }
+    pthread_mutex_unlock(&AK_trace_threads_mutex);
+}
+
+/**
+* @param func_name function name
+* @param counter counter to fill with the totals of all threads
+* @brief Gets the call count and time of a function [public function]
+* @return EXIT_SUCCESS if the function has been called, EXIT_ERROR otherwise
+*/
+int AK_trace_get(const char *func_name, AK_trace_counter *counter){
+    AK_trace_thread *thread;
+    int i;
+    memset(counter, 0, sizeof(AK_trace_counter));
+    counter->func = func_name;
+    pthread_mutex_lock(&AK_trace_threads_mutex);
+    for (thread = AK_trace_threads; thread != NULL; thread = thread->next){
+        for (i = 0; i < AK_TRACE_SLOTS; ++i){
+            if (thread->slot[i].func != NULL && strcmp(thread->slot[i].func, func_name) == 0){
+                counter->calls += thread->slot[i].calls;
+                counter->timed += thread->slot[i].timed;
+                counter->time_ns += thread->slot[i].time_ns;
+            }
+        }
+    }
+    pthread_mutex_unlock(&AK_trace_threads_mutex);
+    return counter->calls > 0 ? EXIT_SUCCESS : EXIT_ERROR;
+}
+
+/**
+* @param out stream to write to
+* @brief Writes "function calls time_us" for every called function, the
+*        time estimated from the timed calls [public function]
+* @return number of functions written
+*/
+int AK_trace_export(FILE *out){
+    AK_trace_thread *thread, *other;
+    AK_trace_counter total, *counter;
+    int i, written = 0;
+    pthread_mutex_lock(&AK_trace_threads_mutex);
+    for (thread = AK_trace_threads; thread != NULL; thread = thread->next){
+        for (i = 0; i < AK_TRACE_SLOTS; ++i){
+            if (thread->slot[i].func == NULL || thread->slot[i].calls == 0){
+                continue;
+            }
+            /// a function is written once, with the first thread of the list that called it
+            for (other = AK_trace_threads; other != thread; other = other->next){
+                counter = AK_trace_slot(other, thread->slot[i].func);
+                if (counter != NULL && counter->func != NULL && counter->calls > 0){
+                    break;
+                }
+            }
+            if (other != thread){
+                continue;
+            }
+            memset(&total, 0, sizeof(total));
+            for (other = thread; other != NULL; other = other->next){
+                counter = AK_trace_slot(other, thread->slot[i].func);
+                if (counter != NULL && counter->func != NULL){
+                    total.calls += counter->calls;
+                    total.timed += counter->timed;
+                    total.time_ns += counter->time_ns;
+                }
+            }
+            fprintf(out, "%s %lu %.3f\n", thread->slot[i].func, total.calls,
+                total.timed > 0 ? (double)total.time_ns * total.calls / total.timed / 1000.0 : 0.0);
+            written++;
+        }
+    }
+    pthread_mutex_unlock(&AK_trace_threads_mutex);
+    return written;
+}
+
 #if 0
 /* Dummy versions of wrapper functions */
 void* AK_calloc(size_t num, size_t size) { return calloc(num, size); }
@@ -1040,6 +1402,18 @@ size_t AK_fwrite(const void *buf, size_t size, size_t count, FILE *fp) {
 size_t AK_fread(void *buf, size_t size, size_t count, FILE *fp) {
     return fread(buf, size, count, fp);
 }
+ssize_t AK_pwrite(int fd, const void *buf, size_t count, off_t offset) {
+    return pwrite(fd, buf, count, offset);
+}
+ssize_t AK_pread(int fd, void *buf, size_t count, off_t offset) {
+    return pread(fd, buf, count, offset);
+}
+ssize_t AK_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t offset) {
+    return pwritev(fd, iov, iovcnt, offset);
+}
+ssize_t AK_preadv(int fd, const struct iovec *iov, int iovcnt, off_t offset) {
+    return preadv(fd, iov, iovcnt, offset);
+}
 void AK_debmod_function_epilogue(const char *func_name,
     const char *source_file, int source_line) { }
 void AK_debmod_function_prologue(const char *func_name,
@@ -1104,6 +1478,42 @@ void AK_mempro_test()
         failed_test++;
     }
 
+    printf("\nFunction tracing test\nCount three calls of a function, one of them nested, and one call while counting is off\n");
+    {
+        static const char probe[] = "AK_trace_probe";
+        AK_trace_counter counter;
+        FILE *out;
+        AK_trace_enter(probe);
+        AK_trace_enter(probe);
+        AK_trace_leave(probe);
+        AK_trace_leave(probe);
+        AK_trace_enter(probe);
+        AK_trace_leave(probe);
+        AK_trace_set_enabled(0);
+        AK_trace_enter(probe);
+        AK_trace_leave(probe);
+        AK_trace_set_enabled(1);
+        out = tmpfile();
+        if (AK_trace_get(probe, &counter) == EXIT_SUCCESS && counter.calls == 3 && counter.timed == 1
+            && out != NULL && AK_trace_export(out) >= 1) {
+            printf("SUCCESS\n");
+            passed_test++;
+        } else {
+            printf("FAIL\n");
+            failed_test++;
+        }
+        if (out != NULL)
+            fclose(out);
+        AK_trace_reset();
+        if (AK_trace_get(probe, &counter) == EXIT_ERROR) {
+            printf("SUCCESS\n");
+            passed_test++;
+        } else {
+            printf("FAIL\n");
+            failed_test++;
+        }
+    }
+
     printf("\nSUMMARY:\n");
     printf("Number of test that pass: %i\n", passed_test);
     printf("Number of test that fail: %i\n", failed_test);
@@ -47,6 +47,7 @@ memory wrappers and debug mode of Kalashnikov DB.
 #include <pthread.h>
 #include <signal.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 #endif
 
 #include <stdio.h>
@@ -103,21 +104,82 @@ memory wrappers and debug mode of Kalashnikov DB.
 #define __func__ __FUNCTION__
 #endif
 
+/**
+  * @def AK_TRACE_OFF
+  * @brief AK_TRACE_MODE in which AK_PRO and AK_EPI compile to nothing
+  */
+#define AK_TRACE_OFF 0
+
+/**
+  * @def AK_TRACE_SAMPLING
+  * @brief AK_TRACE_MODE in which AK_PRO and AK_EPI count calls and sample
+  *        the time spent in every function, per thread and without locks
+  */
+#define AK_TRACE_SAMPLING 1
+
+/**
+  * @def AK_TRACE_FULL
+  * @brief AK_TRACE_MODE in which AK_PRO and AK_EPI run the debug mode
+  *        function tracking (global lock and function name lookup)
+  */
+#define AK_TRACE_FULL 2
+
+/**
+  * @def AK_TRACE_MODE
+  * @brief Function tracing done by AK_PRO and AK_EPI, can be set at build
+  *        time with -DAK_TRACE_MODE=1. Defaults to full tracing when the
+  *        debug mode is on and to no tracing otherwise.
+  */
+#ifndef AK_TRACE_MODE
+#if AK_DEBMOD_ON
+#define AK_TRACE_MODE AK_TRACE_FULL
+#else
+#define AK_TRACE_MODE AK_TRACE_OFF
+#endif
+#endif
+
+/**
+  * @def AK_TRACE_SLOTS
+  * @brief Defines the number of functions counted per thread in sampling
+  *        mode (power of two)
+  */
+#define AK_TRACE_SLOTS 2048
+
+/**
+  * @def AK_TRACE_DEPTH
+  * @brief Defines the call depth followed per thread in sampling mode
+  */
+#define AK_TRACE_DEPTH 256
+
+/**
+  * @def AK_TRACE_SAMPLE_PERIOD
+  * @brief Every AK_TRACE_SAMPLE_PERIOD-th call of a function is timed in
+  *        sampling mode
+  */
+#define AK_TRACE_SAMPLE_PERIOD 16
+
 /**
   * @def AK_PRO
   * @brief Mandatory function prologue for all functions (AK_debmod and
   *        related functions are excluded). Put this macro after variable
   *        declarations, before any function instruction.
   */
-#define AK_PRO AK_debmod_function_prologue(__func__, __FILE__, __LINE__);
-
 /**
   * @def AK_EPI
   * @brief Mandatory function epilogue for all functions (AK_debmod and
   *        related functions are excluded). Put this macro after last
   *        function instruction, before every return statement.
   */
+#if AK_TRACE_MODE == AK_TRACE_FULL
+#define AK_PRO AK_debmod_function_prologue(__func__, __FILE__, __LINE__);
 #define AK_EPI AK_debmod_function_epilogue(__func__, __FILE__, __LINE__);
+#elif AK_TRACE_MODE == AK_TRACE_SAMPLING
+#define AK_PRO AK_trace_enter(__func__);
+#define AK_EPI AK_trace_leave(__func__);
+#else
+#define AK_PRO
+#define AK_EPI
+#endif
 
 #ifdef __linux__
 static pthread_mutex_t AK_debmod_critical_section = PTHREAD_MUTEX_INITIALIZER;
@@ -278,6 +340,46 @@ void AK_free(void*);
 */
 void* AK_realloc(void*, size_t);
 
+/**
+* @param fd file descriptor
+* @param buf buffer to write from
+* @param count number of bytes to write
+* @param offset absolute position in the file
+* @brief Write to a file descriptor at a given offset (see pwrite) [public function]
+* @return number of bytes written, -1 on error
+*/
+ssize_t AK_pwrite(int, const void*, size_t, off_t);
+
+/**
+* @param fd file descriptor
+* @param buf buffer to read into
+* @param count number of bytes to read
+* @param offset absolute position in the file
+* @brief Read from a file descriptor at a given offset (see pread) [public function]
+* @return number of bytes read, -1 on error
+*/
+ssize_t AK_pread(int, void*, size_t, off_t);
+
+/**
+* @param fd file descriptor
+* @param iov buffers to write from
+* @param iovcnt number of buffers
+* @param offset absolute position in the file
+* @brief Write several buffers to consecutive positions of a file descriptor (see pwritev) [public function]
+* @return number of bytes written, -1 on error
+*/
+ssize_t AK_pwritev(int, const struct iovec*, int, off_t);
+
+/**
+* @param fd file descriptor
+* @param iov buffers to read into
+* @param iovcnt number of buffers
+* @param offset absolute position in the file
+* @brief Read consecutive positions of a file descriptor into several buffers (see preadv) [public function]
+* @return number of bytes read, -1 on error
+*/
+ssize_t AK_preadv(int, const struct iovec*, int, off_t);
+
 /**
 * @author Marin Rukavina, Mislav Bozicevic
 * @param memory
@@ -413,6 +515,66 @@ void AK_print_function_uses();
 */
 void AK_print_active_functions();
 
+/**
+  * @brief Call count and time spent in one function, collected by AK_PRO
+  *        and AK_EPI in sampling mode
+  */
+typedef struct {
+    /// function name (__func__ of the function)
+    const char *func;
+    /// number of calls
+    unsigned long calls;
+    /// number of calls that have been timed
+    unsigned long timed;
+    /// nanoseconds spent in the timed calls, callees included
+    unsigned long long time_ns;
+} AK_trace_counter;
+
+/**
+* @param func_name function name as in source
+* @brief Not for direct use (only with macro AK_PRO in sampling mode). Counts
+*        the call in the counters of the calling thread
+* @return void
+*/
+void AK_trace_enter(const char *);
+
+/**
+* @param func_name function name as in source
+* @brief Not for direct use (only with macro AK_EPI in sampling mode). Adds
+*        the time of a timed call to the counters of the calling thread
+* @return void
+*/
+void AK_trace_leave(const char *);
+
+/**
+* @param enabled zero to stop counting, nonzero to count again
+* @brief Switches sampling mode counting on or off at runtime [public function]
+* @return void
+*/
+void AK_trace_set_enabled(int);
+
+/**
+* @brief Sets the counters of all threads to zero [public function]
+* @return void
+*/
+void AK_trace_reset();
+
+/**
+* @param func_name function name
+* @param counter counter to fill with the totals of all threads
+* @brief Gets the call count and estimated time of a function [public function]
+* @return EXIT_SUCCESS if the function has been called, EXIT_ERROR otherwise
+*/
+int AK_trace_get(const char *, AK_trace_counter *);
+
+/**
+* @param out stream to write to
+* @brief Writes "function calls time_us" for every called function, time
+*        estimated from the timed calls [public function]
+* @return number of functions written
+*/
+int AK_trace_export(FILE *);
+
 void AK_mempro_test();
 
 #endif
@@ -27,6 +27,281 @@
 #include "../mm/memoman.h"
 pthread_mutex_t fileLockMutex = PTHREAD_MUTEX_INITIALIZER;
 
+/**
+ * @var AK_db_fd
+ * @brief File descriptor of the DB file. The file is opened once (AK_open_db_file) and all block
+ * reads and writes go through positional I/O on it, so there is no shared file position to guard.
+ */
+static int AK_db_fd = -1;
+
+/**
+ * @var AK_db_fd_mutex
+ * @brief Guards opening and closing of AK_db_fd
+ */
+static pthread_mutex_t AK_db_fd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief  Function that opens the DB file (creating it if it does not exist) and keeps its
+ * descriptor open until AK_close_db_file is called. Calling it again while the file is open does nothing.
+ * @return EXIT_SUCCESS if the file is open, EXIT_ERROR otherwise
+ */
+int
+AK_open_db_file()
+{
+  AK_PRO;
+  pthread_mutex_lock(&AK_db_fd_mutex);
+  if (AK_db_fd == -1)
+    {
+      AK_db_fd = open(DB_FILE, O_RDWR | O_CREAT, 0644);
+    }
+  pthread_mutex_unlock(&AK_db_fd_mutex);
+
+  if (AK_db_fd == -1)
+    {
+      printf("AK_open_db_file: ERROR. Cannot open db file %s.\n", DB_FILE);
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that closes the DB file descriptor opened by AK_open_db_file
+ * @return nothing
+ */
+void
+AK_close_db_file()
+{
+  AK_PRO;
+  pthread_mutex_lock(&AK_db_fd_mutex);
+  if (AK_db_fd != -1)
+    {
+      close(AK_db_fd);
+      AK_db_fd = -1;
+    }
+  pthread_mutex_unlock(&AK_db_fd_mutex);
+  AK_EPI;
+}
+
+/**
+ * @brief  Function that returns the DB file descriptor, opening the file first if needed
+ * @return file descriptor of the DB file; exits the program if the file cannot be opened
+ */
+int
+AK_get_db_fd()
+{
+  AK_PRO;
+  if (AK_db_fd == -1 && AK_open_db_file() == EXIT_ERROR)
+    {
+      AK_EPI;
+      exit(EXIT_ERROR);
+    }
+  AK_EPI;
+  return AK_db_fd;
+}
+
+/**
+ * @brief  Function that reads exactly size bytes from the DB file at the given offset,
+ * retrying short and interrupted reads
+ * @param buffer caller-owned buffer to read into
+ * @param size number of bytes to read
+ * @param offset absolute offset in the DB file
+ * @return EXIT_SUCCESS if all bytes were read, EXIT_ERROR otherwise
+ */
+int
+AK_db_pread(void *buffer, size_t size, off_t offset)
+{
+  size_t done = 0;
+  ssize_t n;
+  int fd = AK_get_db_fd();
+  AK_PRO;
+  while (done < size)
+    {
+      n = AK_pread(fd, (char *)buffer + done, size - done, offset + done);
+      if (n == -1 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	{
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      done += n;
+    }
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that writes exactly size bytes to the DB file at the given offset,
+ * retrying short and interrupted writes
+ * @param buffer caller-owned buffer to write from
+ * @param size number of bytes to write
+ * @param offset absolute offset in the DB file
+ * @return EXIT_SUCCESS if all bytes were written, EXIT_ERROR otherwise
+ */
+int
+AK_db_pwrite(const void *buffer, size_t size, off_t offset)
+{
+  size_t done = 0;
+  ssize_t n;
+  int fd = AK_get_db_fd();
+  AK_PRO;
+  while (done < size)
+    {
+      n = AK_pwrite(fd, (const char *)buffer + done, size - done, offset + done);
+      if (n == -1 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	{
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      done += n;
+    }
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that returns the current size of the DB file
+ * @return size of the DB file in bytes
+ */
+off_t
+AK_db_file_size()
+{
+  struct stat stats;
+  AK_PRO;
+  if (fstat(AK_get_db_fd(), &stats) != 0)
+    {
+      AK_EPI;
+      return 0;
+    }
+  AK_EPI;
+  return stats.st_size;
+}
+
+/**
+ * @brief  Function that reads consecutive positions of the DB file into several buffers
+ * with vectored positional reads, retrying short and interrupted reads
+ * @param iov buffers to read into
+ * @param iovcnt number of buffers
+ * @param offset absolute offset in the DB file of the first buffer
+ * @return EXIT_SUCCESS if all bytes were read, EXIT_ERROR otherwise
+ */
+int
+AK_db_preadv(const struct iovec *iov, int iovcnt, off_t offset)
+{
+  ssize_t n;
+  size_t rest;
+  int fd = AK_get_db_fd();
+  AK_PRO;
+  while (iovcnt > 0)
+    {
+      n = AK_preadv(fd, iov, iovcnt > AK_IOV_BATCH ? AK_IOV_BATCH : iovcnt, offset);
+      if (n == -1 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	{
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      offset += n;
+      /* skip the buffers that were filled completely */
+      while (iovcnt > 0 && (size_t)n >= iov->iov_len)
+	{
+	  n -= iov->iov_len;
+	  iov++;
+	  iovcnt--;
+	}
+      /* finish a partially filled buffer on its own */
+      if (n > 0)
+	{
+	  rest = iov->iov_len - n;
+	  if (AK_db_pread((char *)iov->iov_base + n, rest, offset) != EXIT_SUCCESS)
+	    {
+	      AK_EPI;
+	      return EXIT_ERROR;
+	    }
+	  offset += rest;
+	  iov++;
+	  iovcnt--;
+	}
+    }
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that writes several buffers to consecutive positions of the DB file
+ * with vectored positional writes, retrying short and interrupted writes
+ * @param iov buffers to write
+ * @param iovcnt number of buffers
+ * @param offset absolute offset in the DB file of the first buffer
+ * @return EXIT_SUCCESS if all bytes were written, EXIT_ERROR otherwise
+ */
+int
+AK_db_pwritev(const struct iovec *iov, int iovcnt, off_t offset)
+{
+  ssize_t n;
+  size_t skip;
+  int fd = AK_get_db_fd();
+  AK_PRO;
+  while (iovcnt > 0)
+    {
+      n = AK_pwritev(fd, iov, iovcnt > AK_IOV_BATCH ? AK_IOV_BATCH : iovcnt, offset);
+      if (n == -1 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	{
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      offset += n;
+      /* skip the buffers that were written completely */
+      while (iovcnt > 0 && (size_t)n >= iov->iov_len)
+	{
+	  n -= iov->iov_len;
+	  iov++;
+	  iovcnt--;
+	}
+      /* finish a partially written buffer on its own */
+      if (n > 0)
+	{
+	  skip = iov->iov_len - n;
+	  if (AK_db_pwrite((const char *)iov->iov_base + n, skip, offset) != EXIT_SUCCESS)
+	    {
+	      AK_EPI;
+	      return EXIT_ERROR;
+	    }
+	  offset += skip;
+	  iov++;
+	  iovcnt--;
+	}
+    }
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that forces everything written to the DB file to stable storage
+ * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
+ */
+int
+AK_db_fsync()
+{
+  int fd = AK_get_db_fd();
+  AK_PRO;
+  if (fsync(fd) != 0)
+    {
+      printf("AK_db_fsync: ERROR. Cannot sync DB file: %s\n", strerror(errno));
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
 
 /**
 * @author Markus Schatten
@@ -42,7 +317,7 @@ int
 AK_init_db_file(int size)
 {
     printf("\nInitialization\n");
-    int sizeOfFile;
+    off_t sizeOfFile;
     AK_PRO;
     AK_dbg_messg(HIGH, DB_MAN, "AK_block: %i, AK_header: %i, AK_tuple_dict: %i , char: %i, int: %i\n",
 		 sizeof(AK_block), sizeof(AK_header), sizeof(AK_tuple_dict), sizeof(char), sizeof(int));
@@ -51,22 +326,19 @@ AK_init_db_file(int size)
 
     AK_blocktable* const allocationBit = AK_allocationbit.ptr;
 
-    if ((db.ptr = fopen(DB_FILE, "rb+")) == NULL)
+    if (AK_open_db_file() == EXIT_ERROR)
       {
-        printf("AK_init_db_file: ERROR. Cannot open db file %s.\n", DB_FILE);
         AK_EPI;
         exit(EXIT_ERROR);
       }
 
-    sizeOfFile = fsize(db.ptr);
-    printf("AK_init_db_file: size db file %d. --- %d ---- %d\n", sizeOfFile, AK_ALLOCATION_TABLE_SIZE, allocationBit->last_initialized);
+    sizeOfFile = AK_db_file_size();
+    printf("AK_init_db_file: size db file %ld. --- %d ---- %d\n", (long)sizeOfFile, AK_ALLOCATION_TABLE_SIZE, allocationBit->last_initialized);
     
     
     if (sizeOfFile > AK_ALLOCATION_TABLE_SIZE)
       {
         printf("AK_init_db_file: Already initialized.\n");
-        fclose(db.ptr);
-	      db.ptr = NULL;
         AK_EPI;
         return (EXIT_SUCCESS);
       }
@@ -75,7 +347,7 @@ AK_init_db_file(int size)
 	   "\nPlease be patient, this can take several minutes depending "
 	   "on disk performance.\n");
 
-    if(AK_allocate_blocks(db.ptr, AK_init_block(), 0, MAX_BLOCK_INIT_NUM) != EXIT_SUCCESS)
+    if(AK_allocate_blocks(AK_init_block(), 0, MAX_BLOCK_INIT_NUM) != EXIT_SUCCESS)
       {
         printf("AK_init_db_file: ERROR. Problem with blocks allocation %s.\n", DB_FILE);
         AK_EPI;
@@ -419,16 +691,9 @@ int
 AK_blocktable_flush()
 {
   AK_PRO;
-  if ((db.ptr = fopen(DB_FILE, "rb+")) == NULL)
-    {
-      printf("AK_allocationbit: ERROR. Cannot open db file %s.\n", DB_FILE);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
-
   pthread_mutex_lock(&fileLockMutex);
   
-  if (AK_fwrite(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 1, db.ptr) != 1)
+  if (AK_db_pwrite(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 0) != EXIT_SUCCESS)
     {
       printf("AK_allocationbit: ERROR. Cannot write bit vector \n");
       AK_EPI;
@@ -436,8 +701,6 @@ AK_blocktable_flush()
     }
   pthread_mutex_unlock(&fileLockMutex);
 
-  fclose(db.ptr);
-  db.ptr = NULL;
   AK_EPI;
   
   return(EXIT_SUCCESS);
@@ -489,25 +752,15 @@ int
 AK_blocktable_get()
 {
   AK_PRO;
-  if ((db.ptr = fopen(DB_FILE, "rb+")) == NULL)
-    {
-      printf("AK_allocationbit: ERROR. Cannot open db file %s.\n", DB_FILE);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
-
   pthread_mutex_lock(&fileLockMutex);
   
-  if (AK_fread(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 1, db.ptr) == 0)
+  if (AK_db_pread(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 0) != EXIT_SUCCESS)
     {
       printf("AK_allocationbit:  Cannot read bit-vector %d.\n", AK_ALLOCATION_TABLE_SIZE);
       AK_EPI;
       exit(EXIT_ERROR);
     }
   pthread_mutex_unlock(&fileLockMutex);
-  
-  fclose(db.ptr);
-  db.ptr = NULL;
 
   AK_EPI;
   return (EXIT_SUCCESS);
@@ -554,7 +807,8 @@ fsize(FILE *fp)
  */
 int
 AK_init_allocation_table() {
-  int i, fileSizeBytes;
+  int i;
+  off_t fileSizeBytes;
   AK_PRO;
   if ((AK_allocationbit.ptr = (AK_blocktable *)AK_malloc(sizeof(AK_blocktable))) == NULL) {
     printf("AK_allocationbit: ERROR. Cannot allocate  bit vector \n");
@@ -562,15 +816,12 @@ AK_init_allocation_table() {
     exit(EXIT_ERROR);
   }
 
-  if ((db.ptr = fopen(DB_FILE, "rb+")) == NULL) {
-    if ((db.ptr = fopen(DB_FILE, "wb+")) == NULL) {
-	    printf("AK_allocationbit: ERROR. Cannot open db file %s.\n", DB_FILE);
-	    AK_EPI;
-	    exit(EXIT_ERROR);
-	  }
+  if (AK_open_db_file() == EXIT_ERROR) {
+    AK_EPI;
+    exit(EXIT_ERROR);
   }
 
-  fileSizeBytes = fsize(db.ptr);
+  fileSizeBytes = AK_db_file_size();
 
   pthread_mutex_lock(&fileLockMutex);
   if (fileSizeBytes == 0) {
@@ -584,20 +835,17 @@ AK_init_allocation_table() {
     allocationBit->prepared         = 0;
     allocationBit->ltime            = time(NULL);
 
-    if (AK_fwrite(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 1, db.ptr) != 1) {
+    if (AK_db_pwrite(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 0) != EXIT_SUCCESS) {
       printf("AK_allocationbit: ERROR. Cannot write bit vector \n");
       AK_EPI;
       exit(EXIT_ERROR);
     }
-    pthread_mutex_unlock(&fileLockMutex);
-  } else if (AK_fread(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 1, db.ptr) == 0) {
+  } else if (AK_db_pread(AK_allocationbit.ptr, AK_ALLOCATION_TABLE_SIZE, 0) != EXIT_SUCCESS) {
     printf("AK_allocationbit:  Cannot read bit-vector %d.\n", AK_ALLOCATION_TABLE_SIZE);
     AK_EPI;
     exit(EXIT_ERROR);
   }
 
-  fclose(db.ptr);
-  db.ptr = NULL;
   pthread_mutex_unlock(&fileLockMutex);
 
   AK_EPI;
@@ -919,43 +1167,25 @@ AK_print_block(AK_block * block, int num, char* gg, FILE *fpp)
 * @return EXIT_SUCCESS if the file has been written to disk, EXIT_ERROR otherwise
 */
 int
-AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany)
+AK_allocate_blocks(AK_block * block, int FromWhere, int HowMany)
 {
   register int i = 0;
   AK_PRO;
-  if (db == NULL)
-    {
-      if ((db = fopen(DB_FILE, "rb+")) == NULL)
-	{
-	  printf("AK_init_db_file: ERROR. Cannot open db file %s.\n", DB_FILE);
-	  AK_EPI;
-	  return EXIT_ERROR;
-	} 
-    }
-    
     pthread_mutex_lock(&fileLockMutex);
-    if (fseek(db, AK_ALLOCATION_TABLE_SIZE + FromWhere * sizeof(AK_block), SEEK_SET) != 0)
-      {
-	printf("AK_allocationbit: ERROR. Cannot set position to move for AK_blocktable \n");
-	AK_EPI;
-	return EXIT_ERROR;      
-      }
-    
     for (i = FromWhere; i < FromWhere + HowMany; i++)
       {
         block->address = i;
 	
-        if (AK_fwrite(block, sizeof (*block), 1, db) != 1)
+        if (AK_db_pwrite(block, sizeof (*block), AK_ALLOCATION_TABLE_SIZE + (off_t)i * sizeof(AK_block)) != EXIT_SUCCESS)
 	  {
 	    printf("AK_init_db_file: ERROR. Cannot write block %d\n", i);
+	    pthread_mutex_unlock(&fileLockMutex);
 	    AK_EPI;
 	    return EXIT_ERROR;
 	  }
       }
     pthread_mutex_unlock(&fileLockMutex);
 
-    fclose(db);
-    db = NULL;
     AK_blocktable* const allocationBit = AK_allocationbit.ptr;
     allocationBit->last_initialized = i;
     AK_allocate_block_activity_modes();
@@ -992,14 +1222,15 @@ int test_threadSafeBlockAccessSucceeded = 1;
 
 /**
  * @author Markus Schatten, updated by dv and Domagoj Šitum (thread-safe enabled)
- * @brief  Function that reads a block at a given address (block number less than db_file_size).
- * New block is allocated. Database file is opened. Position is set to provided address block.
- * At the end function reads file from that position. Completely thread-safe.
+ * @brief  Function that reads a block at a given address (block number less than db_file_size)
+ * into a caller-owned buffer. The block is read with a single positional read from the
+ * already opened DB file. Completely thread-safe.
  * @param address block number (address)
- * @return pointer to block allocated in memory
+ * @param block buffer the block is read into
+ * @return EXIT_SUCCESS if the block has been read
  */
-AK_block*
-AK_read_block(int address)
+int
+AK_read_block_into(int address, AK_block *block)
 {
   AK_PRO;
   //TODO: line 999 needs variable names
@@ -1013,14 +1244,6 @@ AK_read_block(int address)
       AK_EPI;
       exit(EXIT_ERROR);
     }
-    
-  FILE * database;
-  if ((database = fopen(DB_FILE, "rb")) == NULL)
-    {
-      printf("AK_read_block: ERROR. Cannot open db file %s.\n", DB_FILE);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    } 
 
   AK_block_activity* const activityInfo = AK_block_activity_info.ptr;
 
@@ -1048,23 +1271,10 @@ AK_read_block(int address)
       activityInfo[address].locked_for_reading = true;
     }
     
-  // now we can safely write block to the disk
-    
-  // first we have to set position in file for reading new block
-  if (fseek(database, address * sizeof(AK_block)+AK_ALLOCATION_TABLE_SIZE, SEEK_SET) != 0)
-    {
-      printf("AK_read_block: ERROR. Cannot set position to provided address block %d.\n", address);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
-  //ERROR: a value of type "void *" cannot be used to initialize an entity of type "AK_block *"   
-  AK_block * block = AK_malloc(sizeof(AK_block));
-
-  // then we simply read block from the disk
-  if (AK_fread(block, sizeof(AK_block), 1, database) == 0)
+  // now we can safely read block from the disk
+  if (AK_db_pread(block, sizeof(AK_block), (off_t)address * sizeof(AK_block) + AK_ALLOCATION_TABLE_SIZE) != EXIT_SUCCESS)
     {
       printf("AK_read_block: ERROR. Cannot read block %d.\n", address);
-	  AK_free(block);
       AK_EPI;
       exit(EXIT_ERROR);
     }
@@ -1095,16 +1305,32 @@ AK_read_block(int address)
   if (activityInfo[address].thread_holding_lock == &thread_id) {
     pthread_mutex_unlock(&activityInfo[address].block_lock);
   }
-  fclose(database);
     
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @author Markus Schatten, updated by dv and Domagoj Šitum (thread-safe enabled)
+ * @brief  Function that reads a block at a given address (block number less than db_file_size).
+ * New block is allocated and filled by AK_read_block_into. Completely thread-safe.
+ * @param address block number (address)
+ * @return pointer to block allocated in memory
+ */
+AK_block*
+AK_read_block(int address)
+{
+  AK_PRO;
+  AK_block * block = AK_malloc(sizeof(AK_block));
+  AK_read_block_into(address, block);
   AK_EPI;
   return block;
 }
 
 /**
 * @author Markus Schatten, updated by Domagoj Šitum (thread-safe enabled)
-* @brief  Function that writes a block to the DB file. Database file is opened. Position is set to provided address block. Block is
-  written to provided address. Completely thread-safe.
+* @brief  Function that writes a block to the DB file with a single positional write at the block's address.
+  The DB file stays open between calls. Completely thread-safe.
 * @param block poiner to block allocated in memory to write
 * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
 */
@@ -1116,14 +1342,6 @@ AK_write_block(AK_block * block)
   int true = 1, false = 0;
   int locked_for_reading = false, locked_for_writing = false, address;
   int thread_id;
-
-  FILE * database;
-  if ((database = fopen(DB_FILE, "rb+")) == NULL)
-    {
-      printf("AK_write_block: ERROR. Cannot open db file %s.\n", DB_FILE);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
     
   // first we have to find out block's address
   address = block->address;
@@ -1170,17 +1388,7 @@ AK_write_block(AK_block * block)
     }
     
   // now we can safely write it to the disk
-
-  // first we have to set position in file for new block writing
-  if (fseek(database, block->address * sizeof(AK_block)+AK_ALLOCATION_TABLE_SIZE, SEEK_SET) != 0)
-    {
-      printf("AK_write_block: ERROR. Cannot set position to provided address block %d.\n", block->address);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
-
-  // then we simply write block to the disk
-  if (AK_fwrite(block, sizeof (*block), 1, database) != 1)
+  if (AK_db_pwrite(block, sizeof (*block), (off_t)address * sizeof(AK_block) + AK_ALLOCATION_TABLE_SIZE) != EXIT_SUCCESS)
     {
       printf("AK_write_block: ERROR. Cannot write block at provided address %d.\n", block->address);
       AK_EPI;
@@ -1199,12 +1407,102 @@ AK_write_block(AK_block * block)
       pthread_mutex_unlock(&activityInfo[address].block_lock);
     }
     
-  fclose(database);
-    
   AK_EPI;
   return (EXIT_SUCCESS);
 }
 
+/**
+ * @brief  Function that reads blocks with consecutive addresses from the DB file with one vectored
+ * read. Every block stays locked for the duration of the read. Completely thread-safe.
+ * @param address address of the first block
+ * @param blocks caller-owned blocks to read into, blocks[i] receives block address + i
+ * @param count number of blocks
+ * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
+ */
+int
+AK_read_blocks_into(int address, AK_block **blocks, int count)
+{
+  int i;
+  struct iovec *iov;
+  AK_PRO;
+  if (count <= 0)
+    {
+      AK_EPI;
+      return EXIT_SUCCESS;
+    }
+  if (DB_FILE_BLOCKS_NUM < address + count - 1 || 0 > address)
+    {
+      printf("AK_read_blocks_into: ERROR. Out of range %s  address:%d - %d  DB_FILE_BLOCKS_NUM:%lu\n", DB_FILE, address, address + count - 1, DB_FILE_BLOCKS_NUM);
+      AK_EPI;
+      exit(EXIT_ERROR);
+    }
+  AK_block_activity* const activityInfo = AK_block_activity_info.ptr;
+  iov = (struct iovec *) AK_malloc(count * sizeof(struct iovec));
+  // block locks are always taken in ascending address order, so two runs cannot deadlock
+  for (i = 0; i < count; i++)
+    {
+      pthread_mutex_lock(&activityInfo[address + i].block_lock);
+      iov[i].iov_base = blocks[i];
+      iov[i].iov_len = sizeof(AK_block);
+    }
+
+  if (AK_db_preadv(iov, count, (off_t)address * sizeof(AK_block) + AK_ALLOCATION_TABLE_SIZE) != EXIT_SUCCESS)
+    {
+      printf("AK_read_blocks_into: ERROR. Cannot read blocks %d - %d.\n", address, address + count - 1);
+      AK_EPI;
+      exit(EXIT_ERROR);
+    }
+
+  for (i = count - 1; i >= 0; i--)
+    pthread_mutex_unlock(&activityInfo[address + i].block_lock);
+  AK_free(iov);
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that writes blocks with consecutive addresses to the DB file with one vectored
+ * write. Every block stays locked for the duration of the write. Completely thread-safe.
+ * @param blocks blocks to write, blocks[i]->address must be blocks[0]->address + i
+ * @param count number of blocks
+ * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
+ */
+int
+AK_write_blocks(AK_block **blocks, int count)
+{
+  int i, first;
+  struct iovec *iov;
+  AK_PRO;
+  if (count <= 0)
+    {
+      AK_EPI;
+      return EXIT_SUCCESS;
+    }
+  first = blocks[0]->address;
+  AK_block_activity* const activityInfo = AK_block_activity_info.ptr;
+  iov = (struct iovec *) AK_malloc(count * sizeof(struct iovec));
+  // block locks are always taken in ascending address order, so two runs cannot deadlock
+  for (i = 0; i < count; i++)
+    {
+      pthread_mutex_lock(&activityInfo[first + i].block_lock);
+      iov[i].iov_base = blocks[i];
+      iov[i].iov_len = sizeof(AK_block);
+    }
+
+  if (AK_db_pwritev(iov, count, (off_t)first * sizeof(AK_block) + AK_ALLOCATION_TABLE_SIZE) != EXIT_SUCCESS)
+    {
+      printf("AK_write_blocks: ERROR. Cannot write blocks %d - %d.\n", first, first + count - 1);
+      AK_EPI;
+      exit(EXIT_ERROR);
+    }
+
+  for (i = count - 1; i >= 0; i--)
+    pthread_mutex_unlock(&activityInfo[first + i].block_lock);
+  AK_free(iov);
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
 
 
 
@@ -1333,7 +1631,7 @@ AK_get_extent(int start_address, int desired_size, AK_allocation_set_mode* mode,
 	{
 	  //there is no space at current boundaries - try to get more
     AK_blocktable* const allocationBit = AK_allocationbit.ptr;
-	  if (AK_allocate_blocks(NULL, AK_init_block(), allocationBit->last_initialized, desired_size) != EXIT_SUCCESS)
+	  if (AK_allocate_blocks(AK_init_block(), allocationBit->last_initialized, desired_size) != EXIT_SUCCESS)
 	    {
 	      printf("AK_new_extent E1: ERROR. Problem with blocks allocation %s.\n", DB_FILE);
 	      AK_EPI;
@@ -1515,7 +1813,7 @@ AK_new_extent(int start_address, int old_size, int extent_type, AK_header *heade
   AK_blocktable* const allocationBit = AK_allocationbit.ptr;
   if (first_element_of_set == FREE_INT)
   {
-      	if (AK_allocate_blocks(NULL, block = AK_init_block(), allocationBit->last_initialized, requested_space_in_blocks) != EXIT_SUCCESS)
+      	if (AK_allocate_blocks(block = AK_init_block(), allocationBit->last_initialized, requested_space_in_blocks) != EXIT_SUCCESS)
 		{
 	  		AK_free(block);
 	  		printf("AK_new_extent: ERROR. Problem with blocks allocation %s.\n", DB_FILE);
@@ -1549,6 +1847,9 @@ AK_new_extent(int start_address, int old_size, int extent_type, AK_header *heade
   for (i = 0; i < requested_space_in_blocks; i++)
     {
       BITSET(allocationBit->bittable, allocation_set[i]);
+      AK_free_space_map_forget(allocation_set[i]);
+      AK_cache_forget_block(allocation_set[i]);
+      AK_block_changed(allocation_set[i]);
       if (i < (requested_space_in_blocks - 1))
 	allocationBit->allocationtable[allocation_set[i]] = allocation_set[i + 1];
     }
@@ -1598,6 +1899,8 @@ AK_new_segment(char * name, int type, AK_header *header)
       return (EXIT_ERROR);
     }
   
+  AK_invalidate_segment_addresses(name);
+
   AK_EPI;
   return first_allocated_block;
 }
@@ -1732,13 +2035,14 @@ AK_insert_entry(AK_block* block_address, int type, void* entry_data, int i)
  * @param constraintNull address of system table of constraintNull in db_file
  * @param constraintCheck system table address for check constraint
  * @param reference address of system table of reference in db_file
+ * @param statistics address of system table of statistics in db_file
  * @return EXIT_SUCCESS if initialization was succesful if not returns EXIT_ERROR
  */
 int
 AK_init_system_tables_catalog(int relation, int attribute, int index, int view, int sequence, int function, int function_arguments,
 			      int trigger, int trigger_conditions, int db, int db_obj, int user, int group, int user_group,
 			      int user_right, int group_right, int constraint, int constraintNull, int constraintCheck,
-			      int constraintUnique, int reference)
+			      int constraintUnique, int reference, int statistics)
 {
   AK_block*  catalog_block;
   AK_header* catalog_header_name;
@@ -1811,7 +2115,9 @@ AK_init_system_tables_catalog(int relation, int attribute, int index, int view,
   AK_insert_entry(catalog_block, TYPE_VARCHAR, "AK_constraints_unique", i++);
   AK_insert_entry(catalog_block, TYPE_INT, &constraintUnique, i++);
   AK_insert_entry(catalog_block, TYPE_VARCHAR, "AK_reference", i++);
-  AK_insert_entry(catalog_block, TYPE_INT, &reference, i);
+  AK_insert_entry(catalog_block, TYPE_INT, &reference, i++);
+  AK_insert_entry(catalog_block, TYPE_VARCHAR, "AK_statistics", i++);
+  AK_insert_entry(catalog_block, TYPE_INT, &statistics, i);
 
   catalog_block->last_tuple_dict_id = i;
 
@@ -1865,13 +2171,14 @@ void AK_memset_int(void *block, int value, size_t num) {
 * @param constraintNull Null constraint in database
 * @param constraintCheck Check constraint in database
 * @param reference reference database
+* @param statistics table and column statistics in database
 * @return EXIT_SUCCESS
 */
 int
 AK_register_system_tables(int relation, int attribute, int index, int view, int sequence, int function, int function_arguments,
 			  int trigger, int trigger_conditions, int db, int db_obj, int user, int group, int user_group,
 			  int user_right, int group_right, int constraint, int constraintNull, int constraintCheck,
-			  int constraintUnique, int reference)
+			  int constraintUnique, int reference, int statistics)
 {
     AK_block *relationTable;
     int i = 1, j = 0;
@@ -2044,6 +2351,13 @@ AK_register_system_tables(int relation, int attribute, int index, int view, int
     AK_insert_entry(relationTable, TYPE_VARCHAR, "AK_reference", j++);
     AK_insert_entry(relationTable, TYPE_INT, &reference, j++);
     end = reference + INITIAL_EXTENT_SIZE;
+    AK_insert_entry(relationTable, TYPE_INT, &end, j++);
+    i++;
+
+    AK_insert_entry(relationTable, TYPE_INT, &i, j++);
+    AK_insert_entry(relationTable, TYPE_VARCHAR, "AK_statistics", j++);
+    AK_insert_entry(relationTable, TYPE_INT, &statistics, j++);
+    end = statistics + INITIAL_EXTENT_SIZE;
     AK_insert_entry(relationTable, TYPE_INT, &end, j);
     i++;
 
@@ -2064,7 +2378,8 @@ int
 AK_init_system_catalog()
 {
   int relation, attribute, index, view, sequence, function, function_arguments, trigger, trigger_conditions, db, db_obj,
-    user, group, user_group, user_right, group_right, constraint, constraintNull, constraintCheck, constraintUnique, reference;
+    user, group, user_group, user_right, group_right, constraint, constraintNull, constraintCheck, constraintUnique, reference,
+    statistics;
   int i;
   AK_PRO;
     
@@ -2074,9 +2389,9 @@ AK_init_system_catalog()
     {
       { TYPE_INT,     "obj_id",    { 0 }, { { '\0' } }, { { '\0' } } },
       { TYPE_VARCHAR, "tableName", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "constraintName", 0, '\0', '\0' },
-      { TYPE_VARCHAR, "attributeName", 0, '\0', '\0' },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "constraintName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "attributeName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hConstraintCheck[8] =
@@ -2088,183 +2403,197 @@ AK_init_system_catalog()
       { TYPE_INT,     "constraint_value_type", { 0 }, { { '\0' } }, { { '\0' } } },
       { TYPE_VARCHAR, "constraint_condition", { 0 }, { { '\0' } }, { { '\0' } } },
       { TYPE_VARCHAR, "constraint_value", { 0 }, { { '\0' } }, { { '\0' } } },
-      { 0, '\0', 0, '\0', '\0' }
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hConstraintUnique[5] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "tableName", 0, '\0', '\0' },
-      { TYPE_VARCHAR, "constraintName", 0, '\0', '\0' },
-      { TYPE_VARCHAR, "attributeName", 0, '\0', '\0' },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "tableName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "constraintName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "attributeName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
 
   AK_header hConstraintBetween[7] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "tableName", 0, '\0', '\0' },
-      { TYPE_VARCHAR, "constraintName", 0, '\0', '\0' },
-      { TYPE_VARCHAR, "attributeName", 0, '\0', '\0' },
-      { TYPE_VARCHAR, "start_value", 0, '\0', '\0' },
-      { TYPE_VARCHAR, "end_value", 0, '\0', '\0' },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "tableName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "constraintName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "attributeName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "start_value", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "end_value", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
 
   AK_header hRelation[5] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0' },
-      { TYPE_INT, "start_address", 0, '\0', '\0' },
-      { TYPE_INT, "end_address", 0, '\0', '\0' },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "start_address", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "end_address", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hAttribute[5] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { TYPE_INT, "type", 0, '\0', '\0', },
-      { TYPE_INT, "table_id", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "type", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "table_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hIndex[7] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { TYPE_INT, "start_address", 0, '\0', '\0', },
-      { TYPE_INT, "end_address", 0, '\0', '\0' },
-      { TYPE_INT, "table_id", 0, '\0', '\0', },
-      { TYPE_INT, "attribute_id", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "start_address", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "end_address", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "table_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "attribute_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hView[4] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "query", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "query", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hSequence[8] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { TYPE_INT, "current_value", 0, '\0', '\0', },
-      { TYPE_INT, "increment", 0, '\0', '\0', },
-      { TYPE_INT, "max", 0, '\0', '\0', },
-      { TYPE_INT, "min", 0, '\0', '\0', },
-      { TYPE_BOOL, "cycle", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "current_value", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "increment", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "max", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "min", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_BOOL, "cycle", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hFunction[5] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { TYPE_INT, "arg_num", 0, '\0', '\0', },
-      { TYPE_INT, "return_type", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "arg_num", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "return_type", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hFunction_arguments[5] =
     {
-      { TYPE_INT, "func_id", 0, '\0', '\0', },
-      { TYPE_INT, "att_num", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "att_type", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "att_name", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_INT, "func_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "att_num", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "att_type", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "att_name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hTrigger[7] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "event", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "condition", 0, '\0', '\0', },
-      { TYPE_INT, "action", 0, '\0', '\0', },
-      { TYPE_INT, "on", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "event", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "condition", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "action", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "on", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hTrigger_conditions[5] =
     {
-      { TYPE_INT, "trigger", 0, '\0', '\0', }, //pk
-      { TYPE_INT, "id", 0, '\0', '\0', }, //pk
-      { TYPE_VARCHAR, "data", 0, '\0', '\0', },
-      { TYPE_INT, "type", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_INT, "trigger", { 0 }, { { '\0' } }, { { '\0' } } }, //pk
+      { TYPE_INT, "id", { 0 }, { { '\0' } }, { { '\0' } } }, //pk
+      { TYPE_VARCHAR, "data", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "type", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
 
   AK_header hDb[3] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hDb_obj[3] =
     {
-      { TYPE_INT, "db_id", 0, '\0', '\0', },
-      { TYPE_INT, "artifact_id", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_INT, "db_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "artifact_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
 
   AK_header hUser[4] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "username", 0, '\0', '\0', },
-      { TYPE_INT, "password", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "username", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "password", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hGroup[3] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hUserGroup[3] =
     {
-      { TYPE_INT, "user_id", 0, '\0', '\0', },
-      { TYPE_INT, "group_id", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_INT, "user_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "group_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hUserRight[5] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_VARCHAR, "name", 0, '\0', '\0', },
-      { TYPE_INT, "artifact_id", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "right_type", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "name", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "artifact_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "right_type", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hGroupRight[5] =
     {
       { TYPE_INT, "obj_id", { 0 }, { { '\0' } }, { { '\0' } } },
-      { TYPE_INT, "group_id", 0, '\0', '\0', },
-      { TYPE_INT, "artifact_id", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "right_type", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_INT, "group_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "artifact_id", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "right_type", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   AK_header hReference[7] =
     {
-      { TYPE_VARCHAR, "table", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "constraint", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "attribute", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "parent", 0, '\0', '\0', },
-      { TYPE_VARCHAR, "parent_attribute", 0, '\0', '\0', },
-      { TYPE_INT, "type", 0, '\0', '\0', },
-      { 0, '\0', 0, '\0', '\0' }
+      { TYPE_VARCHAR, "table", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "constraint", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "attribute", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "parent", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "parent_attribute", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "type", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
+    };
+
+  AK_header hStatistics[10] =
+    {
+      { TYPE_VARCHAR, "tableName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "attributeName", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "rowCount", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "blockCount", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_INT, "ndv", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "minValue", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "maxValue", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "sketch", { 0 }, { { '\0' } }, { { '\0' } } },
+      { TYPE_VARCHAR, "histogram", { 0 }, { { '\0' } }, { { '\0' } } },
+      { 0, { '\0' }, { 0 }, { { '\0' } }, { { '\0' } } }
     };
 
   for (i = 0; i < 4; i++) {
@@ -2393,6 +2722,12 @@ AK_init_system_catalog()
     memset(hReference[i].constr_code, FREE_CHAR, MAX_CONSTRAINTS * MAX_CONSTR_CODE);
   }
 
+  for (i = 0; i < 9; i++) {
+    AK_memset_int(hStatistics[i].integrity, FREE_INT, MAX_CONSTRAINTS);
+    memset(hStatistics[i].constr_name, FREE_CHAR, MAX_CONSTRAINTS * MAX_CONSTR_NAME);
+    memset(hStatistics[i].constr_code, FREE_CHAR, MAX_CONSTRAINTS * MAX_CONSTR_CODE);
+  }
+
   AK_dbg_messg(HIGH, DB_MAN, "AK_init_system_catalog: Creating new segments...\n");
 
 
@@ -2417,16 +2752,18 @@ AK_init_system_catalog()
   constraintCheck    = AK_new_segment(AK_CONSTRAINTS_CHECK_CONSTRAINT, SEGMENT_TYPE_SYSTEM_TABLE, hConstraintCheck);
   constraintUnique   = AK_new_segment("AK_constraints_unique", SEGMENT_TYPE_SYSTEM_TABLE, hConstraintUnique);
   reference          = AK_new_segment("AK_reference",   SEGMENT_TYPE_SYSTEM_TABLE, hReference);
+  statistics         = AK_new_segment("AK_statistics",  SEGMENT_TYPE_SYSTEM_TABLE, hStatistics);
 
   AK_dbg_messg(LOW, DB_MAN, "AK_init_system_catalog: Segments created!\n");
 
   if (EXIT_SUCCESS == AK_init_system_tables_catalog(relation, attribute, index, view, sequence, function, function_arguments,
 						    trigger, trigger_conditions, db, db_obj, user, group, user_group, user_right,
-						    group_right, constraint, constraintNull, constraintCheck, constraintUnique, reference))
+						    group_right, constraint, constraintNull, constraintCheck, constraintUnique, reference,
+						    statistics))
     {
       AK_register_system_tables(relation, attribute, index, view, sequence, function, function_arguments, trigger, trigger_conditions,
 				db, db_obj, user, group, user_group, user_right, group_right, constraint, constraintNull, constraintCheck,
-				constraintUnique, reference);
+				constraintUnique, reference, statistics);
       printf("AK_init_system_catalog: System catalog initialized!\n");
       AK_EPI;
       return EXIT_SUCCESS;
@@ -2600,6 +2937,7 @@ AK_delete_segment(char * name, int type)
   AK_Update_Existing_Element(TYPE_VARCHAR, name, system_table, "name", row_root);
   AK_delete_row(row_root);
   AK_free(row_root);
+  AK_forget_segment_addresses(name);
 
   AK_EPI;
   return EXIT_SUCCESS;
@@ -2810,12 +3148,26 @@ TestResult AK_thread_safe_block_access_test()
     
   // and at the end, we write backup block back to the file
   AK_write_block(backup_block);
+
+  // the restored block has to be read back unchanged into a caller-owned buffer
+  block = (AK_block *) AK_malloc(sizeof(AK_block));
+  AK_read_block_into(block_address, block);
+  if (memcmp(block, backup_block, sizeof(AK_block)) == 0)
+    {
+      printf("\nRestored block read back into caller buffer: Success\n");
+      sum_of_suceeded_tests++;
+    }
+  else
+    {
+      printf("\nRestored block read back into caller buffer: Failed\n");
+    }
+  AK_free((void*)block);
   AK_free((void*)backup_block);
     
-  printf("\n%d out of 50 tests succeeded.", sum_of_suceeded_tests);
+  printf("\n%d out of 51 tests succeeded.", sum_of_suceeded_tests);
     
   AK_EPI;
-  return TEST_result(sum_of_suceeded_tests,50-sum_of_suceeded_tests);
+  return TEST_result(sum_of_suceeded_tests,51-sum_of_suceeded_tests);
 }
 
 
@@ -185,6 +185,11 @@ PtrContainer AK_allocationbit;
  */
 #define MAX_BLOCK_INIT_NUM MAX_CACHE_MEMORY
 
+/**
+ * @brief Maximum number of buffers handed to a single vectored read or write of the DB file
+ */
+#define AK_IOV_BATCH 64
+
 /**
  * @author dv
  * @brief Different modes to obtain allocation indexes:
@@ -250,7 +255,7 @@ int* AK_increase_extent(int start_address, int add_size, AK_allocation_set_mode*
 int* AK_get_extent(int start_address, int desired_size, AK_allocation_set_mode* mode, int border, int target, AK_header *header, int gl);
 int AK_get_allocation_set(int* bitsetbs, int fromWhere, int gaplength, int num, AK_allocation_set_mode mode, int target);
 int AK_copy_header(AK_header *header, int * blocknum, int num);
-int  AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany);
+int  AK_allocate_blocks(AK_block * block, int FromWhere, int HowMany);
 AK_block *  AK_init_block();
 int AK_allocationtable_dump(int zz);
 void AK_blocktable_dump(int zz);
@@ -263,17 +268,29 @@ int AK_blocktable_get();
 int fsize(FILE *fp);
 int AK_init_allocation_table();
 int AK_init_db_file(int size);
+int AK_open_db_file();
+void AK_close_db_file();
+int AK_get_db_fd();
+int AK_db_pread(void *buffer, size_t size, off_t offset);
+int AK_db_pwrite(const void *buffer, size_t size, off_t offset);
+off_t AK_db_file_size();
+int AK_db_preadv(const struct iovec *iov, int iovcnt, off_t offset);
+int AK_db_pwritev(const struct iovec *iov, int iovcnt, off_t offset);
+int AK_db_fsync();
+int AK_read_block_into(int address, AK_block *block);
+int AK_read_blocks_into(int address, AK_block **blocks, int count);
 AK_block * AK_read_block(int address);
 int AK_write_block(AK_block * block);
+int AK_write_blocks(AK_block **blocks, int count);
 int AK_new_extent(int start_address, int old_size, int extent_type, AK_header *header);
 int AK_new_segment(char * name, int type, AK_header *header);
 AK_header * AK_create_header(char * name, int type, int integrity, char * constr_name, char * contr_code);
 void AK_insert_entry(AK_block * block_address, int type, void * entry_data, int i);
 int AK_init_system_tables_catalog(int relation, int attribute, int index, int view, int sequence, int function, int function_arguments,
-    int trigger, int trigger_conditions, int db, int db_obj, int user, int group, int user_group, int user_right, int group_right, int constraint, int constraintNull, int constraintCheck, int constraintUnique, int reference);
+    int trigger, int trigger_conditions, int db, int db_obj, int user, int group, int user_group, int user_right, int group_right, int constraint, int constraintNull, int constraintCheck, int constraintUnique, int reference, int statistics);
 void AK_memset_int(void *block, int value, size_t num);
 int AK_register_system_tables(int relation, int attribute, int index, int view, int sequence, int function, int function_arguments,
-    int trigger, int trigger_conditions, int db, int db_obj, int user, int group, int user_group, int user_right, int group_right, int constraint, int constraintNull, int constraintCheck, int constraintUnique, int reference);
+    int trigger, int trigger_conditions, int db, int db_obj, int user, int group, int user_group, int user_right, int group_right, int constraint, int constraintNull, int constraintCheck, int constraintUnique, int reference, int statistics);
 int AK_init_system_catalog();
 int AK_delete_block(int address);
 int AK_delete_extent(int begin, int end);
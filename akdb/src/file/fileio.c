@@ -17,6 +17,9 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  17 */
 #include "fileio.h"
+#include "idx/bptree.h"
+#include "idx/hash.h"
+#include "statistics.h"
 
 //START SPECIAL FUNCTIONS FOR WORK WITH row_element_structure
 
@@ -42,8 +45,8 @@ void AK_Insert_New_Element_For_Update(int newtype, void *data, char *table, char
     newElement->type = newtype;
     memcpy(newElement->data, data, AK_type_size(newtype, data));
 
-    if (newtype == TYPE_VARCHAR)
-        newElement->data[AK_type_size(newtype, data)] = '\0';
+    /// terminated for every type, AK_update_row_from_block compares new values with strlen
+    newElement->data[AK_type_size(newtype, data)] = '\0';
 
     memcpy(newElement->table, table, strlen(table));
     newElement->table[strlen(table)] = '\0';
@@ -199,11 +202,11 @@ int AK_insert_row(struct list_node *row_root)
     memcpy(&table, some_element->table, strlen(some_element->table));
     AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into table: %s\n", table);
     int adr_to_write;
-    table_addresses_return = AK_get_table_addresses(table);
-    adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
-    AK_free(table_addresses_return);
+    table_addresses extents;
+    adr_to_write = AK_find_segment_free_space("AK_relation", table);
 
-    if (adr_to_write == -1)
+    /// no block has room (EXIT_ERROR) or the directory saw no extents (0); only a segment that exists is extended
+    if (adr_to_write <= 0 && AK_lookup_table_addresses(table, &extents) != 0)
         adr_to_write = (int)AK_init_new_extent(table, SEGMENT_TYPE_TABLE);
     if (strstr(some_element->table, "_bmapIndex"))
     {
@@ -212,13 +215,12 @@ int AK_insert_row(struct list_node *row_root)
         AK_free(table_addresses_return);
     }
 
-    if (adr_to_write == 0)
+    if (adr_to_write <= 0)
     {
         AK_EPI;
         return EXIT_ERROR;
     }
 
-    table_addresses *addresses = (table_addresses *)AK_get_table_addresses(table);
     
     /*for(int i = 0; i < blocks_per_row; i++){
     	AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
@@ -230,8 +232,13 @@ int AK_insert_row(struct list_node *row_root)
     int end;
     AK_mem_block *mem_block;
     int l = 0;
+    int row_block = adr_to_write, row_td = 0;
     do{
     	mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
+    	/// the row starts at the first AK_free tuple dict of its first block, the same one AK_insert_row_to_block takes
+    	if (l++ == 0)
+    	    while (mem_block->block->tuple_dict[row_td].size != FREE_INT)
+    	        row_td++;
     	end = (int)AK_insert_row_to_block(row_root, mem_block->block);
     	AK_mem_block_modify(mem_block, BLOCK_DIRTY);
     	adr_to_write = mem_block->block->chained_with;
@@ -239,8 +246,16 @@ int AK_insert_row(struct list_node *row_root)
     while(mem_block->block->chained_with != NOT_CHAINED);
 
     if (end == EXIT_SUCCESS)
+    {
         AK_redolog_commit();
-        
+        AK_bptree_row_inserted(table, row_root, row_block, row_td);
+        AK_hash_row_inserted(table, row_root, row_block, row_td);
+        AK_statistics_row_inserted(table, row_root, row_block);
+    }
+
+    /// a new catalog row may add, move or rename segments
+    if (strcmp(table, "AK_relation") == 0 || strcmp(table, "AK_index") == 0)
+        AK_invalidate_segment_addresses(NULL);
 
     AK_EPI;
     return end;
@@ -280,7 +295,7 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
         while (strcmp(temp_block->header[head].att_name, "\0") != 0)
         { //going through headers
 
-            some_element = row_root;
+            some_element = AK_First_L2(row_root);
             while (some_element)
             {
                 if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
@@ -318,7 +333,7 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
                     memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
                     memcpy(entry_data, temp_block->data + a, s);
                 }
-                some_element = row_root;
+                some_element = (struct list_node *)AK_First_L2(row_root);
                 while (some_element)
                 {
                     // save data from roow_root in a list new_data where whole row is being inserted
@@ -410,7 +425,7 @@ void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
 
         while (strcmp(temp_block->header[head].att_name, "\0") != 0)
         { //going through headers
-            some_element = row_root;
+            some_element = AK_First_L2(row_root);
 
             while (some_element)
             {
@@ -461,6 +476,78 @@ void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
     AK_EPI;
 }
 
+/**
+ * @brief Function that reads a row of a block into a list, in the form AK_insert_row gets it
+ * @param table table name
+ * @param block block of the row
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ * @param num_attr number of attributes of the table
+ * @return list of the values of the row
+ */
+static struct list_node *AK_block_row(char *table, AK_block *block, int indexTd, int num_attr)
+{
+    struct list_node *row_root = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    char data[MAX_VARCHAR_LENGTH];
+    int l, size;
+
+    AK_Init_L3(&row_root);
+    for (l = 0; l < num_attr; l++)
+    {
+        size = block->tuple_dict[indexTd + l].size;
+        memset(data, '\0', MAX_VARCHAR_LENGTH);
+        if (size > 0 && size < MAX_VARCHAR_LENGTH)
+            memcpy(data, block->data + block->tuple_dict[indexTd + l].address, size);
+        AK_Insert_New_Element(block->tuple_dict[indexTd + l].type, data, table, block->header[l].att_name, row_root);
+    }
+    return row_root;
+}
+
+/**
+ * @brief Function that updates the indices and the statistics of a table for the rows AK_delete_row_from_block or
+ * AK_update_row_from_block changed in a block. A deleted row is removed from them, an updated one is removed with
+ * its old values and added again with the new ones; rows moved to another block by an update were added by
+ * AK_insert_row.
+ * @param table table name
+ * @param before copy of the block made before the change
+ * @param after block after the change
+ */
+static void AK_block_rows_changed(char *table, AK_block *before, AK_block *after)
+{
+    struct list_node *row_root;
+    int num_attr = 0, k, l, changed;
+
+    while (num_attr < MAX_ATTRIBUTES && strcmp(after->header[num_attr].att_name, "\0") != 0)
+        num_attr++;
+    for (k = 0; num_attr > 0 && k + num_attr <= DATA_BLOCK_SIZE; k += num_attr)
+    {
+        if (before->tuple_dict[k].size <= 0)
+            continue;
+        changed = 0;
+        for (l = k; l < k + num_attr && !changed; l++)
+            changed = before->tuple_dict[l].type != after->tuple_dict[l].type
+                    || before->tuple_dict[l].size != after->tuple_dict[l].size
+                    || (before->tuple_dict[l].size > 0
+                        && memcmp(before->data + before->tuple_dict[l].address, after->data + after->tuple_dict[l].address, before->tuple_dict[l].size) != 0);
+        if (!changed)
+            continue;
+        row_root = AK_block_row(table, before, k, num_attr);
+        AK_bptree_row_deleted(table, row_root, before->address, k);
+        AK_hash_row_deleted(table, row_root, before->address, k);
+        AK_statistics_row_deleted(table, row_root);
+        AK_DeleteAll_L3(&row_root);
+        AK_free(row_root);
+        if (after->tuple_dict[k].size > 0)
+        {
+            row_root = AK_block_row(table, after, k, num_attr);
+            AK_bptree_row_inserted(table, row_root, after->address, k);
+            AK_hash_row_inserted(table, row_root, after->address, k);
+            AK_statistics_row_inserted(table, row_root, after->address);
+            AK_DeleteAll_L3(&row_root);
+            AK_free(row_root);
+        }
+    }
+}
+
 /**
       * @author Matija Novak, updated by Matija Šestak (function now uses caching)
       * @brief Function updates or deletes the whole segment of an table. Addresses for given table atr fetched. For each block
@@ -479,11 +566,19 @@ int AK_delete_update_segment(struct list_node *row_root, int del)
     table[strlen(some_element->table)] = '\0';
     AK_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: table to delete_update from: %s, source %s\n", table, some_element->table);
 
-    table_addresses *addresses = (table_addresses *)AK_get_table_addresses(table);
+    table_addresses table_extents;
+    table_addresses *addresses = &table_extents;
+    AK_lookup_table_addresses(table, addresses);
 
     AK_mem_block *mem_block;
+    AK_block *before = NULL;
     int startAddress, j, i;
 
+    /// a block is copied to find the changed rows only for a table with indices or statistics, system tables have neither
+    if (strncmp(table, "AK_", 3) != 0
+            && (AK_bptree_table_indexed(table) || AK_hash_table_indexed(table) || AK_statistics_analyzed(table)))
+        before = (AK_block *)AK_malloc(sizeof(AK_block));
+
     for (j = 0; j < MAX_EXTENTS_IN_SEGMENT; j++)
     { //going through extent
         startAddress = addresses->address_from[j];
@@ -495,18 +590,26 @@ int AK_delete_update_segment(struct list_node *row_root, int del)
             { //going through blocks
                 AK_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: delete_update block: %d\n", i);
                 mem_block = (AK_mem_block *)AK_get_block(i);
+                if (before != NULL)
+                    memcpy(before, mem_block->block, sizeof(AK_block));
 
                 if (del == DELETE)
                     AK_delete_row_from_block(mem_block->block, row_root);
                 else
                     AK_update_row_from_block(mem_block->block, row_root);
                 AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                if (before != NULL)
+                    AK_block_rows_changed(table, before, AK_get_block(i)->block);
             }
         }
         else
             break;
     }
-    AK_free(addresses);
+    if (before != NULL)
+        AK_free(before);
+    /// deleted or updated catalog rows may drop or rename segments
+    if (strcmp(table, "AK_relation") == 0 || strcmp(table, "AK_index") == 0)
+        AK_invalidate_segment_addresses(NULL);
     AK_EPI;
     return EXIT_SUCCESS;
 }
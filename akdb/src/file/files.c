@@ -125,6 +125,50 @@ int AK_initialize_new_index_segment(char *name, char *table_id, int attr_id , AK
     AK_EPI;
 }
 
+/**
+ * @brief Function that adds an extent to an index segment and registers it in AK_index. The extent grows from the
+ * previous one the same way AK_new_extent grows it.
+ * @param name index name
+ * @param table_id object id of the indexed table
+ * @param attr_id position of the indexed attribute
+ * @param old_size number of blocks of the previous extent
+ * @param header header of the index segment
+ * @param end_address set to the address after the last block of the new extent
+ * @return start address of the new extent, EXIT_ERROR if no extent could be allocated
+ */
+int AK_new_index_extent(char *name, char *table_id, int attr_id, int old_size, AK_header *header, int *end_address) {
+    char *sys_table = "AK_index";
+    int start_address, objectID;
+    int size = old_size + old_size * (float) EXTENT_GROWTH_INDEX;
+    AK_PRO;
+
+    if ((start_address = AK_new_extent(1, old_size, SEGMENT_TYPE_INDEX, header)) == EXIT_ERROR) {
+        AK_dbg_messg(LOW, FILE_MAN, "AK_new_index_extent: Could not allocate an extent for %s\n", name);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    *end_address = start_address + size;
+
+    pthread_mutex_lock(&fileMut);
+    objectID = AK_get_id();
+    pthread_mutex_unlock(&fileMut);
+
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    AK_Insert_New_Element(TYPE_INT, &objectID, sys_table, "obj_id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, name, sys_table, "name", row_root);
+    AK_Insert_New_Element(TYPE_INT, &start_address, sys_table, "start_address", row_root);
+    AK_Insert_New_Element(TYPE_INT, end_address, sys_table, "end_address", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, table_id, sys_table, "table_id", row_root);
+    AK_Insert_New_Element(TYPE_INT, &attr_id, sys_table, "attribute_id", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_invalidate_segment_addresses(name);
+    AK_EPI;
+    return start_address;
+}
+
 
 /**
   * @author Unknown
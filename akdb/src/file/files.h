@@ -27,6 +27,7 @@
 
 int AK_initialize_new_segment(char *name, int type, AK_header *header);
 int AK_initialize_new_index_segment(char *name, char *table_id,int attr_id , AK_header *header);
+int AK_new_index_extent(char *name, char *table_id, int attr_id, int old_size, AK_header *header, int *end_address);
 
 TestResult AK_files_test();
 
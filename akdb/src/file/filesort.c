@@ -85,92 +85,353 @@ int AK_get_num_of_tuples(AK_block *iBlock) {
     return (i / max_header_num);
 }
 
+/*
+ * AK_sort_table reads the table once and collects its rows in memory until they take more than WORK_MEMORY. Such a
+ * run is sorted and written into a temporary table segment. The runs are then merged AK_SORT_MERGE_FANIN consecutive
+ * runs at a time until the last merge writes the result table. A table that fits into WORK_MEMORY is sorted in memory and written
+ * directly. Rows with equal keys keep the order they have in the source table.
+ */
+
 /**
- * @author Tomislav Bobinac, updated by Filip Žmuk
- * @todo Make it to suport multiple sort atributes and ASC|DESC ordering
- * @brief Function that sorts a segment
- * @return No return value.
+ * @brief State of a sort
  */
-int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes) {
-	//initialize variables
-	register int i, j;
-	int blocks_addr[MAX_NUM_OF_BLOCKS];	//array with block addresses
-	int num_blocks = 0;	//number of blocks in segment
+typedef struct {
+    AK_sort_key *keys;
+    int num_keys;
+    AK_header *header;
+    int num_attr;
+    AK_sort_stats *stats;
+    char *destTable;
+    /// temporary runs waiting to be merged, in the order they were written
+    char (*runs)[MAX_ATT_NAME];
+    int num_runs;
+    int runs_capacity;
+    /// number of temporary runs created so far, used for their names
+    int run_counter;
+} AK_sort_context;
 
-	AK_PRO;
+/**
+ * @brief Function that compares two values of the same type in the order of that type
+ * @param type type of both values
+ * @param a first value
+ * @param size_a size of the first value in bytes
+ * @param b second value
+ * @param size_b size of the second value in bytes
+ * @return negative, zero or positive like strcmp
+ */
+int AK_sort_compare_values(int type, const char *a, int size_a, const char *b, int size_b) {
+    int int_a, int_b, result;
+    float float_a, float_b;
+    double double_a, double_b;
+
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            if (size_a < (int) sizeof (int) || size_b < (int) sizeof (int))
+                break;
+            memcpy(&int_a, a, sizeof (int));
+            memcpy(&int_b, b, sizeof (int));
+            return (int_a > int_b) - (int_a < int_b);
+        case TYPE_FLOAT:
+            if (size_a < (int) sizeof (float) || size_b < (int) sizeof (float))
+                break;
+            memcpy(&float_a, a, sizeof (float));
+            memcpy(&float_b, b, sizeof (float));
+            return (float_a > float_b) - (float_a < float_b);
+        case TYPE_NUMBER:
+            if (size_a < (int) sizeof (double) || size_b < (int) sizeof (double))
+                break;
+            memcpy(&double_a, a, sizeof (double));
+            memcpy(&double_b, b, sizeof (double));
+            return (double_a > double_b) - (double_a < double_b);
+        case TYPE_VARCHAR:
+            size_a = strnlen(a, size_a);
+            size_b = strnlen(b, size_b);
+            break;
+    }
+    result = memcmp(a, b, size_a < size_b ? size_a : size_b);
+    return result != 0 ? result : (size_a > size_b) - (size_a < size_b);
+}
 
-	//Get number of blocks for given table
-	table_addresses *addresses = (table_addresses *) AK_get_table_addresses(srcTable);
-	for (i = 0; addresses->address_from[i] != 0; i++) {
-		for (j = addresses->address_from[i]; j <= addresses->address_to[i]; j++) {
-			blocks_addr[num_blocks] = j;
-			num_blocks++;
-		}
-	}
+/**
+ * @brief Function that compares two rows on the keys of a sort
+ * @param sort sort
+ * @param a values of the first row
+ * @param b values of the second row
+ * @return negative, zero or positive like strcmp
+ */
+static int AK_sort_compare_rows(AK_sort_context *sort, AK_value *a, AK_value *b) {
+    AK_value *value_a, *value_b;
+    int i, result;
+
+    for (i = 0; i < sort->num_keys; i++) {
+        value_a = &a[sort->keys[i].position];
+        value_b = &b[sort->keys[i].position];
+        /// a missing value is written as VARCHAR "null", values of different types are ordered by type
+        if (value_a->type != value_b->type)
+            result = (value_a->type > value_b->type) - (value_a->type < value_b->type);
+        else
+            result = AK_sort_compare_values(value_a->type, value_a->data, value_a->size, value_b->data, value_b->size);
+        if (result != 0)
+            return sort->keys[i].descending ? -result : result;
+    }
+    return 0;
+}
 
-	AK_header *head = AK_get_header(srcTable);
-	AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, head);
+/**
+ * @brief Function that sorts the rows of a run held in memory and writes them into a table
+ * @param sort sort
+ * @param run run, it is emptied
+ * @param table table to write into
+ * @return No return value
+ */
+static void AK_sort_write_run(AK_sort_context *sort, AK_tuple_arena *run, char *table) {
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_value *values = (AK_value *) AK_calloc(run->num_rows * sort->num_attr + 1, sizeof (AK_value));
+    int *order = (int *) AK_malloc((run->num_rows + 1) * sizeof (int));
+    int *merged = (int *) AK_malloc((run->num_rows + 1) * sizeof (int));
+    int *swap;
+    AK_value row_values[MAX_ATTRIBUTES];
+    int row, i, n, width, low, middle, high, a, b, k;
+
+    for (row = 0; row < run->num_rows; row++) {
+        n = AK_tuple_arena_values(run, row, row_values);
+        for (i = 0; i < n && i < sort->num_attr; i++)
+            values[row * sort->num_attr + i] = row_values[i];
+        /// missing values of a short row are empty
+        for (; i < sort->num_attr; i++) {
+            values[row * sort->num_attr + i].type = sort->header[i].type;
+            values[row * sort->num_attr + i].data = "";
+        }
+        order[row] = row;
+    }
 
-	//SORTING ...
-	char x[DATA_ROW_SIZE]; 		//needed data
-	char y[DATA_ROW_SIZE]; 		//data needed for comparison
-	char data[DATA_TUPLE_SIZE]; //data to be copied
+    /// bottom-up merge sort, it keeps rows with equal keys in the order they were read
+    for (width = 1; width < run->num_rows; width *= 2) {
+        for (low = 0; low < run->num_rows; low += 2 * width) {
+            middle = low + width < run->num_rows ? low + width : run->num_rows;
+            high = low + 2 * width < run->num_rows ? low + 2 * width : run->num_rows;
+            for (a = low, b = middle, k = low; k < high; k++) {
+                if (a < middle && (b >= high || AK_sort_compare_rows(sort, &values[order[a] * sort->num_attr], &values[order[b] * sort->num_attr]) <= 0))
+                    merged[k] = order[a++];
+                else
+                    merged[k] = order[b++];
+            }
+        }
+        swap = order;
+        order = merged;
+        merged = swap;
+    }
 
-	AK_mem_block * real_table = (AK_mem_block*) AK_get_block(blocks_addr[0]);
+    AK_Init_L3(&row_root);
+    for (row = 0; row < run->num_rows; row++)
+        AK_tuple_insert_values(table, sort->header, &values[order[row] * sort->num_attr], sort->num_attr, row_root);
+    AK_free(row_root);
+    AK_free(values);
+    AK_free(order);
+    AK_free(merged);
+    AK_tuple_arena_clear(run);
+}
 
-	//get total number of headers and the number of header used to sort segment
-	int num_headers = AK_get_total_headers(real_table->block);
-	int num_sort_header = AK_get_header_number(real_table->block, AK_First_L2(attributes)->data);
-	int num_records = AK_get_num_records(srcTable);
+/**
+ * @brief Function that creates a temporary run and appends it to the runs waiting to be merged
+ * @param sort sort
+ * @return position of the run in sort->runs
+ */
+static int AK_sort_new_run(AK_sort_context *sort) {
+    if (sort->num_runs == sort->runs_capacity) {
+        sort->runs_capacity = sort->runs_capacity ? sort->runs_capacity * 2 : 16;
+        sort->runs = AK_realloc(sort->runs, sort->runs_capacity * MAX_ATT_NAME);
+    }
+    snprintf(sort->runs[sort->num_runs], MAX_ATT_NAME, "%s_run%d", sort->destTable, sort->run_counter++);
+    AK_initialize_new_segment(sort->runs[sort->num_runs], SEGMENT_TYPE_TABLE, sort->header);
+    return sort->num_runs++;
+}
 
-	int type, temp, address, size, temp_field[num_records];
-	for (i = 0; i<num_records; i++) {
-		temp_field[i]=i;
-	}
+/**
+ * @brief Function that sorts the rows held in memory into a new temporary run
+ * @param sort sort
+ * @param run rows held in memory, it is emptied
+ * @return No return value
+ */
+static void AK_sort_spill(AK_sort_context *sort, AK_tuple_arena *run) {
+    int position = AK_sort_new_run(sort);
 
-	for (i = 0; i < num_records - 1; i++) {
-		for (j = i + 1; j < num_records; j++) {
-			//first data -> x
-			address = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].size;
-			memset(x, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(x, real_table->block->data + address, size);
-			//second data -> y
-			address = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].size;
-			memset(y, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(y, real_table->block->data + address, size);
-
-			//comparison (x > y) ASC
-			if (strcmp(x, y) >= 0) {
-				temp=temp_field[i];
-				temp_field[i]=temp_field[j];
-				temp_field[j]=temp;
-			}//end: if(strcmp(x,y) >= 0)
-		}
-	}
+    AK_dbg_messg(MIDDLE, FILE_MAN, "AK_sort_table: writing %d rows into %s\n", run->num_rows, sort->runs[position]);
+    sort->stats->runs++;
+    sort->stats->spilled_rows += run->num_rows;
+    AK_sort_write_run(sort, run, sort->runs[position]);
+}
+
+/**
+ * @brief Function that merges sorted runs into a table and deletes them
+ * @param sort sort
+ * @param first position of the first run in sort->runs
+ * @param count number of runs, at most AK_SORT_MERGE_FANIN
+ * @param table table to write into
+ * @return number of rows written
+ */
+static int AK_sort_merge(AK_sort_context *sort, int first, int count, char *table) {
+    AK_row_cursor cursors[AK_SORT_MERGE_FANIN];
+    struct list_node *rows[AK_SORT_MERGE_FANIN];
+    AK_value values[AK_SORT_MERGE_FANIN][MAX_ATTRIBUTES];
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    int i, smallest, written = 0;
+
+    AK_Init_L3(&row_root);
+    for (i = 0; i < count; i++) {
+        AK_row_cursor_open(&cursors[i], sort->runs[first + i]);
+        if ((rows[i] = AK_row_cursor_next(&cursors[i])) != NULL)
+            AK_tuple_row_values(rows[i], values[i]);
+    }
+    for (;;) {
+        /// on equal keys the earlier run wins, so the merge keeps the order of the source table
+        smallest = -1;
+        for (i = 0; i < count; i++)
+            if (rows[i] != NULL && (smallest == -1 || AK_sort_compare_rows(sort, values[i], values[smallest]) < 0))
+                smallest = i;
+        if (smallest == -1)
+            break;
+        AK_tuple_insert_values(table, sort->header, values[smallest], sort->num_attr, row_root);
+        written++;
+        AK_DeleteAll_L3(&rows[smallest]);
+        AK_free(rows[smallest]);
+        if ((rows[smallest] = AK_row_cursor_next(&cursors[smallest])) != NULL)
+            AK_tuple_row_values(rows[smallest], values[smallest]);
+    }
+    for (i = 0; i < count; i++)
+        AK_delete_segment(sort->runs[first + i], SEGMENT_TYPE_TABLE);
+    AK_free(row_root);
+    return written;
+}
+
+/**
+ * @brief Function that sorts the rows of a table into a new table with an external merge sort. The rows are read
+ * once; when they do not fit into WORK_MEMORY they are written as sorted runs into temporary segments and merged.
+ * @param srcTable name of the table to sort
+ * @param destTable name of the sorted table, it is created with the header of srcTable
+ * @param keys attributes to sort on, the first one is the most significant
+ * @param num_keys number of attributes to sort on
+ * @param stats filled with the work done by the sort, may be NULL
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_sort_table(char *srcTable, char *destTable, AK_sort_key *keys, int num_keys, AK_sort_stats *stats) {
+    AK_sort_context sort;
+    AK_sort_stats own_stats;
+    AK_tuple_arena run;
+    AK_value values[MAX_ATTRIBUTES];
+    AK_row_cursor cursor;
+    struct list_node *row;
+    long budget = (long) WORK_MEMORY * 1024;
+    int i, n, position, first, count, merged;
+    AK_PRO;
+
+    memset(&sort, 0, sizeof (AK_sort_context));
+    memset(&run, 0, sizeof (AK_tuple_arena));
+    sort.keys = keys;
+    sort.num_keys = num_keys;
+    sort.destTable = destTable;
+    sort.stats = stats != NULL ? stats : &own_stats;
+    memset(sort.stats, 0, sizeof (AK_sort_stats));
+    sort.num_attr = AK_num_attr(srcTable);
+    if (sort.num_attr <= 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < num_keys; i++) {
+        if (keys[i].position < 0 || keys[i].position >= sort.num_attr) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    sort.header = (AK_header *) AK_get_header(srcTable);
+    if (AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, sort.header) == EXIT_ERROR) {
+        AK_free(sort.header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
 
-	for (i = 0; i<num_records; i++) {
-		//initialize a new row
-		struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-		AK_Init_L3(&row_root);
-		for (j = 0; j < num_headers; j++) {
-			//get data from column 'j' orginal table -> data
-			address = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].address;
-			size = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].size;
-			type = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].type;
-			memset(data, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(data, real_table->block->data + address, size);
-			//add column 'j' data into struct row_root
-			AK_Insert_New_Element(type, data, destTable, real_table->block->header[j].att_name, row_root);
+    AK_row_cursor_open(&cursor, srcTable);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL) {
+        n = AK_tuple_row_values(row, values);
+        AK_tuple_arena_add(&run, values, n);
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+        sort.stats->rows++;
+        if (run.size + (long) run.num_rows * (sizeof (int) + sort.num_attr * sizeof (AK_value)) > budget)
+            AK_sort_spill(&sort, &run);
+    }
+
+    if (sort.num_runs == 0) {
+        AK_sort_write_run(&sort, &run, destTable);
+    } else {
+        if (run.num_rows > 0)
+            AK_sort_spill(&sort, &run);
+        /// merge consecutive runs until the rest can be merged into the result at once; a merged run takes the
+        /// place of the runs it was merged from, so the rows of earlier runs stay in earlier runs
+        while (sort.num_runs > AK_SORT_MERGE_FANIN) {
+            merged = 0;
+            for (first = 0; first < sort.num_runs; first += AK_SORT_MERGE_FANIN) {
+                count = sort.num_runs - first < AK_SORT_MERGE_FANIN ? sort.num_runs - first : AK_SORT_MERGE_FANIN;
+                if (count > 1) {
+                    position = AK_sort_new_run(&sort);
+                    sort.stats->spilled_rows += AK_sort_merge(&sort, first, count, sort.runs[position]);
+                    sort.stats->merge_passes++;
+                    sort.num_runs--;
+                } else
+                    position = first;
+                memmove(sort.runs[merged++], sort.runs[position], MAX_ATT_NAME);
+            }
+            sort.num_runs = merged;
+        }
+        AK_sort_merge(&sort, 0, sort.num_runs, destTable);
+    }
+    AK_dbg_messg(LOW, FILE_MAN, "AK_sort_table: %d rows of %s sorted, %d runs, %d merge passes, %d rows spilled\n",
+            sort.stats->rows, srcTable, sort.stats->runs, sort.stats->merge_passes, sort.stats->spilled_rows);
+
+    AK_tuple_arena_free(&run);
+    AK_free(sort.runs);
+    AK_free(sort.header);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Tomislav Bobinac, updated by Filip Žmuk
+ * @brief Function that sorts a segment. The attributes are sorted on in the order of the list, an attribute
+ * followed by an operator element "DESC" is sorted in descending order ("ASC" is the default).
+ * @param srcTable name of the table to sort
+ * @param destTable name of the sorted table
+ * @param attributes attributes to sort on
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes) {
+	AK_sort_key keys[MAX_ATTRIBUTES];
+	struct list_node *el;
+	int num_keys = 0, position;
+	AK_PRO;
+
+	for (el = AK_First_L2(attributes); el != NULL; el = AK_Next_L2(el)) {
+		if (el->type == TYPE_OPERATOR && num_keys > 0 && (strcasecmp(el->data, "DESC") == 0 || strcasecmp(el->data, "ASC") == 0)) {
+			keys[num_keys - 1].descending = strcasecmp(el->data, "DESC") == 0;
+			continue;
 		}
-		//add row to new sorted table
-		AK_insert_row(row_root);
-		AK_DeleteAll_L3(&row_root);
+		position = AK_get_attr_index(srcTable, el->data);
+		if (position < 0 || num_keys == MAX_ATTRIBUTES) {
+			printf("AK_sort_segment: ERROR: table %s can not be sorted on %s\n", srcTable, el->data);
+			AK_EPI;
+			return EXIT_ERROR;
+		}
+		keys[num_keys].position = position;
+		keys[num_keys].descending = 0;
+		num_keys++;
 	}
 
+	position = AK_sort_table(srcTable, destTable, keys, num_keys, NULL);
 	AK_EPI;
-	return EXIT_SUCCESS;
+	return position;
 }
 
 /**
@@ -484,6 +745,61 @@ void AK_block_sort(AK_block * iBlock, char* attribute_name) {
     AK_EPI;
 }
 
+/**
+ * @brief Function that checks that the rows of a table are ordered on given keys, used by the test
+ * @param table table to check
+ * @param keys attributes the table should be ordered on
+ * @param num_keys number of attributes
+ * @param other table the rows should be equal to in the same order, NULL not to compare
+ * @return number of rows, -1 if they are not ordered or differ from the other table
+ */
+static int AK_sort_test_check(char *table, AK_sort_key *keys, int num_keys, char *other) {
+    AK_sort_context sort;
+    AK_value values[2][MAX_ATTRIBUTES], other_values[MAX_ATTRIBUTES];
+    AK_row_cursor cursor, other_cursor;
+    struct list_node *rows[2] = {NULL, NULL}, *other_row;
+    int i, n, count = 0;
+
+    memset(&sort, 0, sizeof (AK_sort_context));
+    sort.keys = keys;
+    sort.num_keys = num_keys;
+    AK_row_cursor_open(&cursor, table);
+    if (other != NULL)
+        AK_row_cursor_open(&other_cursor, other);
+    while (count >= 0 && (rows[1] = AK_row_cursor_next(&cursor)) != NULL) {
+        n = AK_tuple_row_values(rows[1], values[1]);
+        if (rows[0] != NULL && AK_sort_compare_rows(&sort, values[0], values[1]) > 0)
+            count = -1;
+        if (count >= 0 && other != NULL) {
+            other_row = AK_row_cursor_next(&other_cursor);
+            if (other_row == NULL || AK_tuple_row_values(other_row, other_values) != n)
+                count = -1;
+            for (i = 0; count >= 0 && i < n; i++)
+                if (AK_sort_compare_values(values[1][i].type, values[1][i].data, values[1][i].size, other_values[i].data, other_values[i].size) != 0)
+                    count = -1;
+            if (other_row != NULL) {
+                AK_DeleteAll_L3(&other_row);
+                AK_free(other_row);
+            }
+        }
+        if (rows[0] != NULL) {
+            AK_DeleteAll_L3(&rows[0]);
+            AK_free(rows[0]);
+        }
+        rows[0] = rows[1];
+        memcpy(values[0], values[1], sizeof (values[1]));
+        if (count >= 0)
+            count++;
+    }
+    for (i = 0; i < 2; i++) {
+        if (rows[i] != NULL) {
+            AK_DeleteAll_L3(&rows[i]);
+            AK_free(rows[i]);
+        }
+    }
+    return count;
+}
+
 //extern int address_of_tempBlock = 0;
 /*
  * @author Unknown, updated Tomislav Bobinac, Filip Žmuk
@@ -501,6 +817,7 @@ TestResult AK_filesort_test() {
 	AK_print_table(srcTable);
 
     struct list_node* attributes = (struct list_node*) AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&attributes);
     AK_InsertAtBegin_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), attributes); 
 
 	if (AK_sort_segment(srcTable, destTable,  attributes) == EXIT_SUCCESS)
@@ -512,6 +829,91 @@ TestResult AK_filesort_test() {
     {
         failed++;
     }    
+    AK_DeleteAll_L3(&attributes);
+
+    AK_sort_key keys[2];
+    AK_sort_stats stats;
+    int rows = AK_get_num_records(srcTable), work_memory = AK_settings.work_memory;
+    char *multiTable = "student_sorted_multi";
+    char *externalTable = "student_sorted_external";
+    if (AK_num_attr(multiTable) > 0)
+        AK_delete_segment(multiTable, SEGMENT_TYPE_TABLE);
+    if (AK_num_attr(externalTable) > 0)
+        AK_delete_segment(externalTable, SEGMENT_TYPE_TABLE);
+
+    printf("\nSorting %s on year ASC, weight DESC\n", srcTable);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight", sizeof("weight"), attributes);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "DESC", sizeof("DESC"), attributes);
+    keys[0].position = AK_get_attr_index(srcTable, "year");
+    keys[0].descending = 0;
+    keys[1].position = AK_get_attr_index(srcTable, "weight");
+    keys[1].descending = 1;
+    if (AK_sort_segment(srcTable, multiTable, attributes) == EXIT_SUCCESS && AK_sort_test_check(multiTable, keys, 2, NULL) == rows)
+    {
+        AK_print_table(multiTable);
+        success++;
+    }
+    else
+    {
+        printf("Table %s is not ordered on year ASC, weight DESC\n", multiTable);
+        failed++;
+    }
+
+    // without working memory every row is a run and the runs are merged in several passes
+    AK_settings.work_memory = 0;
+    if (AK_sort_table(srcTable, externalTable, keys, 2, &stats) == EXIT_SUCCESS && AK_sort_test_check(externalTable, keys, 2, multiTable) == rows
+            && stats.rows == rows && stats.runs == rows && (rows <= AK_SORT_MERGE_FANIN || stats.merge_passes > 0))
+    {
+        printf("External sort: %d rows, %d runs, %d merge passes, %d rows spilled\n", stats.rows, stats.runs, stats.merge_passes, stats.spilled_rows);
+        success++;
+    }
+    else
+    {
+        printf("External sort of %s differs from the sort in memory\n", srcTable);
+        failed++;
+    }
+
+    // many professors share a telephone number; with more than AK_SORT_MERGE_FANIN runs the external sort still
+    // keeps them in the order of the table, where id_prof grows
+    char *telTable = "p2_tel";
+    int professors = AK_get_num_records("professor2"), ordered = 0, previous_tel = 0, previous_id = 0;
+    AK_row_cursor cursor;
+    struct list_node *row;
+    if (AK_num_attr(telTable) > 0)
+        AK_delete_segment(telTable, SEGMENT_TYPE_TABLE);
+    keys[0].position = AK_get_attr_index("professor2", "tel");
+    keys[0].descending = 0;
+    if (professors > AK_SORT_MERGE_FANIN && AK_sort_table("professor2", telTable, keys, 1, &stats) == EXIT_SUCCESS
+            && AK_sort_test_check(telTable, keys, 1, NULL) == professors)
+    {
+        AK_row_cursor_open(&cursor, telTable);
+        for (ordered = 1; (row = AK_row_cursor_next(&cursor)) != NULL; ) {
+            int id, tel;
+            memcpy(&id, AK_GetNth_L2(1, row)->data, sizeof (int));
+            memcpy(&tel, AK_GetNth_L2(4, row)->data, sizeof (int));
+            if (ordered > 1 && tel == previous_tel && id < previous_id)
+                ordered = 0;
+            else if (ordered)
+                ordered = 2;
+            previous_tel = tel;
+            previous_id = id;
+            AK_DeleteAll_L3(&row);
+            AK_free(row);
+        }
+    }
+    if (ordered)
+    {
+        success++;
+    }
+    else
+    {
+        printf("External sort of professor2 on tel does not keep equal rows in order\n");
+        failed++;
+    }
+    AK_settings.work_memory = work_memory;
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
 
 	AK_EPI;
     return TEST_result(success,failed);
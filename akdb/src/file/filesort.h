@@ -39,6 +39,37 @@
 
 #define DATA_TUPLE_SIZE 500
 
+/**
+  * @def AK_SORT_MERGE_FANIN
+  * @brief Number of runs merged at once, more runs are merged in several passes
+  */
+#define AK_SORT_MERGE_FANIN 8
+
+/**
+ * @struct AK_sort_key
+ * @brief Attribute a table is sorted on
+ */
+typedef struct {
+    /// position of the attribute in the table
+    int position;
+    /// 1 for descending, 0 for ascending order
+    int descending;
+} AK_sort_key;
+
+/**
+ * @struct AK_sort_stats
+ * @brief Work done by a sort
+ */
+typedef struct {
+    int rows;
+    /// sorted runs written into temporary segments, 0 if the table was sorted in memory
+    int runs;
+    /// merges of at most AK_SORT_MERGE_FANIN runs into a new temporary run
+    int merge_passes;
+    /// rows written into temporary segments by all runs and merges
+    int spilled_rows;
+} AK_sort_stats;
+
 
 /**
  * @author Unknown
@@ -61,11 +92,22 @@ int AK_get_header_number(AK_block *iBlock, char *attribute_name);
  */
 int AK_get_num_of_tuples(AK_block *iBlock);
 
+/**
+ * @brief Function that compares two values of the same type in the order of that type
+ * @return negative, zero or positive like strcmp
+ */
+int AK_sort_compare_values(int type, const char *a, int size_a, const char *b, int size_b);
+
+/**
+ * @brief Function that sorts the rows of a table into a new table with an external merge sort
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_sort_table(char *srcTable, char *destTable, AK_sort_key *keys, int num_keys, AK_sort_stats *stats);
+
 /**
  * @author Tomislav Bobinac, updated by Filip Žmuk
- * @todo Make it to suport multiple sort atributes and ASC|DESC ordering
  * @brief Function that sorts a segment
- * @return No return value.
+ * @return EXIT_SUCCESS or EXIT_ERROR
  */
 int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes);
 
@@ -0,0 +1,1505 @@
+/**
+@file bptree.c Provides functions for disk-resident B+-tree indices
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "bptree.h"
+
+/*
+ * Every node of a tree is one block of its index segment; the first block holds the AK_bptree_meta. Entries are
+ * ordered by key and then by row address, so equal keys are allowed and every entry has exactly one place in the
+ * tree. Separators of inner nodes are whole entries: child i holds the entries e with separator[i-1] <= e <
+ * separator[i]. Deleted entries are removed from their leaf only, nodes are never merged.
+ */
+
+/// guards the registry: a create or drop runs alone, every other use of a tree holds it for reading
+static pthread_rwlock_t AK_bptree_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * @brief Entry of a tree outside of a node, large enough for every key type
+ */
+typedef struct {
+    struct_add add;
+    unsigned char key[AK_BPTREE_VARCHAR_KEY];
+} AK_bptree_entry;
+
+/// tree whose entries are being sorted by AK_bptree_entry_compare, set under the write lock of the registry
+static AK_bptree_meta *AK_bptree_sort_meta;
+
+/**
+ * @brief B+-tree known to the insert, delete and update paths of its table
+ */
+typedef struct {
+    char name[MAX_ATT_NAME];
+    char table[MAX_ATT_NAME];
+    /// readers of the tree run concurrently, an insert or delete runs alone
+    pthread_rwlock_t lock;
+} AK_bptree_registry_entry;
+
+/// trees found in AK_index, read on first use and kept up to date by create and drop (guarded by AK_bptree_lock)
+static AK_bptree_registry_entry **AK_bptree_registry;
+static int AK_bptree_registry_size = -1;
+static int AK_bptree_registry_capacity;
+
+/**
+ * @brief Function that determines the size of the key of an attribute type
+ * @param type attribute type
+ * @return key size in bytes, EXIT_ERROR if the type cannot be indexed
+ */
+static int AK_bptree_key_size(int type)
+{
+    switch (type)
+    {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            return sizeof (int);
+        case TYPE_FLOAT:
+            return sizeof (float);
+        case TYPE_NUMBER:
+            return sizeof (double);
+        case TYPE_VARCHAR:
+            return AK_BPTREE_VARCHAR_KEY;
+        default:
+            return EXIT_ERROR;
+    }
+}
+
+/**
+ * @brief Function that turns a value into a key of a tree
+ * @param meta tree
+ * @param value value as stored in a table
+ * @param size size of the value, -1 if it is a C value (string for VARCHAR)
+ * @param key key of meta->key_size bytes
+ */
+static void AK_bptree_make_key(AK_bptree_meta *meta, const void *value, int size, unsigned char *key)
+{
+    memset(key, 0, meta->key_size);
+    if (size < 0)
+        size = meta->key_type == TYPE_VARCHAR ? strlen((const char *) value) : meta->key_size;
+    if (size > meta->key_size)
+        size = meta->key_size;
+    memcpy(key, value, size);
+}
+
+/**
+ * @brief Function that compares two keys of a tree
+ * @param meta tree
+ * @param a first key
+ * @param b second key
+ * @return negative, zero or positive like strcmp
+ */
+static int AK_bptree_compare_keys(AK_bptree_meta *meta, const unsigned char *a, const unsigned char *b)
+{
+    int int_a, int_b;
+    float float_a, float_b;
+    double double_a, double_b;
+
+    switch (meta->key_type)
+    {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            memcpy(&int_a, a, sizeof (int));
+            memcpy(&int_b, b, sizeof (int));
+            return (int_a > int_b) - (int_a < int_b);
+        case TYPE_FLOAT:
+            memcpy(&float_a, a, sizeof (float));
+            memcpy(&float_b, b, sizeof (float));
+            return (float_a > float_b) - (float_a < float_b);
+        case TYPE_NUMBER:
+            memcpy(&double_a, a, sizeof (double));
+            memcpy(&double_b, b, sizeof (double));
+            return (double_a > double_b) - (double_a < double_b);
+        default:
+            return memcmp(a, b, meta->key_size);
+    }
+}
+
+/**
+ * @brief Function that compares two entries of a tree, first by key and then by row address
+ * @param meta tree
+ * @param key_a key of the first entry
+ * @param add_a row address of the first entry
+ * @param key_b key of the second entry
+ * @param add_b row address of the second entry
+ * @return negative, zero or positive like strcmp
+ */
+static int AK_bptree_compare(AK_bptree_meta *meta, const unsigned char *key_a, const struct_add *add_a,
+        const unsigned char *key_b, const struct_add *add_b)
+{
+    int result = AK_bptree_compare_keys(meta, key_a, key_b);
+    if (result != 0)
+        return result;
+    if (add_a->addBlock != add_b->addBlock)
+        return add_a->addBlock < add_b->addBlock ? -1 : 1;
+    return (add_a->indexTd > add_b->indexTd) - (add_a->indexTd < add_b->indexTd);
+}
+
+/**
+ * @brief Function that orders entries for the bulk-load (qsort comparator)
+ */
+static int AK_bptree_entry_compare(const void *a, const void *b)
+{
+    const AK_bptree_entry *entry_a = (const AK_bptree_entry *) a;
+    const AK_bptree_entry *entry_b = (const AK_bptree_entry *) b;
+    return AK_bptree_compare(AK_bptree_sort_meta, entry_a->key, &entry_a->add, entry_b->key, &entry_b->add);
+}
+
+/**
+ * @brief Function that returns the size of an entry (key and row address) of a tree
+ */
+static int AK_bptree_entry_size(AK_bptree_meta *meta)
+{
+    return meta->key_size + sizeof (struct_add);
+}
+
+/**
+ * @brief Function that returns the key of the i-th entry of a node, its row address follows the key
+ */
+static unsigned char *AK_bptree_key_at(AK_block *block, AK_bptree_meta *meta, int i)
+{
+    return block->data + sizeof (AK_bptree_node) + i * AK_bptree_entry_size(meta);
+}
+
+/**
+ * @brief Function that returns the row address of the i-th entry of a node
+ */
+static struct_add *AK_bptree_add_at(AK_block *block, AK_bptree_meta *meta, int i)
+{
+    return (struct_add *) (AK_bptree_key_at(block, meta, i) + meta->key_size);
+}
+
+/**
+ * @brief Function that returns the child blocks of an inner node
+ */
+static int *AK_bptree_children(AK_block *block, AK_bptree_meta *meta)
+{
+    return (int *) (block->data + sizeof (AK_bptree_node) + meta->inner_capacity * AK_bptree_entry_size(meta));
+}
+
+/**
+ * @brief Function that finds the first entry of a leaf that is not smaller than the given entry
+ * @param block leaf
+ * @param meta tree
+ * @param key key of the entry
+ * @param add row address of the entry, NULL compares the keys only
+ * @return position in the leaf
+ */
+static int AK_bptree_lower_bound(AK_block *block, AK_bptree_meta *meta, unsigned char *key, struct_add *add)
+{
+    AK_bptree_node *node = (AK_bptree_node *) block->data;
+    int low = 0, high = node->num_keys, middle, result;
+
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (add == NULL)
+            result = AK_bptree_compare_keys(meta, AK_bptree_key_at(block, meta, middle), key);
+        else
+            result = AK_bptree_compare(meta, AK_bptree_key_at(block, meta, middle), AK_bptree_add_at(block, meta, middle), key, add);
+        if (result < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * @brief Function that finds the child of an inner node which holds the given entry
+ * @param block inner node
+ * @param meta tree
+ * @param key key of the entry
+ * @param add row address of the entry
+ * @return position of the child, equal to the number of separators not greater than the entry
+ */
+static int AK_bptree_child_pos(AK_block *block, AK_bptree_meta *meta, unsigned char *key, struct_add *add)
+{
+    AK_bptree_node *node = (AK_bptree_node *) block->data;
+    int low = 0, high = node->num_keys, middle;
+
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (AK_bptree_compare(meta, AK_bptree_key_at(block, meta, middle), AK_bptree_add_at(block, meta, middle), key, add) <= 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * @brief Function that reads the description of a tree without taking the tree lock
+ * @param indexName index name
+ * @param meta description read from the first block of the index segment
+ * @return address of the first block, EXIT_ERROR if the index is not a B+-tree
+ */
+static int AK_bptree_read_meta(char *indexName, AK_bptree_meta *meta)
+{
+    table_addresses addresses;
+    int address = AK_lookup_segment_addresses("AK_index", indexName, &addresses);
+
+    if (address == 0)
+        return EXIT_ERROR;
+    memcpy(meta, AK_get_block(address)->block->data, sizeof (AK_bptree_meta));
+    if (meta->magic != AK_BPTREE_MAGIC)
+        return EXIT_ERROR;
+    return address;
+}
+
+/**
+ * @brief Function that writes the description of a tree to the first block of its segment
+ * @param address first block of the index segment
+ * @param meta description
+ */
+static void AK_bptree_write_meta(int address, AK_bptree_meta *meta)
+{
+    AK_mem_block *mem_block = AK_get_block(address);
+    memcpy(mem_block->block->data, meta, sizeof (AK_bptree_meta));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @brief Function that adds an extent to the segment of a tree
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param meta tree
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_bptree_grow(char *indexName, int address, AK_bptree_meta *meta)
+{
+    AK_header header[MAX_ATTRIBUTES];
+    int start_address, end_address;
+
+    memcpy(header, AK_get_block(address)->block->header, sizeof (header));
+    start_address = AK_new_index_extent(indexName, meta->table_id, meta->attribute_id, meta->extent_size, header, &end_address);
+    if (start_address == EXIT_ERROR)
+        return EXIT_ERROR;
+    meta->last_block = start_address - 1;
+    meta->extent_end = end_address;
+    meta->extent_size = end_address - start_address;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that takes the next free block of the index segment for a new, empty node
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param meta tree, its last_block is advanced
+ * @param leaf 1 for a leaf, 0 for an inner node
+ * @return address of the node, EXIT_ERROR if the segment cannot grow
+ */
+static int AK_bptree_new_node(char *indexName, int address, AK_bptree_meta *meta, int leaf)
+{
+    AK_mem_block *mem_block;
+    AK_bptree_node *node;
+
+    if (meta->last_block + 1 >= meta->extent_end && AK_bptree_grow(indexName, address, meta) != EXIT_SUCCESS)
+        return EXIT_ERROR;
+    meta->last_block++;
+
+    mem_block = AK_get_block(meta->last_block);
+    memset(mem_block->block->data, 0, sizeof (mem_block->block->data));
+    node = (AK_bptree_node *) mem_block->block->data;
+    node->leaf = leaf;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    return meta->last_block;
+}
+
+/**
+ * @brief Function that fills a tree from entries sorted by AK_bptree_entry_compare. Leaves are filled up to
+ * AK_BPTREE_LOAD_FACTOR and linked, then every level of inner nodes is built from the first entries of the level
+ * below.
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param meta tree, root and height are set
+ * @param entries sorted entries
+ * @param count number of entries
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_bptree_build(char *indexName, int address, AK_bptree_meta *meta, AK_bptree_entry *entries, int count)
+{
+    int per_node, num_nodes, num_parents, i, j, from, to, previous = 0;
+    int entry_size = AK_bptree_entry_size(meta);
+    int *nodes, *parents;
+    AK_bptree_entry *first, *parent_first;
+    AK_mem_block *mem_block;
+    AK_bptree_node *node;
+
+    per_node = meta->leaf_capacity * AK_BPTREE_LOAD_FACTOR / 100;
+    if (per_node < 1)
+        per_node = 1;
+    num_nodes = count > 0 ? (count + per_node - 1) / per_node : 1;
+    nodes = (int *) AK_malloc(num_nodes * sizeof (int));
+    first = (AK_bptree_entry *) AK_malloc(num_nodes * sizeof (AK_bptree_entry));
+
+    for (i = 0; i < num_nodes; i++)
+    {
+        if ((nodes[i] = AK_bptree_new_node(indexName, address, meta, 1)) == EXIT_ERROR)
+        {
+            AK_free(nodes);
+            AK_free(first);
+            return EXIT_ERROR;
+        }
+        from = (long) i * count / num_nodes;
+        to = (long) (i + 1) * count / num_nodes;
+        mem_block = AK_get_block(nodes[i]);
+        node = (AK_bptree_node *) mem_block->block->data;
+        node->num_keys = to - from;
+        node->prev = previous;
+        for (j = from; j < to; j++)
+        {
+            memcpy(AK_bptree_key_at(mem_block->block, meta, j - from), entries[j].key, meta->key_size);
+            memcpy(AK_bptree_add_at(mem_block->block, meta, j - from), &entries[j].add, sizeof (struct_add));
+        }
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        if (count > 0)
+            memcpy(&first[i], &entries[from], sizeof (AK_bptree_entry));
+        if (previous != 0)
+        {
+            mem_block = AK_get_block(previous);
+            ((AK_bptree_node *) mem_block->block->data)->next = nodes[i];
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        }
+        previous = nodes[i];
+    }
+    meta->height = 1;
+
+    per_node = (meta->inner_capacity + 1) * AK_BPTREE_LOAD_FACTOR / 100;
+    if (per_node < 2)
+        per_node = 2;
+    while (num_nodes > 1)
+    {
+        num_parents = (num_nodes + per_node - 1) / per_node;
+        parents = (int *) AK_malloc(num_parents * sizeof (int));
+        parent_first = (AK_bptree_entry *) AK_malloc(num_parents * sizeof (AK_bptree_entry));
+        for (i = 0; i < num_parents; i++)
+        {
+            if ((parents[i] = AK_bptree_new_node(indexName, address, meta, 0)) == EXIT_ERROR)
+            {
+                AK_free(parents);
+                AK_free(parent_first);
+                AK_free(nodes);
+                AK_free(first);
+                return EXIT_ERROR;
+            }
+            from = (long) i * num_nodes / num_parents;
+            to = (long) (i + 1) * num_nodes / num_parents;
+            mem_block = AK_get_block(parents[i]);
+            node = (AK_bptree_node *) mem_block->block->data;
+            node->num_keys = to - from - 1;
+            AK_bptree_children(mem_block->block, meta)[0] = nodes[from];
+            for (j = from + 1; j < to; j++)
+            {
+                memcpy(AK_bptree_key_at(mem_block->block, meta, j - from - 1), first[j].key, entry_size - sizeof (struct_add));
+                memcpy(AK_bptree_add_at(mem_block->block, meta, j - from - 1), &first[j].add, sizeof (struct_add));
+                AK_bptree_children(mem_block->block, meta)[j - from] = nodes[j];
+            }
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            memcpy(&parent_first[i], &first[from], sizeof (AK_bptree_entry));
+        }
+        AK_free(nodes);
+        AK_free(first);
+        nodes = parents;
+        first = parent_first;
+        num_nodes = num_parents;
+        meta->height++;
+    }
+
+    meta->root = nodes[0];
+    AK_free(nodes);
+    AK_free(first);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that inserts an entry into a tree, splitting full nodes on the way back to the root
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param meta tree
+ * @param key key of the entry
+ * @param add row address of the entry
+ * @return EXIT_SUCCESS, EXIT_ERROR if the entry is already in the tree or the segment cannot grow
+ */
+static int AK_bptree_insert_entry(char *indexName, int address, AK_bptree_meta *meta, unsigned char *key, struct_add *add)
+{
+    int path[AK_BPTREE_MAX_HEIGHT];
+    int level, pos, total, half, node_address, right, next;
+    int entry_size = AK_bptree_entry_size(meta);
+    unsigned char separator[AK_BPTREE_VARCHAR_KEY + sizeof (struct_add)];
+    unsigned char *entries;
+    int *children;
+    AK_mem_block *mem_block;
+    AK_bptree_node *node;
+
+    node_address = meta->root;
+    for (level = 0; level < meta->height - 1; level++)
+    {
+        path[level] = node_address;
+        mem_block = AK_get_block(node_address);
+        node_address = AK_bptree_children(mem_block->block, meta)[AK_bptree_child_pos(mem_block->block, meta, key, add)];
+    }
+
+    mem_block = AK_get_block(node_address);
+    node = (AK_bptree_node *) mem_block->block->data;
+    pos = AK_bptree_lower_bound(mem_block->block, meta, key, add);
+    if (pos < node->num_keys && AK_bptree_compare(meta, AK_bptree_key_at(mem_block->block, meta, pos), AK_bptree_add_at(mem_block->block, meta, pos), key, add) == 0)
+        return EXIT_ERROR;
+
+    if (node->num_keys < meta->leaf_capacity)
+    {
+        memmove(AK_bptree_key_at(mem_block->block, meta, pos + 1), AK_bptree_key_at(mem_block->block, meta, pos), (node->num_keys - pos) * entry_size);
+        memcpy(AK_bptree_key_at(mem_block->block, meta, pos), key, meta->key_size);
+        memcpy(AK_bptree_add_at(mem_block->block, meta, pos), add, sizeof (struct_add));
+        node->num_keys++;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        return EXIT_SUCCESS;
+    }
+
+    /// full leaf: the entries and the new one are split between the leaf and a new right neighbour
+    total = node->num_keys + 1;
+    entries = (unsigned char *) AK_malloc(total * entry_size);
+    memcpy(entries, AK_bptree_key_at(mem_block->block, meta, 0), pos * entry_size);
+    memcpy(entries + pos * entry_size, key, meta->key_size);
+    memcpy(entries + pos * entry_size + meta->key_size, add, sizeof (struct_add));
+    memcpy(entries + (pos + 1) * entry_size, AK_bptree_key_at(mem_block->block, meta, pos), (node->num_keys - pos) * entry_size);
+    half = total / 2;
+
+    if ((right = AK_bptree_new_node(indexName, address, meta, 1)) == EXIT_ERROR)
+    {
+        AK_free(entries);
+        return EXIT_ERROR;
+    }
+    mem_block = AK_get_block(node_address);
+    node = (AK_bptree_node *) mem_block->block->data;
+    next = node->next;
+    memcpy(AK_bptree_key_at(mem_block->block, meta, 0), entries, half * entry_size);
+    node->num_keys = half;
+    node->next = right;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+
+    mem_block = AK_get_block(right);
+    node = (AK_bptree_node *) mem_block->block->data;
+    memcpy(AK_bptree_key_at(mem_block->block, meta, 0), entries + half * entry_size, (total - half) * entry_size);
+    node->num_keys = total - half;
+    node->prev = node_address;
+    node->next = next;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+
+    if (next != 0)
+    {
+        mem_block = AK_get_block(next);
+        ((AK_bptree_node *) mem_block->block->data)->prev = right;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    }
+    memcpy(separator, entries + half * entry_size, entry_size);
+    AK_free(entries);
+
+    /// the first entry of the new node goes up as separator, splitting full inner nodes
+    for (level = meta->height - 2; level >= 0; level--)
+    {
+        node_address = path[level];
+        mem_block = AK_get_block(node_address);
+        node = (AK_bptree_node *) mem_block->block->data;
+        children = AK_bptree_children(mem_block->block, meta);
+        pos = AK_bptree_child_pos(mem_block->block, meta, separator, (struct_add *) (separator + meta->key_size));
+
+        if (node->num_keys < meta->inner_capacity)
+        {
+            memmove(AK_bptree_key_at(mem_block->block, meta, pos + 1), AK_bptree_key_at(mem_block->block, meta, pos), (node->num_keys - pos) * entry_size);
+            memmove(children + pos + 2, children + pos + 1, (node->num_keys - pos) * sizeof (int));
+            memcpy(AK_bptree_key_at(mem_block->block, meta, pos), separator, entry_size);
+            children[pos + 1] = right;
+            node->num_keys++;
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            return EXIT_SUCCESS;
+        }
+
+        total = node->num_keys + 1;
+        entries = (unsigned char *) AK_malloc(total * entry_size + (total + 1) * sizeof (int));
+        int *all_children = (int *) (entries + total * entry_size);
+        memcpy(entries, AK_bptree_key_at(mem_block->block, meta, 0), pos * entry_size);
+        memcpy(entries + pos * entry_size, separator, entry_size);
+        memcpy(entries + (pos + 1) * entry_size, AK_bptree_key_at(mem_block->block, meta, pos), (node->num_keys - pos) * entry_size);
+        memcpy(all_children, children, (pos + 1) * sizeof (int));
+        all_children[pos + 1] = right;
+        memcpy(all_children + pos + 2, children + pos + 1, (node->num_keys - pos) * sizeof (int));
+        half = total / 2;
+
+        if ((right = AK_bptree_new_node(indexName, address, meta, 0)) == EXIT_ERROR)
+        {
+            AK_free(entries);
+            return EXIT_ERROR;
+        }
+        mem_block = AK_get_block(node_address);
+        node = (AK_bptree_node *) mem_block->block->data;
+        memcpy(AK_bptree_key_at(mem_block->block, meta, 0), entries, half * entry_size);
+        memcpy(AK_bptree_children(mem_block->block, meta), all_children, (half + 1) * sizeof (int));
+        node->num_keys = half;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+
+        mem_block = AK_get_block(right);
+        node = (AK_bptree_node *) mem_block->block->data;
+        memcpy(AK_bptree_key_at(mem_block->block, meta, 0), entries + (half + 1) * entry_size, (total - half - 1) * entry_size);
+        memcpy(AK_bptree_children(mem_block->block, meta), all_children + half + 1, (total - half) * sizeof (int));
+        node->num_keys = total - half - 1;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+
+        memcpy(separator, entries + half * entry_size, entry_size);
+        AK_free(entries);
+    }
+
+    /// the root was split, the tree grows by one level
+    if (meta->height >= AK_BPTREE_MAX_HEIGHT || (node_address = AK_bptree_new_node(indexName, address, meta, 0)) == EXIT_ERROR)
+        return EXIT_ERROR;
+    mem_block = AK_get_block(node_address);
+    node = (AK_bptree_node *) mem_block->block->data;
+    memcpy(AK_bptree_key_at(mem_block->block, meta, 0), separator, entry_size);
+    AK_bptree_children(mem_block->block, meta)[0] = meta->root;
+    AK_bptree_children(mem_block->block, meta)[1] = right;
+    node->num_keys = 1;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    meta->root = node_address;
+    meta->height++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that finds the leaf where the entries with a key not smaller than the given one start
+ * @param meta tree
+ * @param key key, NULL for the first leaf
+ * @return address of the leaf
+ */
+static int AK_bptree_find_leaf(AK_bptree_meta *meta, unsigned char *key)
+{
+    struct_add lowest = { -1, -1 };
+    int level, node_address = meta->root;
+    AK_block *block;
+
+    for (level = 0; level < meta->height - 1; level++)
+    {
+        block = AK_get_block(node_address)->block;
+        node_address = AK_bptree_children(block, meta)[key == NULL ? 0 : AK_bptree_child_pos(block, meta, key, &lowest)];
+    }
+    return node_address;
+}
+
+/**
+ * @brief Function that adds a tree to the registry, called under the write lock of the registry
+ * @param indexName index name
+ * @param tblName indexed table
+ */
+static void AK_bptree_registry_add(char *indexName, char *tblName)
+{
+    int i;
+
+    AK_bptree_registry_entry *entry;
+
+    for (i = 0; i < AK_bptree_registry_size; i++)
+        if (strcmp(AK_bptree_registry[i]->name, indexName) == 0)
+            return;
+    if (AK_bptree_registry_size == AK_bptree_registry_capacity)
+    {
+        AK_bptree_registry_capacity = AK_bptree_registry_capacity ? AK_bptree_registry_capacity * 2 : 8;
+        AK_bptree_registry = (AK_bptree_registry_entry **) AK_realloc(AK_bptree_registry,
+                AK_bptree_registry_capacity * sizeof (AK_bptree_registry_entry *));
+    }
+    entry = (AK_bptree_registry_entry *) AK_malloc(sizeof (AK_bptree_registry_entry));
+    strcpy(entry->name, indexName);
+    strcpy(entry->table, tblName);
+    pthread_rwlock_init(&entry->lock, NULL);
+    AK_bptree_registry[AK_bptree_registry_size++] = entry;
+}
+
+/**
+ * @brief Function that reads the trees of AK_index into the registry on first use, called under the write lock of the registry.
+ * AK_index holds one row per extent, so a tree may be seen more than once.
+ */
+static void AK_bptree_registry_load()
+{
+    AK_bptree_meta meta;
+    AK_row_cursor cursor;
+    struct list_node *row;
+
+    if (AK_bptree_registry_size >= 0)
+        return;
+    AK_bptree_registry_size = 0;
+    AK_row_cursor_open(&cursor, "AK_index");
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        char *name = AK_Next_L2(AK_First_L2(row))->data;
+        if (AK_bptree_read_meta(name, &meta) != EXIT_ERROR)
+            AK_bptree_registry_add(name, meta.table);
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+}
+
+/**
+ * @brief Function that removes a tree from the registry, called under the write lock of the registry
+ * @param indexName index name
+ */
+static void AK_bptree_registry_remove(char *indexName)
+{
+    int i;
+
+    for (i = 0; i < AK_bptree_registry_size; i++)
+        if (strcmp(AK_bptree_registry[i]->name, indexName) == 0)
+        {
+            pthread_rwlock_destroy(&AK_bptree_registry[i]->lock);
+            AK_free(AK_bptree_registry[i]);
+            AK_bptree_registry[i] = AK_bptree_registry[--AK_bptree_registry_size];
+            return;
+        }
+}
+
+/**
+ * @brief Function that takes the registry lock for reading, reading the registry first if it is not read yet
+ */
+static void AK_bptree_registry_rdlock()
+{
+    pthread_rwlock_rdlock(&AK_bptree_lock);
+    if (AK_bptree_registry_size >= 0)
+        return;
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    pthread_rwlock_wrlock(&AK_bptree_lock);
+    AK_bptree_registry_load();
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    pthread_rwlock_rdlock(&AK_bptree_lock);
+}
+
+/**
+ * @brief Function that finds a tree in the registry, called under the registry lock
+ * @param indexName index name
+ * @return registry entry, NULL if there is no such B+-tree
+ */
+static AK_bptree_registry_entry *AK_bptree_registry_find(char *indexName)
+{
+    int i;
+
+    for (i = 0; i < AK_bptree_registry_size; i++)
+        if (strcmp(AK_bptree_registry[i]->name, indexName) == 0)
+            return AK_bptree_registry[i];
+    return NULL;
+}
+
+/**
+ * @brief Function that reads the object id of a table from AK_relation
+ * @param tblName table name
+ * @param table_id object id as string
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+static int AK_bptree_table_id(char *tblName, char *table_id)
+{
+    AK_row_cursor cursor;
+    struct list_node *row;
+    int obj_id, found = EXIT_ERROR;
+
+    AK_row_cursor_open(&cursor, "AK_relation");
+    while (found == EXIT_ERROR && (row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        struct list_node *id = AK_First_L2(row);
+        if (strcmp(AK_Next_L2(id)->data, tblName) == 0)
+        {
+            memcpy(&obj_id, id->data, sizeof (int));
+            sprintf(table_id, "%d", obj_id);
+            found = EXIT_SUCCESS;
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    return found;
+}
+
+/**
+ * @brief Function that creates a B+-tree index on an attribute of a table. The rows of the table are read once,
+ * sorted and bulk-loaded into the tree, and the index segment is registered in AK_index. Rows inserted later are
+ * added to the tree by AK_insert_row, system tables cannot be indexed.
+ * @param tblName table name
+ * @param attName indexed attribute, of type INT, DATE, DATETIME, TIME, FLOAT, NUMBER or VARCHAR
+ * @param indexName index name
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_bptree_create(char *tblName, char *attName, char *indexName)
+{
+    AK_bptree_meta meta;
+    table_addresses existing;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_header *table_header, *temp;
+    AK_bptree_entry *entries;
+    AK_row_cursor cursor;
+    struct list_node *row, *el;
+    int num_attr, position, i, count = 0, capacity = 64, address, result;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    if (num_attr <= 0 || strncmp(tblName, "AK_", 3) == 0 || AK_lookup_segment_addresses("AK_index", indexName, &existing) != 0)
+    {
+        AK_dbg_messg(LOW, INDICES, "AK_bptree_create: Table %s does not exist or index %s already exists\n", tblName, indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(&meta, 0, sizeof (AK_bptree_meta));
+    table_header = AK_get_header(tblName);
+    for (position = 0; position < num_attr; position++)
+        if (strcmp(table_header[position].att_name, attName) == 0)
+            break;
+    if (position == num_attr || (meta.key_size = AK_bptree_key_size(table_header[position].type)) == EXIT_ERROR
+            || AK_bptree_table_id(tblName, meta.table_id) != EXIT_SUCCESS)
+    {
+        AK_dbg_messg(LOW, INDICES, "AK_bptree_create: Attribute %s of %s cannot be indexed\n", attName, tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    meta.magic = AK_BPTREE_MAGIC;
+    meta.key_type = table_header[position].type;
+    meta.leaf_capacity = (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - sizeof (AK_bptree_node)) / AK_bptree_entry_size(&meta);
+    meta.inner_capacity = (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - sizeof (AK_bptree_node) - sizeof (int)) / (AK_bptree_entry_size(&meta) + sizeof (int));
+    strcpy(meta.table, tblName);
+    strcpy(meta.attribute, attName);
+    meta.attribute_id = position;
+
+    memset(i_header, 0, sizeof (i_header));
+    temp = AK_create_header(attName, meta.key_type, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(i_header, temp, sizeof (AK_header));
+    AK_free(temp);
+    temp = AK_create_header("addBlock", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(i_header + 1, temp, sizeof (AK_header));
+    AK_free(temp);
+    temp = AK_create_header("indexTd", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(i_header + 2, temp, sizeof (AK_header));
+    AK_free(temp);
+    AK_free(table_header);
+
+    /// an entry points to the first tuple_dict entry of its row
+    entries = (AK_bptree_entry *) AK_malloc(capacity * sizeof (AK_bptree_entry));
+    AK_row_cursor_open(&cursor, tblName);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        el = AK_First_L2(row);
+        for (i = 0; i < position && el != NULL; i++)
+            el = AK_Next_L2(el);
+        if (el != NULL && el->type == meta.key_type && el->size > 0)
+        {
+            if (count == capacity)
+            {
+                capacity *= 2;
+                entries = (AK_bptree_entry *) AK_realloc(entries, capacity * sizeof (AK_bptree_entry));
+            }
+            AK_bptree_make_key(&meta, el->data, el->size, entries[count].key);
+            entries[count].add.addBlock = cursor.block;
+            entries[count].add.indexTd = cursor.slot - cursor.num_attr;
+            count++;
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+
+    pthread_rwlock_wrlock(&AK_bptree_lock);
+    AK_bptree_sort_meta = &meta;
+    qsort(entries, count, sizeof (AK_bptree_entry), AK_bptree_entry_compare);
+
+    address = AK_initialize_new_index_segment(indexName, meta.table_id, position, i_header);
+    result = EXIT_ERROR;
+    if (address != EXIT_ERROR)
+    {
+        meta.last_block = address;
+        meta.extent_end = address + INITIAL_EXTENT_SIZE;
+        meta.extent_size = INITIAL_EXTENT_SIZE;
+        meta.num_entries = count;
+        result = AK_bptree_build(indexName, address, &meta, entries, count);
+        meta.stale = result != EXIT_SUCCESS;
+        AK_bptree_write_meta(address, &meta);
+        AK_bptree_registry_load();
+        AK_bptree_registry_add(indexName, tblName);
+    }
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_free(entries);
+
+    if (result == EXIT_SUCCESS)
+        AK_dbg_messg(LOW, INDICES, "AK_bptree_create: Index %s on %s(%s): %d entries, height %d\n", indexName, tblName, attName, count, meta.height);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that drops a B+-tree index, releasing its extents and removing it from AK_index
+ * @param indexName index name
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such B+-tree
+ */
+int AK_bptree_drop(char *indexName)
+{
+    AK_bptree_meta meta;
+    table_addresses *addresses;
+    int i;
+    AK_PRO;
+
+    pthread_rwlock_wrlock(&AK_bptree_lock);
+    if (AK_bptree_read_meta(indexName, &meta) == EXIT_ERROR)
+    {
+        pthread_rwlock_unlock(&AK_bptree_lock);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    /// AK_delete_segment looks up extents in AK_relation, index extents are released here
+    addresses = AK_get_index_addresses(indexName);
+    for (i = 0; addresses->address_from[i] != 0; i++)
+        AK_delete_extent(addresses->address_from[i], addresses->address_to[i] - 1);
+    AK_free(addresses);
+    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+    AK_bptree_registry_remove(indexName);
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that inserts a row address into a B+-tree index
+ * @param indexName index name
+ * @param value indexed value of the row (int, float or double pointer, string for VARCHAR)
+ * @param addBlock block of the row
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such B+-tree or the address is already indexed
+ */
+int AK_bptree_insert(char *indexName, void *value, int addBlock, int indexTd)
+{
+    AK_bptree_meta meta;
+    unsigned char key[AK_BPTREE_VARCHAR_KEY];
+    struct_add add;
+    AK_bptree_registry_entry *entry;
+    int address, result = EXIT_ERROR;
+    AK_PRO;
+
+    add.addBlock = addBlock;
+    add.indexTd = indexTd;
+    AK_bptree_registry_rdlock();
+    if ((entry = AK_bptree_registry_find(indexName)) != NULL)
+    {
+        pthread_rwlock_wrlock(&entry->lock);
+        if ((address = AK_bptree_read_meta(indexName, &meta)) != EXIT_ERROR)
+        {
+            AK_bptree_make_key(&meta, value, -1, key);
+            if ((result = AK_bptree_insert_entry(indexName, address, &meta, key, &add)) == EXIT_SUCCESS)
+                meta.num_entries++;
+            AK_bptree_write_meta(address, &meta);
+        }
+        pthread_rwlock_unlock(&entry->lock);
+    }
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that removes an entry from its leaf, called under the write lock of the tree. Nodes that become empty stay
+ * in the tree.
+ * @param meta tree, its number of entries is decreased
+ * @param key key of the entry
+ * @param add row address of the entry
+ * @return EXIT_SUCCESS, EXIT_ERROR if the entry is not in the tree
+ */
+static int AK_bptree_delete_entry(AK_bptree_meta *meta, unsigned char *key, struct_add *add)
+{
+    AK_mem_block *mem_block;
+    AK_bptree_node *node;
+    int level, node_address, pos;
+
+    node_address = meta->root;
+    for (level = 0; level < meta->height - 1; level++)
+    {
+        mem_block = AK_get_block(node_address);
+        node_address = AK_bptree_children(mem_block->block, meta)[AK_bptree_child_pos(mem_block->block, meta, key, add)];
+    }
+    mem_block = AK_get_block(node_address);
+    node = (AK_bptree_node *) mem_block->block->data;
+    pos = AK_bptree_lower_bound(mem_block->block, meta, key, add);
+    if (pos >= node->num_keys || AK_bptree_compare(meta, AK_bptree_key_at(mem_block->block, meta, pos), AK_bptree_add_at(mem_block->block, meta, pos), key, add) != 0)
+        return EXIT_ERROR;
+    memmove(AK_bptree_key_at(mem_block->block, meta, pos), AK_bptree_key_at(mem_block->block, meta, pos + 1),
+            (node->num_keys - pos - 1) * AK_bptree_entry_size(meta));
+    node->num_keys--;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    meta->num_entries--;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that removes a row address from a B+-tree index. The entry is removed from its leaf, nodes
+ * that become empty stay in the tree.
+ * @param indexName index name
+ * @param value indexed value of the row
+ * @param addBlock block of the row
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the entry is not in the tree
+ */
+int AK_bptree_delete(char *indexName, void *value, int addBlock, int indexTd)
+{
+    AK_bptree_meta meta;
+    unsigned char key[AK_BPTREE_VARCHAR_KEY];
+    struct_add add;
+    AK_bptree_registry_entry *entry;
+    int address, result = EXIT_ERROR;
+    AK_PRO;
+
+    add.addBlock = addBlock;
+    add.indexTd = indexTd;
+    AK_bptree_registry_rdlock();
+    if ((entry = AK_bptree_registry_find(indexName)) != NULL)
+    {
+        pthread_rwlock_wrlock(&entry->lock);
+        if ((address = AK_bptree_read_meta(indexName, &meta)) != EXIT_ERROR)
+        {
+            AK_bptree_make_key(&meta, value, -1, key);
+            if ((result = AK_bptree_delete_entry(&meta, key, &add)) == EXIT_SUCCESS)
+                AK_bptree_write_meta(address, &meta);
+        }
+        pthread_rwlock_unlock(&entry->lock);
+    }
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that searches a B+-tree index for the rows with values in a range. VARCHAR keys hold only the
+ * first AK_BPTREE_VARCHAR_KEY bytes of a value, so rows found by a longer value have to be checked by the caller.
+ * @param indexName index name
+ * @param low lowest value, NULL for no lower bound
+ * @param high highest value, NULL for no upper bound
+ * @param result list the row addresses are appended to in value order
+ * @return number of rows found, EXIT_ERROR if there is no such B+-tree
+ */
+int AK_bptree_search(char *indexName, void *low, void *high, list_ad *result)
+{
+    AK_bptree_meta meta;
+    unsigned char low_key[AK_BPTREE_VARCHAR_KEY], high_key[AK_BPTREE_VARCHAR_KEY];
+    element_ad last = result;
+    AK_block *block;
+    AK_bptree_node *node;
+    struct_add *add;
+    AK_bptree_registry_entry *entry;
+    int node_address, pos, found = 0;
+    AK_PRO;
+
+    while (last->next != NULL)
+        last = last->next;
+
+    AK_bptree_registry_rdlock();
+    if ((entry = AK_bptree_registry_find(indexName)) == NULL)
+    {
+        pthread_rwlock_unlock(&AK_bptree_lock);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    pthread_rwlock_rdlock(&entry->lock);
+    if (AK_bptree_read_meta(indexName, &meta) == EXIT_ERROR)
+    {
+        pthread_rwlock_unlock(&entry->lock);
+        pthread_rwlock_unlock(&AK_bptree_lock);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (low != NULL)
+        AK_bptree_make_key(&meta, low, -1, low_key);
+    if (high != NULL)
+        AK_bptree_make_key(&meta, high, -1, high_key);
+
+    node_address = AK_bptree_find_leaf(&meta, low != NULL ? low_key : NULL);
+    block = AK_get_block(node_address)->block;
+    pos = low != NULL ? AK_bptree_lower_bound(block, &meta, low_key, NULL) : 0;
+    while (node_address != 0)
+    {
+        block = AK_get_block(node_address)->block;
+        node = (AK_bptree_node *) block->data;
+        for (; pos < node->num_keys; pos++)
+        {
+            if (high != NULL && AK_bptree_compare_keys(&meta, AK_bptree_key_at(block, &meta, pos), high_key) > 0)
+            {
+                node_address = 0;
+                break;
+            }
+            add = AK_bptree_add_at(block, &meta, pos);
+            AK_Insert_NewelementAd(add->addBlock, add->indexTd, NULL, last);
+            last = last->next;
+            found++;
+        }
+        if (node_address != 0)
+            node_address = node->next;
+        pos = 0;
+    }
+    pthread_rwlock_unlock(&entry->lock);
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_EPI;
+    return found;
+}
+
+/**
+ * @brief Function that reads the description of a B+-tree index
+ * @param indexName index name
+ * @param meta description of the tree
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such B+-tree
+ */
+int AK_bptree_get_meta(char *indexName, AK_bptree_meta *meta)
+{
+    AK_bptree_registry_entry *entry;
+    int result = EXIT_ERROR;
+    AK_PRO;
+    AK_bptree_registry_rdlock();
+    if ((entry = AK_bptree_registry_find(indexName)) != NULL)
+    {
+        pthread_rwlock_rdlock(&entry->lock);
+        result = AK_bptree_read_meta(indexName, meta) == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+        pthread_rwlock_unlock(&entry->lock);
+    }
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that finds a B+-tree index on an attribute of a table among the indices in AK_index
+ * @param tblName table name
+ * @param attName attribute name
+ * @param indexName name of the index found
+ * @return EXIT_SUCCESS, EXIT_ERROR if the attribute has no B+-tree index
+ */
+int AK_bptree_find(char *tblName, char *attName, char *indexName)
+{
+    AK_bptree_meta meta;
+    AK_bptree_registry_entry *entry;
+    int i, found = EXIT_ERROR;
+    AK_PRO;
+
+    AK_bptree_registry_rdlock();
+    for (i = 0; found == EXIT_ERROR && i < AK_bptree_registry_size; i++)
+    {
+        entry = AK_bptree_registry[i];
+        if (strcmp(entry->table, tblName) != 0)
+            continue;
+        pthread_rwlock_rdlock(&entry->lock);
+        if (AK_bptree_read_meta(entry->name, &meta) != EXIT_ERROR && strcmp(meta.attribute, attName) == 0)
+        {
+            strcpy(indexName, entry->name);
+            found = EXIT_SUCCESS;
+        }
+        pthread_rwlock_unlock(&entry->lock);
+    }
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_EPI;
+    return found;
+}
+
+/**
+ * @brief Function that checks whether a table has a B+-tree index
+ * @param tblName table name
+ * @return 1 if the table has a B+-tree, 0 otherwise
+ */
+int AK_bptree_table_indexed(char *tblName)
+{
+    int i, indexed = 0;
+    AK_PRO;
+
+    AK_bptree_registry_rdlock();
+    for (i = 0; !indexed && i < AK_bptree_registry_size; i++)
+        indexed = strcmp(AK_bptree_registry[i]->table, tblName) == 0;
+    pthread_rwlock_unlock(&AK_bptree_lock);
+    AK_EPI;
+    return indexed;
+}
+
+/**
+ * @brief Function that builds a B+-tree index again from the rows of its table, used for stale trees
+ * @param indexName index name
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_bptree_rebuild(char *indexName)
+{
+    AK_bptree_meta meta;
+    int result = EXIT_ERROR;
+    AK_PRO;
+
+    if (AK_bptree_get_meta(indexName, &meta) == EXIT_SUCCESS && AK_bptree_drop(indexName) == EXIT_SUCCESS)
+        result = AK_bptree_create(meta.table, meta.attribute, indexName);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that adds a row of a table to the B+-tree indices of the table or removes it from them
+ * @param tblName table name
+ * @param row_root row
+ * @param addBlock block of the row
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ * @param insert 1 to add the row, 0 to remove it
+ */
+static void AK_bptree_row_changed(char *tblName, struct list_node *row_root, int addBlock, int indexTd, int insert)
+{
+    AK_bptree_meta meta;
+    unsigned char key[AK_BPTREE_VARCHAR_KEY];
+    struct_add add;
+    AK_bptree_registry_entry *entry;
+    struct list_node *el;
+    int i, address, result;
+
+    /// system tables are not indexed, and AK_index rows are written while a tree is locked
+    if (strncmp(tblName, "AK_", 3) == 0)
+        return;
+    add.addBlock = addBlock;
+    add.indexTd = indexTd;
+    /// only the trees of this table are locked, a table without a tree takes no write lock at all
+    AK_bptree_registry_rdlock();
+    for (i = 0; i < AK_bptree_registry_size; i++)
+    {
+        entry = AK_bptree_registry[i];
+        if (strcmp(entry->table, tblName) != 0)
+            continue;
+        pthread_rwlock_wrlock(&entry->lock);
+        if ((address = AK_bptree_read_meta(entry->name, &meta)) == EXIT_ERROR || meta.stale)
+        {
+            pthread_rwlock_unlock(&entry->lock);
+            continue;
+        }
+        for (el = AK_First_L2(row_root); el != NULL; el = AK_Next_L2(el))
+            if (el->constraint == NEW_VALUE && strcmp(el->attribute_name, meta.attribute) == 0)
+                break;
+        /// a missing value is written as VARCHAR "null" and is not indexed, the same as in AK_bptree_create
+        if (el != NULL && el->type == meta.key_type)
+        {
+            AK_bptree_make_key(&meta, el->data, -1, key);
+            if (insert)
+            {
+                if ((result = AK_bptree_insert_entry(entry->name, address, &meta, key, &add)) == EXIT_SUCCESS)
+                    meta.num_entries++;
+            }
+            else
+                result = AK_bptree_delete_entry(&meta, key, &add);
+            /// the tree no longer matches the rows and is rebuilt before its next use
+            if (result != EXIT_SUCCESS)
+                meta.stale = 1;
+            AK_bptree_write_meta(address, &meta);
+        }
+        pthread_rwlock_unlock(&entry->lock);
+    }
+    pthread_rwlock_unlock(&AK_bptree_lock);
+}
+
+/**
+ * @brief Function that adds a new row of a table to the B+-tree indices of the table, called by AK_insert_row
+ * @param tblName table name
+ * @param row_root inserted row
+ * @param addBlock block the row was written to
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ */
+void AK_bptree_row_inserted(char *tblName, struct list_node *row_root, int addBlock, int indexTd)
+{
+    AK_PRO;
+    AK_bptree_row_changed(tblName, row_root, addBlock, indexTd, 1);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that removes a deleted row of a table from the B+-tree indices of the table, called by
+ * AK_delete_update_segment. An updated row is removed with its old values and added again with the new ones.
+ * @param tblName table name
+ * @param row_root deleted row, as it was stored
+ * @param addBlock block of the row
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ */
+void AK_bptree_row_deleted(char *tblName, struct list_node *row_root, int addBlock, int indexTd)
+{
+    AK_PRO;
+    AK_bptree_row_changed(tblName, row_root, addBlock, indexTd, 0);
+    AK_EPI;
+}
+
+/**
+ * @brief Arguments and result of a reader thread of AK_bptree_test
+ */
+typedef struct {
+    char *indexName;
+    int low;
+    int high;
+    int found;
+} AK_bptree_reader;
+
+/**
+ * @brief Function that repeats a range search, run by the reader threads of AK_bptree_test
+ */
+static void *AK_bptree_reader_main(void *arg)
+{
+    AK_bptree_reader *reader = (AK_bptree_reader *) arg;
+    list_ad *list = (list_ad *) AK_malloc(sizeof (list_ad));
+    int i, found;
+
+    AK_InitializelistAd(list);
+    reader->found = 0;
+    for (i = 0; i < 50; i++)
+    {
+        found = AK_bptree_search(reader->indexName, &reader->low, &reader->high, list);
+        AK_Delete_All_elementsAd(list);
+        if (i > 0 && found != reader->found)
+        {
+            reader->found = -1;
+            break;
+        }
+        reader->found = found;
+    }
+    AK_free(list);
+    return NULL;
+}
+
+/**
+ * @brief Function that counts the rows of a table whose attribute lies in a range, by reading the whole table
+ */
+static int AK_bptree_test_count(char *tblName, int position, int type, void *low, void *high)
+{
+    AK_row_cursor cursor;
+    struct list_node *row, *el;
+    int i, count = 0, match;
+
+    AK_row_cursor_open(&cursor, tblName);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        el = AK_First_L2(row);
+        for (i = 0; i < position; i++)
+            el = AK_Next_L2(el);
+        if (type == TYPE_INT)
+            match = *(int *) el->data >= *(int *) low && *(int *) el->data <= *(int *) high;
+        else if (type == TYPE_FLOAT)
+            match = *(float *) el->data >= *(float *) low && *(float *) el->data <= *(float *) high;
+        else
+            match = strcmp(el->data, (char *) low) >= 0 && strcmp(el->data, (char *) high) <= 0;
+        count += match;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    return count;
+}
+
+/**
+ * @brief Function for testing B+-tree indices
+ * @return TestResult
+ */
+TestResult AK_bptree_test()
+{
+    char *tblName = "student";
+    char *intIndex = "student_mbr_bptree";
+    char *varcharIndex = "student_firstname_bptree";
+    char *floatIndex = "student_weight_bptree";
+    char found_name[MAX_ATT_NAME];
+    AK_bptree_meta meta;
+    AK_bptree_reader readers[4];
+    pthread_t threads[4];
+    list_ad *list = (list_ad *) AK_malloc(sizeof (list_ad));
+    element_ad element;
+    int passed = 0, failed = 0, i, count, ordered, low, high, value, previous, entries;
+    float float_low = 85.0, float_high = 92.0;
+    AK_PRO;
+
+    AK_InitializelistAd(list);
+
+    printf("\nCreating B+-tree indices on %s(mbr), %s(firstname) and %s(weight)...\n", tblName, tblName, tblName);
+    if (AK_bptree_create(tblName, "mbr", intIndex) == EXIT_SUCCESS
+            && AK_bptree_create(tblName, "firstname", varcharIndex) == EXIT_SUCCESS
+            && AK_bptree_create(tblName, "weight", floatIndex) == EXIT_SUCCESS)
+        passed++;
+    else
+        failed++;
+
+    printf("Finding the index of %s(firstname) in AK_index...\n", tblName);
+    if (AK_bptree_find(tblName, "firstname", found_name) == EXIT_SUCCESS && strcmp(found_name, varcharIndex) == 0
+            && AK_bptree_find(tblName, "lastname", found_name) == EXIT_ERROR)
+        passed++;
+    else
+        failed++;
+
+    /// every row found by a range search holds a value in the range, and no row is missed
+    low = 35895;
+    high = 35905;
+    count = AK_bptree_search(intIndex, &low, &high, list);
+    ordered = count == AK_bptree_test_count(tblName, 0, TYPE_INT, &low, &high);
+    previous = low;
+    for (element = AK_Get_First_elementAd(list); element != NULL; element = AK_Get_Next_elementAd(element))
+    {
+        AK_block *block = AK_get_block(element->add.addBlock)->block;
+        memcpy(&value, block->data + block->tuple_dict[element->add.indexTd].address, sizeof (int));
+        if (value < previous || value > high)
+            ordered = 0;
+        previous = value;
+    }
+    AK_Delete_All_elementsAd(list);
+    printf("Range search %d - %d on mbr: %d rows\n", low, high, count);
+    if (count > 0 && ordered)
+        passed++;
+    else
+        failed++;
+
+    count = AK_bptree_search(varcharIndex, "Ivan", "Matija", list);
+    AK_Delete_All_elementsAd(list);
+    printf("Range search Ivan - Matija on firstname: %d rows\n", count);
+    if (count > 0 && count == AK_bptree_test_count(tblName, 1, TYPE_VARCHAR, "Ivan", "Matija"))
+        passed++;
+    else
+        failed++;
+
+    count = AK_bptree_search(floatIndex, &float_low, &float_high, list);
+    AK_Delete_All_elementsAd(list);
+    printf("Range search %.2f - %.2f on weight: %d rows\n", float_low, float_high, count);
+    if (count > 0 && count == AK_bptree_test_count(tblName, 4, TYPE_FLOAT, &float_low, &float_high))
+        passed++;
+    else
+        failed++;
+
+    /// inserts beyond the capacity of a leaf split leaves and inner nodes and grow the segment
+    AK_bptree_get_meta(intIndex, &meta);
+    entries = meta.num_entries;
+    printf("Inserting 20000 entries into %s (leaf capacity %d, inner capacity %d)...\n", intIndex, meta.leaf_capacity, meta.inner_capacity);
+    ordered = 1;
+    for (i = 0; i < 20000; i++)
+    {
+        value = 100000 + (i * 7919) % 20000;
+        if (AK_bptree_insert(intIndex, &value, 1000000 + i, 0) != EXIT_SUCCESS)
+            ordered = 0;
+    }
+    if (AK_bptree_insert(intIndex, &value, 1000000 + 19999, 0) != EXIT_ERROR)
+        ordered = 0;
+    AK_bptree_get_meta(intIndex, &meta);
+    printf("Tree height %d, %d entries\n", meta.height, meta.num_entries);
+    if (ordered && meta.height >= 2 && meta.num_entries == entries + 20000)
+        passed++;
+    else
+        failed++;
+
+    count = AK_bptree_search(intIndex, NULL, NULL, list);
+    previous = 0;
+    ordered = count == meta.num_entries;
+    for (element = AK_Get_First_elementAd(list); element != NULL; element = AK_Get_Next_elementAd(element))
+    {
+        if (element->add.addBlock >= 1000000)
+        {
+            value = 100000 + ((element->add.addBlock - 1000000) * 7919) % 20000;
+            if (value < previous)
+                ordered = 0;
+            previous = value;
+        }
+    }
+    AK_Delete_All_elementsAd(list);
+    low = 110000;
+    high = 110999;
+    if (ordered && AK_bptree_search(intIndex, &low, &high, list) == 1000)
+        passed++;
+    else
+        failed++;
+    AK_Delete_All_elementsAd(list);
+
+    /// readers share the tree
+    printf("Searching with 4 concurrent readers...\n");
+    for (i = 0; i < 4; i++)
+    {
+        readers[i].indexName = intIndex;
+        readers[i].low = 100000 + i * 5000;
+        readers[i].high = readers[i].low + 2499;
+        pthread_create(&threads[i], NULL, AK_bptree_reader_main, &readers[i]);
+    }
+    ordered = 1;
+    for (i = 0; i < 4; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if (readers[i].found != 2500)
+            ordered = 0;
+    }
+    if (ordered)
+        passed++;
+    else
+        failed++;
+
+    printf("Deleting every other inserted entry...\n");
+    ordered = 1;
+    for (i = 0; i < 20000; i += 2)
+    {
+        value = 100000 + (i * 7919) % 20000;
+        if (AK_bptree_delete(intIndex, &value, 1000000 + i, 0) != EXIT_SUCCESS)
+            ordered = 0;
+    }
+    if (AK_bptree_delete(intIndex, &value, 1000000 + 0, 0) != EXIT_ERROR)
+        ordered = 0;
+    low = 100000;
+    high = 119999;
+    count = AK_bptree_search(intIndex, &low, &high, list);
+    AK_Delete_All_elementsAd(list);
+    AK_bptree_get_meta(intIndex, &meta);
+    if (ordered && count == 10000 && meta.num_entries == entries + 10000)
+        passed++;
+    else
+        failed++;
+
+    /// rows deleted or updated in the table are removed from the trees and updated ones added again
+    printf("Updating and deleting rows of %s...\n", tblName);
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    value = 35893;
+    AK_Update_Existing_Element(TYPE_INT, &value, tblName, "mbr", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Ana", tblName, "firstname", row_root);
+    AK_update_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    value = 35892;
+    AK_Update_Existing_Element(TYPE_INT, &value, tblName, "mbr", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Aleksandrina", tblName, "firstname", row_root);
+    AK_update_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    value = 35894;
+    AK_Update_Existing_Element(TYPE_INT, &value, tblName, "mbr", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    low = 35890;
+    high = 35999;
+    count = AK_bptree_search(intIndex, &low, &high, list);
+    AK_Delete_All_elementsAd(list);
+    ordered = count == AK_bptree_test_count(tblName, 0, TYPE_INT, &low, &high)
+        && AK_bptree_search(intIndex, &value, &value, list) == 0;
+    AK_Delete_All_elementsAd(list);
+    ordered = ordered && AK_bptree_search(varcharIndex, "Ana", "Ana", list) == 1;
+    AK_Delete_All_elementsAd(list);
+    ordered = ordered && AK_bptree_search(varcharIndex, "Aleksandrina", "Aleksandrina", list) == 1;
+    AK_Delete_All_elementsAd(list);
+    ordered = ordered && AK_bptree_search(varcharIndex, "Mislav", "Netko", list) == AK_bptree_test_count(tblName, 1, TYPE_VARCHAR, "Mislav", "Netko");
+    AK_Delete_All_elementsAd(list);
+    if (ordered && AK_bptree_get_meta(intIndex, &meta) == EXIT_SUCCESS && !meta.stale
+            && AK_bptree_get_meta(varcharIndex, &meta) == EXIT_SUCCESS && !meta.stale)
+        passed++;
+    else
+        failed++;
+
+    printf("Dropping the indices...\n");
+    if (AK_bptree_drop(intIndex) == EXIT_SUCCESS && AK_bptree_drop(varcharIndex) == EXIT_SUCCESS
+            && AK_bptree_drop(floatIndex) == EXIT_SUCCESS && AK_bptree_find(tblName, "mbr", found_name) == EXIT_ERROR
+            && AK_bptree_search(intIndex, NULL, NULL, list) == EXIT_ERROR)
+        passed++;
+    else
+        failed++;
+
+    AK_free(list);
+    AK_EPI;
+    return TEST_result(passed, failed);
+}
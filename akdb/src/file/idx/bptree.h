@@ -0,0 +1,111 @@
+/**
+@file bptree.h Header file that provides data structures, functions and defines for disk-resident B+-tree indices
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef BPTREE
+#define BPTREE
+
+#include "../../auxi/test.h"
+#include "index.h"
+#include "../../file/table.h"
+#include "../../auxi/constants.h"
+#include "../../auxi/configuration.h"
+#include "../files.h"
+#include "../../auxi/mempro.h"
+
+/**
+ * @def AK_BPTREE_MAGIC
+ * @brief Marks the first block of a B+-tree index segment
+ */
+#define AK_BPTREE_MAGIC 0x42505452
+
+/**
+ * @def AK_BPTREE_VARCHAR_KEY
+ * @brief Number of bytes of a VARCHAR value kept as key, longer values are compared on this prefix
+ */
+#define AK_BPTREE_VARCHAR_KEY 32
+
+/**
+ * @def AK_BPTREE_MAX_HEIGHT
+ * @brief Maximum number of levels of a tree
+ */
+#define AK_BPTREE_MAX_HEIGHT 32
+
+/**
+ * @def AK_BPTREE_LOAD_FACTOR
+ * @brief Percentage of a node filled by the bulk-load, the rest is left for inserts
+ */
+#define AK_BPTREE_LOAD_FACTOR 90
+
+/**
+ * @struct AK_bptree_meta
+ * @brief Description of a B+-tree kept in the first block of its segment
+ */
+typedef struct {
+    /// AK_BPTREE_MAGIC
+    int magic;
+    /// block of the root node and number of levels
+    int root;
+    int height;
+    /// type and size in bytes of a key
+    int key_type;
+    int key_size;
+    /// entries a leaf and an inner node can hold
+    int leaf_capacity;
+    int inner_capacity;
+    int num_entries;
+    /// 1 if a row could not be added to or removed from the tree, which is then rebuilt before its next use
+    int stale;
+    /// last block given to a node, end of its extent and number of blocks in that extent
+    int last_block;
+    int extent_end;
+    int extent_size;
+    /// indexed table and attribute, as registered in AK_index
+    char table[MAX_ATT_NAME];
+    char attribute[MAX_ATT_NAME];
+    char table_id[MAX_ATT_NAME];
+    int attribute_id;
+} AK_bptree_meta;
+
+/**
+ * @struct AK_bptree_node
+ * @brief Header of a node stored in the data of a block. It is followed by the entries (key and row address) and,
+ * in inner nodes, by the child blocks.
+ */
+typedef struct {
+    int leaf;
+    int num_keys;
+    /// neighbour leaves, 0 at the ends of the chain
+    int next;
+    int prev;
+} AK_bptree_node;
+
+int AK_bptree_create(char *tblName, char *attName, char *indexName);
+int AK_bptree_drop(char *indexName);
+int AK_bptree_insert(char *indexName, void *value, int addBlock, int indexTd);
+int AK_bptree_delete(char *indexName, void *value, int addBlock, int indexTd);
+int AK_bptree_search(char *indexName, void *low, void *high, list_ad *result);
+int AK_bptree_find(char *tblName, char *attName, char *indexName);
+int AK_bptree_table_indexed(char *tblName);
+int AK_bptree_get_meta(char *indexName, AK_bptree_meta *meta);
+int AK_bptree_rebuild(char *indexName);
+void AK_bptree_row_inserted(char *tblName, struct list_node *row_root, int addBlock, int indexTd);
+void AK_bptree_row_deleted(char *tblName, struct list_node *row_root, int addBlock, int indexTd);
+TestResult AK_bptree_test();
+
+#endif
@@ -32,7 +32,7 @@ creating index. We should check that with filesort.c and include it in this func
 That file had some errors, so I couldn't test it. 2.working with multiple blocks
 */
 AK_block * AK_btree_create(char *tblName, struct list_node *attributes, char *indexName){
-	int i,n,exist;
+	int i = 0,n,exist;
 	table_addresses *addresses;
 	int num_attr;
 	AK_PRO;
@@ -86,7 +86,7 @@ AK_block * AK_btree_create(char *tblName, struct list_node *attributes, char *in
 	int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
 	if (startAddress != EXIT_ERROR)
 		printf("\nINDEX %s CREATED!\n", indexName);
-        int r;
+        int r = 0;
 	table_addresses *addIndex = (table_addresses*) AK_get_index_addresses(indexName);
 	while(addIndex->address_from[ r ]){
 		printf("\nAddress of the INDEX is from %u to %u \n",(addIndex->address_from[ r ]),(addIndex->address_to[ r ]));
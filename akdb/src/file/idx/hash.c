@@ -20,323 +20,602 @@
 
 #include "hash.h"
 
+/*
+ * The index is a linear hash table. Every bucket is a chain of blocks of the index segment, the first block of the
+ * segment holds the hash_info and the bucket addresses are kept in directory blocks. A bucket is found from the
+ * 64-bit hash of the indexed attributes of a row: hash mod AK_HASH_INITIAL_BUCKETS * 2^level, or mod twice as much
+ * if that bucket was already split in this round. When the entries fill AK_HASH_LOAD_FACTOR of the buckets, the
+ * bucket at the split pointer is divided between itself and a new bucket at the end, so the index grows one bucket
+ * at a time and is never rebuilt. Entries hold only the hash and the row address, so rows found by a hash are
+ * checked against the values. Blocks are read and written through the buffer pool.
+ */
+
+/// readers of all hash indices run concurrently, an insert, delete, create or drop runs alone
+static pthread_rwlock_t AK_hash_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * @def AK_HASH_DIRECTORY_ENTRIES
+ * @brief Number of bucket addresses in a directory block
+ */
+#define AK_HASH_DIRECTORY_ENTRIES ((int) (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE / sizeof (int)))
+
+/// primes of the XXH64 hash function
+#define AK_HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define AK_HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define AK_HASH_PRIME3 0x165667B19E3779F9ULL
+#define AK_HASH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define AK_HASH_PRIME5 0x27D4EB2F165667C5ULL
+
+/**
+ * @brief Hash index known to the insert, delete and update paths of its table
+ */
+typedef struct {
+    char name[MAX_ATT_NAME];
+    char table[MAX_ATT_NAME];
+} AK_hash_registry_entry;
+
+/// indices found in AK_index, read on first use and kept up to date by create and drop (guarded by AK_hash_lock)
+static AK_hash_registry_entry *AK_hash_registry;
+static int AK_hash_registry_size = -1;
+static int AK_hash_registry_capacity;
+
+/**
+ * @brief Key of a batched probe, sorted by bucket and hash so every bucket is read once
+ */
+typedef struct {
+    int bucket;
+    int position;
+    uint64_t value;
+} AK_hash_probe_key;
+
+static uint64_t AK_hash_rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t AK_hash_round(uint64_t acc, uint64_t input)
+{
+    acc += input * AK_HASH_PRIME2;
+    acc = AK_hash_rotl(acc, 31);
+    return acc * AK_HASH_PRIME1;
+}
+
+static uint64_t AK_hash_merge_round(uint64_t acc, uint64_t value)
+{
+    acc ^= AK_hash_round(0, value);
+    return acc * AK_HASH_PRIME1 + AK_HASH_PRIME4;
+}
+
+/**
+ * @brief Function that computes the XXH64 hash of a byte sequence
+ * @param data bytes
+ * @param size number of bytes
+ * @param seed seed, the hash of the previous attribute when attributes are combined
+ * @return 64-bit hash value
+ */
+uint64_t AK_hash_bytes(const void *data, int size, uint64_t seed)
+{
+    const unsigned char *p = (const unsigned char *) data;
+    const unsigned char *end = p + size;
+    uint64_t h, v1, v2, v3, v4, k;
+    uint32_t w;
+
+    if (size >= 32)
+    {
+        v1 = seed + AK_HASH_PRIME1 + AK_HASH_PRIME2;
+        v2 = seed + AK_HASH_PRIME2;
+        v3 = seed;
+        v4 = seed - AK_HASH_PRIME1;
+        do
+        {
+            memcpy(&k, p, 8);
+            v1 = AK_hash_round(v1, k);
+            memcpy(&k, p + 8, 8);
+            v2 = AK_hash_round(v2, k);
+            memcpy(&k, p + 16, 8);
+            v3 = AK_hash_round(v3, k);
+            memcpy(&k, p + 24, 8);
+            v4 = AK_hash_round(v4, k);
+            p += 32;
+        } while (p + 32 <= end);
+        h = AK_hash_rotl(v1, 1) + AK_hash_rotl(v2, 7) + AK_hash_rotl(v3, 12) + AK_hash_rotl(v4, 18);
+        h = AK_hash_merge_round(h, v1);
+        h = AK_hash_merge_round(h, v2);
+        h = AK_hash_merge_round(h, v3);
+        h = AK_hash_merge_round(h, v4);
+    }
+    else
+        h = seed + AK_HASH_PRIME5;
+    h += (uint64_t) size;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        memcpy(&k, p, 8);
+        h ^= AK_hash_round(0, k);
+        h = AK_hash_rotl(h, 27) * AK_HASH_PRIME1 + AK_HASH_PRIME4;
+    }
+    if (p + 4 <= end)
+    {
+        memcpy(&w, p, 4);
+        h ^= (uint64_t) w * AK_HASH_PRIME1;
+        h = AK_hash_rotl(h, 23) * AK_HASH_PRIME2 + AK_HASH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++)
+    {
+        h ^= (*p) * AK_HASH_PRIME5;
+        h = AK_hash_rotl(h, 11) * AK_HASH_PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= AK_HASH_PRIME2;
+    h ^= h >> 29;
+    h *= AK_HASH_PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief Function that determines the number of bytes of a value that are hashed and compared
+ * @param type attribute type
+ * @param data value
+ * @param size size of the value, -1 if a VARCHAR value is terminated
+ * @return number of bytes
+ */
+static int AK_hash_value_size(int type, const char *data, int size)
+{
+    if (type == TYPE_VARCHAR)
+        return strnlen(data, size < 0 ? MAX_VARCHAR_LENGTH : size);
+    return AK_type_size(type, (char *) data);
+}
+
 /**
   * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
+  * @brief Function that computes a hash value from a value of any type
   * @param elem element of row for wich value is to be computed
   * @return hash value
- 
  */
-int AK_elem_hash_value(struct list_node *elem) {
-    int type = elem->type, value = 0, i = 0;
-    char temp_char[MAX_VARCHAR_LENGTH];
+uint64_t AK_elem_hash_value(struct list_node *elem) {
+    uint64_t value;
     AK_PRO;
-    switch (type) {
-        case TYPE_INT:
-            memcpy(&value, elem->data, elem->size);
-            break;
-        case TYPE_VARCHAR:
-            memcpy(temp_char, elem->data, elem->size);
-            temp_char[ elem->size ] = '\0';
-            do {
-                value += (int) temp_char[i++];
-            } while (temp_char[i]);
-            break;
-    }
+    value = AK_hash_bytes(elem->data, AK_hash_value_size(elem->type, elem->data, elem->size), 0);
     AK_EPI;
     return value;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
+ * @brief Function that computes the hash value of the indexed attributes of a row, used to probe an index
+ * @param values values of the indexed attributes in index order
+ * @return hash value
  */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type) {
-    int size, id;
+uint64_t AK_hash_values(struct list_node *values)
+{
+    struct list_node *elem;
+    uint64_t value = 0;
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 0;
-    add->indexTd = 0;
-
-    int adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-    if (adr_to_write == -1)
-        adr_to_write = (int) AK_init_new_extent(indexName, SEGMENT_TYPE_INDEX);
-    if (adr_to_write == 0){
-	AK_EPI;
-        return add;
+    for (elem = AK_First_L2(values); elem != NULL; elem = AK_Next_L2(elem))
+        value = AK_hash_bytes(elem->data, AK_hash_value_size(elem->type, elem->data, elem->size), value);
+    AK_EPI;
+    return value;
+}
+
+/**
+ * @brief Function that reads the description of an index from the first block of its segment
+ * @param indexName index name
+ * @param info description
+ * @return address of the first block, EXIT_ERROR if the index is not a hash index
+ */
+static int AK_hash_read_info(char *indexName, hash_info *info)
+{
+    table_addresses addresses;
+    int address = AK_lookup_segment_addresses("AK_index", indexName, &addresses);
+
+    if (address == 0)
+        return EXIT_ERROR;
+    memcpy(info, AK_get_block(address)->block->data, sizeof (hash_info));
+    if (info->magic != AK_HASH_MAGIC)
+        return EXIT_ERROR;
+    return address;
+}
+
+/**
+ * @brief Function that writes the description of an index to the first block of its segment
+ * @param address first block of the index segment
+ * @param info description
+ */
+static void AK_hash_write_info(int address, hash_info *info)
+{
+    AK_mem_block *mem_block = AK_get_block(address);
+    memcpy(mem_block->block->data, info, sizeof (hash_info));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @brief Function that takes the next free block of the index segment and clears it, adding an extent if needed
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param info index, its last_block is advanced
+ * @return address of the block, EXIT_ERROR if the segment cannot grow
+ */
+static int AK_hash_new_block(char *indexName, int address, hash_info *info)
+{
+    AK_header header[MAX_ATTRIBUTES];
+    AK_mem_block *mem_block;
+    int start_address, end_address;
+
+    if (info->last_block + 1 >= info->extent_end)
+    {
+        memcpy(header, AK_get_block(address)->block->header, sizeof (header));
+        start_address = AK_new_index_extent(indexName, info->table_id, info->attribute_id[0], info->extent_size, header, &end_address);
+        if (start_address == EXIT_ERROR)
+            return EXIT_ERROR;
+        info->last_block = start_address - 1;
+        info->extent_end = end_address;
+        info->extent_size = end_address - start_address;
     }
+    info->last_block++;
 
-    AK_block *block = (AK_block*) AK_read_block(adr_to_write);
+    mem_block = AK_get_block(info->last_block);
+    memset(mem_block->block->data, 0, sizeof (mem_block->block->data));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    return info->last_block;
+}
 
-    AK_dbg_messg(HIGH, INDICES, "insert_bucket_to_block: Position to write (tuple_dict_index) %d\n", adr_to_write);
+/**
+ * @brief Function that determines the bucket of a hash value
+ * @param info index
+ * @param value hash value
+ * @return bucket number
+ */
+static int AK_hash_bucket_number(hash_info *info, uint64_t value)
+{
+    uint64_t n = (uint64_t) AK_HASH_INITIAL_BUCKETS << info->level;
+    uint64_t bucket = value % n;
 
-    switch (type) {
-        case MAIN_BUCKET:
-            size = sizeof (main_bucket);
-            break;
-        case HASH_BUCKET:
-            size = sizeof (hash_bucket);
+    if (bucket < (uint64_t) info->split)
+        bucket = value % (n * 2);
+    return (int) bucket;
+}
+
+/**
+ * @brief Function that reads the first block of a bucket from the directory
+ * @param info index
+ * @param bucket bucket number
+ * @return block address
+ */
+static int AK_hash_bucket_block(hash_info *info, int bucket)
+{
+    AK_block *block = AK_get_block(info->directory[bucket / AK_HASH_DIRECTORY_ENTRIES])->block;
+    return ((int *) block->data)[bucket % AK_HASH_DIRECTORY_ENTRIES];
+}
+
+/**
+ * @brief Function that adds a bucket with one empty block to the directory
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param info index, num_buckets is increased
+ * @return EXIT_SUCCESS, EXIT_ERROR if the directory is full or the segment cannot grow
+ */
+static int AK_hash_add_bucket(char *indexName, int address, hash_info *info)
+{
+    AK_mem_block *mem_block;
+    int bucket = info->num_buckets, directory = bucket / AK_HASH_DIRECTORY_ENTRIES, block_address;
+
+    if (directory >= AK_HASH_DIRECTORY_BLOCKS)
+        return EXIT_ERROR;
+    if (info->directory[directory] == 0 && (info->directory[directory] = AK_hash_new_block(indexName, address, info)) == EXIT_ERROR)
+    {
+        info->directory[directory] = 0;
+        return EXIT_ERROR;
+    }
+    if ((block_address = AK_hash_new_block(indexName, address, info)) == EXIT_ERROR)
+        return EXIT_ERROR;
+
+    mem_block = AK_get_block(info->directory[directory]);
+    ((int *) mem_block->block->data)[bucket % AK_HASH_DIRECTORY_ENTRIES] = block_address;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    info->num_buckets++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that appends an entry to the first block of a bucket with free space, chaining an overflow block
+ * to the bucket when all of its blocks are full
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param info index
+ * @param bucket bucket number
+ * @param elem entry
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_add_entry(char *indexName, int address, hash_info *info, int bucket, bucket_elem *elem)
+{
+    AK_mem_block *mem_block;
+    hash_bucket *header;
+    int block_address = AK_hash_bucket_block(info, bucket), overflow;
+
+    while (block_address != 0)
+    {
+        mem_block = AK_get_block(block_address);
+        header = (hash_bucket *) mem_block->block->data;
+        if (header->num_entries < info->bucket_capacity)
+        {
+            memcpy(mem_block->block->data + sizeof (hash_bucket) + header->num_entries * sizeof (bucket_elem), elem, sizeof (bucket_elem));
+            header->num_entries++;
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            return EXIT_SUCCESS;
+        }
+        if (header->overflow == 0)
+        {
+            if ((overflow = AK_hash_new_block(indexName, address, info)) == EXIT_ERROR)
+                return EXIT_ERROR;
+            /// the block may have left the cache while the new one was taken
+            mem_block = AK_get_block(block_address);
+            ((hash_bucket *) mem_block->block->data)->overflow = overflow;
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        }
+        block_address = ((hash_bucket *) AK_get_block(block_address)->block->data)->overflow;
+    }
+    return EXIT_ERROR;
+}
+
+/**
+ * @brief Function that splits the bucket at the split pointer. Its entries are divided between it and a new bucket
+ * by the next bit of their hash, and the split pointer moves on, starting a new round when all buckets are split.
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param info index
+ * @return EXIT_SUCCESS, EXIT_ERROR if the directory is full or the segment cannot grow
+ */
+static int AK_hash_split(char *indexName, int address, hash_info *info)
+{
+    bucket_elem elems[DATA_BLOCK_SIZE * DATA_ENTRY_SIZE / sizeof (bucket_elem)];
+    bucket_elem moved_elems[DATA_BLOCK_SIZE * DATA_ENTRY_SIZE / sizeof (bucket_elem)];
+    AK_mem_block *mem_block;
+    hash_bucket *header;
+    int bucket = info->split, new_bucket = info->num_buckets, block_address, count, kept, moved, i;
+
+    if (AK_hash_add_bucket(indexName, address, info) != EXIT_SUCCESS)
+        return EXIT_ERROR;
+    if (++info->split == AK_HASH_INITIAL_BUCKETS << info->level)
+    {
+        info->level++;
+        info->split = 0;
+    }
+
+    for (block_address = AK_hash_bucket_block(info, bucket); block_address != 0; block_address = header->overflow)
+    {
+        mem_block = AK_get_block(block_address);
+        header = (hash_bucket *) mem_block->block->data;
+        count = header->num_entries;
+        memcpy(elems, mem_block->block->data + sizeof (hash_bucket), count * sizeof (bucket_elem));
+        kept = 0;
+        moved = 0;
+        for (i = 0; i < count; i++)
+        {
+            if (AK_hash_bucket_number(info, elems[i].value) == bucket)
+                elems[kept++] = elems[i];
+            else
+                moved_elems[moved++] = elems[i];
+        }
+        memcpy(mem_block->block->data + sizeof (hash_bucket), elems, kept * sizeof (bucket_elem));
+        header->num_entries = kept;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        for (i = 0; i < moved; i++)
+            if (AK_hash_add_entry(indexName, address, info, new_bucket, &moved_elems[i]) != EXIT_SUCCESS)
+                return EXIT_ERROR;
+        header = (hash_bucket *) AK_get_block(block_address)->block->data;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that adds an entry to an index and splits buckets while the load factor is exceeded
+ * @param indexName index name
+ * @param address first block of the index segment
+ * @param info index
+ * @param hashValue hash value of the row
+ * @param add address of the row
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_insert_entry(char *indexName, int address, hash_info *info, uint64_t hashValue, struct_add *add)
+{
+    bucket_elem elem;
+
+    memset(&elem, 0, sizeof (bucket_elem));
+    elem.value = hashValue;
+    elem.add = *add;
+    if (AK_hash_add_entry(indexName, address, info, AK_hash_bucket_number(info, hashValue), &elem) != EXIT_SUCCESS)
+        return EXIT_ERROR;
+    info->num_entries++;
+    /// a full directory only makes the chains longer
+    while ((long long) info->num_entries * 100 > (long long) info->num_buckets * info->bucket_capacity * AK_HASH_LOAD_FACTOR)
+        if (AK_hash_split(indexName, address, info) != EXIT_SUCCESS)
             break;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that removes the entry of a row from its bucket, called under the write lock. The last entry of
+ * the block takes the place of the removed one.
+ * @param info index, num_entries is decreased
+ * @param hashValue hash value of the row
+ * @param add address of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row is not in the index
+ */
+static int AK_hash_delete_entry(hash_info *info, uint64_t hashValue, struct_add *add)
+{
+    AK_mem_block *mem_block;
+    hash_bucket *header;
+    bucket_elem *elems;
+    int block_address, i;
+
+    block_address = AK_hash_bucket_block(info, AK_hash_bucket_number(info, hashValue));
+    while (block_address != 0)
+    {
+        mem_block = AK_get_block(block_address);
+        header = (hash_bucket *) mem_block->block->data;
+        elems = (bucket_elem *) (mem_block->block->data + sizeof (hash_bucket));
+        for (i = 0; i < header->num_entries; i++)
+            if (elems[i].value == hashValue && elems[i].add.addBlock == add->addBlock && elems[i].add.indexTd == add->indexTd)
+            {
+                header->num_entries--;
+                memmove(&elems[i], &elems[header->num_entries], sizeof (bucket_elem));
+                AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                info->num_entries--;
+                return EXIT_SUCCESS;
+            }
+        block_address = header->overflow;
     }
-    id = block->last_tuple_dict_id + 1;
-    memcpy(&block->data[block->AK_free_space], data, size);
-    block->tuple_dict[id].address = block->AK_free_space;
-    block->AK_free_space += size;
-    block->tuple_dict[id].type = type;
-    block->tuple_dict[id].size = size;
-    block->last_tuple_dict_id = id;
-    AK_write_block(block);
-
-    add->addBlock = adr_to_write;
-    add->indexTd = id;
-    AK_EPI;
-    return add;
+    return EXIT_ERROR;
 }
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
+ * @brief Function that checks whether the indexed attributes of a row have the given values
+ * @param info index
+ * @param add address of the row
+ * @param values values in index order
+ * @return 1 if all values are equal, 0 otherwise
  */
-void AK_update_bucket_in_block(struct_add *add, char *data) {
-    AK_PRO;
-    AK_block *block = (AK_block*) AK_read_block(add->addBlock);
-    int address = block->tuple_dict[add->indexTd].address;
-    int size = block->tuple_dict[add->indexTd].size;
-    memcpy(&block->data[address], data, size);
-    AK_write_block(block);
-    AK_EPI;
+static int AK_hash_row_matches(hash_info *info, struct_add *add, struct list_node *values)
+{
+    AK_block *block = AK_get_block(add->addBlock)->block;
+    struct list_node *elem = AK_First_L2(values);
+    int i, td, size;
+
+    for (i = 0; i < info->num_attributes; i++, elem = AK_Next_L2(elem))
+    {
+        td = add->indexTd + info->attribute_id[i];
+        if (elem == NULL || block->tuple_dict[td].size <= 0 || block->tuple_dict[td].type != elem->type)
+            return 0;
+        size = AK_hash_value_size(elem->type, elem->data, elem->size);
+        if (AK_hash_value_size(elem->type, (const char *) &block->data[block->tuple_dict[td].address], block->tuple_dict[td].size) != size
+                || memcmp(&block->data[block->tuple_dict[td].address], elem->data, size) != 0)
+            return 0;
+    }
+    return 1;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
-  * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
+ * @brief Function that adds an index to the registry, called under the write lock
+ * @param indexName index name
+ * @param tblName indexed table
  */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num) {
-    AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
+static void AK_hash_registry_add(char *indexName, char *tblName)
+{
+    int i;
+
+    for (i = 0; i < AK_hash_registry_size; i++)
+        if (strcmp(AK_hash_registry[i].name, indexName) == 0)
+            return;
+    if (AK_hash_registry_size == AK_hash_registry_capacity)
+    {
+        AK_hash_registry_capacity = AK_hash_registry_capacity ? AK_hash_registry_capacity * 2 : 8;
+        AK_hash_registry = (AK_hash_registry_entry *) AK_realloc(AK_hash_registry,
+                AK_hash_registry_capacity * sizeof (AK_hash_registry_entry));
     }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = modulo;
-    info->main_bucket_num = main_bucket_num;
-    info->hash_bucket_num = hash_bucket_num;
-
-    memcpy(block->data, info, sizeof (hash_info));
-    block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    AK_write_block(block);
-    AK_EPI;
+    strcpy(AK_hash_registry[AK_hash_registry_size].name, indexName);
+    strcpy(AK_hash_registry[AK_hash_registry_size].table, tblName);
+    AK_hash_registry_size++;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
-  * @param indexName name of index
-  * @return info bucket with info data for hash index
+ * @brief Function that reads the hash indices of AK_index into the registry on first use, called under the write
+ * lock. AK_index holds one row per extent, so an index may be seen more than once.
  */
-hash_info* AK_get_hash_info(char *indexName) {
-    AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    memset(info, 0, sizeof (hash_info));
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
-	AK_EPI;
-        return info;
+static void AK_hash_registry_load()
+{
+    hash_info info;
+    AK_row_cursor cursor;
+    struct list_node *row;
+
+    if (AK_hash_registry_size >= 0)
+        return;
+    AK_hash_registry_size = 0;
+    AK_row_cursor_open(&cursor, "AK_index");
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        char *name = AK_Next_L2(AK_First_L2(row))->data;
+        if (AK_hash_read_info(name, &info) != EXIT_ERROR)
+            AK_hash_registry_add(name, info.table);
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
     }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    memcpy(info, block->data, sizeof (hash_info));
-    AK_EPI;
-    return info;
+}
+
+/**
+ * @brief Function that removes an index from the registry, called under the write lock
+ * @param indexName index name
+ */
+static void AK_hash_registry_remove(char *indexName)
+{
+    int i;
+
+    for (i = 0; i < AK_hash_registry_size; i++)
+        if (strcmp(AK_hash_registry[i].name, indexName) == 0)
+        {
+            AK_hash_registry[i] = AK_hash_registry[--AK_hash_registry_size];
+            return;
+        }
+}
+
+/**
+ * @brief Function that rebuilds an index before it is read if a row could not be added to or removed from it
+ * @param indexName index name
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such hash index
+ */
+static int AK_hash_refresh(char *indexName)
+{
+    hash_info info;
+    int address;
+
+    pthread_rwlock_rdlock(&AK_hash_lock);
+    address = AK_hash_read_info(indexName, &info);
+    pthread_rwlock_unlock(&AK_hash_lock);
+    if (address == EXIT_ERROR)
+        return EXIT_ERROR;
+    return info.stale ? AK_hash_rebuild(indexName) : EXIT_SUCCESS;
 }
 
 /**
   * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
+  * @brief Function that fetches the info for hash index
   * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
+  * @return info bucket with info data for hash index, zeroed if there is no such index
  */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n) {
-    int i = 0, j = 0, k = 0, counter = 0, end = 0;
+hash_info* AK_get_hash_info(char *indexName) {
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 301;
-    add->indexTd = 2;
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    while (addresses->address_from[i]) {
-        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                if (temp->tuple_dict[k].type == MAIN_BUCKET) {
-                    if (n == counter) {
-                        add->addBlock = j;
-                        add->indexTd = k;
-                        end = 1;
-                        break;
-                    }
-                    counter++;
-                }
-            }
-            if (end) break;
-        }
-        i++;
-    }
+    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
+    pthread_rwlock_rdlock(&AK_hash_lock);
+    if (AK_hash_read_info(indexName, info) == EXIT_ERROR)
+        memset(info, 0, sizeof (hash_info));
+    pthread_rwlock_unlock(&AK_hash_lock);
     AK_EPI;
-    return add;
-    AK_free(add);
+    return info;
 }
 
 /**
   *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
+  *  @brief Function that inserts a record in hash index
   *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
+  *  @param hashValue hash value of record that is being inserted, see AK_hash_values
+  *  @param add address of the record
+  *  @return EXIT_SUCCESS or EXIT_ERROR
  */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
-    int i, address, size, hash_AK_free_space = 0;
+int AK_insert_in_hash_index(char *indexName, uint64_t hashValue, struct_add *add) {
+    hash_info info;
+    int address, result = EXIT_ERROR;
     AK_PRO;
-    struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-    hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0)
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    if ((address = AK_hash_read_info(indexName, &info)) == EXIT_ERROR)
         printf("Hash index does not exist!\n");
     else {
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        if (info->main_bucket_num == 0) {
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                temp_main_bucket->element[i].value = i;
-                memset(&temp_main_bucket->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            main_add = AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
-
-            temp_hash_bucket->bucket_level = MAIN_BUCKET_SIZE;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket->element[i].value = -1;
-            }
-            memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
-
-                memcpy(&temp_main_bucket->element[i].add, hash_add, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-            AK_change_hash_info(indexName, MAIN_BUCKET_SIZE, 1, MAIN_BUCKET_SIZE);
-        }
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == -1) {
-                hash_AK_free_space = 1;
-                temp_hash_bucket->element[i].value = hashValue;
-                memcpy(&temp_hash_bucket->element[i].add, add, sizeof (struct_add));
-                memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-                AK_update_bucket_in_block(hash_add, data);
-                break;
-            }
-        }
-        if (hash_AK_free_space == 0) {
-
-            if (temp_hash_bucket->bucket_level == info->modulo) {
-                //adding new main buckets
-                for (i = 0; i < info->main_bucket_num; i++) {
-                    main_add = AK_get_nth_main_bucket_add(indexName, i);
-                    AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-                    address = temp_block->tuple_dict[main_add->indexTd].address;
-                    size = temp_block->tuple_dict[main_add->indexTd].size;
-                    memcpy(data, &temp_block->data[address], size);
-                    AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
-                }
-                AK_change_hash_info(indexName, info->modulo * 2, info->main_bucket_num * 2, info->hash_bucket_num);
-                info = AK_get_hash_info(indexName);
-            }
-            int hash_bucket_id2 = (hash_bucket_id + info->modulo / 2) % info->modulo;
-            int main_bucket_id2 = (int) (hash_bucket_id2 / MAIN_BUCKET_SIZE);
-
-            //swapping hash bucket id's
-            if (hash_bucket_id2 < hash_bucket_id) {
-                int temp = hash_bucket_id;
-                hash_bucket_id = hash_bucket_id2;
-                hash_bucket_id2 = temp;
-                temp = main_bucket_id;
-                main_bucket_id = main_bucket_id2;
-                main_bucket_id2 = temp;
-            }
-
-            hash_bucket *temp_hash_bucket2 = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-            temp_hash_bucket2->bucket_level = temp_hash_bucket->bucket_level * 2;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket2->element[i].value = -1;
-                memset(&temp_hash_bucket2->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(data, temp_hash_bucket2, sizeof (hash_bucket));
-            AK_update_bucket_in_block(hash_add, data);
-
-            main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id2);
-            temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-            address = temp_block->tuple_dict[main_add->indexTd].address;
-            size = temp_block->tuple_dict[main_add->indexTd].size;
-            memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-            hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
-            memcpy(&temp_main_bucket->element[hash_bucket_id2 % MAIN_BUCKET_SIZE].add, hash_add, sizeof (struct_add));
-            memcpy(data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-
-            AK_change_hash_info(indexName, info->modulo, info->main_bucket_num, info->hash_bucket_num + 1);
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                int value = temp_hash_bucket->element[i].value;
-                memcpy(main_add, &temp_hash_bucket->element[i].add, sizeof (struct_add));
-                AK_insert_in_hash_index(indexName, value, main_add);
-            }
-            AK_insert_in_hash_index(indexName, hashValue, add);
-        }
+        result = AK_hash_insert_entry(indexName, address, &info, hashValue, add);
+        AK_hash_write_info(address, &info);
     }
+    pthread_rwlock_unlock(&AK_hash_lock);
     AK_EPI;
+    return result;
 }
 
 /**
@@ -345,96 +624,44 @@ void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
   * @param indexName name of index
   * @param values list of values (one row) to search in hash index
   * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
+  * @return address structure with data where the record is in table, zeroed if it is not found
  */
-//Error: expected a ')'
 struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete) {
+    hash_info info;
+    list_ad candidates;
+    element_ad candidate;
+    uint64_t hashValue;
+    int address, found = 0;
     AK_PRO;
     struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
     memset(add, 0, sizeof (struct_add));
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0) {
+
+    /// a lookup is a batch of one key, the rows with its hash value are compared with the values
+    hashValue = AK_hash_values(values);
+    AK_InitializelistAd(&candidates);
+    if (AK_hash_probe(indexName, &hashValue, 1, &candidates) == EXIT_ERROR) {
         printf("Hash index does not exist!\n");
         AK_EPI;
         return add;
-    } else {
-        int hashValue = 0, address, size, i, j, k, found, match;
-        struct list_node *temp_elem;
-        temp_elem = AK_First_L2(values);
-        while (temp_elem) {
-            hashValue += AK_elem_hash_value(temp_elem);
-            temp_elem = AK_Next_L2(temp_elem);
-        }
-        struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-        hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == hashValue) {
-                AK_block *temp_table_block = (AK_block*) AK_read_block(temp_hash_bucket->element[i].add.addBlock);
-                j = 0;
-                while (strcmp(temp_block->header[j].att_name, "\0")) {
-                    k = 0;
-                    found = 0;
-                    while (strcmp(temp_table_block->header[k].att_name, "\0")) {
-                        if (strcmp(temp_block->header[j].att_name, temp_table_block->header[k].att_name) == 0) {
-                            found = 1;
-                            match = 0;
-                            int indexTd = temp_hash_bucket->element[i].add.indexTd + k;
-                            int record_address = temp_table_block->tuple_dict[indexTd].address;
-                            int record_size = temp_table_block->tuple_dict[indexTd].size;
-                            int record_type = temp_table_block->tuple_dict[indexTd].type;
-                            memcpy(data, &temp_table_block->data[record_address], record_size);
-                            temp_elem = (struct list_node *)AK_First_L2(values);
-                            while (temp_elem) {
-                                if (temp_elem->type == record_type && memcmp(data, &temp_elem->data, record_size) == 0)
-                                    match = 1;
-                                temp_elem = temp_elem->next;
-                            }
-                            break;
-                        }
-                        k++;
-                    }
-                    if (found == 0 || match == 0) break;
-                    j++;
-                }
-                if (match) {
-                    int addBlock = temp_hash_bucket->element[i].add.addBlock;
-                    int indexTd = temp_hash_bucket->element[i].add.indexTd;
-                    //Error: expected an expression
-                    if (delete==1) {
-                        temp_hash_bucket->element[i].value = -1;
-                        memcpy(data, temp_hash_bucket, sizeof (hash_bucket));
-                        AK_update_bucket_in_block(hash_add, data);
-                    } else
-                        AK_dbg_messg(HIGH, INDICES, "Record found in table block %d and TupleDict ID %d\n", addBlock, indexTd);
-                    add->addBlock = addBlock;
-                    add->indexTd = indexTd;
-                    break;
-                }
+    }
+    if (delete == DELETE)
+        pthread_rwlock_wrlock(&AK_hash_lock);
+    else
+        pthread_rwlock_rdlock(&AK_hash_lock);
+    if ((address = AK_hash_read_info(indexName, &info)) != EXIT_ERROR) {
+        for (candidate = candidates.next; !found && candidate != NULL; candidate = candidate->next)
+            if (AK_hash_row_matches(&info, &candidate->add, values)) {
+                *add = candidate->add;
+                found = 1;
             }
-        }
+        if (found && delete == DELETE) {
+            AK_hash_delete_entry(&info, hashValue, add);
+            AK_hash_write_info(address, &info);
+        } else if (found)
+            AK_dbg_messg(HIGH, INDICES, "Record found in table block %d and TupleDict ID %d\n", add->addBlock, add->indexTd);
     }
+    pthread_rwlock_unlock(&AK_hash_lock);
+    AK_Delete_All_elementsAd(&candidates);
     AK_EPI;
     return add;
 }
@@ -445,7 +672,6 @@ struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *valu
   * @param indexName name of index
   * @param values list of values (one row) to search in hash index
   * @return address structure with data where the record is in table
- 
  */
 struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values) {
     AK_PRO;
@@ -460,132 +686,500 @@ struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values) {
   * @param indexName name of index
   * @param values list of values (one row) to search in hash index
   * @return No return value
- 
  */
 void AK_delete_in_hash_index(char *indexName, struct list_node *values) {
     AK_PRO;
-    AK_find_delete_in_hash_index(indexName, values, DELETE);
+    AK_free(AK_find_delete_in_hash_index(indexName, values, DELETE));
+    AK_EPI;
+}
+
+static int AK_hash_probe_key_compare(const void *a, const void *b)
+{
+    const AK_hash_probe_key *x = (const AK_hash_probe_key *) a, *y = (const AK_hash_probe_key *) b;
+
+    if (x->bucket != y->bucket)
+        return x->bucket < y->bucket ? -1 : 1;
+    if (x->value != y->value)
+        return x->value < y->value ? -1 : 1;
+    return x->position - y->position;
+}
+
+/**
+ * @brief Function that probes a hash index with many keys at once, as the probe side of a join does. The keys are
+ * grouped by bucket, so every bucket is read once however many keys fall into it. The rows found have the same
+ * hash value as their key and have to be compared with it by the caller. AK_find_delete_in_hash_index looks a
+ * single key up as a batch of one.
+ * @param indexName index name
+ * @param hashes hash values of the keys, see AK_hash_values
+ * @param count number of keys
+ * @param results count lists, the addresses of the rows found for hashes[i] are appended to results[i]
+ * @return number of rows found, EXIT_ERROR if there is no such hash index
+ */
+int AK_hash_probe(char *indexName, uint64_t *hashes, int count, list_ad *results)
+{
+    hash_info info;
+    AK_hash_probe_key *keys;
+    element_ad *last;
+    AK_block *block;
+    bucket_elem *elems;
+    int i, j, k, low, high, block_address, num_entries, found = 0;
+    AK_PRO;
+
+    if (AK_hash_refresh(indexName) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    keys = (AK_hash_probe_key *) AK_malloc((count + 1) * sizeof (AK_hash_probe_key));
+    last = (element_ad *) AK_malloc((count + 1) * sizeof (element_ad));
+    for (i = 0; i < count; i++)
+        for (last[i] = &results[i]; last[i]->next != NULL; last[i] = last[i]->next);
+
+    pthread_rwlock_rdlock(&AK_hash_lock);
+    if (AK_hash_read_info(indexName, &info) == EXIT_ERROR)
+        found = EXIT_ERROR;
+    else
+    {
+        for (i = 0; i < count; i++)
+        {
+            keys[i].bucket = AK_hash_bucket_number(&info, hashes[i]);
+            keys[i].position = i;
+            keys[i].value = hashes[i];
+        }
+        qsort(keys, count, sizeof (AK_hash_probe_key), AK_hash_probe_key_compare);
+        for (i = 0; i < count; i = j)
+        {
+            for (j = i + 1; j < count && keys[j].bucket == keys[i].bucket; j++);
+            /// keys i..j-1 share the bucket and are sorted by hash
+            for (block_address = AK_hash_bucket_block(&info, keys[i].bucket); block_address != 0;
+                    block_address = ((hash_bucket *) block->data)->overflow)
+            {
+                block = AK_get_block(block_address)->block;
+                num_entries = ((hash_bucket *) block->data)->num_entries;
+                elems = (bucket_elem *) (block->data + sizeof (hash_bucket));
+                for (k = 0; k < num_entries; k++)
+                {
+                    for (low = i, high = j; low < high;)
+                    {
+                        int middle = (low + high) / 2;
+                        if (keys[middle].value < elems[k].value)
+                            low = middle + 1;
+                        else
+                            high = middle;
+                    }
+                    for (; low < j && keys[low].value == elems[k].value; low++)
+                    {
+                        int position = keys[low].position;
+                        AK_Insert_NewelementAd(elems[k].add.addBlock, elems[k].add.indexTd, NULL, last[position]);
+                        last[position] = last[position]->next;
+                        found++;
+                    }
+                }
+            }
+        }
+    }
+    pthread_rwlock_unlock(&AK_hash_lock);
+    AK_free(keys);
+    AK_free(last);
     AK_EPI;
+    return found;
 }
 
 /**
   * @author Mislav Čakarić
-  * @brief Function that creates a hash index
+  * @brief Function that creates a hash index. The rows of the table are read once and added to the index, which
+  * grows by splitting buckets as it fills. Rows inserted later are added by AK_insert_row, system tables cannot be
+  * indexed.
   * @param tblName name of table for which the index is being created
-  * @param indexName name of index
   * @param attributes list of attributes over which the index is being created
+  * @param indexName name of index
   * @return success or error
- 
  */
 int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName) {
-    int i, j, k, l, n, exist, hashValue;
+    hash_info info;
+    table_addresses existing;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_header *table_header, *temp;
+    bucket_elem *elems;
+    AK_row_cursor cursor;
+    struct list_node *attribute, *row, *el;
+    int num_attr, i, position, count = 0, capacity = 64, address, table_id, result = EXIT_SUCCESS;
+    uint64_t hashValue;
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    int num_attr = AK_num_attr(tblName);
-    AK_header *table_header = (AK_header *)AK_get_header(tblName);
-
-    AK_header i_header[ MAX_ATTRIBUTES ];
-    AK_header* temp;
-
-    struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
-    n = 0;
-    while (attribute != 0) {
-        exist = 0;
-        for (i = 0; i < num_attr; i++) {
-            if (strcmp((table_header + i)->att_name, attribute->data) == 0) {
-				AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-                exist = 1;
-                temp = (AK_header*) AK_create_header((table_header + i)->att_name, (table_header + i)->type, FREE_INT, FREE_CHAR, FREE_CHAR);
-                memcpy(i_header + n, temp, sizeof ( AK_header));
-                n++;
-                if ((table_header + 1)->type != TYPE_VARCHAR && (table_header + 1)->type != TYPE_INT) {
-                    printf("Unsupported data type for hash index! Only int and varchar!");
-                    AK_EPI;
-                    return EXIT_ERROR;
-                }
-            }
-        }
-        if (!exist) {
+
+    num_attr = AK_num_attr(tblName);
+    if (num_attr <= 0 || strncmp(tblName, "AK_", 3) == 0 || AK_lookup_segment_addresses("AK_index", indexName, &existing) != 0
+            || (table_id = AK_get_table_obj_id(tblName)) == EXIT_ERROR) {
+        AK_dbg_messg(LOW, INDICES, "AK_create_hash_index: Table %s does not exist or index %s already exists\n", tblName, indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(&info, 0, sizeof (hash_info));
+    memset(i_header, 0, sizeof (i_header));
+    table_header = (AK_header *) AK_get_header(tblName);
+    for (attribute = AK_First_L2(attributes); attribute != NULL; attribute = AK_Next_L2(attribute)) {
+        for (position = 0; position < num_attr; position++)
+            if (strcmp(table_header[position].att_name, attribute->data) == 0)
+                break;
+        if (position == num_attr || info.num_attributes == MAX_ATTRIBUTES) {
             printf("Atribut %s ne postoji u tablici", attribute->data);
+            AK_free(table_header);
             AK_EPI;
             return EXIT_ERROR;
         }
-        attribute = attribute->next;
+        AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", table_header[position].att_name, position);
+        strcpy(info.attributes[info.num_attributes], table_header[position].att_name);
+        info.attribute_id[info.num_attributes] = position;
+        info.attribute_type[info.num_attributes] = table_header[position].type;
+        temp = (AK_header*) AK_create_header(table_header[position].att_name, table_header[position].type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(i_header + info.num_attributes, temp, sizeof (AK_header));
+        AK_free(temp);
+        info.num_attributes++;
+    }
+    AK_free(table_header);
+    if (info.num_attributes == 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    info.magic = AK_HASH_MAGIC;
+    info.bucket_capacity = (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - sizeof (hash_bucket)) / sizeof (bucket_elem);
+    strcpy(info.table, tblName);
+    sprintf(info.table_id, "%d", table_id);
+
+    /// an entry points to the first tuple_dict entry of its row, rows with a missing value are not indexed
+    elems = (bucket_elem *) AK_malloc(capacity * sizeof (bucket_elem));
+    AK_row_cursor_open(&cursor, tblName);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL) {
+        hashValue = 0;
+        for (i = 0; i < info.num_attributes; i++) {
+            el = AK_GetNth_L2(info.attribute_id[i] + 1, row);
+            if (el == NULL || el->type != info.attribute_type[i])
+                break;
+            hashValue = AK_hash_bytes(el->data, AK_hash_value_size(el->type, el->data, el->size), hashValue);
+        }
+        if (i == info.num_attributes) {
+            if (count == capacity) {
+                capacity *= 2;
+                elems = (bucket_elem *) AK_realloc(elems, capacity * sizeof (bucket_elem));
+            }
+            elems[count].value = hashValue;
+            elems[count].add.addBlock = cursor.block;
+            elems[count].add.indexTd = cursor.slot - cursor.num_attr;
+            count++;
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
     }
-    memset(i_header + n, 0, MAX_ATTRIBUTES - n);
 
-    int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
-    if (startAddress != EXIT_ERROR)
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    address = AK_initialize_new_index_segment(indexName, info.table_id, info.attribute_id[0], i_header);
+    if (address == EXIT_ERROR)
+        result = EXIT_ERROR;
+    else {
         printf("\nINDEX %s CREATED!\n", indexName);
+        info.last_block = address;
+        info.extent_end = address + INITIAL_EXTENT_SIZE;
+        info.extent_size = INITIAL_EXTENT_SIZE;
+        for (i = 0; result == EXIT_SUCCESS && i < AK_HASH_INITIAL_BUCKETS; i++)
+            result = AK_hash_add_bucket(indexName, address, &info);
+        for (i = 0; result == EXIT_SUCCESS && i < count; i++) {
+            AK_dbg_messg(HIGH, INDICES, "Insert in hash index %d. record\n", i);
+            result = AK_hash_insert_entry(indexName, address, &info, elems[i].value, &elems[i].add);
+        }
+        info.stale = result != EXIT_SUCCESS;
+        AK_hash_write_info(address, &info);
+        if (AK_hash_registry_size >= 0)
+            AK_hash_registry_add(indexName, tblName);
+    }
+    pthread_rwlock_unlock(&AK_hash_lock);
+    AK_free(elems);
 
-    AK_block *block = (AK_block*) AK_read_block(startAddress);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = 4;
-    info->main_bucket_num = 0;
-    info->hash_bucket_num = 0;
-    memcpy(block->data, info, sizeof (hash_info));
-    block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    block->AK_free_space += sizeof (hash_info);
-    block->last_tuple_dict_id = 0;
-    AK_write_block(block);
-
-    struct list_node *temp_elem;
-
-    char data[ MAX_VARCHAR_LENGTH ];
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&row);
-    i = 0;
-    n = 0;
-    while (addresses->address_from[ i ]) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                n++;
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                for (l = 0; l < num_attr; l++) {
-                    int type = temp->tuple_dict[ k + l ].type;
-                    int size = temp->tuple_dict[ k + l ].size;
-                    int address = temp->tuple_dict[ k + l ].address;
-                    memcpy(data, &(temp->data[address]), size);
-                    data[ size ] = '\0';
-                    AK_InsertAtEnd_L3(type, data, size, row);
-                }
-                /* *************** */
-                hashValue = 0;
-                attribute = (struct list_node *) AK_First_L2(attributes);
-                while (attribute) {
-
-                    for (l = 0; l < num_attr; l++) {
-                        if (strcmp((table_header + l)->att_name, attribute->data) == 0)
-                            break;
-                    }
-                    temp_elem = AK_GetNth_L2(l, row);
-                    hashValue += AK_elem_hash_value(temp_elem);
+    if (result == EXIT_SUCCESS)
+        AK_dbg_messg(LOW, INDICES, "AK_create_hash_index: Index %s on %s: %d entries, %d buckets\n", indexName, tblName, count, info.num_buckets);
+    AK_EPI;
+    return result;
+}
 
-                    attribute = attribute->next;
-                }
-                AK_dbg_messg(HIGH, INDICES, "Insert in hash index %d. record\n", n);
-                struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-                add->addBlock = j;
-                add->indexTd = k;
-                AK_insert_in_hash_index(indexName, hashValue, add);
-                AK_DeleteAll_L3(&row);
-                /* *************** */
-            }
+/**
+  * @brief Function that deletes a hash index, releasing its extents and removing it from AK_index
+  * @param indexName name of index
+  * @return No return value
+ */
+void AK_delete_hash_index(char *indexName) {
+    hash_info info;
+    table_addresses *addresses;
+    int i;
+    AK_PRO;
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    if (AK_hash_read_info(indexName, &info) != EXIT_ERROR) {
+        /// AK_delete_segment looks up extents in AK_relation, index extents are released here
+        addresses = AK_get_index_addresses(indexName);
+        for (i = 0; addresses->address_from[i] != 0; i++)
+            AK_delete_extent(addresses->address_from[i], addresses->address_to[i] - 1);
+        AK_free(addresses);
+        AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+        AK_hash_registry_remove(indexName);
+        printf("INDEX %s DELETED!\n", indexName);
+    }
+    pthread_rwlock_unlock(&AK_hash_lock);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that finds a hash index whose key is the given attributes of a table, in the given order, among
+ * the indices in AK_index
+ * @param tblName table name
+ * @param num_attributes number of key attributes
+ * @param attributes key attribute names
+ * @param indexName name of the index found
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_hash_find_key(char *tblName, int num_attributes, char attributes[][MAX_ATT_NAME], char *indexName)
+{
+    hash_info info;
+    int i, j, found = EXIT_ERROR;
+    AK_PRO;
+
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    AK_hash_registry_load();
+    for (i = 0; found == EXIT_ERROR && i < AK_hash_registry_size; i++)
+    {
+        if (strcmp(AK_hash_registry[i].table, tblName) != 0 || AK_hash_read_info(AK_hash_registry[i].name, &info) == EXIT_ERROR
+                || info.num_attributes != num_attributes)
+            continue;
+        for (j = 0; j < num_attributes; j++)
+            if (strcmp(info.attributes[j], attributes[j]) != 0)
+                break;
+        if (j == num_attributes)
+        {
+            strcpy(indexName, AK_hash_registry[i].name);
+            found = EXIT_SUCCESS;
         }
-        i++;
     }
+    pthread_rwlock_unlock(&AK_hash_lock);
     AK_EPI;
-    return EXIT_SUCCESS;
+    return found;
 }
 
-void AK_delete_hash_index(char *indexName) {
+/**
+ * @brief Function that finds a hash index on an attribute of a table among the indices in AK_index. Only indices
+ * whose key is that single attribute are considered.
+ * @param tblName table name
+ * @param attName attribute name
+ * @param indexName name of the index found
+ * @return EXIT_SUCCESS, EXIT_ERROR if the attribute has no hash index
+ */
+int AK_hash_find(char *tblName, char *attName, char *indexName)
+{
+    char key[1][MAX_ATT_NAME];
+    int found;
+    AK_PRO;
+
+    strncpy(key[0], attName, MAX_ATT_NAME - 1);
+    key[0][MAX_ATT_NAME - 1] = '\0';
+    found = AK_hash_find_key(tblName, 1, key, indexName);
+    AK_EPI;
+    return found;
+}
+
+/**
+ * @brief Function that checks whether a table has a hash index
+ * @param tblName table name
+ * @return 1 if the table has a hash index, 0 otherwise
+ */
+int AK_hash_table_indexed(char *tblName)
+{
+    int i, indexed = 0;
+    AK_PRO;
+
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    AK_hash_registry_load();
+    for (i = 0; !indexed && i < AK_hash_registry_size; i++)
+        indexed = strcmp(AK_hash_registry[i].table, tblName) == 0;
+    pthread_rwlock_unlock(&AK_hash_lock);
+    AK_EPI;
+    return indexed;
+}
+
+/**
+ * @brief Function that names the hash index on a key of a table <table>_<attributes>_key. A name that would not fit
+ * into MAX_ATT_NAME is cut and gets a hash of the table and attribute names before _key, so that keys whose names
+ * only differ past the cut do not share an index name.
+ * @param tblName table name
+ * @param num_attributes number of key attributes
+ * @param attributes key attribute names
+ * @param indexName index name
+ */
+static void AK_hash_key_index_name(char *tblName, int num_attributes, char attributes[][MAX_ATT_NAME], char *indexName)
+{
+    char suffix[32];
+    uint64_t hash;
+    int i, length, suffix_length;
+
+    length = snprintf(indexName, MAX_ATT_NAME, "%s", tblName);
+    for (i = 0; i < num_attributes && length < MAX_ATT_NAME; i++)
+        length += snprintf(indexName + length, MAX_ATT_NAME - length, "_%s", attributes[i]);
+    if (length < MAX_ATT_NAME)
+        length += snprintf(indexName + length, MAX_ATT_NAME - length, "_key");
+    if (length < MAX_ATT_NAME)
+        return;
+
+    /// the terminating zeros keep the names apart, a_b;c and a;b_c hash differently
+    hash = AK_hash_bytes(tblName, strlen(tblName) + 1, 0);
+    for (i = 0; i < num_attributes; i++)
+        hash = AK_hash_bytes(attributes[i], strlen(attributes[i]) + 1, hash);
+    suffix_length = snprintf(suffix, sizeof (suffix), "_%016llx_key", (unsigned long long) hash);
+    strcpy(indexName + MAX_ATT_NAME - 1 - suffix_length, suffix);
+}
+
+/**
+ * @brief Function that finds the hash index on a key of a table and creates it if there is none. Foreign key and
+ * UNIQUE checks probe these indices, inserts keep them up to date like any other hash index.
+ * @param tblName table name
+ * @param num_attributes number of key attributes
+ * @param attributes key attribute names
+ * @param indexName name of the index found or created, named by AK_hash_key_index_name for a new one
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table cannot be indexed
+ */
+int AK_hash_key_index(char *tblName, int num_attributes, char attributes[][MAX_ATT_NAME], char *indexName)
+{
+    struct list_node *list;
+    int i, result;
+    AK_PRO;
+
+    if (num_attributes <= 0 || num_attributes > MAX_ATTRIBUTES || strncmp(tblName, "AK_", 3) == 0)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_hash_find_key(tblName, num_attributes, attributes, indexName) == EXIT_SUCCESS)
+    {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+    AK_hash_key_index_name(tblName, num_attributes, attributes, indexName);
+
+    list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&list);
+    for (i = 0; i < num_attributes; i++)
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, attributes[i], strlen(attributes[i]) + 1, list);
+    result = AK_create_hash_index(tblName, list, indexName);
+    AK_DeleteAll_L3(&list);
+    AK_free(list);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that builds a hash index again from the rows of its table, used for stale indices
+ * @param indexName index name
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_hash_rebuild(char *indexName)
+{
+    hash_info *info = AK_get_hash_info(indexName);
+    struct list_node *attributes;
+    int i, result = EXIT_ERROR;
+    AK_PRO;
+
+    if (info->magic == AK_HASH_MAGIC)
+    {
+        attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&attributes);
+        for (i = 0; i < info->num_attributes; i++)
+            AK_InsertAtEnd_L3(TYPE_ATTRIBS, info->attributes[i], strlen(info->attributes[i]) + 1, attributes);
+        AK_delete_hash_index(indexName);
+        result = AK_create_hash_index(info->table, attributes, indexName);
+        AK_DeleteAll_L3(&attributes);
+        AK_free(attributes);
+    }
+    AK_free(info);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that adds a row of a table to the hash indices of the table or removes it from them
+ * @param tblName table name
+ * @param row_root row
+ * @param addBlock block of the row
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ * @param insert 1 to add the row, 0 to remove it
+ */
+static void AK_hash_row_changed(char *tblName, struct list_node *row_root, int addBlock, int indexTd, int insert)
+{
+    hash_info info;
+    struct_add add;
+    struct list_node *el;
+    uint64_t hashValue;
+    int i, j, address, result;
+
+    /// system tables are not indexed, and AK_index rows are written while the lock is held
+    if (strncmp(tblName, "AK_", 3) == 0)
+        return;
+    add.addBlock = addBlock;
+    add.indexTd = indexTd;
+    pthread_rwlock_wrlock(&AK_hash_lock);
+    AK_hash_registry_load();
+    for (i = 0; i < AK_hash_registry_size; i++)
+    {
+        if (strcmp(AK_hash_registry[i].table, tblName) != 0
+                || (address = AK_hash_read_info(AK_hash_registry[i].name, &info)) == EXIT_ERROR || info.stale)
+            continue;
+        hashValue = 0;
+        for (j = 0; j < info.num_attributes; j++)
+        {
+            for (el = AK_First_L2(row_root); el != NULL; el = AK_Next_L2(el))
+                if (el->constraint == NEW_VALUE && strcmp(el->attribute_name, info.attributes[j]) == 0)
+                    break;
+            /// a missing value is written as VARCHAR "null" and is not indexed, the same as in AK_create_hash_index
+            if (el == NULL || el->type != info.attribute_type[j])
+                break;
+            hashValue = AK_hash_bytes(el->data, AK_hash_value_size(el->type, el->data, -1), hashValue);
+        }
+        if (j < info.num_attributes)
+            continue;
+        if (insert)
+            result = AK_hash_insert_entry(AK_hash_registry[i].name, address, &info, hashValue, &add);
+        else
+            result = AK_hash_delete_entry(&info, hashValue, &add);
+        /// the index no longer matches the rows and is rebuilt before it is read again
+        if (result != EXIT_SUCCESS)
+            info.stale = 1;
+        AK_hash_write_info(address, &info);
+    }
+    pthread_rwlock_unlock(&AK_hash_lock);
+}
+
+/**
+ * @brief Function that adds a new row of a table to the hash indices of the table, called by AK_insert_row
+ * @param tblName table name
+ * @param row_root inserted row
+ * @param addBlock block the row was written to
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ */
+void AK_hash_row_inserted(char *tblName, struct list_node *row_root, int addBlock, int indexTd)
+{
+    AK_PRO;
+    AK_hash_row_changed(tblName, row_root, addBlock, indexTd, 1);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that removes a deleted row of a table from the hash indices of the table, called by
+ * AK_delete_update_segment. The row is already gone from its block, so its entry is found by hash value and
+ * address rather than by comparing values as AK_delete_in_hash_index does. An updated row is removed with its old
+ * values and added again with the new ones.
+ * @param tblName table name
+ * @param row_root deleted row, as it was stored
+ * @param addBlock block of the row
+ * @param indexTd tuple_dict entry of the first attribute of the row
+ */
+void AK_hash_row_deleted(char *tblName, struct list_node *row_root, int addBlock, int indexTd)
+{
     AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
+    AK_hash_row_changed(tblName, row_root, addBlock, indexTd, 0);
     AK_EPI;
 }
 
@@ -599,13 +1193,15 @@ TestResult AK_hash_test() {
     int failedTest = 0;
     char *tblName = "student";
     char *indexName = "student_hash_index";
-    //AK_print_table("AK_relation");
+    char *nameIndex = "student_firstname_hash";
     AK_PRO;
     struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&att_list);
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
     AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname\0", 10, att_list);
 
+    /// the index is left for the drop test, a previous run may have left it as well
+    AK_delete_hash_index(indexName);
     if(AK_create_hash_index(tblName, att_list, indexName) == EXIT_ERROR){
     	failedTest++;
     }
@@ -613,45 +1209,235 @@ TestResult AK_hash_test() {
     	passedTest++;
     }
 
-    struct list_node *values = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&values);
-
-    //AK_delete_hash_index(indexName);
+    /// rows of the table with their addresses
+    AK_row_cursor cursor;
+    struct list_node *row;
+    int i, j, num_rec = 0, capacity = 64, errors;
+    struct_add *adds = (struct_add *) AK_malloc(capacity * sizeof (struct_add));
+    int *mbrs = (int *) AK_malloc(capacity * sizeof (int));
+    char (*names)[MAX_VARCHAR_LENGTH] = AK_malloc(capacity * MAX_VARCHAR_LENGTH);
+    AK_row_cursor_open(&cursor, tblName);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL) {
+        if (num_rec == capacity) {
+            capacity *= 2;
+            adds = (struct_add *) AK_realloc(adds, capacity * sizeof (struct_add));
+            mbrs = (int *) AK_realloc(mbrs, capacity * sizeof (int));
+            names = AK_realloc(names, capacity * MAX_VARCHAR_LENGTH);
+        }
+        adds[num_rec].addBlock = cursor.block;
+        adds[num_rec].indexTd = cursor.slot - cursor.num_attr;
+        memcpy(&mbrs[num_rec], AK_GetNth_L2(1, row)->data, sizeof (int));
+        memset(names[num_rec], 0, MAX_VARCHAR_LENGTH);
+        strncpy(names[num_rec], AK_GetNth_L2(2, row)->data, MAX_VARCHAR_LENGTH - 1);
+        num_rec++;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
 
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info = AK_get_hash_info(indexName);
-    if(info == NULL){
+    hash_info *info = AK_get_hash_info(indexName);
+    printf("Buckets:%d, Level:%d, Entries:%d\n", info->num_buckets, info->level, info->num_entries);
+    if(info->magic != AK_HASH_MAGIC || info->num_entries != num_rec){
     	failedTest++;
     }
     else{
     	passedTest++;
     }
-    printf("Main buckets:%d, Hash buckets:%d, Modulo:%d\n", info->main_bucket_num, info->hash_bucket_num, info->modulo);
-
-    //AK_delete_hash_index(indexName);
-    AK_print_table("AK_relation");
+    AK_free(info);
     AK_print_table("AK_index");
 
     printf("Hash index search test:\n");
-    int i, num_rec = AK_get_num_records(tblName);
+    struct list_node *values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&values);
+    errors = 0;
     for (i = 0; i < num_rec; i++) {
-        row = AK_get_row(i, tblName);
-        struct list_node *value = AK_GetNth_L2(1, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        value = AK_GetNth_L2(1, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &mbrs[i], sizeof (int), values);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, names[i], strlen(names[i]), values);
         struct_add *add = AK_find_in_hash_index(indexName, values);
-        if(add->addBlock == NULL){
-    		failedTest++;
-    	}
-    	else{
-    		passedTest++;
-    	}
+        if (add->addBlock != adds[i].addBlock || add->indexTd != adds[i].indexTd)
+            errors++;
+        AK_free(add);
+        AK_DeleteAll_L3(&values);
+    }
+    if(errors){
+    	failedTest++;
+    }
+    else{
+    	passedTest++;
+    }
+
+    printf("Hash index batched probe test:\n");
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname\0", 10, att_list);
+    AK_create_hash_index(tblName, att_list, nameIndex);
+    char found_index[MAX_ATT_NAME];
+    uint64_t *hashes = (uint64_t *) AK_malloc((num_rec + 3000) * sizeof (uint64_t));
+    list_ad *results = (list_ad *) AK_malloc((num_rec + 3000) * sizeof (list_ad));
+    for (i = 0; i < num_rec; i++) {
+        hashes[i] = AK_hash_bytes(names[i], strlen(names[i]), 0);
+        AK_InitializelistAd(&results[i]);
+    }
+    errors = AK_hash_find(tblName, "firstname", found_index) != EXIT_SUCCESS || strcmp(found_index, nameIndex) != 0;
+    AK_hash_probe(nameIndex, hashes, num_rec, results);
+    for (i = 0; i < num_rec; i++) {
+        int same = 0, found = 0, self = 0;
+        element_ad element;
+        for (j = 0; j < num_rec; j++)
+            same += strcmp(names[i], names[j]) == 0;
+        for (element = results[i].next; element != NULL; element = element->next) {
+            found++;
+            self |= element->add.addBlock == adds[i].addBlock && element->add.indexTd == adds[i].indexTd;
+        }
+        if (found != same || !self)
+            errors++;
+        AK_Delete_All_elementsAd(&results[i]);
+    }
+    if(errors){
+    	failedTest++;
+    }
+    else{
+    	passedTest++;
+    }
+
+    /// many entries split the buckets one by one, every entry stays reachable
+    printf("Hash index growth test:\n");
+    struct_add add;
+    for (i = 0; i < 3000; i++) {
+        add.addBlock = 0;
+        add.indexTd = i;
+        hashes[i] = AK_hash_bytes(&i, sizeof (int), 0);
+        AK_insert_in_hash_index(nameIndex, hashes[i], &add);
+        AK_InitializelistAd(&results[i]);
+    }
+    info = AK_get_hash_info(nameIndex);
+    printf("Buckets:%d, Level:%d, Entries:%d\n", info->num_buckets, info->level, info->num_entries);
+    errors = info->num_buckets <= AK_HASH_INITIAL_BUCKETS || info->num_entries != num_rec + 3000
+        || AK_hash_probe(nameIndex, hashes, 3000, results) != 3000;
+    for (i = 0; i < 3000; i++) {
+        if (results[i].next == NULL || results[i].next->add.indexTd != i)
+            errors++;
+        AK_Delete_All_elementsAd(&results[i]);
+    }
+    AK_free(info);
+    AK_delete_hash_index(nameIndex);
+    if(errors){
+    	failedTest++;
+    }
+    else{
+    	passedTest++;
+    }
+
+    /// a deleted row is removed from the index, an updated one is found by its new values only
+    printf("Hash index delete and update test:\n");
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    int changed_mbrs[3] = { 35893, 35892, 35894 };
+    char *changed_names[3] = { "Ana", "Aleksandrina", NULL };
+    AK_Init_L3(&row_root);
+    for (i = 0; i < 3; i++) {
+        AK_Update_Existing_Element(TYPE_INT, &changed_mbrs[i], tblName, "mbr", row_root);
+        if (changed_names[i] != NULL) {
+            AK_Insert_New_Element(TYPE_VARCHAR, changed_names[i], tblName, "firstname", row_root);
+            AK_update_row(row_root);
+        }
+        else
+            AK_delete_row(row_root);
+        AK_DeleteAll_L3(&row_root);
+    }
+    /// the rows read above may already hold the new values if the test ran before
+    info = AK_get_hash_info(indexName);
+    errors = info->stale;
+    for (i = 0; i < num_rec; i++) {
+        for (j = 0; j < 3 && mbrs[i] != changed_mbrs[j]; j++);
+        if (j == 3)
+            continue;
+        if (changed_names[j] == NULL || strcmp(names[i], changed_names[j]) != 0) {
+            AK_InsertAtEnd_L3(TYPE_INT, (char *) &mbrs[i], sizeof (int), values);
+            AK_InsertAtEnd_L3(TYPE_VARCHAR, names[i], strlen(names[i]), values);
+            struct_add *old_add = AK_find_in_hash_index(indexName, values);
+            errors += old_add->addBlock != 0;
+            AK_free(old_add);
+            AK_DeleteAll_L3(&values);
+        }
+        if (changed_names[j] == NULL) {
+            errors += info->num_entries != num_rec - 1;
+            continue;
+        }
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &mbrs[i], sizeof (int), values);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, changed_names[j], strlen(changed_names[j]), values);
+        struct_add *new_add = AK_find_in_hash_index(indexName, values);
+        errors += new_add->addBlock == 0;
+        AK_free(new_add);
         AK_DeleteAll_L3(&values);
-        if (add->addBlock && add->indexTd)
-            printf("Record found in table block %d and TupleDict ID %d\n", add->addBlock, add->indexTd);
     }
+    AK_free(info);
+    if(errors){
+    	failedTest++;
+    }
+    else{
+    	passedTest++;
+    }
+
+    /// an inserted row is added to the index and found, the old hash summed characters and mixed up anagrams
+    printf("Hash index maintenance test:\n");
+    int new_mbr = 35998, new_year = 2011;
+    float new_weight = 70.00;
+    AK_Insert_New_Element(TYPE_INT, &new_mbr, tblName, "mbr", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Hash", tblName, "firstname", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Index", tblName, "lastname", row_root);
+    AK_Insert_New_Element(TYPE_INT, &new_year, tblName, "year", row_root);
+    AK_Insert_New_Element(TYPE_FLOAT, &new_weight, tblName, "weight", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &new_mbr, sizeof (int), values);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "Hash", 4, values);
+    struct_add *new_add = AK_find_in_hash_index(indexName, values);
+    errors = new_add->addBlock == 0;
+    AK_free(new_add);
+    AK_delete_in_hash_index(indexName, values);
+    new_add = AK_find_in_hash_index(indexName, values);
+    errors += new_add->addBlock != 0;
+    AK_free(new_add);
+    AK_DeleteAll_L3(&values);
+    errors += AK_hash_bytes("ab", 2, 0) == AK_hash_bytes("ba", 2, 0);
+
+    AK_Update_Existing_Element(TYPE_INT, &new_mbr, tblName, "mbr", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    if(errors){
+    	failedTest++;
+    }
+    else{
+    	passedTest++;
+    }
+
+    /// key index names that would be cut at MAX_ATT_NAME stay apart
+    printf("Hash key index name test:\n");
+    char long_key[2][MAX_ATTRIBUTES][MAX_ATT_NAME], key_names[3][MAX_ATT_NAME];
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        snprintf(long_key[0][i], MAX_ATT_NAME, "long_attribute_name_of_a_key_%d", i);
+        snprintf(long_key[1][i], MAX_ATT_NAME, "long_attribute_name_of_a_key_%d", i == MAX_ATTRIBUTES - 1 ? -1 : i);
+    }
+    AK_hash_key_index_name(tblName, MAX_ATTRIBUTES, long_key[0], key_names[0]);
+    AK_hash_key_index_name(tblName, MAX_ATTRIBUTES, long_key[1], key_names[1]);
+    AK_hash_key_index_name(tblName, 1, long_key[0], key_names[2]);
+    errors = strcmp(key_names[0], key_names[1]) == 0 || strlen(key_names[0]) != MAX_ATT_NAME - 1
+        || strcmp(key_names[0] + MAX_ATT_NAME - 5, "_key") != 0 || strcmp(key_names[2], "student_long_attribute_name_of_a_key_0_key") != 0;
+    if(errors){
+    	failedTest++;
+    }
+    else{
+    	passedTest++;
+    }
+
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    AK_free(values);
+    AK_free(hashes);
+    AK_free(results);
+    AK_free(adds);
+    AK_free(mbrs);
+    AK_free(names);
     printf("hash_test: Present!\n");
     AK_EPI;
     return TEST_result(passedTest,failedTest);
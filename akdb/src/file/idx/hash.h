@@ -28,18 +28,60 @@
 #include "../files.h"
 #include "../../auxi/mempro.h"
 
+/**
+ * @def AK_HASH_MAGIC
+ * @brief Marks the first block of a hash index segment
+ */
+#define AK_HASH_MAGIC 0x48415348
+
+/**
+ * @def AK_HASH_INITIAL_BUCKETS
+ * @brief Number of buckets of a new index, the index doubles from it one bucket at a time
+ */
+#define AK_HASH_INITIAL_BUCKETS 4
+
+/**
+ * @def AK_HASH_LOAD_FACTOR
+ * @brief Percentage of the bucket capacity the entries may fill before the next bucket is split
+ */
+#define AK_HASH_LOAD_FACTOR 75
+
+/**
+ * @def AK_HASH_DIRECTORY_BLOCKS
+ * @brief Maximum number of blocks holding the addresses of the buckets
+ */
+#define AK_HASH_DIRECTORY_BLOCKS 64
+
 /**
  * @author Unknown
  * @struct hash_info
- * @brief Structure for defining a hash info element
+ * @brief Description of a linear hash index kept in the first block of its segment
 */
 typedef struct {
-	/// modulo value for hash function
-    int modulo;
-    /// bucket number
-    int main_bucket_num;
-    /// hash bucket number
-    int hash_bucket_num;
+    /// AK_HASH_MAGIC
+    int magic;
+    /// buckets are addressed by hash mod AK_HASH_INITIAL_BUCKETS * 2^level, split is the next bucket to split
+    int level;
+    int split;
+    int num_buckets;
+    int num_entries;
+    /// entries a bucket block can hold
+    int bucket_capacity;
+    /// 1 if a row could not be added to or removed from the index, which is then rebuilt before it is read
+    int stale;
+    /// last block given to a bucket, end of its extent and number of blocks in that extent
+    int last_block;
+    int extent_end;
+    int extent_size;
+    /// indexed table and attributes, the first attribute is registered in AK_index
+    char table[MAX_ATT_NAME];
+    char table_id[MAX_ATT_NAME];
+    int num_attributes;
+    char attributes[MAX_ATTRIBUTES][MAX_ATT_NAME];
+    int attribute_id[MAX_ATTRIBUTES];
+    int attribute_type[MAX_ATTRIBUTES];
+    /// blocks holding the block of every bucket, in bucket order
+    int directory[AK_HASH_DIRECTORY_BLOCKS];
 } hash_info;
 
 /**
@@ -48,148 +90,41 @@ typedef struct {
  * @brief Structure for defining a single bucket element
  */
 typedef struct {
-	/// bucket element hash value
-    unsigned int value;
-    /// bucket element address values
+    /// hash value of the indexed attributes of the row
+    uint64_t value;
+    /// address of the row
     struct_add add;
 } bucket_elem;
 
-/**
- * @author Unknown
- * @struct main_bucket
- * @brief Structure for defining main bucket for table hashing
- */
-typedef struct {
-	/// main bucket array of bucket_elem elements
-    bucket_elem element[MAIN_BUCKET_SIZE];
-} main_bucket;
-
 /**
  * @author Unknown
  * @struct hash_bucket
- * @brief Structure for hash bucket for table hashing
+ * @brief Header of a bucket block, followed by its bucket_elem entries
  */
 typedef struct {
-	/// hash bucket level
-    int bucket_level;
-    /// hash bucket array of bucket_elem elements
-    bucket_elem element[HASH_BUCKET_SIZE];
+    int num_entries;
+    /// next block of a bucket that overflowed, 0 if there is none
+    int overflow;
 } hash_bucket;
 
-/**
-  * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
-  * @param elem element of row for wich value is to be computed
-  * @return hash value
- 
- */
-int AK_elem_hash_value(struct list_node *elem);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
- */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type);
-
-/**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
- */
-void AK_update_bucket_in_block(struct_add *add, char *data);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
-  * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
- */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
-  * @param indexName name of index
-  * @return info bucket with info data for hash index
- */
+uint64_t AK_hash_bytes(const void *data, int size, uint64_t seed);
+uint64_t AK_elem_hash_value(struct list_node *elem);
+uint64_t AK_hash_values(struct list_node *values);
 hash_info* AK_get_hash_info(char *indexName);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
-  * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
- */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n);
-
-/**
-  *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
-  *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
- */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that fetches or deletes a record from hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
- */
+int AK_insert_in_hash_index(char *indexName, uint64_t hashValue, struct_add *add);
 struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that fetches a record from the hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return address structure with data where the record is in table
- 
- */
 struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that deletes a record from the hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return No return value
- 
- */
 void AK_delete_in_hash_index(char *indexName, struct list_node *values);
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that creates a hash index
-  * @param tblName name of table for which the index is being created
-  * @param indexName name of index
-  * @param attributes list of attributes over which the index is being created
-  * @return success or error
- 
- */
+int AK_hash_probe(char *indexName, uint64_t *hashes, int count, list_ad *results);
 int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName);
-void AK_delete_hash_index(char *indexName) ;
-
-/**
-  * @author Mislav Čakarić
-  * @brief Function that tests hash index
-  * @return No return value 
- */
+void AK_delete_hash_index(char *indexName);
+int AK_hash_find_key(char *tblName, int num_attributes, char attributes[][MAX_ATT_NAME], char *indexName);
+int AK_hash_find(char *tblName, char *attName, char *indexName);
+int AK_hash_table_indexed(char *tblName);
+int AK_hash_key_index(char *tblName, int num_attributes, char attributes[][MAX_ATT_NAME], char *indexName);
+int AK_hash_rebuild(char *indexName);
+void AK_hash_row_inserted(char *tblName, struct list_node *row_root, int addBlock, int indexTd);
+void AK_hash_row_deleted(char *tblName, struct list_node *row_root, int addBlock, int indexTd);
 TestResult AK_hash_test();
 
 #endif
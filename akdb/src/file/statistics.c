@@ -0,0 +1,1139 @@
+/**
+@file statistics.c Provides table and column statistics for cost estimates
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "statistics.h"
+
+/*
+ * AK_analyze reads a table once and gathers its row and block counts and, for every column, a HyperLogLog sketch
+ * of its distinct values, its minimum and maximum and, for numeric columns, an equi-depth histogram placed on a
+ * sample of the values. The statistics are stored in AK_statistics, one row per column, and held in memory for the
+ * estimates. AK_insert_row adds every new row to the statistics of its table and a delete or update takes the old
+ * row out of the row count and the histogram, so they stay current without reading the table again; distinct
+ * counts and bounds are kept as they are until enough rows changed, and the table is then analyzed again by
+ * AK_statistics_flush. Estimates never read a table: one that was not analyzed gets the defaults until the next
+ * AK_statistics_flush analyzes it. Statistics changed by inserts, deletes and updates are written to AK_statistics
+ * by AK_statistics_flush.
+ */
+
+/// statistics of the analyzed tables, read from AK_statistics on first use (guarded by AK_statistics_mutex)
+static pthread_mutex_t AK_statistics_mutex = PTHREAD_MUTEX_INITIALIZER;
+static AK_table_statistics *AK_statistics_registry;
+static int AK_statistics_registry_size = -1;
+static int AK_statistics_registry_capacity;
+
+/**
+ * @brief Function that tells whether the values of a type are kept as numbers
+ * @param type data type
+ * @return 1 for INT, FLOAT, NUMBER, DATE, DATETIME and TIME, 0 otherwise
+ */
+static int AK_statistics_numeric(int type)
+{
+    return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_NUMBER || type == TYPE_DATE || type == TYPE_DATETIME
+            || type == TYPE_TIME;
+}
+
+/**
+ * @brief Function that gives the number of bytes that make up a value, FLOAT values are stored as float
+ * @param type data type
+ * @param data bytes of the value
+ * @param size stored size, -1 if unknown
+ * @return number of bytes
+ */
+static int AK_statistics_value_size(int type, const char *data, int size)
+{
+    switch (type)
+    {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            return sizeof (int);
+        case TYPE_FLOAT:
+            return sizeof (float);
+        case TYPE_NUMBER:
+            return sizeof (double);
+        default:
+            return size >= 0 ? (int) strnlen(data, size) : (int) strlen(data);
+    }
+}
+
+/**
+ * @brief Function that reads a numeric value
+ * @param type numeric data type
+ * @param data bytes of the value
+ * @return value
+ */
+static double AK_statistics_number(int type, const void *data)
+{
+    int int_value;
+    float float_value;
+    double double_value;
+
+    if (type == TYPE_FLOAT)
+    {
+        memcpy(&float_value, data, sizeof (float));
+        return float_value;
+    }
+    if (type == TYPE_NUMBER)
+    {
+        memcpy(&double_value, data, sizeof (double));
+        return double_value;
+    }
+    memcpy(&int_value, data, sizeof (int));
+    return int_value;
+}
+
+/**
+ * @brief Function that computes the natural logarithm of a number not smaller than 1
+ * @param x number
+ * @return ln(x)
+ */
+static double AK_statistics_log(double x)
+{
+    double result = 0, t, power, term;
+    int k;
+
+    while (x >= 2)
+    {
+        x /= 2;
+        result += 0.69314718055994530942;
+    }
+    /// ln(x) = 2 atanh((x - 1) / (x + 1)), with (x - 1) / (x + 1) below 1/3
+    t = (x - 1) / (x + 1);
+    power = t;
+    for (k = 1; k < 40; k += 2)
+    {
+        term = power / k;
+        result += 2 * term;
+        power *= t * t;
+    }
+    return result;
+}
+
+/**
+ * @brief Function that adds a value to the sketch and bounds of a column
+ * @param column column statistics
+ * @param data bytes of the value, of the type of the column
+ * @param size stored size, -1 if unknown
+ */
+static void AK_statistics_add_value(AK_column_statistics *column, const char *data, int size)
+{
+    char text[AK_STATISTICS_VALUE];
+    uint64_t hash, rest;
+    double number;
+    int rank;
+
+    size = AK_statistics_value_size(column->type, data, size);
+    hash = AK_hash_bytes(data, size, 0);
+    /// the first bits choose the register, it keeps the longest run of leading zeros seen in the rest
+    rest = hash << AK_STATISTICS_HLL_BITS;
+    for (rank = 1; rank <= 64 - AK_STATISTICS_HLL_BITS && !(rest & ((uint64_t) 1 << 63)); rank++)
+        rest <<= 1;
+    if (rank > column->sketch[hash >> (64 - AK_STATISTICS_HLL_BITS)])
+        column->sketch[hash >> (64 - AK_STATISTICS_HLL_BITS)] = rank;
+
+    if (AK_statistics_numeric(column->type))
+    {
+        number = AK_statistics_number(column->type, data);
+        if (!column->has_bounds || number < column->min)
+            column->min = number;
+        if (!column->has_bounds || number > column->max)
+            column->max = number;
+        column->has_bounds = 1;
+    }
+    else if (column->type == TYPE_VARCHAR)
+    {
+        size = size < AK_STATISTICS_VALUE - 1 ? size : AK_STATISTICS_VALUE - 1;
+        memcpy(text, data, size);
+        text[size] = '\0';
+        if (!column->has_bounds || strcmp(text, column->min_text) < 0)
+            strcpy(column->min_text, text);
+        if (!column->has_bounds || strcmp(text, column->max_text) > 0)
+            strcpy(column->max_text, text);
+        column->has_bounds = 1;
+    }
+}
+
+/**
+ * @brief Function that adds an inserted value to the histogram of a numeric column, widening the outer buckets if
+ * the value is out of the bounds. The buckets are placed again by the next AK_analyze.
+ * @param column column statistics
+ * @param number value
+ */
+static void AK_statistics_add_to_histogram(AK_column_statistics *column, double number)
+{
+    int i;
+
+    if (column->num_buckets == 0)
+    {
+        column->num_buckets = 1;
+        column->bounds[0] = column->bounds[1] = number;
+    }
+    if (number < column->bounds[0])
+        column->bounds[0] = number;
+    if (number > column->bounds[column->num_buckets])
+        column->bounds[column->num_buckets] = number;
+    for (i = 0; i < column->num_buckets - 1 && number > column->bounds[i + 1]; i++)
+        ;
+    column->depths[i]++;
+}
+
+/**
+ * @brief Function that takes a deleted value out of the histogram of a numeric column, the bounds are kept
+ * @param column column statistics
+ * @param number value
+ */
+static void AK_statistics_remove_from_histogram(AK_column_statistics *column, double number)
+{
+    int i;
+
+    for (i = 0; i < column->num_buckets - 1 && number > column->bounds[i + 1]; i++)
+        ;
+    if (column->num_buckets > 0 && column->depths[i] > 0)
+        column->depths[i]--;
+}
+
+/**
+ * @brief Function that estimates the number of distinct values of a column from its sketch
+ * @param column column statistics
+ * @param row_count number of rows of the table, the estimate is not larger
+ * @return estimated number of distinct values
+ */
+static int AK_statistics_estimate_ndv(AK_column_statistics *column, int row_count)
+{
+    double m = AK_STATISTICS_HLL_REGISTERS, sum = 0, estimate;
+    int i, zeros = 0;
+
+    for (i = 0; i < AK_STATISTICS_HLL_REGISTERS; i++)
+    {
+        sum += 1.0 / (double) ((uint64_t) 1 << column->sketch[i]);
+        zeros += column->sketch[i] == 0;
+    }
+    if (zeros == AK_STATISTICS_HLL_REGISTERS || row_count <= 0)
+        return 0;
+    estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    /// small counts leave registers empty and are estimated by linear counting
+    if (estimate <= 2.5 * m && zeros > 0)
+        estimate = m * AK_statistics_log(m / zeros);
+    if (estimate > row_count)
+        estimate = row_count;
+    return estimate < 1 ? 1 : (int) (estimate + 0.5);
+}
+
+/**
+ * @brief Function that compares two doubles for qsort
+ * @param a first value
+ * @param b second value
+ * @return result of comparison
+ */
+static int AK_statistics_compare(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Function that reads a table and gathers its statistics
+ * @param tblName table name
+ * @param stats statistics
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist or is a system table
+ */
+static int AK_statistics_collect(char *tblName, AK_table_statistics *stats)
+{
+    AK_tuple_schema *schema;
+    AK_tuple *tuple;
+    AK_tuple_value *value;
+    AK_column_statistics *column;
+    AK_row_cursor cursor;
+    table_addresses addresses;
+    double *sample[MAX_ATTRIBUTES];
+    int seen[MAX_ATTRIBUTES];
+    unsigned int seed = 1;
+    int i, j, n;
+
+    /// inserts into system tables do not maintain statistics
+    if (strncmp(tblName, "AK_", 3) == 0 || (schema = AK_tuple_schema_create(tblName)) == NULL)
+        return EXIT_ERROR;
+    memset(stats, 0, sizeof (AK_table_statistics));
+    strncpy(stats->table, tblName, MAX_ATT_NAME - 1);
+    stats->first_block = AK_lookup_table_addresses(tblName, &addresses);
+    stats->analyzed = 1;
+    stats->num_attr = schema->num_attr;
+    for (i = 0; i < schema->num_attr; i++)
+    {
+        strcpy(stats->column[i].att_name, schema->header[i].att_name);
+        stats->column[i].type = schema->header[i].type;
+        sample[i] = AK_statistics_numeric(schema->header[i].type)
+                ? (double *) AK_malloc(AK_STATISTICS_SAMPLE * sizeof (double)) : NULL;
+        seen[i] = 0;
+    }
+
+    tuple = AK_tuple_create(schema);
+    if (AK_row_cursor_open(&cursor, tblName) == EXIT_SUCCESS)
+    {
+        while (AK_row_cursor_next_tuple(&cursor, tuple) == EXIT_SUCCESS)
+        {
+            if (cursor.block != stats->last_block)
+            {
+                stats->block_count++;
+                stats->last_block = cursor.block;
+            }
+            stats->row_count++;
+            for (i = 0; i < tuple->num_values; i++)
+            {
+                value = &tuple->values[i];
+                column = &stats->column[value->ordinal];
+                if (value->type != column->type)
+                    continue;
+                AK_statistics_add_value(column, AK_tuple_data(tuple, i), value->length);
+                if (sample[value->ordinal] == NULL)
+                    continue;
+                /// reservoir sampling keeps every value with the same probability
+                n = seen[value->ordinal]++;
+                j = n < AK_STATISTICS_SAMPLE ? n : rand_r(&seed) % (n + 1);
+                if (j < AK_STATISTICS_SAMPLE)
+                    sample[value->ordinal][j] = AK_statistics_number(column->type, AK_tuple_data(tuple, i));
+            }
+        }
+    }
+    AK_tuple_free(tuple);
+    AK_tuple_schema_free(schema);
+
+    for (i = 0; i < stats->num_attr; i++)
+    {
+        column = &stats->column[i];
+        n = seen[i] < AK_STATISTICS_SAMPLE ? seen[i] : AK_STATISTICS_SAMPLE;
+        if (sample[i] != NULL && n > 0)
+        {
+            qsort(sample[i], n, sizeof (double), AK_statistics_compare);
+            column->num_buckets = n < AK_STATISTICS_BUCKETS ? n : AK_STATISTICS_BUCKETS;
+            for (j = 0; j <= column->num_buckets; j++)
+                column->bounds[j] = sample[i][(long) j * (n - 1) / column->num_buckets];
+            column->bounds[0] = column->min;
+            column->bounds[column->num_buckets] = column->max;
+            for (j = 0; j < column->num_buckets; j++)
+                column->depths[j] = seen[i] / column->num_buckets + (j < seen[i] % column->num_buckets);
+        }
+        AK_free(sample[i]);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that finds the statistics of a table in the registry, called under the mutex. Statistics of a
+ * table that was dropped and created again are removed.
+ * @param tblName table name
+ * @return statistics in the registry, NULL if the table was not analyzed
+ */
+static AK_table_statistics *AK_statistics_find(char *tblName)
+{
+    table_addresses addresses;
+    int i;
+
+    for (i = 0; i < AK_statistics_registry_size; i++)
+    {
+        if (strcmp(AK_statistics_registry[i].table, tblName) != 0)
+            continue;
+        if (AK_statistics_registry[i].first_block == AK_lookup_table_addresses(tblName, &addresses))
+            return &AK_statistics_registry[i];
+        AK_statistics_registry[i] = AK_statistics_registry[--AK_statistics_registry_size];
+        return NULL;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function that adds statistics to the registry or replaces the ones of the same table, called under the
+ * mutex
+ * @param stats statistics
+ * @return statistics in the registry
+ */
+static AK_table_statistics *AK_statistics_put(AK_table_statistics *stats)
+{
+    int i;
+
+    for (i = 0; i < AK_statistics_registry_size; i++)
+        if (strcmp(AK_statistics_registry[i].table, stats->table) == 0)
+            break;
+    if (i == AK_statistics_registry_size)
+    {
+        if (AK_statistics_registry_size == AK_statistics_registry_capacity)
+        {
+            AK_statistics_registry_capacity = AK_statistics_registry_capacity ? AK_statistics_registry_capacity * 2 : 8;
+            AK_statistics_registry = (AK_table_statistics *) AK_realloc(AK_statistics_registry,
+                    AK_statistics_registry_capacity * sizeof (AK_table_statistics));
+        }
+        AK_statistics_registry_size++;
+    }
+    memcpy(&AK_statistics_registry[i], stats, sizeof (AK_table_statistics));
+    return &AK_statistics_registry[i];
+}
+
+/**
+ * @brief Function that reads a row of AK_statistics into the statistics of its table, called under the mutex
+ * @param row row of AK_statistics
+ */
+static void AK_statistics_load_row(struct list_node *row)
+{
+    AK_table_statistics *stats, loaded;
+    AK_column_statistics *column;
+    AK_tuple_schema *schema;
+    table_addresses addresses;
+    struct list_node *el[9];
+    char *p, *end;
+    int i, ndv;
+
+    for (el[0] = AK_First_L2(row), i = 1; i < 9 && el[i - 1] != NULL; i++)
+        el[i] = AK_Next_L2(el[i - 1]);
+    if (el[8] == NULL)
+        return;
+    if ((stats = AK_statistics_find(el[0]->data)) == NULL)
+    {
+        if ((schema = AK_tuple_schema_create(el[0]->data)) == NULL)
+            return;
+        memset(&loaded, 0, sizeof (AK_table_statistics));
+        strncpy(loaded.table, el[0]->data, MAX_ATT_NAME - 1);
+        loaded.first_block = AK_lookup_table_addresses(loaded.table, &addresses);
+        loaded.analyzed = 1;
+        loaded.num_attr = schema->num_attr;
+        for (i = 0; i < schema->num_attr; i++)
+        {
+            strcpy(loaded.column[i].att_name, schema->header[i].att_name);
+            loaded.column[i].type = schema->header[i].type;
+        }
+        AK_tuple_schema_free(schema);
+        stats = AK_statistics_put(&loaded);
+    }
+    memcpy(&stats->row_count, el[2]->data, sizeof (int));
+    memcpy(&stats->block_count, el[3]->data, sizeof (int));
+    for (i = 0; i < stats->num_attr && strcmp(stats->column[i].att_name, el[1]->data) != 0; i++)
+        ;
+    if (i == stats->num_attr)
+        return;
+    column = &stats->column[i];
+    memcpy(&ndv, el[4]->data, sizeof (int));
+    column->has_bounds = ndv > 0;
+    if (AK_statistics_numeric(column->type))
+    {
+        column->min = strtod(el[5]->data, NULL);
+        column->max = strtod(el[6]->data, NULL);
+    }
+    else if (column->type == TYPE_VARCHAR)
+    {
+        strncpy(column->min_text, el[5]->data, AK_STATISTICS_VALUE - 1);
+        strncpy(column->max_text, el[6]->data, AK_STATISTICS_VALUE - 1);
+    }
+    for (i = 0; i < AK_STATISTICS_HLL_REGISTERS && el[7]->data[i] != '\0'; i++)
+        column->sketch[i] = el[7]->data[i] - 'A';
+    /// the histogram is written as "bounds;depths"
+    p = el[8]->data;
+    column->num_buckets = 0;
+    for (i = 0; i <= AK_STATISTICS_BUCKETS; i++, p = end)
+    {
+        column->bounds[i] = strtod(p, &end);
+        if (end == p)
+            break;
+    }
+    if (*p == ';' && i > 1)
+    {
+        column->num_buckets = i - 1;
+        for (i = 0, p++; i < column->num_buckets; i++, p = end)
+            column->depths[i] = (int) strtol(p, &end, 10);
+    }
+}
+
+/**
+ * @brief Function that reads AK_statistics into the registry on first use, called under the mutex
+ */
+static void AK_statistics_registry_load()
+{
+    AK_row_cursor cursor;
+    struct list_node *row;
+
+    if (AK_statistics_registry_size >= 0)
+        return;
+    AK_statistics_registry_size = 0;
+    if (AK_row_cursor_open(&cursor, "AK_statistics") != EXIT_SUCCESS)
+        return;
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        AK_statistics_load_row(row);
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+}
+
+/**
+ * @brief Function that writes the statistics of a table to AK_statistics, replacing the rows it had there
+ * @param stats statistics
+ */
+static void AK_statistics_store(AK_table_statistics *stats)
+{
+    AK_column_statistics *column;
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    char min[AK_STATISTICS_VALUE], max[AK_STATISTICS_VALUE], sketch[AK_STATISTICS_HLL_REGISTERS + 1];
+    char histogram[MAX_VARCHAR_LENGTH];
+    int i, j, ndv, length;
+
+    AK_Init_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_VARCHAR, stats->table, "AK_statistics", "tableName", row_root);
+    AK_delete_row(row_root);
+    for (i = 0; i < stats->num_attr; i++)
+    {
+        column = &stats->column[i];
+        ndv = AK_statistics_estimate_ndv(column, stats->row_count);
+        /// an empty VARCHAR would be read as a deleted row
+        strcpy(min, "null");
+        strcpy(max, "null");
+        if (column->has_bounds && AK_statistics_numeric(column->type))
+        {
+            snprintf(min, sizeof (min), "%.17g", column->min);
+            snprintf(max, sizeof (max), "%.17g", column->max);
+        }
+        else if (column->has_bounds && column->type == TYPE_VARCHAR && column->min_text[0] != '\0')
+        {
+            strcpy(min, column->min_text);
+            strcpy(max, column->max_text);
+        }
+        for (j = 0; j < AK_STATISTICS_HLL_REGISTERS; j++)
+            sketch[j] = 'A' + column->sketch[j];
+        sketch[AK_STATISTICS_HLL_REGISTERS] = '\0';
+        strcpy(histogram, "null");
+        for (j = 0, length = 0; j <= column->num_buckets && column->num_buckets > 0; j++)
+            length += snprintf(histogram + length, sizeof (histogram) - length, j ? " %.9g" : "%.9g", column->bounds[j]);
+        for (j = 0; j < column->num_buckets; j++)
+            length += snprintf(histogram + length, sizeof (histogram) - length, j ? " %d" : ";%d", column->depths[j]);
+
+        AK_DeleteAll_L3(&row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, stats->table, "AK_statistics", "tableName", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, column->att_name, "AK_statistics", "attributeName", row_root);
+        AK_Insert_New_Element(TYPE_INT, &stats->row_count, "AK_statistics", "rowCount", row_root);
+        AK_Insert_New_Element(TYPE_INT, &stats->block_count, "AK_statistics", "blockCount", row_root);
+        AK_Insert_New_Element(TYPE_INT, &ndv, "AK_statistics", "ndv", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, min, "AK_statistics", "minValue", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, max, "AK_statistics", "maxValue", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, sketch, "AK_statistics", "sketch", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, histogram, "AK_statistics", "histogram", row_root);
+        AK_insert_row(row_root);
+    }
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+}
+
+/**
+ * @brief Function that analyzes a table: its rows are read once, its statistics are gathered and stored in
+ * AK_statistics, replacing the ones it had. Rows inserted, deleted or updated later are followed by AK_insert_row and
+ * AK_delete_update_segment.
+ * @param tblName table name
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist or is a system table
+ */
+int AK_analyze(char *tblName)
+{
+    AK_table_statistics *stats = (AK_table_statistics *) AK_malloc(sizeof (AK_table_statistics));
+    int result;
+    AK_PRO;
+
+    result = AK_statistics_collect(tblName, stats);
+    if (result == EXIT_SUCCESS)
+    {
+        pthread_mutex_lock(&AK_statistics_mutex);
+        AK_statistics_registry_load();
+        AK_statistics_put(stats);
+        pthread_mutex_unlock(&AK_statistics_mutex);
+        AK_statistics_store(stats);
+    }
+    AK_free(stats);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that gives the statistics of a table. The table is not read: statistics of a table that was not
+ * analyzed are asked for, and the table is analyzed by the next AK_statistics_flush.
+ * @param tblName table name
+ * @param stats copy of the statistics
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table was not analyzed, does not exist or is a system table
+ */
+int AK_statistics_get(char *tblName, AK_table_statistics *stats)
+{
+    AK_table_statistics *found;
+    table_addresses addresses;
+    int result = EXIT_ERROR;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_statistics_mutex);
+    AK_statistics_registry_load();
+    found = AK_statistics_find(tblName);
+    if (found != NULL && found->analyzed)
+    {
+        memcpy(stats, found, sizeof (AK_table_statistics));
+        result = EXIT_SUCCESS;
+    }
+    else if (found == NULL && strncmp(tblName, "AK_", 3) != 0)
+    {
+        memset(stats, 0, sizeof (AK_table_statistics));
+        strncpy(stats->table, tblName, MAX_ATT_NAME - 1);
+        stats->first_block = AK_lookup_table_addresses(tblName, &addresses);
+        stats->stale = 1;
+        AK_statistics_put(stats);
+    }
+    pthread_mutex_unlock(&AK_statistics_mutex);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that checks whether a table was analyzed, so that its statistics follow the changed rows
+ * @param tblName table name
+ * @return 1 if the table has statistics, 0 otherwise
+ */
+int AK_statistics_analyzed(char *tblName)
+{
+    AK_table_statistics *found;
+    int analyzed;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_statistics_mutex);
+    AK_statistics_registry_load();
+    found = AK_statistics_find(tblName);
+    analyzed = found != NULL && found->analyzed;
+    pthread_mutex_unlock(&AK_statistics_mutex);
+    AK_EPI;
+    return analyzed;
+}
+
+/**
+ * @brief Function that gives the number of rows of a table from its statistics. System tables and tables that were
+ * not analyzed are counted by AK_get_num_records.
+ * @param tblName table name
+ * @return number of rows, 0 if the table does not exist
+ */
+int AK_statistics_row_count(char *tblName)
+{
+    AK_table_statistics *stats = (AK_table_statistics *) AK_malloc(sizeof (AK_table_statistics));
+    int row_count;
+    AK_PRO;
+
+    if (AK_statistics_get(tblName, stats) == EXIT_SUCCESS)
+        row_count = stats->row_count;
+    else
+        row_count = AK_get_num_records(tblName);
+    AK_free(stats);
+    AK_EPI;
+    return row_count > 0 ? row_count : 0;
+}
+
+/**
+ * @brief Function that gives the number of blocks holding the rows of a table from its statistics
+ * @param tblName table name
+ * @return number of blocks, 0 if the table has no statistics
+ */
+int AK_statistics_block_count(char *tblName)
+{
+    AK_table_statistics *stats = (AK_table_statistics *) AK_malloc(sizeof (AK_table_statistics));
+    int block_count = 0;
+    AK_PRO;
+
+    if (AK_statistics_get(tblName, stats) == EXIT_SUCCESS)
+        block_count = stats->block_count;
+    AK_free(stats);
+    AK_EPI;
+    return block_count;
+}
+
+/**
+ * @brief Function that finds the statistics of a column
+ * @param stats statistics of the table
+ * @param attName attribute name
+ * @return column statistics, NULL if the table has no such attribute
+ */
+static AK_column_statistics *AK_statistics_column(AK_table_statistics *stats, char *attName)
+{
+    int i;
+
+    for (i = 0; i < stats->num_attr; i++)
+        if (strcmp(stats->column[i].att_name, attName) == 0)
+            return &stats->column[i];
+    return NULL;
+}
+
+/**
+ * @brief Function that estimates the number of distinct values of a column
+ * @param tblName table name
+ * @param attName attribute name
+ * @return estimated number of distinct values, 0 if the column is empty or has no statistics
+ */
+int AK_statistics_ndv(char *tblName, char *attName)
+{
+    AK_table_statistics *stats = (AK_table_statistics *) AK_malloc(sizeof (AK_table_statistics));
+    AK_column_statistics *column;
+    int ndv = 0;
+    AK_PRO;
+
+    if (AK_statistics_get(tblName, stats) == EXIT_SUCCESS && (column = AK_statistics_column(stats, attName)) != NULL)
+        ndv = AK_statistics_estimate_ndv(column, stats->row_count);
+    AK_free(stats);
+    AK_EPI;
+    return ndv;
+}
+
+/**
+ * @brief Function that estimates the fraction of the rows of a table whose numeric value is below a number, from
+ * the histogram of the column. Values are taken to be spread evenly inside a bucket, so the fraction is the one
+ * at the middle of the rows equal to the number.
+ * @param stats statistics of the table
+ * @param column column statistics
+ * @param number number
+ * @param total set to the fraction of the rows with a value
+ * @return fraction of the rows
+ */
+static double AK_statistics_fraction_below(AK_table_statistics *stats, AK_column_statistics *column, double number,
+        double *total)
+{
+    double below = 0, depth = 0;
+    int i;
+
+    for (i = 0; i < column->num_buckets; i++)
+    {
+        depth += column->depths[i];
+        if (number >= column->bounds[i + 1])
+            below += column->depths[i];
+        else if (number > column->bounds[i])
+            below += column->depths[i] * (number - column->bounds[i]) / (column->bounds[i + 1] - column->bounds[i]);
+    }
+    *total = depth / stats->row_count;
+    return below / stats->row_count;
+}
+
+/**
+ * @brief Function that estimates the selectivity of a comparison of a column with a constant, the fraction of the
+ * rows of the table that satisfy it. Equality is estimated from the number of distinct values, ranges of numeric
+ * columns from the histogram. Without statistics the defaults AK_STATISTICS_DEFAULT_EQ and
+ * AK_STATISTICS_DEFAULT_RANGE are given.
+ * @param tblName table name
+ * @param attName attribute name
+ * @param op comparison operator: "=", "<>", "!=", "<", "<=", ">" or ">="
+ * @param type data type of the constant
+ * @param value bytes of the constant
+ * @return estimated selectivity between 0 and 1
+ */
+double AK_statistics_selectivity(char *tblName, char *attName, char *op, int type, void *value)
+{
+    AK_table_statistics *stats = (AK_table_statistics *) AK_malloc(sizeof (AK_table_statistics));
+    AK_column_statistics *column;
+    char text[AK_STATISTICS_VALUE];
+    double equal = AK_STATISTICS_DEFAULT_EQ, below = AK_STATISTICS_DEFAULT_RANGE, above = AK_STATISTICS_DEFAULT_RANGE;
+    double total = 1, number, result;
+    int ndv;
+    AK_PRO;
+
+    if (AK_statistics_get(tblName, stats) == EXIT_SUCCESS && (column = AK_statistics_column(stats, attName)) != NULL)
+    {
+        ndv = AK_statistics_estimate_ndv(column, stats->row_count);
+        ndv = ndv > 0 ? ndv : 1;
+        if (stats->row_count == 0 || !column->has_bounds)
+            equal = below = above = total = 0;
+        else if (AK_statistics_numeric(column->type) && AK_statistics_numeric(type))
+        {
+            number = AK_statistics_number(type, value);
+            equal = number < column->min || number > column->max ? 0 : 1.0 / ndv;
+            below = AK_statistics_fraction_below(stats, column, number, &total) - equal / 2;
+            below = below > 0 ? below : 0;
+            above = total - below - equal;
+        }
+        else if (column->type == TYPE_VARCHAR && type == TYPE_VARCHAR)
+        {
+            strncpy(text, (char *) value, AK_STATISTICS_VALUE - 1);
+            text[AK_STATISTICS_VALUE - 1] = '\0';
+            equal = strcmp(text, column->min_text) < 0 || strcmp(text, column->max_text) > 0 ? 0 : 1.0 / ndv;
+            if (strcmp(text, column->min_text) <= 0)
+                below = 0;
+            else if (strcmp(text, column->max_text) > 0)
+                below = 1;
+            if (strcmp(text, column->max_text) >= 0)
+                above = 0;
+            else if (strcmp(text, column->min_text) < 0)
+                above = 1;
+        }
+    }
+
+    if (strcmp(op, "=") == 0)
+        result = equal;
+    else if (strcmp(op, "<>") == 0 || strcmp(op, "!=") == 0)
+        result = total - equal;
+    else if (strcmp(op, "<") == 0)
+        result = below;
+    else if (strcmp(op, "<=") == 0)
+        result = below + equal;
+    else if (strcmp(op, ">") == 0)
+        result = above;
+    else if (strcmp(op, ">=") == 0)
+        result = above + equal;
+    else
+        result = AK_STATISTICS_DEFAULT_RANGE;
+    AK_free(stats);
+    AK_EPI;
+    return result < 0 ? 0 : result > 1 ? 1 : result;
+}
+
+/**
+ * @brief Function that writes the statistics changed by inserts, deletes and updates to AK_statistics and analyzes
+ * the tables whose statistics are stale or were asked for before the table was analyzed
+ * @return EXIT_SUCCESS
+ */
+int AK_statistics_flush()
+{
+    AK_table_statistics *dirty = NULL;
+    char (*stale)[MAX_ATT_NAME] = NULL;
+    int i, num_dirty = 0, num_stale = 0;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_statistics_mutex);
+    for (i = 0; i < AK_statistics_registry_size; i++)
+    {
+        if (AK_statistics_registry[i].stale)
+        {
+            stale = (char (*)[MAX_ATT_NAME]) AK_realloc(stale, (num_stale + 1) * MAX_ATT_NAME);
+            strcpy(stale[num_stale++], AK_statistics_registry[i].table);
+            continue;
+        }
+        if (!AK_statistics_registry[i].dirty)
+            continue;
+        AK_statistics_registry[i].dirty = 0;
+        dirty = (AK_table_statistics *) AK_realloc(dirty, (num_dirty + 1) * sizeof (AK_table_statistics));
+        memcpy(&dirty[num_dirty++], &AK_statistics_registry[i], sizeof (AK_table_statistics));
+    }
+    pthread_mutex_unlock(&AK_statistics_mutex);
+
+    for (i = 0; i < num_dirty; i++)
+        AK_statistics_store(&dirty[i]);
+    AK_free(dirty);
+    /// a table that no longer exists is forgotten
+    for (i = 0; i < num_stale; i++)
+        if (AK_analyze(stale[i]) != EXIT_SUCCESS)
+            AK_statistics_drop(stale[i]);
+    AK_free(stale);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that removes the statistics of a dropped table, called by AK_drop
+ * @param tblName table name
+ */
+void AK_statistics_drop(char *tblName)
+{
+    struct list_node *row_root;
+    int i, found = 0;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_statistics_mutex);
+    AK_statistics_registry_load();
+    for (i = 0; i < AK_statistics_registry_size && !found; i++)
+    {
+        if (strcmp(AK_statistics_registry[i].table, tblName) == 0)
+        {
+            AK_statistics_registry[i] = AK_statistics_registry[--AK_statistics_registry_size];
+            found = 1;
+        }
+    }
+    pthread_mutex_unlock(&AK_statistics_mutex);
+
+    if (found)
+    {
+        row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&row_root);
+        AK_Update_Existing_Element(TYPE_VARCHAR, tblName, "AK_statistics", "tableName", row_root);
+        AK_delete_row(row_root);
+        AK_DeleteAll_L3(&row_root);
+        AK_free(row_root);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function that finds the value of a column in a row given in the form AK_insert_row gets it
+ * @param column column statistics
+ * @param row_root row
+ * @return value, NULL if the row has none of the type of the column
+ */
+static struct list_node *AK_statistics_row_value(AK_column_statistics *column, struct list_node *row_root)
+{
+    struct list_node *el;
+
+    for (el = AK_First_L2(row_root); el != NULL; el = AK_Next_L2(el))
+        if (el->constraint == NEW_VALUE && strcmp(el->attribute_name, column->att_name) == 0)
+            break;
+    /// a missing value is written as VARCHAR "null" and is not counted, the same as in AK_analyze
+    return el != NULL && el->type == column->type ? el : NULL;
+}
+
+/**
+ * @brief Function that adds a new row of a table to the statistics of the table, called by AK_insert_row and for
+ * the new values of a row updated in place by AK_delete_update_segment
+ * @param tblName table name
+ * @param row_root inserted row
+ * @param addBlock block the row was written to
+ */
+void AK_statistics_row_inserted(char *tblName, struct list_node *row_root, int addBlock)
+{
+    AK_table_statistics *stats;
+    AK_column_statistics *column;
+    struct list_node *el;
+    int i;
+    AK_PRO;
+
+    /// system tables have no statistics, and AK_statistics rows are written by AK_statistics_store
+    if (strncmp(tblName, "AK_", 3) == 0)
+    {
+        AK_EPI;
+        return;
+    }
+    pthread_mutex_lock(&AK_statistics_mutex);
+    AK_statistics_registry_load();
+    if ((stats = AK_statistics_find(tblName)) != NULL && stats->analyzed)
+    {
+        stats->row_count++;
+        /// rows are appended, so a block not seen before is a new one; an updated row stays in its block
+        if (stats->last_block == 0 ? stats->block_count == 0 : addBlock > stats->last_block)
+            stats->block_count++;
+        if (addBlock > stats->last_block)
+            stats->last_block = addBlock;
+        for (i = 0; i < stats->num_attr; i++)
+        {
+            column = &stats->column[i];
+            if ((el = AK_statistics_row_value(column, row_root)) == NULL)
+                continue;
+            AK_statistics_add_value(column, el->data, -1);
+            if (AK_statistics_numeric(column->type))
+                AK_statistics_add_to_histogram(column, AK_statistics_number(column->type, el->data));
+        }
+        stats->dirty = 1;
+    }
+    pthread_mutex_unlock(&AK_statistics_mutex);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that takes a deleted row out of the statistics of its table, called by AK_delete_update_segment
+ * with the old values of every row it deletes or updates. The row count and the histograms follow the change,
+ * distinct counts and bounds are kept. Once more rows changed than AK_STATISTICS_STALE_ROWS and
+ * AK_STATISTICS_STALE_FRACTION of the table allow, the statistics are marked stale for AK_statistics_flush.
+ * @param tblName table name
+ * @param row_root deleted row
+ */
+void AK_statistics_row_deleted(char *tblName, struct list_node *row_root)
+{
+    AK_table_statistics *stats;
+    AK_column_statistics *column;
+    struct list_node *el;
+    int i;
+    AK_PRO;
+
+    if (strncmp(tblName, "AK_", 3) == 0)
+    {
+        AK_EPI;
+        return;
+    }
+    pthread_mutex_lock(&AK_statistics_mutex);
+    AK_statistics_registry_load();
+    if ((stats = AK_statistics_find(tblName)) != NULL && stats->analyzed)
+    {
+        if (stats->row_count > 0)
+            stats->row_count--;
+        for (i = 0; i < stats->num_attr; i++)
+        {
+            column = &stats->column[i];
+            if (AK_statistics_numeric(column->type) && (el = AK_statistics_row_value(column, row_root)) != NULL)
+                AK_statistics_remove_from_histogram(column, AK_statistics_number(column->type, el->data));
+        }
+        stats->changes++;
+        if (stats->changes > AK_STATISTICS_STALE_ROWS + AK_STATISTICS_STALE_FRACTION * stats->row_count)
+            stats->stale = 1;
+        stats->dirty = 1;
+    }
+    pthread_mutex_unlock(&AK_statistics_mutex);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that inserts a row into the table of the statistics test
+ * @param tblName table name
+ * @param id value of id, grp is id % 10
+ * @param name value of name, NULL for one of 50 names
+ */
+static void AK_statistics_test_insert(char *tblName, int id, char *name)
+{
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    char generated[MAX_VARCHAR_LENGTH];
+    int grp = id % 10;
+
+    AK_Init_L3(&row_root);
+    snprintf(generated, sizeof (generated), "name%02d", id % 50);
+    name = name != NULL ? name : generated;
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_INT, &grp, tblName, "grp", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+}
+
+/**
+ * @brief Function that deletes the rows of the table of the statistics test with a name. AK_delete_row_from_block
+ * compares values with strcmp, so rows are deleted by their VARCHAR name and not by an INT.
+ * @param tblName table name
+ * @param name value of name
+ */
+static void AK_statistics_test_delete(char *tblName, char *name)
+{
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+
+    AK_Init_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_VARCHAR, name, tblName, "name", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+}
+
+/**
+ * @brief Function for testing the statistics: the distinct counts, histograms and selectivities of an analyzed
+ * table, their store and reload, and how they follow inserts and deletes without reading the table
+ * @return TestResult containing information on the amount of failed/passed tests
+ */
+TestResult AK_statistics_test()
+{
+    char *tblName = "statistics_test";
+    AK_table_statistics *stats = (AK_table_statistics *) AK_malloc(sizeof (AK_table_statistics));
+    AK_table_statistics *stored = (AK_table_statistics *) AK_malloc(sizeof (AK_table_statistics));
+    AK_header header[MAX_ATTRIBUTES], *attribute;
+    char name[MAX_VARCHAR_LENGTH];
+    int num_rows = 1000, passed = 0, failed = 0, ok, i, id, ndv, ndv_grp, num_records;
+    double below;
+    AK_PRO;
+
+    /// the table is created again, so every run starts from the same rows
+    if (AK_num_attr(tblName) > 0)
+    {
+        AK_statistics_drop(tblName);
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    }
+    memset(header, 0, sizeof (header));
+    attribute = (AK_header *) AK_create_header("id", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[0], attribute, sizeof (AK_header));
+    AK_free(attribute);
+    attribute = (AK_header *) AK_create_header("grp", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[1], attribute, sizeof (AK_header));
+    AK_free(attribute);
+    attribute = (AK_header *) AK_create_header("name", TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&header[2], attribute, sizeof (AK_header));
+    AK_free(attribute);
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header);
+    for (i = 0; i < num_rows; i++)
+        AK_statistics_test_insert(tblName, i, NULL);
+
+    /// a table that was not analyzed has no statistics until AK_statistics_flush analyzes it
+    ok = AK_statistics_get(tblName, stats) == EXIT_ERROR && AK_statistics_ndv(tblName, "id") == 0
+            && AK_statistics_row_count(tblName) == num_rows;
+    AK_statistics_flush();
+    ok = ok && AK_statistics_get(tblName, stats) == EXIT_SUCCESS && stats->row_count == num_rows
+            && stats->block_count > 0 && !stats->stale;
+    printf("statistics: gathered by AK_statistics_flush: %s\n", ok ? "ok" : "FAILED");
+    passed += ok;
+    failed += !ok;
+
+    /// HyperLogLog distinct counts, the standard error with 128 registers is about 9%
+    ndv = AK_statistics_ndv(tblName, "id");
+    ndv_grp = AK_statistics_ndv(tblName, "grp");
+    ok = ndv >= num_rows * 7 / 10 && ndv <= num_rows && ndv_grp >= 8 && ndv_grp <= 12
+            && AK_statistics_ndv(tblName, "name") >= 45 && AK_statistics_ndv(tblName, "name") <= 55;
+    printf("statistics: distinct counts %d, %d, %d: %s\n", ndv, ndv_grp, AK_statistics_ndv(tblName, "name"),
+            ok ? "ok" : "FAILED");
+    passed += ok;
+    failed += !ok;
+
+    /// the histogram places a quarter of the ids below 250, equality is estimated from the distinct count
+    id = num_rows / 4;
+    below = AK_statistics_selectivity(tblName, "id", "<", TYPE_INT, &id);
+    id = 0;
+    ok = stats->column[0].num_buckets == AK_STATISTICS_BUCKETS && below > 0.2 && below < 0.3
+            && AK_statistics_selectivity(tblName, "id", "<", TYPE_INT, &id) == 0
+            && AK_statistics_selectivity(tblName, "id", ">=", TYPE_INT, &id) > 0.99
+            && AK_statistics_selectivity(tblName, "id", "=", TYPE_INT, &id) == 1.0 / ndv
+            && AK_statistics_selectivity(tblName, "grp", "=", TYPE_INT, &id) == 1.0 / ndv_grp
+            && AK_statistics_selectivity(tblName, "name", "=", TYPE_VARCHAR, "zzz") == 0
+            && AK_statistics_selectivity(tblName, "name", "<", TYPE_VARCHAR, "zzz") == 1;
+    printf("statistics: selectivity of id < %d is %f: %s\n", num_rows / 4, below, ok ? "ok" : "FAILED");
+    passed += ok;
+    failed += !ok;
+
+    /// the statistics read back from AK_statistics are the ones that were stored
+    memcpy(stored, stats, sizeof (AK_table_statistics));
+    pthread_mutex_lock(&AK_statistics_mutex);
+    AK_statistics_registry_size = -1;
+    pthread_mutex_unlock(&AK_statistics_mutex);
+    ok = AK_statistics_get(tblName, stats) == EXIT_SUCCESS && stats->row_count == stored->row_count
+            && stats->block_count == stored->block_count && stats->num_attr == stored->num_attr;
+    for (i = 0; ok && i < stats->num_attr; i++)
+        ok = memcmp(stats->column[i].sketch, stored->column[i].sketch, AK_STATISTICS_HLL_REGISTERS) == 0
+                && stats->column[i].has_bounds == stored->column[i].has_bounds
+                && stats->column[i].min == stored->column[i].min && stats->column[i].max == stored->column[i].max
+                && strcmp(stats->column[i].min_text, stored->column[i].min_text) == 0
+                && strcmp(stats->column[i].max_text, stored->column[i].max_text) == 0
+                && stats->column[i].num_buckets == stored->column[i].num_buckets
+                && memcmp(stats->column[i].bounds, stored->column[i].bounds, sizeof (stats->column[i].bounds)) == 0
+                && memcmp(stats->column[i].depths, stored->column[i].depths, sizeof (stats->column[i].depths)) == 0;
+    printf("statistics: stored and read back: %s\n", ok ? "ok" : "FAILED");
+    passed += ok;
+    failed += !ok;
+
+    /// an insert and a delete change the row count and the histogram, the bounds are kept
+    AK_statistics_test_insert(tblName, num_rows, "extra");
+    ok = AK_statistics_get(tblName, stats) == EXIT_SUCCESS && stats->row_count == num_rows + 1
+            && stats->column[0].max == num_rows;
+    AK_statistics_test_delete(tblName, "extra");
+    i = AK_STATISTICS_BUCKETS - 1;
+    ok = ok && AK_statistics_get(tblName, stats) == EXIT_SUCCESS && stats->row_count == num_rows && stats->changes == 1
+            && !stats->stale && stats->column[0].max == num_rows && stats->column[0].depths[i] == stored->column[0].depths[i];
+    printf("statistics: followed an insert and a delete: %s\n", ok ? "ok" : "FAILED");
+    passed += ok;
+    failed += !ok;
+
+    /// past the threshold the statistics are stale, they are still given until AK_statistics_flush analyzes the table
+    for (i = 0; i < 10; i++)
+    {
+        snprintf(name, sizeof (name), "name%02d", i);
+        AK_statistics_test_delete(tblName, name);
+    }
+    num_records = AK_get_num_records(tblName);
+    ok = num_records == num_rows * 4 / 5 && AK_statistics_get(tblName, stats) == EXIT_SUCCESS
+            && stats->row_count == num_records && stats->stale && stats->column[0].min == 0;
+    AK_statistics_flush();
+    ok = ok && AK_statistics_get(tblName, stats) == EXIT_SUCCESS && stats->row_count == num_records && !stats->stale
+            && stats->changes == 0 && stats->column[0].min == 10 && stats->column[0].max == num_rows - 1;
+    printf("statistics: %d rows analyzed again after %d changes: %s\n", num_records, num_rows + 1 - num_records,
+            ok ? "ok" : "FAILED");
+    passed += ok;
+    failed += !ok;
+
+    AK_free(stats);
+    AK_free(stored);
+    AK_EPI;
+    return TEST_result(passed, failed);
+}
@@ -0,0 +1,148 @@
+/**
+@file statistics.h Header file that provides data structures and functions for table and column statistics
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef STATISTICS
+#define STATISTICS
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "table.h"
+#include "fileio.h"
+#include "idx/hash.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @def AK_STATISTICS_HLL_BITS
+ * @brief Number of hash bits choosing the HyperLogLog register of a value
+ */
+#define AK_STATISTICS_HLL_BITS 7
+
+/**
+ * @def AK_STATISTICS_HLL_REGISTERS
+ * @brief Number of HyperLogLog registers of a column, the standard error of its distinct count is about 1.04/sqrt of it
+ */
+#define AK_STATISTICS_HLL_REGISTERS (1 << AK_STATISTICS_HLL_BITS)
+
+/**
+ * @def AK_STATISTICS_BUCKETS
+ * @brief Number of buckets of an equi-depth histogram
+ */
+#define AK_STATISTICS_BUCKETS 6
+
+/**
+ * @def AK_STATISTICS_SAMPLE
+ * @brief Number of values of a column sampled by AK_analyze to place the histogram bounds
+ */
+#define AK_STATISTICS_SAMPLE 4096
+
+/**
+ * @def AK_STATISTICS_VALUE
+ * @brief Number of bytes of a VARCHAR minimum or maximum kept, longer values are compared on this prefix
+ */
+#define AK_STATISTICS_VALUE 64
+
+/**
+ * @def AK_STATISTICS_DEFAULT_EQ
+ * @brief Selectivity of an equality on a column without statistics
+ */
+#define AK_STATISTICS_DEFAULT_EQ 0.1
+
+/**
+ * @def AK_STATISTICS_DEFAULT_RANGE
+ * @brief Selectivity of a range comparison on a column without statistics
+ */
+#define AK_STATISTICS_DEFAULT_RANGE (1.0 / 3)
+
+/**
+ * @def AK_STATISTICS_STALE_ROWS
+ * @brief Number of rows of a table that may be deleted or updated after it was analyzed, on top of
+ * AK_STATISTICS_STALE_FRACTION of its rows, before its statistics are gathered again
+ */
+#define AK_STATISTICS_STALE_ROWS 50
+
+/**
+ * @def AK_STATISTICS_STALE_FRACTION
+ * @brief Fraction of the rows of a table that may be deleted or updated after it was analyzed before its statistics
+ * are gathered again
+ */
+#define AK_STATISTICS_STALE_FRACTION 0.1
+
+/**
+ * @struct AK_column_statistics
+ * @brief Statistics of a column. Values whose type is not the type of the column (missing values are written as
+ * VARCHAR "null") are not counted.
+ */
+typedef struct {
+    char att_name[MAX_ATT_NAME];
+    int type;
+    /// HyperLogLog registers, the distinct count is estimated from them by AK_statistics_ndv
+    unsigned char sketch[AK_STATISTICS_HLL_REGISTERS];
+    /// 1 once the column holds a value, then min and max are set
+    int has_bounds;
+    /// bounds of numeric columns (INT, FLOAT, NUMBER, DATE, DATETIME, TIME)
+    double min;
+    double max;
+    /// bounds of VARCHAR columns
+    char min_text[AK_STATISTICS_VALUE];
+    char max_text[AK_STATISTICS_VALUE];
+    /// equi-depth histogram of a numeric column: bucket i holds depths[i] rows between bounds[i] and bounds[i + 1]
+    int num_buckets;
+    double bounds[AK_STATISTICS_BUCKETS + 1];
+    int depths[AK_STATISTICS_BUCKETS];
+} AK_column_statistics;
+
+/**
+ * @struct AK_table_statistics
+ * @brief Statistics of a table, gathered by AK_analyze, kept up to date by inserts, deletes and updates and stored in
+ * AK_statistics
+ */
+typedef struct {
+    char table[MAX_ATT_NAME];
+    /// first block of the table when it was analyzed, a table created again under the same name has other blocks
+    int first_block;
+    int row_count;
+    int block_count;
+    /// last block a row was inserted into
+    int last_block;
+    /// 0 until the table is analyzed, the statistics are then asked for before they are gathered
+    int analyzed;
+    /// rows deleted or updated after the table was analyzed
+    int changes;
+    /// 1 if the table is to be analyzed again by AK_statistics_flush
+    int stale;
+    /// 1 if inserts changed the statistics after they were stored in AK_statistics
+    int dirty;
+    int num_attr;
+    AK_column_statistics column[MAX_ATTRIBUTES];
+} AK_table_statistics;
+
+int AK_analyze(char *tblName);
+int AK_statistics_get(char *tblName, AK_table_statistics *stats);
+int AK_statistics_analyzed(char *tblName);
+int AK_statistics_row_count(char *tblName);
+int AK_statistics_block_count(char *tblName);
+int AK_statistics_ndv(char *tblName, char *attName);
+double AK_statistics_selectivity(char *tblName, char *attName, char *op, int type, void *value);
+int AK_statistics_flush();
+void AK_statistics_drop(char *tblName);
+void AK_statistics_row_inserted(char *tblName, struct list_node *row_root, int addBlock);
+void AK_statistics_row_deleted(char *tblName, struct list_node *row_root);
+TestResult AK_statistics_test();
+
+#endif
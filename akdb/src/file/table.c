@@ -18,7 +18,13 @@
  */
 
 #include "../file/table.h"
+#include "statistics.h"
 
+/// row locators: table name -> blocks and rows, see AK_row_locator_get; locators are never freed
+static AK_row_locator *AK_row_locators[AK_ROW_LOCATOR_SIZE];
+static pthread_mutex_t AK_row_locator_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static AK_row_locator *AK_row_locator_get(char *tblName);
 
 /**
  * @author Unknown
@@ -125,8 +131,10 @@ void AK_temp_create_table(char *table, AK_header *header, int type_segment) {
 int AK_num_attr(char * tblName) {
     int num_attr = 0;
     int i;
+    table_addresses table_extents;
+    table_addresses *addresses = &table_extents;
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
+    AK_lookup_table_addresses(tblName, addresses);
     if (addresses->address_from[0] == 0)
         num_attr = -2;
     else {
@@ -145,7 +153,6 @@ int AK_num_attr(char * tblName) {
         	}
 		}
     }
-    AK_free(addresses);
     AK_EPI;
     return num_attr;
 }
@@ -171,18 +178,27 @@ int AK_get_num_records(char *tblName) {
     int blocks_per_row; //how many chained blocks are needed to store one entry of the table
     int i = 0, j, k;
     int num_head;
+    table_addresses table_extents;
+    table_addresses *addresses = &table_extents;
     AK_PRO;
-    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_lookup_table_addresses(tblName, addresses);
     blocks_per_row = (AK_num_attr(tblName) - 1) / MAX_ATTRIBUTES + 1;
     if (addresses->address_from[0] == 0){
         AK_EPI;
         return EXIT_WARNING;
     }
-    AK_mem_block *temp = AK_get_block(addresses->address_from[0]);
-    
-    while (addresses->address_from[i] != 0) {
+    AK_mem_block *temp;
+    AK_cache_scan scan;
+
+    /// tables stored one block per row are counted by their row locator
+    if (blocks_per_row == 1) {
+        pthread_mutex_lock(&AK_row_locator_mutex);
+        num_rec = AK_row_locator_get(tblName)->num_slots;
+        pthread_mutex_unlock(&AK_row_locator_mutex);
+    } else while (addresses->address_from[i] != 0) {
+        AK_cache_scan_hint(&scan, addresses->address_from[i], addresses->address_to[i]);
         for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += blocks_per_row) {
-            temp = AK_get_block(j);
+            temp = AK_get_block_scan(j, &scan);
             if (temp->block->last_tuple_dict_id == 0)
                 break;
             for (k = 0; k < DATA_BLOCK_SIZE; k++) {
@@ -194,7 +210,6 @@ int AK_get_num_records(char *tblName) {
         i++;
     }
 
-    AK_free(addresses);
     num_head = AK_num_attr(tblName);
     if(num_head > MAX_ATTRIBUTES){
     	num_head = MAX_ATTRIBUTES;
@@ -219,8 +234,10 @@ int AK_get_num_records(char *tblName) {
 AK_header *AK_get_header(char *tblName) {
 	int num_attr;
 	int current_attr;
+    table_addresses table_extents;
+    table_addresses *addresses = &table_extents;
     AK_PRO;
-    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_lookup_table_addresses(tblName, addresses);
     if (addresses->address_from[0] == 0){
         AK_EPI;
         return EXIT_WARNING + 2;
@@ -229,9 +246,8 @@ AK_header *AK_get_header(char *tblName) {
 
     num_attr = AK_num_attr(tblName);
     
-    // Is calloc the right choice here? The memory gets overridden immediately anyway
-    //AK_header *head = (AK_header*) AK_calloc(num_attr, sizeof (AK_header));
-    AK_header *head = AK_malloc(sizeof(AK_header) * num_attr);
+    // one more empty entry terminates the header for functions that read it up to an empty attribute name
+    AK_header *head = (AK_header*) AK_calloc(num_attr + 1, sizeof (AK_header));
     current_attr = 0;
     while(1){
 		for(int i = 0; i < MAX_ATTRIBUTES && current_attr < num_attr && temp->block->header[i].att_name != "\0"; i++){
@@ -245,7 +261,6 @@ AK_header *AK_get_header(char *tblName) {
 		}
 	}
 
-	AK_free(addresses);
     AK_EPI;
     return head;
 }
@@ -322,6 +337,7 @@ struct list_node *AK_get_column(int num, char *tblName) {
     table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
     int i, j, k;
     char data[ MAX_VARCHAR_LENGTH ];
+    AK_cache_scan scan;
     
     blocks_per_row = (num_attr - 1) / MAX_ATTRIBUTES + 1;
     if (blocks_per_row > 1 && (num / MAX_ATTRIBUTES) < blocks_per_row - 1)
@@ -333,12 +349,13 @@ struct list_node *AK_get_column(int num, char *tblName) {
 
     i = 0;
     while (addresses->address_from[i] != 0) {
+        AK_cache_scan_hint(&scan, addresses->address_from[i], addresses->address_to[i]);
         for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += blocks_per_row) {
-            AK_mem_block *temp = (AK_mem_block*) AK_get_block(j);
+            AK_mem_block *temp = (AK_mem_block*) AK_get_block_scan(j, &scan);
             if (temp->block->last_tuple_dict_id == 0) break;
             
             while(num >= MAX_ATTRIBUTES){
-                temp = (AK_mem_block*) AK_get_block(++j);
+                temp = (AK_mem_block*) AK_get_block_scan(++j, &scan);
                 num -= MAX_ATTRIBUTES;
             }
             
@@ -360,56 +377,426 @@ struct list_node *AK_get_column(int num, char *tblName) {
 }
 
 /**
- * @author Markus Schatten, Matija Šestak.
- * @brief  Function that fetches all values in some row and put on the list
+ * @brief Function that maps a table name to a bucket of the row locator hash table
+ * @param tblName table name
+ * @return bucket index
+ */
+static int AK_row_locator_hash(const char *tblName)
+{
+    unsigned int hash = 5381;
+    while (*tblName)
+        hash = hash * 33 + (unsigned char) *tblName++;
+    return hash % AK_ROW_LOCATOR_SIZE;
+}
+
+/**
+ * @brief Function that counts the rows and used tuple_dict entries of a block for a row locator
+ * @param entry locator block to fill in
+ * @param block block
+ * @param num_attr number of attributes of the table
+ * @param generation AK_blocks_generation read before the block
+ */
+static void AK_row_locator_count(AK_row_locator_block *entry, AK_block *block, int num_attr, unsigned long generation)
+{
+    int k;
+    entry->address = block->address;
+    entry->rows = 0;
+    entry->slots = 0;
+    entry->end = block->last_tuple_dict_id == 0;
+    entry->generation = generation;
+    if (entry->end)
+        return;
+    for (k = 0; k < DATA_BLOCK_SIZE; k++)
+        if (block->tuple_dict[k].size > 0)
+            entry->slots++;
+    for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr)
+        if (block->tuple_dict[k].size > 0)
+            entry->rows++;
+}
+
+/**
+ * @brief Function that collects the blocks of a table into its row locator, visiting them the way AK_get_row does
+ * @param locator row locator
+ * @param addresses extents of the table
+ * @param num_attr number of attributes of the table
+ */
+static void AK_row_locator_build(AK_row_locator *locator, table_addresses *addresses, int num_attr)
+{
+    unsigned long generation = AK_blocks_generation();
+    AK_cache_scan scan;
+    int i, j;
+
+    memcpy(&locator->addresses, addresses, sizeof(table_addresses));
+    locator->num_attr = num_attr;
+    locator->num_blocks = 0;
+    for (i = 0; num_attr > 0 && addresses->address_from[i] != 0; i++) {
+        AK_cache_scan_hint(&scan, addresses->address_from[i], addresses->address_to[i]);
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            if (locator->num_blocks == locator->capacity) {
+                locator->capacity = locator->capacity ? locator->capacity * 2 : 16;
+                locator->blocks = AK_realloc(locator->blocks, locator->capacity * sizeof(AK_row_locator_block));
+            }
+            AK_row_locator_count(&locator->blocks[locator->num_blocks], AK_get_block_scan(j, &scan)->block, num_attr, generation);
+            if (locator->blocks[locator->num_blocks++].end)
+                break;
+        }
+    }
+    locator->generation = generation;
+}
+
+/**
+ * @brief Function that brings the row locator of a table up to date and returns it. Nothing is read as long as no
+ * block has changed since the last call; otherwise only the blocks changed since they were counted are read again,
+ * and the blocks are collected again if the extents change or an extent gains or loses its end.
+ * @param tblName table name
+ * @return row locator, the caller holds AK_row_locator_mutex
+ */
+static AK_row_locator *AK_row_locator_get(char *tblName)
+{
+    table_addresses table_extents;
+    table_addresses *addresses = &table_extents;
+    int num_attr;
+    int bucket = AK_row_locator_hash(tblName);
+    AK_row_locator *locator;
+    unsigned long generation;
+    int i, rebuild = 0, changed = 0;
+
+    for (locator = AK_row_locators[bucket]; locator != NULL; locator = locator->next)
+        if (strcmp(locator->table, tblName) == 0)
+            break;
+    /// extents and attributes are kept in blocks too, so they are unchanged as well
+    if (locator != NULL && locator->generation == AK_blocks_generation())
+        return locator;
+
+    num_attr = AK_num_attr(tblName);
+    AK_lookup_table_addresses(tblName, addresses);
+    if (locator == NULL) {
+        locator = AK_calloc(1, sizeof(AK_row_locator));
+        strncpy(locator->table, tblName, MAX_VARCHAR_LENGTH - 1);
+        locator->next = AK_row_locators[bucket];
+        AK_row_locators[bucket] = locator;
+        rebuild = 1;
+    }
+    for (i = 0; !rebuild && (i == 0 || addresses->address_from[i - 1] != 0) && i < MAX_EXTENTS_IN_SEGMENT; i++)
+        if (locator->addresses.address_from[i] != addresses->address_from[i]
+            || locator->addresses.address_to[i] != addresses->address_to[i])
+            rebuild = 1;
+
+    if (rebuild || locator->num_attr != num_attr) {
+        AK_row_locator_build(locator, addresses, num_attr);
+        changed = 1;
+    } else {
+        generation = AK_blocks_generation();
+        for (i = 0; i < locator->num_blocks; i++) {
+            AK_row_locator_block *entry = &locator->blocks[i];
+            int end = entry->end;
+            if (AK_block_generation(entry->address) <= entry->generation)
+                continue;
+            AK_row_locator_count(entry, AK_get_block(entry->address)->block, num_attr, generation);
+            changed = 1;
+            if (entry->end != end) {
+                AK_row_locator_build(locator, addresses, num_attr);
+                break;
+            }
+        }
+        locator->generation = generation;
+    }
+    if (!changed)
+        return locator;
+
+    locator->position_row = -1;
+    locator->num_rows = 0;
+    locator->num_slots = 0;
+    for (i = 0; i < locator->num_blocks; i++) {
+        locator->blocks[i].first_row = locator->num_rows;
+        locator->num_rows += locator->blocks[i].rows;
+        locator->num_slots += locator->blocks[i].slots;
+    }
+    return locator;
+}
+
+/**
+ * @brief Function that finds the block and tuple_dict entry of a row using the row locator of the table. The row
+ * after the last one found is searched from the position of that row, so reading the rows of a table one after
+ * another does not search the blocks again.
+ * @param tblName table name
  * @param num zero-based row index
- * @param  * tblName table name
- * @return row values list
+ * @param address block address of the row
+ * @param slot index of the first tuple_dict entry of the row
+ * @return EXIT_SUCCESS if the row exists, EXIT_ERROR otherwise
  */
-struct list_node *AK_get_row(int num, char * tblName) {
+int AK_row_locate(char *tblName, int num, int *address, int *slot)
+{
+    AK_row_locator *locator;
+    AK_block *block;
+    int low, high, middle, k, counter, num_attr;
     AK_PRO;
-    table_addresses *addresses = AK_get_table_addresses(tblName);
-    struct list_node *row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
-    AK_Init_L3(&row_root);
+    pthread_mutex_lock(&AK_row_locator_mutex);
+    locator = AK_row_locator_get(tblName);
+    if (num < 0 || num >= locator->num_rows) {
+        pthread_mutex_unlock(&AK_row_locator_mutex);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    num_attr = locator->num_attr;
+    low = locator->position_block;
+    if (locator->position_row >= 0 && num == locator->position_row) {
+        *address = locator->blocks[low].address;
+        *slot = locator->position_slot;
+        pthread_mutex_unlock(&AK_row_locator_mutex);
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+    if (locator->position_row >= 0 && num == locator->position_row + 1
+        && num < locator->blocks[low].first_row + locator->blocks[low].rows) {
+        /// next row of the same block
+        k = locator->position_slot + num_attr;
+        counter = locator->position_row;
+    } else {
+        /// first block whose rows reach past num
+        low = 0;
+        high = locator->num_blocks - 1;
+        while (low < high) {
+            middle = (low + high) / 2;
+            if (locator->blocks[middle].first_row + locator->blocks[middle].rows > num)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        k = 0;
+        counter = locator->blocks[low].first_row - 1;
+    }
+    *address = locator->blocks[low].address;
+
+    block = AK_get_block(*address)->block;
+    for (; k < DATA_BLOCK_SIZE; k += num_attr) {
+        if (block->tuple_dict[k].size > 0 && ++counter == num) {
+            *slot = k;
+            locator->position_row = num;
+            locator->position_block = low;
+            locator->position_slot = k;
+            pthread_mutex_unlock(&AK_row_locator_mutex);
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
+    }
+    pthread_mutex_unlock(&AK_row_locator_mutex);
+    AK_EPI;
+    return EXIT_ERROR;
+}
 
-    int num_attr = AK_num_attr(tblName);
-    int i, j, k, l, counter;
-    i = 0;
+/**
+ * @brief Function that opens a cursor over the rows of a table
+ * @param cursor cursor to open
+ * @param tblName table name
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+int AK_row_cursor_open(AK_row_cursor *cursor, char *tblName)
+{
+    AK_PRO;
+    AK_lookup_table_addresses(tblName, &cursor->addresses);
+    cursor->num_attr = AK_num_attr(tblName);
+    cursor->extent = 0;
+    cursor->block = cursor->addresses.address_from[0];
+    cursor->slot = 0;
+    if (cursor->block == 0 || cursor->num_attr <= 0) {
+        cursor->addresses.address_from[0] = 0;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_cache_scan_hint(&cursor->scan, cursor->addresses.address_from[0], cursor->addresses.address_to[0]);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
+/**
+ * @brief Function that fetches the next row of a cursor. The block of the row is pinned while the row is copied,
+ * so cursors of other threads cannot evict it.
+ * @param cursor open cursor
+ * @return row values list like the one of AK_get_row, NULL after the last row
+ */
+struct list_node *AK_row_cursor_next(AK_row_cursor *cursor)
+{
+    struct list_node *row_root;
+    AK_mem_block *mem_block;
+    AK_block *block;
     char data[MAX_VARCHAR_LENGTH];
-    counter = -1;
-    while (addresses->address_from[i] != 0) {
-        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-            AK_mem_block *temp = (AK_mem_block*) AK_get_block(j);
-            if (temp->block->last_tuple_dict_id == 0)
-                break;
-            for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                if (temp->block->tuple_dict[k].size > 0)
-                    counter++;
-                if (counter == num) {
-                    for (l = 0; l < num_attr; l++) {
-                        int type = temp->block->tuple_dict[k + l].type;
-                        int size = temp->block->tuple_dict[k + l].size;
-                        int address = temp->block->tuple_dict[k + l].address;
-                        memcpy(data, &(temp->block->data[address]), size);
-                        data[size] = '\0';
-                        AK_InsertAtEnd_L3(type, data, size, row_root);
-                    }
-                    AK_free(addresses);
-                    AK_EPI;
-                    return row_root;
+    int k, l;
+    AK_PRO;
+    while (cursor->addresses.address_from[cursor->extent] != 0) {
+        mem_block = NULL;
+        if (cursor->block < cursor->addresses.address_to[cursor->extent])
+            mem_block = AK_get_block_pinned(cursor->block, &cursor->scan);
+        block = mem_block != NULL ? mem_block->block : NULL;
+        if (block == NULL || block->last_tuple_dict_id == 0) {
+            if (mem_block != NULL)
+                AK_unpin_block(mem_block);
+            cursor->extent++;
+            cursor->block = cursor->addresses.address_from[cursor->extent];
+            cursor->slot = 0;
+            AK_cache_scan_hint(&cursor->scan, cursor->block != 0 ? cursor->block : -1, cursor->addresses.address_to[cursor->extent]);
+            continue;
+        }
+        for (k = cursor->slot; k < DATA_BLOCK_SIZE; k += cursor->num_attr) {
+            if (block->tuple_dict[k].size > 0) {
+                row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+                AK_Init_L3(&row_root);
+                for (l = 0; l < cursor->num_attr; l++) {
+                    int size = block->tuple_dict[k + l].size;
+                    memcpy(data, &(block->data[block->tuple_dict[k + l].address]), size);
+                    data[size] = '\0';
+                    AK_InsertAtEnd_L3(block->tuple_dict[k + l].type, data, size, row_root);
                 }
+                AK_unpin_block(mem_block);
+                cursor->slot = k + cursor->num_attr;
+                AK_EPI;
+                return row_root;
             }
         }
-        i++;
+        AK_unpin_block(mem_block);
+        cursor->block++;
+        cursor->slot = 0;
     }
-    AK_free(addresses);
-	AK_DeleteAll_L3(&row_root);
-	AK_free(row_root);
     AK_EPI;
     return NULL;
 }
 
+/**
+ * @brief Function that fetches the next row of a cursor into a tuple. It reads the rows AK_row_cursor_next reads,
+ * but copies the values of a row into the buffer of the tuple instead of allocating a list node for each of them.
+ * @param cursor open cursor
+ * @param tuple tuple of the schema of the table
+ * @return EXIT_SUCCESS, EXIT_ERROR after the last row
+ */
+int AK_row_cursor_next_tuple(AK_row_cursor *cursor, AK_tuple *tuple)
+{
+    AK_mem_block *mem_block;
+    AK_block *block;
+    int k;
+    AK_PRO;
+    while (cursor->addresses.address_from[cursor->extent] != 0) {
+        mem_block = NULL;
+        if (cursor->block < cursor->addresses.address_to[cursor->extent])
+            mem_block = AK_get_block_pinned(cursor->block, &cursor->scan);
+        block = mem_block != NULL ? mem_block->block : NULL;
+        if (block == NULL || block->last_tuple_dict_id == 0) {
+            if (mem_block != NULL)
+                AK_unpin_block(mem_block);
+            cursor->extent++;
+            cursor->block = cursor->addresses.address_from[cursor->extent];
+            cursor->slot = 0;
+            AK_cache_scan_hint(&cursor->scan, cursor->block != 0 ? cursor->block : -1, cursor->addresses.address_to[cursor->extent]);
+            continue;
+        }
+        for (k = cursor->slot; k < DATA_BLOCK_SIZE; k += cursor->num_attr) {
+            if (block->tuple_dict[k].size > 0) {
+                cursor->slot = k + cursor->num_attr;
+                if (AK_tuple_from_block(tuple, block, k) == EXIT_SUCCESS) {
+                    AK_unpin_block(mem_block);
+                    AK_EPI;
+                    return EXIT_SUCCESS;
+                }
+            }
+        }
+        AK_unpin_block(mem_block);
+        cursor->block++;
+        cursor->slot = 0;
+    }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @brief Function that splits the blocks of an open cursor into cursors over consecutive block ranges. Like the
+ * cursor, a part stops reading an extent at its first block without rows.
+ * @param cursor open cursor that has not fetched a row yet
+ * @param parts cursors over the parts, in the order of the rows
+ * @param max_parts maximum number of parts
+ * @param min_blocks minimum number of blocks of a part
+ * @return number of parts, at least 1
+ */
+int AK_row_cursor_split(AK_row_cursor *cursor, AK_row_cursor *parts, int max_parts, int min_blocks)
+{
+    int used_to[MAX_EXTENTS_IN_SEGMENT];
+    int e, block, total = 0, num_parts, per_part, part, taken, extent, take;
+    AK_PRO;
+
+    /// blocks with rows in every extent
+    for (e = 0; e < MAX_EXTENTS_IN_SEGMENT && cursor->addresses.address_from[e] != 0; e++) {
+        for (block = cursor->addresses.address_from[e]; block < cursor->addresses.address_to[e]; block++)
+            if (AK_get_block(block)->block->last_tuple_dict_id == 0)
+                break;
+        used_to[e] = block;
+        total += block - cursor->addresses.address_from[e];
+    }
+
+    num_parts = min_blocks > 0 ? total / min_blocks : total;
+    if (num_parts > max_parts)
+        num_parts = max_parts;
+    if (num_parts < 1)
+        num_parts = 1;
+    per_part = (total + num_parts - 1) / num_parts;
+
+    memset(parts, 0, num_parts * sizeof (AK_row_cursor));
+    e = 0;
+    block = cursor->addresses.address_from[0];
+    for (part = 0; part < num_parts; part++) {
+        parts[part].num_attr = cursor->num_attr;
+        for (taken = 0, extent = 0; taken < per_part && e < MAX_EXTENTS_IN_SEGMENT && cursor->addresses.address_from[e] != 0;) {
+            if (block >= used_to[e]) {
+                e++;
+                if (e < MAX_EXTENTS_IN_SEGMENT)
+                    block = cursor->addresses.address_from[e];
+                continue;
+            }
+            take = used_to[e] - block < per_part - taken ? used_to[e] - block : per_part - taken;
+            parts[part].addresses.address_from[extent] = block;
+            parts[part].addresses.address_to[extent] = block + take;
+            extent++;
+            block += take;
+            taken += take;
+        }
+        parts[part].block = parts[part].addresses.address_from[0];
+        AK_cache_scan_hint(&parts[part].scan, parts[part].block != 0 ? parts[part].block : -1, parts[part].addresses.address_to[0]);
+    }
+    AK_EPI;
+    return num_parts;
+}
+
+/**
+ * @author Markus Schatten, Matija Šestak.
+ * @brief  Function that fetches all values in some row and put on the list. The row is found through the row
+ * locator of the table, so a loop over all rows reads every block only once.
+ * @param num zero-based row index
+ * @param  * tblName table name
+ * @return row values list
+ */
+struct list_node *AK_get_row(int num, char * tblName) {
+    AK_PRO;
+    struct list_node *row_root;
+    int num_attr, block_address, k, l;
+    char data[MAX_VARCHAR_LENGTH];
+
+    if (AK_row_locate(tblName, num, &block_address, &k) != EXIT_SUCCESS) {
+        AK_EPI;
+        return NULL;
+    }
+    num_attr = AK_num_attr(tblName);
+    AK_mem_block *temp = (AK_mem_block*) AK_get_block(block_address);
+    row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    for (l = 0; l < num_attr; l++) {
+        int type = temp->block->tuple_dict[k + l].type;
+        int size = temp->block->tuple_dict[k + l].size;
+        int address = temp->block->tuple_dict[k + l].address;
+        memcpy(data, &(temp->block->data[address]), size);
+        data[size] = '\0';
+        AK_InsertAtEnd_L3(type, data, size, row_root);
+    }
+    AK_EPI;
+    return row_root;
+}
+
 /**
  * @author Barbara Tatai, updated by Josip Šušnjara (chained blocks support)
  * @brief Function that finds the tuple in memory
@@ -492,11 +879,28 @@ struct list_node *AK_get_tuple(int row, int column, char *tblName) {
         return NULL;
     }
 
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&row_root);
 
+    /// tables stored one block per row go straight to the row through the row locator
+    if (num_attr <= MAX_ATTRIBUTES) {
+        struct list_node *next = NULL;
+        int address, k;
+        char data[MAX_VARCHAR_LENGTH];
+        if (AK_row_locate(tblName, row, &address, &k) == EXIT_SUCCESS) {
+            AK_block *block = AK_get_block(address)->block;
+            int size = block->tuple_dict[k + column].size;
+            memcpy(data, &(block->data[block->tuple_dict[k + column].address]), size);
+            data[size] = '\0';
+            AK_InsertAtEnd_L3(block->tuple_dict[k + column].type, data, size, row_root);
+            next = AK_First_L2(row_root);
+        }
+        AK_free(row_root);
+        AK_EPI;
+        return next;
+    }
+
+    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
     struct list_node* tupleFound = AK_find_tuple(row, column, num_attr, addresses, row_root);
     if(tupleFound == NULL) {
         AK_free(addresses);
@@ -1466,11 +1870,57 @@ TestResult AK_table_test() {
     printf("Table \"student\": AK_get_tuple for row=0, column=1:");
     printf("%s\n", tuple_to_string);
 	
+    printf("Table \"student\": row locator and row cursor: ");
+    AK_row_cursor cursor;
+    struct list_node *row, *cursor_row, *a, *b;
+    int num_records = AK_get_num_records("student");
+    int rows_match = AK_row_cursor_open(&cursor, "student") == EXIT_SUCCESS;
+    for (i = 0; rows_match && (cursor_row = AK_row_cursor_next(&cursor)) != NULL; i++) {
+        row = AK_get_row(i, "student");
+        for (a = AK_First_L2(row), b = AK_First_L2(cursor_row); a != NULL && b != NULL; a = a->next, b = b->next)
+            if (a->size != b->size || memcmp(a->data, b->data, a->size) != 0)
+                break;
+        rows_match = row != NULL && a == NULL && b == NULL;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+        AK_DeleteAll_L3(&cursor_row);
+        AK_free(cursor_row);
+    }
+    rows_match = rows_match && i == num_records && AK_get_row(i, "student") == NULL;
+
+    /// the locator follows an insert and a delete without being rebuilt by hand
+    int mbr = 99999, found = 0;
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    row = AK_get_row(0, "student");
+    for (a = AK_First_L2(row), i = 0; a != NULL; a = a->next, i++)
+        AK_Insert_New_Element(a->type, i == 0 ? (void *) &mbr : (void *) a->data, "student", (head + i)->att_name, row_root);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    for (i = 0; (row = AK_get_row(i, "student")) != NULL; i++) {
+        if (memcmp(AK_First_L2(row)->data, &mbr, sizeof(int)) == 0)
+            found++;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    int inserted = found == 1 && i == num_records + 1 && AK_get_num_records("student") == num_records + 1;
+    AK_Update_Existing_Element(TYPE_INT, &mbr, "student", (head + 0)->att_name, row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    int deleted = AK_get_num_records("student") == num_records && AK_get_row(num_records, "student") == NULL;
+    printf("%s\n", rows_match && inserted && deleted ? "ok" : "FAILED");
+
     const int testConditions[] = {
         get_num_records != EXIT_WARNING, 
         get_attr_name != NULL, 
         get_attr_index != EXIT_WARNING, 
-        tuple_to_string != NULL
+        tuple_to_string != NULL,
+        rows_match,
+        inserted,
+        deleted
     };
     
     unsigned short successfulTests = 0, failedTests = 0;
@@ -24,6 +24,7 @@
 #define TABLE
 
 #include "../mm/memoman.h"
+#include "tuple.h"
 
 
 struct AK_create_table_struct {
@@ -33,6 +34,73 @@ struct AK_create_table_struct {
 
 typedef struct AK_create_table_struct AK_create_table_parameter;
 
+/**
+ * @def AK_ROW_LOCATOR_SIZE
+ * @brief Constant declaring the number of buckets of the row locator hash table
+ */
+#define AK_ROW_LOCATOR_SIZE 64
+
+/**
+ * @brief Live rows of one block of a table, as counted by a row locator
+ */
+typedef struct {
+    /// block address
+    int address;
+    /// zero-based number of the first row of the block
+    int first_row;
+    /// number of rows in the block
+    int rows;
+    /// number of used tuple_dict entries in the block (the way AK_get_num_records counts them)
+    int slots;
+    /// 1 if the block is empty and ends the scan of its extent
+    int end;
+    /// AK_blocks_generation when the block was counted
+    unsigned long generation;
+} AK_row_locator_block;
+
+/**
+ * @brief Row locator of a table: the blocks a scan of the table reads, with the rows each of them holds, so that
+ * AK_get_row can go straight to the block of a row. Blocks changed since they were counted are counted again.
+ */
+typedef struct AK_row_locator {
+    /// table name
+    char table[MAX_VARCHAR_LENGTH];
+    /// number of attributes when the blocks were collected
+    int num_attr;
+    /// extents the blocks were collected from
+    table_addresses addresses;
+    /// blocks in scan order
+    AK_row_locator_block *blocks;
+    int num_blocks;
+    int capacity;
+    /// total number of rows and used tuple_dict entries
+    int num_rows;
+    int num_slots;
+    /// AK_blocks_generation when the locator was last checked
+    unsigned long generation;
+    /// last row found by AK_row_locate (-1 if none), with its block index and tuple_dict entry, so that the next
+    /// row is searched from there
+    int position_row;
+    int position_block;
+    int position_slot;
+    struct AK_row_locator *next;
+} AK_row_locator;
+
+/**
+ * @brief Cursor reading the rows of a table in the order of AK_get_row, one block after another
+ */
+typedef struct {
+    /// extents of the table when the cursor was opened
+    table_addresses addresses;
+    int num_attr;
+    /// extent, block and tuple_dict entry the next row is searched from
+    int extent;
+    int block;
+    int slot;
+    /// read-ahead state of the scan, cleared when the last row has been fetched
+    AK_cache_scan scan;
+} AK_row_cursor;
+
 
 
 
@@ -132,6 +200,50 @@ struct list_node *AK_get_column(int num, char *tblName);
  */
 struct list_node * AK_get_row(int num, char * tblName);
 
+/**
+ * @brief Function that finds the block and tuple_dict entry of a row using the row locator of the table
+ * @param tblName table name
+ * @param num zero-based row index
+ * @param address block address of the row
+ * @param slot index of the first tuple_dict entry of the row
+ * @return EXIT_SUCCESS if the row exists, EXIT_ERROR otherwise
+ */
+int AK_row_locate(char *tblName, int num, int *address, int *slot);
+
+/**
+ * @brief Function that opens a cursor over the rows of a table
+ * @param cursor cursor to open
+ * @param tblName table name
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+int AK_row_cursor_open(AK_row_cursor *cursor, char *tblName);
+
+/**
+ * @brief Function that fetches the next row of a cursor. The block of the row is pinned while the row is copied,
+ * so cursors of other threads cannot evict it.
+ * @param cursor open cursor
+ * @return row values list like the one of AK_get_row, NULL after the last row
+ */
+struct list_node *AK_row_cursor_next(AK_row_cursor *cursor);
+
+/**
+ * @brief Function that fetches the next row of a cursor into a tuple, without allocating anything per row
+ * @param cursor open cursor
+ * @param tuple tuple of the schema of the table
+ * @return EXIT_SUCCESS, EXIT_ERROR after the last row
+ */
+int AK_row_cursor_next_tuple(AK_row_cursor *cursor, AK_tuple *tuple);
+
+/**
+ * @brief Function that splits the blocks of an open cursor into cursors over consecutive block ranges
+ * @param cursor open cursor that has not fetched a row yet
+ * @param parts cursors over the parts, in the order of the rows
+ * @param max_parts maximum number of parts
+ * @param min_blocks minimum number of blocks of a part
+ * @return number of parts, at least 1
+ */
+int AK_row_cursor_split(AK_row_cursor *cursor, AK_row_cursor *parts, int max_parts, int min_blocks);
+
 /**
  * @author Matija Šestak.
  * @brief Function that fetches a value in some row and column
@@ -214,6 +326,14 @@ void AK_print_table_to_file(char *tblName);
  */
 int AK_table_empty(char *tblName);
 
+/**
+ * @author Jurica Hlevnjak
+ * @brief Function that examines whether there is a table with the name "tblName" in the system catalog (AK_relation)
+ * @param tblName table name
+ * @return returns 1 if table exist or returns 0 if table does not exist
+ */
+int AK_table_exist(char *tblName);
+
 /**
  * @author Dejan Frankovic
  * @brief  Function that fetches an obj_id of named table from AK_relation system table
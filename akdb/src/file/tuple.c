@@ -0,0 +1,578 @@
+/**
+@file tuple.c Provides a compact row representation and adapters to and from row lists
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "tuple.h"
+#include "table.h"
+#include "fileio.h"
+
+/*
+ * A row list spends a list_node of more than 700 bytes and an allocation on every value, and repeats the table
+ * and attribute names in each of them. A tuple keeps the values of a row back to back in one buffer, with their
+ * attribute positions, types, offsets and lengths in a fixed array; the names are held once by the schema. Modules
+ * move to tuples one at a time: AK_tuple_from_list and AK_tuple_to_list convert at the boundary to code that still
+ * works with lists.
+ */
+
+/**
+ * @brief Function that creates the schema of a table for its tuples
+ * @param tblName table name
+ * @return schema, NULL if the table does not exist
+ */
+AK_tuple_schema *AK_tuple_schema_create(char *tblName)
+{
+    AK_tuple_schema *schema;
+    AK_header *header;
+    int num_attr;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    header = num_attr > 0 && num_attr <= MAX_ATTRIBUTES ? AK_get_header(tblName) : NULL;
+    if (header == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    schema = (AK_tuple_schema *) AK_calloc(1, sizeof (AK_tuple_schema));
+    strncpy(schema->table, tblName, MAX_ATT_NAME - 1);
+    schema->num_attr = num_attr;
+    memcpy(schema->header, header, num_attr * sizeof (AK_header));
+    AK_free(header);
+    AK_EPI;
+    return schema;
+}
+
+/**
+ * @brief Function that frees a schema, after all tuples using it
+ * @param schema schema, may be NULL
+ */
+void AK_tuple_schema_free(AK_tuple_schema *schema)
+{
+    AK_PRO;
+    AK_free(schema);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that finds the position of an attribute in a schema
+ * @param schema schema
+ * @param attName attribute name
+ * @return zero-based position, -1 if the table has no such attribute
+ */
+int AK_tuple_schema_find(AK_tuple_schema *schema, char *attName)
+{
+    int i;
+    AK_PRO;
+    for (i = 0; i < schema->num_attr; i++) {
+        if (strcmp(schema->header[i].att_name, attName) == 0) {
+            AK_EPI;
+            return i;
+        }
+    }
+    AK_EPI;
+    return -1;
+}
+
+/**
+ * @brief Function that creates an empty tuple
+ * @param schema schema of the tuples, it has to outlive the tuple
+ * @return tuple
+ */
+AK_tuple *AK_tuple_create(AK_tuple_schema *schema)
+{
+    AK_tuple *tuple;
+    AK_PRO;
+    tuple = (AK_tuple *) AK_calloc(1, sizeof (AK_tuple));
+    tuple->schema = schema;
+    AK_EPI;
+    return tuple;
+}
+
+/**
+ * @brief Function that removes all values of a tuple and keeps its buffer for the next row
+ * @param tuple tuple
+ */
+void AK_tuple_clear(AK_tuple *tuple)
+{
+    AK_PRO;
+    tuple->num_values = 0;
+    tuple->size = 0;
+    AK_EPI;
+}
+
+/**
+ * @brief Function that appends a value to a tuple
+ * @param tuple tuple
+ * @param ordinal position of the attribute in the schema
+ * @param type data type
+ * @param data bytes of the value
+ * @param length number of bytes
+ * @return EXIT_SUCCESS, EXIT_ERROR if the tuple already holds MAX_ATTRIBUTES values or the value is too long
+ */
+int AK_tuple_append(AK_tuple *tuple, int ordinal, int type, void *data, int length)
+{
+    AK_tuple_value *value;
+    AK_PRO;
+
+    if (tuple->num_values == MAX_ATTRIBUTES || length < 0 || length > MAX_VARCHAR_LENGTH) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (tuple->size + length + 1 > tuple->capacity) {
+        tuple->capacity = tuple->capacity == 0 ? 256 : tuple->capacity;
+        while (tuple->size + length + 1 > tuple->capacity)
+            tuple->capacity *= 2;
+        tuple->data = (char *) AK_realloc(tuple->data, tuple->capacity);
+    }
+    value = &tuple->values[tuple->num_values++];
+    value->ordinal = ordinal;
+    value->type = type;
+    value->offset = tuple->size;
+    value->length = length;
+    memcpy(tuple->data + tuple->size, data, length);
+    tuple->data[tuple->size + length] = '\0';
+    tuple->size += length + 1;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the bytes of a value of a tuple, valid until the tuple changes
+ * @param tuple tuple
+ * @param i zero-based value index
+ * @return bytes of the value, followed by a '\0'
+ */
+char *AK_tuple_data(AK_tuple *tuple, int i)
+{
+    AK_PRO;
+    AK_EPI;
+    return tuple->data + tuple->values[i].offset;
+}
+
+/**
+ * @brief Function that frees a tuple
+ * @param tuple tuple, may be NULL
+ */
+void AK_tuple_free(AK_tuple *tuple)
+{
+    AK_PRO;
+    if (tuple != NULL)
+        AK_free(tuple->data);
+    AK_free(tuple);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that reads a row of a block into a tuple
+ * @param tuple tuple, cleared first
+ * @param block block of the table of the schema
+ * @param slot tuple_dict entry of the first attribute of the row
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row does not fit into the block or into the tuple
+ */
+int AK_tuple_from_block(AK_tuple *tuple, AK_block *block, int slot)
+{
+    AK_tuple_dict *entry;
+    int l;
+    AK_PRO;
+
+    AK_tuple_clear(tuple);
+    if (slot < 0 || slot + tuple->schema->num_attr > DATA_BLOCK_SIZE) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (l = 0; l < tuple->schema->num_attr; l++) {
+        entry = &block->tuple_dict[slot + l];
+        if (AK_tuple_append(tuple, l, entry->type, &block->data[entry->address], entry->size) != EXIT_SUCCESS) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that converts a row list into a tuple
+ * @param tuple tuple, cleared first
+ * @param row_root row list
+ * @param by_name 1 for a row built with AK_Insert_New_Element, whose values are matched to the schema by attribute
+ * name, measured with AK_type_size and put in schema order; 0 for a row like the ones of AK_get_row, whose values
+ * are in schema order and carry their size
+ * @return EXIT_SUCCESS, EXIT_ERROR if a value has no attribute in the schema or does not fit into the tuple
+ */
+int AK_tuple_from_list(AK_tuple *tuple, struct list_node *row_root, int by_name)
+{
+    struct list_node *el;
+    AK_tuple_value value;
+    int i, ordinal, length;
+    AK_PRO;
+
+    AK_tuple_clear(tuple);
+    for (el = AK_First_L2(row_root), i = 0; el != NULL; el = AK_Next_L2(el), i++) {
+        if (by_name) {
+            ordinal = AK_tuple_schema_find(tuple->schema, el->attribute_name);
+            length = AK_type_size(el->type, el->data);
+        }
+        else {
+            ordinal = i;
+            length = el->size;
+        }
+        if (ordinal == -1 || ordinal >= tuple->schema->num_attr
+                || AK_tuple_append(tuple, ordinal, el->type, el->data, length) != EXIT_SUCCESS) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    /// rows built with AK_Insert_New_Element usually hold the attributes last first
+    for (i = 1; by_name && i < tuple->num_values; i++) {
+        value = tuple->values[i];
+        for (ordinal = i; ordinal > 0 && tuple->values[ordinal - 1].ordinal > value.ordinal; ordinal--)
+            tuple->values[ordinal] = tuple->values[ordinal - 1];
+        tuple->values[ordinal] = value;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that converts a tuple into a row list
+ * @param tuple tuple
+ * @param by_name 1 for a row like the ones given to AK_insert_row, built with AK_Insert_New_Element with the table
+ * and attribute names of the schema; 0 for a row like the ones of AK_get_row
+ * @return row list, to be freed with AK_DeleteAll_L3 and AK_free
+ */
+struct list_node *AK_tuple_to_list(AK_tuple *tuple, int by_name)
+{
+    struct list_node *row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    char data[MAX_VARCHAR_LENGTH + 1];
+    AK_tuple_value *value;
+    int i;
+    AK_PRO;
+
+    AK_Init_L3(&row_root);
+    for (i = 0; i < tuple->num_values; i++) {
+        value = &tuple->values[i];
+        memset(data, 0, sizeof (data));
+        memcpy(data, tuple->data + value->offset, value->length);
+        if (by_name)
+            AK_Insert_New_Element(value->type, data, tuple->schema->table, tuple->schema->header[value->ordinal].att_name,
+                    row_root);
+        else
+            AK_InsertAtEnd_L3(value->type, data, value->length, row_root);
+    }
+    AK_EPI;
+    return row_root;
+}
+
+/**
+ * @brief Function that points values at the values of a tuple
+ * @param tuple tuple
+ * @param values values, valid until the tuple changes
+ * @return number of values
+ */
+int AK_tuple_values(AK_tuple *tuple, AK_value *values)
+{
+    int n;
+    AK_PRO;
+
+    for (n = 0; n < tuple->num_values; n++) {
+        values[n].type = tuple->values[n].type;
+        values[n].size = tuple->values[n].length;
+        values[n].data = tuple->data + tuple->values[n].offset;
+    }
+    AK_EPI;
+    return n;
+}
+
+/**
+ * @brief Function that points values at the values of a row read by a cursor
+ * @param row row
+ * @param values values in attribute order, valid until the row is freed
+ * @return number of values
+ */
+int AK_tuple_row_values(struct list_node *row, AK_value *values)
+{
+    struct list_node *el;
+    int n = 0;
+    AK_PRO;
+
+    for (el = AK_First_L2(row); el != NULL && n < MAX_ATTRIBUTES; el = AK_Next_L2(el), n++) {
+        values[n].type = el->type;
+        values[n].size = el->size;
+        values[n].data = el->data;
+    }
+    AK_EPI;
+    return n;
+}
+
+/**
+ * @brief Function that determines the number of bytes of a value that are hashed and compared as a key: a VARCHAR
+ * value ends at its first '\0'
+ * @param value value
+ * @return number of bytes
+ */
+int AK_tuple_key_size(AK_value *value)
+{
+    AK_PRO;
+    AK_EPI;
+    return value->type == TYPE_VARCHAR ? (int) strnlen(value->data, value->size) : value->size;
+}
+
+/**
+ * @brief Function that inserts values as a row into a table
+ * @param tblName table
+ * @param header header of the table, one attribute for every value
+ * @param values values of the row
+ * @param num_values number of values
+ * @param row_root empty list used for the row, it is empty again afterwards
+ */
+void AK_tuple_insert_values(char *tblName, AK_header *header, AK_value *values, int num_values, struct list_node *row_root)
+{
+    char data[MAX_VARCHAR_LENGTH + 1];
+    int i;
+    AK_PRO;
+
+    for (i = 0; i < num_values; i++) {
+        memset(data, 0, sizeof (data));
+        memcpy(data, values[i].data, values[i].size < MAX_VARCHAR_LENGTH ? values[i].size : MAX_VARCHAR_LENGTH);
+        AK_Insert_New_Element(values[i].type, data, tblName, header[i].att_name, row_root);
+    }
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that copies a row into an arena
+ * @param arena arena, zeroed before the first row
+ * @param values values of the row
+ * @param num_values number of values
+ * @return number of the row in the arena
+ */
+int AK_tuple_arena_add(AK_tuple_arena *arena, AK_value *values, int num_values)
+{
+    AK_tuple_value *value;
+    char *row, *data;
+    int i, needed, length = 0;
+    AK_PRO;
+
+    for (i = 0; i < num_values; i++)
+        length += values[i].size + 1;
+    /// rows start at a multiple of sizeof (int), so the AK_tuple_value of a row can be used in place
+    needed = (sizeof (int) + num_values * sizeof (AK_tuple_value) + length + sizeof (int) - 1) / sizeof (int) * sizeof (int);
+    if (arena->size + needed > arena->capacity) {
+        arena->capacity = (arena->capacity + needed) * 2;
+        arena->data = (char *) AK_realloc(arena->data, arena->capacity);
+    }
+    if (arena->num_rows == arena->rows_capacity) {
+        arena->rows_capacity = arena->rows_capacity ? arena->rows_capacity * 2 : 64;
+        arena->offsets = (int *) AK_realloc(arena->offsets, arena->rows_capacity * sizeof (int));
+    }
+    arena->offsets[arena->num_rows] = arena->size;
+
+    row = arena->data + arena->size;
+    memcpy(row, &num_values, sizeof (int));
+    value = (AK_tuple_value *) (row + sizeof (int));
+    data = (char *) (value + num_values);
+    for (i = 0, length = 0; i < num_values; i++) {
+        value[i].ordinal = i;
+        value[i].type = values[i].type;
+        value[i].offset = length;
+        value[i].length = values[i].size;
+        memcpy(data + length, values[i].data, values[i].size);
+        data[length + values[i].size] = '\0';
+        length += values[i].size + 1;
+    }
+    arena->size += needed;
+    AK_EPI;
+    return arena->num_rows++;
+}
+
+/**
+ * @brief Function that points values at a row of an arena
+ * @param arena arena
+ * @param row number of the row
+ * @param values values, valid until the next row is added to the arena
+ * @return number of values
+ */
+int AK_tuple_arena_values(AK_tuple_arena *arena, int row, AK_value *values)
+{
+    AK_tuple_value *value;
+    char *data;
+    int i, n;
+    AK_PRO;
+
+    memcpy(&n, arena->data + arena->offsets[row], sizeof (int));
+    value = (AK_tuple_value *) (arena->data + arena->offsets[row] + sizeof (int));
+    data = (char *) (value + n);
+    for (i = 0; i < n; i++) {
+        values[i].type = value[i].type;
+        values[i].size = value[i].length;
+        values[i].data = data + value[i].offset;
+    }
+    AK_EPI;
+    return n;
+}
+
+/**
+ * @brief Function that removes all rows of an arena and keeps its buffers for the next ones
+ * @param arena arena
+ */
+void AK_tuple_arena_clear(AK_tuple_arena *arena)
+{
+    AK_PRO;
+    arena->size = 0;
+    arena->num_rows = 0;
+    AK_EPI;
+}
+
+/**
+ * @brief Function that frees the buffers of an arena and leaves it empty
+ * @param arena arena
+ */
+void AK_tuple_arena_free(AK_tuple_arena *arena)
+{
+    AK_PRO;
+    AK_free(arena->data);
+    AK_free(arena->offsets);
+    memset(arena, 0, sizeof (AK_tuple_arena));
+    AK_EPI;
+}
+
+/**
+ * @brief Function that gives the partition of a row when an operator splits its input into AK_TUPLE_PARTITIONS
+ * temporary segments by the hash of its rows. A hash table in memory takes the low bits of the hash and every
+ * level of partitioning takes the next three high bits, so rows of one partition still spread over the partitions
+ * of the next level and over the buckets.
+ * @param hash hash of the row
+ * @param depth number of times the rows were already partitioned, less than 20
+ * @return partition number
+ */
+int AK_tuple_partition(uint64_t hash, int depth)
+{
+    AK_PRO;
+    AK_EPI;
+    return (hash >> (61 - 3 * depth)) & (AK_TUPLE_PARTITIONS - 1);
+}
+
+/**
+ * @brief Function that compares a tuple with a row list like the ones of AK_get_row
+ * @param tuple tuple
+ * @param row_root row list
+ * @return 1 if the tuple holds the values of the row in the same order, 0 otherwise
+ */
+static int AK_tuple_matches_row(AK_tuple *tuple, struct list_node *row_root)
+{
+    struct list_node *el;
+    int i;
+
+    if (row_root == NULL)
+        return 0;
+    for (el = AK_First_L2(row_root), i = 0; el != NULL; el = AK_Next_L2(el), i++)
+        if (i >= tuple->num_values || tuple->values[i].ordinal != i || tuple->values[i].type != el->type
+                || tuple->values[i].length != el->size || memcmp(AK_tuple_data(tuple, i), el->data, el->size) != 0)
+            return 0;
+    return i == tuple->num_values;
+}
+
+/**
+ * @brief Function for tuple testing. Every row of the table "student" is read as a tuple from its block and with a
+ * cursor, and converted to both list layouts and back; each of them must hold the values AK_get_row gives,
+ * and so must the rows copied into a tuple arena.
+ * @return TestResult containing information on the amount of failed/passed tests
+ */
+TestResult AK_tuple_test()
+{
+    AK_tuple_schema *schema;
+    AK_tuple *tuple, *converted;
+    AK_row_cursor cursor;
+    AK_tuple_arena arena;
+    AK_value values[MAX_ATTRIBUTES], stored[MAX_ATTRIBUTES];
+    struct list_node *row, *list;
+    int num_records, i, k, n, by_name, address, slot;
+    int from_block = 1, from_cursor = 1, positional = 1, named = 1, arena_rows = 1;
+    AK_PRO;
+    printf("\n********** TUPLE TEST **********\n\n");
+
+    schema = AK_tuple_schema_create("student");
+    if (schema == NULL || AK_row_cursor_open(&cursor, "student") != EXIT_SUCCESS) {
+        printf("Table \"student\" does not exist\n");
+        AK_tuple_schema_free(schema);
+        AK_EPI;
+        return TEST_result(0, 5);
+    }
+    memset(&arena, 0, sizeof (AK_tuple_arena));
+    tuple = AK_tuple_create(schema);
+    converted = AK_tuple_create(schema);
+    num_records = AK_get_num_records("student");
+
+    for (i = 0; i < num_records; i++) {
+        row = AK_get_row(i, "student");
+
+        from_block = from_block && AK_row_locate("student", i, &address, &slot) == EXIT_SUCCESS
+                && AK_tuple_from_block(tuple, AK_get_block(address)->block, slot) == EXIT_SUCCESS
+                && AK_tuple_matches_row(tuple, row);
+        from_cursor = from_cursor && AK_row_cursor_next_tuple(&cursor, tuple) == EXIT_SUCCESS
+                && AK_tuple_matches_row(tuple, row);
+        AK_tuple_arena_add(&arena, values, AK_tuple_values(tuple, values));
+
+        /// a positional list is the row itself; a named list is converted back by attribute names
+        for (by_name = 0; by_name < 2; by_name++) {
+            list = AK_tuple_to_list(tuple, by_name);
+            if (AK_tuple_from_list(converted, list, by_name) != EXIT_SUCCESS || !AK_tuple_matches_row(converted, row)
+                    || (!by_name && !AK_tuple_matches_row(tuple, list))) {
+                if (by_name)
+                    named = 0;
+                else
+                    positional = 0;
+            }
+            AK_DeleteAll_L3(&list);
+            AK_free(list);
+        }
+
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    from_cursor = from_cursor && AK_row_cursor_next_tuple(&cursor, tuple) == EXIT_ERROR;
+
+    /// the rows copied into the arena are read back after all of them were added
+    arena_rows = arena.num_rows == num_records;
+    for (i = 0; arena_rows && i < num_records; i++) {
+        row = AK_get_row(i, "student");
+        n = AK_tuple_row_values(row, values);
+        arena_rows = AK_tuple_arena_values(&arena, i, stored) == n;
+        for (k = 0; arena_rows && k < n; k++)
+            arena_rows = stored[k].type == values[k].type && stored[k].size == values[k].size
+                    && memcmp(stored[k].data, values[k].data, values[k].size) == 0 && stored[k].data[values[k].size] == '\0';
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+
+    printf("AK_tuple_from_block: %s\n", from_block ? "ok" : "FAILED");
+    printf("AK_row_cursor_next_tuple: %s\n", from_cursor ? "ok" : "FAILED");
+    printf("AK_tuple_to_list and AK_tuple_from_list, positional: %s\n", positional ? "ok" : "FAILED");
+    printf("AK_tuple_to_list and AK_tuple_from_list, by name: %s\n", named ? "ok" : "FAILED");
+    printf("AK_tuple_arena_add and AK_tuple_arena_values: %s\n", arena_rows ? "ok" : "FAILED");
+
+    AK_tuple_arena_free(&arena);
+    AK_tuple_free(converted);
+    AK_tuple_free(tuple);
+    AK_tuple_schema_free(schema);
+    AK_EPI;
+    return TEST_result(from_block + from_cursor + positional + named + arena_rows,
+            5 - from_block - from_cursor - positional - named - arena_rows);
+}
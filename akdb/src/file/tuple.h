@@ -0,0 +1,117 @@
+/**
+@file tuple.h Header file that provides a compact row representation and adapters to and from row lists
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef TUPLE
+#define TUPLE
+
+#include "../auxi/test.h"
+#include "../mm/memoman.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @struct AK_tuple_schema
+ * @brief Table and attributes shared by all tuples of a table, so that a tuple does not carry any names
+ */
+typedef struct {
+    char table[MAX_ATT_NAME];
+    int num_attr;
+    AK_header header[MAX_ATTRIBUTES];
+} AK_tuple_schema;
+
+/**
+ * @struct AK_tuple_value
+ * @brief Value of a tuple: the attribute it belongs to and where its bytes are in the data of the tuple
+ */
+typedef struct {
+    /// position of the attribute in the schema
+    int ordinal;
+    int type;
+    int offset;
+    int length;
+} AK_tuple_value;
+
+/**
+ * @struct AK_tuple
+ * @brief Row held in one buffer. Every value is followed by a '\0', so VARCHAR values can be used in place. A
+ * tuple is meant to be reused for many rows; its buffer only grows.
+ */
+typedef struct {
+    AK_tuple_schema *schema;
+    int num_values;
+    AK_tuple_value values[MAX_ATTRIBUTES];
+    /// bytes used and allocated in data
+    int size;
+    int capacity;
+    char *data;
+} AK_tuple;
+
+/**
+ * @struct AK_value
+ * @brief Type, size and bytes of a value, pointing into a tuple, a row list or a tuple arena
+ */
+typedef struct {
+    int type;
+    int size;
+    char *data;
+} AK_value;
+
+/**
+ * @struct AK_tuple_arena
+ * @brief Rows held in memory by an operator, copied into one buffer. A row is laid out like a tuple: its number
+ * of values, an AK_tuple_value for every value and then the data, every value followed by a '\0'.
+ */
+typedef struct {
+    char *data;
+    int size;
+    int capacity;
+    /// offset of every row in data
+    int *offsets;
+    int num_rows;
+    int rows_capacity;
+} AK_tuple_arena;
+
+/**
+ * @def AK_TUPLE_PARTITIONS
+ * @brief Number of partitions AK_tuple_partition splits rows into
+ */
+#define AK_TUPLE_PARTITIONS 8
+
+AK_tuple_schema *AK_tuple_schema_create(char *tblName);
+void AK_tuple_schema_free(AK_tuple_schema *schema);
+int AK_tuple_schema_find(AK_tuple_schema *schema, char *attName);
+AK_tuple *AK_tuple_create(AK_tuple_schema *schema);
+void AK_tuple_clear(AK_tuple *tuple);
+int AK_tuple_append(AK_tuple *tuple, int ordinal, int type, void *data, int length);
+char *AK_tuple_data(AK_tuple *tuple, int i);
+void AK_tuple_free(AK_tuple *tuple);
+int AK_tuple_from_block(AK_tuple *tuple, AK_block *block, int slot);
+int AK_tuple_from_list(AK_tuple *tuple, struct list_node *row_root, int by_name);
+struct list_node *AK_tuple_to_list(AK_tuple *tuple, int by_name);
+int AK_tuple_values(AK_tuple *tuple, AK_value *values);
+int AK_tuple_row_values(struct list_node *row, AK_value *values);
+int AK_tuple_key_size(AK_value *value);
+void AK_tuple_insert_values(char *tblName, AK_header *header, AK_value *values, int num_values, struct list_node *row_root);
+int AK_tuple_arena_add(AK_tuple_arena *arena, AK_value *values, int num_values);
+int AK_tuple_arena_values(AK_tuple_arena *arena, int row, AK_value *values);
+void AK_tuple_arena_clear(AK_tuple_arena *arena);
+void AK_tuple_arena_free(AK_tuple_arena *arena);
+int AK_tuple_partition(uint64_t hash, int depth);
+TestResult AK_tuple_test();
+
+#endif
@@ -30,6 +30,7 @@
 #include "mm/memoman.h"
 // File management
 #include "file/test.h"
+#include "file/statistics.h"
 //Logging
 #include "rec/archive_log.h" //ARCHIVE LOG
 //Other
@@ -115,6 +116,10 @@ int main(int argc, char * argv[])
                     AK_view_test();
                     */
                     // pthread_exit(NULL);
+                    AK_statistics_flush();
+                    AK_cache_writer_stop();
+                    AK_checkpoint();
+                    AK_close_db_file();
                     AK_EPI;
                     return ( EXIT_SUCCESS );
                 }
@@ -23,6 +23,426 @@
 
 #include "memoman.h"
 #include "../dm/dbman.h"
+#include "../file/fileio.h"
+
+/// buffer pool latch; recursive because AK_get_block evicts through AK_release_oldest_cache_block
+static pthread_mutex_t AK_cache_mutex;
+/// orders block writes of the dirty block writer and of evictions; taken after AK_cache_mutex
+static pthread_mutex_t AK_cache_io_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// background writer thread and the state it sleeps on
+static pthread_t AK_cache_writer;
+static pthread_mutex_t AK_cache_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t AK_cache_writer_wakeup = PTHREAD_COND_INITIALIZER;
+static int AK_cache_writer_running = 0;
+/// free-space map: one AK_FREE_SPACE_* state per block address. It is not stored in the DB file: after a restart every
+/// block is AK_FREE_SPACE_UNKNOWN and the map is rebuilt lazily, a block being read the first time a search looks at it
+static unsigned char AK_free_space_map[DB_FILE_BLOCKS_NUM_EX];
+/// change generations: AK_block_clock counts block changes, AK_block_changed_at holds its value at the last change of each block
+static unsigned long AK_block_clock;
+static unsigned long AK_block_changed_at[DB_FILE_BLOCKS_NUM_EX];
+static pthread_mutex_t AK_block_clock_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// segment directory: system table and segment name -> extents; entries are freed when their segment is deleted
+static AK_segment_directory_entry *AK_segment_directory[AK_SEGMENT_DIRECTORY_SIZE];
+static pthread_mutex_t AK_segment_directory_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Function that maps a block address to a bucket of the buffer pool hash table
+ * @param address block address
+ * @return bucket index
+ */
+static AK_INLINE int AK_cache_hash(int address)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	return (int)(((unsigned int)address * 2654435761u) & (unsigned int)(dbCache->hash_size - 1));
+}
+
+/**
+ * @brief Function that links a frame into the hash chain of the block it holds
+ * @param frame frame index
+ */
+static void AK_cache_hash_insert(int frame)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int bucket = AK_cache_hash(dbCache->cache[frame]->block->address);
+	dbCache->hash_next[frame] = dbCache->hash_bucket[bucket];
+	dbCache->hash_bucket[bucket] = frame;
+}
+
+/**
+ * @brief Function that unlinks a frame from the hash chain of the block it holds
+ * @param frame frame index
+ */
+static void AK_cache_hash_remove(int frame)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int bucket = AK_cache_hash(dbCache->cache[frame]->block->address);
+	int *link = &dbCache->hash_bucket[bucket];
+
+	while (*link != -1)
+	{
+		if (*link == frame)
+		{
+			*link = dbCache->hash_next[frame];
+			dbCache->hash_next[frame] = -1;
+			return;
+		}
+		link = &dbCache->hash_next[*link];
+	}
+}
+
+/**
+ * @brief Function that returns the buffer pool frame holding the block with the given address
+ * @param num block number (address)
+ * @return frame index, -1 if the block is not cached
+ */
+int AK_cache_lookup(int num)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int frame;
+
+	pthread_mutex_lock(&AK_cache_mutex);
+	frame = dbCache->hash_bucket[AK_cache_hash(num)];
+	while (frame != -1 && dbCache->cache[frame]->block->address != num)
+		frame = dbCache->hash_next[frame];
+	pthread_mutex_unlock(&AK_cache_mutex);
+	return frame;
+}
+
+/**
+ * @brief Function that unlinks a frame from the replacement queue it is in
+ * @param frame frame index
+ */
+static void AK_cache_queue_unlink(int frame)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	AK_mem_block *mem_block = dbCache->cache[frame];
+	int queue = mem_block->queue;
+
+	if (queue == CACHE_QUEUE_NONE)
+		return;
+	if (mem_block->queue_prev != -1)
+		dbCache->cache[mem_block->queue_prev]->queue_next = mem_block->queue_next;
+	else
+		dbCache->queue_head[queue] = mem_block->queue_next;
+	if (mem_block->queue_next != -1)
+		dbCache->cache[mem_block->queue_next]->queue_prev = mem_block->queue_prev;
+	else
+		dbCache->queue_tail[queue] = mem_block->queue_prev;
+	dbCache->queue_length[queue]--;
+	mem_block->queue = CACHE_QUEUE_NONE;
+	mem_block->queue_prev = mem_block->queue_next = -1;
+}
+
+/**
+ * @brief Function that moves a frame to the tail (most recently used end) of a replacement queue
+ * @param frame frame index
+ * @param queue CACHE_QUEUE_A1IN or CACHE_QUEUE_AM
+ */
+static void AK_cache_queue_append(int frame, int queue)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	AK_mem_block *mem_block = dbCache->cache[frame];
+
+	AK_cache_queue_unlink(frame);
+	mem_block->queue = queue;
+	mem_block->queue_prev = dbCache->queue_tail[queue];
+	mem_block->queue_next = -1;
+	if (dbCache->queue_tail[queue] != -1)
+		dbCache->cache[dbCache->queue_tail[queue]]->queue_next = frame;
+	else
+		dbCache->queue_head[queue] = frame;
+	dbCache->queue_tail[queue] = frame;
+	dbCache->queue_length[queue]++;
+}
+
+/**
+ * @brief Function that maps a block address to a bucket of the ghost ring hash table
+ * @param address block address
+ * @return bucket index
+ */
+static AK_INLINE int AK_cache_ghost_hash(int address)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	return (int)(((unsigned int)address * 2654435761u) & (unsigned int)(dbCache->ghost_hash_size - 1));
+}
+
+/**
+ * @brief Function that empties a ghost ring slot and unlinks it from its bucket chain
+ * @param slot ghost ring slot
+ */
+static void AK_cache_ghost_clear(int slot)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int *link;
+
+	if (dbCache->ghost[slot] == -1)
+		return;
+	link = &dbCache->ghost_bucket[AK_cache_ghost_hash(dbCache->ghost[slot])];
+	while (*link != -1)
+	{
+		if (*link == slot)
+		{
+			*link = dbCache->ghost_chain[slot];
+			break;
+		}
+		link = &dbCache->ghost_chain[*link];
+	}
+	dbCache->ghost_chain[slot] = -1;
+	dbCache->ghost[slot] = -1;
+}
+
+/**
+ * @brief Function that forgets every recently evicted block
+ */
+static void AK_cache_ghost_reset()
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int i;
+
+	for (i = 0; i < dbCache->ghost_size; i++)
+	{
+		dbCache->ghost[i] = -1;
+		dbCache->ghost_chain[i] = -1;
+	}
+	for (i = 0; i < dbCache->ghost_hash_size; i++)
+		dbCache->ghost_bucket[i] = -1;
+	dbCache->ghost_next = 0;
+}
+
+/**
+ * @brief Function that remembers the address of a block evicted from the 2Q A1in queue
+ * @param address block address
+ */
+static void AK_cache_ghost_add(int address)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int slot = dbCache->ghost_next;
+	int bucket = AK_cache_ghost_hash(address);
+
+	AK_cache_ghost_clear(slot);
+	dbCache->ghost[slot] = address;
+	dbCache->ghost_chain[slot] = dbCache->ghost_bucket[bucket];
+	dbCache->ghost_bucket[bucket] = slot;
+	dbCache->ghost_next = (slot + 1) % dbCache->ghost_size;
+}
+
+/**
+ * @brief Function that checks whether a block was recently evicted and forgets it
+ * @param address block address
+ * @return 1 if the address was in the ghost ring, 0 otherwise
+ */
+static int AK_cache_ghost_take(int address)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int slot = dbCache->ghost_bucket[AK_cache_ghost_hash(address)];
+
+	while (slot != -1 && dbCache->ghost[slot] != address)
+		slot = dbCache->ghost_chain[slot];
+	if (slot == -1)
+		return 0;
+	AK_cache_ghost_clear(slot);
+	return 1;
+}
+
+/**
+ * @brief Function that updates the replacement policy state after a block has been read into a frame
+ * @param frame frame index
+ */
+static void AK_cache_policy_load(int frame)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	AK_mem_block *mem_block = dbCache->cache[frame];
+
+	switch (dbCache->policy)
+	{
+		case CACHE_POLICY_CLOCK:
+			mem_block->reference = 1;
+			break;
+		case CACHE_POLICY_2Q:
+			/// a block that comes back soon after eviction is hot, the rest waits in A1in
+			if (AK_cache_ghost_take(mem_block->block->address))
+				AK_cache_queue_append(frame, CACHE_QUEUE_AM);
+			else
+				AK_cache_queue_append(frame, CACHE_QUEUE_A1IN);
+			break;
+		default:
+			AK_cache_queue_append(frame, CACHE_QUEUE_A1IN);
+			break;
+	}
+}
+
+/**
+ * @brief Function that updates the replacement policy state after a block has been found in the pool
+ * @param frame frame index
+ */
+static void AK_cache_policy_hit(int frame)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	AK_mem_block *mem_block = dbCache->cache[frame];
+
+	switch (dbCache->policy)
+	{
+		case CACHE_POLICY_CLOCK:
+			mem_block->reference = 1;
+			break;
+		case CACHE_POLICY_2Q:
+			/// hits in A1in are correlated references (e.g. one scan reading a block tuple by tuple)
+			if (mem_block->queue == CACHE_QUEUE_AM)
+				AK_cache_queue_append(frame, CACHE_QUEUE_AM);
+			break;
+		default:
+			AK_cache_queue_append(frame, CACHE_QUEUE_A1IN);
+			break;
+	}
+}
+
+/**
+ * @brief Function that returns the first frame of a replacement queue that is not pinned
+ * @param queue CACHE_QUEUE_A1IN or CACHE_QUEUE_AM
+ * @return frame index, -1 if every frame of the queue is pinned
+ */
+static int AK_cache_queue_first_unpinned(int queue)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int frame = dbCache->queue_head[queue];
+
+	while (frame != -1 && dbCache->cache[frame]->pin > 0)
+		frame = dbCache->cache[frame]->queue_next;
+	return frame;
+}
+
+/**
+ * @brief Function that selects the frame to evict according to the replacement policy. Pinned frames are skipped.
+ * @param evict 1 if the frame is really going to be evicted (CLOCK clears reference bits on the way), 0 to only look
+ * @return frame index, -1 if no frame holds a block
+ */
+static int AK_cache_select_victim(int evict)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int i, frame, first_used = -1;
+	int a1in, am;
+
+	switch (dbCache->policy)
+	{
+		case CACHE_POLICY_CLOCK:
+			/// two sweeps are enough: the first one clears every reference bit it passes
+			for (i = 0; i < 2 * dbCache->pool_size; i++)
+			{
+				frame = (dbCache->clock_hand + i) % dbCache->pool_size;
+				if (dbCache->cache[frame]->block->address == -1 || dbCache->cache[frame]->pin > 0)
+					continue;
+				if (first_used == -1)
+					first_used = frame;
+				if (dbCache->cache[frame]->reference == 0)
+				{
+					if (evict)
+						dbCache->clock_hand = (frame + 1) % dbCache->pool_size;
+					return frame;
+				}
+				if (evict)
+					dbCache->cache[frame]->reference = 0;
+				else if (i >= dbCache->pool_size - 1)
+					break;
+			}
+			return first_used;
+		case CACHE_POLICY_2Q:
+			a1in = AK_cache_queue_first_unpinned(CACHE_QUEUE_A1IN);
+			am = AK_cache_queue_first_unpinned(CACHE_QUEUE_AM);
+			if (am == -1 || (dbCache->queue_length[CACHE_QUEUE_A1IN] > dbCache->a1in_size && a1in != -1))
+				return a1in;
+			return am;
+		default:
+			return AK_cache_queue_first_unpinned(CACHE_QUEUE_A1IN);
+	}
+}
+
+/**
+ * @brief Function that returns the frame the replacement policy would evict next, without evicting it
+ * @return frame index (also stored in next_replace), -1 if no frame holds a block
+ */
+int AK_cache_next_victim()
+{
+	int frame;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	pthread_mutex_lock(&AK_cache_mutex);
+	frame = dbCache->next_replace = AK_cache_select_victim(0);
+	pthread_mutex_unlock(&AK_cache_mutex);
+	AK_EPI;
+	return frame;
+}
+
+/**
+ * @brief Function that maps the cache:policy value from config.ini to a replacement policy
+ * @param name policy name
+ * @return CACHE_POLICY_LRU, CACHE_POLICY_CLOCK or CACHE_POLICY_2Q
+ */
+static int AK_cache_policy_by_name(const char *name)
+{
+	if (name == NULL || strcmp(name, "lru") == 0)
+		return CACHE_POLICY_LRU;
+	if (strcmp(name, "clock") == 0)
+		return CACHE_POLICY_CLOCK;
+	if (strcmp(name, "2q") == 0)
+		return CACHE_POLICY_2Q;
+	printf("AK_cache_AK_malloc: WARNING. Unknown cache policy '%s', using lru\n", name);
+	return CACHE_POLICY_LRU;
+}
+
+/**
+ * @brief Function that switches the buffer pool to another replacement policy
+ * @param policy CACHE_POLICY_LRU, CACHE_POLICY_CLOCK or CACHE_POLICY_2Q
+ * @return EXIT_SUCCESS if the policy has been set, EXIT_ERROR otherwise
+ */
+int AK_cache_set_policy(int policy)
+{
+	int i;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	if (policy < 0 || policy >= CACHE_POLICY_COUNT)
+	{
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	pthread_mutex_lock(&AK_cache_mutex);
+	for (i = 0; i < dbCache->pool_size; i++)
+		AK_cache_queue_unlink(i);
+	AK_cache_ghost_reset();
+	dbCache->clock_hand = 0;
+	dbCache->policy = policy;
+	/// queue the cached blocks again as if they had just been read
+	for (i = 0; i < dbCache->pool_size; i++)
+	{
+		dbCache->cache[i]->reference = 0;
+		if (dbCache->cache[i]->block->address != -1)
+			AK_cache_policy_load(i);
+	}
+	dbCache->next_replace = AK_cache_select_victim(0);
+	pthread_mutex_unlock(&AK_cache_mutex);
+	AK_EPI;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that prints buffer pool hit and miss counters of every replacement policy
+ */
+void AK_cache_print_stats()
+{
+	static const char *names[CACHE_POLICY_COUNT] = { "lru", "clock", "2q" };
+	int i;
+	unsigned long total;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	printf("Buffer pool: %d frames, policy %s\n", dbCache->pool_size, names[dbCache->policy]);
+	for (i = 0; i < CACHE_POLICY_COUNT; i++)
+	{
+		total = dbCache->hits[i] + dbCache->misses[i];
+		printf("%-6s hits: %lu\tmisses: %lu\thit ratio: %.2f%%\n", names[i], dbCache->hits[i], dbCache->misses[i],
+			   total ? 100.0 * dbCache->hits[i] / total : 0.0);
+	}
+	printf("blocks read ahead: %lu\n", dbCache->readahead_blocks);
+	AK_EPI;
+}
 
 /**
   * @author Nikola Bakoš, Matija Šestak(revised)
@@ -35,26 +455,38 @@
 int AK_cache_block(int num, AK_mem_block *mem_block)
 {
 	unsigned long timestamp;
-	AK_block *block_cache;
-	AK_block *block_cache_old;
+	int in_pool;
 	AK_PRO;
-	/// read the block from the given address
-	block_cache = AK_read_block(num);
-	block_cache_old = mem_block->block;
-	mem_block->block = block_cache;
+	/// read the block from the given address straight into the cache frame
+	if (mem_block->block == NULL)
+		mem_block->block = (AK_block *) AK_malloc(sizeof(AK_block));
+	in_pool = mem_block->frame >= 0 && db_cache.ptr != NULL;
+	if (in_pool)
+	{
+		pthread_mutex_lock(&AK_cache_mutex);
+		AK_cache_hash_remove(mem_block->frame);
+	}
+	if (mem_block->block == NULL || AK_read_block_into(num, mem_block->block) != EXIT_SUCCESS)
+	{
+		if (in_pool)
+			pthread_mutex_unlock(&AK_cache_mutex);
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	if (in_pool)
+	{
+		AK_cache_hash_insert(mem_block->frame);
+		AK_cache_policy_load(mem_block->frame);
+	}
 	mem_block->dirty = BLOCK_CLEAN; /// set dirty bit in mem_block struct
+	mem_block->version++;
 
 	timestamp = clock(); /// get the timestamp
 	mem_block->timestamp_read = timestamp; /// set timestamp_read
 	mem_block->timestamp_last_change = timestamp; /// set timestamp_last_change
 
-	if(sizeof(block_cache) == 0)
-	{
-		AK_EPI;
-		return EXIT_ERROR;
-	}
-
-	AK_free(block_cache_old);
+	if (in_pool)
+		pthread_mutex_unlock(&AK_cache_mutex);
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -67,19 +499,92 @@ int AK_cache_block(int num, AK_mem_block *mem_block)
 int AK_cache_AK_malloc()
 {
 	int i;
+	int pool_size = CACHE_POOL_SIZE;
+	int preload;
 	AK_PRO;
+	if (pool_size < 1)
+		pool_size = MAX_CACHE_MEMORY;
 	if ((db_cache.ptr = (AK_db_cache *) AK_malloc(sizeof(AK_db_cache))) == NULL)
 	{
 		AK_EPI;
 		return EXIT_ERROR;
 	}
 	AK_db_cache* const dbCache = db_cache.ptr;
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&AK_cache_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
 	dbCache->next_replace = -1;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	dbCache->pool_size = pool_size;
+	/// keep the hash table at least twice the pool size so chains stay short
+	dbCache->hash_size = 1;
+	while (dbCache->hash_size < 2 * pool_size)
+		dbCache->hash_size <<= 1;
+	dbCache->cache = (AK_mem_block **) AK_malloc(pool_size * sizeof(AK_mem_block *));
+	dbCache->hash_bucket = (int *) AK_malloc(dbCache->hash_size * sizeof(int));
+	dbCache->hash_next = (int *) AK_malloc(pool_size * sizeof(int));
+	dbCache->free_frames = (int *) AK_malloc(pool_size * sizeof(int));
+	dbCache->free_count = 0;
+	if (dbCache->cache == NULL || dbCache->hash_bucket == NULL || dbCache->hash_next == NULL || dbCache->free_frames == NULL)
+	{
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	for (i = 0; i < dbCache->hash_size; i++)
+		dbCache->hash_bucket[i] = -1;
+
+	/// replacement policy state; 2Q keeps a quarter of the pool for first references and remembers half a pool of evictions
+	dbCache->policy = AK_cache_policy_by_name(CACHE_POLICY);
+	for (i = 0; i < 2; i++)
+	{
+		dbCache->queue_head[i] = dbCache->queue_tail[i] = -1;
+		dbCache->queue_length[i] = 0;
+	}
+	dbCache->a1in_size = pool_size / 4 > 0 ? pool_size / 4 : 1;
+	dbCache->ghost_size = pool_size / 2 > 0 ? pool_size / 2 : 1;
+	dbCache->ghost_hash_size = 1;
+	while (dbCache->ghost_hash_size < 2 * dbCache->ghost_size)
+		dbCache->ghost_hash_size <<= 1;
+	dbCache->clock_hand = 0;
+	dbCache->ghost = (int *) AK_malloc(dbCache->ghost_size * sizeof(int));
+	dbCache->ghost_chain = (int *) AK_malloc(dbCache->ghost_size * sizeof(int));
+	dbCache->ghost_bucket = (int *) AK_malloc(dbCache->ghost_hash_size * sizeof(int));
+	if (dbCache->ghost == NULL || dbCache->ghost_chain == NULL || dbCache->ghost_bucket == NULL)
+	{
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	AK_cache_ghost_reset();
+	for (i = 0; i < CACHE_POLICY_COUNT; i++)
+		dbCache->hits[i] = dbCache->misses[i] = 0;
+	dbCache->readahead_blocks = 0;
+
+	/// preload the first blocks of the DB file; frames past the initialized part of the file stay free
+	preload = ((AK_blocktable *) AK_allocationbit.ptr)->last_initialized;
+	if (preload > pool_size)
+		preload = pool_size;
+
+	for (i = 0; i < pool_size; i++)
 	{
 		dbCache->cache[ i ] = (AK_mem_block *) AK_malloc(sizeof(AK_mem_block));
 		dbCache->cache[ i ]->block = (AK_block *) AK_malloc(sizeof(AK_block));
-
+		dbCache->cache[ i ]->frame = i;
+		dbCache->cache[ i ]->reference = 0;
+		dbCache->cache[ i ]->queue = CACHE_QUEUE_NONE;
+		dbCache->cache[ i ]->queue_prev = dbCache->cache[ i ]->queue_next = -1;
+		dbCache->cache[ i ]->version = 0;
+		dbCache->cache[ i ]->pin = 0;
+		dbCache->cache[ i ]->block->address = -1;
+		dbCache->hash_next[ i ] = -1;
+
+		if (i >= preload)
+		{
+			dbCache->cache[ i ]->dirty = BLOCK_CLEAN;
+			dbCache->cache[ i ]->timestamp_read = -1;
+			dbCache->cache[ i ]->timestamp_last_change = -1;
+			continue;
+		}
 		if ((AK_cache_block(i, dbCache->cache[ i ])) == EXIT_ERROR)
 		{
 			AK_EPI;
@@ -87,6 +592,9 @@ int AK_cache_AK_malloc()
 		}
 		//printf( "Cached block %d with address %d\n", i,  &db_cache->cache[ i ]->block->address );
 	}
+	/// push free frames so that the lowest one is handed out first
+	for (i = pool_size - 1; i >= preload; i--)
+		dbCache->free_frames[ dbCache->free_count++ ] = i;
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -345,6 +853,13 @@ int AK_memoman_init()
 		return EXIT_ERROR;
 	}
 
+	if (AK_cache_writer_start() == EXIT_ERROR)
+	{
+		printf("AK_memoman_init: ERROR. AK_cache_writer_start() failed.\n");
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
 
 	printf("AK_memoman_init: Memory manager initialized...\n");
 	AK_EPI;
@@ -354,74 +869,259 @@ int AK_memoman_init()
 
 
 /**
-  * @author Tomislav Fotak, updated by Matija Šestak, Antonio Martinović
-  * @brief Function that reads a block from the memory. If the block is cached, returns the cached block. Else uses AK_cache_block to read the block
-		to cache and then returns it.
-  * @param num block number (address)
-  * @return segment start address
+  * @brief Function that announces the range of blocks a sequential scan reads next, so that misses of the scan
+  * in the range read the following blocks of the range ahead with one vectored read
+  * @param scan read-ahead state of the scan
+  * @param address_from first block address of the range (-1 ends the scan and clears its state)
+  * @param address_to last block address of the range
  */
-AK_mem_block *AK_get_block(int num)
+void AK_cache_scan_hint(AK_cache_scan *scan, int address_from, int address_to)
 {
-	int i = 0;
-	int free_pos = 0;
-	int first_AK_free_mem_block = -1;
+	AK_PRO;
+	scan->window = 1;
+	scan->next = -1;
+	scan->scan_from = address_from;
+	scan->scan_to = address_from == -1 ? -1 : address_to;
+	AK_EPI;
+}
+
+/**
+ * @brief Function that drops the cached copy of a block that is about to be overwritten on disk, e.g. because
+ * it is allocated to a new extent. The frame is given back to the pool as a free frame.
+ * @param address block address
+ */
+void AK_cache_forget_block(int address)
+{
+	int frame;
 	AK_PRO;
 	AK_db_cache* const dbCache = db_cache.ptr;
-	/* search cache for already-cached block */
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	if (dbCache == NULL)
 	{
-		if (dbCache->cache[i]->block->address == num)
-		{
-			/// found cached! we're done here
-			AK_EPI;
+		AK_EPI;
+		return;
+	}
+	pthread_mutex_lock(&AK_cache_mutex);
+	if ((frame = AK_cache_lookup(address)) != -1)
+	{
+		AK_cache_hash_remove(frame);
+		AK_cache_queue_unlink(frame);
+		dbCache->cache[frame]->block->address = -1;
+		dbCache->cache[frame]->dirty = BLOCK_CLEAN;
+		dbCache->cache[frame]->reference = 0;
+		dbCache->cache[frame]->version++;
+		dbCache->free_frames[ dbCache->free_count++ ] = frame;
+	}
+	pthread_mutex_unlock(&AK_cache_mutex);
+	AK_EPI;
+}
 
-			return dbCache->cache[i];
-		}
+/**
+ * @brief Function that decides how many blocks a miss of a scan reads. The window doubles while misses continue
+ * where the previous read of the scan ended, up to cache:readahead blocks, and never reaches past the hinted
+ * range, the initialized part of the DB file or a block that is already cached.
+ * @param num address of the missed block
+ * @param scan read-ahead state of the scan, NULL for a point read
+ * @return number of blocks to read starting with num
+ */
+static int AK_cache_readahead_window(int num, AK_cache_scan *scan)
+{
+	AK_db_cache* const dbCache = db_cache.ptr;
+	int hinted, limit, count;
 
-	}
+	if (CACHE_READAHEAD <= 1 || scan == NULL)
+		return 1;
+	hinted = scan->scan_from != -1 && num >= scan->scan_from && num <= scan->scan_to;
+	if (num == scan->next)
+		scan->window = scan->window * 2 < CACHE_READAHEAD ? scan->window * 2 : CACHE_READAHEAD;
+	else
+		scan->window = hinted ? 2 : 1;
+
+	limit = hinted ? scan->scan_to : ((AK_blocktable *) AK_allocationbit.ptr)->last_initialized - 1;
+	count = 1;
+	while (count < scan->window && count < dbCache->pool_size / 2 &&
+		   num + count <= limit && AK_cache_lookup(num + count) == -1)
+		count++;
+	scan->next = num + count;
+	return count;
+}
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
-	{
-		/// while looking for block we also want to find an empty block
-		/// in case that the actual block is not found
-		/// then there is no need to run through the blocks twice
-		if (first_AK_free_mem_block == -1 && dbCache->cache[i]->timestamp_read == -1)
-		{
-			first_AK_free_mem_block = i;
-		}
+/**
+ * @brief Function that reads a run of blocks into the buffer pool with a single vectored read
+ * @param num address of the first block
+ * @param count number of blocks
+ * @return frame holding the block num, NULL if no frames could be freed
+ */
+static AK_mem_block *AK_cache_read_ahead(int num, int count)
+{
+	int i, frame;
+	int *frames;
+	AK_block **blocks;
+	AK_mem_block *mem_block = NULL;
+	unsigned long timestamp;
+	AK_db_cache* const dbCache = db_cache.ptr;
 
+	frames = (int *) AK_malloc(count * sizeof(int));
+	blocks = (AK_block **) AK_malloc(count * sizeof(AK_block *));
+	for (i = 0; i < count; i++)
+	{
+		frame = dbCache->free_count > 0 ? dbCache->free_frames[ --dbCache->free_count ] : AK_release_oldest_cache_block();
+		if (frame == EXIT_ERROR)
+			break;
+		/// the frame no longer holds its old block
+		AK_cache_hash_remove(frame);
+		dbCache->cache[frame]->block->address = -1;
+		frames[i] = frame;
+		blocks[i] = dbCache->cache[frame]->block;
 	}
+	count = i;
 
-	if (first_AK_free_mem_block != -1)
+	if (count > 0 && AK_read_blocks_into(num, blocks, count) == EXIT_SUCCESS)
 	{
-		if (AK_cache_block(num, dbCache->cache[ first_AK_free_mem_block ]) == EXIT_SUCCESS)
+		timestamp = clock();
+		for (i = 0; i < count; i++)
 		{
-			/// created new cache block for specified address
-			AK_EPI;
-
-			return dbCache->cache[first_AK_free_mem_block];
+			AK_mem_block *read_block = dbCache->cache[frames[i]];
+			read_block->dirty = BLOCK_CLEAN;
+			read_block->version++;
+			read_block->timestamp_read = timestamp;
+			read_block->timestamp_last_change = timestamp;
+			AK_cache_hash_insert(frames[i]);
+			AK_cache_policy_load(frames[i]);
 		}
+		dbCache->readahead_blocks += count - 1;
+		mem_block = dbCache->cache[frames[0]];
 	}
 
-	/// no free cache blocks found, we need to clear some now
-	free_pos = AK_release_oldest_cache_block();
+	AK_free(blocks);
+	AK_free(frames);
+	return mem_block;
+}
 
-	if(free_pos == EXIT_ERROR)
-	{
-		/// no cache for you
-		AK_EPI;
-		exit(EXIT_ERROR);
+/**
+  * @author Tomislav Fotak, updated by Matija Šestak, Antonio Martinović
+  * @brief Function that reads a block from the memory. If the block is cached, returns the cached block. Else uses AK_cache_block to read the block
+		to cache and then returns it.
+  * @param num block number (address)
+  * @return segment start address
+ */
+AK_mem_block *AK_get_block(int num)
+{
+	AK_mem_block *mem_block;
+	AK_PRO;
+	mem_block = AK_get_block_scan(num, NULL);
+	AK_EPI;
+	return mem_block;
+}
+
+/**
+  * @brief Function that reads a block of a sequential scan from the memory. A miss reads the following blocks
+  * of the scan ahead as well, by the read-ahead state of the scan.
+  * @param num block number (address)
+  * @param scan read-ahead state of the scan, NULL for a point read
+  * @return cached block
+ */
+AK_mem_block *AK_get_block_scan(int num, AK_cache_scan *scan)
+{
+	int free_pos = 0;
+	int first_AK_free_mem_block = -1;
+	int readahead;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	AK_mem_block *mem_block = NULL;
+	pthread_mutex_lock(&AK_cache_mutex);
+	/* look the block up in the buffer pool hash table */
+	free_pos = AK_cache_lookup(num);
+	if (free_pos != -1)
+	{
+		/// found cached! we're done here
+		dbCache->hits[dbCache->policy]++;
+		AK_cache_policy_hit(free_pos);
+		/// a scan that runs into a block it did not read ahead keeps its read-ahead window
+		if (scan != NULL && num == scan->next)
+			scan->next++;
+		mem_block = dbCache->cache[free_pos];
+		pthread_mutex_unlock(&AK_cache_mutex);
+		AK_EPI;
+		return mem_block;
 	}
 
-	if (AK_cache_block(num, dbCache->cache[ free_pos ]) == EXIT_SUCCESS)
+	dbCache->misses[dbCache->policy]++;
+
+	/// sequential scan: read the following blocks together with this one
+	readahead = AK_cache_readahead_window(num, scan);
+	if (readahead > 1 && (mem_block = AK_cache_read_ahead(num, readahead)) != NULL)
 	{
+		pthread_mutex_unlock(&AK_cache_mutex);
 		AK_EPI;
-		return dbCache->cache[ free_pos ];
+		return mem_block;
 	}
 
+	/// take a frame that has never held a block, if there is one left
+	if (dbCache->free_count > 0)
+	{
+		first_AK_free_mem_block = dbCache->free_frames[ --dbCache->free_count ];
+		if (AK_cache_block(num, dbCache->cache[ first_AK_free_mem_block ]) == EXIT_SUCCESS)
+		{
+			/// created new cache block for specified address
+			mem_block = dbCache->cache[first_AK_free_mem_block];
+			pthread_mutex_unlock(&AK_cache_mutex);
+			AK_EPI;
+
+			return mem_block;
+		}
+		dbCache->free_frames[ dbCache->free_count++ ] = first_AK_free_mem_block;
+	}
+
+	/// no free cache blocks found, we need to clear some now
+	free_pos = AK_release_oldest_cache_block();
+
+	if(free_pos == EXIT_ERROR)
+	{
+		/// no cache for you
+		AK_EPI;
+		exit(EXIT_ERROR);
+	}
+
+	if (AK_cache_block(num, dbCache->cache[ free_pos ]) == EXIT_SUCCESS)
+		mem_block = dbCache->cache[ free_pos ];
 
+	pthread_mutex_unlock(&AK_cache_mutex);
+	AK_EPI;
+	return mem_block;
+}
+
+/**
+  * @brief Function that reads a block like AK_get_block_scan and pins its frame, so that the block stays in the
+  * frame until AK_unpin_block is called even if other threads read blocks in the meantime
+  * @param num block number (address)
+  * @param scan read-ahead state of the scan, NULL for a point read
+  * @return pinned cached block
+ */
+AK_mem_block *AK_get_block_pinned(int num, AK_cache_scan *scan)
+{
+	AK_mem_block *mem_block;
+	AK_PRO;
+	/// the latch is held until the frame is pinned, so no other thread can evict the block in between
+	pthread_mutex_lock(&AK_cache_mutex);
+	mem_block = AK_get_block_scan(num, scan);
+	if (mem_block != NULL)
+		mem_block->pin++;
+	pthread_mutex_unlock(&AK_cache_mutex);
+	AK_EPI;
+	return mem_block;
+}
+
+/**
+  * @brief Function that releases a frame pinned by AK_get_block_pinned
+  * @param mem_block pinned cached block
+ */
+void AK_unpin_block(AK_mem_block *mem_block)
+{
+	AK_PRO;
+	pthread_mutex_lock(&AK_cache_mutex);
+	mem_block->pin--;
+	pthread_mutex_unlock(&AK_cache_mutex);
 	AK_EPI;
-	return NULL;
 }
 
 /**
@@ -430,36 +1130,35 @@ AK_mem_block *AK_get_block(int num)
  * @return index of flushed cache block
  */
 int AK_release_oldest_cache_block() {
-	int i;
-	int min = 0;
 	int block_written;
 	AK_db_cache* const dbCache = db_cache.ptr;
-	int oldest_block = dbCache->next_replace;
+	int oldest_block;
 	AK_block *data_block;
 
 	AK_PRO;
 
-	if (oldest_block == -1) {
-		for (i = 0; i < MAX_CACHE_MEMORY; i++)
-		{
-
-			if (dbCache->cache[i]->timestamp_read != -1 &&
-				dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read)
-			{
-				min = i;
-			}
-		}
-		oldest_block = min;
+	pthread_mutex_lock(&AK_cache_mutex);
+	oldest_block = AK_cache_select_victim(1);
+	if (oldest_block == -1)
+	{
+		/// nothing is cached yet, hand out a frame that holds no block
+		oldest_block = dbCache->free_count > 0 ? dbCache->free_frames[ --dbCache->free_count ] : EXIT_ERROR;
+		pthread_mutex_unlock(&AK_cache_mutex);
+		AK_EPI;
+		return oldest_block;
 	}
 
-
 	if (dbCache->cache[oldest_block]->dirty == BLOCK_DIRTY)
 	{
 		data_block = dbCache->cache[oldest_block]->block;
+		/// a copy of the block the dirty block writer is writing must not land on disk after this one
+		pthread_mutex_lock(&AK_cache_io_mutex);
 		block_written = AK_write_block(data_block);
+		pthread_mutex_unlock(&AK_cache_io_mutex);
 		/// if block form cache can not be writed to DB file -> EXIT_ERROR
 		if (block_written != EXIT_SUCCESS)
 		{
+			pthread_mutex_unlock(&AK_cache_mutex);
 			AK_EPI;
 			return EXIT_ERROR;
 		}
@@ -469,16 +1168,22 @@ int AK_release_oldest_cache_block() {
 
 	dbCache->cache[oldest_block]->timestamp_read = clock();
 
-	min = 0;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	/// the frame is about to receive a new block, so it starts over as a first reference
+	switch (dbCache->policy)
 	{
-		if (dbCache->cache[i]->timestamp_read != -1 &&
-			dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read)
-		{
-			min = i;
-		}
+		case CACHE_POLICY_CLOCK:
+			dbCache->cache[oldest_block]->reference = 1;
+			break;
+		case CACHE_POLICY_2Q:
+			if (dbCache->cache[oldest_block]->queue == CACHE_QUEUE_A1IN)
+				AK_cache_ghost_add(dbCache->cache[oldest_block]->block->address);
+			/* fall through */
+		default:
+			AK_cache_queue_append(oldest_block, CACHE_QUEUE_A1IN);
+			break;
 	}
-	dbCache->next_replace = min;
+	dbCache->next_replace = AK_cache_select_victim(0);
+	pthread_mutex_unlock(&AK_cache_mutex);
 
 	AK_EPI;
 
@@ -493,10 +1198,18 @@ int AK_mem_block_modify(AK_mem_block* mem_block, int dirty)
 {
 	unsigned long timestamp;
 	AK_PRO;
+	pthread_mutex_lock(&AK_cache_mutex);
 	mem_block->dirty = dirty;
+	if (dirty == BLOCK_DIRTY)
+	{
+		mem_block->version++;
+		AK_free_space_map_update(mem_block->block);
+		AK_block_changed(mem_block->block->address);
+	}
 
 	timestamp = clock();
 	mem_block->timestamp_last_change = timestamp;
+	pthread_mutex_unlock(&AK_cache_mutex);
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -509,18 +1222,17 @@ int AK_mem_block_modify(AK_mem_block* mem_block, int dirty)
 int AK_refresh_cache()
 {
 	int i;
-	AK_block *new_block;
-	AK_block *old_block;
 
 	AK_PRO;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	AK_db_cache* const dbCache = db_cache.ptr;
+	pthread_mutex_lock(&AK_cache_mutex);
+	for (i = 0; i < dbCache->pool_size; i++)
 	{
-		AK_db_cache* const dbCache = db_cache.ptr;
-		new_block = AK_read_block(dbCache->cache[i]->block->address);
-		old_block = dbCache->cache[i]->block;
-		dbCache->cache[i]->block = new_block;
-		AK_free(old_block);
+		if (dbCache->cache[i]->block->address == -1)
+			continue;
+		AK_read_block_into(dbCache->cache[i]->block->address, dbCache->cache[i]->block);
 	}
+	pthread_mutex_unlock(&AK_cache_mutex);
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -571,18 +1283,33 @@ table_addresses *AK_get_segment_addresses(char * segmentName)
 * @return structure table_addresses witch contains start and end adresses of table extents, when form and to are 0 you are on the end of addresses
 */
 table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmentName)
+{
+	table_addresses *addresses;
+	AK_PRO;
+
+	addresses = (table_addresses *) AK_malloc(sizeof (table_addresses));
+	AK_lookup_segment_addresses(tableName, segmentName, addresses);
+	AK_EPI;
+	return addresses;
+}
+
+/**
+ * @brief Function that reads the extents of a segment from the first block of a system table
+ * @param tableName system table (AK_relation or AK_index)
+ * @param segmentName segment name
+ * @param addresses extents found, terminated by a 0 address
+ * @return number of extents found
+ */
+static int AK_scan_segment_addresses(char *tableName, char *segmentName, table_addresses *addresses)
 {
 	int i = 0;
 	int AK_freeVar = 0;
 	int address_sys;
 	AK_mem_block *mem_block;
 
-	AK_PRO;
-
 	AK_dbg_messg(HIGH, MEMO_MAN,"get_segment_addresses: Serching for %s table \n", tableName);
 	address_sys = AK_get_system_table_address(tableName);
 	mem_block = AK_get_block(address_sys);
-	table_addresses * addresses = (table_addresses *) AK_malloc(sizeof (table_addresses));
 
 	for (AK_freeVar = 0; AK_freeVar < MAX_EXTENTS_IN_SEGMENT; AK_freeVar++)
 	{
@@ -593,19 +1320,22 @@ table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmen
 	int address_from;
 	int address_to;
 	int j = 0;
-	for (i = 0; i < DATA_BLOCK_SIZE; i++)
+	int num_attr = 0;
+	/// rows are (obj_id, name, start, end, ...): AK_index rows carry table_id and attribute_id as well
+	while (num_attr < MAX_ATTRIBUTES && strcmp(mem_block->block->header[num_attr].att_name, "") != 0)
+		num_attr++;
+	if (num_attr < 4)
+		num_attr = 4;
+	for (i = 0; i + 3 < DATA_BLOCK_SIZE; i += num_attr)
 	{
 		if (mem_block->block->tuple_dict[i].type == FREE_INT)
 			break;
 		if ( (mem_block->block->last_tuple_dict_id) <= i )
 			break;
-		i++;
-		memcpy(name, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
-		name[ mem_block->block->tuple_dict[i].size] = '\0';
-		i++;
-		memcpy(&address_from, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
-		i++;
-		memcpy(&address_to, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
+		memcpy(name, &(mem_block->block->data[mem_block->block->tuple_dict[i + 1].address]), mem_block->block->tuple_dict[i + 1].size);
+		name[ mem_block->block->tuple_dict[i + 1].size] = '\0';
+		memcpy(&address_from, &(mem_block->block->data[mem_block->block->tuple_dict[i + 2].address]), sizeof (int));
+		memcpy(&address_to, &(mem_block->block->data[mem_block->block->tuple_dict[i + 3].address]), sizeof (int));
 		//if found the table that addresses we need
 		if (strcmp(name, segmentName) == 0)
 		{
@@ -616,8 +1346,154 @@ table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmen
 		}
 
 	}
+	return j;
+}
+
+/**
+ * @brief Function that maps a system table and segment name to a bucket of the segment directory (djb2)
+ * @param tableName system table
+ * @param segmentName segment name
+ * @return bucket index
+ */
+static unsigned int AK_segment_directory_hash(const char *tableName, const char *segmentName)
+{
+	unsigned long hash = 5381;
+	int c;
+
+	while ((c = *tableName++))
+		hash = ((hash << 5) + hash) + c;
+	while ((c = *segmentName++))
+		hash = ((hash << 5) + hash) + c;
+	return hash % AK_SEGMENT_DIRECTORY_SIZE;
+}
+
+/**
+ * @brief Function that returns the segment directory entry of a segment, reading the system table if the entry
+ * is missing or invalid. A segment that does not exist gets no entry, an invalid entry of it is removed, so that
+ * looking up names that are not there does not fill the directory. The caller holds AK_segment_directory_mutex.
+ * @param tableName system table (AK_relation or AK_index)
+ * @param segmentName segment name
+ * @return directory entry, an empty one that is not in the directory if the segment does not exist
+ */
+static AK_segment_directory_entry *AK_segment_directory_get(char *tableName, char *segmentName)
+{
+	static AK_segment_directory_entry missing;
+	unsigned int bucket;
+	AK_segment_directory_entry **link, *entry;
+	table_addresses addresses;
+
+	bucket = AK_segment_directory_hash(tableName, segmentName);
+	for (link = &AK_segment_directory[bucket]; (entry = *link) != NULL; link = &entry->next)
+		if (strcmp(entry->name, segmentName) == 0 && strcmp(entry->system_table, tableName) == 0)
+			break;
+	if (entry != NULL && entry->valid)
+		return entry;
+
+	if (AK_scan_segment_addresses(tableName, segmentName, &addresses) == 0)
+	{
+		if (entry != NULL)
+		{
+			*link = entry->next;
+			AK_free(entry);
+		}
+		memset(&missing, 0, sizeof (AK_segment_directory_entry));
+		return &missing;
+	}
+	if (entry == NULL)
+	{
+		entry = (AK_segment_directory_entry *) AK_calloc(1, sizeof (AK_segment_directory_entry));
+		strncpy(entry->system_table, tableName, MAX_ATT_NAME - 1);
+		strncpy(entry->name, segmentName, MAX_VARCHAR_LENGTH - 1);
+		entry->next = AK_segment_directory[bucket];
+		AK_segment_directory[bucket] = entry;
+	}
+	memcpy(&entry->addresses, &addresses, sizeof (table_addresses));
+	entry->valid = 1;
+	return entry;
+}
+
+/**
+ * @brief Function that copies the extents of a segment from the in-memory segment directory. The system
+ * table is read only when the segment is not in the directory or its entry has been invalidated.
+ * @param tableName system table (AK_relation or AK_index)
+ * @param segmentName segment name
+ * @param addresses extents of the segment, all zero if the segment does not exist
+ * @return address of the first block of the segment, 0 if the segment does not exist
+ */
+int AK_lookup_segment_addresses(char *tableName, char *segmentName, table_addresses *addresses)
+{
+	AK_PRO;
+	pthread_mutex_lock(&AK_segment_directory_mutex);
+	memcpy(addresses, &AK_segment_directory_get(tableName, segmentName)->addresses, sizeof (table_addresses));
+	pthread_mutex_unlock(&AK_segment_directory_mutex);
+	AK_EPI;
+	return addresses->address_from[0];
+}
+
+/**
+ * @brief Function that copies the extents of a table from the in-memory segment directory
+ * @param table table name
+ * @param addresses extents of the table, all zero if the table does not exist
+ * @return address of the first block of the table, 0 if the table does not exist
+ */
+int AK_lookup_table_addresses(char *table, table_addresses *addresses)
+{
+	int address;
+	AK_PRO;
+	address = AK_lookup_segment_addresses("AK_relation", table, addresses);
+	AK_EPI;
+	return address;
+}
+
+/**
+ * @brief Function that invalidates the segment directory entries of a segment
+ * @param segmentName segment name, NULL invalidates the whole directory
+ */
+void AK_invalidate_segment_addresses(const char *segmentName)
+{
+	int i;
+	AK_segment_directory_entry *entry;
+	AK_PRO;
+
+	pthread_mutex_lock(&AK_segment_directory_mutex);
+	for (i = 0; i < AK_SEGMENT_DIRECTORY_SIZE; i++)
+		for (entry = AK_segment_directory[i]; entry != NULL; entry = entry->next)
+			if (segmentName == NULL || strcmp(entry->name, segmentName) == 0)
+			{
+				entry->valid = 0;
+				entry->free_hint = 0;
+			}
+	pthread_mutex_unlock(&AK_segment_directory_mutex);
+	AK_EPI;
+}
+
+/**
+ * @brief Function that removes the segment directory entries of a deleted segment and frees them
+ * @param segmentName segment name
+ */
+void AK_forget_segment_addresses(const char *segmentName)
+{
+	int i;
+	AK_segment_directory_entry **link, *entry;
+	AK_PRO;
+
+	pthread_mutex_lock(&AK_segment_directory_mutex);
+	for (i = 0; i < AK_SEGMENT_DIRECTORY_SIZE; i++)
+	{
+		link = &AK_segment_directory[i];
+		while ((entry = *link) != NULL)
+		{
+			if (strcmp(entry->name, segmentName) == 0)
+			{
+				*link = entry->next;
+				AK_free(entry);
+			}
+			else
+				link = &entry->next;
+		}
+	}
+	pthread_mutex_unlock(&AK_segment_directory_mutex);
 	AK_EPI;
-	return addresses;
 }
 
 /**
@@ -695,76 +1571,178 @@ table_addresses *AK_get_index_addresses(char * index)
 }
 
 /**
-  * @author Matija Novak, updated by Matija Šestak( function now uses caching)
-  * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row()
-  * @param address addresses of extents
-  * @return address of the block to write in
+ * @brief Function that tells whether a row can still be inserted into a block
+ * @param block block
+ * @return AK_FREE_SPACE_ROOM or AK_FREE_SPACE_FULL
  */
-int AK_find_AK_free_space(table_addresses * addresses)
+static int AK_free_space_classify(AK_block *block)
 {
-	AK_mem_block *mem_block;
-	int from = 0, to = 0, j = 0, i = 0;
-	AK_PRO;
-	AK_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: Searching for block that has AK_free space < 500 \n");
-	for (j = 0; j < MAX_EXTENTS_IN_SEGMENT; j++)
-	{
-		if (addresses->address_from != 0)
-		{
-			from = addresses->address_from[j];
-			to = addresses->address_to[j];
+	if (block->AK_free_space < MAX_FREE_SPACE_SIZE && block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE)
+		return AK_FREE_SPACE_ROOM;
+	return AK_FREE_SPACE_FULL;
+}
 
-			//searching block
-			for (i = from; i <= to; i++)
-			{
-				mem_block = AK_get_block(i);
-				int AK_free_space_on = mem_block->block->AK_free_space;
+/**
+ * @brief Function that records in the free-space map whether a row can still be inserted into a block
+ * @param block block that has just been changed
+ */
+void AK_free_space_map_update(AK_block *block)
+{
+	AK_PRO;
+	if (block->address >= 0 && block->address < DB_FILE_BLOCKS_NUM_EX)
+		AK_free_space_map[block->address] = AK_free_space_classify(block);
+	AK_EPI;
+}
 
-				AK_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: FREE SPACE %d\n", mem_block->block->AK_free_space);
+/**
+ * @brief Function that forgets what the free-space map knows about a block, used when the block is (re)allocated
+ * @param address block address
+ */
+void AK_free_space_map_forget(int address)
+{
+	AK_PRO;
+	if (address >= 0 && address < DB_FILE_BLOCKS_NUM_EX)
+		AK_free_space_map[address] = AK_FREE_SPACE_UNKNOWN;
+	AK_EPI;
+}
 
-				if ((AK_free_space_on < MAX_FREE_SPACE_SIZE) &&
-					(mem_block->block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE))  //found AK_free block to write
-				{
-					AK_EPI;
-					return i;
-				}
-			}
-		}
-		else 
-		{
-			AK_EPI;
-			return EXIT_ERROR;
-		}
+/**
+ * @brief Function that records that the content of a block has changed, so that structures derived from it (e.g. the
+ * row locators of file/table.c) know they have to look at the block again
+ * @param address block address
+ */
+void AK_block_changed(int address)
+{
+	AK_PRO;
+	if (address >= 0 && address < DB_FILE_BLOCKS_NUM_EX)
+	{
+		pthread_mutex_lock(&AK_block_clock_mutex);
+		AK_block_changed_at[address] = ++AK_block_clock;
+		pthread_mutex_unlock(&AK_block_clock_mutex);
 	}
+	AK_EPI;
+}
 
-	//I cant call function from memoman must consider another solution to place these functions
-	int adr = -1;
-
-	//need to create new extent
-	printf("\nAK_find_AK_free_space: Creating new extent\n");
+/**
+ * @brief Function that returns the change generation of a block
+ * @param address block address
+ * @return value of AK_blocks_generation at the last change of the block, 0 if it has not changed since startup
+ */
+unsigned long AK_block_generation(int address)
+{
+	if (address < 0 || address >= DB_FILE_BLOCKS_NUM_EX)
+		return 0;
+	return AK_block_changed_at[address];
+}
 
-	int old_size = 0;
-	int new_size = 0;
+/**
+ * @brief Function that returns the number of block changes since startup; nothing has changed as long as it stays the same
+ * @return change generation of the last changed block
+ */
+unsigned long AK_blocks_generation()
+{
+	return AK_block_clock;
+}
 
-	for (i = 0; i < MAX_EXTENTS_IN_SEGMENT; i++)
+/**
+ * @brief Function that returns the free-space map state of a block, reading the block only if it is unknown
+ * @param address block address
+ * @return AK_FREE_SPACE_ROOM or AK_FREE_SPACE_FULL
+ */
+int AK_free_space_map_state(int address)
+{
+	AK_PRO;
+	if (address < 0 || address >= DB_FILE_BLOCKS_NUM_EX)
 	{
-		if (addresses->address_from[i] == 0)
-			break;
-		new_size = addresses->address_to[i] - addresses->address_from[i];
-		if (new_size > old_size) //find largest extent
-			old_size = new_size;
+		AK_EPI;
+		return AK_FREE_SPACE_FULL;
 	}
+	if (AK_free_space_map[address] == AK_FREE_SPACE_UNKNOWN)
+		AK_free_space_map_update(AK_get_block(address)->block);
+	AK_EPI;
+	return AK_free_space_map[address];
+}
 
-	old_size++;
-
-	if ( (adr = AK_new_extent(1, old_size, SEGMENT_TYPE_TABLE , mem_block->block->header) ) == EXIT_ERROR)
+/**
+ * @brief Function that searches the extents of a segment for a block with room, starting at a given block
+ * @param addresses extents of the segment
+ * @param hint block to start at, 0 to start at the first block of the segment
+ * @return address of the block to write in, EXIT_ERROR if no block has room, 0 if there are no extents
+ */
+static int AK_free_space_search(table_addresses *addresses, int hint)
+{
+	int j, i;
+	int hint_extent = -1;
+
+	if (addresses->address_from[0] == 0)
+		return 0;
+	for (j = 0; hint > 0 && j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++)
+		if (hint >= addresses->address_from[j] && hint <= addresses->address_to[j])
+			hint_extent = j;
+	if (hint_extent == -1)
 	{
-		printf("AK_find_AK_free_space: Could not allocate the new extent\n");
-		AK_EPI;
-		return EXIT_ERROR;
+		hint_extent = 0;
+		hint = addresses->address_from[0];
 	}
 
+	/// from the hint to the end of the segment, then from the start of the segment up to the hint
+	for (j = hint_extent; j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++)
+		for (i = (j == hint_extent) ? hint : addresses->address_from[j]; i <= addresses->address_to[j]; i++)
+			if (AK_free_space_map_state(i) == AK_FREE_SPACE_ROOM)
+				return i;
+	for (j = 0; j <= hint_extent && j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++)
+		for (i = addresses->address_from[j]; i <= addresses->address_to[j] && !(j == hint_extent && i >= hint); i++)
+			if (AK_free_space_map_state(i) == AK_FREE_SPACE_ROOM)
+				return i;
+	return EXIT_ERROR;
+}
+
+/**
+  * @author Matija Novak, updated by Matija Šestak( function now uses caching)
+  * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row().
+  * Blocks are checked in the free-space map, a block is read only the first time it is looked at.
+  * @param address addresses of extents
+  * @return address of the block to write in, EXIT_ERROR if no block of the extents has room, 0 if there are no extents
+ */
+int AK_find_AK_free_space(table_addresses * addresses)
+{
+	int address;
+	AK_PRO;
+	AK_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: Searching for block that has AK_free space < 500 \n");
+	address = AK_free_space_search(addresses, 0);
 	AK_EPI;
-	return adr;
+	return address;
+}
+
+/**
+ * @brief Function that finds a block with room for a new row in a segment. The search starts at the block the
+ * previous search for the segment ended on and reads only the free-space map.
+ * @param tableName system table (AK_relation or AK_index)
+ * @param segmentName segment name
+ * @return address of the block to write in, EXIT_ERROR if the segment has to be extended, 0 if it does not exist
+ */
+int AK_find_segment_free_space(char *tableName, char *segmentName)
+{
+	table_addresses addresses;
+	int address, hint;
+	AK_PRO;
+
+	/// the search may read blocks, so it runs on a copy of the entry without the directory latch
+	pthread_mutex_lock(&AK_segment_directory_mutex);
+	AK_segment_directory_entry *entry = AK_segment_directory_get(tableName, segmentName);
+	memcpy(&addresses, &entry->addresses, sizeof (table_addresses));
+	hint = entry->free_hint;
+	pthread_mutex_unlock(&AK_segment_directory_mutex);
+
+	address = AK_free_space_search(&addresses, hint);
+
+	pthread_mutex_lock(&AK_segment_directory_mutex);
+	entry = AK_segment_directory_get(tableName, segmentName);
+	if (entry->valid && memcmp(&addresses, &entry->addresses, sizeof (table_addresses)) == 0)
+		entry->free_hint = address > 0 ? address : 0;
+	pthread_mutex_unlock(&AK_segment_directory_mutex);
+	AK_EPI;
+	return address;
 }
 
 /**
@@ -857,43 +1835,224 @@ int AK_init_new_extent(char *table_name, int extent_type)
 	AK_Insert_New_Element(TYPE_INT, &start_address, sys_table, "start_address", row_root);
 	AK_Insert_New_Element(TYPE_INT, &end_address, sys_table, "end_address", row_root);
 	AK_insert_row(row_root);
+	AK_invalidate_segment_addresses(table_name);
 	AK_EPI;
 	return start_address;
 }
 
+/**
+ * @brief Function that orders dirty frames by block address (qsort comparator)
+ */
+static int AK_dirty_frame_compare(const void *a, const void *b)
+{
+	return ((const AK_dirty_frame *)a)->address - ((const AK_dirty_frame *)b)->address;
+}
+
+/**
+ * @brief Function that writes dirty frames to disk in block address order. Runs of frames with consecutive
+ * addresses are copied out of the buffer pool under the latch and written with a single vectored write
+ * without it, so readers do not wait for the disk. A frame is marked clean only if it was not dirtied
+ * again or given another block while its copy was being written.
+ * @param max_blocks maximum number of blocks to write, 0 for all of them
+ * @return number of blocks written
+ */
+static int AK_cache_write_dirty(int max_blocks)
+{
+	int i, k, next, count = 0, run = 0, written = 0;
+	AK_dirty_frame *dirty;
+	AK_block *copies;
+	AK_block *blocks[AK_CACHE_WRITE_RUN];
+	AK_dirty_frame runs[AK_CACHE_WRITE_RUN];
+	AK_mem_block *mem_block;
+	AK_PRO;
+	AK_db_cache* const dbCache = db_cache.ptr;
+	dirty = (AK_dirty_frame *) AK_malloc(dbCache->pool_size * sizeof(AK_dirty_frame));
+	copies = (AK_block *) AK_malloc(AK_CACHE_WRITE_RUN * sizeof(AK_block));
+
+	pthread_mutex_lock(&AK_cache_mutex);
+	for (i = 0; i < dbCache->pool_size; i++)
+	{
+		if (dbCache->cache[i]->dirty == BLOCK_DIRTY && dbCache->cache[i]->block->address != -1)
+		{
+			dirty[count].address = dbCache->cache[i]->block->address;
+			dirty[count].frame = i;
+			count++;
+		}
+	}
+	pthread_mutex_unlock(&AK_cache_mutex);
+	qsort(dirty, count, sizeof(AK_dirty_frame), AK_dirty_frame_compare);
+
+	for (i = 0; i < count; i = next)
+	{
+		/// copy a run of frames that hold consecutive addresses and are still dirty;
+		/// a frame could have been evicted or written while the latch was free
+		run = 0;
+		next = i;
+		pthread_mutex_lock(&AK_cache_mutex);
+		while (next < count && run < AK_CACHE_WRITE_RUN && (max_blocks == 0 || written + run < max_blocks))
+		{
+			mem_block = dbCache->cache[dirty[next].frame];
+			if (mem_block->dirty != BLOCK_DIRTY || mem_block->block->address != dirty[next].address)
+			{
+				if (run > 0)
+					break;
+				next++;
+				continue;
+			}
+			if (run > 0 && dirty[next].address != runs[run - 1].address + 1)
+				break;
+			memcpy(&copies[run], mem_block->block, sizeof(AK_block));
+			blocks[run] = &copies[run];
+			runs[run] = dirty[next];
+			runs[run].version = mem_block->version;
+			run++;
+			next++;
+		}
+		if (run == 0)
+		{
+			pthread_mutex_unlock(&AK_cache_mutex);
+			break;
+		}
+		/// an eviction of one of these blocks now waits until the copies are on disk
+		pthread_mutex_lock(&AK_cache_io_mutex);
+		pthread_mutex_unlock(&AK_cache_mutex);
+
+		AK_write_blocks(blocks, run);
+		pthread_mutex_unlock(&AK_cache_io_mutex);
+
+		pthread_mutex_lock(&AK_cache_mutex);
+		for (k = 0; k < run; k++)
+		{
+			mem_block = dbCache->cache[runs[k].frame];
+			if (mem_block->version == runs[k].version && mem_block->block->address == runs[k].address)
+				mem_block->dirty = BLOCK_CLEAN;
+		}
+		pthread_mutex_unlock(&AK_cache_mutex);
+		written += run;
+	}
+
+	AK_free(copies);
+	AK_free(dirty);
+	AK_EPI;
+	return written;
+}
 /**
  * @author Matija Šestak, updated by Antonio Martinović
- * @brief Function that flushes memory blocks to disk file
+ * @brief Function that flushes memory blocks to disk file, in block address order
  * @return EXIT_SUCCESS
  */
 int AK_flush_cache()
 {
-	int i = 0;
-	int block_written;
-	AK_block *data_block;
 	AK_PRO;
-	while (i < MAX_CACHE_MEMORY)
+	/// AK_write_blocks exits if a block can not be written to the DB file
+	AK_cache_write_dirty(0);
+	AK_EPI;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that makes a checkpoint: every dirty block in the buffer pool is written in one pass
+ * ordered by block address, and the DB file is synced once at the end
+ * @return EXIT_SUCCESS if the checkpoint has been made, EXIT_ERROR otherwise
+ */
+int AK_checkpoint()
+{
+	int written;
+	AK_PRO;
+	/// blocks dirtied after their copy has been taken belong to the next checkpoint
+	written = AK_cache_write_dirty(0);
+	if (AK_db_fsync() != EXIT_SUCCESS)
 	{
-		AK_db_cache* const dbCache = db_cache.ptr;
-		if (dbCache->cache[i]->dirty == BLOCK_DIRTY)
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	AK_dbg_messg(LOW, MEMO_MAN, "AK_checkpoint: %d blocks written\n", written);
+	AK_EPI;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Main function of the background writer thread. Every cache:writer_interval milliseconds it writes
+ * up to cache:writer_batch dirty blocks, so that evictions seldom have to write a block on their own. Both settings
+ * are read every round, so AK_reload_config changes them for a running writer; an interval of 0 pauses it.
+ * @param arg unused
+ */
+static void *AK_cache_writer_main(void *arg)
+{
+	struct timespec deadline;
+	int interval, batch;
+	AK_PRO;
+	pthread_mutex_lock(&AK_cache_writer_mutex);
+	while (AK_cache_writer_running)
+	{
+		interval = CACHE_WRITER_INTERVAL > 0 ? CACHE_WRITER_INTERVAL : 1000;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += interval / 1000;
+		deadline.tv_nsec += (long)(interval % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L)
 		{
-			data_block = dbCache->cache[i]->block;
-			block_written = AK_write_block(data_block);
-			/// if block form cache can not be writed to DB file -> EXIT_ERROR
-			if (block_written != EXIT_SUCCESS)
-			{
-				AK_EPI;
-				exit(EXIT_ERROR);
-			}
-			/// block is clean after successfuly writing it to disk
-			dbCache->cache[i]->dirty = BLOCK_CLEAN;
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
 		}
-		i++;
+		pthread_cond_timedwait(&AK_cache_writer_wakeup, &AK_cache_writer_mutex, &deadline);
+		if (!AK_cache_writer_running)
+			break;
+		if (CACHE_WRITER_INTERVAL <= 0)
+			continue;
+		batch = CACHE_WRITER_BATCH > 0 ? CACHE_WRITER_BATCH : MAX_CACHE_MEMORY;
+		pthread_mutex_unlock(&AK_cache_writer_mutex);
+		AK_cache_write_dirty(batch);
+		pthread_mutex_lock(&AK_cache_writer_mutex);
+	}
+	pthread_mutex_unlock(&AK_cache_writer_mutex);
+	AK_EPI;
+	return NULL;
+}
+
+/**
+ * @brief Function that starts the background writer thread (cache:writer_interval and cache:writer_batch in config.ini)
+ * @return EXIT_SUCCESS if the writer is running or disabled in the configuration, EXIT_ERROR otherwise
+ */
+int AK_cache_writer_start()
+{
+	AK_PRO;
+	if (AK_cache_writer_running || CACHE_WRITER_INTERVAL <= 0)
+	{
+		AK_EPI;
+		return EXIT_SUCCESS;
+	}
+	AK_cache_writer_running = 1;
+	if (pthread_create(&AK_cache_writer, NULL, AK_cache_writer_main, NULL) != 0)
+	{
+		printf("AK_cache_writer_start: ERROR. Cannot start the background writer.\n");
+		AK_cache_writer_running = 0;
+		AK_EPI;
+		return EXIT_ERROR;
 	}
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Function that stops the background writer thread and waits for its last round to finish
+ */
+void AK_cache_writer_stop()
+{
+	AK_PRO;
+	pthread_mutex_lock(&AK_cache_writer_mutex);
+	if (!AK_cache_writer_running)
+	{
+		pthread_mutex_unlock(&AK_cache_writer_mutex);
+		AK_EPI;
+		return;
+	}
+	AK_cache_writer_running = 0;
+	pthread_cond_signal(&AK_cache_writer_wakeup);
+	pthread_mutex_unlock(&AK_cache_writer_mutex);
+	pthread_join(AK_cache_writer, NULL);
+	AK_EPI;
+}
+
 TestResult AK_memoman_test()
 {
 	int success=0;
@@ -902,9 +2061,14 @@ TestResult AK_memoman_test()
 	int released_block;
 	int min = 0;
 	int ok = 0;
+	int policy, saved_policy, queued, hot, hot_address, evicted;
+	unsigned long hits;
+	AK_block *disk_block;
+	AK_cache_scan scan;
+	int last_block;
 	AK_PRO;
 	AK_db_cache* const dbCache = db_cache.ptr;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
+	for (i = 0; i < dbCache->pool_size; i++) {
 		printf("Block: %d \t l_address: %d \t c_address: %x\t last_read: %i\t last_change %i\t\n", i,
 			   dbCache->cache[i]->block->address, &dbCache->cache[i]->block, &dbCache->cache[i]->timestamp_read,
 			   dbCache->cache[i]->timestamp_last_change);
@@ -919,17 +2083,23 @@ TestResult AK_memoman_test()
 		
 	}
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
-//        printf("\nINDEX: %i oldest is %i, current is %i, comparison %s\n",i, dbCache->cache[ min ]->timestamp_read,
-//               dbCache->cache[ i ]->timestamp_read,
-//               dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read ? "true" : "false");
-
-		if (dbCache->cache[i]->timestamp_read != -1 &&
-			dbCache->cache[i]->timestamp_read < dbCache->cache[ min ]->timestamp_read)
+	/// block the replacement policy is going to evict next
+	min = AK_cache_next_victim();
+	/// every used frame must be reachable through the buffer pool hash table
+	for (i = 0; i < dbCache->pool_size; i++) {
+		if (dbCache->cache[i]->block->address == -1)
+			continue;
+		if (AK_cache_lookup(dbCache->cache[i]->block->address) != i)
+		{
+			printf("\nTEST FAILED! block with address %i cached at position %i is not found by AK_cache_lookup\n",
+				   dbCache->cache[i]->block->address, i);
+			failed++;
+		}else
 		{
-			min = i;
+			success++;
 		}
 	}
+
 	AK_blocktable* const allocationBit = ((AK_blocktable*)AK_allocationbit.ptr);
 	if(allocationBit->last_allocated == dbCache->next_replace)
 	{
@@ -968,12 +2138,12 @@ TestResult AK_memoman_test()
 	// randomly setting 5 blocks to dirty state to ensure AK_flush_cache() has something to do
 	for(i = 0; i < 5; i++)
 	{
-		AK_mem_block_modify(dbCache->cache[rand()%MAX_CACHE_MEMORY], BLOCK_DIRTY);
+		AK_mem_block_modify(dbCache->cache[rand()%dbCache->pool_size], BLOCK_DIRTY);
 	}
 
 	AK_flush_cache();
 
-	for(i = 0; i < MAX_CACHE_MEMORY; i++) {
+	for(i = 0; i < dbCache->pool_size; i++) {
 		if(dbCache->cache[i]->dirty != BLOCK_CLEAN)
 		{
 			printf("\nTEST FAILED! block %i has not been flushed to disk\n", i);
@@ -986,6 +2156,259 @@ TestResult AK_memoman_test()
 		
 	}
 
+	/// replacement policies: a block that is used again has to outlive a scan under LRU and 2Q,
+	/// and 2Q has to keep a hot block while a scan twice the size of the pool goes through it
+	saved_policy = dbCache->policy;
+	for (policy = 0; policy < CACHE_POLICY_COUNT; policy++)
+	{
+		AK_cache_set_policy(policy);
+		queued = 0;
+		for (i = 0; i < dbCache->pool_size; i++)
+			if (dbCache->cache[i]->block->address != -1)
+				queued++;
+
+		hot = AK_cache_next_victim();
+		if (hot == -1 || queued < 2)
+		{
+			printf("\nTEST FAILED! policy %i has no cached blocks to replace\n", policy);
+			failed++;
+			continue;
+		}
+		hot_address = dbCache->cache[hot]->block->address;
+
+		if (policy == CACHE_POLICY_2Q)
+		{
+			/// evict the block once so that reading it again promotes it to Am
+			for (i = 0; i < queued && AK_release_oldest_cache_block() != hot; i++)
+				;
+			AK_cache_block(hot_address, dbCache->cache[hot]);
+			if (dbCache->cache[hot]->queue != CACHE_QUEUE_AM)
+			{
+				printf("\nTEST FAILED! 2Q: block %i read again after eviction is not in Am\n", hot_address);
+				failed++;
+			}else
+			{
+				success++;
+			}
+		}
+
+		hits = dbCache->hits[policy];
+		if (AK_get_block(hot_address) != dbCache->cache[hot] || dbCache->hits[policy] != hits + 1)
+		{
+			printf("\nTEST FAILED! policy %i: cached block %i is not counted as a hit\n", policy, hot_address);
+			failed++;
+		}else
+		{
+			success++;
+		}
+
+		if (policy != CACHE_POLICY_CLOCK && AK_cache_next_victim() == hot)
+		{
+			printf("\nTEST FAILED! policy %i: block %i is the next victim right after being used\n", policy, hot_address);
+			failed++;
+		}else
+		{
+			success++;
+		}
+
+		/// scan: every release stands for a block that is read once
+		evicted = -1;
+		for (i = 0; i < 2 * queued; i++)
+		{
+			released_block = AK_release_oldest_cache_block();
+			if (released_block == hot && evicted == -1)
+				evicted = i;
+		}
+		if ((policy == CACHE_POLICY_2Q && evicted != -1) ||
+			(policy == CACHE_POLICY_LRU && evicted != queued - 1) ||
+			(policy == CACHE_POLICY_CLOCK && evicted == -1))
+		{
+			printf("\nTEST FAILED! policy %i: block %i evicted after %i of %i scanned blocks\n", policy, hot_address, evicted, 2 * queued);
+			failed++;
+		}else
+		{
+			success++;
+		}
+	}
+	AK_cache_set_policy(saved_policy);
+	AK_cache_print_stats();
+
+	/// checkpoint: dirty blocks are written and match the copy on disk afterwards
+	disk_block = (AK_block *) AK_malloc(sizeof(AK_block));
+	for (i = 0; i < dbCache->pool_size; i += dbCache->pool_size / 5 + 1)
+		if (dbCache->cache[i]->block->address != -1)
+			AK_mem_block_modify(dbCache->cache[i], BLOCK_DIRTY);
+	if (AK_checkpoint() != EXIT_SUCCESS)
+	{
+		printf("\nTEST FAILED! AK_checkpoint failed\n");
+		failed++;
+	}
+	for (i = 0; i < dbCache->pool_size; i += dbCache->pool_size / 5 + 1)
+	{
+		if (dbCache->cache[i]->block->address == -1)
+			continue;
+		AK_read_block_into(dbCache->cache[i]->block->address, disk_block);
+		if (dbCache->cache[i]->dirty != BLOCK_CLEAN || memcmp(disk_block, dbCache->cache[i]->block, sizeof(AK_block)) != 0)
+		{
+			printf("\nTEST FAILED! block %i has not been written by the checkpoint\n", dbCache->cache[i]->block->address);
+			failed++;
+		}else
+		{
+			success++;
+		}
+	}
+
+	/// background writer: a dirty block gets written without anybody flushing the cache
+	if (CACHE_WRITER_INTERVAL > 0)
+	{
+		hot = AK_cache_next_victim();
+		AK_mem_block_modify(dbCache->cache[hot], BLOCK_DIRTY);
+		for (i = 0; i < 50 && dbCache->cache[hot]->dirty == BLOCK_DIRTY; i++)
+			usleep(CACHE_WRITER_INTERVAL * 1000);
+		if (dbCache->cache[hot]->dirty != BLOCK_CLEAN)
+		{
+			printf("\nTEST FAILED! background writer did not write block %i\n", dbCache->cache[hot]->block->address);
+			failed++;
+		}else
+		{
+			success++;
+		}
+	}
+
+	/// read-ahead: a hinted scan over blocks that are not cached needs fewer reads than blocks
+	last_block = ((AK_blocktable *) AK_allocationbit.ptr)->last_initialized - 1;
+	for (hot = 0; hot + 7 <= last_block; hot++)
+	{
+		for (i = 0; i < 8 && AK_cache_lookup(hot + i) == -1; i++)
+			;
+		if (i == 8)
+			break;
+	}
+	if (hot + 7 <= last_block)
+	{
+		hits = dbCache->misses[dbCache->policy];
+		AK_cache_scan_hint(&scan, hot, hot + 7);
+		ok = 1;
+		for (i = hot; i < hot + 8; i++)
+		{
+			AK_read_block_into(i, disk_block);
+			if (AK_get_block_scan(i, &scan)->block->address != i || memcmp(disk_block, AK_get_block(i)->block, sizeof(AK_block)) != 0)
+				ok = 0;
+		}
+		AK_cache_scan_hint(&scan, -1, -1);
+		if (!ok || dbCache->misses[dbCache->policy] - hits >= 8)
+		{
+			printf("\nTEST FAILED! read-ahead scan of blocks %i - %i: %lu misses, blocks %s\n", hot, hot + 7,
+				   dbCache->misses[dbCache->policy] - hits, ok ? "correct" : "wrong");
+			failed++;
+		}else
+		{
+			success++;
+		}
+	}
+	/// a point read does not read ahead on behalf of a scan that ran before it
+	for (hot = last_block - 1; hot > 0 && (AK_cache_lookup(hot) != -1 || AK_cache_lookup(hot + 1) != -1); hot--)
+		;
+	if (hot > 0)
+	{
+		hits = dbCache->readahead_blocks;
+		if (AK_get_block(hot)->block->address != hot || dbCache->readahead_blocks != hits || AK_cache_lookup(hot + 1) != -1)
+		{
+			printf("\nTEST FAILED! point read of block %i read blocks ahead\n", hot);
+			failed++;
+		}else
+		{
+			success++;
+		}
+	}
+	AK_free(disk_block);
+
+	/// segment directory: lookups copy the extents recorded in the system table
+	table_addresses directory_addresses, lookup;
+	table_addresses *directory = &directory_addresses;
+	table_addresses *copy = AK_get_table_addresses("student");
+	if (AK_lookup_table_addresses("student", directory) != directory->address_from[0] || directory->address_from[0] == 0
+		|| memcmp(directory, copy, sizeof(table_addresses)) != 0)
+	{
+		printf("\nTEST FAILED! segment directory entry of table student differs from AK_relation\n");
+		failed++;
+	}else
+	{
+		success++;
+	}
+	/// a segment registered in and removed from AK_relation is seen by the next lookup
+	struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	AK_Init_L3(&row_root);
+	hot = 0;
+	AK_Insert_New_Element(TYPE_INT, &hot, "AK_relation", "obj_id", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "segment_directory_test", "AK_relation", "name", row_root);
+	AK_Insert_New_Element(TYPE_INT, &directory->address_from[0], "AK_relation", "start_address", row_root);
+	AK_Insert_New_Element(TYPE_INT, &directory->address_to[0], "AK_relation", "end_address", row_root);
+	ok = AK_lookup_table_addresses("segment_directory_test", &lookup) == 0;
+	AK_insert_row(row_root);
+	ok = ok && AK_lookup_table_addresses("segment_directory_test", &lookup) == directory->address_from[0];
+	AK_DeleteAll_L3(&row_root);
+	AK_Update_Existing_Element(TYPE_VARCHAR, "segment_directory_test", "AK_relation", "name", row_root);
+	AK_delete_row(row_root);
+	ok = ok && AK_lookup_table_addresses("segment_directory_test", &lookup) == 0;
+	/// neither the removed segment nor a name that never existed is left in the directory
+	AK_lookup_table_addresses("segment_directory_missing", &lookup);
+	for (i = 0; i < AK_SEGMENT_DIRECTORY_SIZE; i++)
+	{
+		AK_segment_directory_entry *entry;
+		for (entry = AK_segment_directory[i]; entry != NULL; entry = entry->next)
+			ok = ok && strcmp(entry->name, "segment_directory_test") != 0 && strcmp(entry->name, "segment_directory_missing") != 0;
+	}
+	AK_DeleteAll_L3(&row_root);
+	AK_free(row_root);
+	if (!ok)
+	{
+		printf("\nTEST FAILED! segment directory did not follow changes of AK_relation\n");
+		failed++;
+	}else
+	{
+		success++;
+	}
+	AK_free(copy);
+
+	/// free-space map: the block found is the first one with room, repeated searches read no blocks
+	AK_lookup_table_addresses("student", directory);
+	evicted = -1;
+	for (i = directory->address_from[0]; evicted == -1 && i <= directory->address_to[0]; i++)
+		if (AK_get_block(i)->block->AK_free_space < MAX_FREE_SPACE_SIZE
+			&& AK_get_block(i)->block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE)
+			evicted = i;
+	hot = AK_find_segment_free_space("AK_relation", "student");
+	hits = dbCache->hits[dbCache->policy] + dbCache->misses[dbCache->policy];
+	if (hot != evicted || AK_find_segment_free_space("AK_relation", "student") != hot
+		|| dbCache->hits[dbCache->policy] + dbCache->misses[dbCache->policy] != hits)
+	{
+		printf("\nTEST FAILED! free space search of table student returned block %i, expected %i\n", hot, evicted);
+		failed++;
+	}else
+	{
+		success++;
+	}
+	/// a block that fills up is skipped by the next search
+	if (hot > 0)
+	{
+		AK_mem_block *mem_block = AK_get_block(hot);
+		int saved_free_space = mem_block->block->AK_free_space;
+		mem_block->block->AK_free_space = MAX_FREE_SPACE_SIZE;
+		AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+		ok = AK_free_space_map_state(hot) == AK_FREE_SPACE_FULL && AK_find_segment_free_space("AK_relation", "student") != hot;
+		mem_block->block->AK_free_space = saved_free_space;
+		AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+		if (!ok || AK_free_space_map_state(hot) != AK_FREE_SPACE_ROOM)
+		{
+			printf("\nTEST FAILED! free-space map did not follow block %i filling up\n", hot);
+			failed++;
+		}else
+		{
+			success++;
+		}
+	}
+
 	//printf("\nTEST PASSED!\n");
 	AK_EPI;
 	return TEST_result(success,failed);
@@ -1023,7 +2446,7 @@ TestResult AK_memoman_test2()
 		//select a random block from range 0 to last block allocated on disk
 		read_block = rand() % allocationBit->last_allocated;
 		ok = 1;
-		for (i = 0; i < MAX_CACHE_MEMORY; i++) {
+		for (i = 0; i < dbCache->pool_size; i++) {
 			if(dbCache->cache[i]->block->address == read_block) {
 				ok = 0;
 				break;
@@ -1033,7 +2456,7 @@ TestResult AK_memoman_test2()
 		if(ok) break;
 	}
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
+	for (i = 0; i < dbCache->pool_size; i++) {
 		if(dbCache->cache[i]->block->address == read_block) {
 			printf("\nTEST FAILED! block with address %i already cached at position %i\n", read_block, i);
 			failed++;
@@ -1055,6 +2478,15 @@ TestResult AK_memoman_test2()
 	{
 		success++;
 	}
+
+	if(AK_get_block(read_block) != dbCache->cache[flushed_pos]) {
+		printf("\nTEST FAILED! AK_get_block does not return the frame at position %i for block %i\n", flushed_pos, read_block);
+		failed++;
+	}
+	else
+	{
+		success++;
+	}
 	
 
 	char *AK_relation_name = "AK_relation";
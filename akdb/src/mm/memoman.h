@@ -39,6 +39,21 @@ typedef struct {
     unsigned long timestamp_read;
     /// timestamp when the block has lastly been changed
     unsigned long timestamp_last_change;
+    /// index of this frame in the buffer pool (-1 if the block is not a pool frame)
+    int frame;
+    /// reference bit used by the CLOCK replacement policy
+    int reference;
+    /// replacement queue the frame is linked into (CACHE_QUEUE_NONE, CACHE_QUEUE_A1IN or CACHE_QUEUE_AM)
+    int queue;
+    /// previous frame in the replacement queue, -1 at the head
+    int queue_prev;
+    /// next frame in the replacement queue, -1 at the tail
+    int queue_next;
+    /// incremented whenever the frame is dirtied or receives another block; a writer that copied the block
+    /// marks the frame clean only if the version is still the one it copied
+    unsigned long version;
+    /// number of readers copying from the frame (AK_get_block_pinned); a pinned frame is never evicted
+    int pin;
 } AK_mem_block;
 
 /**
@@ -47,12 +62,129 @@ typedef struct {
   * @brief Structure that defines global cache memory
  */
 typedef struct {
-    /// last recently read blocks
-    AK_mem_block * cache[ MAX_CACHE_MEMORY ];
-    /// next cached block to be replaced (0 - MAX_CACHE_MEMORY-1); depends on caching algorithm
+    /// buffer pool frames (pool_size of them)
+    AK_mem_block ** cache;
+    /// number of frames in the buffer pool (cache:pool_size in config.ini)
+    int pool_size;
+    /// next cached block to be replaced (0 - pool_size-1); depends on caching algorithm
     int next_replace;
+    /// block address -> frame hash table; first frame of each bucket chain, -1 if the bucket is empty
+    int * hash_bucket;
+    /// next frame in the same bucket chain, -1 at the end of the chain
+    int * hash_next;
+    /// number of hash buckets (power of two)
+    int hash_size;
+    /// stack of frames that do not hold any block yet
+    int * free_frames;
+    /// number of frames on the free_frames stack
+    int free_count;
+    /// replacement policy in use (CACHE_POLICY_LRU, CACHE_POLICY_CLOCK or CACHE_POLICY_2Q)
+    int policy;
+    /// first (next to evict) frame of each replacement queue, -1 if the queue is empty
+    int queue_head[2];
+    /// last (most recently queued) frame of each replacement queue
+    int queue_tail[2];
+    /// number of frames in each replacement queue
+    int queue_length[2];
+    /// 2Q: number of frames the A1in queue may hold before blocks are evicted from it
+    int a1in_size;
+    /// 2Q: ring of recently evicted block addresses (A1out), -1 for an empty slot
+    int * ghost;
+    /// 2Q: number of slots in the ghost ring
+    int ghost_size;
+    /// 2Q: slot of the ghost ring that is overwritten next
+    int ghost_next;
+    /// 2Q: block address -> ghost slot hash table; first slot of each bucket chain, -1 if the bucket is empty
+    int * ghost_bucket;
+    /// 2Q: next ghost slot in the same bucket chain, -1 at the end of the chain
+    int * ghost_chain;
+    /// 2Q: number of ghost hash buckets (power of two)
+    int ghost_hash_size;
+    /// CLOCK: frame the clock hand points to
+    int clock_hand;
+    /// number of AK_get_block calls served from the pool, per replacement policy
+    unsigned long hits[CACHE_POLICY_COUNT];
+    /// number of AK_get_block calls that had to read the block from disk, per replacement policy
+    unsigned long misses[CACHE_POLICY_COUNT];
+    /// number of blocks read ahead of the scans that requested them
+    unsigned long readahead_blocks;
 } AK_db_cache;
 
+/**
+  * @struct AK_cache_scan
+  * @brief Read-ahead state of one sequential scan. Every scan keeps its own, so point reads and other scans
+  * running at the same time do not read ahead on its behalf.
+ */
+typedef struct {
+    /// first and last block address of the range announced by AK_cache_scan_hint, -1 if there is none
+    int scan_from;
+    int scan_to;
+    /// number of blocks read together with the block requested by the last miss of the scan
+    int window;
+    /// address the scan is expected to miss on next
+    int next;
+} AK_cache_scan;
+
+/**
+  * @struct AK_dirty_frame
+  * @brief Structure that pairs a dirty buffer pool frame with the address of the block it holds, used to write dirty blocks in address order
+ */
+typedef struct {
+    /// address of the block held by the frame
+    int address;
+    /// frame index
+    int frame;
+    /// version of the frame when it was found dirty
+    unsigned long version;
+} AK_dirty_frame;
+
+/**
+ * @def AK_CACHE_WRITE_RUN
+ * @brief Maximum number of consecutive blocks the dirty block writer copies out of the buffer pool and writes at once
+ */
+#define AK_CACHE_WRITE_RUN 16
+
+/**
+ * @def AK_FREE_SPACE_UNKNOWN
+ * @brief Free-space map: the block has not been looked at since it was allocated
+ */
+#define AK_FREE_SPACE_UNKNOWN 0
+/**
+ * @def AK_FREE_SPACE_ROOM
+ * @brief Free-space map: a row can still be inserted into the block
+ */
+#define AK_FREE_SPACE_ROOM 1
+/**
+ * @def AK_FREE_SPACE_FULL
+ * @brief Free-space map: the block is full
+ */
+#define AK_FREE_SPACE_FULL 2
+
+/**
+ * @def AK_SEGMENT_DIRECTORY_SIZE
+ * @brief Number of buckets of the in-memory segment directory
+ */
+#define AK_SEGMENT_DIRECTORY_SIZE 256
+
+/**
+  * @struct AK_segment_directory_entry
+  * @brief Structure that caches the extents of a segment as recorded in a system table
+ */
+typedef struct AK_segment_directory_entry {
+    /// system table the extents are recorded in (AK_relation or AK_index)
+    char system_table[MAX_ATT_NAME];
+    /// segment name
+    char name[MAX_VARCHAR_LENGTH];
+    /// extents of the segment
+    table_addresses addresses;
+    /// 1 if addresses are up to date, 0 if they have to be read from the system table again
+    int valid;
+    /// block of the segment the last free space search ended on, 0 if none
+    int free_hint;
+    /// next entry in the same bucket
+    struct AK_segment_directory_entry *next;
+} AK_segment_directory_entry;
+
 /**
  * Structure that contains all vital information for the command
  * that is about to execute. It is defined by the operation (INSERT,
@@ -233,6 +365,22 @@ void AK_query_mem_AK_free();
 int AK_memoman_init();
 //int AK_memoman_AK_free();
 
+/**
+  * @brief Function that returns the buffer pool frame holding the block with the given address
+  * @param num block number (address)
+  * @return frame index, -1 if the block is not cached
+ */
+int AK_cache_lookup(int num);
+
+/**
+  * @brief Function that announces the range of blocks a sequential scan reads next, so that misses of the scan
+  * in the range read the following blocks of the range ahead with one vectored read
+  * @param scan read-ahead state of the scan
+  * @param address_from first block address of the range (-1 ends the scan and clears its state)
+  * @param address_to last block address of the range
+ */
+void AK_cache_scan_hint(AK_cache_scan *scan, int address_from, int address_to);
+
 /**
   * @author Tomislav Fotak, updated by Matija Šestak, Antonio Martinović
   * @brief Function that reads a block from the memory. If the block is cached, returns the cached block. Else uses AK_cache_block to read the block
@@ -241,12 +389,58 @@ int AK_memoman_init();
   * @return segment start address
  */
 AK_mem_block *AK_get_block(int num);
+
+/**
+  * @brief Function that reads a block of a sequential scan from the memory. A miss reads the following blocks
+  * of the scan ahead as well, by the read-ahead state of the scan.
+  * @param num block number (address)
+  * @param scan read-ahead state of the scan, NULL for a point read
+  * @return cached block
+ */
+AK_mem_block *AK_get_block_scan(int num, AK_cache_scan *scan);
+
+/**
+  * @brief Function that reads a block like AK_get_block_scan and pins its frame, so that the block stays in the
+  * frame until AK_unpin_block is called even if other threads read blocks in the meantime
+  * @param num block number (address)
+  * @param scan read-ahead state of the scan, NULL for a point read
+  * @return pinned cached block
+ */
+AK_mem_block *AK_get_block_pinned(int num, AK_cache_scan *scan);
+
+/**
+  * @brief Function that releases a frame pinned by AK_get_block_pinned
+  * @param mem_block pinned cached block
+ */
+void AK_unpin_block(AK_mem_block *mem_block);
+
+/**
+ * @brief Function that drops the cached copy of a block that is about to be overwritten on disk, e.g. because
+ * it is allocated to a new extent. The frame is given back to the pool as a free frame.
+ * @param address block address
+ */
+void AK_cache_forget_block(int address);
 /**
  * @author Antonio Martinović
- * @brief Functions that flushes the oldest block to disk and recalculates the next block to remove
+ * @brief Functions that flushes the block chosen by the replacement policy to disk and recalculates the next block to remove
  * @return index of flushed cache block
  */
 int AK_release_oldest_cache_block();
+/**
+ * @brief Function that returns the frame the replacement policy would evict next, without evicting it
+ * @return frame index (also stored in next_replace), -1 if no frame holds a block
+ */
+int AK_cache_next_victim();
+/**
+ * @brief Function that switches the buffer pool to another replacement policy
+ * @param policy CACHE_POLICY_LRU, CACHE_POLICY_CLOCK or CACHE_POLICY_2Q
+ * @return EXIT_SUCCESS if the policy has been set, EXIT_ERROR otherwise
+ */
+int AK_cache_set_policy(int policy);
+/**
+ * @brief Function that prints buffer pool hit and miss counters of every replacement policy
+ */
+void AK_cache_print_stats();
 /**
  * @author Alen Novosel.
  * @brief  Function that modifies the "dirty" bit of a block, and update the timestamps accordingly.
@@ -293,14 +487,101 @@ table_addresses *AK_get_table_addresses(char *table);
  */
 table_addresses *AK_get_index_addresses(char * index);
 
+/**
+ * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
+ * @brief Function that gets the address of a system table by name
+ * @param name of system table
+ * @return table address
+ */
+int AK_get_system_table_address(const char *name);
+
+/**
+ * @brief Function that copies the extents of a segment from the in-memory segment directory. The system
+ * table is read only when the segment is not in the directory or its entry has been invalidated.
+ * @param tableName system table (AK_relation or AK_index)
+ * @param segmentName segment name
+ * @param addresses extents of the segment, all zero if the segment does not exist
+ * @return address of the first block of the segment, 0 if the segment does not exist
+ */
+int AK_lookup_segment_addresses(char *tableName, char *segmentName, table_addresses *addresses);
+
+/**
+ * @brief Function that copies the extents of a table from the in-memory segment directory
+ * @param table table name
+ * @param addresses extents of the table, all zero if the table does not exist
+ * @return address of the first block of the table, 0 if the table does not exist
+ */
+int AK_lookup_table_addresses(char *table, table_addresses *addresses);
+
+/**
+ * @brief Function that invalidates the segment directory entries of a segment
+ * @param segmentName segment name, NULL invalidates the whole directory
+ */
+void AK_invalidate_segment_addresses(const char *segmentName);
+
+/**
+ * @brief Function that removes the segment directory entries of a deleted segment and frees them
+ * @param segmentName segment name
+ */
+void AK_forget_segment_addresses(const char *segmentName);
+
+/**
+ * @brief Function that records in the free-space map whether a row can still be inserted into a block
+ * @param block block that has just been changed
+ */
+void AK_free_space_map_update(AK_block *block);
+
+/**
+ * @brief Function that forgets what the free-space map knows about a block, used when the block is (re)allocated
+ * @param address block address
+ */
+void AK_free_space_map_forget(int address);
+
+/**
+ * @brief Function that records that the content of a block has changed, so that structures derived from it (e.g. the
+ * row locators of file/table.c) know they have to look at the block again
+ * @param address block address
+ */
+void AK_block_changed(int address);
+
+/**
+ * @brief Function that returns the change generation of a block
+ * @param address block address
+ * @return value of AK_blocks_generation at the last change of the block, 0 if it has not changed since startup
+ */
+unsigned long AK_block_generation(int address);
+
+/**
+ * @brief Function that returns the number of block changes since startup; nothing has changed as long as it stays the same
+ * @return change generation of the last changed block
+ */
+unsigned long AK_blocks_generation();
+
+/**
+ * @brief Function that returns the free-space map state of a block, reading the block only if it is unknown
+ * @param address block address
+ * @return AK_FREE_SPACE_ROOM or AK_FREE_SPACE_FULL
+ */
+int AK_free_space_map_state(int address);
+
 /**
   * @author Matija Novak, updated by Matija Šestak( function now uses caching)
   * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row()
   * @param address addresses of extents
-  * @return address of the block to write in
+  * @return address of the block to write in, EXIT_ERROR if no block of the extents has room, 0 if there are no extents
  */
 int AK_find_AK_free_space(table_addresses * addresses);
 
+/**
+ * @brief Function that finds a block with room for a new row in a segment. The search starts at the block the
+ * previous search for the segment ended on and reads only the free-space map. The map is kept in memory only and
+ * rebuilt lazily after a restart: a block whose state is unknown is read once, the first time it is searched.
+ * @param tableName system table (AK_relation or AK_index)
+ * @param segmentName segment name
+ * @return address of the block to write in, EXIT_ERROR if the segment has to be extended, 0 if it does not exist
+ */
+int AK_find_segment_free_space(char *tableName, char *segmentName);
+
 /**
  * @author Nikola Bakoš, updated by Matija Šestak (function now uses caching), updated by Mislav Čakarić, updated by Dino Laktašić
  * @brief Function that extends the segment
@@ -318,10 +599,29 @@ int AK_init_new_extent(char *table_name, int extent_type);
 
 /**
  * @author Matija Šestak, updated by Antonio Martinović
- * @brief Function that flushes memory blocks to disk file
+ * @brief Function that flushes memory blocks to disk file, in block address order
  * @return EXIT_SUCCESS
  */
 int AK_flush_cache();
+
+/**
+ * @brief Function that makes a checkpoint: every dirty block in the buffer pool is written in one pass
+ * ordered by block address, and the DB file is synced once at the end. The disk I/O runs without the buffer
+ * pool latch, blocks dirtied after they have been copied out are left for the next checkpoint
+ * @return EXIT_SUCCESS if the checkpoint has been made, EXIT_ERROR otherwise
+ */
+int AK_checkpoint();
+
+/**
+ * @brief Function that starts the background writer thread (cache:writer_interval and cache:writer_batch in config.ini)
+ * @return EXIT_SUCCESS if the writer is running or disabled in the configuration, EXIT_ERROR otherwise
+ */
+int AK_cache_writer_start();
+
+/**
+ * @brief Function that stops the background writer thread and waits for its last round to finish
+ */
+void AK_cache_writer_stop();
 TestResult AK_memoman_test();
 TestResult AK_memoman_test2();
 
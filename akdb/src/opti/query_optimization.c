@@ -230,6 +230,69 @@ struct list_node *AK_query_optimization(struct list_node *list_query, const char
     AK_EPI;
     return temp;
 }
+
+/**
+ * @brief Function that runs a query given as an RA list from SQL parser output. The relational equivalences keep
+ * the join order as it is written, so the tables, selections and natural joins of the query are planned again by
+ * cost with AK_plan_query, which chooses the join order, the join methods and the access paths, and the physical
+ * plan is run by AK_plan_execute.
+ * @param list_query RA expression list
+ * @param dstTable name of the new table with the result
+ * @return EXIT_SUCCESS, EXIT_ERROR if the query is not one AK_plan_query plans or it can not be run
+ */
+int AK_query_execute(struct list_node *list_query, char *dstTable) {
+    AK_plan_node *plan;
+    int result;
+    AK_PRO;
+
+    plan = AK_plan_query(list_query);
+    if (plan == NULL) {
+        AK_dbg_messg(LOW, REL_EQ, "AK_query_execute: the query can not be planned\n");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_plan_print(plan);
+    result = AK_plan_execute(plan, dstTable);
+    AK_plan_free(plan);
+    AK_EPI;
+    return result;
+}
+/**
+ * @brief Function that counts the rows a pipeline gives and frees it
+ * @param iterator last operator of the pipeline, may be NULL
+ * @return number of rows, -1 if there is no pipeline or it can not be opened
+ */
+static int AK_query_optimization_test_rows(AK_iterator *iterator)
+{
+    int rows = 0;
+
+    if (iterator == NULL)
+        return -1;
+    if (AK_iterator_open(iterator) != EXIT_SUCCESS)
+        rows = -1;
+    while (rows != -1 && AK_iterator_next(iterator) != NULL)
+        rows++;
+    AK_iterator_close(iterator);
+    AK_iterator_free(iterator);
+    return rows;
+}
+
+/**
+ * @brief Function that sets the method of every join of a physical plan
+ * @param plan plan
+ * @param method AK_PLAN_NESTED_LOOP, AK_PLAN_HASH_JOIN or AK_PLAN_MERGE_JOIN
+ */
+static void AK_query_optimization_test_method(AK_plan_node *plan, int method)
+{
+    int i;
+
+    if (plan->method == AK_PLAN_NESTED_LOOP || plan->method == AK_PLAN_HASH_JOIN || plan->method == AK_PLAN_MERGE_JOIN)
+        plan->method = method;
+    for (i = 0; i < 2; i++)
+        if (plan->input[i] != NULL)
+            AK_query_optimization_test_method(plan->input[i], method);
+}
+
 /**
   * @author Dino Laktašić
   * @param Function for testing *list_query query to be optimized
@@ -428,6 +491,103 @@ TestResult AK_query_optimization_test() {
 
 	int success=0;
     int failed=0;
+
+    //*Join order, join methods and access paths chosen by cost give the rows of the query as it is written
+    printf("\n\n---------Cost-based join order test-----------\n\n");
+    struct list_node *planned = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *chain = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *keys[2], *condition;
+    AK_plan_node *plan;
+    AK_iterator *reference;
+    AK_header *header;
+    char reference_columns[MAX_ATTRIBUTES][MAX_ATT_NAME];
+    int methods[] = {AK_PLAN_NESTED_LOOP, AK_PLAN_HASH_JOIN, AK_PLAN_MERGE_JOIN};
+    int department = 1, reference_rows, num_columns = 0, plan_ok, i;
+
+    AK_Init_L3(&planned);
+    AK_InsertAtEnd_L3(TYPE_OPERAND, "professor", sizeof ("professor"), planned);
+    AK_InsertAtEnd_L3(TYPE_OPERAND, "employee", sizeof ("employee"), planned);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "n", sizeof ("n"), planned);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof", sizeof ("id_prof"), planned);
+    AK_InsertAtEnd_L3(TYPE_OPERAND, "department", sizeof ("department"), planned);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "s", sizeof ("s"), planned);
+    AK_InsertAtEnd_L3(TYPE_CONDITION, "`id_department` 1 =", sizeof ("`id_department` 1 ="), planned);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "n", sizeof ("n"), planned);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_department", sizeof ("id_department"), planned);
+
+    for (i = 0; i < 2; i++) {
+        keys[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&keys[i]);
+    }
+    condition = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&condition);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof", sizeof ("id_prof"), keys[0]);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_department", sizeof ("id_department"), keys[1]);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_department", sizeof ("id_department"), condition);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &department, sizeof (int), condition);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), condition);
+    reference = AK_iterator_join(AK_iterator_join(AK_iterator_scan("professor"), AK_iterator_scan("employee"), keys[0]),
+            AK_iterator_filter(AK_iterator_scan("department"), condition), keys[1]);
+    for (num_columns = 0; num_columns < reference->schema->num_attr; num_columns++)
+        strcpy(reference_columns[num_columns], reference->schema->header[num_columns].att_name);
+    reference_rows = AK_query_optimization_test_rows(reference);
+
+    plan = AK_plan_query(planned);
+    plan_ok = plan != NULL && plan->relations == 7 && plan->rows > 0 && reference_rows > 0;
+    if (plan != NULL) {
+        AK_plan_print(plan);
+        if (AK_table_exist("query_plan_result"))
+            AK_delete_segment("query_plan_result", SEGMENT_TYPE_TABLE);
+        plan_ok = plan_ok && AK_plan_execute(plan, "query_plan_result") == EXIT_SUCCESS
+                && AK_get_num_records("query_plan_result") == reference_rows
+                && AK_num_attr("query_plan_result") == num_columns;
+        header = plan_ok ? AK_get_header("query_plan_result") : NULL;
+        for (i = 0; header != NULL && i < num_columns; i++)
+            plan_ok = plan_ok && strcmp(header[i].att_name, reference_columns[i]) == 0;
+        AK_free(header);
+        for (i = 0; i < 3; i++) {
+            AK_query_optimization_test_method(plan, methods[i]);
+            plan_ok = plan_ok && AK_query_optimization_test_rows(AK_plan_iterator(plan)) == reference_rows;
+        }
+    }
+    printf("\nPlanned join: %d rows, as written: %d rows\n", plan_ok ? reference_rows : -1, reference_rows);
+    if (plan_ok)
+        success++;
+    else
+        failed++;
+    AK_plan_free(plan);
+
+    /// more tables than AK_PLAN_DP_RELATIONS are joined greedily
+    AK_Init_L3(&chain);
+    AK_InsertAtEnd_L3(TYPE_OPERAND, "employee", sizeof ("employee"), chain);
+    for (i = 0; i < AK_PLAN_DP_RELATIONS; i++) {
+        AK_InsertAtEnd_L3(TYPE_OPERAND, "employee", sizeof ("employee"), chain);
+        AK_InsertAtEnd_L3(TYPE_OPERATOR, "n", sizeof ("n"), chain);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof;id_department", sizeof ("id_prof;id_department"), chain);
+    }
+    plan = AK_plan_query(chain);
+    if (plan != NULL && plan->relations == (1 << (AK_PLAN_DP_RELATIONS + 1)) - 1
+            && AK_query_optimization_test_rows(AK_plan_iterator(plan)) == AK_get_num_records("employee")) {
+        printf("\nGreedy join order of %d tables succeeded\n", AK_PLAN_DP_RELATIONS + 1);
+        success++;
+    }
+    else {
+        printf("\nGreedy join order of %d tables failed\n", AK_PLAN_DP_RELATIONS + 1);
+        failed++;
+    }
+    AK_plan_free(plan);
+
+    AK_DeleteAll_L3(&planned);
+    AK_free(planned);
+    AK_DeleteAll_L3(&chain);
+    AK_free(chain);
+    for (i = 0; i < 2; i++) {
+        AK_DeleteAll_L3(&keys[i]);
+        AK_free(keys[i]);
+    }
+    AK_DeleteAll_L3(&condition);
+    AK_free(condition);
+
 	if (error_message==0){
 	printf("\n\n\nTest succeeded!\n");
     success++;
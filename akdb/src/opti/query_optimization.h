@@ -25,6 +25,7 @@
 #include "rel_eq_assoc.h"
 #include "rel_eq_projection.h"
 #include "rel_eq_selection.h"
+#include "query_plan.h"
 
 #include "../auxi/mempro.h"
 #include "../sql/view.h"
@@ -70,10 +71,21 @@ struct list_node *AK_execute_rel_eq(struct list_node *list_query, const char rel
  * Current implementation without uncommenting code doesn't produce list of list, 
  * it rather apply all permutations on the same list
  * 
- * For futher development consider to implement cost estimation for given plan based on 
- * returned heuristicly optimized list
+ * The returned list keeps the join order it was written with, nothing is chosen by cost here; AK_query_execute
+ * chooses the join order by cost and runs the query
  */
 struct list_node *AK_query_optimization(struct list_node *list_query, const char *FLAGS, const int DIFF_PLANS);
+
+/**
+ * @brief Function that runs a query given as an RA list from SQL parser output. The relational equivalences keep
+ * the join order as it is written, so the tables, selections and natural joins of the query are planned again by
+ * cost with AK_plan_query, which chooses the join order, the join methods and the access paths, and the physical
+ * plan is run by AK_plan_execute.
+ * @param list_query RA expression list
+ * @param dstTable name of the new table with the result
+ * @return EXIT_SUCCESS, EXIT_ERROR if the query is not one AK_plan_query plans or it can not be run
+ */
+int AK_query_execute(struct list_node *list_query, char *dstTable);
 TestResult AK_query_optimization_test() ; // (struct list_node *list_query)
 
 #endif
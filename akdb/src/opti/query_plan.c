@@ -0,0 +1,954 @@
+/**
+@file query_plan.c Provides cost-based join ordering and physical plans of join queries
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "query_plan.h"
+
+/*
+ * The relational equivalences rewrite an RA list but leave the order of its joins as it was written. A join query
+ * (tables, selections on them and natural joins over them) is taken apart here into its tables and join
+ * attributes, and planned again: every table gets the cheaper of a scan and an index scan for its selections, and
+ * the joins are ordered by dynamic programming over the sets of tables, or greedily when there are more than
+ * AK_PLAN_DP_RELATIONS of them, choosing a nested loop, hash or merge join for each. Row counts come from the table
+ * statistics: a selection keeps the fraction AK_statistics_selectivity gives, a join on attributes with n and m
+ * distinct values keeps 1/max(n, m) of the pairs of rows. The plan is run by the pipeline of rel/iterator.c.
+ *
+ * AK_query_execute plans and runs queries this way, the SELECT command of AK_command runs the RA queries it gets
+ * through it.
+ */
+
+/**
+ * @brief Table of a planned query
+ */
+typedef struct {
+    AK_tuple_schema *schema;
+    /// selections on the table as one condition in the form AK_selection takes it, NULL if none
+    struct list_node *condition;
+    /// estimated number of distinct values of every join attribute of the query, 0 if the table does not have it
+    double ndv[AK_PLAN_MAX_KEYS];
+} AK_plan_relation;
+
+/**
+ * @brief Tables and join attributes of a planned query
+ */
+typedef struct {
+    int num_relations;
+    AK_plan_relation relation[AK_PLAN_MAX_RELATIONS];
+    int num_keys;
+    char keys[AK_PLAN_MAX_KEYS][MAX_ATT_NAME];
+    /// attributes of the result in the order the query gives them
+    int num_columns;
+    char columns[MAX_ATTRIBUTES][MAX_ATT_NAME];
+} AK_plan_graph;
+
+/**
+ * @brief Operand of the RA list while it is read
+ */
+typedef struct {
+    int relations;
+    int num_columns;
+    char columns[MAX_ATTRIBUTES][MAX_ATT_NAME];
+} AK_plan_operand;
+
+/**
+ * @brief Estimate of a part of a selection condition
+ */
+typedef struct {
+    /// the attribute or the constant the entry is, NULL for a predicate
+    struct list_node *el;
+    double selectivity;
+    /// selectivity of the predicate ANDed into it an index can answer best, -1 if there is none
+    double index_selectivity;
+    char index_attribute[MAX_ATT_NAME];
+} AK_plan_estimate;
+
+/**
+ * @brief Function that reads the next token of a condition of an RA list
+ * @param cursor position in the condition
+ * @param token buffer of MAX_VARCHAR_LENGTH + 1 bytes, a quoted token keeps its quotes
+ * @return position after the token, NULL if there are no more tokens
+ */
+static char *AK_plan_token(char *cursor, char *token)
+{
+    char quote = 0;
+    int length = 0;
+
+    while (*cursor == ' ')
+        cursor++;
+    if (*cursor == '\0')
+        return NULL;
+    if (*cursor == '`' || *cursor == '\'')
+        quote = *cursor;
+    do {
+        if (length < MAX_VARCHAR_LENGTH)
+            token[length++] = *cursor;
+        cursor++;
+    } while (*cursor != '\0' && (quote ? cursor[-1] != quote || length == 1 : *cursor != ' '));
+    token[length] = '\0';
+    return cursor;
+}
+
+/**
+ * @brief Function that tells if a token of a condition is an attribute and gives its name
+ * @param token token
+ * @param name buffer of MAX_ATT_NAME bytes
+ * @return 1 for an attribute, 0 otherwise
+ */
+static int AK_plan_token_attribute(char *token, char *name)
+{
+    int length = strlen(token);
+
+    if (length < 3 || token[0] != '`' || token[length - 1] != '`')
+        return 0;
+    length = length - 2 < MAX_ATT_NAME - 1 ? length - 2 : MAX_ATT_NAME - 1;
+    memcpy(name, token + 1, length);
+    name[length] = '\0';
+    return 1;
+}
+
+/**
+ * @brief Function that appends a condition of an RA list to a postfix expression, typing every number like the
+ * attribute before it
+ * @param condition condition, with attributes in backquotes and strings in quotes
+ * @param schema attributes of the table of the condition
+ * @param expr expression
+ */
+static void AK_plan_append_condition(char *condition, AK_tuple_schema *schema, struct list_node *expr)
+{
+    char token[MAX_VARCHAR_LENGTH + 1], name[MAX_ATT_NAME], *end;
+    int type = TYPE_INT, position, length, int_value;
+    float float_value;
+    double number;
+
+    while ((condition = AK_plan_token(condition, token)) != NULL) {
+        length = strlen(token);
+        if (AK_plan_token_attribute(token, name)) {
+            AK_InsertAtEnd_L3(TYPE_ATTRIBS, name, strlen(name) + 1, expr);
+            position = AK_tuple_schema_find(schema, name);
+            type = position != -1 ? schema->header[position].type : TYPE_INT;
+            continue;
+        }
+        if (length >= 2 && token[0] == '\'' && token[length - 1] == '\'') {
+            token[length - 1] = '\0';
+            AK_InsertAtEnd_L3(TYPE_VARCHAR, token + 1, length - 1, expr);
+            continue;
+        }
+        number = strtod(token, &end);
+        if (end == token || *end != '\0') {
+            AK_InsertAtEnd_L3(TYPE_OPERATOR, token, length + 1, expr);
+        }
+        else if (type == TYPE_FLOAT) {
+            float_value = (float) number;
+            AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &float_value, sizeof (float), expr);
+        }
+        else if (type == TYPE_NUMBER) {
+            AK_InsertAtEnd_L3(TYPE_NUMBER, (char *) &number, sizeof (double), expr);
+        }
+        else if (strchr(token, '.') == NULL) {
+            int_value = (int) number;
+            AK_InsertAtEnd_L3(type == TYPE_VARCHAR ? TYPE_INT : type, (char *) &int_value, sizeof (int), expr);
+        }
+        else {
+            float_value = (float) number;
+            AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &float_value, sizeof (float), expr);
+        }
+    }
+}
+
+/**
+ * @brief Function that estimates a comparison of an attribute with a constant
+ * @param tblName table name
+ * @param attribute entry of the attribute
+ * @param constant entry of the constant
+ * @param op comparison operator, as if the attribute were on its left
+ * @param result estimate of the comparison
+ */
+static void AK_plan_estimate_comparison(char *tblName, AK_plan_estimate *attribute, AK_plan_estimate *constant,
+        char *op, AK_plan_estimate *result)
+{
+    char indexName[MAX_ATT_NAME];
+
+    result->selectivity = AK_statistics_selectivity(tblName, attribute->el->data, op, constant->el->type,
+            constant->el->data);
+    if (strcmp(op, "<>") != 0 && strcmp(op, "!=") != 0
+            && AK_bptree_find(tblName, attribute->el->data, indexName) == EXIT_SUCCESS) {
+        result->index_selectivity = result->selectivity;
+        strncpy(result->index_attribute, attribute->el->data, MAX_ATT_NAME - 1);
+    }
+}
+
+/**
+ * @brief Function that estimates the selectivity of a condition on a table and finds the predicate ANDed into it
+ * that a B+-tree index answers with the fewest rows, the one AK_selection_iterator will look up
+ * @param tblName table name
+ * @param expr condition in postfix notation
+ * @param index_selectivity set to the selectivity of that predicate, -1 if there is none
+ * @param index_attribute set to the attribute of that predicate
+ * @return selectivity between 0 and 1
+ */
+static double AK_plan_selectivity(char *tblName, struct list_node *expr, double *index_selectivity, char *index_attribute)
+{
+    AK_plan_estimate stack[MAX_VARCHAR_LENGTH], result, *a, *b, *c;
+    static const char *comparisons[] = {"=", "<>", "!=", "<", "<=", ">", ">="};
+    static const char *mirrored[] = {"=", "<>", "!=", ">", ">=", "<", "<="};
+    struct list_node *el;
+    char *op;
+    int depth = 0, i, arity;
+
+    *index_selectivity = -1;
+    for (el = AK_First_L2(expr); el != NULL; el = AK_Next_L2(el)) {
+        memset(&result, 0, sizeof (AK_plan_estimate));
+        result.index_selectivity = -1;
+        if (el->type != TYPE_OPERATOR) {
+            result.el = el;
+            if (depth == MAX_VARCHAR_LENGTH)
+                return AK_STATISTICS_DEFAULT_RANGE;
+            stack[depth++] = result;
+            continue;
+        }
+
+        op = el->data;
+        arity = strcmp(op, "NOT") == 0 ? 1 : strcmp(op, "BETWEEN") == 0 ? 3 : 2;
+        if (depth < arity)
+            return AK_STATISTICS_DEFAULT_RANGE;
+        depth -= arity;
+        a = &stack[depth];
+        b = arity > 1 ? &stack[depth + 1] : NULL;
+        c = arity > 2 ? &stack[depth + 2] : NULL;
+        result.selectivity = AK_STATISTICS_DEFAULT_RANGE;
+
+        for (i = 0; i < 7 && strcmp(op, comparisons[i]) != 0; i++);
+        if (i < 7) {
+            if (a->el != NULL && b->el != NULL && a->el->type == TYPE_ATTRIBS && b->el->type != TYPE_ATTRIBS)
+                AK_plan_estimate_comparison(tblName, a, b, (char *) comparisons[i], &result);
+            /// AK_selection_iterator only looks up predicates with the attribute on the left
+            else if (a->el != NULL && b->el != NULL && a->el->type != TYPE_ATTRIBS && b->el->type == TYPE_ATTRIBS) {
+                AK_plan_estimate_comparison(tblName, b, a, (char *) mirrored[i], &result);
+                result.index_selectivity = -1;
+            }
+        }
+        else if (strcmp(op, "BETWEEN") == 0) {
+            if (a->el != NULL && b->el != NULL && c->el != NULL && a->el->type == TYPE_ATTRIBS
+                    && b->el->type != TYPE_ATTRIBS && c->el->type != TYPE_ATTRIBS) {
+                AK_plan_estimate_comparison(tblName, a, c, "<=", &result);
+                result.selectivity -= AK_statistics_selectivity(tblName, a->el->data, "<", b->el->type, b->el->data);
+                result.selectivity = result.selectivity > 0 ? result.selectivity : 0;
+                if (result.index_selectivity != -1)
+                    result.index_selectivity = result.selectivity;
+            }
+        }
+        else if (strcmp(op, "AND") == 0) {
+            result.selectivity = (a->el == NULL ? a->selectivity : 1) * (b->el == NULL ? b->selectivity : 1);
+            if (a->index_selectivity != -1 && (b->index_selectivity == -1 || a->index_selectivity <= b->index_selectivity))
+                b = a;
+            result.index_selectivity = b->index_selectivity;
+            strcpy(result.index_attribute, b->index_attribute);
+        }
+        else if (strcmp(op, "OR") == 0) {
+            if (a->el == NULL && b->el == NULL)
+                result.selectivity = a->selectivity + b->selectivity - a->selectivity * b->selectivity;
+        }
+        else if (strcmp(op, "NOT") == 0) {
+            if (a->el == NULL)
+                result.selectivity = 1 - a->selectivity;
+        }
+        stack[depth++] = result;
+    }
+
+    if (depth != 1 || stack[0].el != NULL)
+        return AK_STATISTICS_DEFAULT_RANGE;
+    *index_selectivity = stack[0].index_selectivity;
+    strcpy(index_attribute, stack[0].index_attribute);
+    return stack[0].selectivity;
+}
+
+/**
+ * @brief Function that finds the table of an operand that has every attribute of a condition
+ * @param graph query
+ * @param relations tables of the operand
+ * @param condition condition of an RA list
+ * @return index of the table, -1 if there is none or the condition has no attribute
+ */
+static int AK_plan_condition_relation(AK_plan_graph *graph, int relations, char *condition)
+{
+    char token[MAX_VARCHAR_LENGTH + 1], name[MAX_ATT_NAME], *cursor;
+    int r, found;
+
+    for (r = 0; r < graph->num_relations; r++) {
+        if (!(relations & (1 << r)))
+            continue;
+        found = 0;
+        for (cursor = condition; (cursor = AK_plan_token(cursor, token)) != NULL;) {
+            if (!AK_plan_token_attribute(token, name))
+                continue;
+            if (AK_tuple_schema_find(graph->relation[r].schema, name) == -1)
+                break;
+            found = 1;
+        }
+        if (found && cursor == NULL)
+            return r;
+    }
+    return -1;
+}
+
+/**
+ * @brief Function that tells if an operand has an attribute
+ * @param operand operand
+ * @param name attribute name
+ * @return 1 if it has, 0 otherwise
+ */
+static int AK_plan_operand_has(AK_plan_operand *operand, char *name)
+{
+    int i;
+    for (i = 0; i < operand->num_columns; i++)
+        if (strcmp(operand->columns[i], name) == 0)
+            return 1;
+    return 0;
+}
+
+/**
+ * @brief Function that takes a join query apart into its tables, the selections on them and its join attributes
+ * @param list_query RA list in postfix notation: tables, selections s followed by their condition and natural
+ * joins n followed by their attributes separated by ATTR_DELIMITER
+ * @param graph query, its tables have to be freed even if it fails
+ * @return EXIT_SUCCESS, EXIT_ERROR if the list is not such a query
+ */
+static int AK_plan_parse(struct list_node *list_query, AK_plan_graph *graph)
+{
+    AK_plan_operand *stack, *left, *right;
+    AK_plan_relation *relation;
+    struct list_node *el, *next;
+    char attributes[MAX_VARCHAR_LENGTH + 1], *token, *save;
+    int depth = 0, i, k, r, result = EXIT_SUCCESS;
+
+    stack = (AK_plan_operand *) AK_calloc(AK_PLAN_MAX_RELATIONS, sizeof (AK_plan_operand));
+    for (el = AK_First_L2(list_query); el != NULL && result == EXIT_SUCCESS; el = AK_Next_L2(el)) {
+        next = AK_Next_L2(el);
+        if (el->type == TYPE_OPERAND) {
+            relation = &graph->relation[graph->num_relations];
+            if (graph->num_relations == AK_PLAN_MAX_RELATIONS || (relation->schema = AK_tuple_schema_create(el->data)) == NULL) {
+                result = EXIT_ERROR;
+                continue;
+            }
+            stack[depth].relations = 1 << graph->num_relations++;
+            stack[depth].num_columns = relation->schema->num_attr;
+            for (i = 0; i < relation->schema->num_attr; i++)
+                strcpy(stack[depth].columns[i], relation->schema->header[i].att_name);
+            depth++;
+        }
+        else if (el->type == TYPE_OPERATOR && el->data[0] == RO_NAT_JOIN && el->data[1] == '\0' && depth >= 2
+                && next != NULL && next->type == TYPE_ATTRIBS) {
+            left = &stack[depth - 2];
+            right = &stack[depth - 1];
+            strncpy(attributes, next->data, MAX_VARCHAR_LENGTH);
+            attributes[MAX_VARCHAR_LENGTH] = '\0';
+            for (token = strtok_r(attributes, ATTR_DELIMITER, &save); token != NULL; token = strtok_r(NULL, ATTR_DELIMITER, &save)) {
+                for (k = 0; k < graph->num_keys && strcmp(graph->keys[k], token) != 0; k++);
+                if (k == AK_PLAN_MAX_KEYS) {
+                    result = EXIT_ERROR;
+                    break;
+                }
+                if (k == graph->num_keys)
+                    strncpy(graph->keys[graph->num_keys++], token, MAX_ATT_NAME - 1);
+            }
+            /// the attributes of the result are the ones AK_iterator_join gives for the join as it is written
+            for (i = 0; i < right->num_columns && result == EXIT_SUCCESS; i++) {
+                for (k = 0; k < graph->num_keys && strcmp(graph->keys[k], right->columns[i]) != 0; k++);
+                if (k < graph->num_keys && AK_plan_operand_has(left, right->columns[i]))
+                    continue;
+                if (left->num_columns == MAX_ATTRIBUTES)
+                    result = EXIT_ERROR;
+                else
+                    strcpy(left->columns[left->num_columns++], right->columns[i]);
+            }
+            left->relations |= right->relations;
+            depth--;
+            el = next;
+        }
+        else if (el->type == TYPE_OPERATOR && el->data[0] == RO_SELECTION && el->data[1] == '\0' && depth >= 1
+                && next != NULL && next->type == TYPE_CONDITION) {
+            r = AK_plan_condition_relation(graph, stack[depth - 1].relations, next->data);
+            if (r == -1) {
+                result = EXIT_ERROR;
+                continue;
+            }
+            relation = &graph->relation[r];
+            if (relation->condition == NULL) {
+                relation->condition = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+                AK_Init_L3(&relation->condition);
+                AK_plan_append_condition(next->data, relation->schema, relation->condition);
+            }
+            else {
+                AK_plan_append_condition(next->data, relation->schema, relation->condition);
+                AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), relation->condition);
+            }
+            el = next;
+        }
+        else {
+            result = EXIT_ERROR;
+        }
+    }
+
+    if (result == EXIT_SUCCESS && depth == 1) {
+        graph->num_columns = stack[0].num_columns;
+        memcpy(graph->columns, stack[0].columns, sizeof (graph->columns));
+    }
+    else {
+        result = EXIT_ERROR;
+    }
+    AK_free(stack);
+    return result;
+}
+
+/**
+ * @brief Function that estimates the cost of reading an intermediate result from a temporary segment
+ * @param node node giving the result
+ * @return number of blocks
+ */
+static double AK_plan_blocks(AK_plan_node *node)
+{
+    return node->rows * node->num_columns / DATA_BLOCK_SIZE + 1;
+}
+
+/**
+ * @brief Function that tells if the rows of a node fit into WORK_MEMORY
+ * @param node node
+ * @return 1 if they fit, 0 otherwise
+ */
+static int AK_plan_fits(AK_plan_node *node)
+{
+    return node->rows * node->num_columns * AK_PLAN_VALUE_BYTES <= (double) WORK_MEMORY * 1024;
+}
+
+/**
+ * @brief Function that estimates the cost of sorting the rows of a node, like AK_iterator_sort does
+ * @param node node
+ * @return cost in blocks read
+ */
+static double AK_plan_sort_cost(AK_plan_node *node)
+{
+    double n = node->rows, log2 = 0;
+
+    /// base 2 logarithm, rounded down and linear between powers of two
+    for (; n >= 2; n /= 2)
+        log2++;
+    if (n > 1)
+        log2 += n - 1;
+    return AK_PLAN_CPU_ROW * node->rows * log2 + (AK_plan_fits(node) ? 0 : 2 * AK_plan_blocks(node));
+}
+
+/**
+ * @brief Function that estimates the number of distinct values of a join attribute in the result of a node
+ * @param graph query
+ * @param node node
+ * @param key index of the join attribute
+ * @return number of distinct values, 0 if no table of the node has the attribute
+ */
+static double AK_plan_ndv(AK_plan_graph *graph, AK_plan_node *node, int key)
+{
+    double ndv = 0;
+    int r;
+
+    for (r = 0; r < graph->num_relations; r++)
+        if ((node->relations & (1 << r)) && graph->relation[r].ndv[key] > 0 && (ndv == 0 || graph->relation[r].ndv[key] < ndv))
+            ndv = graph->relation[r].ndv[key];
+    if (ndv > node->rows)
+        ndv = node->rows;
+    return ndv == 0 ? 0 : ndv > 1 ? ndv : 1;
+}
+
+/**
+ * @brief Function that chooses the cheapest way of joining the results of two nodes
+ * @param graph query
+ * @param left node giving the left input
+ * @param right node giving the right input
+ * @param node set to the join
+ * @return EXIT_SUCCESS, EXIT_ERROR if the inputs share no join attribute or the result would have more than
+ * MAX_ATTRIBUTES
+ */
+static int AK_plan_join(AK_plan_graph *graph, AK_plan_node *left, AK_plan_node *right, AK_plan_node *node)
+{
+    double ndv[2], divisor = 1, base, cost;
+    int k, num_keys = 0;
+
+    memset(node, 0, sizeof (AK_plan_node));
+    for (k = 0; k < graph->num_keys; k++) {
+        ndv[0] = AK_plan_ndv(graph, left, k);
+        ndv[1] = AK_plan_ndv(graph, right, k);
+        if (ndv[0] == 0 || ndv[1] == 0)
+            continue;
+        if (num_keys++ > 0)
+            strcat(node->attributes, ATTR_DELIMITER);
+        strcat(node->attributes, graph->keys[k]);
+        divisor *= ndv[0] > ndv[1] ? ndv[0] : ndv[1];
+    }
+    node->num_columns = left->num_columns + right->num_columns - num_keys;
+    if (num_keys == 0 || node->num_columns > MAX_ATTRIBUTES)
+        return EXIT_ERROR;
+
+    node->relations = left->relations | right->relations;
+    node->rows = left->rows * right->rows / divisor;
+    node->input[0] = left;
+    node->input[1] = right;
+    base = left->cost + right->cost + AK_PLAN_CPU_ROW * node->rows;
+
+    /// the right input is held in a hash table, or both are written out for AK_hash_join if it does not fit
+    node->method = AK_PLAN_HASH_JOIN;
+    node->cost = base + AK_PLAN_CPU_ROW * (left->rows + 2 * right->rows)
+            + (AK_plan_fits(right) ? 0 : 2 * (AK_plan_blocks(left) + AK_plan_blocks(right)));
+
+    cost = base + AK_plan_sort_cost(left) + AK_plan_sort_cost(right) + AK_PLAN_CPU_ROW * (left->rows + right->rows);
+    if (cost < node->cost) {
+        node->method = AK_PLAN_MERGE_JOIN;
+        node->cost = cost;
+    }
+
+    /// the right input is run again for every left row
+    cost = base + (left->rows > 1 ? left->rows - 1 : 0) * right->cost + AK_PLAN_CPU_ROW * left->rows * right->rows;
+    if (cost < node->cost) {
+        node->method = AK_PLAN_NESTED_LOOP;
+        node->cost = cost;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that chooses the access path of a table of a query and estimates its rows
+ * @param graph query
+ * @param r index of the table
+ * @return node reading the table, its condition is the one of the table
+ */
+static AK_plan_node *AK_plan_access(AK_plan_graph *graph, int r)
+{
+    AK_plan_relation *relation = &graph->relation[r];
+    AK_plan_node *node = (AK_plan_node *) AK_calloc(1, sizeof (AK_plan_node));
+    double row_count, blocks, selectivity = 1, index_selectivity = -1, cost;
+    int k, ndv;
+
+    strcpy(node->table, relation->schema->table);
+    node->condition = relation->condition;
+    node->relations = 1 << r;
+    node->num_columns = relation->schema->num_attr;
+    row_count = AK_statistics_row_count(node->table);
+    blocks = AK_statistics_block_count(node->table);
+    if (blocks <= 0)
+        blocks = row_count * node->num_columns / DATA_BLOCK_SIZE + 1;
+    if (node->condition != NULL)
+        selectivity = AK_plan_selectivity(node->table, node->condition, &index_selectivity, node->index_attribute);
+
+    node->method = AK_PLAN_SCAN;
+    node->rows = row_count * selectivity;
+    node->cost = blocks + AK_PLAN_CPU_ROW * row_count;
+    /// every row the index gives may be in another block
+    if (index_selectivity != -1) {
+        cost = AK_PLAN_INDEX_PROBE + (row_count * index_selectivity < blocks ? row_count * index_selectivity : blocks)
+                + AK_PLAN_CPU_ROW * row_count * index_selectivity;
+        if (cost < node->cost) {
+            node->method = AK_PLAN_INDEX_SCAN;
+            node->cost = cost;
+        }
+    }
+
+    for (k = 0; k < graph->num_keys; k++) {
+        if (AK_tuple_schema_find(relation->schema, graph->keys[k]) == -1)
+            continue;
+        ndv = AK_statistics_ndv(node->table, graph->keys[k]);
+        relation->ndv[k] = ndv > 0 && ndv < row_count ? ndv : row_count;
+        if (relation->ndv[k] > node->rows)
+            relation->ndv[k] = node->rows;
+        if (relation->ndv[k] < 1)
+            relation->ndv[k] = 1;
+    }
+    return node;
+}
+
+/**
+ * @brief Function that copies a plan
+ * @param node plan, its nodes may be shared
+ * @return copy with its own nodes and conditions
+ */
+static AK_plan_node *AK_plan_copy(AK_plan_node *node)
+{
+    AK_plan_node *copy = (AK_plan_node *) AK_malloc(sizeof (AK_plan_node));
+    struct list_node *el;
+    int i;
+
+    memcpy(copy, node, sizeof (AK_plan_node));
+    if (node->condition != NULL) {
+        copy->condition = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+        AK_Init_L3(&copy->condition);
+        for (el = AK_First_L2(node->condition); el != NULL; el = AK_Next_L2(el))
+            AK_InsertAtEnd_L3(el->type, el->data, el->size, copy->condition);
+    }
+    for (i = 0; i < 2; i++)
+        if (node->input[i] != NULL)
+            copy->input[i] = AK_plan_copy(node->input[i]);
+    return copy;
+}
+
+/**
+ * @brief Function that finds the cheapest join order by dynamic programming: the cheapest plan of every set of
+ * tables is the cheapest join of the plans of two of its subsets
+ * @param graph query
+ * @param access access paths of the tables
+ * @return plan, NULL if the tables can not all be joined
+ */
+static AK_plan_node *AK_plan_dynamic(AK_plan_graph *graph, AK_plan_node **access)
+{
+    AK_plan_node **best, *plan, *candidate, *chosen;
+    int full = (1 << graph->num_relations) - 1, set, left, r;
+
+    best = (AK_plan_node **) AK_calloc(full + 1, sizeof (AK_plan_node *));
+    candidate = (AK_plan_node *) AK_malloc(sizeof (AK_plan_node));
+    chosen = (AK_plan_node *) AK_malloc(sizeof (AK_plan_node));
+    for (r = 0; r < graph->num_relations; r++)
+        best[1 << r] = access[r];
+    for (set = 1; set <= full; set++) {
+        if ((set & (set - 1)) == 0)
+            continue;
+        chosen->relations = 0;
+        for (left = (set - 1) & set; left > 0; left = (left - 1) & set) {
+            if (best[left] == NULL || best[set ^ left] == NULL
+                    || AK_plan_join(graph, best[left], best[set ^ left], candidate) != EXIT_SUCCESS)
+                continue;
+            if (chosen->relations == 0 || candidate->cost < chosen->cost)
+                memcpy(chosen, candidate, sizeof (AK_plan_node));
+        }
+        if (chosen->relations != 0) {
+            best[set] = (AK_plan_node *) AK_malloc(sizeof (AK_plan_node));
+            memcpy(best[set], chosen, sizeof (AK_plan_node));
+        }
+    }
+
+    plan = best[full] != NULL ? AK_plan_copy(best[full]) : NULL;
+    for (set = 1; set <= full; set++)
+        if ((set & (set - 1)) != 0)
+            AK_free(best[set]);
+    AK_free(best);
+    AK_free(candidate);
+    AK_free(chosen);
+    return plan;
+}
+
+/**
+ * @brief Function that finds a join order greedily: the cheapest join of two of the plans built so far is made
+ * until one plan is left
+ * @param graph query
+ * @param access access paths of the tables
+ * @return plan, NULL if the tables can not all be joined
+ */
+static AK_plan_node *AK_plan_greedy(AK_plan_graph *graph, AK_plan_node **access)
+{
+    AK_plan_node *parts[AK_PLAN_MAX_RELATIONS], *joins[AK_PLAN_MAX_RELATIONS], *candidate, *chosen, *plan = NULL;
+    int num_parts = graph->num_relations, num_joins = 0, i, j, chosen_i = 0, chosen_j = 0;
+
+    candidate = (AK_plan_node *) AK_malloc(sizeof (AK_plan_node));
+    chosen = (AK_plan_node *) AK_malloc(sizeof (AK_plan_node));
+    memcpy(parts, access, num_parts * sizeof (AK_plan_node *));
+    while (num_parts > 1) {
+        chosen->relations = 0;
+        for (i = 0; i < num_parts; i++) {
+            for (j = 0; j < num_parts; j++) {
+                if (i == j || AK_plan_join(graph, parts[i], parts[j], candidate) != EXIT_SUCCESS)
+                    continue;
+                if (chosen->relations == 0 || candidate->cost < chosen->cost) {
+                    memcpy(chosen, candidate, sizeof (AK_plan_node));
+                    chosen_i = i;
+                    chosen_j = j;
+                }
+            }
+        }
+        if (chosen->relations == 0)
+            break;
+        joins[num_joins] = (AK_plan_node *) AK_malloc(sizeof (AK_plan_node));
+        memcpy(joins[num_joins], chosen, sizeof (AK_plan_node));
+        parts[chosen_i < chosen_j ? chosen_i : chosen_j] = joins[num_joins++];
+        parts[chosen_i < chosen_j ? chosen_j : chosen_i] = parts[--num_parts];
+    }
+
+    if (num_parts == 1)
+        plan = AK_plan_copy(parts[0]);
+    for (i = 0; i < num_joins; i++)
+        AK_free(joins[i]);
+    AK_free(candidate);
+    AK_free(chosen);
+    return plan;
+}
+
+/**
+ * @brief Function that gives the attributes of the result of a node in their order
+ * @param node node
+ * @param columns set to the attribute names
+ * @return number of attributes
+ */
+static int AK_plan_columns(AK_plan_node *node, char columns[][MAX_ATT_NAME])
+{
+    AK_tuple_schema *schema;
+    char right[MAX_ATTRIBUTES][MAX_ATT_NAME], keys[MAX_ATTRIBUTES * MAX_ATT_NAME], *token, *save;
+    int n = 0, num_right, i, key;
+
+    if (node->method == AK_PLAN_SCAN || node->method == AK_PLAN_INDEX_SCAN) {
+        schema = AK_tuple_schema_create(node->table);
+        for (n = 0; schema != NULL && n < schema->num_attr; n++)
+            strcpy(columns[n], schema->header[n].att_name);
+        AK_tuple_schema_free(schema);
+        return n;
+    }
+    n = AK_plan_columns(node->input[0], columns);
+    num_right = AK_plan_columns(node->input[1], right);
+    for (i = 0; i < num_right && n < MAX_ATTRIBUTES; i++) {
+        strcpy(keys, node->attributes);
+        for (key = 0, token = strtok_r(keys, ATTR_DELIMITER, &save); token != NULL && !key; token = strtok_r(NULL, ATTR_DELIMITER, &save))
+            key = strcmp(token, right[i]) == 0;
+        if (!key)
+            strcpy(columns[n++], right[i]);
+    }
+    return n;
+}
+
+/**
+ * @brief Function that puts a projection on top of a plan if it gives the attributes of the query in another order
+ * and the query has no two attributes with the same name
+ * @param graph query
+ * @param plan plan
+ * @return plan with the projection, or the same plan
+ */
+static AK_plan_node *AK_plan_restore_order(AK_plan_graph *graph, AK_plan_node *plan)
+{
+    AK_plan_node *projection;
+    char columns[MAX_ATTRIBUTES][MAX_ATT_NAME];
+    int n, i, j, same = 1;
+
+    n = AK_plan_columns(plan, columns);
+    if (n != graph->num_columns)
+        return plan;
+    for (i = 0; i < n; i++) {
+        same = same && strcmp(columns[i], graph->columns[i]) == 0;
+        for (j = 0; j < i; j++)
+            if (strcmp(graph->columns[i], graph->columns[j]) == 0)
+                return plan;
+    }
+    if (same)
+        return plan;
+
+    projection = (AK_plan_node *) AK_calloc(1, sizeof (AK_plan_node));
+    projection->method = AK_PLAN_PROJECTION;
+    for (i = 0; i < n; i++) {
+        if (i > 0)
+            strcat(projection->attributes, ATTR_DELIMITER);
+        strcat(projection->attributes, graph->columns[i]);
+    }
+    projection->relations = plan->relations;
+    projection->num_columns = n;
+    projection->rows = plan->rows;
+    projection->cost = plan->cost + AK_PLAN_CPU_ROW * plan->rows;
+    projection->input[0] = plan;
+    return projection;
+}
+
+/**
+ * @brief Function that chooses the physical plan of a join query. The tables are joined in the order of the
+ * lowest estimated cost, each with a nested loop, hash or merge join, and read with a scan or, when a B+-tree index
+ * answers a selection on them with fewer blocks, an index scan. The result has the attributes in the order the
+ * query gives them, unless two of them have the same name.
+ * @param list_query RA list in postfix notation of tables, selections s followed by their condition and natural
+ * joins n followed by their attributes separated by ATTR_DELIMITER, e.g. professor employee n (id_prof)
+ * department s (`id_department` 1 =) n (id_department); it is not changed
+ * @return plan, to be freed with AK_plan_free; NULL if the list is not such a query or joining its tables needs a
+ * product
+ */
+AK_plan_node *AK_plan_query(struct list_node *list_query)
+{
+    AK_plan_graph *graph = (AK_plan_graph *) AK_calloc(1, sizeof (AK_plan_graph));
+    AK_plan_node *access[AK_PLAN_MAX_RELATIONS], *plan = NULL;
+    int r;
+    AK_PRO;
+
+    if (AK_plan_parse(list_query, graph) == EXIT_SUCCESS) {
+        for (r = 0; r < graph->num_relations; r++)
+            access[r] = AK_plan_access(graph, r);
+        if (graph->num_relations == 1)
+            plan = AK_plan_copy(access[0]);
+        else if (graph->num_relations <= AK_PLAN_DP_RELATIONS)
+            plan = AK_plan_dynamic(graph, access);
+        else
+            plan = AK_plan_greedy(graph, access);
+        for (r = 0; r < graph->num_relations; r++)
+            AK_free(access[r]);
+        if (plan != NULL)
+            plan = AK_plan_restore_order(graph, plan);
+    }
+
+    for (r = 0; r < graph->num_relations; r++) {
+        AK_tuple_schema_free(graph->relation[r].schema);
+        if (graph->relation[r].condition != NULL) {
+            AK_DeleteAll_L3(&graph->relation[r].condition);
+            AK_free(graph->relation[r].condition);
+        }
+    }
+    AK_free(graph);
+    AK_EPI;
+    return plan;
+}
+
+/**
+ * @brief Function that makes a list of attributes separated by ATTR_DELIMITER
+ * @param attributes attribute names
+ * @return list, to be freed with AK_DeleteAll_L3 and AK_free
+ */
+static struct list_node *AK_plan_attribute_list(char *attributes)
+{
+    struct list_node *list = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    char names[MAX_ATTRIBUTES * MAX_ATT_NAME], *token, *save;
+
+    AK_Init_L3(&list);
+    strcpy(names, attributes);
+    for (token = strtok_r(names, ATTR_DELIMITER, &save); token != NULL; token = strtok_r(NULL, ATTR_DELIMITER, &save))
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, token, strlen(token) + 1, list);
+    return list;
+}
+
+/**
+ * @brief Function that builds the pipeline running a physical plan
+ * @param plan plan, it has to outlive the pipeline
+ * @return last operator of the pipeline, NULL if a table of the plan does not exist any more
+ */
+AK_iterator *AK_plan_iterator(AK_plan_node *plan)
+{
+    AK_iterator *iterator = NULL, *inputs[2] = {NULL, NULL}, *scan;
+    struct list_node *attributes;
+    int i;
+    AK_PRO;
+
+    switch (plan->method) {
+        case AK_PLAN_SCAN:
+            iterator = AK_iterator_scan(plan->table);
+            if (iterator != NULL && plan->condition != NULL) {
+                scan = iterator;
+                iterator = AK_iterator_filter(scan, plan->condition);
+                if (iterator == NULL)
+                    AK_iterator_free(scan);
+            }
+            break;
+        case AK_PLAN_INDEX_SCAN:
+            iterator = AK_selection_iterator(plan->table, plan->condition);
+            break;
+        default:
+            for (i = 0; i < 2 && (i == 0 || inputs[0] != NULL); i++)
+                inputs[i] = plan->input[i] != NULL ? AK_plan_iterator(plan->input[i]) : NULL;
+            if (inputs[0] == NULL || (plan->method != AK_PLAN_PROJECTION && inputs[1] == NULL))
+                break;
+            attributes = AK_plan_attribute_list(plan->attributes);
+            if (plan->method == AK_PLAN_PROJECTION)
+                iterator = AK_iterator_project(inputs[0], attributes);
+            else if (plan->method == AK_PLAN_NESTED_LOOP)
+                iterator = AK_iterator_nested_loop_join(inputs[0], inputs[1], attributes);
+            else if (plan->method == AK_PLAN_MERGE_JOIN)
+                iterator = AK_iterator_merge_join(inputs[0], inputs[1], attributes);
+            else
+                iterator = AK_iterator_join(inputs[0], inputs[1], attributes);
+            AK_DeleteAll_L3(&attributes);
+            AK_free(attributes);
+            break;
+    }
+    if (iterator == NULL) {
+        AK_iterator_free(inputs[0]);
+        AK_iterator_free(inputs[1]);
+    }
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that runs a physical plan and writes its result into a new table
+ * @param plan plan
+ * @param dstTable name of the new table
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_plan_execute(AK_plan_node *plan, char *dstTable)
+{
+    AK_iterator *iterator;
+    int result;
+    AK_PRO;
+
+    iterator = AK_plan_iterator(plan);
+    if (iterator == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    result = AK_iterator_materialize(iterator, dstTable);
+    AK_iterator_free(iterator);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that prints a node of a physical plan with its inputs
+ * @param node node
+ * @param depth depth of the node in the plan
+ */
+static void AK_plan_print_node(AK_plan_node *node, int depth)
+{
+    static const char *methods[] = {"SCAN", "INDEX SCAN", "NESTED LOOP JOIN", "HASH JOIN", "MERGE JOIN", "PROJECTION"};
+    int i;
+
+    printf("%*s%s", 4 * depth, "", methods[node->method]);
+    if (node->method == AK_PLAN_SCAN || node->method == AK_PLAN_INDEX_SCAN)
+        printf(" %s", node->table);
+    if (node->method == AK_PLAN_INDEX_SCAN)
+        printf(" on %s", node->index_attribute);
+    else if (node->method == AK_PLAN_SCAN && node->condition != NULL)
+        printf(" with selection");
+    else if (node->method != AK_PLAN_SCAN)
+        printf(" (%s)", node->attributes);
+    printf("  rows: %.1f cost: %.2f\n", node->rows, node->cost);
+    for (i = 0; i < 2; i++)
+        if (node->input[i] != NULL)
+            AK_plan_print_node(node->input[i], depth + 1);
+}
+
+/**
+ * @brief Function that prints a physical plan, every node with its estimated rows and cost
+ * @param plan plan
+ */
+void AK_plan_print(AK_plan_node *plan)
+{
+    AK_PRO;
+    AK_plan_print_node(plan, 0);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that frees a physical plan
+ * @param plan plan, may be NULL
+ */
+void AK_plan_free(AK_plan_node *plan)
+{
+    int i;
+    AK_PRO;
+    if (plan != NULL) {
+        for (i = 0; i < 2; i++)
+            AK_plan_free(plan->input[i]);
+        if (plan->condition != NULL) {
+            AK_DeleteAll_L3(&plan->condition);
+            AK_free(plan->condition);
+        }
+        AK_free(plan);
+    }
+    AK_EPI;
+}
@@ -0,0 +1,139 @@
+/**
+@file query_plan.h Header file that provides data structures and functions for cost-based physical plans of join queries
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef QUERY_PLAN
+#define QUERY_PLAN
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../file/table.h"
+#include "../file/tuple.h"
+#include "../file/statistics.h"
+#include "../file/idx/bptree.h"
+#include "../rel/iterator.h"
+#include "../rel/selection.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @def AK_PLAN_MAX_RELATIONS
+ * @brief Maximum number of tables a planned query joins
+ */
+#define AK_PLAN_MAX_RELATIONS 16
+
+/**
+ * @def AK_PLAN_DP_RELATIONS
+ * @brief Maximum number of tables whose join order is found by dynamic programming, more are joined greedily
+ */
+#define AK_PLAN_DP_RELATIONS 10
+
+/**
+ * @def AK_PLAN_MAX_KEYS
+ * @brief Maximum number of distinct join attributes of a planned query
+ */
+#define AK_PLAN_MAX_KEYS 32
+
+/**
+ * @def AK_PLAN_CPU_ROW
+ * @brief Cost of handling a row in memory, in blocks read
+ */
+#define AK_PLAN_CPU_ROW 0.01
+
+/**
+ * @def AK_PLAN_INDEX_PROBE
+ * @brief Cost of descending a B+-tree index, in blocks read
+ */
+#define AK_PLAN_INDEX_PROBE 3
+
+/**
+ * @def AK_PLAN_VALUE_BYTES
+ * @brief Number of bytes a value of a row held in memory by a join or a sort is taken to need
+ */
+#define AK_PLAN_VALUE_BYTES 24
+
+/**
+ * @def AK_PLAN_SCAN
+ * @brief Node reading all rows of a table, filtered by the condition if there is one
+ */
+#define AK_PLAN_SCAN 0
+
+/**
+ * @def AK_PLAN_INDEX_SCAN
+ * @brief Node reading the rows of a table a B+-tree index gives for the condition
+ */
+#define AK_PLAN_INDEX_SCAN 1
+
+/**
+ * @def AK_PLAN_NESTED_LOOP
+ * @brief Node joining its inputs by reading the right input again for every left row
+ */
+#define AK_PLAN_NESTED_LOOP 2
+
+/**
+ * @def AK_PLAN_HASH_JOIN
+ * @brief Node joining its inputs through a hash table on the right input
+ */
+#define AK_PLAN_HASH_JOIN 3
+
+/**
+ * @def AK_PLAN_MERGE_JOIN
+ * @brief Node joining its inputs by sorting both on the keys and merging them
+ */
+#define AK_PLAN_MERGE_JOIN 4
+
+/**
+ * @def AK_PLAN_PROJECTION
+ * @brief Node putting the attributes of its input into the order the query gives them in
+ */
+#define AK_PLAN_PROJECTION 5
+
+typedef struct AK_plan_node AK_plan_node;
+
+/**
+ * @struct AK_plan_node
+ * @brief Node of a physical plan, annotated with the estimated number of rows it gives and its cost
+ */
+struct AK_plan_node {
+    /// AK_PLAN_SCAN, AK_PLAN_INDEX_SCAN, AK_PLAN_NESTED_LOOP, AK_PLAN_HASH_JOIN, AK_PLAN_MERGE_JOIN or AK_PLAN_PROJECTION
+    int method;
+    /// table of a scan
+    char table[MAX_ATT_NAME];
+    /// condition of a scan in the form AK_selection takes it, NULL if none
+    struct list_node *condition;
+    /// attribute of the predicate of the condition an index scan looks up
+    char index_attribute[MAX_ATT_NAME];
+    /// key attributes of a join or attributes of a projection, separated by ATTR_DELIMITER
+    char attributes[MAX_ATTRIBUTES * MAX_ATT_NAME];
+    /// tables of the query the node reads, one bit for each in the order of the query
+    int relations;
+    int num_columns;
+    double rows;
+    /// cost of the node with its inputs, in blocks read
+    double cost;
+    /// inputs of a join, the first one of a projection
+    AK_plan_node *input[2];
+};
+
+AK_plan_node *AK_plan_query(struct list_node *list_query);
+AK_iterator *AK_plan_iterator(AK_plan_node *plan);
+int AK_plan_execute(AK_plan_node *plan, char *dstTable);
+void AK_plan_print(AK_plan_node *plan);
+void AK_plan_free(AK_plan_node *plan);
+
+#endif
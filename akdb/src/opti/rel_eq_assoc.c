@@ -76,10 +76,10 @@ struct list_node *AK_rel_eq_assoc(struct list_node *list_rel_eq) {
 
                                 //We can later consider some other options than number of table records
                                 //to get heuristic values for table reordering in association construction
-                                //Getting table rows count requires loop through all rows in table (very expansive)
-                                cost[0].value = AK_get_num_records(temp_elem->data);
-                                cost[1].value = AK_get_num_records(temp_elem_prev->data);
-                                cost[2].value = AK_get_num_records(list_elem_next->data);
+                                //Row counts come from the table statistics, the tables are not read
+                                cost[0].value = AK_statistics_row_count(temp_elem->data);
+                                cost[1].value = AK_statistics_row_count(temp_elem_prev->data);
+                                cost[2].value = AK_statistics_row_count(list_elem_next->data);
 
                                 strcpy(cost[0].data, temp_elem->data);
                                 strcpy(cost[1].data, temp_elem_prev->data);
@@ -147,7 +147,7 @@ struct list_node *AK_rel_eq_assoc(struct list_node *list_rel_eq) {
                                 //read previous two relations and save their rows number to cost_eval struct,
                                 //save also table name
                                 while (temp_elem->type == TYPE_OPERAND) {
-                                    cost[next_cost].value = AK_get_num_records(temp_elem->data);
+                                    cost[next_cost].value = AK_statistics_row_count(temp_elem->data);
                                     strcpy(cost[next_cost].data, temp_elem->data);
                                     next_cost++;
                                     temp_elem = (struct list_node *) AK_Previous_L2(temp_elem, temp);
@@ -157,7 +157,7 @@ struct list_node *AK_rel_eq_assoc(struct list_node *list_rel_eq) {
                                 //check for relation after natural join operator, if exists save data to cost_eval struct
                                 //and then sort all three elements ascending (lower index -> less rows in table)
                                 if ((list_elem_next->next)->type == TYPE_OPERAND) {
-                                    cost[next_cost].value = AK_get_num_records((list_elem_next->next)->data);
+                                    cost[next_cost].value = AK_statistics_row_count((list_elem_next->next)->data);
                                     strcpy(cost[next_cost].data, (list_elem_next->next)->data);
                                     qsort(cost, 3, sizeof (cost_eval), AK_compare);
                                 }
@@ -281,7 +281,7 @@ struct list_node *AK_rel_eq_assoc(struct list_node *list_rel_eq) {
                                 cost_eval cost[3];
 
                                 while (temp_elem->type == TYPE_OPERAND) {
-                                    cost[next_cost].value = AK_get_num_records(temp_elem->data);
+                                    cost[next_cost].value = AK_statistics_row_count(temp_elem->data);
                                     strcpy(cost[next_cost].data, temp_elem->data);
                                     next_cost++;
                                     temp_elem = (struct list_node *) AK_Previous_L2(temp_elem, temp);
@@ -289,7 +289,7 @@ struct list_node *AK_rel_eq_assoc(struct list_node *list_rel_eq) {
 
                                 if (next_cost > 1) {
                                     //see comment on the previous operator for getting heuristics values
-                                    cost[next_cost].value = AK_get_num_records((list_elem_next->next)->data);
+                                    cost[next_cost].value = AK_statistics_row_count((list_elem_next->next)->data);
                                     strcpy(cost[next_cost].data, (list_elem_next->next)->data);
                                     qsort(cost, 3, sizeof (cost_eval), AK_compare);
                                     temp_elem = (struct list_node *) AK_End_L2(temp);
@@ -22,6 +22,7 @@
 
 #include "../auxi/test.h"
 #include "../file/table.h"
+#include "../file/statistics.h"
 #include "../auxi/mempro.h"
 #include "../auxi/auxiliary.h"
 
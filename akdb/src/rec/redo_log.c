@@ -40,12 +40,6 @@ int AK_add_to_redolog(int command, struct list_node *row_root){
     }
 
     struct list_node * el = (struct list_node *) AK_First_L2(row_root);
-    
-    char* record;
-    if((record = (char*) AK_calloc(MAX_VARCHAR_LENGTH, sizeof(char))) == NULL){
-        AK_EPI;
-    	return EXIT_FAILURE;
-    }
 
     char table[MAX_ATT_NAME];
     memset(table, '\0', MAX_ATT_NAME);
@@ -56,6 +50,13 @@ int AK_add_to_redolog(int command, struct list_node *row_root){
 	int attrs_length = MAX_ATTRIBUTES;
 	if(AK_Size_L2(row_root) > MAX_ATTRIBUTES)
 		attrs_length = AK_Size_L2(row_root);
+
+    /// the record holds every value of the row and a separator after each
+    char* record;
+    if((record = (char*) AK_calloc(attrs_length * (MAX_VARCHAR_LENGTH + 1), sizeof(char))) == NULL){
+        AK_EPI;
+    	return EXIT_FAILURE;
+    }
     char** attrs = AK_calloc(attrs_length, sizeof(char*));
     int i = 0;
     while (el != NULL) {
@@ -18,8 +18,8 @@
  */
 
 #include "aggregation.h"
-
-extern search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int iNum_search_params);
+#include "iterator.h"
+#include "../sql/drop.h"
 
 /**
  @author Dejan Frankovic
@@ -131,553 +131,822 @@ void AK_agg_input_fix(AK_agg_input *input) {
     AK_EPI;
 }
 
+/*
+ * AK_aggregation resolves the attributes of the input to positions in the source table once and keeps one group per
+ * distinct combination of the binary values of the GROUP attributes in a hash table. Every group holds a typed
+ * accumulator per aggregated attribute. Tables of at least 2 * AK_AGG_THREAD_BLOCKS blocks are split into parts that
+ * are aggregated by up to AK_AGG_THREADS threads, each into its own hash table, and the partial groups are merged in
+ * the order of the parts. When the groups do not fit into WORK_MEMORY the table is aggregated by one thread: rows of
+ * groups that are not in memory are written into AK_AGG_PARTITIONS temporary segments by the hash of their group and
+ * every partition is aggregated the same way after the groups in memory are written.
+ */
+
 /**
-   @author Dejan Frankovic
-   @brief Function that aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
-          AGG_TASK_AVG_SUM are put on the beginning of the input object. Then for loop iterates through
-          input tasks and assignes the type of aggregation operation according to aggregation operation.
-	  New table has to be created. For loop goes through given table. GROUP operation is executed separately
-	  from other operations. Addresses of records are put in needed_values array and
-	  results are put in new table.
-   @param input input object with list of atributes by which we aggregate and types of aggregations
-   @param source_table - table name for the source table
-   @param agg_table  table name for aggregated table
-   @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR
+ * @brief Aggregation with the attributes resolved to positions in the source table
+ */
+typedef struct {
+    int num_columns;
+    /// aggregation task, position and type in the source table of every column of the result
+    int task[MAX_ATTRIBUTES];
+    int position[MAX_ATTRIBUTES];
+    int type[MAX_ATTRIBUTES];
+    /// header of the result
+    AK_header header[MAX_ATTRIBUTES + 1];
+    int num_groups;
+    /// columns that are GROUP attributes
+    int group_columns[MAX_ATTRIBUTES];
+    char *agg_table;
+} AK_agg_plan;
 
+/**
+ * @brief Accumulator of an aggregated attribute of a group
  */
-int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
-    int i, j;
-    AK_PRO;
-    AK_agg_input_fix(input);
-    AK_header *att_root = (*input).attributes;
-    int *att_tasks = (*input).tasks;
-    int num_aggregations = (*input).counter;
-	AK_header *agg_head_ptr[MAX_ATTRIBUTES];
-    AK_header agg_head[MAX_ATTRIBUTES];
-    int agg_group_number = 0;
-    int inttemp = 0;
-    double doubletemp = 0;
-    float floattemp = 0;
-
-    char agg_h_name[MAX_ATT_NAME];
-    int agg_h_type;
-    char group_h_name[MAX_ATT_NAME];
-
-    AK_agg_value *needed_values = AK_malloc(sizeof (AK_agg_value) * num_aggregations);
-
-    char new_table[MAX_ATT_NAME];
-    sprintf(new_table, "_%s", agg_table);
-
-    for (i = 0; i < num_aggregations; i++) 
-	{
-        agg_h_type = att_root[i].type;
-        switch (att_tasks[i]) {
+typedef struct {
+    /// rows of the group
+    long long count;
+    /// sum, minimum or maximum of INT attributes
+    long long int_value;
+    /// sum, minimum or maximum of FLOAT and NUMBER attributes
+    double double_value;
+} AK_agg_accumulator;
+
+/**
+ * @brief Group of a hash table, its GROUP values are stored in the arena from offset on
+ */
+typedef struct {
+    uint64_t hash;
+    int next;
+    int offset;
+    int size;
+} AK_agg_group;
+
+/**
+ * @brief Groups held in memory
+ */
+typedef struct {
+    char *arena;
+    int arena_size;
+    int arena_capacity;
+    AK_agg_group *groups;
+    AK_agg_accumulator *accumulators;
+    int num_groups;
+    int groups_capacity;
+    /// first group of every chain, -1 for none, the number of buckets is a power of two
+    int *buckets;
+    int num_buckets;
+} AK_agg_table;
+
+/**
+ * @brief Part of a table aggregated by a thread
+ */
+typedef struct {
+    AK_agg_plan *plan;
+    AK_row_cursor cursor;
+    AK_agg_table table;
+    long budget;
+    /// 1 if the groups of the part did not fit into the budget
+    int overflow;
+} AK_agg_worker;
+
+/**
+ * @brief Function that collects the values of a row read by a cursor, a VARCHAR value up to its '\0'
+ * @param row row
+ * @param values values in attribute order
+ * @return number of values
+ */
+static int AK_agg_row_values(struct list_node *row, AK_value *values) {
+    int i, n = AK_tuple_row_values(row, values);
+
+    for (i = 0; i < n; i++)
+        values[i].size = AK_tuple_key_size(&values[i]);
+    return n;
+}
+
+/**
+ * @brief Function that resolves the attributes of an aggregation to positions in the source table and builds the
+ * header of the result. Internal AVG tasks added by AK_agg_input_fix are skipped, AVG is computed directly.
+ * @param input aggregation
+ * @param schema attributes of the source table
+ * @param plan resolved aggregation
+ * @return EXIT_SUCCESS, EXIT_ERROR if an attribute is not in the source table
+ */
+static int AK_agg_plan_init(AK_agg_input *input, AK_tuple_schema *schema, AK_agg_plan *plan) {
+    AK_header *header;
+    char name[MAX_ATT_NAME];
+    int i, n, type;
+
+    memset(plan, 0, sizeof (AK_agg_plan));
+    for (i = 0; i < input->counter; i++) {
+        if (input->tasks[i] == AGG_TASK_AVG_COUNT || input->tasks[i] == AGG_TASK_AVG_SUM)
+            continue;
+        n = plan->num_columns;
+        plan->task[n] = input->tasks[i];
+        plan->position[n] = AK_tuple_schema_find(schema, input->attributes[i].att_name);
+        if (plan->position[n] < 0) {
+            printf("AK_aggregation: ERROR: table %s has no attribute %s\n", schema->table, input->attributes[i].att_name);
+            return EXIT_ERROR;
+        }
+        plan->type[n] = type = input->attributes[i].type;
+        switch (plan->task[n]) {
             case AGG_TASK_GROUP:
-                strcpy(agg_h_name, att_root[i].att_name);
-                strcpy(group_h_name, att_root[i].att_name);
-                agg_group_number++;
+                strcpy(name, input->attributes[i].att_name);
+                plan->group_columns[plan->num_groups++] = n;
                 break;
             case AGG_TASK_COUNT:
-                sprintf(agg_h_name, "Cnt(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
+                sprintf(name, "Cnt(%s)", input->attributes[i].att_name);
+                type = TYPE_INT;
                 break;
             case AGG_TASK_SUM:
-                sprintf(agg_h_name, "Sum(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
-                break;
             case AGG_TASK_MAX:
-                sprintf(agg_h_name, "Max(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
-                break;
             case AGG_TASK_MIN:
-                sprintf(agg_h_name, "Min(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
+                sprintf(name, plan->task[n] == AGG_TASK_SUM ? "Sum(%s)" : plan->task[n] == AGG_TASK_MAX ? "Max(%s)" : "Min(%s)", input->attributes[i].att_name);
+                if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER)
+                    type = TYPE_INT;
                 break;
             case AGG_TASK_AVG:
-                sprintf(agg_h_name, "Avg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
-                break;
-            case AGG_TASK_AVG_COUNT:
-                sprintf(agg_h_name, "_cAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_AVG_SUM:
-                sprintf(agg_h_name, "_sAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
+                sprintf(name, "Avg(%s)", input->attributes[i].att_name);
+                type = TYPE_FLOAT;
                 break;
+            default:
+                return EXIT_ERROR;
         }
-        needed_values[i].agg_task = att_tasks[i];
-        strcpy(needed_values[i].att_name, att_root[i].att_name);
-		agg_head_ptr[i] = AK_create_header(agg_h_name, agg_h_type, FREE_INT, FREE_CHAR, FREE_CHAR);
-        agg_head[i] = *(agg_head_ptr[i]);
+        header = (AK_header *) AK_create_header(name, type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&plan->header[n], header, sizeof (AK_header));
+        AK_free(header);
+        plan->num_columns++;
     }
+    return plan->num_columns > 0 ? EXIT_SUCCESS : EXIT_ERROR;
+}
 
-    // removing rest of the unneeded attributes (where attribute id is greater than number of used aggregations)
-    for (i = num_aggregations; i < MAX_ATTRIBUTES; i++) 
-	{
-        memcpy(&agg_head[i], "\0", sizeof ( "\0"));
-    }
-    
+/**
+ * @brief Function that computes the hash of the GROUP values of a row
+ * @param plan aggregation
+ * @param values values of the row
+ * @return hash value
+ */
+static uint64_t AK_agg_hash(AK_agg_plan *plan, AK_value *values) {
+    AK_value *value;
+    uint64_t hash = 0;
+    int i;
 
-    int startAddress = AK_initialize_new_segment(new_table, SEGMENT_TYPE_TABLE, agg_head);
+    for (i = 0; i < plan->num_groups; i++) {
+        value = &values[plan->position[plan->group_columns[i]]];
+        hash = AK_hash_bytes(value->data, value->size, hash);
+    }
+    return hash;
+}
 
-    if (startAddress != EXIT_ERROR)
-        printf("\nTABLE %s CREATED!\n", new_table);
+/**
+ * @brief Function that compares the GROUP values of a row with the values of a group held in memory
+ * @param plan aggregation
+ * @param values values of the row
+ * @param key GROUP values of the group, every one stored as its size followed by the data
+ * @return 1 if all values are equal, 0 otherwise
+ */
+static int AK_agg_key_equal(AK_agg_plan *plan, AK_value *values, char *key) {
+    AK_value *value;
+    int i, size;
+
+    for (i = 0; i < plan->num_groups; i++) {
+        value = &values[plan->position[plan->group_columns[i]]];
+        memcpy(&size, key, sizeof (int));
+        if (size != value->size || memcmp(key + sizeof (int), value->data, size) != 0)
+            return 0;
+        key += sizeof (int) + size;
+    }
+    return 1;
+}
 
-    // this was an optimisation or something, so that sort works normally
-    //sort_segment(source_table,group_h_name);
+/**
+ * @brief Function that gives the size of the memory held by a hash table
+ * @param plan aggregation
+ * @param table hash table
+ * @return size in bytes
+ */
+static long AK_agg_table_size(AK_agg_plan *plan, AK_agg_table *table) {
+    return table->arena_size + (long) table->num_groups * (sizeof (AK_agg_group) + plan->num_columns * sizeof (AK_agg_accumulator))
+            + (long) table->num_buckets * sizeof (int);
+}
 
-    search_params search_parameters[agg_group_number];
-    search_result sresult;
-    j = 0;
+/**
+ * @brief Function that chains the groups of a hash table into twice as many buckets
+ * @param table hash table
+ * @return No return value
+ */
+static void AK_agg_table_grow(AK_agg_table *table) {
+    int i, bucket;
+
+    table->num_buckets = table->num_buckets ? table->num_buckets * 2 : 64;
+    table->buckets = (int *) AK_realloc(table->buckets, table->num_buckets * sizeof (int));
+    for (i = 0; i < table->num_buckets; i++)
+        table->buckets[i] = -1;
+    for (i = table->num_groups - 1; i >= 0; i--) {
+        bucket = table->groups[i].hash & (table->num_buckets - 1);
+        table->groups[i].next = table->buckets[bucket];
+        table->buckets[bucket] = i;
+    }
+}
 
+/**
+ * @brief Function that finds the group of a row in a hash table and adds a new one if there is none
+ * @param plan aggregation
+ * @param table hash table
+ * @param values values of the row
+ * @param hash hash of the GROUP values of the row
+ * @param budget memory the table may take, a negative value for no limit
+ * @return position of the group, -1 if it is not in the table and the table is full
+ */
+static int AK_agg_find_group(AK_agg_plan *plan, AK_agg_table *table, AK_value *values, uint64_t hash, long budget) {
+    AK_value *value;
+    int i, needed = 0;
+
+    if (table->num_buckets == 0)
+        AK_agg_table_grow(table);
+    for (i = table->buckets[hash & (table->num_buckets - 1)]; i != -1; i = table->groups[i].next)
+        if (table->groups[i].hash == hash && AK_agg_key_equal(plan, values, table->arena + table->groups[i].offset))
+            return i;
+
+    for (i = 0; i < plan->num_groups; i++)
+        needed += sizeof (int) + values[plan->position[plan->group_columns[i]]].size;
+    if (budget >= 0 && table->num_groups > 0 && AK_agg_table_size(plan, table) + needed > budget)
+        return -1;
+
+    if (table->arena_size + needed > table->arena_capacity) {
+        table->arena_capacity = (table->arena_capacity + needed) * 2;
+        table->arena = (char *) AK_realloc(table->arena, table->arena_capacity);
+    }
+    if (table->num_groups == table->groups_capacity) {
+        table->groups_capacity = table->groups_capacity ? table->groups_capacity * 2 : 64;
+        table->groups = (AK_agg_group *) AK_realloc(table->groups, table->groups_capacity * sizeof (AK_agg_group));
+        table->accumulators = (AK_agg_accumulator *) AK_realloc(table->accumulators, table->groups_capacity * plan->num_columns * sizeof (AK_agg_accumulator));
+    }
+    table->groups[table->num_groups].hash = hash;
+    table->groups[table->num_groups].offset = table->arena_size;
+    table->groups[table->num_groups].size = needed;
+    for (i = 0; i < plan->num_groups; i++) {
+        value = &values[plan->position[plan->group_columns[i]]];
+        memcpy(table->arena + table->arena_size, &value->size, sizeof (int));
+        memcpy(table->arena + table->arena_size + sizeof (int), value->data, value->size);
+        table->arena_size += sizeof (int) + value->size;
+    }
+    memset(&table->accumulators[table->num_groups * plan->num_columns], 0, plan->num_columns * sizeof (AK_agg_accumulator));
+    i = table->num_groups++;
+    if (table->num_groups > table->num_buckets)
+        AK_agg_table_grow(table);
+    else {
+        table->groups[i].next = table->buckets[hash & (table->num_buckets - 1)];
+        table->buckets[hash & (table->num_buckets - 1)] = i;
+    }
+    return i;
+}
 
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(source_table);
-    int num_attr = AK_num_attr(source_table);
+/**
+ * @brief Function that adds a row to the accumulators of its group
+ * @param plan aggregation
+ * @param accumulators accumulators of the group
+ * @param values values of the row
+ * @return No return value
+ */
+static void AK_agg_accumulate(AK_agg_plan *plan, AK_agg_accumulator *accumulators, AK_value *values) {
+    AK_value *value;
+    AK_agg_accumulator *acc;
+    long long int_value = 0;
+    double double_value = 0;
+    int int_data = 0, i;
+    float float_data = 0;
+
+    for (i = 0; i < plan->num_columns; i++) {
+        acc = &accumulators[i];
+        value = &values[plan->position[i]];
+        switch (plan->type[i]) {
+            case TYPE_FLOAT:
+                memcpy(&float_data, value->data, value->size < (int) sizeof (float) ? value->size : sizeof (float));
+                double_value = float_data;
+                break;
+            case TYPE_NUMBER:
+                memcpy(&double_value, value->data, value->size < (int) sizeof (double) ? value->size : sizeof (double));
+                break;
+            default:
+                int_data = 0;
+                memcpy(&int_data, value->data, value->size < (int) sizeof (int) ? value->size : sizeof (int));
+                int_value = int_data;
+                break;
+        }
+        switch (plan->task[i]) {
+            case AGG_TASK_SUM:
+            case AGG_TASK_AVG:
+                acc->int_value += int_value;
+                acc->double_value += double_value;
+                break;
+            case AGG_TASK_MAX:
+                if (acc->count == 0 || int_value > acc->int_value)
+                    acc->int_value = int_value;
+                if (acc->count == 0 || double_value > acc->double_value)
+                    acc->double_value = double_value;
+                break;
+            case AGG_TASK_MIN:
+                if (acc->count == 0 || int_value < acc->int_value)
+                    acc->int_value = int_value;
+                if (acc->count == 0 || double_value < acc->double_value)
+                    acc->double_value = double_value;
+                break;
+        }
+        acc->count++;
+    }
+}
 
-    int k, l, m, n, o, counter;
+/**
+ * @brief Function that merges the accumulators of a group of another hash table into the ones of a group
+ * @param plan aggregation
+ * @param accumulators accumulators of the group
+ * @param other accumulators of the same group in another hash table
+ * @return No return value
+ */
+static void AK_agg_merge_accumulators(AK_agg_plan *plan, AK_agg_accumulator *accumulators, AK_agg_accumulator *other) {
+    int i;
 
-    AK_block *temp;
-    AK_mem_block *mem_block;
+    for (i = 0; i < plan->num_columns; i++) {
+        switch (plan->task[i]) {
+            case AGG_TASK_SUM:
+            case AGG_TASK_AVG:
+                accumulators[i].int_value += other[i].int_value;
+                accumulators[i].double_value += other[i].double_value;
+                break;
+            case AGG_TASK_MAX:
+                if (accumulators[i].count == 0 || other[i].int_value > accumulators[i].int_value)
+                    accumulators[i].int_value = other[i].int_value;
+                if (accumulators[i].count == 0 || other[i].double_value > accumulators[i].double_value)
+                    accumulators[i].double_value = other[i].double_value;
+                break;
+            case AGG_TASK_MIN:
+                if (accumulators[i].count == 0 || other[i].int_value < accumulators[i].int_value)
+                    accumulators[i].int_value = other[i].int_value;
+                if (accumulators[i].count == 0 || other[i].double_value < accumulators[i].double_value)
+                    accumulators[i].double_value = other[i].double_value;
+                break;
+        }
+        accumulators[i].count += other[i].count;
+    }
+}
 
+/**
+ * @brief Function that computes the value of a column of the result for a group
+ * @param plan aggregation
+ * @param acc accumulator of the column
+ * @param i column
+ * @param key GROUP values of the group not used yet, moved past the value of a GROUP column
+ * @param data value, MAX_VARCHAR_LENGTH + 1 bytes
+ * @return size of the value
+ */
+static int AK_agg_column_value(AK_agg_plan *plan, AK_agg_accumulator *acc, int i, char **key, char *data) {
+    int size, int_value;
+    float float_value;
+    double double_value;
+
+    memset(data, 0, MAX_VARCHAR_LENGTH + 1);
+    if (plan->task[i] == AGG_TASK_GROUP) {
+        /// GROUP values follow each other in the key in the order of the columns
+        memcpy(&size, *key, sizeof (int));
+        memcpy(data, *key + sizeof (int), size < MAX_VARCHAR_LENGTH ? size : MAX_VARCHAR_LENGTH);
+        *key += sizeof (int) + size;
+        return size < MAX_VARCHAR_LENGTH ? size : MAX_VARCHAR_LENGTH;
+    } else if (plan->task[i] == AGG_TASK_COUNT) {
+        int_value = acc->count;
+        memcpy(data, &int_value, sizeof (int));
+        return sizeof (int);
+    } else if (plan->header[i].type == TYPE_FLOAT) {
+        /// the average of a FLOAT attribute is computed in float, like the attribute itself
+        if (plan->task[i] == AGG_TASK_AVG)
+            float_value = plan->type[i] == TYPE_INT ? (float) acc->int_value / acc->count
+                    : (float) acc->double_value / (float) acc->count;
+        else
+            float_value = acc->double_value;
+        memcpy(data, &float_value, sizeof (float));
+        return sizeof (float);
+    } else if (plan->header[i].type == TYPE_NUMBER) {
+        double_value = acc->double_value;
+        memcpy(data, &double_value, sizeof (double));
+        return sizeof (double);
+    }
+    int_value = acc->int_value;
+    memcpy(data, &int_value, sizeof (int));
+    return sizeof (int);
+}
 
-	rowroot_struct rowroot_table = {.row_root = (struct list_node*) AK_malloc(sizeof(struct list_node))};
+/**
+ * @brief Function that writes the groups of a hash table into the result table
+ * @param plan aggregation
+ * @param table hash table
+ * @return No return value
+ */
+static void AK_agg_emit(AK_agg_plan *plan, AK_agg_table *table) {
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    char data[MAX_VARCHAR_LENGTH + 1], *key;
+    int g, i;
+
+    AK_Init_L3(&row_root);
+    for (g = 0; g < table->num_groups; g++) {
+        key = table->arena + table->groups[g].offset;
+        for (i = 0; i < plan->num_columns; i++) {
+            AK_agg_column_value(plan, &table->accumulators[g * plan->num_columns + i], i, &key, data);
+            AK_Insert_New_Element(plan->header[i].type, data, plan->agg_table, plan->header[i].att_name, row_root);
+        }
+        AK_insert_row(row_root);
+        AK_DeleteAll_L3(&row_root);
+    }
+    AK_free(row_root);
+}
 
-    AK_Init_L3(&rowroot_table);
+/**
+ * @brief Function that frees a hash table
+ * @param table hash table
+ * @return No return value
+ */
+static void AK_agg_table_free(AK_agg_table *table) {
+    AK_free(table->arena);
+    AK_free(table->groups);
+    AK_free(table->accumulators);
+    AK_free(table->buckets);
+    memset(table, 0, sizeof (AK_agg_table));
+}
 
+/**
+ * @brief Function that aggregates a part of a table in a thread
+ * @param arg AK_agg_worker of the part
+ * @return NULL
+ */
+static void *AK_agg_worker_main(void *arg) {
+    AK_agg_worker *worker = (AK_agg_worker *) arg;
+    AK_value values[MAX_ATTRIBUTES];
+    struct list_node *row;
+    int group;
+
+    while (!worker->overflow && (row = AK_row_cursor_next(&worker->cursor)) != NULL) {
+        AK_agg_row_values(row, values);
+        group = AK_agg_find_group(worker->plan, &worker->table, values, AK_agg_hash(worker->plan, values), worker->budget);
+        if (group == -1)
+            worker->overflow = 1;
+        else
+            AK_agg_accumulate(worker->plan, &worker->table.accumulators[group * worker->plan->num_columns], values);
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    return NULL;
+}
 
-    i = 0;
-    counter = 0;
+/**
+ * @brief Function that aggregates the parts of a table in parallel and merges the partial groups
+ * @param plan aggregation
+ * @param cursor open cursor over the table
+ * @param table hash table that receives the groups
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table has too few blocks or the groups do not fit into WORK_MEMORY
+ */
+static int AK_agg_parallel(AK_agg_plan *plan, AK_row_cursor *cursor, AK_agg_table *table) {
+    AK_row_cursor parts[AK_AGG_THREADS];
+    AK_agg_worker workers[AK_AGG_THREADS];
+    pthread_t threads[AK_AGG_THREADS];
+    AK_value values[MAX_ATTRIBUTES];
+    char *key;
+    int num_parts, i, g, k, group, overflow = 0;
+
+    num_parts = AK_row_cursor_split(cursor, parts, AK_AGG_THREADS, AK_AGG_THREAD_BLOCKS);
+    if (num_parts < 2)
+        return EXIT_ERROR;
+    AK_dbg_messg(LOW, REL_OP, "AK_aggregation: %d threads\n", num_parts);
+    memset(workers, 0, sizeof (workers));
+    for (i = 0; i < num_parts; i++) {
+        workers[i].plan = plan;
+        workers[i].cursor = parts[i];
+        workers[i].budget = (long) WORK_MEMORY * 1024 / num_parts;
+        pthread_create(&threads[i], NULL, AK_agg_worker_main, &workers[i]);
+    }
+    for (i = 0; i < num_parts; i++) {
+        pthread_join(threads[i], NULL);
+        overflow |= workers[i].overflow;
+    }
 
-    while (addresses->address_from[ i ] != 0) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            temp = (AK_block*) AK_read_block(j);
-            if ( temp->last_tuple_dict_id == 0 )
-            	break;
-            for (k = 0; k < temp->last_tuple_dict_id; k += num_attr) {
-                counter++;
-                n = 0;
-
-                //aggregation when no grouping is done will be executed separately to skip the unsorted search
-                if(agg_group_number == 0){
-                	for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-								switch (needed_values[m].agg_task) {
-									case AGG_TASK_COUNT:
-										//no break is intentional
-									case AGG_TASK_AVG_COUNT:
-										memcpy(needed_values[m].data, &counter, sizeof(int));
-										needed_values[m].data[sizeof(int)] = '\0';
-										break;
-
-									case AGG_TASK_MAX:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) < inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) < floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) < doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_MIN:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) > inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) > floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) > doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_SUM:
-										//no break is intentional
-									case AGG_TASK_AVG_SUM:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												inttemp += *((int*) needed_values[m].data);
-												memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												floattemp += *((float *)needed_values[m].data);
-												memcpy(needed_values[m].data, &floattemp, sizeof (float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												doubletemp += *((double*) needed_values[m].data);
-												memcpy(needed_values[m].data, &doubletemp, sizeof (double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-								}
-							}
-						}
-					}
-				}
-				else{
-
-					for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-
-								memcpy(needed_values[m].data, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-								needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-
-								if (needed_values[m].agg_task == AGG_TASK_GROUP) {
-									search_parameters[n].iSearchType = SEARCH_PARTICULAR;
-									search_parameters[n].pData_lower = AK_malloc(temp->tuple_dict[k + l].size + 1);
-									memcpy(search_parameters[n].pData_lower, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-									((char *) search_parameters[n].pData_lower)[ temp->tuple_dict[k + l].size ] = '\0';
-									search_parameters[n].szAttribute = (temp->header[l].att_name);
-									n++;
-								}
-							}
-						}
-					}
-
-					sresult = AK_search_unsorted(new_table, search_parameters, agg_group_number);
-
-					if (sresult.iNum_tuple_addresses == 0) {
-						AK_DeleteAll_L3(&rowroot_table);
-
-						for (l = 0; l < num_aggregations; l++) {
-							switch (needed_values[l].agg_task) {
-								case AGG_TASK_COUNT:
-									//no break is intentional
-								case AGG_TASK_AVG_COUNT:
-									inttemp = 1;
-									/**
-									 * THIS SINGLE LINE BELOW (memcpy) is the purpose of ALL evil in the world!
-									 * This line is the reason why test function prints one extra empty 
-									 * row with "nulls" at the end! Trust me! Comment it, and you will see - 
-									 * test function will not print extra row with nulls (but counts and averages 
-									 * in table will be all messed up!)
-									 * After two days of hard research, I still have not found what is the
-									 * reason behind printing extra row at the end! Fellow programmer,
-									 * if you really really want to solve this issue, arm yourself with
-									 * at least 2 liters of hot coffee!
-									 *
-									 * What this line does? What is the purpose of this line in the universe?
-									 * Well, fellow programmer, this line sets the initial count to 1.
-									 * That means if name "Ivan" is found, it will have count of 1
-									 * because, well, that's the first Ivan that is found!
-									 * If function finds another Ivan (which, actually, will happen),
-									 * this part of code will not handle it (other part of code will).
-									 *
-									 * That actually means that this little piece of code 
-									 * (this line below) only (and ONLY) sets count to 1! And besides that
-									 * causes every other evil in the world. :O
-									 *
-									 * P.S. The reason for that may be in linked list, or in AK_insert_row()
-									 * You'll have to check every piece of AKDB code to find cause!
-									 * I have found out that additional line is added when k == 25.
-									 * There may be problem in linked lists or in AK_insert_row function
-									 * or somewhere else. Who knows.
-									 *
-									 * If I didn't handle that last row (which has one attribute of size 0),
-									 * test would not pass!
-									 *
-									 * Good luck, fellow programmer!
-									 */
-									memcpy(needed_values[l].data, &inttemp, sizeof(int));
-									needed_values[l].data[sizeof (int) ] = '\0';
-									AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, rowroot_table.row_root);
-									break;
-
-								case AGG_TASK_AVG:
-									//no break is intentional
-								case AGG_TASK_MAX:
-									//no break is intentional
-								case AGG_TASK_MIN:
-									//no break is intentional
-								case AGG_TASK_SUM:
-									//no break is intentional
-								case AGG_TASK_GROUP:
-									//no break is intentional
-								case AGG_TASK_AVG_SUM:
-									//no break is intentional
-								default:
-									AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, rowroot_table.row_root);
-							}
-
-						}
-                        //FILE  -  fix this!
-						AK_insert_row(rowroot_table.row_root);
-
-					} else {
-						mem_block = AK_get_block(sresult.aiBlocks[0]);
-
-						for (l = 0; l < num_attr; l++) {
-							for (m = 0; m < num_aggregations; m++) {
-								if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-									switch (needed_values[m].agg_task) {
-										case AGG_TASK_COUNT:
-											//no break is intentional
-										case AGG_TASK_AVG_COUNT:
-											inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address)) + 1;
-											memcpy(&mem_block->block->data[mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address], &inttemp, sizeof (int));
-											break;
-
-										case AGG_TASK_SUM:
-											//no break is intentional
-										case AGG_TASK_AVG_SUM:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int*) needed_values[m].data) + *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float*) needed_values[m].data) + *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double*) needed_values[m].data) + *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													break;
-											}
-											break;
-
-										case AGG_TASK_MAX:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) > inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) > floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) > doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_MIN:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) < inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) < floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) < doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_AVG:
-											inttemp = floattemp = -1;
-											for (o = 0; o < num_aggregations; o++) {
-												sprintf(agg_h_name, "_cAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													inttemp = *((int*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-												sprintf(agg_h_name, "_sAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													floattemp = *((float*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-
-												if (inttemp != -1 && doubletemp != -1)
-													break;
-											}
-											floattemp = floattemp / (float) inttemp;
-											memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-											break;
-
-										case AGG_TASK_GROUP:
-											break;
-									}
-								}
-							}
-						}
-						AK_deallocate_search_result(sresult);
-						
-						AK_DeleteAll_L3(&rowroot_table);
-
-						for (l = 0; l<num_aggregations;l++) {
-							if (needed_values[l].agg_task == AGG_TASK_GROUP)
-							   inttemp = 1;
-							else
-								inttemp = 0;
-							AK_Insert_New_Element_For_Update(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, rowroot_table.row_root, inttemp);
-						}
-
-						//AK_update_delete_row_from_block(mem_block->block, row_root, 0);
-                        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
-					}
-				}
+    /// partial groups are merged in the order of the parts, so groups keep the order of their first rows
+    *table = workers[0].table;
+    for (i = 1; i < num_parts && !overflow; i++) {
+        for (g = 0; g < workers[i].table.num_groups; g++) {
+            key = workers[i].table.arena + workers[i].table.groups[g].offset;
+            for (k = 0; k < plan->num_groups; k++) {
+                memcpy(&values[plan->position[plan->group_columns[k]]].size, key, sizeof (int));
+                values[plan->position[plan->group_columns[k]]].data = key + sizeof (int);
+                key += sizeof (int) + values[plan->position[plan->group_columns[k]]].size;
             }
+            group = AK_agg_find_group(plan, table, values, workers[i].table.groups[g].hash, -1);
+            AK_agg_merge_accumulators(plan, &table->accumulators[group * plan->num_columns],
+                    &workers[i].table.accumulators[g * plan->num_columns]);
         }
-        i++;
     }
+    for (i = 1; i < num_parts; i++)
+        AK_agg_table_free(&workers[i].table);
+    if (overflow) {
+        AK_dbg_messg(LOW, REL_OP, "AK_aggregation: groups do not fit into %d KB, aggregating with one thread\n", WORK_MEMORY);
+        AK_agg_table_free(table);
+        return EXIT_ERROR;
+    }
+    return EXIT_SUCCESS;
+}
 
-    //if there is no grouping, we only need to insert one row into the table and we can insert it straight into the destination table
-    if(agg_group_number == 0)
-	{
+/**
+ * @brief Function that aggregates a table with one thread. Rows of groups that do not fit into WORK_MEMORY are
+ * partitioned into temporary segments and every partition is aggregated after the groups held in memory are written.
+ * @param plan aggregation
+ * @param source_table name of the table
+ * @param depth number of times the rows were already partitioned, deeper partitions are aggregated in memory
+ * @return No return value
+ */
+static void AK_agg_serial(AK_agg_plan *plan, char *source_table, int depth) {
+    char names[AK_AGG_PARTITIONS][MAX_ATT_NAME];
+    int counts[AK_AGG_PARTITIONS];
+    AK_value values[MAX_ATTRIBUTES];
+    AK_agg_table table;
+    AK_header *header = NULL;
+    AK_row_cursor cursor;
+    struct list_node *row, *row_root;
+    char data[MAX_VARCHAR_LENGTH + 1];
+    long budget = depth < AK_AGG_MAX_DEPTH ? (long) WORK_MEMORY * 1024 : -1;
+    uint64_t hash;
+    int group, p, i, n;
+
+    memset(&table, 0, sizeof (AK_agg_table));
+    memset(counts, 0, sizeof (counts));
+    AK_row_cursor_open(&cursor, source_table);
+    if (depth == 0 && AK_agg_parallel(plan, &cursor, &table) == EXIT_SUCCESS) {
+        if (plan->num_groups == 0 && table.num_groups == 0)
+            AK_agg_find_group(plan, &table, values, 0, -1);
+        AK_agg_emit(plan, &table);
+        AK_agg_table_free(&table);
+        return;
+    }
 
-    	AK_header agg_head_final[MAX_ATTRIBUTES];
-    	j = 0;
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL) {
+        n = AK_agg_row_values(row, values);
+        hash = AK_agg_hash(plan, values);
+        group = AK_agg_find_group(plan, &table, values, hash, budget);
+        if (group != -1) {
+            AK_agg_accumulate(plan, &table.accumulators[group * plan->num_columns], values);
+        } else {
+            /// the row is written unchanged into the partition of its group
+            p = AK_tuple_partition(hash, depth);
+            if (counts[p]++ == 0) {
+                if (header == NULL)
+                    header = (AK_header *) AK_get_header(source_table);
+                snprintf(names[p], MAX_ATT_NAME, "%s_agg%d_%d", plan->agg_table, depth, p);
+                AK_initialize_new_segment(names[p], SEGMENT_TYPE_TABLE, header);
+            }
+            AK_tuple_insert_values(names[p], header, values, n, row_root);
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    AK_free(row_root);
+    /// without GROUP attributes an empty table still gives one row
+    if (depth == 0 && plan->num_groups == 0 && table.num_groups == 0)
+        AK_agg_find_group(plan, &table, values, 0, -1);
+    AK_agg_emit(plan, &table);
+    AK_agg_table_free(&table);
+
+    for (p = 0; p < AK_AGG_PARTITIONS; p++) {
+        if (counts[p] > 0) {
+            AK_dbg_messg(MIDDLE, REL_OP, "AK_aggregation: %d rows in partition %s\n", counts[p], names[p]);
+            AK_agg_serial(plan, names[p], depth + 1);
+            AK_delete_segment(names[p], SEGMENT_TYPE_TABLE);
+        }
+    }
+    AK_free(header);
+}
 
-    	for (i = 0; i < num_aggregations; i++) {
-			if (agg_head[i].att_name[0] != '_') {
-				agg_head_final[j] = agg_head[i];
-				j++;
-			}
-		}
+/**
+   @author Dejan Frankovic
+   @brief Function that aggregates a given table by given attributes. The attributes are resolved to positions in
+          the source table once and the rows are grouped in a hash table on the binary values of the GROUP
+          attributes, with typed accumulators for COUNT, SUM, MIN, MAX and AVG. Large tables are aggregated by
+          several threads whose partial groups are merged, groups that do not fit into WORK_MEMORY are partitioned
+          into temporary segments. Groups are written in the order of their first rows unless they were partitioned.
+   @param input input object with list of atributes by which we aggregate and types of aggregations
+   @param source_table - table name for the source table
+   @param agg_table  table name for aggregated table
+   @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR
 
-    	startAddress = AK_initialize_new_segment(agg_table, SEGMENT_TYPE_TABLE, agg_head_final);
-
-		if (startAddress != EXIT_ERROR)
-			printf("\nTABLE %s CREATED!\n", agg_table);
-
-    	
-	AK_DeleteAll_L3(&rowroot_table);
-
-		for (l = 0; l < num_aggregations; l++) 
-		{
-
-			switch (needed_values[l].agg_task) {
-
-				case AGG_TASK_AVG_SUM:
-					floattemp = *((float *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG_COUNT:
-					inttemp = *((int *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG:
-					floattemp = floattemp/inttemp;
-					memcpy(needed_values[l].data, &floattemp, sizeof(float));
-					needed_values[l].data[sizeof(float)] = '\0';
-					//no break is intentional
-				case AGG_TASK_COUNT:
-					//no break is intentional
-				case AGG_TASK_MAX:
-					//no break is intentional
-				case AGG_TASK_MIN:
-					//no break is intentional
-				case AGG_TASK_SUM:
-					//no break is intentional
-				default:
-					AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, agg_table, agg_head[l].att_name, rowroot_table.row_root);
-					break;
-			}
-		}
-		AK_insert_row(rowroot_table.row_root);
+ */
+int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
+    AK_tuple_schema *schema;
+    AK_agg_plan plan;
+    int result;
+    AK_PRO;
+
+    schema = AK_tuple_schema_create(source_table);
+    result = schema != NULL ? AK_agg_plan_init(input, schema, &plan) : EXIT_ERROR;
+    AK_tuple_schema_free(schema);
+    if (result != EXIT_SUCCESS) {
+        AK_EPI;
+        return EXIT_ERROR;
     }
-    else
-	{
+    plan.agg_table = agg_table;
+    if (AK_initialize_new_segment(agg_table, SEGMENT_TYPE_TABLE, plan.header) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    printf("\nTABLE %s CREATED!\n", agg_table);
 
-	
-	projection_att_struct projection_att_table = {.projection_att = (struct list_node*) AK_malloc(sizeof(struct list_node))};
-	
-	AK_Init_L3(&projection_att_table);
+    AK_agg_serial(&plan, source_table, 0);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
+/**
+ * @brief Aggregation of rows that are given one by one, used by the aggregate operator of a pipeline
+ */
+struct AK_agg_stream {
+    AK_agg_plan plan;
+    AK_agg_table table;
+};
 
+/**
+ * @brief Function that creates an aggregation of rows given one by one
+ * @param input input object with list of atributes by which we aggregate and types of aggregations
+ * @param schema attributes of the rows
+ * @return aggregation, NULL if an attribute is not in the schema
+ */
+AK_agg_stream *AK_agg_stream_create(AK_agg_input *input, AK_tuple_schema *schema) {
+    AK_agg_stream *stream;
+    AK_PRO;
 
-	for (i = 0; i < num_aggregations; i++) 
-		{
-			if (agg_head[i].att_name[0] != '_') 
-			{
-				AK_InsertAtEnd_L3(TYPE_ATTRIBS, agg_head[i].att_name, strlen(agg_head[i].att_name), projection_att_table.projection_att);
+    stream = (AK_agg_stream *) AK_calloc(1, sizeof (AK_agg_stream));
+    if (AK_agg_plan_init(input, schema, &stream->plan) != EXIT_SUCCESS) {
+        AK_free(stream);
+        AK_EPI;
+        return NULL;
+    }
+    AK_EPI;
+    return stream;
+}
 
-			}
-		}
+/**
+ * @brief Function that gives the attributes of the result of an aggregation
+ * @param stream aggregation
+ * @param header receives the attributes, MAX_ATTRIBUTES of them
+ * @return number of attributes
+ */
+int AK_agg_stream_header(AK_agg_stream *stream, AK_header *header) {
+    AK_PRO;
+    memcpy(header, stream->plan.header, stream->plan.num_columns * sizeof (AK_header));
+    AK_EPI;
+    return stream->plan.num_columns;
+}
 
-		AK_projection(new_table, agg_table, projection_att_table.projection_att,NULL);
+/**
+ * @brief Function that adds a row to its group
+ * @param stream aggregation
+ * @param tuple row with the attributes of the schema the aggregation was created for
+ * @return EXIT_SUCCESS, EXIT_ERROR if the group of the row is not held and the groups take WORK_MEMORY already
+ */
+int AK_agg_stream_add(AK_agg_stream *stream, AK_tuple *tuple) {
+    AK_value values[MAX_ATTRIBUTES];
+    AK_tuple_value *value;
+    int i, group;
+    AK_PRO;
 
-		
-		AK_DeleteAll_L3(&projection_att_table);
-		AK_free(projection_att_table.projection_att);
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        values[i].type = TYPE_VARCHAR;
+        values[i].size = 0;
+        values[i].data = "";
+    }
+    for (i = 0; i < tuple->num_values; i++) {
+        value = &tuple->values[i];
+        values[value->ordinal].type = value->type;
+        values[value->ordinal].data = tuple->data + value->offset;
+        values[value->ordinal].size = value->type == TYPE_VARCHAR ? (int) strnlen(values[value->ordinal].data, value->length)
+                : value->length;
     }
-	AK_free(addresses);
-		
+    group = AK_agg_find_group(&stream->plan, &stream->table, values, AK_agg_hash(&stream->plan, values),
+            (long) WORK_MEMORY * 1024);
+    if (group == -1) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_agg_accumulate(&stream->plan, &stream->table.accumulators[group * stream->plan.num_columns], values);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
-        //TODO replace this segment with AK_drop_table() once when it's done
-	addresses = (table_addresses*) AK_get_table_addresses(new_table);
-	i = 0;
-	while (addresses->address_from[i] != 0) 
-	{
-		AK_delete_extent(addresses->address_from[i], addresses->address_to[i]);
-		i++;
-	}
-	for (i = 0; i < num_aggregations; i++)
-		AK_free(agg_head_ptr[i]);
-    AK_free(needed_values);
-    AK_free(rowroot_table.row_root);
-    AK_free(temp);
-	AK_free(addresses);
+/**
+ * @brief Function that ends the rows of an aggregation
+ * @param stream aggregation
+ * @return number of groups; without GROUP attributes an empty input still gives one
+ */
+int AK_agg_stream_finish(AK_agg_stream *stream) {
+    AK_value values[MAX_ATTRIBUTES];
+    AK_PRO;
+    if (stream->plan.num_groups == 0 && stream->table.num_groups == 0)
+        AK_agg_find_group(&stream->plan, &stream->table, values, 0, -1);
+    AK_EPI;
+    return stream->table.num_groups;
+}
+
+/**
+ * @brief Function that gives the result row of a group
+ * @param stream aggregation
+ * @param group group, from 0 to the number AK_agg_stream_finish gives
+ * @param tuple tuple with the schema of the result, cleared first
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_agg_stream_result(AK_agg_stream *stream, int group, AK_tuple *tuple) {
+    AK_agg_plan *plan = &stream->plan;
+    char data[MAX_VARCHAR_LENGTH + 1], *key;
+    int i, size;
+    AK_PRO;
+
+    AK_tuple_clear(tuple);
+    if (group < 0 || group >= stream->table.num_groups) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    key = stream->table.arena + stream->table.groups[group].offset;
+    for (i = 0; i < plan->num_columns; i++) {
+        size = AK_agg_column_value(plan, &stream->table.accumulators[group * plan->num_columns + i], i, &key, data);
+        if (AK_tuple_append(tuple, i, plan->header[i].type, data, size) != EXIT_SUCCESS) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
     AK_EPI;
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Function that drops the groups of an aggregation, so that it can be given rows again
+ * @param stream aggregation
+ * @return No return value
+ */
+void AK_agg_stream_clear(AK_agg_stream *stream) {
+    AK_PRO;
+    AK_agg_table_free(&stream->table);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that frees an aggregation
+ * @param stream aggregation, may be NULL
+ * @return No return value
+ */
+void AK_agg_stream_free(AK_agg_stream *stream) {
+    AK_PRO;
+    if (stream != NULL)
+        AK_agg_table_free(&stream->table);
+    AK_free(stream);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that checks that an aggregation of a table in a pipeline gives the rows of another table
+ * @param aggregation aggregation
+ * @param source_table table that is aggregated
+ * @param expected table with the expected rows, in any order
+ * @return 1 if every row of the pipeline is in the table and both have as many rows, 0 otherwise
+ */
+static int AK_agg_pipeline_matches(AK_agg_input *aggregation, char *source_table, char *expected) {
+    AK_iterator *pipeline, *scan = AK_iterator_scan(source_table);
+    AK_row_cursor cursor;
+    AK_tuple *tuple;
+    struct list_node *row, *el;
+    int i, found, rows = 0, matched = 0;
+
+    pipeline = scan != NULL ? AK_iterator_aggregate(scan, aggregation) : NULL;
+    if (pipeline == NULL) {
+        AK_iterator_free(scan);
+        return 0;
+    }
+    if (AK_iterator_open(pipeline) == EXIT_SUCCESS) {
+        while ((tuple = AK_iterator_next(pipeline)) != NULL) {
+            rows++;
+            found = 0;
+            AK_row_cursor_open(&cursor, expected);
+            while (!found && (row = AK_row_cursor_next(&cursor)) != NULL) {
+                found = 1;
+                /// FLOAT values are stored in 8 bytes, only the first ones hold the value
+                for (el = AK_First_L2(row), i = 0; i < tuple->num_values; el = AK_Next_L2(el), i++)
+                    if (el == NULL || el->size < tuple->values[i].length
+                            || (el->type == TYPE_VARCHAR && el->size != tuple->values[i].length)
+                            || memcmp(el->data, tuple->data + tuple->values[i].offset, tuple->values[i].length) != 0)
+                        found = 0;
+                AK_DeleteAll_L3(&row);
+                AK_free(row);
+            }
+            matched += found;
+        }
+    }
+    AK_iterator_close(pipeline);
+    AK_iterator_free(pipeline);
+    printf("Aggregation in a pipeline: %d of %d groups found in %s\n", matched, rows, expected);
+    return rows > 0 && matched == rows && rows == AK_get_num_records(expected);
+}
+
 //TODO: Needs description
 TestResult AK_aggregation_test() {
     AK_PRO;
@@ -890,6 +1159,149 @@ TestResult AK_aggregation_test() {
     } else {
     	printf("\nTEST FAILED! Number of errors: %d\n", num_errors);
     }
+    int passed = num_errors == 0, failed = num_errors != 0;
+
+    /* The same aggregation without working memory, every group but the first one is partitioned */
+    int work_memory = AK_settings.work_memory;
+    AK_agg_input aggregation;
+    AK_header *t_header = (AK_header *) AK_get_header(tblName);
+    AK_agg_input_init(&aggregation);
+    AK_agg_input_add(t_header[1], AGG_TASK_GROUP, &aggregation);
+    AK_agg_input_add(t_header[4], AGG_TASK_AVG, &aggregation);
+    AK_agg_input_add(t_header[2], AGG_TASK_COUNT, &aggregation);
+    AK_agg_input_add(t_header[4], AGG_TASK_SUM, &aggregation);
+    AK_agg_input_add(t_header[4], AGG_TASK_MAX, &aggregation);
+    AK_agg_input_add(t_header[4], AGG_TASK_MIN, &aggregation);
+    AK_free(t_header);
+    if (AK_if_exist("agg_spill", sys_table) != 0)
+        AK_delete_segment("agg_spill", SEGMENT_TYPE_TABLE);
+    AK_settings.work_memory = 0;
+    AK_aggregation(&aggregation, tblName, "agg_spill");
+    AK_settings.work_memory = work_memory;
+
+    /* The same aggregation in a pipeline */
+    if (AK_agg_pipeline_matches(&aggregation, tblName, destTable))
+        passed++;
+    else
+        failed++;
+
+    AK_row_cursor cursor, spill_cursor;
+    struct list_node *row, *spill_row;
+    int found, rows = 0, matched = 0;
+    AK_row_cursor_open(&cursor, destTable);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL) {
+        rows++;
+        found = 0;
+        AK_row_cursor_open(&spill_cursor, "agg_spill");
+        while (!found && (spill_row = AK_row_cursor_next(&spill_cursor)) != NULL) {
+            struct list_node *a = AK_First_L2(row), *b = AK_First_L2(spill_row);
+            found = 1;
+            for (; a != NULL && b != NULL; a = AK_Next_L2(a), b = AK_Next_L2(b))
+                if (a->size != b->size || memcmp(a->data, b->data, a->size) != 0)
+                    found = 0;
+            AK_DeleteAll_L3(&spill_row);
+            AK_free(spill_row);
+        }
+        matched += found;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    if (rows > 0 && matched == rows && AK_get_num_records("agg_spill") == rows) {
+        printf("Partitioned aggregation gives the same %d groups\n", rows);
+        passed++;
+    } else {
+        printf("Partitioned aggregation differs: %d of %d groups found, %d rows\n", matched, rows, AK_get_num_records("agg_spill"));
+        failed++;
+    }
+
+    /* A table of several blocks is aggregated by several threads */
+    char *rowsTable = "agg_test_rows";
+    int num_rows = 1500, num_groups = 7, value;
+    float weight;
+    if (AK_if_exist(rowsTable, sys_table) == 0) {
+        AK_header rows_header[MAX_ATTRIBUTES];
+        memset(rows_header, 0, sizeof (rows_header));
+        t_header = (AK_header *) AK_create_header("grp", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&rows_header[0], t_header, sizeof (AK_header));
+        AK_free(t_header);
+        t_header = (AK_header *) AK_create_header("val", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&rows_header[1], t_header, sizeof (AK_header));
+        AK_free(t_header);
+        t_header = (AK_header *) AK_create_header("w", TYPE_FLOAT, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(&rows_header[2], t_header, sizeof (AK_header));
+        AK_free(t_header);
+        AK_initialize_new_segment(rowsTable, SEGMENT_TYPE_TABLE, rows_header);
+        row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&row);
+        for (i = 0; i < num_rows; i++) {
+            value = i % num_groups;
+            AK_Insert_New_Element(TYPE_INT, &value, rowsTable, "grp", row);
+            AK_Insert_New_Element(TYPE_INT, &i, rowsTable, "val", row);
+            weight = (i % 4) * 0.25f;
+            AK_Insert_New_Element(TYPE_FLOAT, &weight, rowsTable, "w", row);
+            AK_insert_row(row);
+            AK_DeleteAll_L3(&row);
+        }
+        AK_free(row);
+    }
+    t_header = (AK_header *) AK_get_header(rowsTable);
+    AK_agg_input_init(&aggregation);
+    AK_agg_input_add(t_header[0], AGG_TASK_GROUP, &aggregation);
+    AK_agg_input_add(t_header[1], AGG_TASK_COUNT, &aggregation);
+    AK_agg_input_add(t_header[1], AGG_TASK_SUM, &aggregation);
+    AK_agg_input_add(t_header[1], AGG_TASK_MIN, &aggregation);
+    AK_agg_input_add(t_header[1], AGG_TASK_MAX, &aggregation);
+    AK_agg_input_add(t_header[2], AGG_TASK_AVG, &aggregation);
+    AK_free(t_header);
+    if (AK_if_exist("agg_parallel", sys_table) != 0)
+        AK_delete_segment("agg_parallel", SEGMENT_TYPE_TABLE);
+    AK_row_cursor parts[AK_AGG_THREADS];
+    AK_row_cursor_open(&cursor, rowsTable);
+    int num_parts = AK_row_cursor_split(&cursor, parts, AK_AGG_THREADS, AK_AGG_THREAD_BLOCKS);
+    AK_aggregation(&aggregation, rowsTable, "agg_parallel");
+
+    /* group g has the values g, g + 7, ... below num_rows */
+    rows = matched = 0;
+    AK_row_cursor_open(&cursor, "agg_parallel");
+    while ((row = AK_row_cursor_next(&cursor)) != NULL) {
+        int g, cnt, sum, min, max, expected_cnt = 0, expected_sum = 0;
+        float avg, expected_weight = 0;
+        memcpy(&g, AK_GetNth_L2(1, row)->data, sizeof (int));
+        memcpy(&cnt, AK_GetNth_L2(2, row)->data, sizeof (int));
+        memcpy(&sum, AK_GetNth_L2(3, row)->data, sizeof (int));
+        memcpy(&min, AK_GetNth_L2(4, row)->data, sizeof (int));
+        memcpy(&max, AK_GetNth_L2(5, row)->data, sizeof (int));
+        memcpy(&avg, AK_GetNth_L2(6, row)->data, sizeof (float));
+        for (i = g; i < num_rows; i += num_groups) {
+            expected_cnt++;
+            expected_sum += i;
+            expected_weight += (i % 4) * 0.25f;
+        }
+        if (g == rows && cnt == expected_cnt && sum == expected_sum && min == g && max == g + (expected_cnt - 1) * num_groups
+                && avg == expected_weight / (float) expected_cnt)
+            matched++;
+        else
+            printf("Wrong group %d: count %d, sum %d, min %d, max %d, avg %f\n", g, cnt, sum, min, max, avg);
+        rows++;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    if (num_parts > 1 && rows == num_groups && matched == num_groups) {
+        printf("Aggregation of %d rows in %d parts is correct\n", num_rows, num_parts);
+        passed++;
+    } else {
+        printf("Aggregation of %d rows in %d parts: %d of %d groups correct\n", num_rows, num_parts, matched, rows);
+        failed++;
+    }
+
+    /* In a pipeline without working memory the rows of every group but the first one are aggregated by AK_aggregation */
+    AK_settings.work_memory = 0;
+    if (AK_agg_pipeline_matches(&aggregation, rowsTable, "agg_parallel"))
+        passed++;
+    else
+        failed++;
+    AK_settings.work_memory = work_memory;
 
     AK_EPI;
+    return TEST_result(passed, failed);
 }
@@ -21,11 +21,13 @@
 #define AGGREGATION
 
 #include "../auxi/test.h"
-#include "selection.h"
-#include "projection.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../file/files.h"
+#include "../file/tuple.h"
 #include "../file/filesearch.h"
 #include "../auxi/mempro.h"
-#include "../sql/drop.h"
+#include "../file/idx/hash.h"
 
 #define AGG_TASK_GROUP 1
 #define AGG_TASK_COUNT 2
@@ -36,6 +38,30 @@
 #define AGG_TASK_AVG_COUNT 10 //used internaly
 #define AGG_TASK_AVG_SUM 11 //used internaly
 
+/**
+ * @def AK_AGG_THREADS
+ * @brief Maximum number of threads that aggregate parts of a table in parallel
+ */
+#define AK_AGG_THREADS 4
+
+/**
+ * @def AK_AGG_THREAD_BLOCKS
+ * @brief Minimum number of blocks with rows aggregated by one thread, smaller tables are aggregated by one thread
+ */
+#define AK_AGG_THREAD_BLOCKS 4
+
+/**
+ * @def AK_AGG_PARTITIONS
+ * @brief Number of partitions the rows of groups that do not fit into WORK_MEMORY are split into
+ */
+#define AK_AGG_PARTITIONS AK_TUPLE_PARTITIONS
+
+/**
+ * @def AK_AGG_MAX_DEPTH
+ * @brief Number of times a partition may be partitioned again, deeper partitions are aggregated in memory regardless
+ */
+#define AK_AGG_MAX_DEPTH 4
+
 /**
   * @author Unknown
   * @struct AK_agg_value
@@ -74,6 +100,12 @@ typedef struct{
     struct list_node * projection_att;
 } projection_att_struct;
 
+/**
+  * @struct AK_agg_stream
+  * @brief Aggregation of rows that are given one by one instead of read from a table
+  */
+typedef struct AK_agg_stream AK_agg_stream;
+
 /**
  @author Dejan Frankovic
  @brief  Function that calculates how many attributes there are in the header with a while loop.
@@ -126,12 +158,9 @@ void AK_agg_input_fix(AK_agg_input *input);
 
 /**
    @author Dejan Frankovic
-   @brief Function that aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
-          AGG_TASK_AVG_SUM are put on the beginning of the input object. Then for loop iterates through
-          input tasks and assignes the type of aggregation operation according to aggregation operation.
-	  New table has to be created. For loop goes through given table. GROUP operation is executed separately
-	  from other operations. Addresses of records are put in needed_values array and
-	  results are put in new table.
+   @brief Function that aggregates a given table by given attributes. The rows are grouped in a hash table on the
+          binary values of the GROUP attributes with typed accumulators for the other tasks. Large tables are
+          aggregated by several threads and groups that do not fit into WORK_MEMORY are partitioned.
    @param input input object with list of atributes by which we aggregate and types of aggregations
    @param source_table - table name for the source table
    @param agg_table  table name for aggregated table
@@ -139,6 +168,13 @@ void AK_agg_input_fix(AK_agg_input *input);
 
  */
 int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table);
+AK_agg_stream *AK_agg_stream_create(AK_agg_input *input, AK_tuple_schema *schema);
+int AK_agg_stream_header(AK_agg_stream *stream, AK_header *header);
+int AK_agg_stream_add(AK_agg_stream *stream, AK_tuple *tuple);
+int AK_agg_stream_finish(AK_agg_stream *stream);
+int AK_agg_stream_result(AK_agg_stream *stream, int group, AK_tuple *tuple);
+void AK_agg_stream_clear(AK_agg_stream *stream);
+void AK_agg_stream_free(AK_agg_stream *stream);
 TestResult AK_aggregation_test();
 
 #endif
@@ -24,14 +24,15 @@
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "set_operation.h"
+#include "union.h"
 
 /**
  * @author Dino Laktašić
- * @brief  Function that produces a difference of the two tables. Table addresses are get through names of tables.
- *         Specially start addresses are taken from them. They are used to allocate blocks for them. It is checked whether
-           the tables have same table schemas. If not, it returns EXIT_ERROR. New segment for result of difference operation is
-           initialized. Function compares every block in extent of the first table with every block in extent of second table. If there 
-	   is a difference between their rows, they are put in dstTable.
+ * @brief  Function that produces a difference of the two tables. It is checked whether the tables have same table
+ *         schemas. If not, it returns EXIT_ERROR. The rows of both tables are hashed, so every table is read once and
+ *         every row of the first table that is not in the second one is written once into dstTable
+ *         (see AK_set_operation).
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
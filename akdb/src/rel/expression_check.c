@@ -997,6 +997,892 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
     AK_EPI;
     return result;
 }
+/*
+ * A compiled expression replaces the lists the interpreter keeps while it walks the postfix expression. The
+ * interpreter never takes values off its list of values: an operator always works on the last two (BETWEEN on the
+ * last three) values pushed, and AND and OR on the last two results. Which values and results those are does not
+ * depend on the row, so the compiler resolves them once and every instruction refers to its operands directly.
+ */
+
+/// operations of a compiled expression
+#define AK_EXPR_CONSTANT 0
+#define AK_EXPR_EQUAL 1
+#define AK_EXPR_DIFFERENT 2
+#define AK_EXPR_OR 3
+#define AK_EXPR_AND 4
+#define AK_EXPR_BETWEEN 5
+#define AK_EXPR_COMPARE 6
+#define AK_EXPR_LIST 7
+#define AK_EXPR_MEMBER 8
+#define AK_EXPR_REGEX 9
+
+/// comparison operators, in the order of AK_expression_operators
+#define AK_EXPR_LT 0
+#define AK_EXPR_GT 1
+#define AK_EXPR_LE 2
+#define AK_EXPR_GE 3
+#define AK_EXPR_EQ 4
+#define AK_EXPR_NE 5
+
+static const char *AK_expression_operators[] = {"<", ">", "<=", ">=", "=", "!="};
+
+/**
+ * @brief Operators comparing a value with every value of a list: ANY holds if the comparison holds for one of
+ * them, the ALL operators hold if the comparison given here holds for none of them
+ */
+static const struct {
+    const char *name;
+    int op;
+    int negate;
+} AK_expression_quantifiers[] = {
+    {"IN", AK_EXPR_EQ, 0}, {"=ANY", AK_EXPR_EQ, 0}, {"= ANY", AK_EXPR_EQ, 0},
+    {">ANY", AK_EXPR_GT, 0}, {"> ANY", AK_EXPR_GT, 0}, {"<ANY", AK_EXPR_LT, 0}, {"< ANY", AK_EXPR_LT, 0},
+    {"<=ANY", AK_EXPR_LE, 0}, {"<= ANY", AK_EXPR_LE, 0}, {">=ANY", AK_EXPR_GE, 0}, {">= ANY", AK_EXPR_GE, 0},
+    {"!=ANY", AK_EXPR_NE, 0}, {"!= ANY", AK_EXPR_NE, 0}, {"<>ANY", AK_EXPR_NE, 0}, {"<> ANY", AK_EXPR_NE, 0},
+    {">ALL", AK_EXPR_LT, 1}, {"> ALL", AK_EXPR_LT, 1}, {"<ALL", AK_EXPR_GT, 1}, {"< ALL", AK_EXPR_GT, 1},
+    {">=ALL", AK_EXPR_LE, 1}, {">= ALL", AK_EXPR_LE, 1}, {"<=ALL", AK_EXPR_GE, 1}, {"<= ALL", AK_EXPR_GE, 1},
+    {"!=ALL", AK_EXPR_EQ, 1}, {"!= ALL", AK_EXPR_EQ, 1}, {"<>ALL", AK_EXPR_EQ, 1}, {"<> ALL", AK_EXPR_EQ, 1},
+    {"=ALL", AK_EXPR_NE, 1}, {"= ALL", AK_EXPR_NE, 1}
+};
+
+/**
+ * @brief Operators matching a value with a pattern: LIKE patterns get SQL wildcards, a pattern that fails the
+ * check of the interpreter makes LIKE unusable for the compiler and the other operators false
+ */
+static const struct {
+    const char *name;
+    int wildcard;
+    int sensitive;
+    int negate;
+} AK_expression_patterns[] = {
+    {"LIKE", 1, 1, 0}, {"~~", 1, 1, 0}, {"NOT LIKE", 1, 1, 1}, {"ILIKE", 1, 0, 0}, {"~~*", 1, 0, 0},
+    {"NOT ILIKE", 1, 0, 1}, {"~", 0, 1, 0}, {"!~", 0, 1, 1}, {"~*", 0, 0, 0}
+};
+
+/**
+ * @brief Function that compares two values of a type like AK_check_arithmetic_statement does
+ * @param type data type
+ * @param op AK_EXPR_LT, AK_EXPR_GT, AK_EXPR_LE, AK_EXPR_GE, AK_EXPR_EQ or AK_EXPR_NE
+ * @param a left operand
+ * @param b right operand
+ * @return 1 if the comparison holds, 0 otherwise
+ */
+static int AK_expression_compare(int type, int op, const char *a, const char *b)
+{
+    double x, y;
+
+    switch (type) {
+        case TYPE_INT:
+            x = *(int *) a;
+            y = *(int *) b;
+            break;
+        case TYPE_FLOAT:
+            x = *(float *) a;
+            y = *(float *) b;
+            break;
+        case TYPE_NUMBER:
+            x = *(double *) a;
+            y = *(double *) b;
+            break;
+        case TYPE_VARCHAR:
+            x = strcmp(a, b);
+            y = 0;
+            break;
+        default:
+            return 0;
+    }
+    switch (op) {
+        case AK_EXPR_LT:
+            return x < y;
+        case AK_EXPR_GT:
+            return x > y;
+        case AK_EXPR_LE:
+            return x <= y;
+        case AK_EXPR_GE:
+            return x >= y;
+        case AK_EXPR_EQ:
+            return x == y;
+        default:
+            return x != y;
+    }
+}
+
+/**
+ * @brief Function that computes the hash of a value the way equal values of a list are found
+ * @param type TYPE_INT, TYPE_FLOAT or TYPE_VARCHAR
+ * @param value value
+ * @param hash computed hash
+ * @return 1, 0 if the value is equal to no value (NaN)
+ */
+static int AK_expression_hash(int type, const char *value, uint64_t *hash)
+{
+    float float_value;
+
+    if (type == TYPE_INT)
+        *hash = AK_hash_bytes(value, sizeof (int), 0);
+    else if (type == TYPE_FLOAT) {
+        memcpy(&float_value, value, sizeof (float));
+        if (float_value != float_value)
+            return 0;
+        /// 0 and -0 are equal
+        if (float_value == 0)
+            float_value = 0;
+        *hash = AK_hash_bytes(&float_value, sizeof (float), 0);
+    }
+    else
+        *hash = AK_hash_bytes(value, strlen(value), 0);
+    return 1;
+}
+
+/**
+ * @brief Function that compares a value with the values of an IN, ANY or ALL list
+ * @param instruction AK_EXPR_LIST or AK_EXPR_MEMBER instruction
+ * @param type type of the list
+ * @param value value
+ * @return outcome of the operator
+ */
+static int AK_expression_in_list(AK_expression_instruction *instruction, int type, const char *value)
+{
+    uint64_t hash;
+    int i, slot, found = 0;
+
+    if (instruction->opcode == AK_EXPR_LIST) {
+        for (i = 0; i < instruction->list_size && !found; i++)
+            found = AK_expression_compare(type, instruction->op, value, instruction->list + i * MAX_VARCHAR_LENGTH);
+    }
+    else if (AK_expression_hash(type, value, &hash)) {
+        for (slot = hash & (instruction->set_size - 1); !found && instruction->set[slot] != -1;
+                slot = (slot + 1) & (instruction->set_size - 1)) {
+            i = instruction->set[slot];
+            found = instruction->hashes[i] == hash
+                    && AK_expression_compare(type, AK_EXPR_EQ, value, instruction->list + i * MAX_VARCHAR_LENGTH);
+        }
+    }
+    return found != instruction->negate;
+}
+
+/**
+ * @brief Function that appends an instruction to a compiled expression
+ * @param program compiled expression
+ * @param opcode AK_EXPR_* operation
+ * @return the new instruction, zeroed apart from its unused operands
+ */
+static AK_expression_instruction *AK_expression_add_instruction(AK_compiled_expression *program, int opcode)
+{
+    AK_expression_instruction *instruction;
+
+    program->instructions = (AK_expression_instruction *) AK_realloc(program->instructions,
+            (program->num_instructions + 1) * sizeof (AK_expression_instruction));
+    instruction = &program->instructions[program->num_instructions++];
+    memset(instruction, 0, sizeof (AK_expression_instruction));
+    instruction->opcode = opcode;
+    instruction->a = instruction->b = instruction->c = -1;
+    instruction->r1 = instruction->r2 = -1;
+    return instruction;
+}
+
+/**
+ * @brief Function that parses the list of an IN, ANY or ALL operator like the interpreter does for every row, and
+ * builds a hash set over it when the values are compared for equality
+ * @param instruction instruction of the operator
+ * @param list constant holding the list
+ */
+static void AK_expression_parse_list(AK_expression_instruction *instruction, AK_expression_operand *list)
+{
+    char *copy, *rest, *token, *value;
+    int int_value, i, slot;
+    float float_value;
+    uint64_t hash;
+
+    copy = rest = strdup(list->data);
+    while ((token = strsep(&rest, ",")) != NULL) {
+        instruction->list = (char *) AK_realloc(instruction->list, (instruction->list_size + 1) * MAX_VARCHAR_LENGTH);
+        value = instruction->list + instruction->list_size++ * MAX_VARCHAR_LENGTH;
+        memset(value, 0, MAX_VARCHAR_LENGTH);
+        if (list->type == TYPE_INT) {
+            int_value = atoi(token);
+            memcpy(value, &int_value, sizeof (int));
+        }
+        else if (list->type == TYPE_FLOAT) {
+            float_value = atof(token);
+            memcpy(value, &float_value, sizeof (float));
+        }
+        else
+            strncpy(value, token, MAX_VARCHAR_LENGTH - 1);
+    }
+    free(copy);
+
+    if (instruction->op != AK_EXPR_EQ || (list->type != TYPE_INT && list->type != TYPE_FLOAT && list->type != TYPE_VARCHAR))
+        return;
+    instruction->opcode = AK_EXPR_MEMBER;
+    for (instruction->set_size = 8; instruction->set_size < 2 * instruction->list_size; instruction->set_size *= 2);
+    instruction->set = (int *) AK_malloc(instruction->set_size * sizeof (int));
+    instruction->hashes = (uint64_t *) AK_malloc(instruction->list_size * sizeof (uint64_t));
+    for (i = 0; i < instruction->set_size; i++)
+        instruction->set[i] = -1;
+    for (i = 0; i < instruction->list_size; i++) {
+        if (!AK_expression_hash(list->type, instruction->list + i * MAX_VARCHAR_LENGTH, &hash))
+            continue;
+        instruction->hashes[i] = hash;
+        for (slot = hash & (instruction->set_size - 1); instruction->set[slot] != -1; slot = (slot + 1) & (instruction->set_size - 1));
+        instruction->set[slot] = i;
+    }
+}
+
+/**
+ * @brief Function that compiles the pattern of LIKE or of a regular expression operator the way
+ * AK_check_regex_expression does for every row
+ * @param pattern pattern
+ * @param wildcard 1 for LIKE patterns with SQL wildcards
+ * @param sensitive 0 for case insensitive matching
+ * @return compiled regular expression, NULL if it does not compile
+ */
+static regex_t *AK_expression_compile_pattern(const char *pattern, int wildcard, int sensitive)
+{
+    regex_t *regex = (regex_t *) AK_malloc(sizeof (regex_t));
+    char anchored[MAX_VARCHAR_LENGTH + 3];
+    char *result, *expression = (char *) pattern;
+    int compiled;
+
+    if (wildcard) {
+        /// AK_add_start_end_regex_chars anchors the pattern in place
+        memset(anchored, 0, sizeof (anchored));
+        strncpy(anchored, pattern, MAX_VARCHAR_LENGTH);
+        AK_add_start_end_regex_chars(anchored);
+        result = AK_replace_wild_card(anchored, '%', ".*");
+        expression = AK_replace_wild_card(result, '_', ".");
+        AK_free(result);
+    }
+    compiled = regcomp(regex, expression, sensitive ? REG_EXTENDED : REG_ICASE) == 0;
+    if (wildcard)
+        AK_free(expression);
+    if (!compiled) {
+        AK_free(regex);
+        return NULL;
+    }
+    return regex;
+}
+
+/**
+ * @brief Function that compiles an operator of the expression
+ * @param program compiled expression
+ * @param op operator
+ * @return EXIT_SUCCESS, EXIT_ERROR if the operator has to be left to the interpreter
+ */
+static int AK_expression_compile_operator(AK_compiled_expression *program, const char *op)
+{
+    AK_expression_instruction *instruction;
+    AK_expression_operand *b;
+    char like_regex[] = "([]:alpha:[!%_^]*)";
+    char similar_regex[] = "([]:alpha:[!%_^|*+()!]*)";
+    int nv = program->num_operands, nr = program->num_instructions, i, valid;
+
+    /// the interpreter looks at the last two values before it looks at the operator
+    if (nv < 2)
+        return EXIT_ERROR;
+    b = &program->operands[nv - 1];
+
+    if (strcmp(op, "OR") == 0 || strcmp(op, "AND") == 0) {
+        if (nr < 2)
+            return EXIT_ERROR;
+        instruction = AK_expression_add_instruction(program, strcmp(op, "OR") == 0 ? AK_EXPR_OR : AK_EXPR_AND);
+        instruction->r1 = nr - 1;
+        instruction->r2 = nr - 2;
+        return EXIT_SUCCESS;
+    }
+    if (strcmp(op, "BETWEEN") == 0) {
+        if (nv < 3)
+            return EXIT_ERROR;
+        instruction = AK_expression_add_instruction(program, AK_EXPR_BETWEEN);
+        instruction->c = nv - 3;
+    }
+    else if (strcmp(op, "=") == 0)
+        instruction = AK_expression_add_instruction(program, AK_EXPR_EQUAL);
+    else if (strcmp(op, "<>") == 0)
+        instruction = AK_expression_add_instruction(program, AK_EXPR_DIFFERENT);
+    else {
+        for (i = 0; i < sizeof (AK_expression_quantifiers) / sizeof (AK_expression_quantifiers[0]); i++)
+            if (strcmp(op, AK_expression_quantifiers[i].name) == 0)
+                break;
+        if (i < sizeof (AK_expression_quantifiers) / sizeof (AK_expression_quantifiers[0])) {
+            /// the list is split for every row, so it has to be a constant
+            if (b->position != -1)
+                return EXIT_ERROR;
+            instruction = AK_expression_add_instruction(program, AK_EXPR_LIST);
+            instruction->op = AK_expression_quantifiers[i].op;
+            instruction->negate = AK_expression_quantifiers[i].negate;
+            AK_expression_parse_list(instruction, b);
+        }
+        else if (strcmp(op, "SIMILAR TO") == 0) {
+            if (b->position != -1)
+                return EXIT_ERROR;
+            instruction = AK_expression_add_instruction(program, AK_EXPR_CONSTANT);
+            instruction->constant = AK_check_regex_operator_expression(b->data, similar_regex);
+        }
+        else {
+            for (i = 0; i < sizeof (AK_expression_patterns) / sizeof (AK_expression_patterns[0]); i++)
+                if (strcmp(op, AK_expression_patterns[i].name) == 0)
+                    break;
+            if (i < sizeof (AK_expression_patterns) / sizeof (AK_expression_patterns[0])) {
+                if (b->position != -1)
+                    return EXIT_ERROR;
+                valid = !AK_expression_patterns[i].wildcard || AK_check_regex_operator_expression(b->data, like_regex);
+                if (!valid) {
+                    /// LIKE with such a pattern gives no result at all
+                    if (strcmp(op, "LIKE") == 0 || strcmp(op, "~~") == 0)
+                        return EXIT_ERROR;
+                    instruction = AK_expression_add_instruction(program, AK_EXPR_CONSTANT);
+                }
+                else {
+                    instruction = AK_expression_add_instruction(program, AK_EXPR_REGEX);
+                    instruction->negate = AK_expression_patterns[i].negate;
+                    instruction->regex = AK_expression_compile_pattern(b->data, AK_expression_patterns[i].wildcard,
+                            AK_expression_patterns[i].sensitive);
+                    if (instruction->regex == NULL)
+                        return EXIT_ERROR;
+                }
+            }
+            else {
+                for (i = 0; i < sizeof (AK_expression_operators) / sizeof (AK_expression_operators[0]); i++)
+                    if (strcmp(op, AK_expression_operators[i]) == 0)
+                        break;
+                if (i < sizeof (AK_expression_operators) / sizeof (AK_expression_operators[0])) {
+                    instruction = AK_expression_add_instruction(program, AK_EXPR_COMPARE);
+                    instruction->op = i;
+                }
+                else if (strcmp(op, "+") == 0 || strcmp(op, "-") == 0 || strcmp(op, "*") == 0 || strcmp(op, "/") == 0)
+                    /// arithmetic results are not values the compiler can use
+                    return EXIT_ERROR;
+                else
+                    /// AK_check_arithmetic_statement does not know the operator
+                    instruction = AK_expression_add_instruction(program, AK_EXPR_CONSTANT);
+            }
+        }
+    }
+    instruction->a = nv - 2;
+    instruction->b = nv - 1;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the number of bytes a value of a type takes in a column gathered from a block
+ * @param type data type
+ * @return width of a value, 0 for types a block is not evaluated at once for
+ */
+static int AK_expression_width(int type)
+{
+    switch (type) {
+        case TYPE_INT:
+            return sizeof (int);
+        case TYPE_FLOAT:
+            return sizeof (float);
+        case TYPE_NUMBER:
+            return sizeof (double);
+        case TYPE_VARCHAR:
+            return MAX_VARCHAR_LENGTH + 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Function that checks whether AK_check_block_satisfies_compiled gives the results of
+ * AK_check_if_row_satisfies_compiled for a compiled expression. That takes operands of one type for every
+ * comparison, because the row evaluator reads the bytes of the left operand as a value of the type of the right one.
+ * @param program compiled expression
+ * @return 1 if blocks can be evaluated at once, 0 otherwise
+ */
+static int AK_expression_batchable(AK_compiled_expression *program)
+{
+    AK_expression_instruction *instruction;
+    int i, ta, tb, tc;
+
+    for (i = 0; i < program->num_operands; i++)
+        if (program->operands[i].position != -1 && AK_expression_width(program->operands[i].type) == 0)
+            return 0;
+    for (i = 0; i < program->num_instructions; i++) {
+        instruction = &program->instructions[i];
+        ta = instruction->a == -1 ? -1 : program->operands[instruction->a].type;
+        tb = instruction->b == -1 ? -1 : program->operands[instruction->b].type;
+        tc = instruction->c == -1 ? -1 : program->operands[instruction->c].type;
+        switch (instruction->opcode) {
+            case AK_EXPR_CONSTANT:
+            case AK_EXPR_OR:
+            case AK_EXPR_AND:
+                break;
+            case AK_EXPR_EQUAL:
+                /// four bytes of INT and FLOAT values are the whole value
+                if (ta != tb || (ta != TYPE_INT && ta != TYPE_FLOAT))
+                    return 0;
+                break;
+            case AK_EXPR_BETWEEN:
+                if (ta != tc || tb != tc || AK_expression_width(tc) == 0)
+                    return 0;
+                break;
+            case AK_EXPR_COMPARE:
+            case AK_EXPR_LIST:
+            case AK_EXPR_MEMBER:
+                if (ta != tb || AK_expression_width(tb) == 0)
+                    return 0;
+                break;
+            case AK_EXPR_REGEX:
+                if (ta != TYPE_VARCHAR)
+                    return 0;
+                break;
+            default:
+                /// AK_EXPR_DIFFERENT compares the bytes after the end of a value
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/// compares n values of a C type, a step of 0 bytes repeats a constant
+#define AK_EXPR_COMPARE_BATCH(c_type, oper) \
+    for (i = 0; i < n; i++) \
+        result[i] = *(const c_type *) (a + i * step_a) oper *(const c_type *) (b + i * step_b)
+
+#define AK_EXPR_COMPARE_BATCH_OP(c_type) \
+    switch (op) { \
+        case AK_EXPR_LT: AK_EXPR_COMPARE_BATCH(c_type, <); break; \
+        case AK_EXPR_GT: AK_EXPR_COMPARE_BATCH(c_type, >); break; \
+        case AK_EXPR_LE: AK_EXPR_COMPARE_BATCH(c_type, <=); break; \
+        case AK_EXPR_GE: AK_EXPR_COMPARE_BATCH(c_type, >=); break; \
+        case AK_EXPR_EQ: AK_EXPR_COMPARE_BATCH(c_type, ==); break; \
+        default: AK_EXPR_COMPARE_BATCH(c_type, !=); break; \
+    }
+
+/**
+ * @brief Function that compares the values of two columns, or of a column and a constant, like
+ * AK_expression_compare does for one pair of values
+ * @param type data type
+ * @param op AK_EXPR_LT, AK_EXPR_GT, AK_EXPR_LE, AK_EXPR_GE, AK_EXPR_EQ or AK_EXPR_NE
+ * @param a left values
+ * @param step_a bytes between two left values, 0 for a constant
+ * @param b right values
+ * @param step_b bytes between two right values, 0 for a constant
+ * @param n number of values
+ * @param result 1 for every pair the comparison holds for, 0 otherwise
+ */
+static void AK_expression_compare_batch(int type, int op, const char *a, int step_a, const char *b, int step_b, int n,
+        char *result)
+{
+    int i;
+
+    switch (type) {
+        case TYPE_INT:
+            AK_EXPR_COMPARE_BATCH_OP(int);
+            break;
+        case TYPE_FLOAT:
+            AK_EXPR_COMPARE_BATCH_OP(float);
+            break;
+        case TYPE_NUMBER:
+            AK_EXPR_COMPARE_BATCH_OP(double);
+            break;
+        case TYPE_VARCHAR:
+            for (i = 0; i < n; i++)
+                result[i] = AK_expression_compare(TYPE_VARCHAR, op, a + i * step_a, b + i * step_b);
+            break;
+        default:
+            memset(result, 0, n);
+    }
+}
+
+/**
+ * @brief Function that compiles a postfix expression for rows whose attributes are those of a header. Such rows
+ * are built by AK_Insert_New_Element on the list root in header order, so they hold the attributes last first.
+ * Attributes are bound to their positions, IN, ANY and ALL lists are parsed once and LIKE patterns and regular
+ * expressions are compiled once.
+ * @param expr list with the logical expression in postfix notation
+ * @param header attributes of the rows
+ * @param num_attr number of attributes
+ * @return compiled expression, NULL if it has to be left to AK_check_if_row_satisfies_expression
+ */
+AK_compiled_expression *AK_compile_expression(struct list_node *expr, AK_header *header, int num_attr)
+{
+    AK_compiled_expression *program;
+    AK_expression_operand *operand;
+    struct list_node *el;
+    int position, failed = 0;
+    AK_PRO;
+
+    if (expr == NULL || header == NULL || num_attr <= 0 || num_attr > MAX_ATTRIBUTES || AK_First_L2(expr) == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    program = (AK_compiled_expression *) AK_calloc(1, sizeof (AK_compiled_expression));
+    program->num_attr = num_attr;
+    for (el = AK_First_L2(expr); el != NULL && !failed && !program->always_false; el = AK_Next_L2(el)) {
+        if (program->num_operands >= MAX_TOKENS || program->num_instructions >= MAX_TOKENS) {
+            failed = 1;
+            break;
+        }
+        if (el->type == TYPE_OPERATOR) {
+            failed = AK_expression_compile_operator(program, el->data) != EXIT_SUCCESS;
+            continue;
+        }
+        position = -1;
+        if (el->type == TYPE_ATTRIBS) {
+            /// the interpreter takes the first match in the row, that is the last one in the header
+            for (position = num_attr - 1; position >= 0; position--)
+                if (strcmp(el->data, header[position].att_name) == 0)
+                    break;
+            /// the interpreter gives up on a row without the attribute as soon as it comes to it
+            if (position < 0) {
+                program->always_false = 1;
+                break;
+            }
+        }
+        program->operands = (AK_expression_operand *) AK_realloc(program->operands,
+                (program->num_operands + 1) * sizeof (AK_expression_operand));
+        operand = &program->operands[program->num_operands++];
+        operand->position = position;
+        operand->type = position == -1 ? el->type : header[position].type;
+        operand->size = el->size < MAX_VARCHAR_LENGTH ? el->size : MAX_VARCHAR_LENGTH;
+        operand->data = NULL;
+        if (position == -1) {
+            operand->data = (char *) AK_calloc(1, MAX_VARCHAR_LENGTH + 1);
+            memcpy(operand->data, el->data, operand->size);
+        }
+    }
+    if (failed || (!program->always_false && program->num_instructions == 0)) {
+        AK_dbg_messg(MIDDLE, REL_OP, "AK_compile_expression: expression left to the interpreter\n");
+        AK_free_compiled_expression(program);
+        AK_EPI;
+        return NULL;
+    }
+    program->batch = AK_expression_batchable(program);
+    AK_EPI;
+    return program;
+}
+
+/**
+ * @brief Function that runs the instructions of a compiled expression on the values of one row
+ * @param program compiled expression
+ * @param data values of the attributes of the row, by position in the header, each readable for
+ * MAX_VARCHAR_LENGTH bytes
+ * @param data_types types of the values
+ * @return 0 if row does not satisfy, 1 if row satisfies expression
+ */
+static int AK_expression_run(AK_compiled_expression *program, char **data, int *data_types)
+{
+    AK_expression_instruction *instruction;
+    AK_expression_operand *operand;
+    char *values[3];
+    int types[3], sizes[3], operands[3];
+    char results[MAX_TOKENS];
+    char *a, *b;
+    int i, j;
+
+    for (i = 0; i < program->num_instructions; i++) {
+        instruction = &program->instructions[i];
+        operands[0] = instruction->a;
+        operands[1] = instruction->b;
+        operands[2] = instruction->c;
+        for (j = 0; j < 3; j++) {
+            if (operands[j] == -1)
+                continue;
+            operand = &program->operands[operands[j]];
+            if (operand->position == -1) {
+                values[j] = operand->data;
+                types[j] = operand->type;
+                sizes[j] = operand->size;
+            }
+            else {
+                values[j] = data[operand->position];
+                types[j] = data_types[operand->position];
+                sizes[j] = MAX_VARCHAR_LENGTH;
+            }
+        }
+        a = values[0];
+        b = values[1];
+
+        switch (instruction->opcode) {
+            case AK_EXPR_CONSTANT:
+                results[i] = instruction->constant;
+                break;
+            case AK_EXPR_EQUAL:
+                /// the interpreter compares the first sizeof(int) bytes of both values
+                results[i] = memcmp(a, b, sizeof (int)) == 0;
+                break;
+            case AK_EXPR_DIFFERENT:
+                results[i] = memcmp(a, b, sizes[0]) != 0;
+                break;
+            case AK_EXPR_OR:
+                results[i] = results[instruction->r1] || results[instruction->r2];
+                break;
+            case AK_EXPR_AND:
+                results[i] = results[instruction->r1] && results[instruction->r2];
+                break;
+            case AK_EXPR_BETWEEN:
+                results[i] = AK_expression_compare(types[0], AK_EXPR_GE, values[2], a)
+                        && AK_expression_compare(types[1], AK_EXPR_LE, values[2], b);
+                break;
+            case AK_EXPR_COMPARE:
+                results[i] = AK_expression_compare(types[1], instruction->op, a, b);
+                break;
+            case AK_EXPR_LIST:
+            case AK_EXPR_MEMBER:
+                results[i] = AK_expression_in_list(instruction, types[1], a);
+                break;
+            case AK_EXPR_REGEX:
+                results[i] = (regexec(instruction->regex, a, 0, NULL, 0) != REG_NOMATCH) != instruction->negate;
+                break;
+        }
+    }
+    return results[program->num_instructions - 1];
+}
+
+/**
+ * @brief Function that evaluates a compiled expression on a row, with the same outcome as
+ * AK_check_if_row_satisfies_expression on the expression it was compiled from
+ * @param program compiled expression
+ * @param row_root row with the attributes of the header the expression was compiled for
+ * @return 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_check_if_row_satisfies_compiled(AK_compiled_expression *program, struct list_node *row_root)
+{
+    struct list_node *el;
+    char *data[MAX_ATTRIBUTES];
+    int types[MAX_ATTRIBUTES];
+    int n, result;
+    AK_PRO;
+
+    if (program->always_false) {
+        AK_EPI;
+        return 0;
+    }
+    /// the row holds the attributes last first
+    for (n = 0, el = AK_First_L2(row_root); el != NULL && n < program->num_attr; el = AK_Next_L2(el), n++) {
+        data[program->num_attr - 1 - n] = el->data;
+        types[program->num_attr - 1 - n] = el->type;
+    }
+    if (n < program->num_attr) {
+        AK_EPI;
+        return 0;
+    }
+    result = AK_expression_run(program, data, types);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that evaluates a compiled expression on a tuple, with the same outcome as
+ * AK_check_if_row_satisfies_compiled on the row list of the tuple. The values used are copied into zeroed buffers,
+ * because the evaluator reads operands as whole values of their type and compares up to MAX_VARCHAR_LENGTH bytes.
+ * @param program compiled expression
+ * @param tuple tuple of the schema the expression was compiled for, with a value for every attribute
+ * @return 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_check_tuple_satisfies_compiled(AK_compiled_expression *program, AK_tuple *tuple)
+{
+    char buffers[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH + 1];
+    char *data[MAX_ATTRIBUTES];
+    int types[MAX_ATTRIBUTES], copied[MAX_ATTRIBUTES];
+    AK_tuple_value *value;
+    int i, position, result;
+    AK_PRO;
+
+    if (program->always_false || tuple->num_values < program->num_attr) {
+        AK_EPI;
+        return 0;
+    }
+    memset(copied, 0, sizeof (copied));
+    for (i = 0; i < program->num_operands; i++) {
+        position = program->operands[i].position;
+        if (position == -1 || copied[position])
+            continue;
+        value = &tuple->values[position];
+        memset(buffers[position], 0, sizeof (buffers[position]));
+        memcpy(buffers[position], tuple->data + value->offset, value->length);
+        data[position] = buffers[position];
+        types[position] = value->type;
+        copied[position] = 1;
+    }
+    result = AK_expression_run(program, data, types);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that evaluates a compiled expression over all rows of a block at once. The values of the
+ * attributes are gathered from tuple_dict into typed arrays and every instruction runs over the whole array.
+ * @param program compiled expression
+ * @param block block of a table with the header the expression was compiled for
+ * @param selected set to 1 for every row of the block that satisfies the expression, 0 otherwise
+ * @return number of rows of the block, -1 if the block has to be evaluated row by row
+ */
+int AK_check_block_satisfies_compiled(AK_compiled_expression *program, AK_block *block, char *selected)
+{
+    AK_expression_instruction *instruction;
+    AK_expression_operand *operand;
+    AK_tuple_dict *entry;
+    char *values[3], *column, *result, *scratch;
+    int steps[3], operands[3], gathered[MAX_ATTRIBUTES];
+    int num_attr = program->num_attr, n, i, j, r, width;
+    AK_PRO;
+
+    if (!program->batch) {
+        AK_EPI;
+        return -1;
+    }
+    for (n = 0; n * num_attr < DATA_BLOCK_SIZE && block->tuple_dict[n * num_attr].type != FREE_INT; n++);
+    if (n * num_attr > DATA_BLOCK_SIZE) {
+        AK_EPI;
+        return -1;
+    }
+    if (program->always_false) {
+        memset(selected, 0, n);
+        AK_EPI;
+        return n;
+    }
+
+    if (program->columns == NULL) {
+        program->columns = (char **) AK_calloc(num_attr, sizeof (char *));
+        for (i = 0; i < program->num_operands; i++) {
+            operand = &program->operands[i];
+            if (operand->position != -1 && program->columns[operand->position] == NULL)
+                program->columns[operand->position] = (char *) AK_malloc(DATA_BLOCK_SIZE * AK_expression_width(operand->type));
+        }
+        /// one more vector for the second half of BETWEEN
+        program->batch_results = (char *) AK_malloc((program->num_instructions + 1) * DATA_BLOCK_SIZE);
+    }
+
+    /// gather the values of every attribute used, a row that does not fit the header is left to the row evaluator
+    memset(gathered, 0, sizeof (gathered));
+    for (i = 0; i < program->num_operands; i++) {
+        operand = &program->operands[i];
+        if (operand->position == -1 || gathered[operand->position])
+            continue;
+        gathered[operand->position] = 1;
+        column = program->columns[operand->position];
+        width = AK_expression_width(operand->type);
+        for (r = 0; r < n; r++) {
+            entry = &block->tuple_dict[r * num_attr + operand->position];
+            if (entry->type != operand->type) {
+                AK_EPI;
+                return -1;
+            }
+            if (operand->type == TYPE_VARCHAR) {
+                if (entry->size < 0 || entry->size > MAX_VARCHAR_LENGTH) {
+                    AK_EPI;
+                    return -1;
+                }
+                memcpy(column + r * width, &block->data[entry->address], entry->size);
+                column[r * width + entry->size] = '\0';
+            }
+            else {
+                if (entry->size != width) {
+                    AK_EPI;
+                    return -1;
+                }
+                memcpy(column + r * width, &block->data[entry->address], width);
+            }
+        }
+    }
+
+    scratch = program->batch_results + program->num_instructions * DATA_BLOCK_SIZE;
+    for (i = 0; i < program->num_instructions; i++) {
+        instruction = &program->instructions[i];
+        result = program->batch_results + i * DATA_BLOCK_SIZE;
+        operands[0] = instruction->a;
+        operands[1] = instruction->b;
+        operands[2] = instruction->c;
+        for (j = 0; j < 3; j++) {
+            if (operands[j] == -1)
+                continue;
+            operand = &program->operands[operands[j]];
+            if (operand->position == -1) {
+                values[j] = operand->data;
+                steps[j] = 0;
+            }
+            else {
+                values[j] = program->columns[operand->position];
+                steps[j] = AK_expression_width(operand->type);
+            }
+        }
+
+        switch (instruction->opcode) {
+            case AK_EXPR_CONSTANT:
+                memset(result, instruction->constant, n);
+                break;
+            case AK_EXPR_EQUAL:
+                AK_expression_compare_batch(TYPE_INT, AK_EXPR_EQ, values[0], steps[0], values[1], steps[1], n, result);
+                break;
+            case AK_EXPR_OR:
+                for (r = 0; r < n; r++)
+                    result[r] = program->batch_results[instruction->r1 * DATA_BLOCK_SIZE + r]
+                            || program->batch_results[instruction->r2 * DATA_BLOCK_SIZE + r];
+                break;
+            case AK_EXPR_AND:
+                for (r = 0; r < n; r++)
+                    result[r] = program->batch_results[instruction->r1 * DATA_BLOCK_SIZE + r]
+                            && program->batch_results[instruction->r2 * DATA_BLOCK_SIZE + r];
+                break;
+            case AK_EXPR_BETWEEN:
+                AK_expression_compare_batch(program->operands[instruction->c].type, AK_EXPR_GE, values[2], steps[2],
+                        values[0], steps[0], n, result);
+                AK_expression_compare_batch(program->operands[instruction->c].type, AK_EXPR_LE, values[2], steps[2],
+                        values[1], steps[1], n, scratch);
+                for (r = 0; r < n; r++)
+                    result[r] = result[r] && scratch[r];
+                break;
+            case AK_EXPR_COMPARE:
+                AK_expression_compare_batch(program->operands[instruction->b].type, instruction->op, values[0], steps[0],
+                        values[1], steps[1], n, result);
+                break;
+            case AK_EXPR_LIST:
+            case AK_EXPR_MEMBER:
+                for (r = 0; r < n; r++)
+                    result[r] = AK_expression_in_list(instruction, program->operands[instruction->b].type,
+                            values[0] + r * steps[0]);
+                break;
+            case AK_EXPR_REGEX:
+                for (r = 0; r < n; r++)
+                    result[r] = (regexec(instruction->regex, values[0] + r * steps[0], 0, NULL, 0) != REG_NOMATCH)
+                            != instruction->negate;
+                break;
+        }
+    }
+    memcpy(selected, program->batch_results + (program->num_instructions - 1) * DATA_BLOCK_SIZE, n);
+    AK_EPI;
+    return n;
+}
+
+/**
+ * @brief Function that frees a compiled expression
+ * @param program compiled expression, may be NULL
+ */
+void AK_free_compiled_expression(AK_compiled_expression *program)
+{
+    int i;
+    AK_PRO;
+    if (program == NULL) {
+        AK_EPI;
+        return;
+    }
+    for (i = 0; i < program->num_operands; i++)
+        AK_free(program->operands[i].data);
+    for (i = 0; i < program->num_instructions; i++) {
+        AK_free(program->instructions[i].list);
+        AK_free(program->instructions[i].hashes);
+        AK_free(program->instructions[i].set);
+        if (program->instructions[i].regex != NULL) {
+            regfree(program->instructions[i].regex);
+            AK_free(program->instructions[i].regex);
+        }
+    }
+    if (program->columns != NULL)
+        for (i = 0; i < program->num_attr; i++)
+            AK_free(program->columns[i]);
+    AK_free(program->columns);
+    AK_free(program->batch_results);
+    AK_free(program->operands);
+    AK_free(program->instructions);
+    AK_free(program);
+    AK_EPI;
+}
+
 //TODO: Add description
 TestResult AK_expression_check_test()
 {
@@ -1298,6 +2184,120 @@ TestResult AK_expression_check_test()
 	AK_free(attributes6);
 	AK_free(condition6);
 
+	printf("EXPRESSION CHECK TEST 3 (compiled expressions give the results of the interpreter, for rows and blocks):\n");
+
+	/// postfix expressions, INT and FLOAT constants are binary unless they hold a list
+	struct {
+		int type;
+		int binary;
+		const char *text;
+	} expressions[][7] = {
+		{{TYPE_ATTRIBS, 0, "id"}, {TYPE_INT, 1, "2"}, {TYPE_OPERATOR, 0, ">"}},
+		{{TYPE_ATTRIBS, 0, "weight"}, {TYPE_FLOAT, 1, "55.5"}, {TYPE_FLOAT, 1, "80"}, {TYPE_OPERATOR, 0, "BETWEEN"}},
+		{{TYPE_ATTRIBS, 0, "id"}, {TYPE_INT, 0, "1,3,5"}, {TYPE_OPERATOR, 0, "IN"}},
+		{{TYPE_ATTRIBS, 0, "name"}, {TYPE_VARCHAR, 0, "Ana,Ivo"}, {TYPE_OPERATOR, 0, "IN"}},
+		{{TYPE_ATTRIBS, 0, "weight"}, {TYPE_FLOAT, 0, "70,90.25"}, {TYPE_OPERATOR, 0, "!=ALL"}},
+		{{TYPE_ATTRIBS, 0, "id"}, {TYPE_INT, 0, "3,4"}, {TYPE_OPERATOR, 0, ">ANY"}},
+		{{TYPE_ATTRIBS, 0, "id"}, {TYPE_INT, 0, "2,3"}, {TYPE_OPERATOR, 0, "<=ALL"}},
+		{{TYPE_ATTRIBS, 0, "name"}, {TYPE_VARCHAR, 0, "%a"}, {TYPE_OPERATOR, 0, "LIKE"}},
+		{{TYPE_ATTRIBS, 0, "name"}, {TYPE_VARCHAR, 0, "i%"}, {TYPE_OPERATOR, 0, "NOT ILIKE"}},
+		{{TYPE_ATTRIBS, 0, "id"}, {TYPE_INT, 1, "2"}, {TYPE_OPERATOR, 0, "="}, {TYPE_ATTRIBS, 0, "name"},
+			{TYPE_VARCHAR, 0, "^M"}, {TYPE_OPERATOR, 0, "~"}, {TYPE_OPERATOR, 0, "OR"}},
+		{{TYPE_ATTRIBS, 0, "id"}, {TYPE_INT, 1, "4"}, {TYPE_OPERATOR, 0, "!="}, {TYPE_ATTRIBS, 0, "weight"},
+			{TYPE_FLOAT, 1, "75"}, {TYPE_OPERATOR, 0, "<"}, {TYPE_OPERATOR, 0, "AND"}},
+		{{TYPE_ATTRIBS, 0, "height"}, {TYPE_INT, 1, "1"}, {TYPE_OPERATOR, 0, ">"}}
+	};
+	int ids[] = {1, 2, 3, 4};
+	char *names[] = {"Ana", "Marina", "Ivo", "Mia"};
+	float weights[] = {55.5, 70, 80, 90.25};
+	AK_header compiled_header[3];
+	AK_compiled_expression *program;
+	struct list_node *compiled_expr, *row;
+	int e, t, r, int_value, mismatches = 0;
+	float float_value;
+
+	/// the same rows in a block, for AK_check_block_satisfies_compiled
+	AK_block *compiled_block = (AK_block *) AK_calloc(1, sizeof (AK_block));
+	char selected[DATA_BLOCK_SIZE];
+	int address = 0;
+
+	for (t = 0; t < DATA_BLOCK_SIZE; t++)
+		compiled_block->tuple_dict[t].type = FREE_INT;
+	for (r = 0; r < 4; r++) {
+		compiled_block->tuple_dict[3 * r].type = TYPE_INT;
+		compiled_block->tuple_dict[3 * r].size = sizeof (int);
+		compiled_block->tuple_dict[3 * r + 1].type = TYPE_VARCHAR;
+		compiled_block->tuple_dict[3 * r + 1].size = strlen(names[r]);
+		compiled_block->tuple_dict[3 * r + 2].type = TYPE_FLOAT;
+		compiled_block->tuple_dict[3 * r + 2].size = sizeof (float);
+		for (t = 0; t < 3; t++) {
+			compiled_block->tuple_dict[3 * r + t].address = address;
+			address += compiled_block->tuple_dict[3 * r + t].size;
+		}
+		memcpy(&compiled_block->data[compiled_block->tuple_dict[3 * r].address], &ids[r], sizeof (int));
+		memcpy(&compiled_block->data[compiled_block->tuple_dict[3 * r + 1].address], names[r], strlen(names[r]));
+		memcpy(&compiled_block->data[compiled_block->tuple_dict[3 * r + 2].address], &weights[r], sizeof (float));
+	}
+
+	memset(compiled_header, 0, sizeof (compiled_header));
+	strcpy(compiled_header[0].att_name, "id");
+	compiled_header[0].type = TYPE_INT;
+	strcpy(compiled_header[1].att_name, "name");
+	compiled_header[1].type = TYPE_VARCHAR;
+	strcpy(compiled_header[2].att_name, "weight");
+	compiled_header[2].type = TYPE_FLOAT;
+
+	for (e = 0; e < sizeof (expressions) / sizeof (expressions[0]); e++) {
+		compiled_expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+		AK_Init_L3(&compiled_expr);
+		for (t = 0; t < 7 && expressions[e][t].text != NULL; t++) {
+			if (expressions[e][t].binary && expressions[e][t].type == TYPE_INT) {
+				int_value = atoi(expressions[e][t].text);
+				AK_InsertAtEnd_L3(TYPE_INT, (char *) &int_value, sizeof (int), compiled_expr);
+			}
+			else if (expressions[e][t].binary) {
+				float_value = atof(expressions[e][t].text);
+				AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &float_value, sizeof (float), compiled_expr);
+			}
+			else
+				AK_InsertAtEnd_L3(expressions[e][t].type, (char *) expressions[e][t].text,
+						strlen(expressions[e][t].text) + 1, compiled_expr);
+		}
+		program = AK_compile_expression(compiled_expr, compiled_header, 3);
+		if (program == NULL)
+			mismatches++;
+		/// every expression here compares values of one type, so whole blocks can be evaluated for it
+		else if (!program->batch || AK_check_block_satisfies_compiled(program, compiled_block, selected) != 4) {
+			printf("Expression %d is not evaluated over the block\n", e);
+			mismatches++;
+		}
+		for (r = 0; r < 4 && program != NULL; r++) {
+			/// the interpreter also looks at the root of the row, so it must not hold an attribute name
+			row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+			AK_Init_L3(&row);
+			AK_Insert_New_Element(TYPE_INT, &ids[r], "compiled", "id", row);
+			AK_Insert_New_Element(TYPE_VARCHAR, names[r], "compiled", "name", row);
+			AK_Insert_New_Element(TYPE_FLOAT, &weights[r], "compiled", "weight", row);
+			if (AK_check_if_row_satisfies_compiled(program, row) != AK_check_if_row_satisfies_expression(row, compiled_expr)) {
+				printf("Expression %d gives a different result on row %d\n", e, r);
+				mismatches++;
+			}
+			if (program->batch && selected[r] != AK_check_if_row_satisfies_compiled(program, row)) {
+				printf("Expression %d gives a different result for row %d of the block\n", e, r);
+				mismatches++;
+			}
+			AK_DeleteAll_L3(&row);
+			AK_free(row);
+		}
+		AK_free_compiled_expression(program);
+		AK_DeleteAll_L3(&compiled_expr);
+		AK_free(compiled_expr);
+	}
+	AK_free(compiled_block);
+	if (mismatches == 0)
+		successful++;
+	else
+		failed++;
 
     AK_EPI;
     return TEST_result(successful, failed);
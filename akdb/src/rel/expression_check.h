@@ -24,7 +24,66 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "../file/idx/hash.h"
 #include <regex.h>
+
+/**
+ * @struct AK_expression_operand
+ * @brief Value used by a compiled expression: an attribute of the row, bound to its position, or a constant
+ */
+typedef struct {
+    /// position of the attribute in the row, -1 for a constant
+    int position;
+    /// type of the constant or of the attribute in the header, size of a constant, whose value is kept in a zeroed
+    /// buffer of MAX_VARCHAR_LENGTH bytes
+    int type;
+    int size;
+    char *data;
+} AK_expression_operand;
+
+/**
+ * @struct AK_expression_instruction
+ * @brief Operator of a compiled expression. Every instruction gives one result, the results are numbered like
+ * the instructions.
+ */
+typedef struct {
+    /// AK_EXPR_* operation, comparison operator and 1 if the outcome is negated
+    int opcode;
+    int op;
+    int negate;
+    /// value operands in the order the interpreter takes them (c a b), -1 if not used
+    int a, b, c;
+    /// results combined by AND and OR, the outcome of AK_EXPR_CONSTANT
+    int r1, r2;
+    int constant;
+    /// values of an IN, ANY or ALL list, MAX_VARCHAR_LENGTH bytes each, and a hash set over them (-1 for free)
+    char *list;
+    int list_size;
+    uint64_t *hashes;
+    int *set;
+    int set_size;
+    /// pattern of LIKE and the regular expression operators
+    regex_t *regex;
+} AK_expression_instruction;
+
+/**
+ * @struct AK_compiled_expression
+ * @brief Postfix expression compiled against the attributes of a row by AK_compile_expression
+ */
+typedef struct {
+    AK_expression_operand *operands;
+    int num_operands;
+    AK_expression_instruction *instructions;
+    int num_instructions;
+    /// number of attributes of the header
+    int num_attr;
+    int always_false;
+    /// 1 if AK_check_block_satisfies_compiled can evaluate the expression over whole blocks
+    int batch;
+    /// typed values of the attributes used, for the rows of a block, and the results of every instruction for them
+    char **columns;
+    char *batch_results;
+} AK_compiled_expression;
 /*
 int AK_check_arithmetic_statement(AK_list_elem el, const char *op, const char *a, const char *b);
 int AK_check_if_row_satisfies_expression(AK_list_elem row_root, AK_list *expr);
@@ -70,6 +129,52 @@ int AK_check_regex_expression(const char *value,const char *expression,int sensi
 			  1 if string matches coresponding regex expression
 */
 int AK_check_regex_operator_expression(const char *value,const char *expression);
+
+/**
+ * @brief Function that compiles a postfix expression for rows whose attributes are those of a header. Such rows
+ * are built by AK_Insert_New_Element on the list root in header order, so they hold the attributes last first.
+ * Attributes are bound to their positions, IN, ANY and ALL lists are parsed once and LIKE patterns and regular
+ * expressions are compiled once.
+ * @param expr list with the logical expression in postfix notation
+ * @param header attributes of the rows
+ * @param num_attr number of attributes
+ * @return compiled expression, NULL if it has to be left to AK_check_if_row_satisfies_expression
+ */
+AK_compiled_expression *AK_compile_expression(struct list_node *expr, AK_header *header, int num_attr);
+
+/**
+ * @brief Function that evaluates a compiled expression on a row, with the same outcome as
+ * AK_check_if_row_satisfies_expression on the expression it was compiled from
+ * @param program compiled expression
+ * @param row_root row with the attributes of the header the expression was compiled for
+ * @return 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_check_if_row_satisfies_compiled(AK_compiled_expression *program, struct list_node *row_root);
+
+/**
+ * @brief Function that evaluates a compiled expression over all rows of a block at once. The values of the
+ * attributes are gathered from tuple_dict into typed arrays and every instruction runs over the whole array.
+ * @param program compiled expression
+ * @param block block of a table with the header the expression was compiled for
+ * @param selected set to 1 for every row of the block that satisfies the expression, 0 otherwise
+ * @return number of rows of the block, -1 if the block has to be evaluated row by row
+ */
+int AK_check_block_satisfies_compiled(AK_compiled_expression *program, AK_block *block, char *selected);
+
+/**
+ * @brief Function that evaluates a compiled expression on a tuple, with the same outcome as
+ * AK_check_if_row_satisfies_compiled on the row list of the tuple
+ * @param program compiled expression
+ * @param tuple tuple of the schema the expression was compiled for
+ * @return 0 if row does not satisfy, 1 if row satisfies expression
+ */
+int AK_check_tuple_satisfies_compiled(AK_compiled_expression *program, AK_tuple *tuple);
+
+/**
+ * @brief Function that frees a compiled expression
+ * @param program compiled expression, may be NULL
+ */
+void AK_free_compiled_expression(AK_compiled_expression *program);
 TestResult AK_expression_check_test();
 
 #endif /* CONSTRAINT_CHECKER_H_ */
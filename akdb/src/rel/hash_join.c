@@ -0,0 +1,414 @@
+/**
+@file hash_join.c Provides functions for the hash join of two tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "hash_join.h"
+
+/*
+ * The input with fewer rows is the build side: its rows are copied into an arena and chained by the hash of their
+ * key attributes. The other input is read once and every row follows the chain of its hash. When the build side
+ * does not fit into WORK_MEMORY, both inputs are split by the hash of their keys into AK_HASH_JOIN_PARTITIONS
+ * temporary segments and every pair of partitions is joined the same way (grace hash join). The in-memory table
+ * takes the low bits of the hash and every level of partitioning takes the next three high bits.
+ */
+
+static int AK_hash_join_run(AK_join_spec *spec, char **tables, int build, int depth);
+
+/**
+ * @brief Function that computes the hash of the key attributes of a row
+ * @param values values of the row
+ * @param keys positions of the key attributes
+ * @param num_keys number of key attributes
+ * @return hash value
+ */
+uint64_t AK_hash_join_key(AK_value *values, int *keys, int num_keys)
+{
+    uint64_t hash = 0;
+    int i;
+    AK_PRO;
+
+    for (i = 0; i < num_keys; i++)
+        hash = AK_hash_bytes(values[keys[i]].data, AK_tuple_key_size(&values[keys[i]]), hash);
+    AK_EPI;
+    return hash;
+}
+
+/**
+ * @brief Function that compares the key attributes of a row of the first and a row of the second table
+ * @param spec join
+ * @param values values of both rows, indexed by side
+ * @return 1 if all keys are equal, 0 otherwise
+ */
+int AK_hash_join_keys_equal(AK_join_spec *spec, AK_value **values)
+{
+    AK_value *a, *b;
+    int i, size;
+    AK_PRO;
+
+    for (i = 0; i < spec->num_keys; i++)
+    {
+        a = &values[0][spec->keys[0][i]];
+        b = &values[1][spec->keys[1][i]];
+        size = AK_tuple_key_size(a);
+        if (a->type != b->type || AK_tuple_key_size(b) != size || memcmp(a->data, b->data, size) != 0)
+        {
+            AK_EPI;
+            return 0;
+        }
+    }
+    AK_EPI;
+    return 1;
+}
+
+/**
+ * @brief Function that copies a row into the arena of a hash table
+ * @param table hash table, zeroed before the first row
+ * @param values values of the row
+ * @param num_values number of values
+ * @param hash hash of the key attributes of the row
+ */
+void AK_hash_join_add_row(AK_hash_join_table *table, AK_value *values, int num_values, uint64_t hash)
+{
+    int row;
+    AK_PRO;
+
+    row = AK_tuple_arena_add(&table->arena, values, num_values);
+    if (row == table->rows_capacity)
+    {
+        table->rows_capacity = table->rows_capacity ? table->rows_capacity * 2 : 64;
+        table->rows = (AK_hash_join_row *) AK_realloc(table->rows, table->rows_capacity * sizeof (AK_hash_join_row));
+    }
+    table->rows[row].hash = hash;
+    AK_EPI;
+}
+
+/**
+ * @brief Function that gives the memory a hash table holds for its rows
+ * @param table hash table
+ * @return size in bytes
+ */
+long AK_hash_join_table_size(AK_hash_join_table *table)
+{
+    AK_PRO;
+    AK_EPI;
+    return table->arena.size + (long) table->arena.num_rows * (sizeof (int) + sizeof (AK_hash_join_row));
+}
+
+/**
+ * @brief Function that chains the rows of the build side into buckets, after the last row is added
+ * @param table hash table
+ */
+void AK_hash_join_chain(AK_hash_join_table *table)
+{
+    int i, bucket;
+    AK_PRO;
+
+    for (table->num_buckets = 16; table->num_buckets < table->arena.num_rows; table->num_buckets *= 2);
+    table->buckets = (int *) AK_malloc(table->num_buckets * sizeof (int));
+    for (i = 0; i < table->num_buckets; i++)
+        table->buckets[i] = -1;
+    /// rows are chained backwards so a chain lists them in the order they were read
+    for (i = table->arena.num_rows - 1; i >= 0; i--)
+    {
+        bucket = table->rows[i].hash & (table->num_buckets - 1);
+        table->rows[i].next = table->buckets[bucket];
+        table->buckets[bucket] = i;
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief Function that gives the first row of the chain of a hash
+ * @param table chained hash table
+ * @param hash hash of the key attributes of a probing row
+ * @return row number, -1 for none
+ */
+int AK_hash_join_probe(AK_hash_join_table *table, uint64_t hash)
+{
+    AK_PRO;
+    AK_EPI;
+    return table->num_buckets > 0 ? table->buckets[hash & (table->num_buckets - 1)] : -1;
+}
+
+/**
+ * @brief Function that finds the next row of the build side whose key attributes equal the ones of a probing row
+ * @param spec join
+ * @param table chained hash table
+ * @param build side of the rows of the hash table
+ * @param values values of both rows indexed by side, the values of the probing row are set, the ones of the
+ * build side are pointed at the row found
+ * @param hash hash of the key attributes of the probing row
+ * @param candidate next row of the chain to check, from AK_hash_join_probe; set to the one after the row found
+ * @return 1 if a row was found, 0 at the end of the chain
+ */
+int AK_hash_join_match(AK_join_spec *spec, AK_hash_join_table *table, int build, AK_value **values, uint64_t hash, int *candidate)
+{
+    int i;
+    AK_PRO;
+
+    while ((i = *candidate) != -1)
+    {
+        *candidate = table->rows[i].next;
+        if (table->rows[i].hash != hash)
+            continue;
+        AK_tuple_arena_values(&table->arena, i, values[build]);
+        if (AK_hash_join_keys_equal(spec, values))
+        {
+            AK_EPI;
+            return 1;
+        }
+    }
+    AK_EPI;
+    return 0;
+}
+
+/**
+ * @brief Function that frees the memory of a hash table
+ * @param table hash table
+ */
+void AK_hash_join_free(AK_hash_join_table *table)
+{
+    AK_PRO;
+    AK_tuple_arena_free(&table->arena);
+    AK_free(table->rows);
+    AK_free(table->buckets);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that writes a joined row into the result table
+ * @param spec join
+ * @param values values of the row of the first and of the second table
+ */
+void AK_join_emit(AK_join_spec *spec, AK_value **values)
+{
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_value *value;
+    char data[MAX_VARCHAR_LENGTH + 1];
+    int i;
+
+    AK_Init_L3(&row_root);
+    for (i = 0; i < spec->num_columns; i++)
+    {
+        value = &values[spec->columns[i].side][spec->columns[i].position];
+        memset(data, 0, sizeof (data));
+        memcpy(data, value->data, value->size < MAX_VARCHAR_LENGTH ? value->size : MAX_VARCHAR_LENGTH);
+        AK_Insert_New_Element(value->type, data, spec->dstTable, spec->columns[i].name, row_root);
+    }
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+}
+
+/**
+ * @brief Function that names a temporary partition of a join input after the result table
+ * @param name partition name, MAX_ATT_NAME bytes
+ * @param dstTable result table
+ * @param depth partitioning level
+ * @param side input the partition holds rows of
+ * @param partition partition number
+ * @return length of the whole name, MAX_ATT_NAME or more if it was cut
+ */
+static int AK_hash_join_partition_name(char *name, char *dstTable, int depth, int side, int partition)
+{
+    return snprintf(name, MAX_ATT_NAME, "%s_hj%d_%d_%d", dstTable, depth, side, partition);
+}
+
+/**
+ * @brief Function that splits both inputs of a join into temporary segments by the hash of their keys and joins
+ * every pair of partitions
+ * @param spec join
+ * @param tables names of the first and of the second input
+ * @param depth number of times the inputs were already partitioned
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_partition(AK_join_spec *spec, char **tables, int depth)
+{
+    char names[2][AK_HASH_JOIN_PARTITIONS][MAX_ATT_NAME];
+    int counts[2][AK_HASH_JOIN_PARTITIONS];
+    AK_value values[MAX_ATTRIBUTES];
+    AK_header *header;
+    AK_row_cursor cursor;
+    struct list_node *row, *row_root;
+    char *partition[2];
+    int side, p, n, result = EXIT_SUCCESS;
+
+    AK_dbg_messg(LOW, REL_OP, "AK_hash_join: %s does not fit into %d KB, partitioning level %d\n", tables[0], WORK_MEMORY, depth);
+    memset(counts, 0, sizeof (counts));
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    for (side = 0; side < 2; side++)
+    {
+        header = (AK_header *) AK_get_header(tables[side]);
+        AK_row_cursor_open(&cursor, tables[side]);
+        while ((row = AK_row_cursor_next(&cursor)) != NULL)
+        {
+            n = AK_tuple_row_values(row, values);
+            p = AK_tuple_partition(AK_hash_join_key(values, spec->keys[side], spec->num_keys), depth);
+            /// partitions are created when their first row arrives
+            if (counts[side][p]++ == 0)
+            {
+                AK_hash_join_partition_name(names[side][p], spec->dstTable, depth, side, p);
+                AK_initialize_new_segment(names[side][p], SEGMENT_TYPE_TABLE, header);
+            }
+            AK_tuple_insert_values(names[side][p], header, values, n, row_root);
+            AK_DeleteAll_L3(&row);
+            AK_free(row);
+        }
+        AK_free(header);
+    }
+    AK_free(row_root);
+
+    for (p = 0; p < AK_HASH_JOIN_PARTITIONS; p++)
+    {
+        if (counts[0][p] > 0 && counts[1][p] > 0)
+        {
+            partition[0] = names[0][p];
+            partition[1] = names[1][p];
+            if (AK_hash_join_run(spec, partition, counts[1][p] < counts[0][p], depth + 1) != EXIT_SUCCESS)
+                result = EXIT_ERROR;
+        }
+        for (side = 0; side < 2; side++)
+            if (counts[side][p] > 0)
+                AK_delete_segment(names[side][p], SEGMENT_TYPE_TABLE);
+    }
+    return result;
+}
+
+/**
+ * @brief Function that joins two inputs, building the hash table on one of them and probing it with the other
+ * @param spec join
+ * @param tables names of the first and of the second input
+ * @param build 0 to build on the first input, 1 to build on the second
+ * @param depth number of times the inputs were already partitioned
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_run(AK_join_spec *spec, char **tables, int build, int depth)
+{
+    AK_hash_join_table table;
+    AK_value build_values[MAX_ATTRIBUTES], probe_values[MAX_ATTRIBUTES];
+    AK_value *values[2];
+    AK_row_cursor cursor;
+    struct list_node *row;
+    long budget = (long) WORK_MEMORY * 1024;
+    uint64_t hash;
+    int n, i, probe = 1 - build;
+
+    memset(&table, 0, sizeof (AK_hash_join_table));
+    AK_row_cursor_open(&cursor, tables[build]);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        n = AK_tuple_row_values(row, build_values);
+        AK_hash_join_add_row(&table, build_values, n, AK_hash_join_key(build_values, spec->keys[build], spec->num_keys));
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+        if (depth < AK_HASH_JOIN_MAX_DEPTH && AK_hash_join_table_size(&table) > budget)
+        {
+            AK_hash_join_free(&table);
+            return AK_hash_join_partition(spec, tables, depth);
+        }
+    }
+    AK_hash_join_chain(&table);
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_hash_join: %d rows of %s in %d buckets\n", table.arena.num_rows, tables[build], table.num_buckets);
+
+    values[build] = build_values;
+    values[probe] = probe_values;
+    AK_row_cursor_open(&cursor, tables[probe]);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        AK_tuple_row_values(row, probe_values);
+        hash = AK_hash_join_key(probe_values, spec->keys[probe], spec->num_keys);
+        i = AK_hash_join_probe(&table, hash);
+        while (AK_hash_join_match(spec, &table, build, values, hash, &i))
+            AK_join_emit(spec, values);
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    AK_hash_join_free(&table);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that joins two tables on equal key attributes into an existing result table. The table with
+ * fewer rows is held in a hash table and the other one is read once, so every table is read once unless the
+ * smaller one does not fit into WORK_MEMORY and both are partitioned first.
+ * @param spec tables, key attributes and result attributes of the join
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_hash_join(AK_join_spec *spec)
+{
+    char name[MAX_ATT_NAME];
+    int rows[2], i, result;
+    AK_PRO;
+
+    /// a cut partition name could be the name of another segment, so such a join is not run
+    if (AK_hash_join_partition_name(name, spec->dstTable, AK_HASH_JOIN_MAX_DEPTH, 1, AK_HASH_JOIN_PARTITIONS - 1) >= MAX_ATT_NAME)
+    {
+        AK_dbg_messg(LOW, REL_OP, "AK_hash_join: name of table %s is too long\n", spec->dstTable);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        rows[i] = AK_get_num_records(spec->table[i]);
+        if (rows[i] < 0)
+            rows[i] = 0;
+    }
+    result = AK_hash_join_run(spec, spec->table, rows[1] < rows[0], 0);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that counts the pairs of rows of two tables with equal values of an attribute by comparing every
+ * row of the first table with every row of the second one, the result the join tests check the joins against
+ * @param srcTable1 first table
+ * @param attName1 attribute of the first table
+ * @param srcTable2 second table
+ * @param attName2 attribute of the second table
+ * @return number of pairs
+ */
+int AK_join_nested_loop_count(char *srcTable1, char *attName1, char *srcTable2, char *attName2)
+{
+    AK_row_cursor outer, inner;
+    struct list_node *row1, *row2, *value1, *value2;
+    int pos1, pos2, count = 0;
+    AK_PRO;
+
+    pos1 = AK_get_attr_index(srcTable1, attName1) + 1;
+    pos2 = AK_get_attr_index(srcTable2, attName2) + 1;
+    AK_row_cursor_open(&outer, srcTable1);
+    while ((row1 = AK_row_cursor_next(&outer)) != NULL)
+    {
+        value1 = AK_GetNth_L2(pos1, row1);
+        AK_row_cursor_open(&inner, srcTable2);
+        while ((row2 = AK_row_cursor_next(&inner)) != NULL)
+        {
+            value2 = AK_GetNth_L2(pos2, row2);
+            if (value1->type == value2->type && value1->size == value2->size && memcmp(value1->data, value2->data, value1->size) == 0)
+                count++;
+            AK_DeleteAll_L3(&row2);
+            AK_free(row2);
+        }
+        AK_DeleteAll_L3(&row1);
+        AK_free(row1);
+    }
+    AK_EPI;
+    return count;
+}
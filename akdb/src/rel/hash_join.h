@@ -0,0 +1,109 @@
+/**
+@file hash_join.h Header file that provides data structures for equi-joins and functions for the hash join of two tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef HASH_JOIN
+#define HASH_JOIN
+
+#include "../auxi/test.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../file/tuple.h"
+#include "../file/idx/hash.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @def AK_HASH_JOIN_PARTITIONS
+ * @brief Number of partitions an input is split into when the build side does not fit into WORK_MEMORY
+ */
+#define AK_HASH_JOIN_PARTITIONS AK_TUPLE_PARTITIONS
+
+/**
+ * @def AK_HASH_JOIN_MAX_DEPTH
+ * @brief Number of times a partition may be partitioned again, deeper partitions are joined in memory regardless
+ */
+#define AK_HASH_JOIN_MAX_DEPTH 4
+
+/**
+ * @struct AK_join_column
+ * @brief Attribute of the result of an equi-join
+ */
+typedef struct {
+    /// 0 for the first table, 1 for the second one
+    int side;
+    /// position of the attribute in that table
+    int position;
+    /// name of the attribute in the result table
+    char name[MAX_ATT_NAME];
+} AK_join_column;
+
+/**
+ * @struct AK_join_spec
+ * @brief Equi-join of two tables: the rows whose key attributes are equal are joined into the result table
+ */
+typedef struct {
+    char *table[2];
+    int num_keys;
+    /// positions of the key attributes in the first and in the second table
+    int keys[2][MAX_ATTRIBUTES];
+    /// "<", "<=", ">" or ">=" if the range attribute of the first table also has to compare so with the one of the
+    /// second table, an empty string otherwise; only AK_merge_join joins on a range
+    char range_op[3];
+    /// positions of the range attributes in the first and in the second table
+    int range[2];
+    int num_columns;
+    AK_join_column columns[2 * MAX_ATTRIBUTES];
+    char *dstTable;
+} AK_join_spec;
+
+/**
+ * @struct AK_hash_join_row
+ * @brief Row of the build side of a hash join: the hash of its key attributes and the next row of its chain, -1 for none
+ */
+typedef struct {
+    uint64_t hash;
+    int next;
+} AK_hash_join_row;
+
+/**
+ * @struct AK_hash_join_table
+ * @brief Hash table on the build side of a hash join. Rows are added, chained once after the last one and probed.
+ */
+typedef struct {
+    /// values of the rows, a row has the same number in the arena and in rows
+    AK_tuple_arena arena;
+    AK_hash_join_row *rows;
+    int rows_capacity;
+    /// first row of every chain, -1 for none, the number of buckets is a power of two
+    int *buckets;
+    int num_buckets;
+} AK_hash_join_table;
+
+uint64_t AK_hash_join_key(AK_value *values, int *keys, int num_keys);
+int AK_hash_join_keys_equal(AK_join_spec *spec, AK_value **values);
+void AK_hash_join_add_row(AK_hash_join_table *table, AK_value *values, int num_values, uint64_t hash);
+long AK_hash_join_table_size(AK_hash_join_table *table);
+void AK_hash_join_chain(AK_hash_join_table *table);
+int AK_hash_join_probe(AK_hash_join_table *table, uint64_t hash);
+int AK_hash_join_match(AK_join_spec *spec, AK_hash_join_table *table, int build, AK_value **values, uint64_t hash, int *candidate);
+void AK_hash_join_free(AK_hash_join_table *table);
+void AK_join_emit(AK_join_spec *spec, AK_value **values);
+int AK_hash_join(AK_join_spec *spec);
+int AK_join_nested_loop_count(char *srcTable1, char *attName1, char *srcTable2, char *attName2);
+
+#endif
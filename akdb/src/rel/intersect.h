@@ -25,6 +25,8 @@
 #include "../rec/archive_log.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "set_operation.h"
+#include "union.h"
 
 /**
  * @author Dino Laktašić
@@ -40,8 +42,8 @@ typedef struct {
 
 /**
  * @author Dino Laktašić
- * @brief  Function that makes a intersect of the two tables. Intersect is implemented for working with multiple sets of data, i.e. duplicate 
-          tuples can be written in same table (intersect)
+ * @brief  Function that makes a intersect of the two tables. The rows of both tables are hashed, so every table is
+ *         read once and every row that is in both tables is written once into dstTable (see AK_set_operation)
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
@@ -0,0 +1,1305 @@
+/**
+@file iterator.c Provides a pipelined executor of relational operators
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "iterator.h"
+
+/*
+ * Every operator writes its whole result into a table, so a query like AK_select writes and reads back a table
+ * for each of its steps. Operators of a pipeline instead pass tuples to each other: the last one is asked for a
+ * row, asks its inputs for as many rows as it needs and gives the row back without writing it anywhere. Only
+ * operators that cannot give a row before they have seen all of their input keep rows: a sort holds its input
+ * in memory, a join the rows of its right input, an aggregation its groups. When those do not fit into WORK_MEMORY
+ * the rows are written into a temporary segment and sorted, joined or aggregated by AK_sort_table, AK_hash_join or
+ * AK_aggregation, which spill to disk themselves, and the result is read back by a scan.
+ *
+ * An operator is built on top of its inputs and takes them over; AK_iterator_free frees the whole pipeline. If a
+ * constructor gives NULL, its inputs are left to the caller.
+ */
+
+/// number of temporary segments created so far, used for their names
+static int AK_iterator_temp_counter = 0;
+
+/**
+ * @brief State of a scan
+ */
+typedef struct {
+    char table[MAX_ATT_NAME];
+    AK_row_cursor cursor;
+    AK_tuple *tuple;
+} AK_iterator_scan_state;
+
+/**
+ * @brief State of a filter
+ */
+typedef struct {
+    struct list_node *expr;
+    /// expr compiled for the attributes of the input, NULL if it is interpreted
+    AK_compiled_expression *program;
+} AK_iterator_filter_state;
+
+/**
+ * @brief State of a projection
+ */
+typedef struct {
+    /// position in the input of every attribute of the result
+    int positions[MAX_ATTRIBUTES];
+    AK_tuple *tuple;
+} AK_iterator_project_state;
+
+/**
+ * @brief State of a limit
+ */
+typedef struct {
+    int limit;
+    int count;
+} AK_iterator_limit_state;
+
+/**
+ * @brief State of a sort
+ */
+typedef struct {
+    AK_sort_key keys[MAX_ATTRIBUTES];
+    int num_keys;
+    /// rows held in memory, in sorted order after open
+    AK_tuple **rows;
+    int num_rows;
+    int rows_capacity;
+    int position;
+    /// scan of the sorted temporary segment when the rows did not fit into WORK_MEMORY
+    AK_iterator *spilled;
+    char sorted[MAX_ATT_NAME];
+} AK_iterator_sort_state;
+
+/**
+ * @brief State of a join
+ */
+typedef struct {
+    /// keys and result attributes; the tables and the result table are only set when AK_hash_join joins the inputs
+    AK_join_spec spec;
+    /// rows of the right input held by a hash join
+    AK_hash_join_table table;
+    /// values of the current row of the left input and of the right row joined with it, indexed by side
+    AK_value row_values[2][MAX_ATTRIBUTES];
+    AK_value *values[2];
+    /// row of the left input being joined, hash of its keys and the next candidate row
+    AK_tuple *left;
+    uint64_t hash;
+    int candidate;
+    AK_tuple *tuple;
+    /// scan of the result of AK_hash_join when the right input did not fit into WORK_MEMORY
+    AK_iterator *spilled;
+    char joined[MAX_ATT_NAME];
+    /// nested loop join: 1 once the right input has to be read again for the next left row
+    int rescan;
+    /// merge join: merge of the sorted inputs
+    AK_merge_join_state merge;
+} AK_iterator_join_state;
+
+/**
+ * @brief State of an aggregation
+ */
+typedef struct {
+    AK_agg_input aggregation;
+    /// groups held in memory
+    AK_agg_stream *stream;
+    int num_groups;
+    int position;
+    AK_tuple *tuple;
+    /// scan of the result of AK_aggregation over the rows whose groups did not fit into WORK_MEMORY
+    AK_iterator *spilled;
+    char aggregated[MAX_ATT_NAME];
+} AK_iterator_aggregate_state;
+
+/**
+ * @brief Function that creates an operator of a pipeline
+ * @param schema attributes of the rows it gives, freed with the operator
+ * @param state state, freed with AK_free unless the free function of the operator is set
+ * @param open function that prepares the operator, called after its inputs are opened, may be NULL
+ * @param next function that gives the next row or NULL after the last one
+ * @param close function that releases what open took, called before its inputs are closed, may be NULL
+ * @return operator
+ */
+AK_iterator *AK_iterator_create(AK_tuple_schema *schema, void *state, int (*open)(AK_iterator *),
+        AK_tuple *(*next)(AK_iterator *), void (*close)(AK_iterator *))
+{
+    AK_iterator *iterator;
+    AK_PRO;
+    iterator = (AK_iterator *) AK_calloc(1, sizeof (AK_iterator));
+    iterator->schema = schema;
+    iterator->state = state;
+    iterator->open = open;
+    iterator->next = next;
+    iterator->close = close;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that opens an operator and its inputs
+ * @param iterator operator
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_iterator_open(AK_iterator *iterator)
+{
+    int i;
+    AK_PRO;
+    for (i = 0; i < 2; i++) {
+        if (iterator->input[i] != NULL && AK_iterator_open(iterator->input[i]) != EXIT_SUCCESS) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    i = iterator->open != NULL ? iterator->open(iterator) : EXIT_SUCCESS;
+    AK_EPI;
+    return i;
+}
+
+/**
+ * @brief Function that gives the next row of an open operator
+ * @param iterator operator
+ * @return row, valid until the next call, NULL after the last row
+ */
+AK_tuple *AK_iterator_next(AK_iterator *iterator)
+{
+    AK_tuple *tuple;
+    AK_PRO;
+    tuple = iterator->next(iterator);
+    AK_EPI;
+    return tuple;
+}
+
+/**
+ * @brief Function that closes an operator and its inputs
+ * @param iterator operator
+ */
+void AK_iterator_close(AK_iterator *iterator)
+{
+    int i;
+    AK_PRO;
+    if (iterator->close != NULL)
+        iterator->close(iterator);
+    for (i = 0; i < 2; i++)
+        if (iterator->input[i] != NULL)
+            AK_iterator_close(iterator->input[i]);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that frees a closed operator with its inputs
+ * @param iterator operator, may be NULL
+ */
+void AK_iterator_free(AK_iterator *iterator)
+{
+    int i;
+    AK_PRO;
+    if (iterator == NULL) {
+        AK_EPI;
+        return;
+    }
+    for (i = 0; i < 2; i++)
+        AK_iterator_free(iterator->input[i]);
+    if (iterator->free != NULL)
+        iterator->free(iterator);
+    else
+        AK_free(iterator->state);
+    AK_tuple_schema_free(iterator->schema);
+    AK_free(iterator);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that gives a name for a temporary segment of an operator
+ * @param iterator operator
+ * @param suffix part of the name that tells what the segment is for
+ * @param name name, MAX_ATT_NAME bytes
+ */
+void AK_iterator_temp_name(AK_iterator *iterator, const char *suffix, char *name)
+{
+    int length;
+    AK_PRO;
+    length = snprintf(name, MAX_ATT_NAME, "%s%d__", suffix, AK_iterator_temp_counter++);
+    /// the counter comes before the table name, so a long table name is cut and the name stays unique
+    strncat(name, iterator->schema->table, MAX_ATT_NAME - 1 - length);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that copies a schema
+ * @param schema schema
+ * @return copy, to be freed with AK_tuple_schema_free
+ */
+static AK_tuple_schema *AK_iterator_copy_schema(AK_tuple_schema *schema)
+{
+    AK_tuple_schema *copy = (AK_tuple_schema *) AK_malloc(sizeof (AK_tuple_schema));
+    memcpy(copy, schema, sizeof (AK_tuple_schema));
+    return copy;
+}
+
+/**
+ * @brief Function that copies a tuple
+ * @param tuple tuple
+ * @param schema schema of the copy
+ * @return copy, to be freed with AK_tuple_free
+ */
+static AK_tuple *AK_iterator_copy_tuple(AK_tuple *tuple, AK_tuple_schema *schema)
+{
+    AK_tuple *copy = AK_tuple_create(schema);
+    copy->num_values = tuple->num_values;
+    memcpy(copy->values, tuple->values, tuple->num_values * sizeof (AK_tuple_value));
+    copy->size = copy->capacity = tuple->size;
+    copy->data = (char *) AK_malloc(tuple->size + 1);
+    memcpy(copy->data, tuple->data, tuple->size);
+    return copy;
+}
+
+/**
+ * @brief Function that inserts a tuple into a table
+ * @param tuple tuple
+ * @param dstTable table with the attributes of the schema of the tuple
+ * @param row_root empty list used for the row
+ */
+static void AK_iterator_insert_tuple(AK_tuple *tuple, char *dstTable, struct list_node *row_root)
+{
+    char data[MAX_VARCHAR_LENGTH + 1];
+    AK_tuple_value *value;
+    int i;
+
+    for (i = 0; i < tuple->num_values; i++) {
+        value = &tuple->values[i];
+        memset(data, 0, sizeof (data));
+        memcpy(data, tuple->data + value->offset, value->length);
+        AK_Insert_New_Element(value->type, data, dstTable, tuple->schema->header[value->ordinal].att_name, row_root);
+    }
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+}
+
+/**
+ * @brief Function that writes rows into a new temporary segment
+ * @param iterator operator the rows come from
+ * @param suffix part of the name of the segment
+ * @param rows rows held in memory as tuples, written first
+ * @param num_rows number of rows held as tuples
+ * @param arena rows held in memory in an arena, written next, NULL for none
+ * @param input operator whose remaining rows are written after them, NULL for none
+ * @param name name of the segment
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_spill(AK_iterator *iterator, const char *suffix, AK_tuple **rows, int num_rows,
+        AK_tuple_arena *arena, AK_iterator *input, char *name)
+{
+    AK_header *header = input != NULL ? input->schema->header : iterator->schema->header;
+    AK_value values[MAX_ATTRIBUTES];
+    struct list_node *row_root;
+    AK_tuple *tuple;
+    int i;
+
+    AK_iterator_temp_name(iterator, suffix, name);
+    if (AK_initialize_new_segment(name, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR)
+        return EXIT_ERROR;
+    row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    for (i = 0; i < num_rows; i++)
+        AK_iterator_insert_tuple(rows[i], name, row_root);
+    for (i = 0; arena != NULL && i < arena->num_rows; i++)
+        AK_tuple_insert_values(name, header, values, AK_tuple_arena_values(arena, i, values), row_root);
+    while (input != NULL && (tuple = AK_iterator_next(input)) != NULL)
+        AK_iterator_insert_tuple(tuple, name, row_root);
+    AK_free(row_root);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that opens a scan
+ * @param iterator scan
+ * @return EXIT_SUCCESS
+ */
+static int AK_iterator_scan_open(AK_iterator *iterator)
+{
+    AK_iterator_scan_state *state = (AK_iterator_scan_state *) iterator->state;
+    /// a table without blocks gives no rows
+    AK_row_cursor_open(&state->cursor, state->table);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the next row of a scan
+ * @param iterator scan
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_scan_next(AK_iterator *iterator)
+{
+    AK_iterator_scan_state *state = (AK_iterator_scan_state *) iterator->state;
+    return AK_row_cursor_next_tuple(&state->cursor, state->tuple) == EXIT_SUCCESS ? state->tuple : NULL;
+}
+
+/**
+ * @brief Function that frees the state of a scan
+ * @param iterator scan
+ */
+static void AK_iterator_scan_free(AK_iterator *iterator)
+{
+    AK_iterator_scan_state *state = (AK_iterator_scan_state *) iterator->state;
+    AK_tuple_free(state->tuple);
+    AK_free(state);
+}
+
+/**
+ * @brief Function that creates a scan, which gives the rows of a table in the order of AK_get_row
+ * @param tblName table name
+ * @return scan, NULL if the table does not exist
+ */
+AK_iterator *AK_iterator_scan(char *tblName)
+{
+    AK_iterator_scan_state *state;
+    AK_tuple_schema *schema;
+    AK_iterator *iterator;
+    AK_PRO;
+
+    schema = AK_tuple_schema_create(tblName);
+    if (schema == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_iterator_scan_state *) AK_calloc(1, sizeof (AK_iterator_scan_state));
+    strncpy(state->table, tblName, MAX_ATT_NAME - 1);
+    state->tuple = AK_tuple_create(schema);
+    iterator = AK_iterator_create(schema, state, AK_iterator_scan_open, AK_iterator_scan_next, NULL);
+    iterator->free = AK_iterator_scan_free;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that gives the next row of a filter
+ * @param iterator filter
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_filter_next(AK_iterator *iterator)
+{
+    AK_iterator_filter_state *state = (AK_iterator_filter_state *) iterator->state;
+    struct list_node *row_root;
+    AK_tuple *tuple;
+    int satisfies;
+
+    while ((tuple = AK_iterator_next(iterator->input[0])) != NULL) {
+        if (state->program != NULL)
+            satisfies = AK_check_tuple_satisfies_compiled(state->program, tuple);
+        else {
+            row_root = AK_tuple_to_list(tuple, 1);
+            satisfies = AK_check_if_row_satisfies_expression(row_root, state->expr);
+            AK_DeleteAll_L3(&row_root);
+            AK_free(row_root);
+        }
+        if (satisfies)
+            return tuple;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function that frees the state of a filter
+ * @param iterator filter
+ */
+static void AK_iterator_filter_free(AK_iterator *iterator)
+{
+    AK_iterator_filter_state *state = (AK_iterator_filter_state *) iterator->state;
+    AK_free_compiled_expression(state->program);
+    AK_free(state);
+}
+
+/**
+ * @brief Function that creates a filter, which gives the rows of its input that satisfy a logical expression. The
+ * expression is compiled once, see AK_compile_expression.
+ * @param input input
+ * @param expr list with postfix notation of the logical expression, it has to outlive the filter
+ * @return filter
+ */
+AK_iterator *AK_iterator_filter(AK_iterator *input, struct list_node *expr)
+{
+    AK_iterator_filter_state *state;
+    AK_iterator *iterator;
+    AK_PRO;
+
+    state = (AK_iterator_filter_state *) AK_calloc(1, sizeof (AK_iterator_filter_state));
+    state->expr = expr;
+    state->program = AK_compile_expression(expr, input->schema->header, input->schema->num_attr);
+    iterator = AK_iterator_create(AK_iterator_copy_schema(input->schema), state, NULL, AK_iterator_filter_next, NULL);
+    iterator->input[0] = input;
+    iterator->free = AK_iterator_filter_free;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that gives the next row of a projection
+ * @param iterator projection
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_project_next(AK_iterator *iterator)
+{
+    AK_iterator_project_state *state = (AK_iterator_project_state *) iterator->state;
+    AK_tuple_value *value;
+    AK_tuple *tuple;
+    int i;
+
+    while ((tuple = AK_iterator_next(iterator->input[0])) != NULL) {
+        AK_tuple_clear(state->tuple);
+        for (i = 0; i < iterator->schema->num_attr; i++) {
+            if (state->positions[i] >= tuple->num_values)
+                break;
+            value = &tuple->values[state->positions[i]];
+            AK_tuple_append(state->tuple, i, value->type, tuple->data + value->offset, value->length);
+        }
+        if (i == iterator->schema->num_attr)
+            return state->tuple;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Function that frees the state of a projection
+ * @param iterator projection
+ */
+static void AK_iterator_project_free(AK_iterator *iterator)
+{
+    AK_iterator_project_state *state = (AK_iterator_project_state *) iterator->state;
+    AK_tuple_free(state->tuple);
+    AK_free(state);
+}
+
+/**
+ * @brief Function that creates a projection, which gives the given attributes of the rows of its input
+ * @param input input
+ * @param att list of the attributes of the result, in their order, an attribute may be repeated
+ * @return projection, NULL if the input has no such attribute or there are more than MAX_ATTRIBUTES
+ */
+AK_iterator *AK_iterator_project(AK_iterator *input, struct list_node *att)
+{
+    AK_iterator_project_state *state;
+    AK_tuple_schema *schema;
+    AK_iterator *iterator;
+    struct list_node *el;
+    int n = 0, position;
+    AK_PRO;
+
+    schema = (AK_tuple_schema *) AK_calloc(1, sizeof (AK_tuple_schema));
+    state = (AK_iterator_project_state *) AK_calloc(1, sizeof (AK_iterator_project_state));
+    strcpy(schema->table, input->schema->table);
+    for (el = AK_First_L2(att); el != NULL; el = AK_Next_L2(el), n++) {
+        position = AK_tuple_schema_find(input->schema, el->data);
+        if (position == -1 || n == MAX_ATTRIBUTES) {
+            AK_free(schema);
+            AK_free(state);
+            AK_EPI;
+            return NULL;
+        }
+        state->positions[n] = position;
+        memcpy(&schema->header[n], &input->schema->header[position], sizeof (AK_header));
+    }
+    schema->num_attr = n;
+    state->tuple = AK_tuple_create(schema);
+    iterator = AK_iterator_create(schema, state, NULL, AK_iterator_project_next, NULL);
+    iterator->input[0] = input;
+    iterator->free = AK_iterator_project_free;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that opens a limit
+ * @param iterator limit
+ * @return EXIT_SUCCESS
+ */
+static int AK_iterator_limit_open(AK_iterator *iterator)
+{
+    ((AK_iterator_limit_state *) iterator->state)->count = 0;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the next row of a limit, it does not read its input after the last row it gives
+ * @param iterator limit
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_limit_next(AK_iterator *iterator)
+{
+    AK_iterator_limit_state *state = (AK_iterator_limit_state *) iterator->state;
+    AK_tuple *tuple;
+
+    if (state->count >= state->limit)
+        return NULL;
+    tuple = AK_iterator_next(iterator->input[0]);
+    if (tuple != NULL)
+        state->count++;
+    return tuple;
+}
+
+/**
+ * @brief Function that creates a limit, which gives the first rows of its input
+ * @param input input
+ * @param limit maximum number of rows
+ * @return limit
+ */
+AK_iterator *AK_iterator_limit(AK_iterator *input, int limit)
+{
+    AK_iterator_limit_state *state;
+    AK_iterator *iterator;
+    AK_PRO;
+
+    state = (AK_iterator_limit_state *) AK_calloc(1, sizeof (AK_iterator_limit_state));
+    state->limit = limit;
+    iterator = AK_iterator_create(AK_iterator_copy_schema(input->schema), state, AK_iterator_limit_open,
+            AK_iterator_limit_next, NULL);
+    iterator->input[0] = input;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that compares two rows on the keys of a sort, like AK_sort_table does
+ * @param state sort
+ * @param a first row
+ * @param b second row
+ * @return negative, zero or positive like strcmp
+ */
+static int AK_iterator_sort_compare(AK_iterator_sort_state *state, AK_tuple *a, AK_tuple *b)
+{
+    AK_tuple_value *value_a, *value_b;
+    int i, result;
+
+    for (i = 0; i < state->num_keys; i++) {
+        value_a = &a->values[state->keys[i].position];
+        value_b = &b->values[state->keys[i].position];
+        if (value_a->type != value_b->type)
+            result = (value_a->type > value_b->type) - (value_a->type < value_b->type);
+        else
+            result = AK_sort_compare_values(value_a->type, a->data + value_a->offset, value_a->length,
+                    b->data + value_b->offset, value_b->length);
+        if (result != 0)
+            return state->keys[i].descending ? -result : result;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function that frees the rows a sort holds in memory
+ * @param state sort
+ */
+static void AK_iterator_sort_release(AK_iterator_sort_state *state)
+{
+    int i;
+    for (i = 0; i < state->num_rows; i++)
+        AK_tuple_free(state->rows[i]);
+    AK_free(state->rows);
+    state->rows = NULL;
+    state->num_rows = state->rows_capacity = 0;
+}
+
+/**
+ * @brief Function that opens a sort: it reads the whole input and sorts it in memory, or in a temporary segment
+ * with AK_sort_table when it does not fit into WORK_MEMORY
+ * @param iterator sort
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_sort_open(AK_iterator *iterator)
+{
+    AK_iterator_sort_state *state = (AK_iterator_sort_state *) iterator->state;
+    AK_tuple **merged, **swap;
+    AK_tuple *tuple;
+    char unsorted[MAX_ATT_NAME];
+    long budget = (long) WORK_MEMORY * 1024, used = 0;
+    int width, low, middle, high, a, b, k, result;
+
+    state->position = 0;
+    while ((tuple = AK_iterator_next(iterator->input[0])) != NULL) {
+        if (state->num_rows == state->rows_capacity) {
+            state->rows_capacity = state->rows_capacity ? state->rows_capacity * 2 : 64;
+            state->rows = (AK_tuple **) AK_realloc(state->rows, state->rows_capacity * sizeof (AK_tuple *));
+        }
+        state->rows[state->num_rows++] = AK_iterator_copy_tuple(tuple, iterator->schema);
+        used += sizeof (AK_tuple *) + sizeof (AK_tuple) + tuple->size;
+        if (used <= budget)
+            continue;
+
+        /// the rest of the input goes straight into the segment
+        if (AK_iterator_spill(iterator, "sort", state->rows, state->num_rows, NULL, iterator->input[0], unsorted) != EXIT_SUCCESS)
+            return EXIT_ERROR;
+        AK_iterator_sort_release(state);
+        AK_iterator_temp_name(iterator, "sorted", state->sorted);
+        result = AK_sort_table(unsorted, state->sorted, state->keys, state->num_keys, NULL);
+        AK_delete_segment(unsorted, SEGMENT_TYPE_TABLE);
+        if (result != EXIT_SUCCESS)
+            return EXIT_ERROR;
+        state->spilled = AK_iterator_scan(state->sorted);
+        if (state->spilled == NULL)
+            return EXIT_ERROR;
+        return AK_iterator_open(state->spilled);
+    }
+
+    /// bottom-up merge sort, it keeps rows with equal keys in the order they were read
+    merged = (AK_tuple **) AK_malloc((state->num_rows + 1) * sizeof (AK_tuple *));
+    for (width = 1; width < state->num_rows; width *= 2) {
+        for (low = 0; low < state->num_rows; low += 2 * width) {
+            middle = low + width < state->num_rows ? low + width : state->num_rows;
+            high = low + 2 * width < state->num_rows ? low + 2 * width : state->num_rows;
+            for (a = low, b = middle, k = low; k < high; k++) {
+                if (a < middle && (b >= high || AK_iterator_sort_compare(state, state->rows[a], state->rows[b]) <= 0))
+                    merged[k] = state->rows[a++];
+                else
+                    merged[k] = state->rows[b++];
+            }
+        }
+        swap = state->rows;
+        state->rows = merged;
+        merged = swap;
+    }
+    AK_free(merged);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the next row of a sort
+ * @param iterator sort
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_sort_next(AK_iterator *iterator)
+{
+    AK_iterator_sort_state *state = (AK_iterator_sort_state *) iterator->state;
+
+    if (state->spilled != NULL)
+        return AK_iterator_next(state->spilled);
+    return state->position < state->num_rows ? state->rows[state->position++] : NULL;
+}
+
+/**
+ * @brief Function that closes a sort
+ * @param iterator sort
+ */
+static void AK_iterator_sort_close(AK_iterator *iterator)
+{
+    AK_iterator_sort_state *state = (AK_iterator_sort_state *) iterator->state;
+
+    AK_iterator_sort_release(state);
+    if (state->spilled != NULL) {
+        AK_iterator_close(state->spilled);
+        AK_iterator_free(state->spilled);
+        state->spilled = NULL;
+        AK_delete_segment(state->sorted, SEGMENT_TYPE_TABLE);
+    }
+}
+
+/**
+ * @brief Function that creates a sort, which gives the rows of its input ordered like AK_sort_segment orders them
+ * @param input input
+ * @param attributes attributes to sort on, in the form AK_sort_segment takes them
+ * @return sort, NULL if the input has no such attribute
+ */
+AK_iterator *AK_iterator_sort(AK_iterator *input, struct list_node *attributes)
+{
+    AK_iterator_sort_state *state;
+    AK_iterator *iterator;
+    struct list_node *el;
+    int position;
+    AK_PRO;
+
+    state = (AK_iterator_sort_state *) AK_calloc(1, sizeof (AK_iterator_sort_state));
+    for (el = AK_First_L2(attributes); el != NULL; el = AK_Next_L2(el)) {
+        if (el->type == TYPE_OPERATOR && state->num_keys > 0 && (strcasecmp(el->data, "DESC") == 0 || strcasecmp(el->data, "ASC") == 0)) {
+            state->keys[state->num_keys - 1].descending = strcasecmp(el->data, "DESC") == 0;
+            continue;
+        }
+        position = AK_tuple_schema_find(input->schema, el->data);
+        if (position == -1 || state->num_keys == MAX_ATTRIBUTES) {
+            printf("AK_iterator_sort: ERROR: rows of %s can not be sorted on %s\n", input->schema->table, el->data);
+            AK_free(state);
+            AK_EPI;
+            return NULL;
+        }
+        state->keys[state->num_keys].position = position;
+        state->keys[state->num_keys].descending = 0;
+        state->num_keys++;
+    }
+    iterator = AK_iterator_create(AK_iterator_copy_schema(input->schema), state, AK_iterator_sort_open,
+            AK_iterator_sort_next, AK_iterator_sort_close);
+    iterator->input[0] = input;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that frees the rows a join holds in memory
+ * @param state join
+ */
+static void AK_iterator_join_release(AK_iterator_join_state *state)
+{
+    AK_hash_join_free(&state->table);
+    memset(&state->table, 0, sizeof (AK_hash_join_table));
+}
+
+/**
+ * @brief Function that joins the inputs of a join with AK_hash_join, after writing them into temporary segments
+ * @param iterator join
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_join_spill(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+    char inputs[2][MAX_ATT_NAME];
+    int result;
+
+    if (AK_iterator_spill(iterator, "build", NULL, 0, &state->table.arena, iterator->input[1], inputs[1]) != EXIT_SUCCESS)
+        return EXIT_ERROR;
+    AK_iterator_join_release(state);
+    if (AK_iterator_spill(iterator, "probe", NULL, 0, NULL, iterator->input[0], inputs[0]) != EXIT_SUCCESS) {
+        AK_delete_segment(inputs[1], SEGMENT_TYPE_TABLE);
+        return EXIT_ERROR;
+    }
+
+    AK_iterator_temp_name(iterator, "join", state->joined);
+    state->spec.table[0] = inputs[0];
+    state->spec.table[1] = inputs[1];
+    state->spec.dstTable = state->joined;
+    result = AK_initialize_new_segment(state->joined, SEGMENT_TYPE_TABLE, iterator->schema->header) == EXIT_ERROR
+            ? EXIT_ERROR : AK_hash_join(&state->spec);
+    AK_delete_segment(inputs[0], SEGMENT_TYPE_TABLE);
+    AK_delete_segment(inputs[1], SEGMENT_TYPE_TABLE);
+    if (result != EXIT_SUCCESS)
+        return EXIT_ERROR;
+    state->spilled = AK_iterator_scan(state->joined);
+    return state->spilled != NULL ? AK_iterator_open(state->spilled) : EXIT_ERROR;
+}
+
+/**
+ * @brief Function that opens a join: it reads the right input into the hash table of AK_hash_join, or joins both
+ * inputs with AK_hash_join when the right one does not fit into WORK_MEMORY
+ * @param iterator join
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_join_open(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+    AK_value *values = state->row_values[1];
+    AK_tuple *tuple;
+    long budget = (long) WORK_MEMORY * 1024;
+    int n;
+
+    state->left = NULL;
+    state->candidate = -1;
+    while ((tuple = AK_iterator_next(iterator->input[1])) != NULL) {
+        n = AK_tuple_values(tuple, values);
+        AK_hash_join_add_row(&state->table, values, n, AK_hash_join_key(values, state->spec.keys[1], state->spec.num_keys));
+        if (AK_hash_join_table_size(&state->table) > budget)
+            return AK_iterator_join_spill(iterator);
+    }
+    AK_hash_join_chain(&state->table);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that builds a result row of a join from a row of each input
+ * @param state join
+ * @param values values of the row of the left and of the right input
+ * @return result row, valid until the next one is built
+ */
+static AK_tuple *AK_iterator_join_combine(AK_iterator_join_state *state, AK_value **values)
+{
+    AK_value *value;
+    int i;
+
+    AK_tuple_clear(state->tuple);
+    for (i = 0; i < state->spec.num_columns; i++) {
+        value = &values[state->spec.columns[i].side][state->spec.columns[i].position];
+        AK_tuple_append(state->tuple, i, value->type, value->data, value->size);
+    }
+    return state->tuple;
+}
+
+/**
+ * @brief Function that gives the next row of a join
+ * @param iterator join
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_join_next(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+
+    if (state->spilled != NULL)
+        return AK_iterator_next(state->spilled);
+
+    while (1) {
+        if (state->left != NULL && AK_hash_join_match(&state->spec, &state->table, 1, state->values, state->hash, &state->candidate))
+            return AK_iterator_join_combine(state, state->values);
+        state->left = AK_iterator_next(iterator->input[0]);
+        if (state->left == NULL || state->table.arena.num_rows == 0)
+            return NULL;
+        AK_tuple_values(state->left, state->row_values[0]);
+        state->hash = AK_hash_join_key(state->row_values[0], state->spec.keys[0], state->spec.num_keys);
+        state->candidate = AK_hash_join_probe(&state->table, state->hash);
+    }
+}
+
+/**
+ * @brief Function that closes a join
+ * @param iterator join
+ */
+static void AK_iterator_join_close(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+
+    AK_iterator_join_release(state);
+    if (state->spilled != NULL) {
+        AK_iterator_close(state->spilled);
+        AK_iterator_free(state->spilled);
+        state->spilled = NULL;
+        AK_delete_segment(state->joined, SEGMENT_TYPE_TABLE);
+    }
+}
+
+/**
+ * @brief Function that frees the state of a join
+ * @param iterator join
+ */
+static void AK_iterator_join_free(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+    AK_tuple_free(state->tuple);
+    AK_free(state);
+}
+
+/**
+ * @brief Function that creates the state and the schema of a join
+ * @param left left input
+ * @param right right input
+ * @param att list of the key attributes, which both inputs have to have
+ * @param schema schema of the result
+ * @return state, NULL if an input has no such attribute or the result would have more than MAX_ATTRIBUTES
+ */
+static AK_iterator_join_state *AK_iterator_join_state_create(AK_iterator *left, AK_iterator *right, struct list_node *att,
+        AK_tuple_schema **schema)
+{
+    AK_iterator_join_state *state;
+    AK_join_spec *spec;
+    AK_tuple_schema *input;
+    struct list_node *el;
+    int i, k, side;
+
+    state = (AK_iterator_join_state *) AK_calloc(1, sizeof (AK_iterator_join_state));
+    spec = &state->spec;
+    for (el = AK_First_L2(att); el != NULL; el = AK_Next_L2(el), spec->num_keys++) {
+        if (spec->num_keys == MAX_ATTRIBUTES)
+            break;
+        spec->keys[0][spec->num_keys] = AK_tuple_schema_find(left->schema, el->data);
+        spec->keys[1][spec->num_keys] = AK_tuple_schema_find(right->schema, el->data);
+        if (spec->keys[0][spec->num_keys] == -1 || spec->keys[1][spec->num_keys] == -1)
+            break;
+    }
+    if (el != NULL || spec->num_keys == 0
+            || left->schema->num_attr + right->schema->num_attr - spec->num_keys > MAX_ATTRIBUTES) {
+        AK_free(state);
+        return NULL;
+    }
+
+    *schema = (AK_tuple_schema *) AK_calloc(1, sizeof (AK_tuple_schema));
+    strcpy((*schema)->table, left->schema->table);
+    for (side = 0; side < 2; side++) {
+        input = side == 0 ? left->schema : right->schema;
+        for (i = 0; i < input->num_attr; i++) {
+            for (k = 0; side == 1 && k < spec->num_keys && spec->keys[1][k] != i; k++);
+            if (side == 1 && k < spec->num_keys)
+                continue;
+            spec->columns[spec->num_columns].side = side;
+            spec->columns[spec->num_columns].position = i;
+            strcpy(spec->columns[spec->num_columns].name, input->header[i].att_name);
+            memcpy(&(*schema)->header[spec->num_columns++], &input->header[i], sizeof (AK_header));
+        }
+    }
+    (*schema)->num_attr = spec->num_columns;
+    state->values[0] = state->row_values[0];
+    state->values[1] = state->row_values[1];
+    state->tuple = AK_tuple_create(*schema);
+    return state;
+}
+
+/**
+ * @brief Function that creates a join, which gives the pairs of rows of its inputs with equal key attributes:
+ * every row of the left input joined with the matching rows of the right input in the order they were read. A
+ * result row holds all attributes of the left input followed by the attributes of the right input that are not
+ * keys.
+ * @param left left input
+ * @param right right input, held in memory
+ * @param att list of the key attributes, which both inputs have to have
+ * @return join, NULL if an input has no such attribute or the result would have more than MAX_ATTRIBUTES
+ */
+AK_iterator *AK_iterator_join(AK_iterator *left, AK_iterator *right, struct list_node *att)
+{
+    AK_iterator_join_state *state;
+    AK_tuple_schema *schema;
+    AK_iterator *iterator;
+    AK_PRO;
+
+    state = AK_iterator_join_state_create(left, right, att, &schema);
+    if (state == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    iterator = AK_iterator_create(schema, state, AK_iterator_join_open, AK_iterator_join_next, AK_iterator_join_close);
+    iterator->input[0] = left;
+    iterator->input[1] = right;
+    iterator->free = AK_iterator_join_free;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that opens a nested loop join
+ * @param iterator join
+ * @return EXIT_SUCCESS
+ */
+static int AK_iterator_nested_loop_open(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+
+    state->left = NULL;
+    state->rescan = 0;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the next row of a nested loop join
+ * @param iterator join
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_nested_loop_next(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+    AK_tuple *right;
+
+    while (1) {
+        while (state->left != NULL && (right = AK_iterator_next(iterator->input[1])) != NULL) {
+            AK_tuple_values(right, state->row_values[1]);
+            if (AK_hash_join_keys_equal(&state->spec, state->values))
+                return AK_iterator_join_combine(state, state->values);
+        }
+        state->left = AK_iterator_next(iterator->input[0]);
+        if (state->left == NULL)
+            return NULL;
+        AK_tuple_values(state->left, state->row_values[0]);
+        /// the right input was opened with the join, it is read again from the start for every next row
+        if (state->rescan) {
+            AK_iterator_close(iterator->input[1]);
+            if (AK_iterator_open(iterator->input[1]) != EXIT_SUCCESS) {
+                state->left = NULL;
+                return NULL;
+            }
+        }
+        state->rescan = 1;
+    }
+}
+
+/**
+ * @brief Function that creates a nested loop join, which gives the same rows as AK_iterator_join in the same order
+ * without holding any row: the right input is read again for every row of the left input. It suits a left input of
+ * a few rows.
+ * @param left left input
+ * @param right right input, opened again for every row of the left input
+ * @param att list of the key attributes, which both inputs have to have
+ * @return join, NULL if an input has no such attribute or the result would have more than MAX_ATTRIBUTES
+ */
+AK_iterator *AK_iterator_nested_loop_join(AK_iterator *left, AK_iterator *right, struct list_node *att)
+{
+    AK_iterator_join_state *state;
+    AK_tuple_schema *schema;
+    AK_iterator *iterator;
+    AK_PRO;
+
+    state = AK_iterator_join_state_create(left, right, att, &schema);
+    if (state == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    iterator = AK_iterator_create(schema, state, AK_iterator_nested_loop_open, AK_iterator_nested_loop_next, NULL);
+    iterator->input[0] = left;
+    iterator->input[1] = right;
+    iterator->free = AK_iterator_join_free;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that reads the next row of an input of a merge join
+ * @param input input
+ * @param values values of the row, valid until the next row of the input
+ * @return number of values, -1 after the last row
+ */
+static int AK_iterator_merge_read(void *input, AK_value *values)
+{
+    AK_tuple *tuple = AK_iterator_next((AK_iterator *) input);
+    return tuple != NULL ? AK_tuple_values(tuple, values) : -1;
+}
+
+/**
+ * @brief Function that opens a merge join
+ * @param iterator join
+ * @return EXIT_SUCCESS
+ */
+static int AK_iterator_merge_open(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+    void *input[2];
+
+    input[0] = iterator->input[0];
+    input[1] = iterator->input[1];
+    AK_merge_join_open(&state->merge, &state->spec, 0, AK_iterator_merge_read, input);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the next row of a merge join
+ * @param iterator join
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_merge_next(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+
+    return AK_merge_join_next(&state->merge) ? AK_iterator_join_combine(state, state->merge.values) : NULL;
+}
+
+/**
+ * @brief Function that closes a merge join
+ * @param iterator join
+ */
+static void AK_iterator_merge_close(AK_iterator *iterator)
+{
+    AK_iterator_join_state *state = (AK_iterator_join_state *) iterator->state;
+
+    AK_merge_join_close(&state->merge);
+}
+
+/**
+ * @brief Function that creates a merge join, which gives the pairs of rows of its inputs with equal key
+ * attributes like AK_iterator_join does. Both inputs are sorted on the keys with AK_iterator_sort and merged by
+ * AK_merge_join_next; only the right rows with the keys of the current left row are held.
+ * @param left left input
+ * @param right right input
+ * @param att list of the key attributes, which both inputs have to have
+ * @return join, NULL if an input has no such attribute or the result would have more than MAX_ATTRIBUTES
+ */
+AK_iterator *AK_iterator_merge_join(AK_iterator *left, AK_iterator *right, struct list_node *att)
+{
+    AK_iterator_join_state *state;
+    AK_tuple_schema *schema;
+    AK_iterator *iterator, *sorted[2];
+    AK_PRO;
+
+    state = AK_iterator_join_state_create(left, right, att, &schema);
+    if (state == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    sorted[0] = AK_iterator_sort(left, att);
+    sorted[1] = sorted[0] != NULL ? AK_iterator_sort(right, att) : NULL;
+    if (sorted[1] == NULL) {
+        if (sorted[0] != NULL) {
+            sorted[0]->input[0] = NULL;
+            AK_iterator_free(sorted[0]);
+        }
+        AK_tuple_free(state->tuple);
+        AK_free(state);
+        AK_tuple_schema_free(schema);
+        AK_EPI;
+        return NULL;
+    }
+    iterator = AK_iterator_create(schema, state, AK_iterator_merge_open, AK_iterator_merge_next, AK_iterator_merge_close);
+    iterator->input[0] = sorted[0];
+    iterator->input[1] = sorted[1];
+    iterator->free = AK_iterator_join_free;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that opens an aggregation: it reads the whole input into groups held in memory. Rows of groups
+ * that do not fit into WORK_MEMORY are written into a temporary segment and aggregated by AK_aggregation.
+ * @param iterator aggregation
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_iterator_aggregate_open(AK_iterator *iterator)
+{
+    AK_iterator_aggregate_state *state = (AK_iterator_aggregate_state *) iterator->state;
+    struct list_node *row_root = NULL;
+    AK_tuple *tuple;
+    char unaggregated[MAX_ATT_NAME];
+    int result;
+
+    state->position = 0;
+    while ((tuple = AK_iterator_next(iterator->input[0])) != NULL) {
+        if (AK_agg_stream_add(state->stream, tuple) == EXIT_SUCCESS)
+            continue;
+        if (row_root == NULL) {
+            AK_iterator_temp_name(iterator, "agg", unaggregated);
+            if (AK_initialize_new_segment(unaggregated, SEGMENT_TYPE_TABLE, iterator->input[0]->schema->header) == EXIT_ERROR)
+                return EXIT_ERROR;
+            row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+            AK_Init_L3(&row_root);
+        }
+        AK_iterator_insert_tuple(tuple, unaggregated, row_root);
+    }
+    state->num_groups = AK_agg_stream_finish(state->stream);
+    if (row_root == NULL)
+        return EXIT_SUCCESS;
+
+    AK_free(row_root);
+    AK_iterator_temp_name(iterator, "aggregated", state->aggregated);
+    result = AK_aggregation(&state->aggregation, unaggregated, state->aggregated);
+    AK_delete_segment(unaggregated, SEGMENT_TYPE_TABLE);
+    if (result != EXIT_SUCCESS)
+        return EXIT_ERROR;
+    state->spilled = AK_iterator_scan(state->aggregated);
+    if (state->spilled == NULL)
+        return EXIT_ERROR;
+    return AK_iterator_open(state->spilled);
+}
+
+/**
+ * @brief Function that gives the next row of an aggregation, the groups held in memory first
+ * @param iterator aggregation
+ * @return row or NULL
+ */
+static AK_tuple *AK_iterator_aggregate_next(AK_iterator *iterator)
+{
+    AK_iterator_aggregate_state *state = (AK_iterator_aggregate_state *) iterator->state;
+
+    if (state->position < state->num_groups) {
+        AK_agg_stream_result(state->stream, state->position++, state->tuple);
+        return state->tuple;
+    }
+    return state->spilled != NULL ? AK_iterator_next(state->spilled) : NULL;
+}
+
+/**
+ * @brief Function that closes an aggregation
+ * @param iterator aggregation
+ */
+static void AK_iterator_aggregate_close(AK_iterator *iterator)
+{
+    AK_iterator_aggregate_state *state = (AK_iterator_aggregate_state *) iterator->state;
+
+    AK_agg_stream_clear(state->stream);
+    state->num_groups = 0;
+    if (state->spilled != NULL) {
+        AK_iterator_close(state->spilled);
+        AK_iterator_free(state->spilled);
+        state->spilled = NULL;
+        AK_delete_segment(state->aggregated, SEGMENT_TYPE_TABLE);
+    }
+}
+
+/**
+ * @brief Function that frees the state of an aggregation
+ * @param iterator aggregation
+ */
+static void AK_iterator_aggregate_free(AK_iterator *iterator)
+{
+    AK_iterator_aggregate_state *state = (AK_iterator_aggregate_state *) iterator->state;
+    AK_agg_stream_free(state->stream);
+    AK_tuple_free(state->tuple);
+    AK_free(state);
+}
+
+/**
+ * @brief Function that creates an aggregation, which gives a row for every group of its input like AK_aggregation
+ * @param input input
+ * @param aggregation attributes and tasks of the aggregation, in the form AK_aggregation takes them
+ * @return aggregation, NULL if the input has no such attribute
+ */
+AK_iterator *AK_iterator_aggregate(AK_iterator *input, AK_agg_input *aggregation)
+{
+    AK_iterator_aggregate_state *state;
+    AK_tuple_schema *schema;
+    AK_iterator *iterator;
+    AK_PRO;
+
+    state = (AK_iterator_aggregate_state *) AK_calloc(1, sizeof (AK_iterator_aggregate_state));
+    state->stream = AK_agg_stream_create(aggregation, input->schema);
+    if (state->stream == NULL) {
+        AK_free(state);
+        AK_EPI;
+        return NULL;
+    }
+    memcpy(&state->aggregation, aggregation, sizeof (AK_agg_input));
+    schema = (AK_tuple_schema *) AK_calloc(1, sizeof (AK_tuple_schema));
+    strcpy(schema->table, input->schema->table);
+    schema->num_attr = AK_agg_stream_header(state->stream, schema->header);
+    state->tuple = AK_tuple_create(schema);
+    iterator = AK_iterator_create(schema, state, AK_iterator_aggregate_open, AK_iterator_aggregate_next,
+            AK_iterator_aggregate_close);
+    iterator->input[0] = input;
+    iterator->free = AK_iterator_aggregate_free;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief Function that writes all rows of a pipeline into an existing table
+ * @param iterator last operator of the pipeline, it is opened and closed
+ * @param dstTable table with the attributes of the schema of the operator
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_iterator_insert(AK_iterator *iterator, char *dstTable)
+{
+    struct list_node *row_root;
+    AK_tuple *tuple;
+    int result;
+    AK_PRO;
+
+    result = AK_iterator_open(iterator);
+    if (result == EXIT_SUCCESS) {
+        row_root = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+        AK_Init_L3(&row_root);
+        while ((tuple = AK_iterator_next(iterator)) != NULL)
+            AK_iterator_insert_tuple(tuple, dstTable, row_root);
+        AK_free(row_root);
+    }
+    AK_iterator_close(iterator);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that writes all rows of a pipeline into a new table
+ * @param iterator last operator of the pipeline, it is opened and closed
+ * @param dstTable name of the new table, it gets the attributes of the schema of the operator
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table can not be created
+ */
+int AK_iterator_materialize(AK_iterator *iterator, char *dstTable)
+{
+    int result;
+    AK_PRO;
+
+    if (AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, iterator->schema->header) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s!\n", dstTable, iterator->schema->table);
+    result = AK_iterator_insert(iterator, dstTable);
+    AK_EPI;
+    return result;
+}
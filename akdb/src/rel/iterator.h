@@ -0,0 +1,73 @@
+/**
+@file iterator.h Header file that provides a pipelined executor of relational operators
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef ITERATOR
+#define ITERATOR
+
+#include "../auxi/test.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../file/filesort.h"
+#include "expression_check.h"
+#include "hash_join.h"
+#include "merge_join.h"
+#include "aggregation.h"
+#include "../auxi/mempro.h"
+
+typedef struct AK_iterator AK_iterator;
+
+/**
+ * @struct AK_iterator
+ * @brief Relational operator of a pipeline. After open, every call of next gives the next row of the operator,
+ * pulled from its inputs as it is needed, until it gives NULL; close releases what open took.
+ */
+struct AK_iterator {
+    int (*open)(AK_iterator *iterator);
+    /// the tuple it gives stays valid until the next call
+    AK_tuple *(*next)(AK_iterator *iterator);
+    void (*close)(AK_iterator *iterator);
+    /// frees the state, NULL if the state is released with AK_free
+    void (*free)(AK_iterator *iterator);
+    /// attributes of the rows the operator gives
+    AK_tuple_schema *schema;
+    /// inputs, NULL if not used
+    AK_iterator *input[2];
+    void *state;
+};
+
+AK_iterator *AK_iterator_create(AK_tuple_schema *schema, void *state, int (*open)(AK_iterator *),
+        AK_tuple *(*next)(AK_iterator *), void (*close)(AK_iterator *));
+int AK_iterator_open(AK_iterator *iterator);
+AK_tuple *AK_iterator_next(AK_iterator *iterator);
+void AK_iterator_close(AK_iterator *iterator);
+void AK_iterator_free(AK_iterator *iterator);
+AK_iterator *AK_iterator_scan(char *tblName);
+AK_iterator *AK_iterator_filter(AK_iterator *input, struct list_node *expr);
+AK_iterator *AK_iterator_project(AK_iterator *input, struct list_node *att);
+AK_iterator *AK_iterator_limit(AK_iterator *input, int limit);
+AK_iterator *AK_iterator_sort(AK_iterator *input, struct list_node *attributes);
+AK_iterator *AK_iterator_join(AK_iterator *left, AK_iterator *right, struct list_node *att);
+AK_iterator *AK_iterator_nested_loop_join(AK_iterator *left, AK_iterator *right, struct list_node *att);
+AK_iterator *AK_iterator_merge_join(AK_iterator *left, AK_iterator *right, struct list_node *att);
+AK_iterator *AK_iterator_aggregate(AK_iterator *input, AK_agg_input *aggregation);
+int AK_iterator_insert(AK_iterator *iterator, char *dstTable);
+int AK_iterator_materialize(AK_iterator *iterator, char *dstTable);
+void AK_iterator_temp_name(AK_iterator *iterator, const char *suffix, char *name);
+
+#endif
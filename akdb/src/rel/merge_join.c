@@ -0,0 +1,327 @@
+/**
+@file merge_join.c Provides functions for the sort-merge join of two tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+
+#include "merge_join.h"
+
+/**
+ * @brief Input of a merge join read by a cursor, with the row it read last
+ */
+typedef struct {
+    AK_row_cursor cursor;
+    struct list_node *row;
+} AK_merge_join_cursor;
+
+/**
+ * @brief Function that compares the key attributes of two rows of a join
+ * @param spec join
+ * @param a values of the first row
+ * @param side_a 0 if the first row is from the first table, 1 if it is from the second one
+ * @param b values of the second row
+ * @param side_b table of the second row
+ * @return negative, zero or positive like strcmp
+ */
+static int AK_merge_join_compare(AK_join_spec *spec, AK_value *a, int side_a, AK_value *b, int side_b)
+{
+    AK_value *value_a, *value_b;
+    int i, result;
+
+    for (i = 0; i < spec->num_keys; i++)
+    {
+        value_a = &a[spec->keys[side_a][i]];
+        value_b = &b[spec->keys[side_b][i]];
+        /// values of different types (a missing value is VARCHAR "null") are ordered by type, as AK_sort_table does
+        if (value_a->type != value_b->type)
+            return (value_a->type > value_b->type) - (value_a->type < value_b->type);
+        result = AK_sort_compare_values(value_a->type, value_a->data, value_a->size, value_b->data, value_b->size);
+        if (result != 0)
+            return result;
+    }
+    return 0;
+}
+
+/**
+ * @brief Function that checks the range comparison of a join for a row of each table
+ * @param spec join
+ * @param type type of the range attributes
+ * @param a values of the row of the first table
+ * @param b values of the row of the second table
+ * @return 1 if the comparison holds, 0 otherwise
+ */
+static int AK_merge_join_range_holds(AK_join_spec *spec, int type, AK_value *a, AK_value *b)
+{
+    AK_value *value_a = &a[spec->range[0]], *value_b = &b[spec->range[1]];
+    int result = AK_sort_compare_values(type, value_a->data, value_a->size, value_b->data, value_b->size);
+
+    if (spec->range_op[0] == '<')
+        return spec->range_op[1] == '=' ? result <= 0 : result < 0;
+    return spec->range_op[1] == '=' ? result >= 0 : result > 0;
+}
+
+/**
+ * @brief Function that reads the next row of an input of a merge join
+ * @param state merge
+ * @param side input
+ * @return No return value
+ */
+static void AK_merge_join_advance(AK_merge_join_state *state, int side)
+{
+    state->num_values[side] = state->read(state->input[side], state->row[side]);
+}
+
+/**
+ * @brief Function that determines the held rows the current row of the first input is joined with. On a range
+ * they are a suffix (for < and <=) or a prefix (for > and >=) of the held rows of the range type, and the bound
+ * between the rows that compare so and the ones that do not only moves forward for the next rows with equal keys.
+ * @param state merge
+ * @return No return value
+ */
+static void AK_merge_join_bounds(AK_merge_join_state *state)
+{
+    AK_join_spec *spec = state->spec;
+    AK_value held[MAX_ATTRIBUTES];
+    int less = spec->range_op[0] == '<';
+
+    state->next = state->low;
+    state->to = state->high;
+    if (spec->range_op[0] == '\0')
+        return;
+    if (state->row[0][spec->range[0]].type != state->range_type)
+    {
+        state->to = state->next;
+        return;
+    }
+    for (; state->bound < state->high; state->bound++)
+    {
+        AK_tuple_arena_values(&state->group, state->bound, held);
+        if (AK_merge_join_range_holds(spec, state->range_type, state->row[0], held) == less)
+            break;
+    }
+    if (less)
+        state->next = state->bound;
+    else
+        state->to = state->bound;
+}
+
+/**
+ * @brief Function that starts a merge of two inputs sorted on the keys of a join, and on the range attributes
+ * after them if the join is on a range
+ * @param state merge
+ * @param spec join, only its keys and range are used
+ * @param range_type type of the range attributes, not used without a range
+ * @param read function that reads the next row of an input
+ * @param input first and second input, passed to read
+ * @return No return value
+ */
+void AK_merge_join_open(AK_merge_join_state *state, AK_join_spec *spec, int range_type, AK_merge_join_read read, void **input)
+{
+    AK_PRO;
+    memset(state, 0, sizeof (AK_merge_join_state));
+    state->spec = spec;
+    state->range_type = range_type;
+    state->read = read;
+    state->input[0] = input[0];
+    state->input[1] = input[1];
+    state->values[0] = state->row[0];
+    state->values[1] = state->held;
+    AK_merge_join_advance(state, 0);
+    AK_merge_join_advance(state, 1);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that gives the next pair of joined rows of a merge. The rows of the second input with equal keys
+ * are held while the rows of the first input with those keys are joined with them, so every input is read once.
+ * @param state merge
+ * @return 1 with state->values pointed at the rows of the pair, 0 after the last pair
+ */
+int AK_merge_join_next(AK_merge_join_state *state)
+{
+    AK_join_spec *spec = state->spec;
+    AK_value held[MAX_ATTRIBUTES];
+    int result;
+    AK_PRO;
+
+    while (1)
+    {
+        if (state->next < state->to)
+        {
+            AK_tuple_arena_values(&state->group, state->next++, state->held);
+            AK_EPI;
+            return 1;
+        }
+        if (state->group.num_rows > 0)
+        {
+            /// the next row of the first input may have the same keys and be joined with the same held rows
+            AK_merge_join_advance(state, 0);
+            if (state->num_values[0] >= 0 && AK_merge_join_compare(spec, state->row[0], 0, state->key, 1) == 0)
+            {
+                AK_merge_join_bounds(state);
+                continue;
+            }
+            AK_tuple_arena_clear(&state->group);
+        }
+        if (state->num_values[0] < 0 || state->num_values[1] < 0)
+        {
+            AK_EPI;
+            return 0;
+        }
+        result = AK_merge_join_compare(spec, state->row[0], 0, state->row[1], 1);
+        if (result != 0)
+        {
+            AK_merge_join_advance(state, result < 0 ? 0 : 1);
+            continue;
+        }
+
+        do
+        {
+            AK_tuple_arena_add(&state->group, state->row[1], state->num_values[1]);
+            AK_merge_join_advance(state, 1);
+        } while (state->num_values[1] >= 0 && AK_merge_join_compare(spec, state->row[0], 0, state->row[1], 1) == 0);
+        AK_tuple_arena_values(&state->group, 0, state->key);
+
+        /// on a range, a missing value (VARCHAR "null") compares with nothing; values are sorted by type first,
+        /// so the held rows with a value of the range type are the ones from low to high
+        state->low = 0;
+        state->high = state->group.num_rows;
+        if (spec->range_op[0] != '\0')
+        {
+            for (; state->low < state->group.num_rows; state->low++)
+            {
+                AK_tuple_arena_values(&state->group, state->low, held);
+                if (held[spec->range[1]].type == state->range_type)
+                    break;
+            }
+            for (state->high = state->low; state->high < state->group.num_rows; state->high++)
+            {
+                AK_tuple_arena_values(&state->group, state->high, held);
+                if (held[spec->range[1]].type != state->range_type)
+                    break;
+            }
+        }
+        state->bound = state->low;
+        AK_merge_join_bounds(state);
+    }
+}
+
+/**
+ * @brief Function that frees the rows a merge holds
+ * @param state merge
+ * @return No return value
+ */
+void AK_merge_join_close(AK_merge_join_state *state)
+{
+    AK_PRO;
+    AK_tuple_arena_free(&state->group);
+    AK_EPI;
+}
+
+/**
+ * @brief Function that reads the next row of a cursor for a merge join and frees the previous one
+ * @param input cursor and its last row
+ * @param values values of the next row
+ * @return number of values, -1 after the last row
+ */
+static int AK_merge_join_read_cursor(void *input, AK_value *values)
+{
+    AK_merge_join_cursor *cursor = (AK_merge_join_cursor *) input;
+
+    if (cursor->row != NULL)
+    {
+        AK_DeleteAll_L3(&cursor->row);
+        AK_free(cursor->row);
+    }
+    if ((cursor->row = AK_row_cursor_next(&cursor->cursor)) == NULL)
+        return -1;
+    return AK_tuple_row_values(cursor->row, values);
+}
+
+/**
+ * @brief Function that joins two tables on equal key attributes into an existing result table. Both tables are
+ * sorted on their keys with AK_sort_table and merged by AK_merge_join_next. A join on a range is sorted on the
+ * range attributes after the keys, so a join without keys costs two sorts and the rows it gives.
+ * @param spec join, the result table must already exist
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_merge_join(AK_join_spec *spec)
+{
+    char sorted[2][MAX_ATT_NAME];
+    AK_sort_key keys[MAX_ATTRIBUTES + 1];
+    AK_merge_join_cursor cursor[2];
+    AK_merge_join_state merge;
+    AK_header *header;
+    void *input[2];
+    int num_keys, range_type = 0, side, i, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    /// a cut name could be the name of another segment, and both sides would get the same one
+    if (snprintf(sorted[0], MAX_ATT_NAME, "%s_mj%d", spec->dstTable, 0) >= MAX_ATT_NAME)
+    {
+        AK_dbg_messg(LOW, REL_OP, "AK_merge_join: name of table %s is too long\n", spec->dstTable);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (spec->range_op[0] != '\0')
+    {
+        header = AK_get_header(spec->table[1]);
+        range_type = header[spec->range[1]].type;
+        AK_free(header);
+    }
+
+    for (side = 0; side < 2; side++)
+    {
+        for (num_keys = 0; num_keys < spec->num_keys; num_keys++)
+            keys[num_keys].position = spec->keys[side][num_keys];
+        if (spec->range_op[0] != '\0')
+            keys[num_keys++].position = spec->range[side];
+        for (i = 0; i < num_keys; i++)
+            keys[i].descending = 0;
+        snprintf(sorted[side], MAX_ATT_NAME, "%s_mj%d", spec->dstTable, side);
+        if (AK_sort_table(spec->table[side], sorted[side], keys, num_keys, NULL) != EXIT_SUCCESS)
+            result = EXIT_ERROR;
+    }
+
+    if (result == EXIT_SUCCESS)
+    {
+        for (side = 0; side < 2; side++)
+        {
+            AK_row_cursor_open(&cursor[side].cursor, sorted[side]);
+            cursor[side].row = NULL;
+            input[side] = &cursor[side];
+        }
+        AK_merge_join_open(&merge, spec, range_type, AK_merge_join_read_cursor, input);
+        while (AK_merge_join_next(&merge))
+            AK_join_emit(spec, merge.values);
+        AK_merge_join_close(&merge);
+        for (side = 0; side < 2; side++)
+        {
+            if (cursor[side].row != NULL)
+            {
+                AK_DeleteAll_L3(&cursor[side].row);
+                AK_free(cursor[side].row);
+            }
+        }
+    }
+
+    for (side = 0; side < 2; side++)
+        if (AK_num_attr(sorted[side]) > 0)
+            AK_delete_segment(sorted[side], SEGMENT_TYPE_TABLE);
+    AK_EPI;
+    return result;
+}
@@ -0,0 +1,72 @@
+/**
+@file merge_join.h Header file that provides functions for the sort-merge join of two tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef MERGE_JOIN
+#define MERGE_JOIN
+
+#include "../auxi/test.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../file/filesort.h"
+#include "hash_join.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @brief Function that reads the next row of an input of a merge join, in the order of the keys of the join
+ * @param input input
+ * @param values values of the row, valid until the next call
+ * @return number of values, -1 after the last row
+ */
+typedef int (*AK_merge_join_read)(void *input, AK_value *values);
+
+/**
+ * @struct AK_merge_join_state
+ * @brief Merge of two inputs sorted on the keys of a join, which gives the joined pairs of rows one at a time
+ */
+typedef struct {
+    AK_join_spec *spec;
+    AK_merge_join_read read;
+    void *input[2];
+    /// type of the range attributes if the join is on a range
+    int range_type;
+    /// current row of every input and its number of values, -1 after the last row
+    AK_value row[2][MAX_ATTRIBUTES];
+    int num_values[2];
+    /// rows of the second input with the keys of the current row of the first one, and the values of the first of them
+    AK_tuple_arena group;
+    AK_value key[MAX_ATTRIBUTES];
+    /// held rows with a range value of the range type, from low to high, and the bound of the last range comparison
+    int low;
+    int high;
+    int bound;
+    /// held rows from next to to are still to be joined with the current row of the first input
+    int next;
+    int to;
+    /// values of the held row of the last pair
+    AK_value held[MAX_ATTRIBUTES];
+    /// values of the rows of the last pair, indexed by side
+    AK_value *values[2];
+} AK_merge_join_state;
+
+void AK_merge_join_open(AK_merge_join_state *state, AK_join_spec *spec, int range_type, AK_merge_join_read read, void **input);
+int AK_merge_join_next(AK_merge_join_state *state);
+void AK_merge_join_close(AK_merge_join_state *state);
+int AK_merge_join(AK_join_spec *spec);
+
+#endif
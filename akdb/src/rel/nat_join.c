@@ -266,9 +266,68 @@ void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, s
     AK_EPI;
 }
 
+/**
+ * @brief Function that describes a natural join as an equi-join for AK_hash_join or AK_merge_join. The result has
+ * the attributes of the first table that are not join attributes followed by all attributes of the second table,
+ * the same as the header written by AK_create_join_block_header.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the nat_join table
+ * @param att attributes on which we make nat_join
+ * @param spec description of the join
+ * @return EXIT_SUCCESS, EXIT_ERROR if a join attribute is missing from one of the tables
+ */
+static int AK_join_equi_spec(char *srcTable1, char *srcTable2, char *dstTable, struct list_node *att, AK_join_spec *spec) {
+    AK_header *header[2];
+    struct list_node *list_elem;
+    int num_attr[2], side, i, result = EXIT_SUCCESS;
+
+    memset(spec, 0, sizeof (AK_join_spec));
+    spec->table[0] = srcTable1;
+    spec->table[1] = srcTable2;
+    spec->dstTable = dstTable;
+    for (side = 0; side < 2; side++) {
+        header[side] = (AK_header *) AK_get_header(spec->table[side]);
+        num_attr[side] = AK_num_attr(spec->table[side]);
+    }
+
+    for (list_elem = AK_First_L2(att); list_elem != NULL && result == EXIT_SUCCESS; list_elem = list_elem->next) {
+        for (side = 0; side < 2 && spec->num_keys < MAX_ATTRIBUTES; side++) {
+            for (i = 0; i < num_attr[side]; i++)
+                if (strcmp(header[side][i].att_name, list_elem->data) == 0)
+                    break;
+            spec->keys[side][spec->num_keys] = i;
+            if (i == num_attr[side])
+                result = EXIT_ERROR;
+        }
+        spec->num_keys++;
+    }
+    if (spec->num_keys == 0 || spec->num_keys > MAX_ATTRIBUTES)
+        result = EXIT_ERROR;
+
+    for (side = 0; side < 2 && result == EXIT_SUCCESS; side++) {
+        for (i = 0; i < num_attr[side]; i++) {
+            for (list_elem = AK_First_L2(att); side == 0 && list_elem != NULL; list_elem = list_elem->next)
+                if (strcmp(list_elem->data, header[side][i].att_name) == 0)
+                    break;
+            if (side == 0 && list_elem != NULL)
+                continue;
+            spec->columns[spec->num_columns].side = side;
+            spec->columns[spec->num_columns].position = i;
+            strcpy(spec->columns[spec->num_columns].name, header[side][i].att_name);
+            spec->num_columns++;
+        }
+    }
+    AK_free(header[0]);
+    AK_free(header[1]);
+    return result;
+}
+
 /**
  * @author Matija Novak, updated to work with AK_list and support cacheing by Dino Laktašić
- * @brief Function that makes a  nat_join betwen two tables on some attributes
+ * @brief Function that makes a  nat_join betwen two tables on some attributes. When all join attributes exist in
+ * both tables the join runs as a hash join (see AK_hash_join), otherwise the blocks of the tables are joined in
+ * nested loops.
  * @param srcTable1 name of the first table to join
  * @param srcTable2 name of the second table to join
  * @param att attributes on which we make nat_join
@@ -288,6 +347,15 @@ int AK_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node
         AK_create_join_block_header(startAddress1, startAddress2, dstTable, att);
 
         AK_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s and %s\n", dstTable, srcTable1, srcTable2);
+
+        AK_join_spec spec;
+        if (AK_join_equi_spec(srcTable1, srcTable2, dstTable, att, &spec) == EXIT_SUCCESS) {
+            int result = AK_hash_join(&spec);
+            AK_free(src_addr1);
+            AK_free(src_addr2);
+            AK_EPI;
+            return result;
+        }
 		AK_dbg_messg(MIDDLE, REL_OP, "\nAK_join: start copying data\n");
 
         AK_mem_block *tbl1_temp_block, *tbl2_temp_block;
@@ -364,7 +432,10 @@ TestResult AK_op_join_test() {
     char *destTable = "nat_join_test";
     char *tblName2 = "employee";
     char *tblName1 = "department";
+    char *graceTable = "nat_join_test_grace";
+    char *mergeTable = "nat_join_test_merge";
     	int test;
+    int expected = 0, work_memory;
 
     printf("\n********** NAT JOIN TEST **********\n\n");
 
@@ -375,7 +446,52 @@ TestResult AK_op_join_test() {
     	AK_InsertAtBegin_L3(TYPE_ATTRIBS, "id_department", sizeof ("id_department"), att);
 
     	test = AK_join(tblName1, tblName2, destTable, att);
-	    AK_DeleteAll_L3(&att);
+
+        // pairs of rows with equal id_department, counted by a nested loop
+        expected = AK_join_nested_loop_count(tblName1, "id_department", tblName2, "id_department");
+        if (test == EXIT_SUCCESS && AK_get_num_records(destTable) != expected) {
+            printf("Hash join returned %d rows instead of %d\n", AK_get_num_records(destTable), expected);
+            test = EXIT_ERROR;
+        }
+
+        // without working memory the tables are partitioned until the maximal depth
+        work_memory = AK_settings.work_memory;
+        AK_settings.work_memory = 0;
+        if (AK_if_exist(graceTable, sys_table) != 0)
+            AK_delete_segment(graceTable, SEGMENT_TYPE_TABLE);
+        if (test == EXIT_SUCCESS && (AK_join(tblName1, tblName2, graceTable, att) != EXIT_SUCCESS || AK_get_num_records(graceTable) != expected)) {
+            printf("Partitioned hash join returned %d rows instead of %d\n", AK_get_num_records(graceTable), expected);
+            test = EXIT_ERROR;
+        }
+        AK_settings.work_memory = work_memory;
+
+        // the same join as a sort-merge join
+        AK_join_spec spec;
+        table_addresses *addr1 = (table_addresses *) AK_get_table_addresses(tblName1);
+        table_addresses *addr2 = (table_addresses *) AK_get_table_addresses(tblName2);
+        if (AK_if_exist(mergeTable, sys_table) != 0)
+            AK_delete_segment(mergeTable, SEGMENT_TYPE_TABLE);
+        AK_create_join_block_header(addr1->address_from[0], addr2->address_from[0], mergeTable, att);
+        AK_free(addr1);
+        AK_free(addr2);
+        if (test == EXIT_SUCCESS && (AK_join_equi_spec(tblName1, tblName2, mergeTable, att, &spec) != EXIT_SUCCESS
+                || AK_merge_join(&spec) != EXIT_SUCCESS || AK_get_num_records(mergeTable) != expected)) {
+            printf("Merge join returned %d rows instead of %d\n", AK_get_num_records(mergeTable), expected);
+            test = EXIT_ERROR;
+        }
+        else
+            AK_print_table(mergeTable);
+
+        // a result name that leaves no room for the names of its partitions is rejected
+        char longTable[MAX_ATT_NAME];
+        memset(longTable, 'j', MAX_ATT_NAME - 1);
+        longTable[MAX_ATT_NAME - 1] = '\0';
+        spec.dstTable = longTable;
+        if (test == EXIT_SUCCESS && AK_hash_join(&spec) != EXIT_ERROR) {
+            printf("Hash join into a table with a too long name was not rejected\n");
+            test = EXIT_ERROR;
+        }
+        AK_DeleteAll_L3(&att);
     }
 
     else {
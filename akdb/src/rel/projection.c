@@ -436,9 +436,60 @@ char *AK_perform_operation(char *op,struct AK_operand *firstOperand, struct AK_o
     
 }
 
+/**
+ * @brief Function that creates the projection of a pipeline on plain attributes. Its attributes come in the order
+ * of the input, like AK_create_block_header gives them, and an attribute that is listed twice is given twice.
+ * @param input input, taken over by the projection unless NULL is returned
+ * @param att list of atributes on which we make projection
+ * @param expr given expression to check while doing projection, NULL for none, it has to outlive the projection
+ * @return projection, NULL if an attribute is an arithmetic operation or none of them is an attribute of the input
+ */
+AK_iterator *AK_projection_iterator(AK_iterator *input, struct list_node *att, struct list_node *expr) {
+    struct list_node *columns, *list_elem;
+    AK_iterator *projection = NULL;
+    int head, arithmetic = 0;
+    AK_PRO;
+
+    columns = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&columns);
+    for (head = 0; head < input->schema->num_attr && !arithmetic; head++) {
+        for (list_elem = AK_First_L2(att); list_elem != NULL; list_elem = AK_Next_L2(list_elem)) {
+            if (strcmp(list_elem->data, input->schema->header[head].att_name) == 0)
+                AK_InsertAtEnd_L3(TYPE_ATTRIBS, list_elem->data, strlen(list_elem->data) + 1, columns);
+            else if (strstr(list_elem->data, input->schema->header[head].att_name) != NULL)
+                arithmetic = 1;
+        }
+    }
+    if (!arithmetic && AK_First_L2(columns) != NULL)
+        projection = AK_iterator_project(input, columns);
+    if (projection != NULL && expr != NULL)
+        projection = AK_iterator_filter(projection, expr);
+    AK_DeleteAll_L3(&columns);
+    AK_free(columns);
+    AK_EPI;
+    return projection;
+}
+
+/**
+ * @brief Function that writes the rows of a projection into the projection table
+ * @param projection projection, it is freed
+ * @param dstTable table name for projection table, it is created like AK_create_block_header creates it
+ * @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR
+ */
+static int AK_projection_write(AK_iterator *projection, char *dstTable) {
+    int result;
+
+    AK_temp_create_table(dstTable, projection->schema->header, SEGMENT_TYPE_TABLE);
+    AK_dbg_messg(LOW, REL_OP, "TABLE %s CREATED from %s!\n", dstTable, projection->schema->table);
+    result = AK_iterator_insert(projection, dstTable);
+    AK_iterator_free(projection);
+    return result;
+}
+
 /**
  * @author Matija Novak, rewritten and optimized by Dino Laktašić, now support cacheing
- * @brief  Function that makes a projection of some table on given attributes
+ * @brief  Function that makes a projection of some table on given attributes. Plain attributes are projected by
+ * a pipeline, see AK_projection_iterator; attributes with arithmetic operations are copied block by block.
  * @param srcTable source table - table on which projection is made
  * @param expr given expression to check while doing projection
  * @param att list of atributes on which we make projection
@@ -452,8 +503,23 @@ int AK_projection(char *srcTable, char *dstTable, struct list_node *att, struct
     //geting the table addresses from table on which we make projection
     AK_PRO;
     table_addresses *src_addr = (table_addresses *) AK_get_table_addresses(srcTable);
+    AK_iterator *scan, *projection;
 
     if (src_addr->address_from[0] != 0) {
+        scan = AK_iterator_scan(srcTable);
+        projection = scan != NULL ? AK_projection_iterator(scan, att, expr) : NULL;
+        if (projection != NULL) {
+            AK_free(src_addr);
+            if (AK_projection_write(projection, dstTable) != EXIT_SUCCESS) {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            AK_dbg_messg(LOW, REL_OP, "PROJECTION_TEST_SUCCESS\n\n");
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
+        AK_iterator_free(scan);
+
         //create new segmenet for the projection table
         AK_create_block_header(src_addr->address_from[0], dstTable, att);
 
@@ -499,6 +565,40 @@ int AK_projection(char *srcTable, char *dstTable, struct list_node *att, struct
     AK_EPI;
 }
 
+/**
+ * @brief Function that makes a projection of the rows of a pipeline. Plain attributes are projected as the rows
+ * come; for attributes with arithmetic operations the rows are first written into a temporary table, which is
+ * projected by AK_projection.
+ * @param input last operator of the pipeline, it is freed
+ * @param dstTable table name for projection table
+ * @param att list of atributes on which we make projection
+ * @param expr given expression to check while doing projection, NULL for none
+ * @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR
+ */
+int AK_projection_pipeline(AK_iterator *input, char *dstTable, struct list_node *att, struct list_node *expr) {
+    AK_iterator *projection;
+    char temp[MAX_ATT_NAME];
+    int result;
+    AK_PRO;
+
+    projection = AK_projection_iterator(input, att, expr);
+    if (projection != NULL) {
+        result = AK_projection_write(projection, dstTable);
+        AK_EPI;
+        return result;
+    }
+
+    AK_iterator_temp_name(input, "projection", temp);
+    result = AK_iterator_materialize(input, temp);
+    AK_iterator_free(input);
+    if (result == EXIT_SUCCESS) {
+        result = AK_projection(temp, dstTable, att, expr);
+        AK_delete_segment(temp, SEGMENT_TYPE_TABLE);
+    }
+    AK_EPI;
+    return result;
+}
+
 /**
  * @author Dino Laktašić, rewritten and optimized by Irena Ilišević to support ILIKE operator and perform usual projection 
  * @brief  Function for projection operation testing, tests usual projection functionality, projection when it is given aritmetic operation or expresson
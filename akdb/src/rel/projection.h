@@ -22,6 +22,7 @@
 
 #include "../auxi/test.h"
 #include "expression_check.h"
+#include "iterator.h"
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
@@ -127,6 +128,25 @@ char *AK_perform_operation(char *op,struct AK_operand *firstOperand, struct AK_o
  */
 int AK_projection(char *srcTable, char *dstTable, struct list_node *att, struct list_node *expr);
 
+/**
+ * @brief Function that creates the projection of a pipeline on plain attributes
+ * @param input input, taken over by the projection unless NULL is returned
+ * @param att list of atributes on which we make projection
+ * @param expr given expression to check while doing projection, NULL for none
+ * @return projection, NULL if an attribute is an arithmetic operation or none of them is an attribute of the input
+ */
+AK_iterator *AK_projection_iterator(AK_iterator *input, struct list_node *att, struct list_node *expr);
+
+/**
+ * @brief Function that makes a projection of the rows of a pipeline
+ * @param input last operator of the pipeline, it is freed
+ * @param dstTable table name for projection table
+ * @param att list of atributes on which we make projection
+ * @param expr given expression to check while doing projection, NULL for none
+ * @return EXIT_SUCCESS if continues succesfuly, when not EXIT_ERROR
+ */
+int AK_projection_pipeline(AK_iterator *input, char *dstTable, struct list_node *att, struct list_node *expr);
+
 
 /**
  * @author Dino Laktašić, rewritten and optimized by Irena Ilišević to support ILIKE operator and perform usual projection 
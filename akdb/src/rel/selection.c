@@ -19,95 +19,579 @@
 
 #include "selection.h"
 
+/**
+ * @brief Predicate of a selection that an index can answer, with the attribute on the left of the operator
+ */
+typedef struct {
+	char *attribute;
+	/// "=", "<", ">", "<=", ">=", "BETWEEN" or "IN"
+	const char *op;
+	/// bound or IN list, and the upper bound of BETWEEN
+	struct list_node *first;
+	struct list_node *second;
+} AK_selection_predicate;
 
+/**
+ * @brief Function that checks whether an element of a postfix expression is a constant
+ */
+static int AK_selection_is_constant(struct list_node *el)
+{
+	return el->type != TYPE_ATTRIBS && el->type != TYPE_OPERATOR;
+}
 
 /**
- * @author Matija Šestak.
- * @brief  Function that which implements selection
- * @param *srcTable source table name
- * @param *dstTable destination table name
- * @param *expr list with posfix notation of the logical expression
- * @return EXIT_SUCCESS
+ * @brief Function that finds the predicates of a selection condition an index can answer. The condition is split
+ * at its top-level ANDs, and every part of the form attribute op constant (=, <, >, <=, >=, IN), constant op
+ * attribute or attribute BETWEEN constant AND constant is returned.
+ * @param expr list with postfix notation of the logical expression
+ * @param predicates predicates found
+ * @return number of predicates found
  */
-int AK_selection(char *srcTable, char *dstTable, struct list_node *expr) {
-        AK_PRO;
-	AK_header *t_header = (AK_header *) AK_get_header(srcTable);
-	int num_attr = AK_num_attr(srcTable);
+static int AK_selection_find_predicates(struct list_node *expr, AK_selection_predicate *predicates)
+{
+	struct list_node *el, **items;
+	int *starts, *stack, *spans;
+	int n = 0, depth = 0, found = 0, i, s, e, arity;
 
+	for (el = AK_First_L2(expr); el != NULL; el = AK_Next_L2(el))
+		n++;
+	if (n == 0)
+		return 0;
+	items = (struct list_node **) AK_malloc(n * sizeof (struct list_node *));
+	starts = (int *) AK_malloc(3 * n * sizeof (int));
+	stack = starts + n;
+	spans = stack + n;
 
-    AK_add_to_redolog_select(SELECT, expr, srcTable);
+	/// starts[i] is the first element of the subexpression that ends at element i
+	for (i = 0, el = AK_First_L2(expr); el != NULL; el = AK_Next_L2(el), i++)
+	{
+		items[i] = el;
+		starts[i] = i;
+		if (el->type == TYPE_OPERATOR)
+		{
+			arity = strcmp(el->data, "BETWEEN") == 0 ? 3 : 2;
+			if (depth < arity)
+				break;
+			depth -= arity;
+			starts[i] = stack[depth];
+		}
+		stack[depth++] = starts[i];
+	}
 
-    //commented out code is for testing of AK_check_redo_log_select
-    //should be moved to a test
+	if (i == n && depth == 1)
+	{
+		depth = 0;
+		spans[depth++] = n - 1;
+		while (depth > 0 && found < AK_SELECTION_MAX_PREDICATES)
+		{
+			e = spans[--depth];
+			s = starts[e];
+			if (items[e]->type == TYPE_OPERATOR && strcmp(items[e]->data, "AND") == 0)
+			{
+				spans[depth++] = e - 1;
+				spans[depth++] = starts[e - 1] - 1;
+				continue;
+			}
+			if (e - s == 3 && strcmp(items[e]->data, "BETWEEN") == 0 && items[s]->type == TYPE_ATTRIBS
+					&& AK_selection_is_constant(items[s + 1]) && AK_selection_is_constant(items[s + 2]))
+			{
+				predicates[found].attribute = items[s]->data;
+				predicates[found].op = "BETWEEN";
+				predicates[found].first = items[s + 1];
+				predicates[found++].second = items[s + 2];
+			}
+			else if (e - s == 2 && items[e]->type == TYPE_OPERATOR)
+			{
+				const char *op = items[e]->data;
+				if (strcmp(op, "=") != 0 && strcmp(op, "<") != 0 && strcmp(op, ">") != 0 && strcmp(op, "<=") != 0
+						&& strcmp(op, ">=") != 0 && strcmp(op, "IN") != 0)
+					continue;
+				if (items[s]->type == TYPE_ATTRIBS && AK_selection_is_constant(items[s + 1]))
+				{
+					predicates[found].attribute = items[s]->data;
+					predicates[found].first = items[s + 1];
+				}
+				else if (items[s + 1]->type == TYPE_ATTRIBS && AK_selection_is_constant(items[s]) && strcmp(op, "IN") != 0)
+				{
+					/// constant op attribute is turned around
+					predicates[found].attribute = items[s + 1]->data;
+					predicates[found].first = items[s];
+					if (op[0] == '<')
+						op = op[1] == '=' ? ">=" : ">";
+					else if (op[0] == '>')
+						op = op[1] == '=' ? "<=" : "<";
+				}
+				else
+					continue;
+				predicates[found].op = op;
+				predicates[found++].second = NULL;
+			}
+		}
+	}
+	AK_free(items);
+	AK_free(starts);
+	return found;
+}
+
+/**
+ * @brief Function that looks up the rows that may satisfy an = or IN predicate in a hash index on its attribute.
+ * The rows found have the hash value of one of the values, the whole condition is checked on each of them. All
+ * values of an IN list are probed at once, see AK_hash_probe.
+ * @param srcTable source table name
+ * @param predicate predicate
+ * @param candidates list the row addresses are appended to
+ * @return number of rows found, EXIT_ERROR if there is no hash index the predicate can use
+ */
+static int AK_selection_hash_lookup(char *srcTable, AK_selection_predicate *predicate, list_ad *candidates)
+{
+	hash_info *info;
+	list_ad *results;
+	element_ad last, element;
+	char indexName[MAX_ATT_NAME];
+	char *list, *token, *rest;
+	uint64_t *hashes;
+	int type, int_value, count = 1, found, i;
+	float float_value;
 
-    /*struct list_node *expr1 = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&expr1);
+	if ((strcmp(predicate->op, "=") != 0 && strcmp(predicate->op, "IN") != 0)
+			|| AK_hash_find(srcTable, predicate->attribute, indexName) != EXIT_SUCCESS)
+		return EXIT_ERROR;
+	info = AK_get_hash_info(indexName);
+	type = info->attribute_type[0];
+	AK_free(info);
+	/// AK_check_if_row_satisfies_expression compares the first sizeof(int) bytes of both values, so a hash of a
+	/// wider value would miss rows the condition holds for
+	if ((type != TYPE_INT && type != TYPE_FLOAT) || (strcmp(predicate->op, "=") == 0 && predicate->first->type != type))
+		return EXIT_ERROR;
 
-    char *destTable = "selection_test1";
-    int num = 2005;
-    strcpy(expr1->table,destTable);
-    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr1);
-    AK_InsertAtEnd_L3(TYPE_INT, &num, sizeof (int), expr1);
-    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr1);
-    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr1);
-    AK_InsertAtEnd_L3(TYPE_VARCHAR, "Robert", sizeof ("Robert"), expr1);
-    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr1);
-    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof("AND"), expr1);*/
+	if (strcmp(predicate->op, "=") == 0)
+	{
+		hashes = (uint64_t *) AK_malloc(sizeof (uint64_t));
+		hashes[0] = AK_hash_bytes(predicate->first->data, sizeof (int), 0);
+	}
+	else
+	{
+		/// IN: the list is split the way AK_check_if_row_satisfies_expression splits it
+		for (token = predicate->first->data; *token != '\0'; token++)
+			count += *token == ',';
+		hashes = (uint64_t *) AK_malloc(count * sizeof (uint64_t));
+		count = 0;
+		list = rest = strdup(predicate->first->data);
+		while ((token = strsep(&rest, ",")) != NULL)
+		{
+			if (type == TYPE_INT)
+			{
+				int_value = atoi(token);
+				hashes[count++] = AK_hash_bytes(&int_value, sizeof (int), 0);
+			}
+			else
+			{
+				float_value = atof(token);
+				hashes[count++] = AK_hash_bytes(&float_value, sizeof (float), 0);
+			}
+		}
+		free(list);
+	}
+
+	results = (list_ad *) AK_malloc(count * sizeof (list_ad));
+	for (i = 0; i < count; i++)
+		AK_InitializelistAd(&results[i]);
+	found = AK_hash_probe(indexName, hashes, count, results);
+	for (last = candidates; last->next != NULL; last = last->next);
+	for (i = 0; i < count; i++)
+	{
+		for (element = AK_Get_First_elementAd(&results[i]); found != EXIT_ERROR && element != NULL; element = AK_Get_Next_elementAd(element))
+		{
+			AK_Insert_NewelementAd(element->add.addBlock, element->add.indexTd, NULL, last);
+			last = last->next;
+		}
+		AK_Delete_All_elementsAd(&results[i]);
+	}
+	AK_free(results);
+	AK_free(hashes);
+	return found;
+}
 
-    AK_check_redo_log_select(SELECT, expr, srcTable);
+/**
+ * @brief Function that looks up the rows that may satisfy a predicate in an index on its attribute: a B+-tree, or
+ * for = and IN a hash index. The rows found are a superset of the rows the predicate holds for, the whole
+ * condition is checked on each of them. A stale index is rebuilt first.
+ * @param srcTable source table name
+ * @param predicate predicate
+ * @param candidates list the row addresses are appended to
+ * @return number of rows found, EXIT_ERROR if there is no index the predicate can use
+ */
+static int AK_selection_index_lookup(char *srcTable, AK_selection_predicate *predicate, list_ad *candidates)
+{
+	AK_bptree_meta meta;
+	char indexName[MAX_ATT_NAME];
+	char low[AK_BPTREE_VARCHAR_KEY + 1], high[AK_BPTREE_VARCHAR_KEY + 1];
+	char *list, *token, *rest;
+	int int_value, found, count;
+	float float_value;
 
-    //AK_DeleteAll_L3(&expr1);
+	if (AK_bptree_find(srcTable, predicate->attribute, indexName) != EXIT_SUCCESS
+			|| AK_bptree_get_meta(indexName, &meta) != EXIT_SUCCESS)
+		return AK_selection_hash_lookup(srcTable, predicate, candidates);
+	if (meta.stale && (AK_bptree_rebuild(indexName) != EXIT_SUCCESS || AK_bptree_get_meta(indexName, &meta) != EXIT_SUCCESS || meta.stale))
+		return AK_selection_hash_lookup(srcTable, predicate, candidates);
+	if (predicate->first->type != meta.key_type || (predicate->second != NULL && predicate->second->type != meta.key_type))
+		return EXIT_ERROR;
 
-		int startAddress = AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, t_header);
-		if (startAddress == EXIT_ERROR) {
-			AK_EPI;
+	if (strcmp(predicate->op, "=") == 0)
+	{
+		/// AK_check_if_row_satisfies_expression compares the first sizeof(int) bytes of both values
+		if (meta.key_size == sizeof (int))
+			return AK_bptree_search(indexName, predicate->first->data, predicate->first->data, candidates);
+		if (meta.key_type != TYPE_VARCHAR || strlen(predicate->first->data) < sizeof (int) - 1)
 			return EXIT_ERROR;
+		memset(low, 0, sizeof (low));
+		strncpy(low, predicate->first->data, sizeof (int));
+		if (strlen(low) < sizeof (int))
+			return AK_bptree_search(indexName, low, low, candidates);
+		memset(high, 0xff, AK_BPTREE_VARCHAR_KEY);
+		memcpy(high, low, sizeof (int));
+		high[AK_BPTREE_VARCHAR_KEY] = '\0';
+		return AK_bptree_search(indexName, low, high, candidates);
+	}
+	if (strcmp(predicate->op, "<") == 0 || strcmp(predicate->op, "<=") == 0)
+		return AK_bptree_search(indexName, NULL, predicate->first->data, candidates);
+	if (strcmp(predicate->op, ">") == 0 || strcmp(predicate->op, ">=") == 0)
+		return AK_bptree_search(indexName, predicate->first->data, NULL, candidates);
+	if (strcmp(predicate->op, "BETWEEN") == 0)
+		return AK_bptree_search(indexName, predicate->first->data, predicate->second->data, candidates);
+
+	/// IN: the list is split the way AK_check_if_row_satisfies_expression splits it
+	if (meta.key_type != TYPE_INT && meta.key_type != TYPE_FLOAT && meta.key_type != TYPE_VARCHAR)
+		return EXIT_ERROR;
+	count = 0;
+	list = rest = strdup(predicate->first->data);
+	while ((token = strsep(&rest, ",")) != NULL)
+	{
+		if (meta.key_type == TYPE_INT)
+		{
+			int_value = atoi(token);
+			found = AK_bptree_search(indexName, &int_value, &int_value, candidates);
 		}
-		AK_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s!\n", dstTable, srcTable);
-		table_addresses *src_addr = (table_addresses*) AK_get_table_addresses(srcTable);
-		
-		struct list_node * row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
-		AK_Init_L3(&row_root);
-		
-		int i, j, k, l, type, size, address;
-		char data[MAX_VARCHAR_LENGTH];
+		else if (meta.key_type == TYPE_FLOAT)
+		{
+			float_value = atof(token);
+			found = AK_bptree_search(indexName, &float_value, &float_value, candidates);
+		}
+		else
+			found = AK_bptree_search(indexName, token, token, candidates);
+		if (found == EXIT_ERROR)
+		{
+			count = EXIT_ERROR;
+			break;
+		}
+		count += found;
+	}
+	free(list);
+	return count;
+}
 
-		for (i = 0; src_addr->address_from[i] != 0; i++) {
+/**
+ * @brief Function that orders row addresses by block and tuple_dict entry (qsort comparator)
+ */
+static int AK_selection_compare_addresses(const void *a, const void *b)
+{
+	const struct_add *add_a = (const struct_add *) a;
+	const struct_add *add_b = (const struct_add *) b;
+	if (add_a->addBlock != add_b->addBlock)
+		return add_a->addBlock < add_b->addBlock ? -1 : 1;
+	return (add_a->indexTd > add_b->indexTd) - (add_a->indexTd < add_b->indexTd);
+}
 
-			for (j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
+/**
+ * @brief Function that chooses the index access path of a selection. Every predicate of the condition with an
+ * index on its attribute is looked up, and the one with the fewest rows is used.
+ * @param srcTable source table name
+ * @param expr list with postfix notation of the logical expression
+ * @param count number of row addresses returned
+ * @return row addresses in table order without duplicates, NULL if no index can be used
+ */
+static struct_add *AK_selection_index_candidates(char *srcTable, struct list_node *expr, int *count)
+{
+	AK_selection_predicate predicates[AK_SELECTION_MAX_PREDICATES];
+	list_ad *best = NULL, *list;
+	element_ad element;
+	struct_add *addresses;
+	int num_predicates, i, found, best_found = 0;
 
-				AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
-				if (temp->block->last_tuple_dict_id == 0)
-					break;
-				for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
+	num_predicates = AK_selection_find_predicates(expr, predicates);
+	for (i = 0; i < num_predicates && (best == NULL || best_found > 0); i++)
+	{
+		list = (list_ad *) AK_malloc(sizeof (list_ad));
+		AK_InitializelistAd(list);
+		found = AK_selection_index_lookup(srcTable, &predicates[i], list);
+		if (found != EXIT_ERROR && (best == NULL || found < best_found))
+		{
+			AK_dbg_messg(LOW, REL_OP, "AK_selection: %s %s on %s gives %d rows\n", predicates[i].attribute, predicates[i].op, srcTable, found);
+			if (best != NULL)
+			{
+				AK_Delete_All_elementsAd(best);
+				AK_free(best);
+			}
+			best = list;
+			best_found = found;
+			continue;
+		}
+		AK_Delete_All_elementsAd(list);
+		AK_free(list);
+	}
+	if (best == NULL)
+		return NULL;
 
-					if (temp->block->tuple_dict[k].type == FREE_INT)
-						break;
+	addresses = (struct_add *) AK_malloc((best_found + 1) * sizeof (struct_add));
+	for (i = 0, element = AK_Get_First_elementAd(best); element != NULL; element = AK_Get_Next_elementAd(element))
+		addresses[i++] = element->add;
+	AK_Delete_All_elementsAd(best);
+	AK_free(best);
 
-					for (l = 0; l < num_attr; l++) {
-						type = temp->block->tuple_dict[k + l].type;
-						size = temp->block->tuple_dict[k + l].size;
-						address = temp->block->tuple_dict[k + l].address;
-						memcpy(data, &(temp->block->data[address]), size);
-						data[size] = '\0';
-						AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
-					}
+	qsort(addresses, best_found, sizeof (struct_add), AK_selection_compare_addresses);
+	for (*count = 0, i = 0; i < best_found; i++)
+		if (*count == 0 || AK_selection_compare_addresses(&addresses[*count - 1], &addresses[i]) != 0)
+			addresses[(*count)++] = addresses[i];
+	return addresses;
+}
 
-					if (AK_check_if_row_satisfies_expression(row_root, expr))
-						AK_insert_row(row_root);
+/**
+ * @brief State of a selection in a pipeline
+ */
+typedef struct {
+	char table[MAX_ATT_NAME];
+	struct list_node *expr;
+	/// expr compiled for the header of the table, NULL if it is interpreted
+	AK_compiled_expression *program;
+	/// rows an index gives, NULL if the table is scanned
+	struct_add *candidates;
+	int count;
+	int candidate;
+	/// extents of a scan, the block and the tuple_dict entry of the next row, and its row number in the block
+	table_addresses *addresses;
+	int extent;
+	int block;
+	int slot;
+	int row;
+	/// read-ahead state of the scan
+	AK_cache_scan scan;
+	/// rows of the block that satisfy the condition, see AK_check_block_satisfies_compiled
+	int batch;
+	char selected[DATA_BLOCK_SIZE];
+	AK_tuple *tuple;
+} AK_selection_state;
 
-					
-					AK_DeleteAll_L3(&row_root);
-				}
-			}
+/**
+ * @brief Function that reads a row of the source table into the tuple of a selection and checks the condition
+ * @param state selection
+ * @param block block of the row
+ * @param k tuple_dict entry of the first attribute of the row
+ * @param check 0 for a row that is already known to satisfy the condition
+ * @return 1 if the row satisfies the condition, 0 otherwise
+ */
+static int AK_selection_check_tuple(AK_selection_state *state, AK_block *block, int k, int check)
+{
+	struct list_node *row_root;
+	int satisfies;
+
+	if (AK_tuple_from_block(state->tuple, block, k) != EXIT_SUCCESS)
+		return 0;
+	if (!check)
+		return 1;
+	if (state->program != NULL)
+		return AK_check_tuple_satisfies_compiled(state->program, state->tuple);
+
+	row_root = AK_tuple_to_list(state->tuple, 1);
+	satisfies = AK_check_if_row_satisfies_expression(row_root, state->expr);
+	AK_DeleteAll_L3(&row_root);
+	AK_free(row_root);
+	return satisfies;
+}
+
+/**
+ * @brief Function that opens a selection: it logs the selection and chooses between an index and a scan
+ * @param iterator selection
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_selection_open(AK_iterator *iterator)
+{
+	AK_selection_state *state = (AK_selection_state *) iterator->state;
+
+	AK_add_to_redolog_select(SELECT, state->expr, state->table);
+
+	//commented out code is for testing of AK_check_redo_log_select
+	//should be moved to a test
+
+	/*struct list_node *expr1 = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	AK_Init_L3(&expr1);
+
+	char *destTable = "selection_test1";
+	int num = 2005;
+	strcpy(expr1->table,destTable);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr1);
+	AK_InsertAtEnd_L3(TYPE_INT, &num, sizeof (int), expr1);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr1);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr1);
+	AK_InsertAtEnd_L3(TYPE_VARCHAR, "Robert", sizeof ("Robert"), expr1);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr1);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof("AND"), expr1);*/
+
+	AK_check_redo_log_select(SELECT, state->expr, state->table);
+
+	//AK_DeleteAll_L3(&expr1);
+
+	state->candidate = state->extent = state->block = state->slot = state->row = 0;
+	AK_cache_scan_hint(&state->scan, -1, -1);
+	state->candidates = AK_selection_index_candidates(state->table, state->expr, &state->count);
+	if (state->candidates == NULL)
+		state->addresses = (table_addresses *) AK_get_table_addresses(state->table);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that gives the next row of a selection
+ * @param iterator selection
+ * @return row or NULL
+ */
+static AK_tuple *AK_selection_next(AK_iterator *iterator)
+{
+	AK_selection_state *state = (AK_selection_state *) iterator->state;
+	int num_attr = iterator->schema->num_attr, satisfies;
+	struct_add *candidate;
+	AK_block *block;
+
+	if (state->candidates != NULL) {
+		while (state->candidate < state->count) {
+			candidate = &state->candidates[state->candidate++];
+			block = AK_get_block(candidate->addBlock)->block;
+			if (block->tuple_dict[candidate->indexTd].size > 0 && AK_selection_check_tuple(state, block, candidate->indexTd, 1))
+				return state->tuple;
 		}
+		return NULL;
+	}
 
-		AK_free(src_addr);
-		AK_free(t_header);
-		AK_free(row_root);
+	while (state->addresses != NULL && state->addresses->address_from[state->extent] != 0) {
+		if (state->block == 0) {
+			state->block = state->addresses->address_from[state->extent];
+			AK_cache_scan_hint(&state->scan, state->block, state->addresses->address_to[state->extent]);
+		}
+		block = state->block < state->addresses->address_to[state->extent] ? AK_get_block_scan(state->block, &state->scan)->block : NULL;
+		if (block == NULL || block->last_tuple_dict_id == 0) {
+			state->extent++;
+			state->block = 0;
+			continue;
+		}
+		/// the whole block is checked at once when it can be, only the selected rows are copied
+		if (state->slot == 0)
+			state->batch = state->program != NULL ? AK_check_block_satisfies_compiled(state->program, block, state->selected) : -1;
+		while (state->slot < DATA_BLOCK_SIZE && block->tuple_dict[state->slot].type != FREE_INT) {
+			/// rows deleted from the block are skipped, like AK_row_cursor_next skips them
+			if (block->tuple_dict[state->slot].size == 0)
+				satisfies = 0;
+			else if (state->batch == -1)
+				satisfies = AK_selection_check_tuple(state, block, state->slot, 1);
+			else
+				satisfies = state->selected[state->row] && AK_selection_check_tuple(state, block, state->slot, 0);
+			state->slot += num_attr;
+			state->row++;
+			if (satisfies)
+				return state->tuple;
+		}
+		state->block++;
+		state->slot = state->row = 0;
+	}
+	return NULL;
+}
 
-		AK_print_table(dstTable);
-	
+/**
+ * @brief Function that closes a selection
+ * @param iterator selection
+ */
+static void AK_selection_close(AK_iterator *iterator)
+{
+	AK_selection_state *state = (AK_selection_state *) iterator->state;
+
+	AK_free(state->candidates);
+	AK_free(state->addresses);
+	state->candidates = NULL;
+	state->addresses = NULL;
+	AK_cache_scan_hint(&state->scan, -1, -1);
+}
+
+/**
+ * @brief Function that frees the state of a selection
+ * @param iterator selection
+ */
+static void AK_selection_free(AK_iterator *iterator)
+{
+	AK_selection_state *state = (AK_selection_state *) iterator->state;
+
+	AK_free_compiled_expression(state->program);
+	AK_tuple_free(state->tuple);
+	AK_free(state);
+}
+
+/**
+ * @brief Function that creates the selection of a pipeline, which gives the rows of a table that satisfy a
+ * condition. When a predicate ANDed into the condition can be answered by a B+-tree or hash index on its attribute,
+ * only the rows the index returns are read; otherwise the table is scanned. The condition is compiled once for the
+ * header of the table, see AK_compile_expression, and a scan evaluates it over whole blocks when it can, see
+ * AK_check_block_satisfies_compiled.
+ * @param srcTable source table name
+ * @param expr list with postfix notation of the logical expression, it has to outlive the selection
+ * @return selection, NULL if the table does not exist
+ */
+AK_iterator *AK_selection_iterator(char *srcTable, struct list_node *expr)
+{
+	AK_selection_state *state;
+	AK_tuple_schema *schema;
+	AK_iterator *iterator;
+	AK_PRO;
+
+	schema = AK_tuple_schema_create(srcTable);
+	if (schema == NULL) {
+		AK_EPI;
+		return NULL;
+	}
+	state = (AK_selection_state *) AK_calloc(1, sizeof (AK_selection_state));
+	strncpy(state->table, srcTable, MAX_ATT_NAME - 1);
+	state->expr = expr;
+	state->program = AK_compile_expression(expr, schema->header, schema->num_attr);
+	state->tuple = AK_tuple_create(schema);
+	iterator = AK_iterator_create(schema, state, AK_selection_open, AK_selection_next, AK_selection_close);
+	iterator->free = AK_selection_free;
+	AK_EPI;
+	return iterator;
+}
+
+/**
+ * @author Matija Šestak.
+ * @brief  Function that which implements selection. The rows of the selection of a pipeline, see
+ * AK_selection_iterator, are written into the destination table.
+ * @param *srcTable source table name
+ * @param *dstTable destination table name
+ * @param *expr list with posfix notation of the logical expression
+ * @return EXIT_SUCCESS
+ */
+int AK_selection(char *srcTable, char *dstTable, struct list_node *expr) {
+	AK_iterator *selection;
+	int result;
+        AK_PRO;
+
+	selection = AK_selection_iterator(srcTable, expr);
+	if (selection == NULL) {
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	result = AK_iterator_materialize(selection, dstTable);
+	AK_iterator_free(selection);
+	if (result != EXIT_SUCCESS) {
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
+	AK_print_table(dstTable);
 
 	AK_dbg_messg(LOW, REL_OP, "SELECTION_TEST_SUCCESS\n\n");
 	AK_EPI;
@@ -115,6 +599,28 @@ int AK_selection(char *srcTable, char *dstTable, struct list_node *expr) {
 }
 
 
+/**
+ * @brief Function that checks whether two selection results hold the same rows in the same order, compared by the
+ * first attribute
+ * @return 1 if they do, 0 otherwise
+ */
+static int AK_selection_test_same_rows(char *tblName1, char *tblName2)
+{
+	int i, num_rows = AK_get_num_records(tblName1), same = num_rows == AK_get_num_records(tblName2);
+	struct list_node *row1, *row2;
+
+	for (i = 0; same && i < num_rows; i++) {
+		row1 = (struct list_node *) AK_get_row(i, tblName1);
+		row2 = (struct list_node *) AK_get_row(i, tblName2);
+		same = memcmp(get_row_attr_data(0, row1), get_row_attr_data(0, row2), sizeof (int)) == 0;
+		AK_DeleteAll_L3(&row1);
+		AK_free(row1);
+		AK_DeleteAll_L3(&row2);
+		AK_free(row2);
+	}
+	return same;
+}
+
 /**
  * @author Matija Šestak, updated by Dino Laktašić,Nikola Miljancic
  * @brief  Function for selection operator testing
@@ -135,7 +641,7 @@ TestResult AK_op_selection_test() { // test 31
 	int num = 2005;
 	strcpy(expr->table,destTable);
 	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr);
-	AK_InsertAtEnd_L3(TYPE_INT, &num, sizeof (int), expr);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *)&num, sizeof (int), expr);
 	AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
 	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
 	AK_InsertAtEnd_L3(TYPE_VARCHAR, "Robert", sizeof ("Robert"), expr);
@@ -181,8 +687,8 @@ TestResult AK_op_selection_test() { // test 31
 	int a = 2000;
     	int b = 2006;
     	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr);
-    	AK_InsertAtEnd_L3(TYPE_INT, &a, sizeof (int), expr);
-    	AK_InsertAtEnd_L3(TYPE_INT, &b, sizeof (int), expr);
+    	AK_InsertAtEnd_L3(TYPE_INT, (char *)&a, sizeof (int), expr);
+    	AK_InsertAtEnd_L3(TYPE_INT, (char *)&b, sizeof (int), expr);
     	AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), expr);
     	printf("\nQUERY: SELECT * FROM student WHERE year BETWEEN 2000 AND 2006';\n\n");
     	int sel2 = AK_selection(srcTable, destTable2, expr);
@@ -222,6 +728,143 @@ TestResult AK_op_selection_test() { // test 31
 		}
 	}
 
+	/// the same conditions give the same rows through B+-tree indices on year and firstname as through a scan
+	char *scanTables[] = {"selection_scan1", "selection_scan2", "selection_scan3", "selection_scan4"};
+	char *indexTables[] = {"selection_index1", "selection_index2", "selection_index3", "selection_index4"};
+	struct list_node *exprs[4];
+	int year = 2005, from = 2000, to = 2006, t;
+	char names[] = "Robert,Ivan,Matija";
+
+	for (t = 0; t < 4; t++) {
+		exprs[t] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+		AK_Init_L3(&exprs[t]);
+	}
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), exprs[0]);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *)&from, sizeof (int), exprs[0]);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *)&to, sizeof (int), exprs[0]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), exprs[0]);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *)&year, sizeof (int), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_VARCHAR, "Robert", sizeof ("Robert"), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *)&year, sizeof (int), exprs[2]);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), exprs[2]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), exprs[2]);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), exprs[3]);
+	AK_InsertAtEnd_L3(TYPE_VARCHAR, names, sizeof (names), exprs[3]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "IN", sizeof ("IN"), exprs[3]);
+
+	printf("\nQUERY: the same selections without and with B+-tree indices on year and firstname\n\n");
+	for (t = 0; t < 4; t++)
+		AK_selection(srcTable, scanTables[t], exprs[t]);
+	AK_bptree_create(srcTable, "year", "student_year_bptree");
+	AK_bptree_create(srcTable, "firstname", "student_firstname_bptree");
+	int local_fail = 0;
+	for (t = 0; t < 4; t++)
+		if (AK_selection(srcTable, indexTables[t], exprs[t]) != EXIT_SUCCESS || !AK_selection_test_same_rows(scanTables[t], indexTables[t]))
+			local_fail = 1;
+	if (!local_fail && AK_get_num_records(indexTables[0]) == 7 && AK_get_num_records(indexTables[1]) == 1) {
+		printf("\n Selection test 3 (index access path) succeeded.\n");
+		successful++;
+	}
+	else {
+		printf("\n Selection test 3 (index access path) failed.\n");
+		failed++;
+	}
+
+	/// an inserted row is added to the indices and a deleted one is removed from them
+	struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	int new_mbr = 35999, new_year = 2010;
+	float new_weight = 80.00;
+	AK_Init_L3(&row_root);
+	AK_Insert_New_Element(TYPE_INT, &new_mbr, srcTable, "mbr", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "Robert", srcTable, "firstname", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "Index", srcTable, "lastname", row_root);
+	AK_Insert_New_Element(TYPE_INT, &new_year, srcTable, "year", row_root);
+	AK_Insert_New_Element(TYPE_FLOAT, &new_weight, srcTable, "weight", row_root);
+	AK_insert_row(row_root);
+	AK_DeleteAll_L3(&row_root);
+	AK_selection(srcTable, "selection_index5", exprs[1]);
+
+	AK_Update_Existing_Element(TYPE_INT, &new_mbr, srcTable, "mbr", row_root);
+	AK_delete_row(row_root);
+	AK_DeleteAll_L3(&row_root);
+	AK_free(row_root);
+	AK_selection(srcTable, "selection_index6", exprs[1]);
+	/// the delete is applied to the tree, which is not left to be rebuilt
+	AK_bptree_meta year_meta;
+	if (AK_get_num_records("selection_index5") == 2 && AK_selection_test_same_rows(scanTables[1], "selection_index6")
+			&& AK_bptree_get_meta("student_year_bptree", &year_meta) == EXIT_SUCCESS && !year_meta.stale) {
+		printf("\n Selection test 4 (index maintenance) succeeded.\n");
+		successful++;
+	}
+	else {
+		printf("\n Selection test 4 (index maintenance) failed.\n");
+		failed++;
+	}
+
+	AK_bptree_drop("student_year_bptree");
+	AK_bptree_drop("student_firstname_bptree");
+	for (t = 0; t < 4; t++) {
+		AK_DeleteAll_L3(&exprs[t]);
+		AK_free(exprs[t]);
+	}
+
+	/// = and IN on an attribute with a hash index read only the rows the index gives
+	char *hashScanTables[] = {"selection_hash_scan1", "selection_hash_scan2"};
+	char *hashTables[] = {"selection_hash1", "selection_hash2"};
+	struct list_node *key = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	struct_add *candidates;
+	int hash_mbr = 35893, num_candidates;
+	char mbrs[] = "35891,35895,35899";
+
+	for (t = 0; t < 2; t++) {
+		exprs[t] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+		AK_Init_L3(&exprs[t]);
+	}
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), exprs[0]);
+	AK_InsertAtEnd_L3(TYPE_INT, (char *)&hash_mbr, sizeof (int), exprs[0]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), exprs[0]);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_VARCHAR, mbrs, sizeof (mbrs), exprs[1]);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, "IN", sizeof ("IN"), exprs[1]);
+	AK_Init_L3(&key);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), key);
+
+	printf("\nQUERY: the same selections without and with a hash index on mbr\n\n");
+	AK_delete_hash_index("student_mbr_hash");
+	for (t = 0; t < 2; t++)
+		AK_selection(srcTable, hashScanTables[t], exprs[t]);
+	AK_create_hash_index(srcTable, key, "student_mbr_hash");
+	local_fail = 0;
+	for (t = 0; t < 2; t++) {
+		candidates = AK_selection_index_candidates(srcTable, exprs[t], &num_candidates);
+		if (candidates == NULL || num_candidates < AK_get_num_records(hashScanTables[t]))
+			local_fail = 1;
+		AK_free(candidates);
+		if (AK_selection(srcTable, hashTables[t], exprs[t]) != EXIT_SUCCESS || !AK_selection_test_same_rows(hashScanTables[t], hashTables[t]))
+			local_fail = 1;
+	}
+	if (!local_fail && AK_get_num_records(hashTables[0]) == 1) {
+		printf("\n Selection test 5 (hash index access path) succeeded.\n");
+		successful++;
+	}
+	else {
+		printf("\n Selection test 5 (hash index access path) failed.\n");
+		failed++;
+	}
+
+	AK_delete_hash_index("student_mbr_hash");
+	for (t = 0; t < 2; t++) {
+		AK_DeleteAll_L3(&exprs[t]);
+		AK_free(exprs[t]);
+	}
+	AK_DeleteAll_L3(&key);
+	AK_free(key);
+
 	if (failed == 0) {
 		printf("\n All tests finished successfully. :)\n");
 	}
@@ -256,7 +899,7 @@ TestResult AK_op_selection_test_pattern() { //test 32
     	strcpy(expr->table,destTable3);
     	char expression []= "%in%";
     	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
-    	AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression, sizeof (char), expr);
+    	AK_InsertAtEnd_L3(TYPE_VARCHAR, (char *)&expression, sizeof (char), expr);
     	AK_InsertAtEnd_L3(TYPE_OPERATOR, "LIKE", sizeof ("LIKE"), expr);
     	printf("\nQUERY: SELECT * FROM student WHERE firstname Like .*in.*;\n\n");
 	int sel3 = AK_selection(srcTable, destTable3, expr);
@@ -303,7 +946,7 @@ TestResult AK_op_selection_test_pattern() { //test 32
     	strcpy(expr->table,destTable4);
     	char expression2 []= "%dino%";
     	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
-    	AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression2, sizeof (char), expr);
+    	AK_InsertAtEnd_L3(TYPE_VARCHAR, (char *)&expression2, sizeof (char), expr);
     	AK_InsertAtEnd_L3(TYPE_OPERATOR, "ILIKE", sizeof ("ILIKE"), expr);
     	printf("\nQUERY: SELECT * FROM student WHERE firstname ILIKE .*dino.*;\n\n");
 	int sel4 = AK_selection(srcTable, destTable4, expr);
@@ -337,7 +980,7 @@ TestResult AK_op_selection_test_pattern() { //test 32
     	strcpy(expr->table,destTable5);
     	char expression3 []= "%(d|i)%";
     	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
-   	AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression3, sizeof (char), expr);
+   	AK_InsertAtEnd_L3(TYPE_VARCHAR, (char *)&expression3, sizeof (char), expr);
     	AK_InsertAtEnd_L3(TYPE_OPERATOR, "SIMILAR TO", sizeof ("SIMILAR TO"), expr);
     	printf("\nQUERY: SELECT * FROM student WHERE firstname SIMILAR TO .*(d|i).*;\n\n");
 	int sel5 = AK_selection(srcTable, destTable5, expr);
@@ -382,7 +1025,7 @@ TestResult AK_op_selection_test_pattern() { //test 32
     	strcpy(expr->table,destTable6);
     	char expression4 []= "^D";
     	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr);
-    	AK_InsertAtEnd_L3(TYPE_VARCHAR, &expression4, sizeof (char), expr);
+    	AK_InsertAtEnd_L3(TYPE_VARCHAR, (char *)&expression4, sizeof (char), expr);
     	AK_InsertAtEnd_L3(TYPE_OPERATOR, "~", sizeof ("~"), expr);
     	printf("\nQUERY: SELECT * FROM student WHERE firstname ~ '^D' ;\n\n");
     	int sel6 = AK_selection(srcTable, destTable6, expr);
@@ -458,11 +1101,14 @@ int AK_selection_op_rename(char *srcTable, char *dstTable, struct list_node *exp
 		int i, j, k, l, type, size, address;
 		char data[MAX_VARCHAR_LENGTH];
 
+		AK_cache_scan scan;
+
 		for (i = 0; src_addr->address_from[i] != 0; i++) {
 
+			AK_cache_scan_hint(&scan, src_addr->address_from[i], src_addr->address_to[i]);
 			for (j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
 
-				AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
+				AK_mem_block *temp = (AK_mem_block *) AK_get_block_scan(j, &scan);
 				if (temp->block->last_tuple_dict_id == 0)
 					break;
 				for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
@@ -22,12 +22,21 @@
 
 #include "../auxi/test.h"
 #include "expression_check.h"
+#include "iterator.h"
 #include "../rec/redo_log.h"
 #include "../auxi/constants.h"
 #include "../auxi/configuration.h"
 #include "../file/files.h"
+#include "../file/idx/bptree.h"
+#include "../file/idx/hash.h"
 #include "../auxi/mempro.h"
 
+/**
+ * @def AK_SELECTION_MAX_PREDICATES
+ * @brief Maximum number of ANDed predicates of a selection that are considered for an index lookup
+ */
+#define AK_SELECTION_MAX_PREDICATES 16
+
 
 /**
  * @author Matija Šestak.
@@ -38,6 +47,7 @@
  * @return EXIT_SUCCESS
  */
 int AK_selection(char *srcTable, char *dstTable, struct list_node *expr);
+AK_iterator *AK_selection_iterator(char *srcTable, struct list_node *expr);
 TestResult AK_op_selection_test();
 TestResult AK_op_selection_test_pattern();
 
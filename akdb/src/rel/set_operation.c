@@ -0,0 +1,451 @@
+/**
+@file set_operation.c Provides functions for the hash-based union, intersect and difference of two tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "set_operation.h"
+
+/*
+ * Every distinct row of the inputs is kept once in an arena and chained by the hash of its types and bytes, together
+ * with the inputs it was seen in. The first table is read first, so the result keeps the order in which rows first
+ * appear in it. An intersect or a difference only marks the rows of the second table that are already known, so only
+ * the distinct rows of the first table are held. When they do not fit into WORK_MEMORY, both inputs are split by
+ * the hash of their rows into AK_SET_PARTITIONS temporary segments and every pair of partitions is processed the same
+ * way. Equal rows always land in the same partition, so the results of the partitions never overlap.
+ */
+
+/**
+ * @brief Distinct row: the hash of its values and the next row of its chain, -1 for none
+ */
+typedef struct {
+    uint64_t hash;
+    int next;
+    /// bit 0 if the row is in the first input, bit 1 if it is in the second one
+    int sides;
+} AK_set_row;
+
+/**
+ * @brief Hash table of distinct rows
+ */
+typedef struct {
+    /// values of the rows, a row has the same number in the arena and in rows
+    AK_tuple_arena arena;
+    AK_set_row *rows;
+    int rows_capacity;
+    /// first row of every chain, -1 for none, the number of buckets is a power of two
+    int *buckets;
+    int num_buckets;
+} AK_set_table;
+
+static int AK_set_run(char **tables, char *dstTable, AK_header *header, int operation, int depth);
+
+/**
+ * @brief Function that computes the hash of a whole row
+ * @param values values of the row
+ * @param num_values number of values
+ * @return hash value
+ */
+static uint64_t AK_set_row_hash(AK_value *values, int num_values)
+{
+    uint64_t hash = 0;
+    int i;
+
+    for (i = 0; i < num_values; i++)
+    {
+        hash = AK_hash_bytes(&values[i].type, sizeof (int), hash);
+        hash = AK_hash_bytes(values[i].data, AK_tuple_key_size(&values[i]), hash);
+    }
+    return hash;
+}
+
+/**
+ * @brief Function that compares a row with a row of the hash table
+ * @param table hash table
+ * @param row row number in the table
+ * @param values values of the other row
+ * @param num_values number of values
+ * @return 1 if the rows are equal, 0 otherwise
+ */
+static int AK_set_row_equal(AK_set_table *table, int row, AK_value *values, int num_values)
+{
+    AK_value stored[MAX_ATTRIBUTES];
+    int i, size;
+
+    if (AK_tuple_arena_values(&table->arena, row, stored) != num_values)
+        return 0;
+    for (i = 0; i < num_values; i++)
+    {
+        size = AK_tuple_key_size(&values[i]);
+        if (stored[i].type != values[i].type || AK_tuple_key_size(&stored[i]) != size
+                || memcmp(stored[i].data, values[i].data, size) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Function that doubles the number of buckets of a hash table and chains its rows again
+ * @param table hash table
+ */
+static void AK_set_rehash(AK_set_table *table)
+{
+    int i, bucket;
+
+    AK_free(table->buckets);
+    table->num_buckets = table->num_buckets ? table->num_buckets * 2 : 16;
+    table->buckets = (int *) AK_malloc(table->num_buckets * sizeof (int));
+    for (i = 0; i < table->num_buckets; i++)
+        table->buckets[i] = -1;
+    for (i = table->arena.num_rows - 1; i >= 0; i--)
+    {
+        bucket = table->rows[i].hash & (table->num_buckets - 1);
+        table->rows[i].next = table->buckets[bucket];
+        table->buckets[bucket] = i;
+    }
+}
+
+/**
+ * @brief Function that looks a row up in a hash table
+ * @param table hash table
+ * @param values values of the row
+ * @param num_values number of values
+ * @param hash hash of the row
+ * @return row number, -1 if the row is not in the table
+ */
+static int AK_set_find(AK_set_table *table, AK_value *values, int num_values, uint64_t hash)
+{
+    int i;
+
+    if (table->num_buckets == 0)
+        return -1;
+    for (i = table->buckets[hash & (table->num_buckets - 1)]; i != -1; i = table->rows[i].next)
+        if (table->rows[i].hash == hash && AK_set_row_equal(table, i, values, num_values))
+            return i;
+    return -1;
+}
+
+/**
+ * @brief Function that copies a row into the arena of a hash table and chains it
+ * @param table hash table
+ * @param values values of the row
+ * @param num_values number of values
+ * @param hash hash of the row
+ * @return row number
+ */
+static int AK_set_add(AK_set_table *table, AK_value *values, int num_values, uint64_t hash)
+{
+    int row, bucket;
+
+    row = AK_tuple_arena_add(&table->arena, values, num_values);
+    if (row == table->rows_capacity)
+    {
+        table->rows_capacity = table->rows_capacity ? table->rows_capacity * 2 : 64;
+        table->rows = (AK_set_row *) AK_realloc(table->rows, table->rows_capacity * sizeof (AK_set_row));
+    }
+    table->rows[row].hash = hash;
+    table->rows[row].sides = 0;
+
+    if (table->arena.num_rows > table->num_buckets)
+        AK_set_rehash(table);
+    else
+    {
+        bucket = hash & (table->num_buckets - 1);
+        table->rows[row].next = table->buckets[bucket];
+        table->buckets[bucket] = row;
+    }
+    return row;
+}
+
+/**
+ * @brief Function that frees a hash table
+ * @param table hash table
+ */
+static void AK_set_free(AK_set_table *table)
+{
+    AK_tuple_arena_free(&table->arena);
+    AK_free(table->rows);
+    AK_free(table->buckets);
+}
+
+/**
+ * @brief Function that names a temporary partition of a set operation input after the result table
+ * @param name partition name, MAX_ATT_NAME bytes
+ * @param dstTable result table
+ * @param depth partitioning level
+ * @param side input the partition holds rows of
+ * @param partition partition number
+ * @return length of the whole name, MAX_ATT_NAME or more if it was cut
+ */
+static int AK_set_partition_name(char *name, char *dstTable, int depth, int side, int partition)
+{
+    return snprintf(name, MAX_ATT_NAME, "%s_so%d_%d_%d", dstTable, depth, side, partition);
+}
+
+/**
+ * @brief Function that splits both inputs into temporary segments by the hash of their rows and processes every
+ * pair of partitions
+ * @param tables names of the first and of the second input, NULL for an empty input
+ * @param dstTable result table
+ * @param header header of the inputs
+ * @param operation AK_SET_UNION, AK_SET_INTERSECT or AK_SET_DIFFERENCE
+ * @param depth number of times the inputs were already partitioned
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_partition(char **tables, char *dstTable, AK_header *header, int operation, int depth)
+{
+    char names[2][AK_SET_PARTITIONS][MAX_ATT_NAME];
+    int counts[2][AK_SET_PARTITIONS];
+    AK_value values[MAX_ATTRIBUTES];
+    AK_row_cursor cursor;
+    AK_tuple_schema *schema;
+    AK_tuple *tuple;
+    struct list_node *row_root;
+    char *partition[2];
+    int side, p, n, result = EXIT_SUCCESS;
+
+    AK_dbg_messg(LOW, REL_OP, "AK_set_operation: %s does not fit into %d KB, partitioning level %d\n", tables[0], WORK_MEMORY, depth);
+    memset(counts, 0, sizeof (counts));
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    for (side = 0; side < 2; side++)
+    {
+        if (tables[side] == NULL)
+            continue;
+        schema = AK_tuple_schema_create(tables[side]);
+        tuple = AK_tuple_create(schema);
+        AK_row_cursor_open(&cursor, tables[side]);
+        while (schema != NULL && AK_row_cursor_next_tuple(&cursor, tuple) == EXIT_SUCCESS)
+        {
+            n = AK_tuple_values(tuple, values);
+            p = AK_tuple_partition(AK_set_row_hash(values, n), depth);
+            /// partitions are created when their first row arrives
+            if (counts[side][p]++ == 0)
+            {
+                AK_set_partition_name(names[side][p], dstTable, depth, side, p);
+                AK_initialize_new_segment(names[side][p], SEGMENT_TYPE_TABLE, header);
+            }
+            AK_tuple_insert_values(names[side][p], header, values, n, row_root);
+        }
+        AK_tuple_free(tuple);
+        AK_tuple_schema_free(schema);
+    }
+    AK_free(row_root);
+
+    for (p = 0; p < AK_SET_PARTITIONS; p++)
+    {
+        /// a partition without rows of the first input adds nothing to an intersect or a difference
+        if (counts[0][p] > 0 || (operation == AK_SET_UNION && counts[1][p] > 0))
+        {
+            partition[0] = counts[0][p] > 0 ? names[0][p] : NULL;
+            partition[1] = counts[1][p] > 0 ? names[1][p] : NULL;
+            if (AK_set_run(partition, dstTable, header, operation, depth + 1) != EXIT_SUCCESS)
+                result = EXIT_ERROR;
+        }
+        for (side = 0; side < 2; side++)
+            if (counts[side][p] > 0)
+                AK_delete_segment(names[side][p], SEGMENT_TYPE_TABLE);
+    }
+    return result;
+}
+
+/**
+ * @brief Function that collects the distinct rows of both inputs in a hash table and writes the ones the operation
+ * keeps into the result table
+ * @param tables names of the first and of the second input, NULL for an empty input
+ * @param dstTable result table
+ * @param header header of the inputs
+ * @param operation AK_SET_UNION, AK_SET_INTERSECT or AK_SET_DIFFERENCE
+ * @param depth number of times the inputs were already partitioned
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_run(char **tables, char *dstTable, AK_header *header, int operation, int depth)
+{
+    AK_set_table table;
+    AK_value values[MAX_ATTRIBUTES];
+    AK_row_cursor cursor;
+    AK_tuple_schema *schema;
+    AK_tuple *tuple;
+    struct list_node *row_root;
+    long budget = (long) WORK_MEMORY * 1024;
+    uint64_t hash;
+    int side, n, i, keep;
+
+    memset(&table, 0, sizeof (AK_set_table));
+    for (side = 0; side < 2; side++)
+    {
+        if (tables[side] == NULL)
+            continue;
+        schema = AK_tuple_schema_create(tables[side]);
+        tuple = AK_tuple_create(schema);
+        AK_row_cursor_open(&cursor, tables[side]);
+        while (schema != NULL && AK_row_cursor_next_tuple(&cursor, tuple) == EXIT_SUCCESS)
+        {
+            n = AK_tuple_values(tuple, values);
+            hash = AK_set_row_hash(values, n);
+            i = AK_set_find(&table, values, n, hash);
+            if (i == -1 && (side == 0 || operation == AK_SET_UNION))
+                i = AK_set_add(&table, values, n, hash);
+            if (i != -1)
+                table.rows[i].sides |= 1 << side;
+            /// a single distinct row cannot be split any further
+            if (depth < AK_SET_MAX_DEPTH && table.arena.num_rows > 1 && table.arena.size + (long) table.arena.num_rows * (sizeof (int) + sizeof (AK_set_row))
+                    + (long) table.num_buckets * sizeof (int) > budget)
+            {
+                AK_tuple_free(tuple);
+                AK_tuple_schema_free(schema);
+                AK_set_free(&table);
+                return AK_set_partition(tables, dstTable, header, operation, depth);
+            }
+        }
+        AK_tuple_free(tuple);
+        AK_tuple_schema_free(schema);
+    }
+    AK_dbg_messg(MIDDLE, REL_OP, "AK_set_operation: %d distinct rows in %d buckets\n", table.arena.num_rows, table.num_buckets);
+
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    for (i = 0; i < table.arena.num_rows; i++)
+    {
+        if (operation == AK_SET_INTERSECT)
+            keep = table.rows[i].sides == 3;
+        else if (operation == AK_SET_DIFFERENCE)
+            keep = table.rows[i].sides == 1;
+        else
+            keep = 1;
+        if (keep)
+        {
+            n = AK_tuple_arena_values(&table.arena, i, values);
+            AK_tuple_insert_values(dstTable, header, values, n, row_root);
+        }
+    }
+    AK_free(row_root);
+    AK_set_free(&table);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that computes the union, intersect or difference of two tables with the same attributes into a
+ * new table. Duplicate rows are removed, so every row of the result is distinct. Both tables are read once unless
+ * their distinct rows do not fit into WORK_MEMORY and both are partitioned first.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @param operation AK_SET_UNION, AK_SET_INTERSECT or AK_SET_DIFFERENCE
+ * @return EXIT_SUCCESS, EXIT_ERROR if a table does not exist or the tables have different attributes
+ */
+int AK_set_operation(char *srcTable1, char *srcTable2, char *dstTable, int operation)
+{
+    AK_header *header1, *header2;
+    char *tables[2], name[MAX_ATT_NAME];
+    int num_att, i, result;
+    AK_PRO;
+
+    /// a cut partition name could be the name of another segment, so such an operation is not run
+    if (AK_set_partition_name(name, dstTable, AK_SET_MAX_DEPTH, 1, AK_SET_PARTITIONS - 1) >= MAX_ATT_NAME)
+    {
+        AK_dbg_messg(LOW, REL_OP, "\nAK_set_operation: name of table %s is too long", dstTable);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    num_att = AK_num_attr(srcTable1);
+    if (num_att <= 0 || AK_num_attr(srcTable2) <= 0)
+    {
+        AK_dbg_messg(LOW, REL_OP, "\nAK_set_operation: Table/s doesn't exist!");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_num_attr(srcTable2) != num_att)
+    {
+        printf("Set operation ERROR: Not same number of the attributes! \n");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    header1 = (AK_header *) AK_get_header(srcTable1);
+    header2 = (AK_header *) AK_get_header(srcTable2);
+    for (i = 0; i < num_att; i++)
+    {
+        if (strcmp(header1[i].att_name, header2[i].att_name) != 0 || header1[i].type != header2[i].type)
+        {
+            printf("Set operation ERROR: Relation shemas are not the same! \n");
+            AK_free(header1);
+            AK_free(header2);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    AK_free(header2);
+
+    AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, header1);
+    tables[0] = srcTable1;
+    tables[1] = srcTable2;
+    result = AK_set_run(tables, dstTable, header1, operation, 0);
+    AK_free(header1);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that checks the rows of a table by the values of a VARCHAR attribute, the result the set
+ * operation tests check the operations against
+ * @param tblName table name
+ * @param attName VARCHAR attribute
+ * @param values expected values, in any order, each one as many times as there must be rows with it
+ * @param num_values number of expected values
+ * @return 1 if the table has exactly the expected rows, 0 otherwise
+ */
+int AK_set_operation_rows_match(char *tblName, char *attName, char **values, int num_values)
+{
+    AK_row_cursor cursor;
+    struct list_node *row, *value;
+    int *used;
+    int position, i, match = 1, num_rows = 0;
+    AK_PRO;
+
+    position = AK_get_attr_index(tblName, attName) + 1;
+    if (position <= 0 || AK_row_cursor_open(&cursor, tblName) != EXIT_SUCCESS)
+    {
+        AK_EPI;
+        return num_values == 0;
+    }
+    used = (int *) AK_calloc(num_values > 0 ? num_values : 1, sizeof (int));
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        value = AK_GetNth_L2(position, row);
+        for (i = 0; i < num_values; i++)
+            if (!used[i] && value->size == (int) strlen(values[i]) && memcmp(value->data, values[i], value->size) == 0)
+                break;
+        if (i < num_values)
+            used[i] = 1;
+        else
+        {
+            printf("AK_set_operation_rows_match: unexpected row %.*s in %s\n", value->size, value->data, tblName);
+            match = 0;
+        }
+        num_rows++;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    if (num_rows != num_values)
+    {
+        printf("AK_set_operation_rows_match: %s has %d rows instead of %d\n", tblName, num_rows, num_values);
+        match = 0;
+    }
+    AK_free(used);
+    AK_EPI;
+    return match;
+}
@@ -0,0 +1,63 @@
+/**
+@file set_operation.h Header file that provides functions for the hash-based union, intersect and difference of two tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SET_OPERATION
+#define SET_OPERATION
+
+#include "../auxi/test.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../file/idx/hash.h"
+#include "../auxi/mempro.h"
+#include "hash_join.h"
+
+/**
+ * @def AK_SET_UNION
+ * @brief Rows that are in the first or in the second table
+ */
+#define AK_SET_UNION 1
+
+/**
+ * @def AK_SET_INTERSECT
+ * @brief Rows that are in both tables
+ */
+#define AK_SET_INTERSECT 2
+
+/**
+ * @def AK_SET_DIFFERENCE
+ * @brief Rows of the first table that are not in the second one
+ */
+#define AK_SET_DIFFERENCE 3
+
+/**
+ * @def AK_SET_PARTITIONS
+ * @brief Number of partitions the inputs are split into when their distinct rows do not fit into WORK_MEMORY
+ */
+#define AK_SET_PARTITIONS AK_TUPLE_PARTITIONS
+
+/**
+ * @def AK_SET_MAX_DEPTH
+ * @brief Number of times a partition may be partitioned again, deeper partitions are processed in memory regardless
+ */
+#define AK_SET_MAX_DEPTH 4
+
+int AK_set_operation(char *srcTable1, char *srcTable2, char *dstTable, int operation);
+int AK_set_operation_rows_match(char *tblName, char *attName, char **values, int num_values);
+
+#endif
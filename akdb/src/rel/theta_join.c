@@ -139,18 +139,18 @@ int AK_create_theta_join_header(char *srcTable1, char * srcTable2, char *new_tab
 }
 
 /**
- * @author Tomislav Mikulček
- * @brief Function that iterates through blocks of the two tables and copies the rows which pass the constraint check into the new table
+ * @brief Function that joins the rows of two blocks and copies those which pass the constraint check into the new table
  * @param tbl1_temp_block block of the first table
  * @param tbl2_temp_block block of the second join table
  * @param tbl1_num_att number of attributes in the first table
  * @param tbl2_num_att number of attributes in the second table
  * @param constraints list of attributes, (in)equality and logical operators which are the conditions for the join in postfix notation
+ * @param program constraints compiled for t_header, NULL to interpret them
+ * @param t_header header of the theta_join table
  * @param new_table name of the theta_join table
- * @return No return value
  */
-void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, char *new_table) {
-    AK_PRO;
+static void AK_theta_join_blocks(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att,
+        struct list_node *constraints, AK_compiled_expression *program, AK_header *t_header, char *new_table) {
     AK_dbg_messg(HIGH, REL_OP, "\n COPYING THETA JOIN");
 
     int tbl1_att, tbl2_att, tbl1_row, tbl2_row;
@@ -160,8 +160,6 @@ void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block,
     struct list_node *row_root_init = (struct list_node *) AK_malloc(sizeof (struct list_node));
     struct list_node *row_root_full;
 
-    AK_header *t_header = (AK_header *) AK_get_header(new_table);
-
     AK_Init_L3(&row_root_init);
 
     for (tbl1_row = 0; tbl1_row < DATA_BLOCK_SIZE; tbl1_row += tbl1_num_att){
@@ -195,9 +193,17 @@ void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block,
 				AK_Insert_New_Element(type, data, new_table, t_header[tbl1_att + tbl2_att].att_name, row_root_full);
 			}
 
-			if (AK_check_if_row_satisfies_expression(row_root_full, constraints)){
+			if (program != NULL ? AK_check_if_row_satisfies_compiled(program, row_root_full)
+					: AK_check_if_row_satisfies_expression(row_root_full, constraints)){
     			AK_insert_row(row_root_full);
 			}
+
+			/// the attributes of the next row of the second table go in front of the first row again
+			for (tbl2_att = 0; tbl2_att < tbl2_num_att; tbl2_att++){
+				row_root_full = row_root_init->next;
+				row_root_init->next = row_root_full->next;
+				AK_free(row_root_full);
+			}
     	}
 
     	
@@ -205,14 +211,126 @@ void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block,
     }
 
     AK_free(row_root_init);
+}
+
+/**
+ * @author Tomislav Mikulček
+ * @brief Function that iterates through blocks of the two tables and copies the rows which pass the constraint check into the new table
+ * @param tbl1_temp_block block of the first table
+ * @param tbl2_temp_block block of the second join table
+ * @param tbl1_num_att number of attributes in the first table
+ * @param tbl2_num_att number of attributes in the second table
+ * @param constraints list of attributes, (in)equality and logical operators which are the conditions for the join in postfix notation
+ * @param new_table name of the theta_join table
+ * @return No return value
+ */
+void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, int tbl1_num_att, int tbl2_num_att, struct list_node *constraints, char *new_table) {
+    AK_PRO;
+    AK_header *t_header = (AK_header *) AK_get_header(new_table);
+    AK_compiled_expression *program = AK_compile_expression(constraints, t_header, tbl1_num_att + tbl2_num_att);
+
+    AK_theta_join_blocks(tbl1_temp_block, tbl2_temp_block, tbl1_num_att, tbl2_num_att, constraints, program, t_header, new_table);
+
+    AK_free_compiled_expression(program);
+    AK_free(t_header);
     AK_EPI;
 }
 
+/**
+ * @brief Function that describes a theta join whose constraints compare an attribute of the first with an attribute
+ * of the second table, joined by AND, as a join for AK_hash_join or AK_merge_join. Any number of equalities and at
+ * most one of <, <=, > and >= are taken, the last one only for INT, FLOAT, NUMBER and VARCHAR attributes, which
+ * AK_sort_table orders the way the comparison does.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param constraints conditions of the join in postfix notation
+ * @param dstTable name of the theta join table, its header is already created
+ * @param spec description of the join
+ * @return EXIT_SUCCESS, EXIT_ERROR if the constraints are not such comparisons
+ */
+static int AK_theta_join_spec(char *srcTable1, char *srcTable2, struct list_node *constraints, char *dstTable, AK_join_spec *spec) {
+    AK_header *t_header = (AK_header *) AK_get_header(dstTable);
+    struct list_node *el;
+    /// attribute positions in the result header, -1 for a comparison or a conjunction of comparisons
+    int stack[MAX_TOKENS];
+    int tbl1_num_att = AK_num_attr(srcTable1);
+    int num_att = tbl1_num_att + AK_num_attr(srcTable2);
+    int top = 0, i, a, b, type, result = EXIT_SUCCESS;
+    const char *op;
+
+    memset(spec, 0, sizeof (AK_join_spec));
+    spec->table[0] = srcTable1;
+    spec->table[1] = srcTable2;
+    spec->dstTable = dstTable;
+
+    for (el = AK_First_L2(constraints); el != NULL && result == EXIT_SUCCESS; el = AK_Next_L2(el)) {
+        if (el->type == TYPE_ATTRIBS && top < MAX_TOKENS) {
+            for (i = 0; i < num_att; i++)
+                if (strcmp(t_header[i].att_name, el->data) == 0)
+                    break;
+            stack[top++] = i;
+            if (i == num_att)
+                result = EXIT_ERROR;
+        } else if (el->type == TYPE_OPERATOR && strcmp(el->data, "=") == 0 && top >= 2 && stack[top - 1] >= 0 && stack[top - 2] >= 0) {
+            a = stack[top - 2] < stack[top - 1] ? stack[top - 2] : stack[top - 1];
+            b = stack[top - 2] < stack[top - 1] ? stack[top - 1] : stack[top - 2];
+            /// one attribute of each table, of the same type
+            if (a >= tbl1_num_att || b < tbl1_num_att || t_header[a].type != t_header[b].type || spec->num_keys == MAX_ATTRIBUTES) {
+                result = EXIT_ERROR;
+                break;
+            }
+            spec->keys[0][spec->num_keys] = a;
+            spec->keys[1][spec->num_keys] = b - tbl1_num_att;
+            spec->num_keys++;
+            top -= 2;
+            stack[top++] = -1;
+        } else if (el->type == TYPE_OPERATOR && (strcmp(el->data, "<") == 0 || strcmp(el->data, "<=") == 0 || strcmp(el->data, ">") == 0
+                    || strcmp(el->data, ">=") == 0) && top >= 2 && stack[top - 1] >= 0 && stack[top - 2] >= 0) {
+            op = el->data;
+            a = stack[top - 2];
+            b = stack[top - 1];
+            /// an attribute of the second table on the left is turned around
+            if (a >= tbl1_num_att) {
+                a = stack[top - 1];
+                b = stack[top - 2];
+                op = op[0] == '<' ? (op[1] == '=' ? ">=" : ">") : (op[1] == '=' ? "<=" : "<");
+            }
+            type = t_header[a].type;
+            if (a >= tbl1_num_att || b < tbl1_num_att || type != t_header[b].type || spec->range_op[0] != '\0'
+                    || (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER && type != TYPE_VARCHAR)) {
+                result = EXIT_ERROR;
+                break;
+            }
+            strcpy(spec->range_op, op);
+            spec->range[0] = a;
+            spec->range[1] = b - tbl1_num_att;
+            top -= 2;
+            stack[top++] = -1;
+        } else if (el->type == TYPE_OPERATOR && strcmp(el->data, "AND") == 0 && top >= 2 && stack[top - 1] < 0 && stack[top - 2] < 0) {
+            top--;
+        } else
+            result = EXIT_ERROR;
+    }
+    if (top != 1 || stack[0] >= 0)
+        result = EXIT_ERROR;
+
+    for (i = 0; i < num_att && result == EXIT_SUCCESS; i++) {
+        spec->columns[i].side = i >= tbl1_num_att;
+        spec->columns[i].position = i >= tbl1_num_att ? i - tbl1_num_att : i;
+        strcpy(spec->columns[i].name, t_header[i].att_name);
+        spec->num_columns++;
+    }
+    AK_free(t_header);
+    return result;
+}
+
 /**
  * @author Tomislav Mikulček,updated by Nikola Miljancic
  * @brief Function that creates a theta join betwen two tables on specified conditions. Names of the attibutes in the constraints parameter must be prefixed
  *         with the table name followed by a dot if and only if they exist in both tables. This is left for the preprocessing. Also, for now the constraints  
- *	   must come from the two source tables and not from a third.
+ *	   must come from the two source tables and not from a third. Equalities of attributes of the two tables joined by AND are
+ *	   evaluated as a hash join (see AK_hash_join); with one <, <=, > or >= of such attributes ANDed to them they are
+ *	   evaluated as a sort-merge join (see AK_merge_join). Other constraints are checked for every pair of rows.
  * @param srcTable1 name of the first table to join
  * @param srcTable2 name of the second table to join
  * @param constraints list of attributes, (in)equality and logical operators which are the conditions for the join in postfix notation
@@ -238,9 +356,23 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
 	}
 
         AK_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s and %s\n", dstTable, srcTable1, srcTable2);
+
+        AK_join_spec spec;
+        if (AK_theta_join_spec(srcTable1, srcTable2, constraints, dstTable, &spec) == EXIT_SUCCESS) {
+            int result = spec.range_op[0] != '\0' ? AK_merge_join(&spec) : AK_hash_join(&spec);
+            AK_free(src_addr1);
+            AK_free(src_addr2);
+            AK_EPI;
+            return result;
+        }
 		AK_dbg_messg(MIDDLE, REL_OP, "\nAK_theta_join: start copying data\n");
 
-        AK_mem_block *tbl1_temp_block, *tbl2_temp_block;
+        /// the joined blocks are copied out of the buffer pool, the rows inserted into the result may evict their frames
+        AK_block *tbl1_block = (AK_block *) AK_malloc(sizeof (AK_block));
+        AK_block *tbl2_block = (AK_block *) AK_malloc(sizeof (AK_block));
+        /// the constraints are compiled once for all block pairs
+        AK_header *t_header = (AK_header *) AK_get_header(dstTable);
+        AK_compiled_expression *program = AK_compile_expression(constraints, t_header, tbl1_num_att + tbl2_num_att);
 
         int i, j, k, l;
         i = j = k = l = 0;
@@ -256,10 +388,10 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
                 for (j = startAddress1; j < src_addr1->address_to[i]; j++) {
                     AK_dbg_messg(MIDDLE, REL_OP, "Theta join: copying block of table 1: %d\n", j);
 
-                    tbl1_temp_block = (AK_mem_block *) AK_get_block(j);
+                    memcpy(tbl1_block, AK_get_block(j)->block, sizeof (AK_block));
 
                     //if there is data in the block
-                    if (tbl1_temp_block->block->AK_free_space != 0) {
+                    if (tbl1_block->AK_free_space != 0) {
 
                         //for each extent in table2 that contains blocks needed for join
                         for (k = 0; (k < src_addr2->address_from[k]) != 0; k++) {
@@ -272,12 +404,12 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
                                 for (l = startAddress2; l < src_addr2->address_to[k]; l++) {
                                     AK_dbg_messg(MIDDLE, REL_OP, "Theta join: copying block of table 2: %d\n", l);
 
-                                    tbl2_temp_block = (AK_mem_block *) AK_get_block(l);
+                                    memcpy(tbl2_block, AK_get_block(l)->block, sizeof (AK_block));
 
                                     //if there is data in the block
-                                    if (tbl2_temp_block->block->AK_free_space != 0) {
+                                    if (tbl2_block->AK_free_space != 0) {
 
-                                    		AK_check_constraints(tbl1_temp_block->block, tbl2_temp_block->block, tbl1_num_att, tbl2_num_att, constraints, dstTable);
+                                    		AK_theta_join_blocks(tbl1_block, tbl2_block, tbl1_num_att, tbl2_num_att, constraints, program, t_header, dstTable);
                                     }
                                 }
                             } else break;
@@ -287,6 +419,10 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
             } else break;
         }
 
+        AK_free_compiled_expression(program);
+        AK_free(tbl1_block);
+        AK_free(tbl2_block);
+        AK_free(t_header);
         AK_free(src_addr1);
         AK_free(src_addr2);
 
@@ -304,6 +440,40 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
     }
 }
 
+/**
+ * @brief Function that counts the pairs of rows of two tables whose attributes compare with an operator, the way
+ * AK_check_arithmetic_statement compares them
+ * @param srcTable1 name of the first table
+ * @param attName1 attribute of the first table
+ * @param srcTable2 name of the second table
+ * @param attName2 attribute of the second table
+ * @param op "<", "<=", ">" or ">="
+ * @return number of pairs
+ */
+static int AK_theta_join_test_count(char *srcTable1, char *attName1, char *srcTable2, char *attName2, char *op) {
+    AK_row_cursor outer, inner;
+    struct list_node *row1, *row2, *value1, *value2;
+    int pos1 = AK_get_attr_index(srcTable1, attName1) + 1;
+    int pos2 = AK_get_attr_index(srcTable2, attName2) + 1;
+    int count = 0;
+
+    AK_row_cursor_open(&outer, srcTable1);
+    while ((row1 = AK_row_cursor_next(&outer)) != NULL) {
+        value1 = AK_GetNth_L2(pos1, row1);
+        AK_row_cursor_open(&inner, srcTable2);
+        while ((row2 = AK_row_cursor_next(&inner)) != NULL) {
+            value2 = AK_GetNth_L2(pos2, row2);
+            if (value1->type == value2->type && AK_check_arithmetic_statement(value1, op, value1->data, value2->data))
+                count++;
+            AK_DeleteAll_L3(&row2);
+            AK_free(row2);
+        }
+        AK_DeleteAll_L3(&row1);
+        AK_free(row1);
+    }
+    return count;
+}
+
 /**
  * @author Tomislav Mikulček
  * @brief Function for testing the theta join
@@ -311,6 +481,7 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
  */
 TestResult AK_op_theta_join_test() {
     AK_PRO;
+    int passed = 0, failed = 0;
     printf("\n********** THETA JOIN TEST **********\n\n");
 
     struct list_node *constraints = (struct list_node *) AK_malloc(sizeof (struct list_node));
@@ -347,6 +518,21 @@ TestResult AK_op_theta_join_test() {
 
     AK_theta_join("employee", "department", "theta_join_test3", constraints);
     AK_print_table("theta_join_test3");
+
+    // the same equality as a hash join partitioned until the maximal depth, compared with a nested loop
+    int expected = AK_join_nested_loop_count("employee", "id_department", "department", "id_department");
+    int work_memory = AK_settings.work_memory;
+    if (AK_if_exist("theta_join_test5", "AK_relation") != 0)
+        AK_delete_segment("theta_join_test5", SEGMENT_TYPE_TABLE);
+    AK_settings.work_memory = 0;
+    AK_theta_join("employee", "department", "theta_join_test5", constraints);
+    AK_settings.work_memory = work_memory;
+    if (AK_get_num_records("theta_join_test5") == expected)
+        passed++;
+    else {
+        printf("Partitioned hash join returned %d rows instead of %d\n", AK_get_num_records("theta_join_test5"), expected);
+        failed++;
+    }
     AK_DeleteAll_L3(&constraints);
     char num = 102;
     printf("SELECT * FROM student, professor2 WHERE year + id_prof > 37895;\n");
@@ -360,9 +546,38 @@ TestResult AK_op_theta_join_test() {
     AK_print_table("theta_join_test4");
     printf("Test is successful :) \n");
     AK_DeleteAll_L3(&constraints);
+
+    // comparisons of attributes of the two tables are joined by sorting both tables, compared with a nested loop
+    char *rangeTables[] = {"theta_join_test6", "theta_join_test7", "theta_join_test8"};
+    char *rangeSources[][2] = {{"employee", "department"}, {"employee", "department"}, {"department", "professor"}};
+    char *rangeAttributes[][2] = {{"employee.id_department", "department.id_department"},
+        {"department.id_department", "employee.id_department"}, {"manager", "lastname"}};
+    char *rangeOps[] = {"<", ">=", "<"};
+    int rangeExpected[] = {AK_theta_join_test_count("employee", "id_department", "department", "id_department", "<"),
+        AK_theta_join_test_count("employee", "id_department", "department", "id_department", "<="),
+        AK_theta_join_test_count("department", "manager", "professor", "lastname", "<")};
+    AK_join_spec spec;
+    int t;
+    for (t = 0; t < 3; t++) {
+        printf("SELECT * FROM %s, %s WHERE %s %s %s;\n", rangeSources[t][0], rangeSources[t][1], rangeAttributes[t][0], rangeOps[t], rangeAttributes[t][1]);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, rangeAttributes[t][0], strlen(rangeAttributes[t][0]) + 1, constraints);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, rangeAttributes[t][1], strlen(rangeAttributes[t][1]) + 1, constraints);
+        AK_InsertAtEnd_L3(TYPE_OPERATOR, rangeOps[t], strlen(rangeOps[t]) + 1, constraints);
+        if (AK_if_exist(rangeTables[t], "AK_relation") != 0)
+            AK_delete_segment(rangeTables[t], SEGMENT_TYPE_TABLE);
+        AK_theta_join(rangeSources[t][0], rangeSources[t][1], rangeTables[t], constraints);
+        if (AK_theta_join_spec(rangeSources[t][0], rangeSources[t][1], constraints, rangeTables[t], &spec) == EXIT_SUCCESS
+                && spec.range_op[0] != '\0' && AK_get_num_records(rangeTables[t]) == rangeExpected[t])
+            passed++;
+        else {
+            printf("Sort-merge range join returned %d rows instead of %d\n", AK_get_num_records(rangeTables[t]), rangeExpected[t]);
+            failed++;
+        }
+        AK_DeleteAll_L3(&constraints);
+    }
     
     AK_free(constraints);
     AK_EPI;
-    return TEST_result(0,0);
+    return TEST_result(passed, failed);
 }
 
@@ -24,6 +24,9 @@
 #include "../auxi/test.h"
 #include "expression_check.h"
 #include "../file/fileio.h"
+#include "hash_join.h"
+#include "merge_join.h"
+#include "../sql/drop.h"
 #include "../auxi/mempro.h"
 
 //int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, AK_list *constraints);
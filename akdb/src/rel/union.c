@@ -139,6 +139,22 @@ int AK_union(char *srcTable1, char *srcTable2, char *dstTable) {
 	AK_EPI;
 }
 
+/**
+ * @brief  Function that makes a union of two tables without duplicate rows. The rows of both tables are hashed, so
+ *         every table is read once and every distinct row is written once into dstTable (see AK_set_operation)
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
+ */
+int AK_union_distinct(char *srcTable1, char *srcTable2, char *dstTable) {
+    int result;
+    AK_PRO;
+    result = AK_set_operation(srcTable1, srcTable2, dstTable, AK_SET_UNION);
+    AK_EPI;
+    return result;
+}
+
 /**
  * @author Dino Laktašić
  * @brief  Function for union operator testing
@@ -150,14 +166,60 @@ TestResult AK_op_union_test() {
     printf("\n********** UNION TEST **********\n\n");
     AK_print_table("professor");
     AK_print_table("assistant");
+    if (AK_if_exist("union_test", "AK_relation") != 0)
+        AK_delete_segment("union_test", SEGMENT_TYPE_TABLE);
     int test = AK_union("professor", "assistant", "union_test");
     AK_print_table("union_test");
-	
-	AK_EPI;
-	if (test == EXIT_SUCCESS){
-		return TEST_result(1,0);
+    int success = 0, failed = 0;
+
+    // every row once, then the rows of Balaban, Kisasondi and Schatten, who are both professors and assistants
+    char *all_rows[13] = {"Baca", "Balaban", "Brumnic", "Cubrilo", "Kermek", "Kisasondi", "Lovrencic", "Schatten",
+        "Vrcek", "Zlatović", "Balaban", "Kisasondi", "Schatten"};
+	if (test == EXIT_SUCCESS && AK_set_operation_rows_match("union_test", "lastname", all_rows, 13)){
+		printf("\nUnion keeps the rows of both tables: succeeded\n");
+		success++;
     }
     else{
-		return TEST_result(0,1);
-    }	
+		printf("\nUnion keeps the rows of both tables: failed\n");
+		failed++;
+    }
+
+    // the distinct union is computed in memory and with the rows partitioned into temporary segments; the partitioned
+    // one reads union_test, so the duplicates within its first table are removed as well
+    char *distinct[2] = {"union_test_distinct", "union_test_distinct_spill"};
+    char *first[2] = {"professor", "union_test"};
+    int work_memory = AK_settings.work_memory, i;
+    for (i = 0; i < 2; i++) {
+        if (AK_if_exist(distinct[i], "AK_relation") != 0)
+            AK_delete_segment(distinct[i], SEGMENT_TYPE_TABLE);
+        if (i == 1)
+            AK_settings.work_memory = 0;
+        test = AK_union_distinct(first[i], "assistant", distinct[i]);
+        AK_settings.work_memory = work_memory;
+        AK_print_table(distinct[i]);
+        if (test == EXIT_SUCCESS && AK_set_operation_rows_match(distinct[i], "lastname", all_rows, 10)) {
+            printf("\nDistinct union of %s and assistant gives every row once: succeeded\n", first[i]);
+            success++;
+        }
+        else {
+            printf("\nDistinct union of %s and assistant gives every row once: failed\n", first[i]);
+            failed++;
+        }
+    }
+
+    // a result name that leaves no room for the names of its partitions is rejected before anything is created
+    char long_name[MAX_ATT_NAME];
+    memset(long_name, 'u', MAX_ATT_NAME - 1);
+    long_name[MAX_ATT_NAME - 1] = '\0';
+    if (AK_union_distinct("professor", "assistant", long_name) == EXIT_ERROR && AK_if_exist(long_name, "AK_relation") == 0) {
+        printf("\nDistinct union into a table with a too long name is rejected: succeeded\n");
+        success++;
+    }
+    else {
+        printf("\nDistinct union into a table with a too long name is rejected: failed\n");
+        failed++;
+    }
+
+	AK_EPI;
+	return TEST_result(success, failed);
 }
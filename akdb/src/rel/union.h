@@ -24,6 +24,8 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "../sql/drop.h"
+#include "set_operation.h"
 
 /**
  * @author Dino Laktašić
@@ -34,6 +36,15 @@
  * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
  */
 int AK_union(char *srcTable1, char *srcTable2, char *dstTable);
+
+/**
+ * @brief  Function that makes a union of two tables without duplicate rows (see AK_set_operation)
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @return if success returns EXIT_SUCCESS, else returns EXIT_ERROR
+ */
+int AK_union_distinct(char *srcTable1, char *srcTable2, char *dstTable);
 TestResult AK_op_union_test();
 
 #endif
@@ -35,10 +35,22 @@ int AK_command(command * commands, int commandNum) {
             char *dest_table = AK_malloc(strlen(ext) + strlen(commands[i].tblName)+1);
             strcpy(dest_table, commands[i].tblName);
             strcat(dest_table, ext);
-            if(AK_selection(commands[i].tblName, dest_table, (struct list_node*)commands[i].parameters) == EXIT_ERROR){ // print temp table inside the function
+            //an RA query starts with a table, it is planned by cost and run, a condition of a selection starts with an attribute
+            struct list_node *first = AK_First_L2((struct list_node*)commands[i].parameters);
+            if(first != NULL && first->type == TYPE_OPERAND){
+                if(AK_query_execute((struct list_node*)commands[i].parameters, dest_table) == EXIT_ERROR){
+                    AK_free(dest_table);
+                    AK_EPI;
+                    return EXIT_ERROR;
+                }
+                AK_print_table(dest_table);
+            }
+            else if(AK_selection(commands[i].tblName, dest_table, (struct list_node*)commands[i].parameters) == EXIT_ERROR){ // print temp table inside the function
+                AK_free(dest_table);
         AK_EPI;
                 return EXIT_ERROR;
         }
+            AK_free(dest_table);
 
             break;
             
@@ -84,7 +96,7 @@ int AK_command(command * commands, int commandNum) {
 TestResult AK_test_command(){
     AK_PRO;
     printf("***Test Command***\n");
-    int commandNum = 4;
+    int commandNum = 5;
     command *commands = AK_malloc(sizeof(command)*(commandNum+1));
 
 
@@ -160,10 +172,33 @@ TestResult AK_test_command(){
     commands[3].parameters = row_root;
 
 
+    // Test for select of a join, planned by cost
+
+    struct list_node *query = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&query);
+    AK_InsertAtEnd_L3(TYPE_OPERAND, "professor", sizeof ("professor"), query);
+    AK_InsertAtEnd_L3(TYPE_OPERAND, "employee", sizeof ("employee"), query);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "n", sizeof ("n"), query);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id_prof", sizeof ("id_prof"), query);
+
+    commands[4].id_command = SELECT;
+    commands[4].tblName = "professor_employee";
+    commands[4].parameters = query;
+    if (AK_table_exist("professor_employee_selection_tmp_table"))
+        AK_delete_segment("professor_employee_selection_tmp_table", SEGMENT_TYPE_TABLE);
+
+
     // execute commands
     int test_command = AK_command(commands, commandNum);
     AK_DeleteAll_L3(&row_root);
     int ok=0, fail=0;
+    int joined = AK_get_num_records("professor_employee_selection_tmp_table");
+    int expected = AK_join_nested_loop_count("professor", "id_prof", "employee", "id_prof");
+    printf("\nJoin of professor and employee selected by a command: %d rows, %d expected\n", joined, expected);
+    if (joined != expected)
+        test_command = EXIT_ERROR;
+    AK_DeleteAll_L3(&query);
+    AK_free(query);
 	if (test_command == EXIT_SUCCESS){
 		printf("\n\nTest succeeded!\n");
 		ok++;
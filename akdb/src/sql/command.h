@@ -23,6 +23,8 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../rel/selection.h"
+#include "../rel/hash_join.h"
+#include "../opti/query_optimization.h"
 #include "../auxi/mempro.h"
 
 struct AK_command_struct {
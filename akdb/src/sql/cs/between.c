@@ -145,6 +145,7 @@ void AK_set_constraint_between(char* tableName, char* constraintName, char* attN
 
     AK_DeleteAll_L3(&constraint_row);
     AK_free(constraint_row);
+    AK_constraint_cache_invalidate(tableName);
 
     printf("\nCHECK CONSTRAINT set on attribute: '%s' on TABLE %s!\n\n", attName, tableName);
 
@@ -162,14 +163,10 @@ void AK_set_constraint_between(char* tableName, char* constraintName, char* attN
 int AK_read_constraint_between(char* tableName, char* newValue, char* attNamePar) {
 
     int systemTableAddress = AK_find_table_address(AK_CONSTRAINTS_BEWTEEN);
-    int num_rows = AK_get_num_records(AK_CONSTRAINTS_BEWTEEN);
     int loop_count;
-    AK_block *tempBlock;
-    struct list_node *row;
-    struct list_node *constraint_table;
-    struct list_node *constraint_attribute;
-    struct list_node *start_value;
-    struct list_node *end_value;
+    int result = EXIT_SUCCESS;
+    AK_constraint_descriptor descriptor;
+    AK_between_item *constraint;
 
     AK_PRO;
 
@@ -180,46 +177,27 @@ int AK_read_constraint_between(char* tableName, char* newValue, char* attNamePar
         return EXIT_ERROR;
     }
 
-    if (num_rows != 0) {
-        for (loop_count = 0; loop_count < num_rows; loop_count++) {
-            row = AK_get_row(loop_count, AK_CONSTRAINTS_BEWTEEN);
-            constraint_table = AK_GetNth_L2(2, row);
-            
-            if(strcmp(constraint_table->data, tableName) == 0){
-
-                constraint_attribute = AK_GetNth_L2(4, row);
-                if(strcmp(constraint_attribute->data, attNamePar) == 0){
-
-                    start_value = AK_GetNth_L2(5, row);
-                    end_value = AK_GetNth_L2(6, row);
-
-                    if(strcmp(start_value->data,newValue) > 0){
-                        printf("\nFAILURE: Value '%s' is smaller than minimal allowed value: '%s' \n",newValue,start_value->data);
-
-                        AK_EPI;
-                        return EXIT_FAILURE;
-                    }
+    AK_constraint_descriptor_get(tableName, &descriptor);
+    for (loop_count = 0; loop_count < descriptor.num_between && result == EXIT_SUCCESS; loop_count++) {
+        constraint = &descriptor.between[loop_count];
 
-                    if(strcmp(end_value->data,newValue) < 0){
+        if(strcmp(constraint->attribute, attNamePar) == 0){
 
-                        printf("\nFAILURE: Value '%s' is bigger than maximum allowed value: '%s' \n",newValue,end_value->data);
+            if(strcmp(constraint->start_value,newValue) > 0){
+                printf("\nFAILURE: Value '%s' is smaller than minimal allowed value: '%s' \n",newValue,constraint->start_value);
+                result = EXIT_FAILURE;
+            }
+            else if(strcmp(constraint->end_value,newValue) < 0){
 
-                        AK_EPI;
-                        return EXIT_FAILURE;
-                    }
-                }
+                printf("\nFAILURE: Value '%s' is bigger than maximum allowed value: '%s' \n",newValue,constraint->end_value);
+                result = EXIT_FAILURE;
             }
         }
     }
-
-    AK_free(tempBlock);
-    AK_free(constraint_table);
-    AK_free(constraint_attribute);
-    AK_free(start_value);
-    AK_free(end_value);
+    AK_constraint_descriptor_free(&descriptor);
     AK_EPI;
 
-    return EXIT_SUCCESS;
+    return result;
 }
 
 /**
@@ -317,6 +295,7 @@ int AK_delete_constraint_between(char* tableName, char* constraintNamePar){
     int result = AK_delete_row(row_root);
     AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);    
+    AK_constraint_cache_invalidate(NULL);
 
     AK_EPI;
 
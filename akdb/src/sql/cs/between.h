@@ -23,6 +23,7 @@
 #include "../../auxi/test.h"
 #include "../../mm/memoman.h"
 #include "../../file/id.h"
+#include "constraint_cache.h"
 #include "../../auxi/mempro.h"
 
 /**
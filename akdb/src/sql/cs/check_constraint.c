@@ -204,6 +204,7 @@ int AK_set_check_constraint(char *table_name, char *constraint_name, char *attri
 
     AK_DeleteAll_L3(&constraint_row);
     AK_free(constraint_row);
+    AK_constraint_cache_invalidate(table_name);
 
     printf("\nCHECK CONSTRAINT set on attribute: '%s' on TABLE %s!\n\n", attribute_name, table_name);
 
@@ -222,51 +223,37 @@ int AK_set_check_constraint(char *table_name, char *constraint_name, char *attri
  */
 int AK_check_constraint(char *table, char *attribute, void *value) {
     int i;
-    int num_rows = AK_get_num_records(AK_CONSTRAINTS_CHECK_CONSTRAINT);
+    int result = EXIT_SUCCESS;
     int _row_data; // check constraint value
-    struct list_node *row;
-    struct list_node *constraint_attribute;
-    void *row_data = (void *) AK_calloc(MAX_VARCHAR_LENGTH, sizeof (void)); // check constraint value
+    AK_constraint_descriptor descriptor;
+    AK_check_item *constraint;
 
     AK_PRO;
 
-    if (num_rows != 0) {
-        for (i = 0; i < num_rows; ++i) {
-            row = AK_get_row(i, AK_CONSTRAINTS_CHECK_CONSTRAINT);
-            constraint_attribute = AK_GetNth_L2(7, row);
-
-            memmove(row_data, constraint_attribute->data, AK_type_size(constraint_attribute->type, constraint_attribute->data));  
-
-            // If table name and attribute name match, check value
-            if (!strcmp(table, AK_GetNth_L2(2, row)->data) && !strcmp(attribute, AK_GetNth_L2(4, row)->data)) {
-                if (AK_GetNth_L2(7, row)->type == TYPE_INT) {
-                    _row_data = *((int *) row_data);
-
-                    if (!condition_passed(AK_GetNth_L2(6, row)->data, AK_GetNth_L2(7, row)->type, _row_data, &value)) {
-                        AK_EPI;
-
-                        return EXIT_ERROR;
-                    }
-                    else {
-                        break;
-                    }
-                }
+    AK_constraint_descriptor_get(table, &descriptor);
+    for (i = 0; i < descriptor.num_check; ++i) {
+        constraint = &descriptor.check[i];
 
-                if (!condition_passed(AK_GetNth_L2(6, row)->data, AK_GetNth_L2(7, row)->type, row_data, value)) {
-                    AK_EPI;
+        // If attribute name matches, check value
+        if (!strcmp(attribute, constraint->attribute)) {
+            if (constraint->type == TYPE_INT) {
+                memcpy(&_row_data, constraint->value, sizeof (int));
 
-                    return EXIT_ERROR;
-                }
-                else {
-                    break;
+                if (!condition_passed(constraint->condition, constraint->type, _row_data, &value)) {
+                    result = EXIT_ERROR;
                 }
             }
+            else if (!condition_passed(constraint->condition, constraint->type, constraint->value, value)) {
+                result = EXIT_ERROR;
+            }
+            break;
         }
     }
+    AK_constraint_descriptor_free(&descriptor);
 
     AK_EPI;
 
-    return EXIT_SUCCESS;
+    return result;
 }
 
 /**
@@ -294,6 +281,7 @@ int AK_delete_check_constraint(char* tableName, char* constraintName){
     int result = AK_delete_row(row_root);
     AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);    
+    AK_constraint_cache_invalidate(NULL);
 
     AK_EPI;
 
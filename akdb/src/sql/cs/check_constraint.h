@@ -25,6 +25,7 @@
 #include "../../file/table.h"
 #include "../../file/fileio.h"
 #include "../../rel/expression_check.h"
+#include "constraint_cache.h"
 #include "../../auxi/mempro.h"
 
 
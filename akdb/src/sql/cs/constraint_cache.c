@@ -0,0 +1,308 @@
+/**
+ * @file constraint_cache.c Provides an in-memory cache of the constraints of tables
+ *
+ * The NOT NULL, BETWEEN, CHECK, UNIQUE and foreign key constraints of a table are read from their system tables the
+ * first time they are needed and kept in a descriptor of the table. The functions that set or delete constraints
+ * and DROP TABLE invalidate the descriptors, so checks on inserts do not read the system tables again. Callers get a
+ * copy of a descriptor, which stays valid while the cache changes.
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "constraint_cache.h"
+
+/// descriptors of the tables read so far (guarded by AK_constraint_cache_mutex)
+static pthread_mutex_t AK_constraint_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static AK_constraint_descriptor *AK_constraint_cache;
+static int AK_constraint_cache_size;
+static int AK_constraint_cache_capacity;
+
+/// incremented by every invalidation, a descriptor read while it changed is not kept
+static int AK_constraint_cache_generation;
+
+/**
+ * @brief Function that makes room for one more element of an array
+ * @param array array
+ * @param count number of elements in the array
+ * @param capacity number of elements the array can hold, updated if it grows
+ * @param size size of an element
+ * @return the array, moved if it grew
+ */
+static void *AK_constraint_cache_grow(void *array, int count, int *capacity, size_t size)
+{
+    if (count == *capacity)
+    {
+        *capacity = *capacity ? *capacity * 2 : 4;
+        array = AK_realloc(array, *capacity * size);
+    }
+    return array;
+}
+
+/**
+ * @brief Function that copies a value of a row of a system table
+ * @param dst destination
+ * @param size size of the destination
+ * @param row row
+ * @param position position of the value in the row, starting with 1
+ */
+static void AK_constraint_cache_value(char *dst, int size, struct list_node *row, int position)
+{
+    struct list_node *value = AK_GetNth_L2(position, row);
+
+    snprintf(dst, size, "%s", value != NULL ? value->data : "");
+}
+
+/**
+ * @brief Function that reads the constraints of a table from the constraint system tables
+ * @param tblName table name
+ * @param descriptor descriptor to fill
+ */
+static void AK_constraint_cache_read(char *tblName, AK_constraint_descriptor *descriptor)
+{
+    AK_row_cursor cursor;
+    struct list_node *row, *value;
+    AK_ref_item *reference;
+    char constraint[MAX_VARCHAR_LENGTH];
+    int capacity, size, i;
+
+    memset(descriptor, 0, sizeof (AK_constraint_descriptor));
+    snprintf(descriptor->table, MAX_ATT_NAME, "%s", tblName);
+
+    /// obj_id, tableName, constraintName, attributeName
+    capacity = 0;
+    AK_row_cursor_open(&cursor, AK_CONSTRAINTS_NOT_NULL);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        if (strcmp(AK_GetNth_L2(2, row)->data, tblName) == 0)
+        {
+            descriptor->not_null = AK_constraint_cache_grow(descriptor->not_null, descriptor->num_not_null, &capacity, sizeof (*descriptor->not_null));
+            AK_constraint_cache_value(descriptor->not_null[descriptor->num_not_null++], MAX_ATT_NAME, row, 4);
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+
+    /// obj_id, tableName, constraintName, attributeName, start_value, end_value
+    capacity = 0;
+    AK_row_cursor_open(&cursor, AK_CONSTRAINTS_BEWTEEN);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        if (strcmp(AK_GetNth_L2(2, row)->data, tblName) == 0)
+        {
+            descriptor->between = AK_constraint_cache_grow(descriptor->between, descriptor->num_between, &capacity, sizeof (AK_between_item));
+            AK_constraint_cache_value(descriptor->between[descriptor->num_between].attribute, MAX_ATT_NAME, row, 4);
+            AK_constraint_cache_value(descriptor->between[descriptor->num_between].start_value, MAX_VARCHAR_LENGTH, row, 5);
+            AK_constraint_cache_value(descriptor->between[descriptor->num_between].end_value, MAX_VARCHAR_LENGTH, row, 6);
+            descriptor->num_between++;
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+
+    /// obj_id, table_name, constraint_name, attribute_name, constraint_value_type, constraint_condition, constraint_value
+    capacity = 0;
+    AK_row_cursor_open(&cursor, AK_CONSTRAINTS_CHECK_CONSTRAINT);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        if (strcmp(AK_GetNth_L2(2, row)->data, tblName) == 0 && (value = AK_GetNth_L2(7, row)) != NULL)
+        {
+            descriptor->check = AK_constraint_cache_grow(descriptor->check, descriptor->num_check, &capacity, sizeof (AK_check_item));
+            memset(&descriptor->check[descriptor->num_check], 0, sizeof (AK_check_item));
+            AK_constraint_cache_value(descriptor->check[descriptor->num_check].attribute, MAX_ATT_NAME, row, 4);
+            AK_constraint_cache_value(descriptor->check[descriptor->num_check].condition, MAX_ATT_NAME, row, 6);
+            descriptor->check[descriptor->num_check].type = value->type;
+            size = AK_type_size(value->type, value->data);
+            memcpy(descriptor->check[descriptor->num_check].value, value->data, size < MAX_VARCHAR_LENGTH ? size : MAX_VARCHAR_LENGTH - 1);
+            descriptor->num_check++;
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+
+    /// obj_id, tableName, constraintName, attributeName
+    capacity = 0;
+    AK_row_cursor_open(&cursor, AK_CONSTRAINTS_UNIQUE);
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        if (strcmp(AK_GetNth_L2(2, row)->data, tblName) == 0)
+        {
+            descriptor->unique = AK_constraint_cache_grow(descriptor->unique, descriptor->num_unique, &capacity, sizeof (*descriptor->unique));
+            AK_constraint_cache_value(descriptor->unique[descriptor->num_unique++], MAX_VARCHAR_LENGTH, row, 4);
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+
+    /// table, constraint, attribute, parent, parent_attribute, type; a row for every attribute of a foreign key
+    capacity = 0;
+    AK_row_cursor_open(&cursor, "AK_reference");
+    while ((row = AK_row_cursor_next(&cursor)) != NULL)
+    {
+        if (strcmp(AK_GetNth_L2(1, row)->data, tblName) == 0)
+        {
+            AK_constraint_cache_value(constraint, MAX_VARCHAR_LENGTH, row, 2);
+            for (i = 0; i < descriptor->num_references; i++)
+                if (strcmp(descriptor->references[i].constraint, constraint) == 0)
+                    break;
+            if (i == descriptor->num_references)
+            {
+                descriptor->references = AK_constraint_cache_grow(descriptor->references, descriptor->num_references, &capacity, sizeof (AK_ref_item));
+                memset(&descriptor->references[i], 0, sizeof (AK_ref_item));
+                snprintf(descriptor->references[i].table, MAX_ATT_NAME, "%s", tblName);
+                strcpy(descriptor->references[i].constraint, constraint);
+                descriptor->num_references++;
+            }
+            reference = &descriptor->references[i];
+            if (reference->attributes_number < MAX_REFERENCE_ATTRIBUTES)
+            {
+                AK_constraint_cache_value(reference->attributes[reference->attributes_number], MAX_ATT_NAME, row, 3);
+                AK_constraint_cache_value(reference->parent, MAX_ATT_NAME, row, 4);
+                AK_constraint_cache_value(reference->parent_attributes[reference->attributes_number], MAX_ATT_NAME, row, 5);
+                memcpy(&reference->type, AK_GetNth_L2(6, row)->data, sizeof (int));
+                reference->attributes_number++;
+            }
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+}
+
+/**
+ * @brief Function that copies an array of a descriptor
+ * @param array array
+ * @param count number of elements
+ * @param size size of an element
+ * @return copy, NULL if the array is empty
+ */
+static void *AK_constraint_cache_duplicate(void *array, int count, size_t size)
+{
+    void *copy;
+
+    if (count == 0)
+        return NULL;
+    copy = AK_malloc(count * size);
+    memcpy(copy, array, count * size);
+    return copy;
+}
+
+/**
+ * @brief Function that copies a descriptor with its arrays
+ * @param dst copy
+ * @param src descriptor
+ */
+static void AK_constraint_cache_copy(AK_constraint_descriptor *dst, AK_constraint_descriptor *src)
+{
+    memcpy(dst, src, sizeof (AK_constraint_descriptor));
+    dst->not_null = AK_constraint_cache_duplicate(src->not_null, src->num_not_null, sizeof (*src->not_null));
+    dst->between = AK_constraint_cache_duplicate(src->between, src->num_between, sizeof (AK_between_item));
+    dst->check = AK_constraint_cache_duplicate(src->check, src->num_check, sizeof (AK_check_item));
+    dst->unique = AK_constraint_cache_duplicate(src->unique, src->num_unique, sizeof (*src->unique));
+    dst->references = AK_constraint_cache_duplicate(src->references, src->num_references, sizeof (AK_ref_item));
+}
+
+/**
+ * @brief Function that gives the constraints of a table. They are read from the constraint system tables only if the
+ * cache does not hold the table.
+ * @param tblName table name
+ * @param descriptor copy of the descriptor of the table, to be released with AK_constraint_descriptor_free
+ * @return EXIT_SUCCESS
+ */
+int AK_constraint_descriptor_get(char *tblName, AK_constraint_descriptor *descriptor)
+{
+    AK_constraint_descriptor loaded;
+    int i, generation;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_constraint_cache_mutex);
+    for (i = 0; i < AK_constraint_cache_size; i++)
+        if (strcmp(AK_constraint_cache[i].table, tblName) == 0)
+        {
+            AK_constraint_cache_copy(descriptor, &AK_constraint_cache[i]);
+            pthread_mutex_unlock(&AK_constraint_cache_mutex);
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
+    generation = AK_constraint_cache_generation;
+    pthread_mutex_unlock(&AK_constraint_cache_mutex);
+
+    /// the system tables are read without the lock, the descriptor is not kept if a constraint changed meanwhile
+    AK_constraint_cache_read(tblName, &loaded);
+    AK_constraint_cache_copy(descriptor, &loaded);
+
+    pthread_mutex_lock(&AK_constraint_cache_mutex);
+    for (i = 0; i < AK_constraint_cache_size; i++)
+        if (strcmp(AK_constraint_cache[i].table, tblName) == 0)
+            break;
+    if (i == AK_constraint_cache_size && generation == AK_constraint_cache_generation)
+    {
+        AK_constraint_cache = AK_constraint_cache_grow(AK_constraint_cache, AK_constraint_cache_size,
+                &AK_constraint_cache_capacity, sizeof (AK_constraint_descriptor));
+        AK_constraint_cache[AK_constraint_cache_size++] = loaded;
+    }
+    else
+        AK_constraint_descriptor_free(&loaded);
+    pthread_mutex_unlock(&AK_constraint_cache_mutex);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that releases the arrays of a descriptor
+ * @param descriptor descriptor
+ */
+void AK_constraint_descriptor_free(AK_constraint_descriptor *descriptor)
+{
+    AK_PRO;
+    if (descriptor->not_null != NULL)
+        AK_free(descriptor->not_null);
+    if (descriptor->between != NULL)
+        AK_free(descriptor->between);
+    if (descriptor->check != NULL)
+        AK_free(descriptor->check);
+    if (descriptor->unique != NULL)
+        AK_free(descriptor->unique);
+    if (descriptor->references != NULL)
+        AK_free(descriptor->references);
+    descriptor->not_null = NULL;
+    descriptor->between = NULL;
+    descriptor->check = NULL;
+    descriptor->unique = NULL;
+    descriptor->references = NULL;
+    descriptor->num_not_null = descriptor->num_between = descriptor->num_check = descriptor->num_unique = descriptor->num_references = 0;
+    AK_EPI;
+}
+
+/**
+ * @brief Function that removes the descriptor of a table from the cache, called when a constraint of the table is set
+ * or deleted and when the table is dropped
+ * @param tblName table name, NULL to remove all descriptors (constraints are deleted by name, without their table)
+ */
+void AK_constraint_cache_invalidate(char *tblName)
+{
+    int i;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_constraint_cache_mutex);
+    AK_constraint_cache_generation++;
+    for (i = AK_constraint_cache_size - 1; i >= 0; i--)
+        if (tblName == NULL || strcmp(AK_constraint_cache[i].table, tblName) == 0)
+        {
+            AK_constraint_descriptor_free(&AK_constraint_cache[i]);
+            AK_constraint_cache[i] = AK_constraint_cache[--AK_constraint_cache_size];
+        }
+    pthread_mutex_unlock(&AK_constraint_cache_mutex);
+    AK_EPI;
+}
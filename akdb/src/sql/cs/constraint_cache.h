@@ -0,0 +1,77 @@
+/**
+@file constraint_cache.h Header file that provides data structures and functions for the cache of constraints of tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef CONSTRAINT_CACHE
+#define CONSTRAINT_CACHE
+
+#include "../../auxi/test.h"
+#include "../../auxi/constants.h"
+#include "../../file/table.h"
+#include "reference.h"
+#include "../../auxi/mempro.h"
+
+/**
+ * @struct AK_between_item
+ * @brief BETWEEN constraint of an attribute, read from AK_constraints_between
+ */
+typedef struct {
+    char attribute[MAX_ATT_NAME];
+    char start_value[MAX_VARCHAR_LENGTH];
+    char end_value[MAX_VARCHAR_LENGTH];
+} AK_between_item;
+
+/**
+ * @struct AK_check_item
+ * @brief CHECK constraint of an attribute, read from AK_constraints_check_constraint
+ */
+typedef struct {
+    char attribute[MAX_ATT_NAME];
+    char condition[MAX_ATT_NAME];
+    /// type of the constraint value, the value is kept as it is stored
+    int type;
+    char value[MAX_VARCHAR_LENGTH];
+} AK_check_item;
+
+/**
+ * @struct AK_constraint_descriptor
+ * @brief Constraints of a table, read from the constraint system tables once and kept until a constraint of the
+ * table is set or deleted or the table is dropped
+ */
+typedef struct {
+    char table[MAX_ATT_NAME];
+    /// attributes with a NOT NULL constraint
+    int num_not_null;
+    char (*not_null)[MAX_ATT_NAME];
+    int num_between;
+    AK_between_item *between;
+    int num_check;
+    AK_check_item *check;
+    /// attribute names of the UNIQUE constraints, separated by SEPARATOR as in AK_constraints_unique
+    int num_unique;
+    char (*unique)[MAX_VARCHAR_LENGTH];
+    /// foreign keys of the table
+    int num_references;
+    AK_ref_item *references;
+} AK_constraint_descriptor;
+
+int AK_constraint_descriptor_get(char *tblName, AK_constraint_descriptor *descriptor);
+void AK_constraint_descriptor_free(AK_constraint_descriptor *descriptor);
+void AK_constraint_cache_invalidate(char *tblName);
+
+#endif
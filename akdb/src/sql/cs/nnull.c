@@ -67,6 +67,7 @@ int AK_set_constraint_not_null(char* tableName, char* attName, char* constraintN
 	AK_insert_row(row_root);
 	AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);
+	AK_constraint_cache_invalidate(tableName);
 	printf("\nNOT NULL constraint is successfully set on attribute: %s\nof table: %s\n\n", attName, tableName);
 	
 	AK_EPI;
@@ -145,42 +146,24 @@ int AK_check_constraint_not_null(char* tableName, char* attName, char* constrain
  **/
 
 int AK_read_constraint_not_null(char* tableName, char* attName, char* newValue) {
-	int numRecords = AK_get_num_records("AK_constraints_not_null");
-
-	struct list_node *row;
-	struct list_node *attribute;
-	struct list_node *table;
+	AK_constraint_descriptor descriptor;
 	int i;
+	int result = EXIT_SUCCESS;
 	
 	AK_PRO;
 
 	if(newValue == NULL) {
-		if(numRecords != 0) {
-			for (i = 0; i < numRecords; i++) 
-			{
-				row = AK_get_row(i, "AK_constraints_not_null");
-				attribute = AK_GetNth_L2(4, row);
-				
-				if(strcmp(attribute->data, attName) == 0) 
-				{
-					table = AK_GetNth_L2(2, row);
-					
-					if(strcmp(table->data, tableName) == 0) 
-					{
-						AK_DeleteAll_L3(&row);
-						AK_free(row);
-						AK_EPI;
-						return EXIT_ERROR;
-					}
-				}
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
-			}			
+		AK_constraint_descriptor_get(tableName, &descriptor);
+		for (i = 0; i < descriptor.num_not_null && result == EXIT_SUCCESS; i++) 
+		{
+			if(strcmp(descriptor.not_null[i], attName) == 0) 
+				result = EXIT_ERROR;
 		}
+		AK_constraint_descriptor_free(&descriptor);
 	}
 
 	AK_EPI;
-	return EXIT_SUCCESS;		
+	return result;		
 }
 
 
@@ -209,6 +192,7 @@ int AK_delete_constraint_not_null(char* tableName, char* constraintName){
     int result = AK_delete_row(row_root);
     AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);    
+    AK_constraint_cache_invalidate(NULL);
 
     AK_EPI;
 
@@ -263,7 +247,8 @@ TestResult AK_nnull_constraint_test() {
 	printf("\n TEST 1 - Trying to set NOT NULL constraint on attribute %s of table %s...\n\n", attName, tableName);
 	int resultTest1 = AK_set_constraint_not_null(tableName, attName, constraintName);
 	AK_print_table(AK_CONSTRAINTS_NOT_NULL);
-	if(resultTest1 == EXIT_SUCCESS)
+	//the constraint is seen through the constraint cache as soon as it is set
+	if(resultTest1 == EXIT_SUCCESS && AK_read_constraint_not_null(tableName, attName, NULL) == EXIT_ERROR)
 	{	passed++;
 		printf("\nChecking if attribute %s of table %s can contain NULL sign...\nYes (0) No (-1): %d\n\n", attName,
 		 tableName, AK_read_constraint_not_null(tableName, attName, newValue));
@@ -279,7 +264,7 @@ TestResult AK_nnull_constraint_test() {
 	printf("\nTEST 2 - Delete NOT NULL constraint");
     int resultTest2 = AK_delete_constraint_not_null(AK_CONSTRAINTS_NOT_NULL, constraintName);
     AK_print_table("AK_constraints_not_null");
-    if(resultTest2 == EXIT_SUCCESS) 
+    if(resultTest2 == EXIT_SUCCESS && AK_read_constraint_not_null(tableName, attName, NULL) == EXIT_SUCCESS) 
 	{
 		passed++;
         printf("\nTest 2 is successful!");
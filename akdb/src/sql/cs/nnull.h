@@ -25,6 +25,7 @@
 #include "../../file/fileio.h"
 #include "../../auxi/mempro.h"
 #include "constraint_names.h"
+#include "constraint_cache.h"
 
 
 /**
@@ -18,6 +18,9 @@
  17 */
 
 #include "reference.h"
+/// not included by reference.h, which fileio.h includes before index.h defines struct_add
+#include "../../file/idx/hash.h"
+#include "constraint_cache.h"
 
 /**
  * @author Dejan Frankovic
@@ -30,9 +33,13 @@
  * @param name of the constraint
  * @param type of the constraint, constants defined in 'reference.h'
  * @return EXIT_SUCCESS
+ *
+ * A hash index on the parent attributes is created if the parent has none, AK_reference_check_entry probes it.
  */
 int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable, char *parentAttNames[], int attNum, char *constraintName, int type) {
     int i;
+    char key[MAX_REFERENCE_ATTRIBUTES][MAX_ATT_NAME];
+    char indexName[MAX_ATT_NAME];
     AK_PRO;
     if (type != REF_TYPE_CASCADE && type != REF_TYPE_NO_ACTION && type != REF_TYPE_RESTRICT && type != REF_TYPE_SET_DEFAULT && type != REF_TYPE_SET_NULL){
 	AK_EPI;
@@ -55,6 +62,13 @@ int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable,
     }
 
     AK_free(row_root);
+    AK_constraint_cache_invalidate(childTable);
+
+    for (i = 0; i < attNum && i < MAX_REFERENCE_ATTRIBUTES; i++) {
+        strncpy(key[i], parentAttNames[i], MAX_ATT_NAME - 1);
+        key[i][MAX_ATT_NAME - 1] = '\0';
+    }
+    AK_hash_key_index(parentTable, i, key, indexName);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -67,14 +81,15 @@ int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable,
  * @return AK_ref_item object with all neccessary information about the reference
  */
 AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
-    int i = 0;
+    AK_row_cursor cursor;
 
     struct list_node *list;
     AK_ref_item reference;
     AK_PRO;
     reference.attributes_number = 0;
 
-    while ((list = AK_get_row(i, "AK_reference")) != NULL) {
+    AK_row_cursor_open(&cursor, "AK_reference");
+    while ((list = AK_row_cursor_next(&cursor)) != NULL) {
         if (strcmp(list->next->data, tableName) == 0 &&
                 strcmp(list->next->next->data, constraintName) == 0) {
             strcpy(reference.table, tableName);
@@ -85,7 +100,8 @@ AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
             memcpy(&reference.type, list->next->next->next->next->next->next->data, sizeof (int));
             reference.attributes_number++;
         }
-        i++;
+        AK_DeleteAll_L3(&list);
+        AK_free(list);
     }
     AK_EPI;
     return reference;
@@ -100,12 +116,13 @@ AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
  * @return EXIT ERROR if check failed, EXIT_SUCCESS if referential integrity is ok
  */
 int AK_reference_check_attribute(char *tableName, char *attribute, char *value) {
-    int i;
     int att_index;
+    AK_row_cursor cursor;
 
     struct list_node *list_row, *list_col;
     AK_PRO;
-    while ((list_row = AK_get_row(i, "AK_reference")) != NULL) {
+    AK_row_cursor_open(&cursor, "AK_reference");
+    while ((list_row = AK_row_cursor_next(&cursor)) != NULL) {
         if (strcmp(list_row->next->data, tableName) == 0 &&
                 strcmp(list_row->next->next->next->data, attribute) == 0) {
             att_index = AK_get_attr_index(list_row->next->next->next->next->data, list_row->next->next->next->next->next->data);
@@ -118,7 +135,8 @@ int AK_reference_check_attribute(char *tableName, char *attribute, char *value)
 		}
             }
         }
-        i++;
+        AK_DeleteAll_L3(&list_row);
+        AK_free(list_row);
     }
     AK_EPI;
     return EXIT_SUCCESS;
@@ -206,7 +224,7 @@ int AK_reference_check_restricion(struct list_node *lista, int action) {
  */
 
 int AK_reference_update(struct list_node *lista, int action) {
-    int parent_i, i, j, ref_i, con_num = 0;
+    int parent_i = 0, i, j, ref_i = 0, con_num = 0;
 
     struct list_node *parent_row;
     struct list_node *ref_row;
@@ -238,7 +256,7 @@ int AK_reference_update(struct list_node *lista, int action) {
         ref_i++;
     }
 
-    struct list_node *expr;
+    struct list_node *expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&expr);
 
     // selecting only affected rows in parent table..
@@ -266,6 +284,7 @@ int AK_reference_update(struct list_node *lista, int action) {
     AK_selection(lista->next->table, tempTable, expr);
     
     AK_DeleteAll_L3(&expr);
+    AK_free(expr);
 
     AK_print_table(tempTable);
 
@@ -336,26 +355,65 @@ int AK_reference_update(struct list_node *lista, int action) {
         parent_i++;
     }
 
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
     AK_delete_segment(tempTable, SEGMENT_TYPE_TABLE);
     AK_EPI;
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Function that checks whether a parent row has the given foreign key values. The hash index on the parent key
+ * is probed, the parent rows are read if there is none.
+ * @param reference reference
+ * @param values foreign key values in the order of the parent attributes
+ * @return 1 if there is such a row, 0 otherwise
+ */
+static int AK_reference_parent_exists(AK_ref_item *reference, struct list_node *values) {
+    char indexName[MAX_ATT_NAME];
+    struct_add *add;
+    AK_row_cursor cursor;
+    struct list_node *row, *parent_value, *value;
+    int k, found = 0;
+
+    if (AK_hash_find_key(reference->parent, reference->attributes_number, reference->parent_attributes, indexName) == EXIT_SUCCESS) {
+        add = AK_find_in_hash_index(indexName, values);
+        found = add->addBlock != 0;
+        AK_free(add);
+        return found;
+    }
+
+    AK_row_cursor_open(&cursor, reference->parent);
+    while (!found && (row = AK_row_cursor_next(&cursor)) != NULL) {
+        found = 1;
+        value = AK_First_L2(values);
+        for (k = 0; found && k < reference->attributes_number; k++, value = AK_Next_L2(value)) {
+            parent_value = AK_GetNth_L2(AK_get_attr_index(reference->parent, reference->parent_attributes[k]) + 1, row);
+            found = parent_value != NULL && value != NULL && parent_value->type == value->type
+                    && AK_type_size(value->type, value->data) == AK_type_size(parent_value->type, parent_value->data)
+                    && memcmp(parent_value->data, value->data, AK_type_size(value->type, value->data)) == 0;
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    return found;
+}
+
 /**
  * @author Dejan Franković
- * @brief Function that checks a new entry for referential integrity.
+ * @brief Function that checks a new entry for referential integrity. The foreign keys of the table come from the
+ * constraint cache, their values in the entry are looked up in the hash index on the parent key, the rows of a parent
+ * without one are read.
  * @param list of elements for insert row
  * @return EXIT_SUCCESS if referential integrity is ok, EXIT_ERROR if it is compromised
  */
 int AK_reference_check_entry(struct list_node *lista) {
     
-    struct list_node *temp, *row, *temp1;
-    int i = 0, j, k, con_num = 0, success;
-    char constraints[10][MAX_VARCHAR_LENGTH]; // this 10 should probably be a constant... how many foreign keys can one table have..
-    char attributes[MAX_REFERENCE_ATTRIBUTES][MAX_ATT_NAME];
+    struct list_node *temp, *values;
+    int i, j, success;
     int is_att_null[MAX_REFERENCE_ATTRIBUTES]; //this is a workaround... when proper null value implementation is in place, this should be solved differently
-    
-    AK_ref_item reference;
+    AK_constraint_descriptor descriptor;
+    AK_ref_item *reference;
 
     AK_PRO;
 
@@ -369,83 +427,46 @@ int AK_reference_check_entry(struct list_node *lista) {
 	temp = AK_Next_L2(temp);
     }
 
-    while ((row = AK_get_row(i, "AK_reference")) != NULL) 
-	{
-        if (strcmp(row->next->data, lista->next->table) == 0) 
-		{
-            for (j = 0; j < con_num; j++) 
-			{
-                if (strcmp(constraints[j], row->next->next->data) == 0) 
-				{
-                    break;
-                }
-            }
-            if (j == con_num) 
-			{
-                strcpy(constraints[con_num], row->next->next->data);
-                con_num++;
-            }
-        }
-        i++;
-		AK_free(row);
-    }
+    // foreign keys of the table, AK_reference is read only the first time
+    AK_constraint_descriptor_get(lista->next->table, &descriptor);
 
-    if (con_num == 0){
-	AK_EPI;
-        return EXIT_SUCCESS;
-    }
-
-    for (i = 0; i < con_num; i++) { // reference
-        reference = AK_get_reference(lista->next->table, constraints[i]);
+    for (i = 0; i < descriptor.num_references; i++) { // reference
+        reference = &descriptor.references[i];
 
-        // fetching relevant attributes from entry list...
-        // attributes = AK_malloc(sizeof(char)*MAX_VARCHAR_LENGHT*reference.attributes_number);
-        for (j = 0; j < reference.attributes_number; j++) {
+        // fetching relevant attributes from entry list, a missing attribute is treated as null
+        values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&values);
+        for (j = 0; j < reference->attributes_number; j++) {
+            is_att_null[j] = 1;
             temp = lista->next;
             while (temp != NULL) {
 
-                if (temp->constraint == 0 && strcmp(temp->attribute_name, reference.attributes[j]) == 0) {
-                    strcpy(attributes[j], temp->data);
-                    if (reference.type == REF_TYPE_SET_NULL && strcmp(temp->data, "\0") == 0) //if type is 0, the value is PROBABLY null
+                if (temp->constraint == 0 && strcmp(temp->attribute_name, reference->attributes[j]) == 0) {
+                    if (reference->type == REF_TYPE_SET_NULL && strcmp(temp->data, "\0") == 0) //if type is 0, the value is PROBABLY null
                         is_att_null[j] = 1;
                     else
                         is_att_null[j] = 0;
+                    AK_InsertAtEnd_L3(temp->type, temp->data, AK_type_size(temp->type, temp->data), values);
                     break;
                 }
-//                temp = AK_Next_L2(temp);
 		temp = AK_Next_L2(temp);
             }
         }
 
-        if (reference.attributes_number == 1) {
-            if (AK_reference_check_attribute(reference.table, reference.attributes[0], attributes[0]) == EXIT_ERROR) {
-		AK_EPI;
-                return EXIT_ERROR;
-            } else continue;
-        }
-
-
-        j = 0;
-        while ((row = AK_get_row(j, reference.parent)) != NULL) { // rows in parent table
-            success = 1;
-            for (k = 0; k < reference.attributes_number; k++) { // attributes in reference
-		temp1 = AK_GetNth_L2(AK_get_attr_index(reference.parent, reference.parent_attributes[k]), row);
-                if (temp1 != 0x0) {
-                  if (is_att_null[k] || strcmp(temp1->data, attributes[k]) != 0) {
-                      success = 0;
-                      break;
-                  }
-                }
-            }
-            if (success == 1) {
-		AK_EPI;
-                return EXIT_SUCCESS;
-            }
-            j++;
+        // a null value references no parent row
+        for (j = 0; j < reference->attributes_number && !is_att_null[j]; j++);
+        success = j == reference->attributes_number && AK_reference_parent_exists(reference, values);
+        AK_DeleteAll_L3(&values);
+        AK_free(values);
+        if (!success) {
+            AK_constraint_descriptor_free(&descriptor);
+	    AK_EPI;
+            return EXIT_ERROR;
         }
     }
+    AK_constraint_descriptor_free(&descriptor);
     AK_EPI;
-    return EXIT_ERROR;
+    return EXIT_SUCCESS;
 }
 
 /**
@@ -488,6 +509,28 @@ TestResult AK_reference_test() {
     AK_print_table("AK_reference");
     AK_print_table("student");
 
+    int success = 0, failed = 0, i, result;
+    char key[2][MAX_ATT_NAME] = {"mbr", "firstname"};
+    char indexName[MAX_ATT_NAME];
+
+    AK_constraint_descriptor descriptor;
+    AK_constraint_descriptor_get("ref_test", &descriptor);
+    printf("\nForeign keys of ref_test in the constraint cache: %d\n", descriptor.num_references);
+    if (descriptor.num_references == 1 && strcmp(descriptor.references[0].parent, "student") == 0)
+        success++;
+    else
+        failed++;
+    AK_constraint_descriptor_free(&descriptor);
+
+    printf("\nIndex on the parent key: ");
+    if (AK_hash_find_key("student", 2, key, indexName) == EXIT_SUCCESS) {
+        printf("%s\n", indexName);
+        success++;
+    } else {
+        printf("none\n");
+        failed++;
+    }
+
     a = 35891;
     
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
@@ -496,30 +539,85 @@ TestResult AK_reference_test() {
     AK_Insert_New_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "Dude", "ref_test", "Value", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "TheRippah", "ref_test", "Rnd", row_root);
-    AK_insert_row(row_root);
+    if (AK_insert_row(row_root) == EXIT_ERROR)
+        success++;
+    else
+        failed++;
 
     a = 35891;
     
       
-    AK_DeleteAll_L3(row_root);
+    AK_DeleteAll_L3(&row_root);
     AK_Insert_New_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "Mislav", "ref_test", "Value", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "TheMutilator", "ref_test", "Rnd", row_root);
-    AK_insert_row(row_root);
+    if (AK_insert_row(row_root) == EXIT_ERROR)
+        success++;
+    else
+        failed++;
 
     a = 35893;
       
-    AK_DeleteAll_L3(row_root);
+    AK_DeleteAll_L3(&row_root);
     AK_Insert_New_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "Mislav", "ref_test", "Value", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "TheMutilator", "ref_test", "Rnd", row_root);
-    AK_insert_row(row_root);
+    if (AK_insert_row(row_root) == EXIT_SUCCESS)
+        success++;
+    else
+        failed++;
+
+    /// a batch of child rows, each checked with one probe of the parent key index
+    result = EXIT_SUCCESS;
+    for (i = 0; i < 200 && result == EXIT_SUCCESS; i++) {
+        AK_DeleteAll_L3(&row_root);
+        AK_Insert_New_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, "Mislav", "ref_test", "Value", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, "Batch", "ref_test", "Rnd", row_root);
+        result = AK_insert_row(row_root);
+    }
+    printf("\n%d child rows inserted\n", i);
+    if (result == EXIT_SUCCESS)
+        success++;
+    else
+        failed++;
+    AK_DeleteAll_L3(&row_root);
 
-    AK_print_table("ref_test");
+    /// the parent key index follows the rows of the parent: a new parent row is found, a deleted one is not
+    int parent = 35997, year = 2011, orphan;
+    float weight = 70.0;
+    AK_Insert_New_Element(TYPE_INT, &parent, "student", "mbr", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "KeyProbe", "student", "firstname", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Parent", "student", "lastname", row_root);
+    AK_Insert_New_Element(TYPE_INT, &year, "student", "year", row_root);
+    AK_Insert_New_Element(TYPE_FLOAT, &weight, "student", "weight", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_Insert_New_Element(TYPE_INT, &parent, "ref_test", "FK", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "KeyProbe", "ref_test", "Value", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Probe", "ref_test", "Rnd", row_root);
+    result = AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_VARCHAR, "Probe", "ref_test", "Rnd", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_VARCHAR, "KeyProbe", "student", "firstname", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_Insert_New_Element(TYPE_INT, &parent, "ref_test", "FK", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "KeyProbe", "ref_test", "Value", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "Probe", "ref_test", "Rnd", row_root);
+    orphan = AK_insert_row(row_root);
+    printf("\nChild of a new parent row: %d, of a deleted one: %d\n", result, orphan);
+    if (result == EXIT_SUCCESS && orphan == EXIT_ERROR)
+        success++;
+    else
+        failed++;
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
 
     AK_print_table("student");
-    AK_print_table("ref_test");
     AK_EPI;
 
-    return TEST_result(0,1);
+    return TEST_result(success, failed);
 }
@@ -19,6 +19,96 @@
 
 #include "unique.h"
 
+/**
+ * @brief Function that splits the attribute name(s) of a UNIQUE constraint into the key of its hash index
+ * @param char attName[] name(s) of attribute(s) separated by SEPARATOR
+ * @param key attribute names
+ * @return number of attributes, EXIT_ERROR if there are more than MAX_ATTRIBUTES
+ **/
+static int AK_unique_key(char attName[], char key[][MAX_ATT_NAME]){
+	char attNameCopy[MAX_VARCHAR_LENGTH];
+	char *nameOfAtt;
+	int numOfKeys = 0;
+
+	strncpy(attNameCopy, attName, sizeof(attNameCopy) - 1);
+	attNameCopy[sizeof(attNameCopy) - 1] = '\0';
+	for(nameOfAtt = strtok(attNameCopy, SEPARATOR); nameOfAtt != NULL; nameOfAtt = strtok(NULL, SEPARATOR))
+	{
+		if(numOfKeys == MAX_ATTRIBUTES)
+			return EXIT_ERROR;
+		strncpy(key[numOfKeys], nameOfAtt, MAX_ATT_NAME - 1);
+		key[numOfKeys][MAX_ATT_NAME - 1] = '\0';
+		numOfKeys++;
+	}
+	return numOfKeys;
+}
+
+/**
+ * @brief Function that checks new value(s) against the hash index on the attribute(s) of a UNIQUE constraint. The
+ * values are converted from their string form, only INT and VARCHAR attributes are looked up this way.
+ * @param char* tableName name of table
+ * @param char attName[] name(s) of attribute(s) separated by SEPARATOR
+ * @param char newValue[] new value(s) separated by SEPARATOR
+ * @return EXIT_SUCCESS if the value(s) are UNIQUE, EXIT_ERROR if they are not, EXIT_WARNING if the index can't tell
+ **/
+static int AK_unique_index_check(char* tableName, char attName[], char newValue[]){
+	char key[MAX_ATTRIBUTES][MAX_ATT_NAME];
+	char newValueCopy[MAX_VARCHAR_LENGTH];
+	char indexName[MAX_ATT_NAME];
+	char intString[MAX_VARCHAR_LENGTH];
+	char *token;
+	AK_header *header;
+	struct list_node *values;
+	struct_add *add;
+	int numOfKeys;
+	int numAttr;
+	int intValue;
+	int i, j;
+	int result = EXIT_WARNING;
+
+	numOfKeys = AK_unique_key(attName, key);
+	if(numOfKeys <= 0 || AK_hash_find_key(tableName, numOfKeys, key, indexName) == EXIT_ERROR)
+		return EXIT_WARNING;
+
+	header = (AK_header *) AK_get_header(tableName);
+	numAttr = AK_num_attr(tableName);
+	values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	AK_Init_L3(&values);
+
+	strncpy(newValueCopy, newValue, sizeof(newValueCopy) - 1);
+	newValueCopy[sizeof(newValueCopy) - 1] = '\0';
+	token = strtok(newValueCopy, SEPARATOR);
+	for(i = 0; i < numOfKeys && token != NULL; i++, token = strtok(NULL, SEPARATOR))
+	{
+		for(j = 0; j < numAttr && strcmp(header[j].att_name, key[i]) != 0; j++);
+		if(j == numAttr)
+			break;
+		if(header[j].type == TYPE_INT)
+		{
+			//only a value written the way AK_tuple_to_string writes it can be equal to a stored one
+			intValue = atoi(token);
+			sprintf(intString, "%d", intValue);
+			if(strcmp(intString, token) != 0)
+				break;
+			AK_InsertAtEnd_L3(TYPE_INT, (char *) &intValue, sizeof(int), values);
+		}
+		else if(header[j].type == TYPE_VARCHAR)
+			AK_InsertAtEnd_L3(TYPE_VARCHAR, token, strlen(token), values);
+		else
+			break;
+	}
+	if(i == numOfKeys && token == NULL)
+	{
+		add = AK_find_in_hash_index(indexName, values);
+		result = add->addBlock != 0 ? EXIT_ERROR : EXIT_SUCCESS;
+		AK_free(add);
+	}
+	AK_DeleteAll_L3(&values);
+	AK_free(values);
+	AK_free(header);
+	return result;
+}
+
 /**
  * @author Domagoj Tuličić, updated by Nenad Makar 
  * @brief Function that sets unique constraint on attribute(s)
@@ -160,6 +250,15 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 	AK_insert_row(row_root);
 	AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);
+	AK_constraint_cache_invalidate(tableName);
+
+	//AK_read_constraint_unique probes this index
+	char key[MAX_ATTRIBUTES][MAX_ATT_NAME];
+	char indexName[MAX_ATT_NAME];
+	int numOfKeys = AK_unique_key(attName, key);
+	if(numOfKeys > 0)
+		AK_hash_key_index(tableName, numOfKeys, key, indexName);
+
 	printf("\nUNIQUE constraint is set on (combination of) attribute(s): %s\nof table: %s\n\n", attName, tableName);
 	AK_EPI;
 	return EXIT_SUCCESS;
@@ -219,111 +318,114 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 		}
 	}
 
-	int numRecords = AK_get_num_records("AK_constraints_unique");
-	
-	if(numRecords!=0 && (strcmpTableName!=0 || (strcmpTableName==0 && strcmpAttName==0)))
+	if(strcmpTableName!=0 || strcmpAttName==0)
 	{
-		struct list_node *row;
-		struct list_node *attribute;
-		struct list_node *table;
+		AK_constraint_descriptor descriptor;
+		int constraintSet = 0;
 		int i;
 		
-		for(i=0; i<numRecords; i++)
+		//UNIQUE constraints of the table come from the constraint cache
+		AK_constraint_descriptor_get(tableName, &descriptor);
+		for(i=0; i<descriptor.num_unique && constraintSet==0; i++)
+		{
+			if(strcmp(descriptor.unique[i], attName) == 0)
+				constraintSet = 1;
+		}
+		AK_constraint_descriptor_free(&descriptor);
+		
+		if(constraintSet == 1)
 		{
-			row = AK_get_row(i, "AK_constraints_unique");
-			attribute = AK_GetNth_L2(4, row);
+			//one probe of the index on the attribute(s) instead of reading the whole table
+			int indexResult = AK_unique_index_check(tableName, attName, newValue);
+			if(indexResult != EXIT_WARNING)
+			{
+				AK_EPI;
+				return indexResult;
+			}
+
+			int numRows = AK_get_num_records(tableName);
+			
+			if(numRows == 0)
+			{
+				AK_EPI;
+				return EXIT_SUCCESS;
+			}
+			
+			struct list_node *row2 = AK_get_row(0, tableName);
+			int numOfAttsInTable = AK_Size_L2(row2);
+			int positionsOfAtts[numOfAttsInTable];
+			int numOfImpAttPos = 0;
+			char attNameCopy[MAX_VARCHAR_LENGTH];
+			char *nameOfOneAtt;
+			char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
+			struct list_node *attribute2;
+			
+			strncpy(attNameCopy, attName, sizeof(attNameCopy));
+
+			nameOfOneAtt = strtok(attNameCopy, SEPARATOR);
+			while(nameOfOneAtt != NULL)
+			{
+				positionsOfAtts[numOfImpAttPos] = AK_get_attr_index(tableName, nameOfOneAtt) + 1;
+				strncpy(namesOfAtts[numOfImpAttPos], nameOfOneAtt, sizeof(namesOfAtts[numOfImpAttPos]));
+				numOfImpAttPos++;
+
+				nameOfOneAtt = strtok(NULL, SEPARATOR);
+			}
+			
+			int h;
+			int impoIndexInArray;
+			int match;
+			int index = 0;
+			char *value2;
+			char newValueCopy2[MAX_VARCHAR_LENGTH];
+			char values[numOfValues][MAX_VARCHAR_LENGTH];
+
+			strncpy(newValueCopy2, newValue, sizeof(newValueCopy2));
+
+			value2 = strtok(newValueCopy2, SEPARATOR);
+			while(value2 != NULL)
+			{
+				strncpy(values[index], value2, sizeof(values[index]));
+				index++;
+				value2 = strtok(NULL, SEPARATOR);
+			}
+
 			
-			if(strcmp(attribute->data, attName) == 0)
+			for(h=0; h<numRows; h++)
 			{
-				table = AK_GetNth_L2(2, row);
+				row2 = AK_get_row(h, tableName);
+
+				match = 1;
 				
-				if(strcmp(table->data, tableName) == 0)
+				for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
 				{
-					int numRows = AK_get_num_records(table->data);
-					
-					if(numRows == 0)
+					attribute2 = AK_GetNth_L2(positionsOfAtts[impoIndexInArray], row2);
+					if(AK_tuple_to_string(attribute2) == NULL)
 					{
-						AK_EPI;
-						return EXIT_SUCCESS;
-					}
-					
-					struct list_node *row2 = AK_get_row(0, table->data);
-					int numOfAttsInTable = AK_Size_L2(row2);
-					int positionsOfAtts[numOfAttsInTable];
-					int numOfImpAttPos = 0;
-					char attNameCopy[MAX_VARCHAR_LENGTH];
-					char *nameOfOneAtt;
-					char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
-					struct list_node *attribute2;
-					
-					strncpy(attNameCopy, attName, sizeof(attNameCopy));
-
-					nameOfOneAtt = strtok(attNameCopy, SEPARATOR);
-					while(nameOfOneAtt != NULL)
-					{
-						positionsOfAtts[numOfImpAttPos] = AK_get_attr_index(table->data, nameOfOneAtt) + 1;
-						strncpy(namesOfAtts[numOfImpAttPos], nameOfOneAtt, sizeof(namesOfAtts[numOfImpAttPos]));
-						numOfImpAttPos++;
-
-						nameOfOneAtt = strtok(NULL, SEPARATOR);
+						match = 0;
 					}
-					
-					int h;
-					int impoIndexInArray;
-					int match;
-					int index = 0;
-					char *value2;
-					char newValueCopy2[MAX_VARCHAR_LENGTH];
-					char values[numOfValues][MAX_VARCHAR_LENGTH];
-
-					strncpy(newValueCopy2, newValue, sizeof(newValueCopy2));
-
-					value2 = strtok(newValueCopy2, SEPARATOR);
-					while(value2 != NULL)
+					else if(strcmp(values[impoIndexInArray], AK_tuple_to_string(attribute2)) != 0)
 					{
-						strncpy(values[index], value2, sizeof(values[index]));
-						index++;
-						value2 = strtok(NULL, SEPARATOR);
+						match = 0 ;
 					}
 
-					
-					for(h=0; h<numRows; h++)
-					{
-						row2 = AK_get_row(h, table->data);
-
-						match = 1;
-						
-						for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
-						{
-							attribute2 = AK_GetNth_L2(positionsOfAtts[impoIndexInArray], row2);
-							if(AK_tuple_to_string(attribute2) == NULL)
-							{
-								match = 0;
-							}
-							else if(strcmp(values[impoIndexInArray], AK_tuple_to_string(attribute2)) != 0)
-							{
-								match = 0 ;
-							}
-
-						}
-						
-						if(match == 1)
-						{
-							AK_EPI;
-							return EXIT_ERROR;
-						}
-					}
-					
+				}
+				
+				if(match == 1)
+				{
 					AK_EPI;
-					return EXIT_SUCCESS;
+					return EXIT_ERROR;
 				}
 			}
+			
+			AK_EPI;
+			return EXIT_SUCCESS;
 		}
 		
 		AK_EPI;
 		return EXIT_SUCCESS;
 	}
-	else if(numRecords !=0 && strcmpTableName==0 && strcmpAttName!=0)
+	else if(AK_get_num_records("AK_constraints_unique") != 0)
 	{
 		struct list_node *row = AK_get_row(0, tableName);
 		int numOfAttsInTable = AK_Size_L2(row);
@@ -434,6 +536,7 @@ int AK_delete_constraint_unique(char* tableName, char* constraintName){
     int result = AK_delete_row(row_root);
     AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);    
+    AK_constraint_cache_invalidate(NULL);
 
     AK_EPI;
 
@@ -566,8 +669,17 @@ TestResult AK_unique_test() {
 	{
 		printf("\nChecking if value %s would be UNIQUE in attribute %s of table %s...\nYes (0) No (-1): %d\n\n", newValue0, attYear, tableName, AK_read_constraint_unique(tableName, attYear, newValue0));
 		printf("\nChecking if value %s would be UNIQUE in attribute %s of table %s...\nYes (0) No (-1): %d\n\n", newValue1, attYear, tableName, AK_read_constraint_unique(tableName, attYear, newValue1));
-		success++;
-		printf("\nSUCCESS\n\n");
+		//both answers come from the hash index created with the constraint
+		if(AK_read_constraint_unique(tableName, attYear, newValue0) == EXIT_ERROR && AK_read_constraint_unique(tableName, attYear, newValue1) == EXIT_SUCCESS)
+		{
+			success++;
+			printf("\nSUCCESS\n\n");
+		}
+		else
+		{
+			failed++;
+			printf("\nFAILED\n\n");
+		}
 	}
 	else
 	{
@@ -606,6 +718,35 @@ TestResult AK_unique_test() {
 	}
 	
         
+	//the index follows the rows of the table, a value inserted after the constraint is found and a deleted one is not
+	printf("\nChecking that an inserted and a deleted value of attribute %s are seen by the index...\n\n", attYear);
+	int probeMbr = 35996, probeYear = 2050;
+	float probeWeight = 70.0;
+	struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	AK_Init_L3(&row_root);
+	AK_Insert_New_Element(TYPE_INT, &probeMbr, tableName, "mbr", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "UniqueProbe", tableName, "firstname", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "Probe", tableName, "lastname", row_root);
+	AK_Insert_New_Element(TYPE_INT, &probeYear, tableName, "year", row_root);
+	AK_Insert_New_Element(TYPE_FLOAT, &probeWeight, tableName, "weight", row_root);
+	result = AK_insert_row(row_root) == EXIT_SUCCESS && AK_read_constraint_unique(tableName, attYear, newValue1) == EXIT_ERROR;
+	AK_DeleteAll_L3(&row_root);
+	AK_Update_Existing_Element(TYPE_VARCHAR, "UniqueProbe", tableName, "firstname", row_root);
+	AK_delete_row(row_root);
+	AK_DeleteAll_L3(&row_root);
+	AK_free(row_root);
+	result = result && AK_read_constraint_unique(tableName, attYear, newValue1) == EXIT_SUCCESS;
+	if(result)
+	{
+		success++;
+		printf("\nSUCCESS\n\n");
+	}
+	else
+	{
+		failed++;
+		printf("\nFAILED\n\n");
+	}
+
         printf("\n============== Running Test #4 ==============\n");
 	printf("\nTrying to set UNIQUE constraint on attribute %s of table %s...\n\n", attFirstname, tableName);
 	result = AK_set_constraint_unique(tableName, attFirstname, constraintName);
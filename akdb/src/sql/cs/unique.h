@@ -23,9 +23,11 @@
 #include "../../auxi/test.h"
 #include "../../file/table.h"
 #include "../../file/fileio.h"
+#include "../../file/idx/hash.h"
 #include "../../auxi/mempro.h"
 #include "../../auxi/dictionary.h"
 #include "constraint_names.h"
+#include "constraint_cache.h"
 
 /**
  * @author Domagoj Tuličić, updated by Nenad Makar 
@@ -47,7 +47,8 @@ char *system_catalog[NUM_SYS_TABLES] = {
     "AK_constraints_not_null",
     AK_CONSTRAINTS_CHECK_CONSTRAINT,
     "AK_constraints_unique",
-    "AK_reference"
+    "AK_reference",
+    "AK_statistics"
 };
 
 /**
@@ -119,6 +120,8 @@ int AK_drop_table(AK_drop_arguments *drop_arguments){
             }
         }
         if (status != 1) {
+            AK_statistics_drop(name);
+            AK_constraint_cache_invalidate(name);
             AK_drop_help_function(name, sys_table);
             printf("TABLE %s DROPPED!\n", name);
             return EXIT_SUCCESS;
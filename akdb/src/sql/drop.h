@@ -23,6 +23,7 @@
 #include "../auxi/test.h"
 #include "../file/table.h"
 #include "../file/fileio.h"
+#include "../file/statistics.h"
 #include "../file/sequence.h"
 #include "view.h"
 #include "trigger.h"
@@ -21,134 +21,115 @@
 
 /**
  * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Helper function in SELECT clause which filters by condition
+ * @brief Function that implements SELECT relational operator. The selection, the sort and the projection are
+ * operators of one pipeline, so the rows go from the source table into the result without temporary tables; only
+ * a sort that does not fit into WORK_MEMORY and a projection with arithmetic operations write their input into one.
  * @param srcTable - original table that is used for selection
- * @param selection_table - table in which result of applied condition is stored
+ * @param destTable - table that contains the result
  * @param condition - condition for selection
- * @return EXIT_SUCCESS if there was no error applying condition 
+ * @param attributes - atributes to be selected
+ * @param ordering - atributes for result sorting
+ * @return EXIT_SUCCESS if cache result in memory and print table else break 
  */
-int AK_apply_select_by_condition(char *srcTable, char *selection_table, struct list_node *condition){
-    strcat(selection_table, srcTable);
-    if(condition != NULL)
+int AK_select(char *srcTable, char *destTable, struct list_node *attributes, struct list_node *condition, struct list_node *ordering)
+{
+    AK_iterator *rows, *sorted;
+    AK_PRO;
+    //select required rows
+    rows = condition != NULL ? AK_selection_iterator(srcTable, condition) : AK_iterator_scan(srcTable);
+    if (rows == NULL)
     {
-        strcat(selection_table, "__selection");
-        //select required rows
-        if (AK_selection(srcTable, selection_table, condition) != EXIT_SUCCESS)
-        {
-            return EXIT_ERROR;
-        }
+        AK_EPI;
+        return EXIT_ERROR;
     }
-    return EXIT_SUCCESS;
-}
 
-/**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Helper function in SELECT clause which does the ordering
- * @param projectionAttributes - copy of the attributes given
- * @param ordering - condition on which to order
- * @param sorted_table - table in which result of applied ordering is stored
- * @param selection_table - table in which result of applied condition is stored
- * @return EXIT_SUCCESS if there was no error ordering
- */
-int AK_apply_select_by_sorting(char *sorted_table, char *selection_table, struct list_node *ordering, struct list_node *projectionAttributes){
-    strcat(sorted_table, selection_table);
     //sort required rows
     if (ordering != NULL)
     {
-        strcat(sorted_table, "__sorted");
-        if (AK_sort_segment(selection_table, sorted_table, ordering) != EXIT_SUCCESS)
+        sorted = AK_iterator_sort(rows, ordering);
+        if (sorted == NULL)
         {
-            AK_DeleteAll_L3(&projectionAttributes);
-            AK_free(projectionAttributes);
+            AK_iterator_free(rows);
+            AK_EPI;
             return EXIT_ERROR;
         }
+        rows = sorted;
     }
-    return EXIT_SUCCESS;
-}
-/**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Function that clears temporary tables
- * @param sorted_table - table in which result of applied ordering is stored
- * @param selection_table - table in which result of applied condition is stored
- * @param srcTable - original table that is used for selection
- * @return EXIT_SUCCESS
- */
-int AK_apply_select_free_temp_tables(char *srcTable, char *selection_table, char *sorted_table){
-    if(strcmp(srcTable, selection_table) != 0)
-    {
-        AK_delete_segment(selection_table, SEGMENT_TYPE_TABLE);
-        if(strcmp(selection_table, sorted_table) != 0)
-        {
-            AK_delete_segment(sorted_table, SEGMENT_TYPE_TABLE);
-        }
-    }
-    else
+
+    //project required rows
+    if (AK_projection_pipeline(rows, destTable, attributes, NULL) != EXIT_SUCCESS)
     {
-        if(strcmp(srcTable, sorted_table) != 0)
-        {
-            AK_delete_segment(sorted_table, SEGMENT_TYPE_TABLE);
-        }
+        AK_EPI;
+        return EXIT_ERROR;
     }
+    AK_EPI;
     return EXIT_SUCCESS;
 }
 
-
 /**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Function that implements SELECT relational operator
- * @param srcTable - original table that is used for selection
- * @param destTable - table that contains the result
- * @param condition - condition for selection
- * @param attributes - atributes to be selected
- * @param ordering - atributes for result sorting
- * @return EXIT_SUCCESS if cache result in memory and print table else break 
+ * @brief Function that checks pipelines over the student table: the three latest students before 2008 by a sort
+ * with a limit, and the first eight students joined with their own year on mbr
+ * @return 1 if both give the right rows, 0 otherwise
  */
-int AK_select(char *srcTable, char *destTable, struct list_node *attributes, struct list_node *condition, struct list_node *ordering)
+static int AK_select_test_pipeline()
 {
-    struct list_node *attribute;
-    AK_PRO;
-    //create help table name for selection
-    char selection_table[MAX_ATT_NAME] = "";
-    if (AK_apply_select_by_condition(srcTable, &selection_table, condition) != EXIT_SUCCESS){
-        AK_EPI;
-        return EXIT_ERROR;
-    }
+    struct list_node *condition = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *ordering = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct list_node *columns = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_iterator *pipeline;
+    AK_tuple *tuple;
+    int year = 2008, previous = year, rows = 0, correct = 1, value, last;
+
+    AK_Init_L3(&condition);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), condition);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *)&year, sizeof(int), condition);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof("<"), condition);
+    AK_Init_L3(&ordering);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), ordering);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "DESC", sizeof("DESC"), ordering);
 
-    // create copy of attributes
-    struct list_node *projectionAttributes = (struct list_node *)AK_malloc(sizeof(struct list_node));
-    AK_Init_L3(&projectionAttributes);
-    for (attribute = AK_First_L2(attributes); attribute; attribute = AK_Next_L2(attribute))
+    pipeline = AK_iterator_limit(AK_iterator_sort(AK_selection_iterator("student", condition), ordering), 3);
+    AK_iterator_open(pipeline);
+    while ((tuple = AK_iterator_next(pipeline)) != NULL)
     {
-        AK_InsertAtEnd_L3(TYPE_ATTRIBS, attribute->data, strlen(attribute->data), projectionAttributes);
-    }
-
-
-    //create help table name for sorting
-    char sorted_table[ MAX_ATT_NAME ] = "";
-    if (AK_apply_select_by_sorting(&sorted_table, &selection_table, ordering, projectionAttributes) != EXIT_SUCCESS){
-        AK_EPI;
-        return EXIT_ERROR;
+        memcpy(&value, AK_tuple_data(tuple, AK_tuple_schema_find(pipeline->schema, "year")), sizeof(int));
+        correct = correct && value <= previous && value < year;
+        previous = value;
+        rows++;
     }
-
-    //project required rows
-    if (AK_projection(sorted_table, destTable, projectionAttributes, NULL) != EXIT_SUCCESS)
+    AK_iterator_close(pipeline);
+    AK_iterator_free(pipeline);
+    printf("\nAK_select_test: %d rows sorted by year, latest %d rows taken, year %d last\n", AK_get_num_records("student"), rows, previous);
+    correct = correct && rows == 3;
+
+    AK_Init_L3(&columns);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof("mbr"), columns);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), columns);
+    pipeline = AK_iterator_limit(AK_iterator_project(AK_iterator_scan("student"), columns), 8);
+    AK_DeleteAll_L3(&columns);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof("mbr"), columns);
+    pipeline = AK_iterator_join(AK_iterator_scan("student"), pipeline, columns);
+    last = pipeline->schema->num_attr - 1;
+    correct = correct && last == AK_num_attr("student");
+    AK_iterator_open(pipeline);
+    for (rows = 0; (tuple = AK_iterator_next(pipeline)) != NULL; rows++)
     {
-        AK_DeleteAll_L3(&projectionAttributes);
-        AK_free(projectionAttributes);
-        AK_EPI;
-        return EXIT_ERROR;
+        memcpy(&value, AK_tuple_data(tuple, AK_tuple_schema_find(pipeline->schema, "year")), sizeof(int));
+        memcpy(&previous, AK_tuple_data(tuple, last), sizeof(int));
+        correct = correct && value == previous;
     }
+    AK_iterator_close(pipeline);
+    AK_iterator_free(pipeline);
+    printf("AK_select_test: %d students joined with their year\n", rows);
+    correct = correct && rows == 8;
 
-    // free temp tables
-    if (AK_apply_select_free_temp_tables(srcTable, &selection_table, &sorted_table) != EXIT_SUCCESS){
-        AK_EPI;
-        return EXIT_ERROR;
-    }
-
-    AK_DeleteAll_L3(&projectionAttributes);
-    AK_free(projectionAttributes);
-    AK_EPI;
-    return EXIT_SUCCESS;
+    AK_DeleteAll_L3(&condition);
+    AK_DeleteAll_L3(&ordering);
+    AK_DeleteAll_L3(&columns);
+    AK_free(condition);
+    AK_free(ordering);
+    AK_free(columns);
+    return correct;
 }
 
 /**
@@ -159,6 +140,7 @@ TestResult AK_select_test(){
 	
     int succesfulTests = 0;
     int failedTests = 0;
+    int i;
     AK_PRO;
 	
 	// list of attributes which will be in the result of selection
@@ -217,6 +199,22 @@ TestResult AK_select_test(){
     }
     
     AK_DeleteAll_L3(&attributes);
+
+    // the same pipelines with their rows held in memory and written into temporary segments
+    int work_memory = AK_settings.work_memory;
+    for (i = 0; i < 2; i++)
+    {
+        AK_settings.work_memory = i == 0 ? work_memory : 1;
+        if (AK_select_test_pipeline())
+        {
+            succesfulTests++;
+        }
+        else
+        {
+            failedTests++;
+        }
+    }
+    AK_settings.work_memory = work_memory;
 	
     AK_print_table(srcTable);
 	printf("\n SELECT firstname, year, weight, weight+year FROM student WHERE year < 2008 ORDER BY firstname;\n\n");
@@ -76,5 +76,6 @@ int AK_view_change_query(char *name, char *query, char *rel_exp);
 TestResult AK_view_test();
 
 char* AK_get_view_query(char *name);
+char* AK_get_relation_expression(char *name);
 
 #endif
@@ -11,6 +11,7 @@
 #include "../opti/rel_eq_projection.c"
 #include "../sql/view.c"
 #include "../opti/query_optimization.c"
+#include "../opti/query_plan.c"
 #include "../opti/rel_eq_comut.c"
 #include "../opti/rel_eq_assoc.c"
 #include "../opti/rel_eq_selection.c"
@@ -24,12 +25,15 @@
 #include "../file/filesearch.c"
 #include "../file/files.c"
 #include "../file/table.c"
+#include "../file/tuple.c"
+#include "../file/statistics.c"
 #include "../file/id.c"
 #include "../file/fileio.c"
 #include "../file/filesort.c"
 #include "../file/sequence.c"
 #include "../file/idx/index.c"
 #include "../file/idx/btree.c"
+#include "../file/idx/bptree.c"
 #include "../file/idx/bitmap.c"
 #include "../file/idx/hash.c"
 #include "../file/test.c"
@@ -51,13 +55,18 @@
 #include "../rel/aggregation.c"
 #include "../rel/product.c"
 #include "../rel/expression_check.c"
+#include "../rel/hash_join.c"
+#include "../rel/merge_join.c"
+#include "../rel/set_operation.c"
 #include "../rel/nat_join.c"
 #include "../rel/theta_join.c"
+#include "../rel/iterator.c"
 #include "../rel/selection.c"
 #include "../rel/difference.c"
 #include "../rel/intersect.c"
 #include "../rel/projection.c"
 #include "../sql/cs/constraint_names.c"
+#include "../sql/cs/constraint_cache.c"
 
 
 #endif